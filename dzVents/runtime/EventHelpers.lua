@@ -92,15 +92,27 @@ local function EventHelpers(domoticz, mainMethod)
 		end
 	end
 
+	-- data files that are resident in the native store (domoticz_getPersistentData / domoticz_setPersistentData)
+	-- and only need the changes written back
+	local nativeStorage = {}
+
 	function self.getStorageContext(storageDef, module)
 
 		local storageContext = {}
 		local fileStorage, value, ok
 		
 		if (storageDef ~= nil) then
-			-- load the datafile for this module
-			ok, fileStorage = pcall(require, module)
-			package.loaded[module] = nil -- no caching
+			if (domoticz_getPersistentData ~= nil) then
+				local dataFilePath = _G.dataFolderPath .. '/' .. module .. '.lua'
+				fileStorage = domoticz_getPersistentData(dataFilePath)
+				nativeStorage[dataFilePath] = (fileStorage ~= nil)
+				ok = (fileStorage ~= nil)
+			end
+			if (not ok) then
+				-- load the datafile for this module
+				ok, fileStorage = pcall(require, module)
+				package.loaded[module] = nil -- no caching
+			end
 			if (ok) then
 				-- only transfer data as defined in storageDef
 				for _var, _def in pairs(storageDef) do
@@ -181,6 +193,31 @@ local function EventHelpers(domoticz, mainMethod)
 
 		local data = {}
 
+		if (storageDef ~= nil and domoticz_setPersistentData ~= nil) then
+			local histories = {}
+			local native = nativeStorage[dataFilePath]
+			nativeStorage[dataFilePath] = nil
+
+			for var, def in pairs(storageDef) do
+				if (type(var) == 'number' and type(def) == 'string') then
+					data[def] = storageContext[def]
+				elseif (def.history ~= nil and def.history == true) then
+					if (native) then
+						histories[var] = storageContext[var]._getChanges()
+					else
+						histories[var] = { full = storageContext[var]._getForStorage() }
+					end
+				else
+					data[var] = storageContext[var]
+				end
+			end
+			if (domoticz_setPersistentData(dataFilePath, data, histories)) then
+				return
+			end
+			-- not storable in the native store (e.g. cyclic tables), write the file
+			data = {}
+		end
+
 		if (storageDef ~= nil) then
 			-- transfer only stuf as described in storageDef
 			for var, def in pairs(storageDef) do
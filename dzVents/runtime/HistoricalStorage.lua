@@ -61,6 +61,10 @@ local function HistoricalStorage(data, maxItems, maxHours, maxMinutes, getData)
 	-- IMPORTANT: data must be time-stamped in UTC format
 
 	local newAdded = false
+	local addedCount = 0 -- items added since loading, for the native store
+	local wasReset = false
+	local loadedIndex = {} -- item -> position and data when loading, to find items changed in place
+	local loadedData = {}
 	if (maxItems == nil) then
 		maxItems = MAXLIMIT
 	end
@@ -95,8 +99,11 @@ local function HistoricalStorage(data, maxItems, maxHours, maxMinutes, getData)
 					add = false
 				end
 				if (add) then
-					table.insert(self.storage, { time = t, data = sample.data })
+					local item = { time = t, data = sample.data }
+					table.insert(self.storage, item)
 					count = count + 1
+					loadedIndex[item] = count
+					loadedData[item] = sample.data
 				end
 			end
 		end
@@ -169,6 +176,33 @@ local function HistoricalStorage(data, maxItems, maxHours, maxMinutes, getData)
 		return res
 	end
 
+	function self._getChanges()
+		-- only what changed since loading: the native store keeps the rest
+		local added = {}
+		local addedSize = math.min(addedCount, self.size)
+
+		for i = addedSize + 1, self.size do
+			local item = self.storage[i]
+			-- the store only knows about added items: send everything when a kept item was
+			-- replaced, moved or changed (table data can be changed without notice)
+			if (loadedIndex[item] ~= i - addedSize or item.data ~= loadedData[item] or type(item.data) == 'table') then
+				return { full = self._getForStorage() }
+			end
+		end
+
+		for i = 1, addedSize do
+			table.insert(added, {
+				time = self.storage[i].time.raw,
+				data = self.storage[i].data
+			})
+		end
+		return {
+			reset = wasReset,
+			added = added,
+			size = self.size
+		}
+	end
+
 	function self.setNew(data)
 		utils.log('setNew is deprecated. Please use add().', utils.LOG_INFO)
 		self.add(data)
@@ -191,6 +225,7 @@ local function HistoricalStorage(data, maxItems, maxHours, maxMinutes, getData)
 			data = data
 		})
 		self.size = self.size + 1
+		addedCount = addedCount + 1
 	end
 
 	function self.getNew()
@@ -247,6 +282,8 @@ local function HistoricalStorage(data, maxItems, maxHours, maxMinutes, getData)
 		end
 		self.size = 0
 		self.newData = nil
+		addedCount = 0
+		wasReset = true
 	end
 
 	local function _getItemData(item)
@@ -512,6 +512,45 @@ describe('event helper storage', function()
 			assert.is_same(data, newData)
 		end)
 
+		it('should return only the changes since loading', function()
+			local hs = HS(data)
+			assert.is_same({ reset = false, added = {}, size = 10 }, hs._getChanges())
+
+			hs.add(11)
+			hs.add(12)
+			local changes = hs._getChanges()
+			assert.is_false(changes.reset)
+			assert.is_same(10, changes.size)
+			assert.is_same(2, _.size(changes.added))
+			assert.is_same(12, changes.added[1].data)
+			assert.is_same(11, changes.added[2].data)
+			assert.is_same(hs.getLatest().time.raw, changes.added[1].time)
+
+			hs.reset()
+			hs.add(13)
+			changes = hs._getChanges()
+			assert.is_true(changes.reset)
+			assert.is_same(1, changes.size)
+			assert.is_same(13, changes.added[1].data)
+		end)
+
+		it('should return all when kept items were changed in place', function()
+			local hs = HS(data)
+			hs.add(11)
+			hs.get(3).data = 100
+			local changes = hs._getChanges()
+			assert.is_same(hs._getForStorage(), changes.full)
+			assert.is_same(100, changes.full[3].data)
+
+			hs = HS(data)
+			table.remove(hs.storage, 2)
+			hs.size = hs.size - 1
+			assert.is_same(hs._getForStorage(), hs._getChanges().full)
+
+			hs = HS({ { time = data[1].time, data = { value = 1 } } })
+			assert.is_same({ { time = data[1].time, data = { value = 1 } } }, hs._getChanges().full)
+		end)
+
 		it('should have iterators: forEach', function()
 			local hs = HS(data)
 
@@ -3,6 +3,8 @@
 #include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>     // for error_code
 #include "../main/Logger.h"
+#include "../main/Helper.h"
+#include "DomoticzHardware.h"
 
 struct hostent;
 
@@ -13,8 +15,10 @@ struct hostent;
 #define STATUS_OK(err) !err
 
 ASyncTCP::ASyncTCP(const bool secure)
+	: mOwnIos(m_iocontextpool.IsEnabled() ? nullptr : new boost::asio::io_service)
+	, mIos(mOwnIos ? *mOwnIos : m_iocontextpool.GetContext())
 #ifdef WWW_ENABLE_SSL
-	: mSecure(secure)
+	, mSecure(secure)
 #endif
 {
 #ifdef WWW_ENABLE_SSL
@@ -30,6 +34,13 @@ ASyncTCP::~ASyncTCP()
 {
 	assert(mTcpthread == nullptr);
 	mIsTerminating = true;
+	if ((!mOwnIos) && (mIsStarted))
+	{
+		//This should never happen. terminate() never called!!
+		_log.Log(LOG_ERROR, "ASyncTCP: Connection still active on the shared I/O pool. terminate() never called!!!");
+		disconnect();
+		wait_pending_handlers();
+	}
 	if (mTcpthread)
 	{
 		//This should never happen. terminate() never called!!
@@ -57,19 +68,32 @@ void ASyncTCP::connect(const std::string& ip, uint16_t port)
 		terminate();
 	}
 
-	// RK: We reset mIos here because it might have been stopped in terminate()
-	mIos.reset();
-	// RK: After the reset, we need to provide it work anew
-	mTcpwork = std::make_shared<boost::asio::io_service::work>(mIos);
-	if (!mTcpthread)
-		mTcpthread = std::make_shared<std::thread>([p = &mIos] { p->run(); });
+	if (mOwnIos)
+	{
+		// RK: We reset mIos here because it might have been stopped in terminate()
+		mIos.reset();
+		// RK: After the reset, we need to provide it work anew
+		mTcpwork = std::make_shared<boost::asio::io_service::work>(mIos);
+		if (!mTcpthread)
+			mTcpthread = std::make_shared<std::thread>([p = &mIos] { p->run(); });
+	}
+	mIsStarted = true;
 
 	mIp = ip;
 	mPort = port;
+	if (!mHandlerStats)
+	{
+		// connect is called from StartHardware, by then the hardware name is known
+		std::string label = std_format("ASyncTCP %s:%d", ip.c_str(), port);
+		auto pHardware = dynamic_cast<CDomoticzHardwareBase *>(this);
+		if ((pHardware) && (!pHardware->m_Name.empty()))
+			label = pHardware->m_Name + " (" + label + ")";
+		mHandlerStats = m_iocontextpool.GetHandlerStats(label);
+	}
 	std::string port_str = std::to_string(port);
 	boost::asio::ip::tcp::resolver::query query(ip, port_str);
 	timeout_start_timer();
-	mResolver.async_resolve(query, [this](auto &&err, auto &&iter) { cb_resolve_done(err, iter); });
+	mResolver.async_resolve(query, track([this](auto &&err, auto &&iter) { cb_resolve_done(err, iter); }));
 }
 
 void ASyncTCP::cb_resolve_done(const boost::system::error_code& error, boost::asio::ip::tcp::resolver::iterator endpoint_iterator)
@@ -98,12 +122,12 @@ void ASyncTCP::connect_start(boost::asio::ip::tcp::resolver::iterator& endpoint_
 	{
 		// we reset the ssl socket, because the ssl context needs to be reinitialized after a reconnect
 		mSslSocket.reset(new boost::asio::ssl::stream<boost::asio::ip::tcp::socket>(mIos, mContext));
-		mSslSocket->lowest_layer().async_connect(mEndPoint, [this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); });
+		mSslSocket->lowest_layer().async_connect(mEndPoint, track([this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); }));
 	}
 	else
 #endif
 	{
-		mSocket.async_connect(mEndPoint, [this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); });
+		mSocket.async_connect(mEndPoint, track([this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); }));
 	}
 }
 
@@ -117,7 +141,7 @@ void ASyncTCP::cb_connect_done(const boost::system::error_code& error, boost::as
 		if (mSecure) 
 		{
 			timeout_start_timer();
-			mSslSocket->async_handshake(boost::asio::ssl::stream_base::client, [this](auto &&err) { cb_handshake_done(err); });
+			mSslSocket->async_handshake(boost::asio::ssl::stream_base::client, track([this](auto &&err) { cb_handshake_done(err); }));
 		}
 		else
 #endif
@@ -156,13 +180,14 @@ void ASyncTCP::cb_handshake_done(const boost::system::error_code& error)
 void ASyncTCP::reconnect_start_timer()
 {
 	if (mIsReconnecting) return;
+	if (mIsTerminating) return;
 
 	if (mReconnectDelay != 0)
 	{
 		mIsReconnecting = true;
 
 		mReconnectTimer.expires_from_now(boost::posix_time::seconds(mReconnectDelay));
-		mReconnectTimer.async_wait([this](auto &&err) { cb_reconnect_start(err); });
+		mReconnectTimer.async_wait(track([this](auto &&err) { cb_reconnect_start(err); }));
 	}
 }
 
@@ -184,13 +209,22 @@ void ASyncTCP::terminate(const bool silent)
 {
 	mIsTerminating = true;
 	disconnect(silent);
-	mTcpwork.reset();
-	mIos.stop();
-	if (mTcpthread)
+	if (mOwnIos)
 	{
-		mTcpthread->join();
-		mTcpthread.reset();
+		mTcpwork.reset();
+		mIos.stop();
+		if (mTcpthread)
+		{
+			mTcpthread->join();
+			mTcpthread.reset();
+		}
+	}
+	else
+	{
+		// The io_service is shared with other drivers, wait until our own handlers are done
+		wait_pending_handlers();
 	}
+	mIsStarted = false;
 	mIsReconnecting = false;
 	mIsConnected = false;
 	mWriteQ.clear();
@@ -201,11 +235,15 @@ void ASyncTCP::disconnect(const bool silent)
 {
 	mReconnectTimer.cancel();
 	mTimeoutTimer.cancel();
-	if (!mTcpthread) return;
+	if (!mIsStarted) return;
 
 	try
 	{
-		mIos.post([this] { do_close(); });
+		mIos.post(track([this] {
+			if (mIsTerminating)
+				mResolver.cancel();
+			do_close();
+		}));
 	}
 	catch (...)
 	{
@@ -216,6 +254,12 @@ void ASyncTCP::disconnect(const bool silent)
 	}
 }
 
+void ASyncTCP::wait_pending_handlers()
+{
+	std::unique_lock<std::mutex> l(mPending->mutex);
+	mPending->cond.wait(l, [this] { return mPending->count == 0; });
+}
+
 void ASyncTCP::do_close()
 {
 	if (mIsReconnecting) {
@@ -252,12 +296,12 @@ void ASyncTCP::do_read_start()
 #ifdef WWW_ENABLE_SSL
 	if (mSecure)
 	{
-		mSslSocket->async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), [this](auto &&err, auto bytes) { cb_read_done(err, bytes); });
+		mSslSocket->async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), track([this](auto &&err, auto bytes) { cb_read_done(err, bytes); }));
 	}
 	else
 #endif
 	{
-		mSocket.async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), [this](auto &&err, auto bytes) { cb_read_done(err, bytes); });
+		mSocket.async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), track([this](auto &&err, auto bytes) { cb_read_done(err, bytes); }));
 	}
 }
 
@@ -283,9 +327,9 @@ void ASyncTCP::write(const uint8_t* pData, size_t length)
 
 void ASyncTCP::write(const std::string& msg)
 {
-	if (!mTcpthread) return;
+	if (!mIsStarted) return;
 
-	mSendStrand.post([this, msg]() { cb_write_queue(msg); });
+	mSendStrand.post(track([this, msg]() { cb_write_queue(msg); }));
 }
 
 void ASyncTCP::cb_write_queue(const std::string& msg)
@@ -307,12 +351,12 @@ void ASyncTCP::do_write_start()
 #ifdef WWW_ENABLE_SSL
 	if (mSecure) 
 	{
-		boost::asio::async_write(*mSslSocket, boost::asio::buffer(mWriteQ.front()), [this](auto &&err, auto) { cb_write_done(err); });
+		boost::asio::async_write(*mSslSocket, boost::asio::buffer(mWriteQ.front()), track([this](auto &&err, auto) { cb_write_done(err); }));
 	}
 	else
 #endif
 	{
-		boost::asio::async_write(mSocket, boost::asio::buffer(mWriteQ.front()), [this](auto &&err, auto) { cb_write_done(err); });
+		boost::asio::async_write(mSocket, boost::asio::buffer(mWriteQ.front()), track([this](auto &&err, auto) { cb_write_done(err); }));
 	}
 }
 
@@ -370,9 +414,12 @@ void ASyncTCP::timeout_start_timer()
 	if (0 == mTimeoutDelay) {
 		return;
 	}
+	if (mIsTerminating) {
+		return;
+	}
 	timeout_cancel_timer();
 	mTimeoutTimer.expires_from_now(boost::posix_time::seconds(mTimeoutDelay));
-	mTimeoutTimer.async_wait([this](auto &&err) { timeout_handler(err); });
+	mTimeoutTimer.async_wait(track([this](auto &&err) { timeout_handler(err); }));
 }
 
 void ASyncTCP::timeout_cancel_timer()
@@ -9,6 +9,9 @@
 #include <boost/asio/ssl.hpp>		 // for secure sockets
 #include <boost/asio/ssl/stream.hpp>	 // for secure sockets
 #include <exception>			  // for exception
+#include <condition_variable>		 // for pending handler tracking
+#include <mutex>			 // for pending handler tracking
+#include "../main/IoContextPool.h"	 // for the shared io_service pool
 
 #define ASYNCTCP_THREAD_NAME "ASyncTCP"
 #define DEFAULT_RECONNECT_TIME 30
@@ -46,9 +49,36 @@ class ASyncTCP
 	virtual void OnData(const uint8_t *pData, size_t length) = 0;
 	virtual void OnError(const boost::system::error_code &error) = 0;
 
-	boost::asio::io_service mIos; // protected to allow derived classes to attach timers etc.
+	std::unique_ptr<boost::asio::io_service> mOwnIos; // only set when not running on the shared pool
+	boost::asio::io_service &mIos; // protected to allow derived classes to attach timers etc.
 
       private:
+	// Counts the handlers this connection still has queued, so terminate() can wait for them
+	// when the io_service is shared with other drivers and can not simply be stopped.
+	struct _tPendingHandlers
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		int count = 0;
+	};
+	template <typename Handler> auto track(Handler handler)
+	{
+		{
+			std::lock_guard<std::mutex> l(mPending->mutex);
+			mPending->count++;
+		}
+		return [this, pending = mPending, handler](auto &&...args) mutable {
+			auto tStart = std::chrono::steady_clock::now();
+			handler(std::forward<decltype(args)>(args)...);
+			if (mHandlerStats)
+				mHandlerStats->Account(tStart);
+			std::lock_guard<std::mutex> l(pending->mutex);
+			if (--pending->count == 0)
+				pending->cond.notify_all();
+		};
+	}
+	void wait_pending_handlers();
+
 	void cb_resolve_done(const boost::system::error_code &err, boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
 	void connect_start(boost::asio::ip::tcp::resolver::iterator &endpoint_iterator);
 	void cb_connect_done(const boost::system::error_code &error, boost::asio::ip::tcp::resolver::iterator &endpoint_iterator);
@@ -79,6 +109,10 @@ class ASyncTCP
 	bool mIsConnected = false;
 	bool mIsReconnecting = false;
 	bool mIsTerminating = false;
+	bool mIsStarted = false;
+
+	std::shared_ptr<_tPendingHandlers> mPending = std::make_shared<_tPendingHandlers>();
+	std::shared_ptr<CIoContextPool::_tHandlerStats> mHandlerStats;
 
 	boost::asio::io_service::strand mSendStrand{ mIos };
 	std::deque<std::string> mWriteQ; // we need a write queue to allow concurrent writes
@@ -7,6 +7,7 @@
 #include "../main/RFXtrx.h"
 #include "../main/SQLHelper.h"
 #include "../main/mainworker.h"
+#include "../main/IoContextPool.h"
 #include "hardwaretypes.h"
 #include "HardwareCereal.h"
 
@@ -79,6 +80,12 @@ void CDomoticzHardwareBase::StartHeartbeatThread()
 
 void CDomoticzHardwareBase::StartHeartbeatThread(const char* ThreadName)
 {
+	if (m_iocontextpool.IsEnabled())
+	{
+		// No dedicated thread needed, let a timer on the shared I/O pool do the work
+		m_HeartbeatTaskID = m_iocontextpool.AddPeriodicTask(m_Name + " (heartbeat)", 12, [this] { mytime(&m_LastHeartbeat); });
+		return;
+	}
 	m_Heartbeatthread = std::make_shared<std::thread>([this] { Do_Heartbeat_Work(); });
 	SetThreadName(m_Heartbeatthread->native_handle(), ThreadName);
 }
@@ -86,6 +93,12 @@ void CDomoticzHardwareBase::StartHeartbeatThread(const char* ThreadName)
 
 void CDomoticzHardwareBase::StopHeartbeatThread()
 {
+	if (m_HeartbeatTaskID >= 0)
+	{
+		RequestStop();
+		m_iocontextpool.RemovePeriodicTask(m_HeartbeatTaskID);
+		m_HeartbeatTaskID = -1;
+	}
 	if (m_Heartbeatthread)
 	{
 		RequestStop();
@@ -146,4 +146,5 @@ class CDomoticzHardwareBase : public StoppableTask
 
 	volatile bool m_stopHeartbeatrequested = { false };
 	std::shared_ptr<std::thread> m_Heartbeatthread = { nullptr };
+	int m_HeartbeatTaskID = { -1 }; // heartbeat timer on the shared I/O pool
 };
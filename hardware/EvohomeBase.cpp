@@ -38,7 +38,6 @@ bool CEvohomeBase::m_bDebug=false;
 #endif
 
 constexpr std::array<const char *, 7> CEvohomeBase::m_szControllerMode{ "Normal", "Economy", "Away", "Day Off", "Custom", "Heating Off", "Unknown" };
-constexpr std::array<const char *, 7> CEvohomeBase::m_szWebAPIMode{ "Auto", "AutoWithEco", "Away", "DayOff", "Custom", "HeatingOff", "Unknown" };
 constexpr std::array<const char *, 7> CEvohomeBase::m_szZoneMode{ "Auto", "PermanentOverride", "TemporaryOverride", "OpenWindow", "LocalOverride", "RemoteOverride", "Unknown" };
 
 const char* CEvohomeBase::GetControllerModeName(uint8_t nControllerMode)
@@ -48,7 +47,7 @@ const char* CEvohomeBase::GetControllerModeName(uint8_t nControllerMode)
 
 const char* CEvohomeBase::GetWebAPIModeName(uint8_t nControllerMode)
 {
-	return m_szWebAPIMode[std::min(nControllerMode,(uint8_t)6)];
+	return Evohome_WebAPI_Mode_Desc(nControllerMode);
 }
 
 const char* CEvohomeBase::GetZoneModeName(uint8_t nZoneMode)
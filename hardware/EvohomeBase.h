@@ -800,7 +800,6 @@ class CEvohomeBase : public CDomoticzHardwareBase
 	void SetZoneName(uint8_t nZone, const std::string &szName);
 
 	static const std::array<const char *, 7> m_szControllerMode;
-	static const std::array<const char *, 7> m_szWebAPIMode;
 	static const std::array<const char *, 7> m_szZoneMode;
 
 	std::vector<zoneModeType> m_ZoneOverrideLocal;
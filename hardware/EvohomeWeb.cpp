@@ -508,7 +508,7 @@ void CEvohomeWeb::DecodeControllerMode(temperatureControlSystem* tcs)
 		szsystemMode = "Unknown";
 	else
 		szsystemMode = (*tcs->status)["systemModeStatus"]["mode"].asString();
-	while (sysmode < 7 && strcmp(szsystemMode.c_str(), m_szWebAPIMode[sysmode]) != 0)
+	while (sysmode < 7 && strcmp(szsystemMode.c_str(), Evohome_WebAPI_Modes[sysmode]) != 0)
 		sysmode++;
 
 	_tEVOHOME1 tsen;
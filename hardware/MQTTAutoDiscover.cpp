@@ -50,6 +50,38 @@ MQTTAutoDiscover::MQTTAutoDiscover(const int ID, const std::string& Name, const
 	}
 }
 
+//Splits a topic (filter) into its levels, empty levels are kept
+static void SplitTopicLevels(const std::string& topic, std::vector<std::string>& levels)
+{
+	levels.clear();
+	size_t start = 0;
+	while (true)
+	{
+		size_t pos = topic.find('/', start);
+		if (pos == std::string::npos)
+		{
+			levels.push_back(topic.substr(start));
+			return;
+		}
+		levels.push_back(topic.substr(start, pos - start));
+		start = pos + 1;
+	}
+}
+
+//All topics on which a sensor can receive state (handled in handle_auto_discovery_sensor_message)
+static std::vector<const std::string*> GetSensorStateTopics(const std::string& availability_topic, const std::string& state_topic, const std::string& position_topic,
+	const std::string& brightness_state_topic, const std::string& rgb_state_topic, const std::string& mode_state_topic, const std::string& temperature_state_topic,
+	const std::string& current_temperature_topic)
+{
+	std::vector<const std::string*> topics;
+	for (const std::string* pTopic : { &availability_topic, &state_topic, &position_topic, &brightness_state_topic, &rgb_state_topic, &mode_state_topic, &temperature_state_topic, &current_temperature_topic })
+	{
+		if ((!pTopic->empty()) && (std::find_if(topics.begin(), topics.end(), [pTopic](const std::string* pOther) { return *pOther == *pTopic; }) == topics.end()))
+			topics.push_back(pTopic);
+	}
+	return topics;
+}
+
 void MQTTAutoDiscover::on_message(const struct mosquitto_message* message)
 {
 	std::string topic = message->topic;
@@ -60,7 +92,12 @@ void MQTTAutoDiscover::on_message(const struct mosquitto_message* message)
 		Debug(DEBUG_HARDWARE, "topic: %s, message: %s", topic.c_str(), qMessage.c_str());
 
 		if (qMessage.empty())
+		{
+			//an empty (retained) config message removes a discovered entity
+			if (m_discovered_config_topics.find(topic) != m_discovered_config_topics.end())
+				on_auto_discovery_retract(topic);
 			return;
+		}
 
 		if (
 			(topic.substr(0, topic.find('/')) == m_TopicDiscoveryPrefix)
@@ -71,24 +108,13 @@ void MQTTAutoDiscover::on_message(const struct mosquitto_message* message)
 			return;
 		}
 
-		std::string DiscoveryWildcard = m_TopicDiscoveryPrefix + "/#";
-
-		for (auto& itt : m_subscribed_topics)
-		{
-			bool result = false;
-			if (
-				(itt.first != DiscoveryWildcard)
-				&& (mosquitto_topic_matches_sub(itt.first.c_str(), topic.c_str(), &result) == MOSQ_ERR_SUCCESS)
-				)
-			{
-				if (result == true)
-				{
-					handle_auto_discovery_sensor_message(message, itt.first);
-					return;
-				}
-			}
-		}
+		std::vector<std::string> levels;
+		SplitTopicLevels(topic, levels);
 
+		const _tMQTTATopicNode* pMatch = nullptr;
+		MatchTopic(&m_topic_trie, levels, 0, pMatch);
+		if (pMatch != nullptr)
+			handle_auto_discovery_sensor_message(message, pMatch->filter);
 		return;
 	}
 	catch (const std::exception& e)
@@ -143,9 +169,129 @@ void MQTTAutoDiscover::on_disconnect(int rc)
 {
 	m_discovered_devices.clear();
 	m_discovered_sensors.clear();
+	m_discovered_config_topics.clear();
+	m_topic_trie.children.clear();
+	m_topic_trie.sensors.clear();
 	MQTT::on_disconnect(rc);
 }
 
+void MQTTAutoDiscover::AddSensorTopics(_tMQTTASensor* pSensor)
+{
+	std::vector<std::string> levels;
+	for (const std::string* pTopic : GetSensorStateTopics(pSensor->availability_topic, pSensor->state_topic, pSensor->position_topic, pSensor->brightness_state_topic,
+		pSensor->rgb_state_topic, pSensor->mode_state_topic, pSensor->temperature_state_topic, pSensor->current_temperature_topic))
+	{
+		SplitTopicLevels(*pTopic, levels);
+		_tMQTTATopicNode* pNode = &m_topic_trie;
+		for (const auto& level : levels)
+		{
+			auto& pChild = pNode->children[level];
+			if (!pChild)
+				pChild = std::make_unique<_tMQTTATopicNode>();
+			pNode = pChild.get();
+		}
+		pNode->filter = *pTopic;
+		pNode->sensors[pSensor->unique_id] = pSensor;
+	}
+}
+
+void MQTTAutoDiscover::RemoveSensorTopics(const _tMQTTASensor* pSensor)
+{
+	std::vector<std::string> levels;
+	for (const std::string* pTopic : GetSensorStateTopics(pSensor->availability_topic, pSensor->state_topic, pSensor->position_topic, pSensor->brightness_state_topic,
+		pSensor->rgb_state_topic, pSensor->mode_state_topic, pSensor->temperature_state_topic, pSensor->current_temperature_topic))
+	{
+		SplitTopicLevels(*pTopic, levels);
+		RemoveTopicFilter(&m_topic_trie, levels, 0, pSensor->unique_id);
+	}
+}
+
+//Removes the sensor from the filter, returns true when the node is no longer used and can be deleted
+bool MQTTAutoDiscover::RemoveTopicFilter(_tMQTTATopicNode* pNode, const std::vector<std::string>& levels, const size_t level, const std::string& unique_id)
+{
+	if (level == levels.size())
+		pNode->sensors.erase(unique_id);
+	else
+	{
+		auto itt = pNode->children.find(levels[level]);
+		if (itt == pNode->children.end())
+			return false;
+		if (RemoveTopicFilter(itt->second.get(), levels, level + 1, unique_id))
+			pNode->children.erase(itt);
+	}
+	return (pNode->sensors.empty() && pNode->children.empty());
+}
+
+//Finds the filter matching the topic, like the broker does ('+' one level, '#' all remaining levels)
+//when several filters match, the lowest one (in sort order) is used
+void MQTTAutoDiscover::MatchTopic(const _tMQTTATopicNode* pNode, const std::vector<std::string>& levels, const size_t level, const _tMQTTATopicNode*& pMatch)
+{
+	auto match = [&pMatch](const _tMQTTATopicNode* pFound) {
+		if ((!pFound->sensors.empty()) && ((pMatch == nullptr) || (pFound->filter < pMatch->filter)))
+			pMatch = pFound;
+	};
+
+	//wildcards do not match topics starting with '$'
+	bool bWildcards = !((level == 0) && (!levels[0].empty()) && (levels[0][0] == '$'));
+
+	if (bWildcards)
+	{
+		//'#' also matches the parent level itself
+		auto itt = pNode->children.find("#");
+		if (itt != pNode->children.end())
+			match(itt->second.get());
+	}
+	if (level == levels.size())
+	{
+		match(pNode);
+		return;
+	}
+	auto itt = pNode->children.find(levels[level]);
+	if (itt != pNode->children.end())
+		MatchTopic(itt->second.get(), levels, level + 1, pMatch);
+	if (bWildcards)
+	{
+		itt = pNode->children.find("+");
+		if (itt != pNode->children.end())
+			MatchTopic(itt->second.get(), levels, level + 1, pMatch);
+	}
+}
+
+const MQTTAutoDiscover::_tMQTTATopicNode* MQTTAutoDiscover::FindTopicFilter(const std::string& filter)
+{
+	std::vector<std::string> levels;
+	SplitTopicLevels(filter, levels);
+	const _tMQTTATopicNode* pNode = &m_topic_trie;
+	for (const auto& level : levels)
+	{
+		auto itt = pNode->children.find(level);
+		if (itt == pNode->children.end())
+			return nullptr;
+		pNode = itt->second.get();
+	}
+	return pNode;
+}
+
+void MQTTAutoDiscover::on_auto_discovery_retract(const std::string& config_topic)
+{
+	auto itt = m_discovered_config_topics.find(config_topic);
+	std::string sensor_unique_id = itt->second;
+	m_discovered_config_topics.erase(itt);
+
+	auto ittSensor = m_discovered_sensors.find(sensor_unique_id);
+	if (ittSensor == m_discovered_sensors.end())
+		return;
+	_tMQTTASensor* pSensor = &ittSensor->second;
+	RemoveSensorTopics(pSensor);
+
+	auto ittDevice = m_discovered_devices.find(pSensor->device_identifiers);
+	if (ittDevice != m_discovered_devices.end())
+		ittDevice->second.sensor_ids.erase(sensor_unique_id);
+
+	Log(LOG_STATUS, "removed: %s (unique_id: %s)", pSensor->name.c_str(), sensor_unique_id.c_str());
+	m_discovered_sensors.erase(ittSensor);
+}
+
 void MQTTAutoDiscover::CleanValueTemplate(std::string& szValueTemplate)
 {
 	if (szValueTemplate.empty())
@@ -770,8 +916,13 @@ void MQTTAutoDiscover::on_auto_discovery_message(const struct mosquitto_message*
 			}
 		}
 
+		auto ittSensor = m_discovered_sensors.find(sensor_unique_id);
+		if (ittSensor != m_discovered_sensors.end())
+			RemoveSensorTopics(&ittSensor->second); //config update, topics might have changed
+
 		_tMQTTASensor tmpSensor;
 		m_discovered_sensors[sensor_unique_id] = tmpSensor;
+		m_discovered_config_topics[org_topic] = sensor_unique_id;
 		_tMQTTASensor* pSensor = &m_discovered_sensors[sensor_unique_id];
 		pSensor->unique_id = sensor_unique_id;
 		pSensor->object_id = object_id;
@@ -1301,6 +1452,8 @@ void MQTTAutoDiscover::on_auto_discovery_message(const struct mosquitto_message*
 		
 
 
+		AddSensorTopics(pSensor);
+
 		//Check if we want to subscribe to this sensor
 		bool bDoSubscribe = false;
 
@@ -1369,9 +1522,15 @@ void MQTTAutoDiscover::handle_auto_discovery_sensor_message(const struct mosquit
 		bIsJSON = root.isObject();
 	}
 
-	for (auto& itt : m_discovered_sensors)
+	const _tMQTTATopicNode* pNode = FindTopicFilter(topic);
+	if (pNode == nullptr)
+		return;
+	//copy, the sensors of this topic should not change while handling them, but be safe
+	std::map<std::string, _tMQTTASensor*> sensors = pNode->sensors;
+
+	for (auto& itt : sensors)
 	{
-		_tMQTTASensor* pSensor = &itt.second;
+		_tMQTTASensor* pSensor = itt.second;
 
 		if (
 			(pSensor->state_topic == topic)
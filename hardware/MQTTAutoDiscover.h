@@ -128,6 +128,14 @@ class MQTTAutoDiscover : public MQTT
 		std::map<std::string, bool> sensor_ids;
 	};
 
+	// Node of the subscription trie, one level of a topic filter ('+' and '#' are stored as normal levels)
+	struct _tMQTTATopicNode
+	{
+		std::map<std::string, std::unique_ptr<_tMQTTATopicNode>> children;
+		std::string filter;
+		std::map<std::string, _tMQTTASensor*> sensors; // unique_id, sensors having this filter as state/availability topic
+	};
+
 public:
 	MQTTAutoDiscover(int ID, const std::string &Name, const std::string &IPAddress, unsigned short usIPPort, const std::string &Username, const std::string &Password,
 		      const std::string &CAfilenameExtra, int TLS_Version);
@@ -160,6 +168,13 @@ private:
 	void ApplySignalLevelDevice(const _tMQTTASensor* pSensor);
 
 	void on_auto_discovery_message(const struct mosquitto_message* message);
+	void on_auto_discovery_retract(const std::string& config_topic);
+
+	void AddSensorTopics(_tMQTTASensor* pSensor);
+	void RemoveSensorTopics(const _tMQTTASensor* pSensor);
+	bool RemoveTopicFilter(_tMQTTATopicNode* pNode, const std::vector<std::string>& levels, size_t level, const std::string& unique_id);
+	void MatchTopic(const _tMQTTATopicNode* pNode, const std::vector<std::string>& levels, size_t level, const _tMQTTATopicNode*& pMatch);
+	const _tMQTTATopicNode* FindTopicFilter(const std::string& filter);
 	void handle_auto_discovery_sensor_message(const struct mosquitto_message* message,const std::string &subscribed_topic);
 
 	void handle_auto_discovery_availability(_tMQTTASensor* pSensor, const std::string& payload, const struct mosquitto_message* message);
@@ -184,4 +199,6 @@ private:
 
 	std::map<std::string, _tMQTTADevice> m_discovered_devices;
 	std::map<std::string, _tMQTTASensor> m_discovered_sensors;
+	std::map<std::string, std::string> m_discovered_config_topics; // config topic, sensor unique_id
+	_tMQTTATopicNode m_topic_trie;
 };
@@ -4,6 +4,7 @@
 #include "../main/SQLHelper.h"
 #include "../main/localtime_r.h"
 #include "../main/Logger.h"
+#include "P1MeterOBIS.h"
 
 #include <openssl/bio.h>
 #include <openssl/evp.h>
@@ -20,136 +21,9 @@
 #define GCMTagLength 12
 const std::string _szDecodeAdd = "3000112233445566778899AABBCCDDEEFF";
 
-enum class _eP1MatchType {
-	ID = 0,
-	EXCLMARK,
-	STD,
-	DEVTYPE,
-	MBUS,
-	LINE17,
-	LINE18
-};
-
 #define P1MAXTOTALPOWER 55200		// Define Max total Power possible (80A * 3fase * 230V)
 #define P1MAXPHASEPOWER 18400		// Define Max phase Power possible (80A * 3fase * 230V)
 
-#define P1SMID		"/"				// Smart Meter ID. Used to detect start of telegram.
-#define P1VER		"1-3:0.2.8"		// P1 version
-#define P1VERBE		"0-0:96.1.4"	// P1 version + e-MUCS version (Belgium)
-#define P1TS		"0-0:1.0.0"		// Timestamp
-#define P1PUSG		"1-0:1.8."		// total power usage (excluding tariff indicator)
-#define P1PDLV		"1-0:2.8."		// total delivered power (excluding tariff indicator)
-#define P1TIP		"0-0:96.14.0"	// tariff indicator power
-#define P1PUC		"1-0:1.7.0"		// current power usage
-#define P1PDC		"1-0:2.7.0"		// current power delivery
-#define P1NOPF		"0-0:96.7.21"	// Number of power failures in any phases
-#define P1NOLPF		"0-0:96.7.9"	// Number of power failures in any phases
-#define P1NOVSGL1	"1-0:32.32.0"	// Number of voltage sags in phase L1
-#define P1NOVSGL2	"1-0:52.32.0"	// Number of voltage sags in phase L2
-#define P1NOVSGL3	"1-0:72.32.0"	// Number of voltage sags in phase L3
-#define P1NOVSWL1	"1-0:32.36.0"	// Number of voltage swells in phase L1
-#define P1NOVSWL2	"1-0:52.36.0"	// Number of voltage swells in phase L2
-#define P1NOVSWL3	"1-0:72.36.0"	// Number of voltage swells in phase L3
-#define P1VOLTL1	"1-0:32.7.0"	// voltage L1 (DSMRv5)
-#define P1VOLTL2	"1-0:52.7.0"	// voltage L2 (DSMRv5)
-#define P1VOLTL3	"1-0:72.7.0"	// voltage L3 (DSMRv5)
-#define P1AMPEREL1	"1-0:31.7.0"	// amperage L1 (DSMRv5)
-#define P1AMPEREL2	"1-0:51.7.0"	// amperage L2 (DSMRv5)
-#define P1AMPEREL3	"1-0:71.7.0"	// amperage L3 (DSMRv5)
-#define P1POWUSL1	"1-0:21.7.0"	// Power used L1 (DSMRv5)
-#define P1POWUSL2	"1-0:41.7.0"	// Power used L2 (DSMRv5)
-#define P1POWUSL3	"1-0:61.7.0"	// Power used L3 (DSMRv5)
-#define P1POWDLL1	"1-0:22.7.0"	// Power delivered L1 (DSMRv5)
-#define P1POWDLL2	"1-0:42.7.0"	// Power delivered L2 (DSMRv5)
-#define P1POWDLL3	"1-0:62.7.0"	// Power delivered L3 (DSMRv5)
-#define P1GTS		"0-n:24.3.0"	// DSMR2 timestamp gas usage sample
-#define P1GUDSMR2	"("				// DSMR2 gas usage sample
-#define P1MUDSMR4	"0-n:24.2."		// DSMR4 mbus value (excluding 'tariff' indicator)
-#define P1MBTYPE	"0-n:24.1.0"	// M-Bus device type
-#define P1EOT		"!"				// End of telegram.
-
-enum _eP1Type {
-	P1TYPE_SMID = 0,
-	P1TYPE_END,
-	P1TYPE_VERSION,
-	P1TYPE_POWERUSAGE,
-	P1TYPE_POWERDELIV,
-	P1TYPE_USAGECURRENT,
-	P1TYPE_DELIVCURRENT,
-	P1TYPE_NUMPWRFAIL,
-	P1TYPE_NUMLONGPWRFAIL,
-	P1TYPE_NUMVOLTSAGSL1,
-	P1TYPE_NUMVOLTSAGSL2,
-	P1TYPE_NUMVOLTSAGSL3,
-	P1TYPE_NUMVOLTSWELLSL1,
-	P1TYPE_NUMVOLTSWELLSL2,
-	P1TYPE_NUMVOLTSWELLSL3,
-	P1TYPE_VOLTAGEL1,
-	P1TYPE_VOLTAGEL2,
-	P1TYPE_VOLTAGEL3,
-	P1TYPE_AMPERAGEL1,
-	P1TYPE_AMPERAGEL2,
-	P1TYPE_AMPERAGEL3,
-	P1TYPE_POWERUSEL1,
-	P1TYPE_POWERUSEL2,
-	P1TYPE_POWERUSEL3,
-	P1TYPE_POWERDELL1,
-	P1TYPE_POWERDELL2,
-	P1TYPE_POWERDELL3,
-	P1TYPE_MBUSDEVICETYPE,
-	P1TYPE_MBUSUSAGEDSMR4,
-	P1TYPE_GASTIMESTAMP,
-	P1TYPE_GASUSAGE
-};
-
-using P1Match = struct
-{
-	_eP1MatchType matchtype;
-	_eP1Type type;
-	const char* key;
-	const char* topic;
-	uint8_t start;
-	uint8_t width;
-};
-
-constexpr std::array<P1Match, 32> p1_matchlist{
-	{
-		{ _eP1MatchType::ID, P1TYPE_SMID, P1SMID, "", 0, 0 },
-		{ _eP1MatchType::EXCLMARK, P1TYPE_END, P1EOT, "", 0, 0 },
-		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VER, "version", 10, 2 },
-		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VERBE, "versionBE", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSAGE, P1PUSG, "powerusage", 10, 9 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELIV, P1PDLV, "powerdeliv", 10, 9 },
-		{ _eP1MatchType::STD, P1TYPE_USAGECURRENT, P1PUC, "powerusagec", 10, 7 },
-		{ _eP1MatchType::STD, P1TYPE_DELIVCURRENT, P1PDC, "powerdelivc", 10, 7 },
-		{ _eP1MatchType::STD, P1TYPE_NUMPWRFAIL, P1NOPF, "numpwrfail", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMLONGPWRFAIL, P1NOLPF, "numlongpwrfail", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL1, P1NOVSGL1, "numvoltsagsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL2, P1NOVSGL2, "numvoltsagsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL3, P1NOVSGL3, "numvoltsagsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL1, P1NOVSWL1, "numvoltswellsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL2, P1NOVSWL2, "numvoltswellsl2", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL3, P1NOVSWL3, "numvoltswellsl3", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL1, P1VOLTL1, "voltagel1", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL2, P1VOLTL2, "voltagel2", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL3, P1VOLTL3, "voltagel3", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL1, P1AMPEREL1, "amperagel1", 11, 3 },
-		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL2, P1AMPEREL2, "amperagel2", 11, 3 },
-		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL3, P1AMPEREL3, "amperagel3", 11, 3 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSEL1, P1POWUSL1, "powerusel1", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSEL2, P1POWUSL2, "powerusel2", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSEL3, P1POWUSL3, "powerusel3", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELL1, P1POWDLL1, "powerdell1", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELL2, P1POWDLL2, "powerdell2", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELL3, P1POWDLL3, "powerdell3", 11, 6 },
-		{ _eP1MatchType::DEVTYPE, P1TYPE_MBUSDEVICETYPE, P1MBTYPE, "mbusdevicetype", 11, 3 },
-		{ _eP1MatchType::MBUS, P1TYPE_MBUSUSAGEDSMR4, P1MUDSMR4, "mbus_meter", 26, 8 },
-		// must keep DEVTYPE, GAS, LINE17 and LINE18 in this order at end of p1_matchlist
-		{ _eP1MatchType::LINE17, P1TYPE_GASTIMESTAMP, P1GTS, "gastimestamp", 11, 12 },
-		{ _eP1MatchType::LINE18, P1TYPE_GASUSAGE, P1GUDSMR2, "gasusage", 1, 9 },
-	}
-};
-
 struct P1MBusType
 {
 	P1MeterBase::P1MBusType type = P1MeterBase::P1MBusType::deviceType_Unknown;
@@ -221,6 +95,8 @@ P1MeterBase::P1MeterBase()
 P1MeterBase::~P1MeterBase()
 {
 	delete[] m_pDecryptBuffer;
+	if (m_pDecryptCtx != nullptr)
+		EVP_CIPHER_CTX_free(m_pDecryptCtx);
 }
 
 void P1MeterBase::Init()
@@ -230,6 +106,7 @@ void P1MeterBase::Init()
 	m_exclmarkfound = 0;
 	m_CRfound = 0;
 	m_bufferpos = 0;
+	m_telegramcrc = 0;
 	m_lastgasusage = 0;
 	m_lastSharedSendGas = 0;
 	m_lastSendMBusDevice = 0;
@@ -304,7 +181,6 @@ void P1MeterBase::Init()
 		m_avr_calculated[ii].delivery_cntr = GetKwhMeter(0, 4 + ii, bExists);
 	}
 
-	memset(&m_buffer, 0, sizeof(m_buffer));
 	memset(&l_buffer, 0, sizeof(l_buffer));
 
 	memset(&m_power, 0, sizeof(m_power));
@@ -371,92 +247,76 @@ void P1MeterBase::InitP1EncryptionState()
 }
 
 
-bool P1MeterBase::MatchLine()
+const P1Match *P1MeterBase::FindMatch(const char *pLine, const size_t len)
 {
-	try {
-		if ((strlen(l_buffer) < 1) || (l_buffer[0] == 0x0a))
-			return true; //null value (startup)
+	if (pLine[0] == P1SMID[0])
+	{
+		// start of data, we do not process anything else on this line
+		m_linecount = 1;
+		return nullptr;
+	}
+	if (pLine[0] == P1EOT[0])
+	{
+		// end of data
+		l_exclmarkfound = 1;
+		return &p1_matchlist[P1MATCH_EXCLMARK];
+	}
 
-		bool bFound = false;
+	const P1Match *t = P1FindStdMatch(pLine, len);
+	if (t != nullptr)
+		return t;
 
-		for (size_t i = 0; i < p1_matchlist.size(); ++i)
+	// M-Bus lines, checked in the order they have at the end of p1_matchlist
+	t = &p1_matchlist[P1MATCH_DEVTYPE];
+	if (m_p1_mbus_type == P1MBusType::deviceType_Unknown)
+	{
+		// skip matches with any other m-bus lines - we need to find the M0-Bus channel first
+		if (P1LineStartsWithChannelKey(pLine, len, pLine, t->key))
+			return t;
+		return nullptr;
+	}
+
+	t = &p1_matchlist[P1MATCH_MBUS];
+	// verify that 'tariff' indicator is either 1 (Nld) or 3 (Bel)
+	const bool bTariffOK = (len > 9) && ((pLine[9] & 0xFD) == 0x31);
+	if (P1LineStartsWithChannelKey(pLine, len, m_gasprefix.c_str(), t->key))
+	{
+		if (bTariffOK)
+			return t;
+	}
+	else
+	{
+		for (const auto &itt : m_mbus_devices)
 		{
-			if (bFound)
-				break;
+			if ((P1LineStartsWithChannelKey(pLine, len, itt.second.prefix.c_str(), t->key)) && (bTariffOK))
+				return t;
+		}
+	}
+	if (m_p1version >= 4)
+		return nullptr; // skip matches with any DSMR v2 gas lines
 
-			std::string sValue;
+	t = &p1_matchlist[P1MATCH_LINE17];
+	if (P1LineStartsWithChannelKey(pLine, len, m_gasprefix.c_str(), t->key))
+	{
+		m_linecount = 17;
+		return t;
+	}
+	t = &p1_matchlist[P1MATCH_LINE18];
+	if ((m_linecount == 18) && (P1LineStartsWith(pLine, len, t->key, strlen(t->key))))
+		return t;
+	return nullptr;
+}
 
-			const P1Match* t = &p1_matchlist[i];
-			switch (t->matchtype)
-			{
-			case _eP1MatchType::ID:
-				// start of data
-				if (strncmp(t->key, l_buffer, strlen(t->key)) == 0)
-				{
-					m_linecount = 1;
-					bFound = true;
-				}
-				continue; // we do not process anything else on this line
-				break;
-			case _eP1MatchType::EXCLMARK:
-				// end of data
-				if (strncmp(t->key, l_buffer, strlen(t->key)) == 0)
-				{
-					l_exclmarkfound = 1;
-					bFound = true;
-				}
-				break;
-			case _eP1MatchType::STD:
-				if (strncmp(t->key, l_buffer, strlen(t->key)) == 0)
-					bFound = true;
-				break;
-			case _eP1MatchType::DEVTYPE:
-				if (m_p1_mbus_type == P1MBusType::deviceType_Unknown)
-				{
-					const char* pValue = t->key + 3;
-					if (strncmp(pValue, l_buffer + 3, strlen(t->key) - 3) == 0)
-						bFound = true;
-					else
-						i += 100; // skip matches with any other m-bus lines - we need to find the M0-Bus channel first
-				}
-				break;
-			case _eP1MatchType::MBUS:
-				if (strncmp((m_gasprefix + (t->key + 3)).c_str(), l_buffer, strlen(t->key)) == 0)
-				{
-					// verify that 'tariff' indicator is either 1 (Nld) or 3 (Bel)
-					if ((l_buffer[9] & 0xFD) == 0x31)
-						bFound = true;
-				}
-				else
-				{
-					for (const auto& itt : m_mbus_devices)
-					{
-						if (strncmp((itt.second.prefix + (t->key + 3)).c_str(), l_buffer, strlen(t->key)) == 0)
-						{
-							// verify that 'tariff' indicator is either 1 (Nld) or 3 (Bel)
-							if ((l_buffer[9] & 0xFD) == 0x31)
-								bFound = true;
-						}
-					}
-				}
-				if (m_p1version >= 4)
-					i += 100; // skip matches with any DSMR v2 gas lines
-				break;
-			case _eP1MatchType::LINE17:
-				if (strncmp((m_gasprefix + (t->key + 3)).c_str(), l_buffer, strlen(t->key)) == 0)
-				{
-					m_linecount = 17;
-					bFound = true;
-				}
-				break;
-			case _eP1MatchType::LINE18:
-				if ((m_linecount == 18) && (strncmp(t->key, l_buffer, strlen(t->key)) == 0))
-					bFound = true;
-				break;
-			} //switch
+bool P1MeterBase::MatchLine(const char *pLine, const size_t len)
+{
+	try {
+		if ((len < 1) || (pLine[0] == 0x0a))
+			return true; //null value (startup)
 
-			if (!bFound)
-				continue;
+		const P1Match *t = FindMatch(pLine, len);
+		if (t != nullptr)
+		{
+			std::string sValue;
 
 			if (l_exclmarkfound)
 			{
@@ -667,19 +527,18 @@ bool P1MeterBase::MatchLine()
 			}
 			else
 			{
-				std::string vString = l_buffer + t->start;
-
-				size_t ePos = vString.find_first_of("*)");
-				if (ePos == std::string::npos)
+				const char *pValue = nullptr;
+				size_t ePos = 0;
+				if (!P1GetLineValue(pLine, len, t->start, pValue, ePos))
 				{
 					// invalid message: value not delimited
-					Log(LOG_NORM, "Dismiss incoming - value is not delimited in line \"%s\"", l_buffer);
+					Log(LOG_NORM, "Dismiss incoming - value is not delimited in line \"%.*s\"", static_cast<int>(len), pLine);
 					return false;
 				}
 
 				if (ePos > 0)
 				{
-					sValue = vString.substr(0, ePos);
+					sValue.assign(pValue, ePos);
 #ifdef _DEBUG
 					Log(LOG_NORM, "Key: %s, Value: %s", t->topic, sValue.c_str());
 #endif
@@ -717,7 +576,7 @@ bool P1MeterBase::MatchLine()
 					break;
 				case P1TYPE_MBUSDEVICETYPE:
 					mbus_type = (P1MBusType)std::stoul(sValue);
-					mbus_channel = l_buffer[2];
+					mbus_channel = pLine[2];
 					//Open Metering System Specification 4.3.3 table 2 (Device Types of OMS-Meter)
 					/*
 					* Electricity meter 02h
@@ -740,7 +599,7 @@ bool P1MeterBase::MatchLine()
 					{
 						if (m_gasmbuschannel == 0)
 						{
-							m_gasmbuschannel = (char)l_buffer[2];
+							m_gasmbuschannel = (char)pLine[2];
 							if (m_gasprefix[2] == 'n')
 								Log(LOG_STATUS, "Found gas meter on M-Bus channel %c", m_gasmbuschannel);
 							m_gasprefix[2] = m_gasmbuschannel;
@@ -756,9 +615,9 @@ bool P1MeterBase::MatchLine()
 								{
 									//new
 									_tMBusDevice mdevice;
-									mdevice.channel = l_buffer[2] - 0x30;
+									mdevice.channel = pLine[2] - 0x30;
 									mdevice.name = itt.name;
-									mdevice.prefix[2] = (char)l_buffer[2];
+									mdevice.prefix[2] = (char)pLine[2];
 									m_mbus_devices[mbus_type] = mdevice;
 									Log(LOG_STATUS, "Found '%s' meter on M-Bus channel %c", itt.name, mdevice.channel);
 								}
@@ -766,11 +625,11 @@ bool P1MeterBase::MatchLine()
 						}
 					}
 					m_p1_mbus_type = mbus_type;
-					m_p1_mbus_channel = l_buffer[2];
+					m_p1_mbus_channel = pLine[2];
 					break;
 				case P1TYPE_POWERUSAGE:
 					temp_usage = (unsigned long)(std::stof(sValue) * 1000.0F);
-					if ((l_buffer[8] & 0xFE) == 0x30)
+					if ((pLine[8] & 0xFE) == 0x30)
 					{
 						// map tariff IDs 0 (Lux) and 1 (Bel, Nld) both to powerusage1
 						if (!m_power.powerusage1 || m_p1version >= 4)
@@ -778,7 +637,7 @@ bool P1MeterBase::MatchLine()
 						else if (temp_usage - m_power.powerusage1 < P1MAXPHASEPOWER)
 							m_power.powerusage1 = temp_usage;
 					}
-					else if (l_buffer[8] == 0x32)
+					else if (pLine[8] == 0x32)
 					{
 						if (!m_power.powerusage2 || m_p1version >= 4)
 							m_power.powerusage2 = temp_usage;
@@ -788,7 +647,7 @@ bool P1MeterBase::MatchLine()
 					break;
 				case P1TYPE_POWERDELIV:
 					temp_usage = (unsigned long)(std::stof(sValue) * 1000.0F);
-					if ((l_buffer[8] & 0xFE) == 0x30)
+					if ((pLine[8] & 0xFE) == 0x30)
 					{
 						// map tariff IDs 0 (Lux) and 1 (Bel, Nld) both to powerdeliv1
 						if (!m_power.powerdeliv1 || m_p1version >= 4)
@@ -796,7 +655,7 @@ bool P1MeterBase::MatchLine()
 						else if (temp_usage - m_power.powerdeliv1 < P1MAXPHASEPOWER)
 							m_power.powerdeliv1 = temp_usage;
 					}
-					else if (l_buffer[8] == 0x32)
+					else if (pLine[8] == 0x32)
 					{
 						if (!m_power.powerdeliv2 || m_p1version >= 4)
 							m_power.powerdeliv2 = temp_usage;
@@ -940,17 +799,17 @@ bool P1MeterBase::MatchLine()
 				if (ePos > 0 && (sValue.size() != ePos))
 				{
 					// invalid message: value is not a number
-					Log(LOG_NORM, "Dismiss incoming - value in line \"%s\" is not a number", l_buffer);
+					Log(LOG_NORM, "Dismiss incoming - value in line \"%.*s\" is not a number", static_cast<int>(len), pLine);
 					return false;
 				}
 
 				if (t->type == P1TYPE_MBUSUSAGEDSMR4)
 				{
 					// need to get timestamp from this line as well
-					vString = l_buffer + 11;
+					const std::string vString(pLine + 11, std::min<size_t>(len - 11, 13));
 					if (m_p1_mbus_type == P1MBusType::deviceType_Gas)
 					{
-						m_gastimestamp = vString.substr(0, 13);
+						m_gastimestamp = vString;
 #ifdef _DEBUG
 						Log(LOG_NORM, "Key: gastimestamp, Value: %s", m_gastimestamp.c_str());
 #endif
@@ -961,7 +820,7 @@ bool P1MeterBase::MatchLine()
 						{
 							if (itt.first == m_p1_mbus_type)
 							{
-								itt.second.timestamp = vString.substr(0, 13);
+								itt.second.timestamp = vString;
 #ifdef _DEBUG
 								Log(LOG_NORM, "Key: %s timestamp value: %s", itt.second.name.c_str(), itt.second.timestamp.c_str());
 #endif
@@ -987,12 +846,15 @@ bool P1MeterBase::MatchLine()
 /	and including the message starting character '/' upto and including the message
 /	end character '!'. According to the specs the CRC is a 16bit checksum using the
 /	polynomial x^16 + x^15 + x^2 + 1, however input/output are reflected.
+/
+/	The CRC of the message is calculated while the message is received (m_telegramcrc),
+/	pLine is the line holding the end character and the CRC value.
 */
 
-bool P1MeterBase::CheckCRC()
+bool P1MeterBase::CheckCRC(const char *pLine, const size_t len)
 {
 	// sanity checks
-	if (l_buffer[1] == 0)
+	if (len < 2)
 	{
 		if (m_p1version == 0)
 		{
@@ -1003,7 +865,7 @@ bool P1MeterBase::CheckCRC()
 		return true;
 	}
 
-	if (l_buffer[5] != 0)
+	if (len > 5)
 	{
 		// trailing characters after CRC
 		Log(LOG_NORM, "Dismiss incoming - CRC value in message has trailing characters");
@@ -1018,21 +880,15 @@ bool P1MeterBase::CheckCRC()
 
 	// retrieve CRC from the current line
 	char crc_str[5];
-	strncpy(crc_str, l_buffer + 1, 4);
-	crc_str[4] = 0;
+	memcpy(crc_str, pLine + 1, len - 1);
+	crc_str[len - 1] = 0;
 	uint16_t m_crc16 = (uint16_t)strtoul(crc_str, nullptr, 16);
 
-	// calculate CRC
-	uint16_t crc = 0;
-	for (int ii = 0; ii < m_bufferpos; ii++)
-	{
-		crc = (crc >> 8) ^ p1_crc_16[(crc ^ m_buffer[ii]) & 0xFF];
-	}
-	if (crc != m_crc16)
+	if (m_telegramcrc != m_crc16)
 	{
 		Log(LOG_NORM, "Dismiss incoming - CRC failed");
 	}
-	return (crc == m_crc16);
+	return (m_telegramcrc == m_crc16);
 }
 
 void P1MeterBase::SendTextSensorWhenDifferent(const int ID, const int value, int& cmp_value, const std::string& Name)
@@ -1172,9 +1028,8 @@ void P1MeterBase::ParseP1Data(const uint8_t* pDataIn, const int LenIn, const boo
 				try
 				{
 					//We have a complete Telegram
-					std::string iv, cipherText;
+					std::string iv;
 					iv.reserve(m_systemTitle.size() + 4);
-					cipherText.reserve(m_dataPayload.size() + GCMTagLength);
 
 					iv.append(m_systemTitle.begin(), m_systemTitle.end());
 					iv.append(1, (m_frameCounter & 0xFF000000) >> 24);
@@ -1182,10 +1037,7 @@ void P1MeterBase::ParseP1Data(const uint8_t* pDataIn, const int LenIn, const boo
 					iv.append(1, (m_frameCounter & 0x0000FF00) >> 8);
 					iv.append(1, m_frameCounter & 0x000000FF);
 
-					cipherText.append(m_dataPayload.begin(), m_dataPayload.end());
-					cipherText.append(m_gcmTag.begin(), m_gcmTag.end());
-
-					size_t neededDecryptBufferSize = std::min(2048, static_cast<int>(cipherText.size() + 16));
+					size_t neededDecryptBufferSize = std::min(2048, static_cast<int>(m_dataPayload.size() + GCMTagLength + 16));
 					if (neededDecryptBufferSize > m_DecryptBufferSize)
 					{
 						delete[] m_pDecryptBuffer;
@@ -1195,25 +1047,34 @@ void P1MeterBase::ParseP1Data(const uint8_t* pDataIn, const int LenIn, const boo
 						if (m_pDecryptBuffer == nullptr)
 							return;
 					}
-					memset(m_pDecryptBuffer, 0, m_DecryptBufferSize);
 
-					EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-					if (ctx == nullptr)
-						return;
-					EVP_DecryptInit_ex(ctx, EVP_aes_128_gcm(), nullptr, nullptr, nullptr);
-					EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, iv.size(), nullptr);
-
-					EVP_DecryptInit_ex(ctx, nullptr, nullptr, (const unsigned char*)m_szHexKey.data(),
-						(const unsigned char*)iv.c_str());
+					// The cipher context (and with it the expanded key) is set up once, every telegram only brings a new IV
+					const unsigned char *pKey = nullptr;
+					if (m_pDecryptCtx == nullptr)
+					{
+						m_pDecryptCtx = EVP_CIPHER_CTX_new();
+						if (m_pDecryptCtx == nullptr)
+							return;
+						EVP_DecryptInit_ex(m_pDecryptCtx, EVP_aes_128_gcm(), nullptr, nullptr, nullptr);
+						m_DecryptIvLength = 0;
+						pKey = (const unsigned char*)m_szHexKey.data();
+					}
+					if (iv.size() != m_DecryptIvLength)
+					{
+						EVP_CIPHER_CTX_ctrl(m_pDecryptCtx, EVP_CTRL_AEAD_SET_IVLEN, iv.size(), nullptr);
+						m_DecryptIvLength = iv.size();
+					}
+					EVP_DecryptInit_ex(m_pDecryptCtx, nullptr, nullptr, pKey, (const unsigned char*)iv.c_str());
 
 					int outlen = 0;
 					// std::vector<char> m_szDecodeAdd = HexToBytes(_szDecodeAdd);
 					// EVP_DecryptUpdate(ctx, nullptr, &outlen, (const uint8_t*)m_szDecodeAdd.data(),
 					// m_szDecodeAdd.size());
-					EVP_DecryptUpdate(ctx, (uint8_t*)m_pDecryptBuffer, &outlen, (uint8_t*)cipherText.c_str(), cipherText.size());
-					EVP_CIPHER_CTX_free(ctx);
+					// The GCM tag is not verified, only the payload needs to be decrypted
+					EVP_DecryptUpdate(m_pDecryptCtx, (uint8_t*)m_pDecryptBuffer, &outlen, (const uint8_t*)m_dataPayload.data(), static_cast<int>(m_dataPayload.size()));
 					if (outlen <= 0)
 						return;
+					m_pDecryptBuffer[outlen] = 0;
 					/*
 										CryptoPP::GCM< CryptoPP::AES >::Decryption decryptor;
 										decryptor.SetKeyWithIV((uint8_t*)m_szHexKey.data(), 16, (uint8_t*)iv.c_str(), 12);
@@ -1237,35 +1098,36 @@ void P1MeterBase::ParseP1Data(const uint8_t* pDataIn, const int LenIn, const boo
 	int ii = 0;
 	m_ratelimit = ratelimit;
 	// a new message should not start with an empty line, but just in case it does (crude check is sufficient here)
-	while ((m_linecount == 0) && (pData[ii] < 0x10))
+	while ((ii < LenIn) && (m_linecount == 0) && (pData[ii] < 0x10))
 	{
 		ii++;
 	}
 
 	// re enable reading pData when a new message starts, empty buffers
-	if (pData[ii] == 0x2f)
+	if ((ii < LenIn) && (pData[ii] == 0x2f))
 	{
-		if ((l_buffer[0] == 0x21) && !l_exclmarkfound && (m_linecount > 0))
+		if ((l_bufferpos > 0) && (l_buffer[0] == 0x21) && !l_exclmarkfound && (m_linecount > 0))
 		{
 			Log(LOG_STATUS, "WARNING: got new message but buffer still contains unprocessed data from previous message.");
-			l_buffer[l_bufferpos] = 0;
-			if (disable_crc || CheckCRC())
+			if (disable_crc || CheckCRC(l_buffer, l_bufferpos))
 			{
-				MatchLine();
+				MatchLine(l_buffer, l_bufferpos);
 			}
 		}
 		m_linecount = 1;
 		l_bufferpos = 0;
 		m_bufferpos = 0;
+		m_telegramcrc = 0;
 		m_exclmarkfound = 0;
 		m_p1_mbus_type = P1MBusType::deviceType_Unknown;
 	}
 
-	// assemble complete message in message buffer
-	while ((ii < Len) && (m_linecount > 0) && (!m_exclmarkfound) && (m_bufferpos < sizeof(m_buffer)))
+	// measure the complete message and calculate its CRC
+	while ((ii < Len) && (m_linecount > 0) && (!m_exclmarkfound) && (m_bufferpos < P1_MAX_TELEGRAM_SIZE))
 	{
 		const unsigned char c = pData[ii];
-		m_buffer[m_bufferpos] = c;
+		if (!disable_crc)
+			m_telegramcrc = (m_telegramcrc >> 8) ^ p1_crc_16[(m_telegramcrc ^ c) & 0xFF];
 		m_bufferpos++;
 		if (c == 0x21)
 		{
@@ -1278,7 +1140,7 @@ void P1MeterBase::ParseP1Data(const uint8_t* pDataIn, const int LenIn, const boo
 		}
 	}
 
-	if (m_bufferpos == sizeof(m_buffer))
+	if (m_bufferpos == P1_MAX_TELEGRAM_SIZE)
 	{
 		// discard oversized message
 		if ((Len > 400) || (pData[0] == 0x21))
@@ -1291,45 +1153,69 @@ void P1MeterBase::ParseP1Data(const uint8_t* pDataIn, const int LenIn, const boo
 	}
 
 	// read pData, ignore/stop if there is a message validation failure
+	// complete lines are matched in place, only a line that is split over two calls is assembled in l_buffer
 	ii = 0;
 	while ((ii < Len) && (m_linecount > 0))
 	{
-		const unsigned char c = pData[ii];
-		ii++;
-		if (c == 0x0d)
+		const uint8_t *pLF = (const uint8_t *)memchr(pData + ii, 0x0a, Len - ii);
+		const int lineEnd = (pLF != nullptr) ? static_cast<int>(pLF - pData) : Len;
+
+		int contentEnd = lineEnd;
+		while ((contentEnd > ii) && (pData[contentEnd - 1] == 0x0d))
 		{
 			m_CRfound = 1;
-			continue;
+			contentEnd--;
 		}
 
-		if (c == 0x0a)
+		const char *pLine;
+		size_t lineLen;
+		if ((pLF != nullptr) && (l_bufferpos == 0) && (memchr(pData + ii, 0x0d, contentEnd - ii) == nullptr))
+		{
+			pLine = (const char *)pData + ii;
+			lineLen = contentEnd - ii;
+		}
+		else
 		{
-			// close string, parse line and clear it.
-			m_linecount++;
-			if ((l_bufferpos > 0) && (l_bufferpos < sizeof(l_buffer)))
+			for (int jj = ii; jj < contentEnd; jj++)
 			{
-				// don't try to match empty or oversized lines
-				l_buffer[l_bufferpos] = 0;
-				if (l_buffer[0] == 0x21 && !disable_crc)
+				const unsigned char c = pData[jj];
+				if (c == 0x0d)
 				{
-					if (!CheckCRC())
-					{
-						m_linecount = 0;
-						return;
-					}
+					m_CRfound = 1;
+					continue;
 				}
-				if (!MatchLine())
+				if (l_bufferpos < sizeof(l_buffer))
 				{
-					// discard message
-					m_linecount = 0;
+					l_buffer[l_bufferpos] = c;
+					l_bufferpos++;
 				}
 			}
-			l_bufferpos = 0;
+			if (pLF == nullptr)
+				break; // rest of the line follows with the next call
+			pLine = l_buffer;
+			lineLen = l_bufferpos;
 		}
-		else if (l_bufferpos < sizeof(l_buffer))
+		ii = lineEnd + 1;
+
+		// parse line and clear it.
+		m_linecount++;
+		if ((lineLen > 0) && (lineLen < sizeof(l_buffer)))
 		{
-			l_buffer[l_bufferpos] = c;
-			l_bufferpos++;
+			// don't try to match empty or oversized lines
+			if (pLine[0] == 0x21 && !disable_crc)
+			{
+				if (!CheckCRC(pLine, lineLen))
+				{
+					m_linecount = 0;
+					return;
+				}
+			}
+			if (!MatchLine(pLine, lineLen))
+			{
+				// discard message
+				m_linecount = 0;
+			}
 		}
+		l_bufferpos = 0;
 	}
 }
@@ -3,6 +3,11 @@
 #include "DomoticzHardware.h"
 #include "hardwaretypes.h"
 
+#define P1_MAX_TELEGRAM_SIZE 1400
+
+struct P1Match;
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
 class P1MeterBase : public CDomoticzHardwareBase
 {
 	friend class P1MeterSerial;
@@ -89,10 +94,11 @@ public:
 
 private:
 	void Init();
-	bool MatchLine();
+	const P1Match *FindMatch(const char *pLine, size_t len);
+	bool MatchLine(const char *pLine, size_t len);
 	void ParseP1Data(const uint8_t *pDataIn, int LenIn, bool disable_crc, int ratelimit);
 
-	bool CheckCRC();
+	bool CheckCRC(const char *pLine, size_t len);
 	void SendTextSensorWhenDifferent(const int ID, const int value, int &cmp_value, const std::string &Name);
 
 	bool m_bDisableCRC;
@@ -100,8 +106,8 @@ private:
 
 	unsigned char m_p1version;
 
-	unsigned char m_buffer[1400];
 	int m_bufferpos;
+	uint16_t m_telegramcrc = 0;
 	unsigned char m_exclmarkfound;
 	unsigned char m_linecount;
 	unsigned char m_CRfound;
@@ -202,6 +208,8 @@ private:
 	std::string m_gcmTag;
 	uint8_t *m_pDecryptBuffer = nullptr;
 	size_t m_DecryptBufferSize = 0;
+	EVP_CIPHER_CTX *m_pDecryptCtx = nullptr; // keeps the AES key schedule between telegrams
+	size_t m_DecryptIvLength = 0;
 	void InitP1EncryptionState();
 	bool ParseP1EncryptedData(uint8_t p1_byte);
 };
@@ -0,0 +1,233 @@
+#pragma once
+
+// OBIS references of the DSMR/ESMR P1 telegram and the lookup used by P1MeterBase to dispatch a line.
+// Lines are matched in place, they do not have to be null terminated.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+enum class _eP1MatchType {
+	ID = 0,
+	EXCLMARK,
+	STD,
+	DEVTYPE,
+	MBUS,
+	LINE17,
+	LINE18
+};
+
+#define P1SMID		"/"				// Smart Meter ID. Used to detect start of telegram.
+#define P1VER		"1-3:0.2.8"		// P1 version
+#define P1VERBE		"0-0:96.1.4"	// P1 version + e-MUCS version (Belgium)
+#define P1TS		"0-0:1.0.0"		// Timestamp
+#define P1PUSG		"1-0:1.8."		// total power usage (excluding tariff indicator)
+#define P1PDLV		"1-0:2.8."		// total delivered power (excluding tariff indicator)
+#define P1TIP		"0-0:96.14.0"	// tariff indicator power
+#define P1PUC		"1-0:1.7.0"		// current power usage
+#define P1PDC		"1-0:2.7.0"		// current power delivery
+#define P1NOPF		"0-0:96.7.21"	// Number of power failures in any phases
+#define P1NOLPF		"0-0:96.7.9"	// Number of power failures in any phases
+#define P1NOVSGL1	"1-0:32.32.0"	// Number of voltage sags in phase L1
+#define P1NOVSGL2	"1-0:52.32.0"	// Number of voltage sags in phase L2
+#define P1NOVSGL3	"1-0:72.32.0"	// Number of voltage sags in phase L3
+#define P1NOVSWL1	"1-0:32.36.0"	// Number of voltage swells in phase L1
+#define P1NOVSWL2	"1-0:52.36.0"	// Number of voltage swells in phase L2
+#define P1NOVSWL3	"1-0:72.36.0"	// Number of voltage swells in phase L3
+#define P1VOLTL1	"1-0:32.7.0"	// voltage L1 (DSMRv5)
+#define P1VOLTL2	"1-0:52.7.0"	// voltage L2 (DSMRv5)
+#define P1VOLTL3	"1-0:72.7.0"	// voltage L3 (DSMRv5)
+#define P1AMPEREL1	"1-0:31.7.0"	// amperage L1 (DSMRv5)
+#define P1AMPEREL2	"1-0:51.7.0"	// amperage L2 (DSMRv5)
+#define P1AMPEREL3	"1-0:71.7.0"	// amperage L3 (DSMRv5)
+#define P1POWUSL1	"1-0:21.7.0"	// Power used L1 (DSMRv5)
+#define P1POWUSL2	"1-0:41.7.0"	// Power used L2 (DSMRv5)
+#define P1POWUSL3	"1-0:61.7.0"	// Power used L3 (DSMRv5)
+#define P1POWDLL1	"1-0:22.7.0"	// Power delivered L1 (DSMRv5)
+#define P1POWDLL2	"1-0:42.7.0"	// Power delivered L2 (DSMRv5)
+#define P1POWDLL3	"1-0:62.7.0"	// Power delivered L3 (DSMRv5)
+#define P1GTS		"0-n:24.3.0"	// DSMR2 timestamp gas usage sample
+#define P1GUDSMR2	"("				// DSMR2 gas usage sample
+#define P1MUDSMR4	"0-n:24.2."		// DSMR4 mbus value (excluding 'tariff' indicator)
+#define P1MBTYPE	"0-n:24.1.0"	// M-Bus device type
+#define P1EOT		"!"				// End of telegram.
+
+enum _eP1Type {
+	P1TYPE_SMID = 0,
+	P1TYPE_END,
+	P1TYPE_VERSION,
+	P1TYPE_POWERUSAGE,
+	P1TYPE_POWERDELIV,
+	P1TYPE_USAGECURRENT,
+	P1TYPE_DELIVCURRENT,
+	P1TYPE_NUMPWRFAIL,
+	P1TYPE_NUMLONGPWRFAIL,
+	P1TYPE_NUMVOLTSAGSL1,
+	P1TYPE_NUMVOLTSAGSL2,
+	P1TYPE_NUMVOLTSAGSL3,
+	P1TYPE_NUMVOLTSWELLSL1,
+	P1TYPE_NUMVOLTSWELLSL2,
+	P1TYPE_NUMVOLTSWELLSL3,
+	P1TYPE_VOLTAGEL1,
+	P1TYPE_VOLTAGEL2,
+	P1TYPE_VOLTAGEL3,
+	P1TYPE_AMPERAGEL1,
+	P1TYPE_AMPERAGEL2,
+	P1TYPE_AMPERAGEL3,
+	P1TYPE_POWERUSEL1,
+	P1TYPE_POWERUSEL2,
+	P1TYPE_POWERUSEL3,
+	P1TYPE_POWERDELL1,
+	P1TYPE_POWERDELL2,
+	P1TYPE_POWERDELL3,
+	P1TYPE_MBUSDEVICETYPE,
+	P1TYPE_MBUSUSAGEDSMR4,
+	P1TYPE_GASTIMESTAMP,
+	P1TYPE_GASUSAGE
+};
+
+struct P1Match
+{
+	_eP1MatchType matchtype;
+	_eP1Type type;
+	const char* key;
+	const char* topic;
+	uint8_t start;
+	uint8_t width;
+};
+
+constexpr std::array<P1Match, 32> p1_matchlist{
+	{
+		{ _eP1MatchType::ID, P1TYPE_SMID, P1SMID, "", 0, 0 },
+		{ _eP1MatchType::EXCLMARK, P1TYPE_END, P1EOT, "", 0, 0 },
+		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VER, "version", 10, 2 },
+		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VERBE, "versionBE", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSAGE, P1PUSG, "powerusage", 10, 9 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELIV, P1PDLV, "powerdeliv", 10, 9 },
+		{ _eP1MatchType::STD, P1TYPE_USAGECURRENT, P1PUC, "powerusagec", 10, 7 },
+		{ _eP1MatchType::STD, P1TYPE_DELIVCURRENT, P1PDC, "powerdelivc", 10, 7 },
+		{ _eP1MatchType::STD, P1TYPE_NUMPWRFAIL, P1NOPF, "numpwrfail", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMLONGPWRFAIL, P1NOLPF, "numlongpwrfail", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL1, P1NOVSGL1, "numvoltsagsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL2, P1NOVSGL2, "numvoltsagsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL3, P1NOVSGL3, "numvoltsagsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL1, P1NOVSWL1, "numvoltswellsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL2, P1NOVSWL2, "numvoltswellsl2", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL3, P1NOVSWL3, "numvoltswellsl3", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL1, P1VOLTL1, "voltagel1", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL2, P1VOLTL2, "voltagel2", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL3, P1VOLTL3, "voltagel3", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL1, P1AMPEREL1, "amperagel1", 11, 3 },
+		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL2, P1AMPEREL2, "amperagel2", 11, 3 },
+		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL3, P1AMPEREL3, "amperagel3", 11, 3 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSEL1, P1POWUSL1, "powerusel1", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSEL2, P1POWUSL2, "powerusel2", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSEL3, P1POWUSL3, "powerusel3", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELL1, P1POWDLL1, "powerdell1", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELL2, P1POWDLL2, "powerdell2", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELL3, P1POWDLL3, "powerdell3", 11, 6 },
+		{ _eP1MatchType::DEVTYPE, P1TYPE_MBUSDEVICETYPE, P1MBTYPE, "mbusdevicetype", 11, 3 },
+		{ _eP1MatchType::MBUS, P1TYPE_MBUSUSAGEDSMR4, P1MUDSMR4, "mbus_meter", 26, 8 },
+		// must keep DEVTYPE, GAS, LINE17 and LINE18 in this order at end of p1_matchlist
+		{ _eP1MatchType::LINE17, P1TYPE_GASTIMESTAMP, P1GTS, "gastimestamp", 11, 12 },
+		{ _eP1MatchType::LINE18, P1TYPE_GASUSAGE, P1GUDSMR2, "gasusage", 1, 9 },
+	}
+};
+
+// Fixed positions of the entries that are not looked up through the STD index
+#define P1MATCH_ID		0
+#define P1MATCH_EXCLMARK	1
+#define P1MATCH_DEVTYPE		(p1_matchlist.size() - 4)
+#define P1MATCH_MBUS		(p1_matchlist.size() - 3)
+#define P1MATCH_LINE17		(p1_matchlist.size() - 2)
+#define P1MATCH_LINE18		(p1_matchlist.size() - 1)
+
+static_assert(p1_matchlist[P1MATCH_ID].matchtype == _eP1MatchType::ID, "p1_matchlist must start with ID");
+static_assert(p1_matchlist[P1MATCH_EXCLMARK].matchtype == _eP1MatchType::EXCLMARK, "p1_matchlist must start with ID, EXCLMARK");
+static_assert(p1_matchlist[P1MATCH_DEVTYPE].matchtype == _eP1MatchType::DEVTYPE, "p1_matchlist must end with DEVTYPE, MBUS, LINE17, LINE18");
+static_assert(p1_matchlist[P1MATCH_MBUS].matchtype == _eP1MatchType::MBUS, "p1_matchlist must end with DEVTYPE, MBUS, LINE17, LINE18");
+static_assert(p1_matchlist[P1MATCH_LINE17].matchtype == _eP1MatchType::LINE17, "p1_matchlist must end with DEVTYPE, MBUS, LINE17, LINE18");
+static_assert(p1_matchlist[P1MATCH_LINE18].matchtype == _eP1MatchType::LINE18, "p1_matchlist must end with DEVTYPE, MBUS, LINE17, LINE18");
+
+// Compares a key with the start of a line, like strncmp(key, line, strlen(key)) on a null terminated line
+inline bool P1LineStartsWith(const char *pLine, const size_t len, const char *key, const size_t keylen)
+{
+	return (keylen <= len) && (memcmp(pLine, key, keylen) == 0);
+}
+
+// M-Bus keys are written as "0-n:...", the line has to start with prefix (the 3 character channel prefix) instead of "0-n"
+inline bool P1LineStartsWithChannelKey(const char *pLine, const size_t len, const char *prefix, const char *key)
+{
+	const size_t keylen = strlen(key);
+	return (keylen <= len) && (memcmp(pLine, prefix, 3) == 0) && (memcmp(pLine + 3, key + 3, keylen - 3) == 0);
+}
+
+// The STD entries of p1_matchlist sorted by key. No key is a prefix of another key, so the only key
+// that can match a line is the greatest key that does not sort after the line (a binary search instead
+// of a strncmp on every entry).
+struct P1StdKeyIndex
+{
+	std::array<const P1Match *, p1_matchlist.size()> entries;
+	std::array<size_t, p1_matchlist.size()> keylen;
+	size_t count = 0;
+};
+
+inline const P1StdKeyIndex &P1GetStdKeyIndex()
+{
+	static const P1StdKeyIndex index = [] {
+		P1StdKeyIndex idx;
+		for (const auto &match : p1_matchlist)
+		{
+			if (match.matchtype == _eP1MatchType::STD)
+				idx.entries[idx.count++] = &match;
+		}
+		std::sort(idx.entries.begin(), idx.entries.begin() + idx.count, [](const P1Match *a, const P1Match *b) { return strcmp(a->key, b->key) < 0; });
+		for (size_t ii = 0; ii < idx.count; ii++)
+			idx.keylen[ii] = strlen(idx.entries[ii]->key);
+		return idx;
+	}();
+	return index;
+}
+
+inline const P1Match *P1FindStdMatch(const char *pLine, const size_t len)
+{
+	const P1StdKeyIndex &index = P1GetStdKeyIndex();
+	size_t lo = 0;
+	size_t hi = index.count;
+	while (lo < hi)
+	{
+		const size_t mid = (lo + hi) / 2;
+		const size_t keylen = index.keylen[mid];
+		int cmp = memcmp(index.entries[mid]->key, pLine, std::min(keylen, len));
+		if ((cmp == 0) && (keylen > len))
+			cmp = 1;
+		if (cmp <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == 0)
+		return nullptr;
+	lo--;
+	if (!P1LineStartsWith(pLine, len, index.entries[lo]->key, index.keylen[lo]))
+		return nullptr;
+	return index.entries[lo];
+}
+
+// Finds the value that starts at position start of the line and ends at '*' or ')'.
+// Returns false when the value is not delimited.
+inline bool P1GetLineValue(const char *pLine, const size_t len, const size_t start, const char *&pValue, size_t &valuelen)
+{
+	if (start > len)
+		return false;
+	for (size_t ii = start; ii < len; ii++)
+	{
+		if ((pLine[ii] == '*') || (pLine[ii] == ')'))
+		{
+			pValue = pLine + start;
+			valuelen = ii - start;
+			return true;
+		}
+	}
+	return false;
+}
@@ -538,6 +538,40 @@ namespace http {
 				}
 			}
 		}
+
+		void CWebServer::Cmd_GetPluginStats(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; // Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetPluginStats";
+
+			Plugins::CPluginSystem Plugins;
+			std::lock_guard<std::mutex> l(Plugins::PluginMutex);
+			int ii = 0;
+			for (const auto &itt : *Plugins.GetHardware())
+			{
+				Plugins::CPlugin *pPlugin = dynamic_cast<Plugins::CPlugin *>(itt.second);
+				if (!pPlugin)
+					continue;
+				Plugins::CPlugin::_tQueueStatistics stats;
+				pPlugin->GetQueueStatistics(stats);
+				root["result"][ii]["idx"] = itt.first;
+				root["result"][ii]["name"] = pPlugin->m_Name;
+				root["result"][ii]["key"] = pPlugin->m_PluginKey;
+				root["result"][ii]["queued"] = (Json::UInt64)stats.Queued;
+				root["result"][ii]["delayed"] = (Json::UInt64)stats.Delayed;
+				root["result"][ii]["processed"] = (Json::UInt64)stats.Processed;
+				root["result"][ii]["avg_wait_ms"] = (stats.Processed > 0) ? round_digits(double(stats.TotalWaitUs) / double(stats.Processed) / 1000.0, 3) : 0.0;
+				root["result"][ii]["max_wait_ms"] = round_digits(double(stats.MaxWaitUs) / 1000.0, 3);
+				root["result"][ii]["avg_callback_ms"] = (stats.Processed > 0) ? round_digits(double(stats.TotalProcessUs) / double(stats.Processed) / 1000.0, 3) : 0.0;
+				root["result"][ii]["max_callback_ms"] = round_digits(double(stats.MaxProcessUs) / 1000.0, 3);
+				ii++;
+			}
+		}
 	} // namespace server
 } // namespace http
 #endif
@@ -22,6 +22,7 @@ namespace Plugins {
 	  int m_Unit;
 	  bool m_Delay;
 	  time_t m_When;
+	  std::chrono::steady_clock::time_point m_Queued; // when the message became ready to be processed
 
 	protected:
 		CPluginMessageBase() : m_Unit(-1), m_Delay(false)
@@ -766,6 +766,7 @@ namespace Plugins
 		m_bIsStarted = false;
 		m_bIsStarting = false;
 		m_bTracing = false;
+		m_DelayedSequence = 0;
 	}
 
 	CPlugin::~CPlugin()
@@ -925,13 +926,7 @@ namespace Plugins
 		RequestStart();
 
 		// Flush the message queue (should already be empty)
-		{
-			std::lock_guard<std::mutex> l(m_QueueMutex);
-			while (!m_MessageQueue.empty())
-			{
-				m_MessageQueue.pop_front();
-			}
-		}
+		FlushMessageQueue();
 
 		// Start worker thread
 		try
@@ -975,6 +970,7 @@ namespace Plugins
 			}
 
 			RequestStop();
+			m_QueueCondition.notify_all();
 
 			if (m_bIsStarted)
 			{
@@ -1039,64 +1035,52 @@ namespace Plugins
 	{
 		Log(LOG_STATUS, "Entering work loop.");
 		m_LastHeartbeat = mytime(nullptr);
-		while (!IsStopRequested(50) || !m_bIsStopped)
+		while (!IsStopRequested(0) || !m_bIsStopped)
 		{
-			time_t Now = time(nullptr);
-			bool bProcessed = true;
-			while (bProcessed)
+			// Process all messages that are ready
+			CPluginMessageBase *Message;
+			while ((Message = NextMessage()) != nullptr)
 			{
-				CPluginMessageBase *Message = nullptr;
-				bProcessed = false;
-
-				// Cycle once through the queue looking for the 1st message that is ready to process
+				auto tStart = std::chrono::steady_clock::now();
+				uint64_t WaitUs = std::chrono::duration_cast<std::chrono::microseconds>(tStart - Message->m_Queued).count();
+				try
 				{
-					std::lock_guard<std::mutex> l(m_QueueMutex);
-					for (size_t i = 0; i < m_MessageQueue.size(); i++)
+					if (m_bDebug & PDM_QUEUE)
 					{
-						CPluginMessageBase *FrontMessage = m_MessageQueue.front();
-						m_MessageQueue.pop_front();
-						if (!FrontMessage->m_Delay || FrontMessage->m_When <= Now)
-						{
-							// Message is ready now or was already ready (this is the case for almost all messages)
-							Message = FrontMessage;
-							break;
-						}
-						// Message is for sometime in the future so requeue it (this happens when the 'Delay' parameter is used on a Send)
-						m_MessageQueue.push_back(FrontMessage);
+						Log(LOG_NORM, "Processing '" + std::string(Message->Name()) + "' message");
 					}
+					Message->Process(this);
 				}
-
-				if (Message)
+				catch (...)
 				{
-					bProcessed = true;
-					try
-					{
-						if (m_bDebug & PDM_QUEUE)
-						{
-							Log(LOG_NORM, "Processing '" + std::string(Message->Name()) + "' message");
-						}
-						Message->Process(this);
-					}
-					catch (...)
-					{
-						Log(LOG_ERROR, "Exception processing '%s' message.", Message->Name());
-					}
+					Log(LOG_ERROR, "Exception processing '%s' message.", Message->Name());
+				}
+				uint64_t ProcessUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count();
 
-					// Free the memory for the message
-					if (!m_PyInterpreter)
-					{
-						// Can't lock because there is no interpreter to lock
-						delete Message;
-					}
-					else
-					{
-						AccessPython	Guard(this, Message->Name());
-						delete Message;
-					}
+				// Free the memory for the message
+				if (!m_PyInterpreter)
+				{
+					// Can't lock because there is no interpreter to lock
+					delete Message;
 				}
+				else
+				{
+					AccessPython	Guard(this, Message->Name());
+					delete Message;
+				}
+
+				std::lock_guard<std::mutex> l(m_QueueMutex);
+				m_QueueStats.Processed++;
+				m_QueueStats.TotalWaitUs += WaitUs;
+				m_QueueStats.MaxWaitUs = std::max(m_QueueStats.MaxWaitUs, WaitUs);
+				m_QueueStats.TotalProcessUs += ProcessUs;
+				m_QueueStats.MaxProcessUs = std::max(m_QueueStats.MaxProcessUs, ProcessUs);
 			}
 
-			if (Now >= (m_LastHeartbeat + m_iPollInterval))
+			if (IsStopRequested(0) && m_bIsStopped)
+				break;
+
+			if (mytime(nullptr) >= (m_LastHeartbeat + m_iPollInterval))
 			{
 				//	Add heartbeat to message queue
 				MessagePlugin(new onHeartbeatCallback());
@@ -1119,11 +1103,71 @@ namespace Plugins
 			{
 				Log(LOG_NORM, "Transport vector changed during %s loop, continuing.", __func__);
 			}
+
+			WaitForMessage();
 		}
 
 		Log(LOG_STATUS, "Exiting work loop.");
 	}
 
+	// Returns the next message that is ready to be processed (or nullptr)
+	CPluginMessageBase *CPlugin::NextMessage()
+	{
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+
+		// Delayed messages that are due join the back of the ready queue
+		time_t Now = time(nullptr);
+		while (!m_DelayedQueue.empty() && (m_DelayedQueue.top().When <= Now))
+		{
+			CPluginMessageBase *pMessage = m_DelayedQueue.top().pMessage;
+			m_DelayedQueue.pop();
+			pMessage->m_Queued = std::chrono::steady_clock::now();
+			m_MessageQueue.push_back(pMessage);
+		}
+
+		if (m_MessageQueue.empty())
+			return nullptr;
+		CPluginMessageBase *pMessage = m_MessageQueue.front();
+		m_MessageQueue.pop_front();
+		return pMessage;
+	}
+
+	// Sleeps until a message is queued, a delayed message is due or the next heartbeat.
+	// Wakes at least once a second so connections are still verified regularly
+	void CPlugin::WaitForMessage()
+	{
+		std::unique_lock<std::mutex> l(m_QueueMutex);
+		if (!m_MessageQueue.empty())
+			return;
+
+		time_t WakeUp = m_LastHeartbeat + m_iPollInterval;
+		if (!m_DelayedQueue.empty())
+			WakeUp = std::min(WakeUp, m_DelayedQueue.top().When);
+		auto Deadline = std::min(std::chrono::system_clock::from_time_t(WakeUp), std::chrono::system_clock::now() + std::chrono::seconds(1));
+		m_QueueCondition.wait_until(l, Deadline, [this] { return !m_MessageQueue.empty(); });
+	}
+
+	void CPlugin::FlushMessageQueue()
+	{
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+		while (!m_MessageQueue.empty())
+		{
+			m_MessageQueue.pop_front();
+		}
+		while (!m_DelayedQueue.empty())
+		{
+			m_DelayedQueue.pop();
+		}
+	}
+
+	void CPlugin::GetQueueStatistics(_tQueueStatistics &stats)
+	{
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+		stats = m_QueueStats;
+		stats.Queued = m_MessageQueue.size();
+		stats.Delayed = m_DelayedQueue.size();
+	}
+
 	bool CPlugin::Initialise()
 	{
 		m_bIsStarted = false;
@@ -1967,9 +2011,16 @@ namespace Plugins
 			Log(LOG_NORM, "Pushing '" + std::string(pMessage->Name()) + "' on to queue");
 		}
 
-		// Add message to queue
-		std::lock_guard<std::mutex> l(m_QueueMutex);
-		m_MessageQueue.push_back(pMessage);
+		// Add message to queue, messages sent with a 'Delay' wait in the delay heap until they are due
+		{
+			std::lock_guard<std::mutex> l(m_QueueMutex);
+			pMessage->m_Queued = std::chrono::steady_clock::now();
+			if (pMessage->m_Delay && (pMessage->m_When > time(nullptr)))
+				m_DelayedQueue.push({ pMessage->m_When, m_DelayedSequence++, pMessage });
+			else
+				m_MessageQueue.push_back(pMessage);
+		}
+		m_QueueCondition.notify_one();
 	}
 
 	void CPlugin::DeviceAdded(const std::string DeviceID, int Unit)
@@ -2330,13 +2381,7 @@ namespace Plugins
 		m_bIsStarted = false;
 
 		// Flush the message queue (should already be empty)
-		{
-			std::lock_guard<std::mutex> l(m_QueueMutex);
-			while (!m_MessageQueue.empty())
-			{
-				m_MessageQueue.pop_front();
-			}
-		}
+		FlushMessageQueue();
 
 		m_bIsStopped = true;
 	}
@@ -7,6 +7,8 @@
 #include "../../notifications/NotificationBase.h"
 #include "PythonObjects.h"
 #include "PythonObjectEx.h"
+#include <condition_variable>
+#include <queue>
 
 #ifndef byte
 typedef unsigned char byte;
@@ -41,6 +43,18 @@ namespace Plugins {
 
 	class CPlugin : public CDomoticzHardwareBase
 	{
+	public:
+	  struct _tQueueStatistics
+	  {
+		  size_t Queued = 0;	     // messages ready to be processed
+		  size_t Delayed = 0;	     // messages waiting for their 'Delay' to expire
+		  uint64_t Processed = 0;
+		  uint64_t TotalWaitUs = 0;    // time between becoming ready and being processed
+		  uint64_t MaxWaitUs = 0;
+		  uint64_t TotalProcessUs = 0; // time spent processing, including the Python callback
+		  uint64_t MaxProcessUs = 0;
+	  };
+
 	private:
 		int				m_iPollInterval;
 
@@ -54,15 +68,32 @@ namespace Plugins {
 
 		std::mutex	m_TransportsMutex;
 		std::vector<CPluginTransport*>	m_Transports;
-		std::mutex m_QueueMutex; // controls access to the message queue
-		std::deque<CPluginMessageBase *> m_MessageQueue;
+		struct _tDelayedMessage
+		{
+			time_t When;
+			uint64_t Sequence; // keeps messages that are due at the same time in order of arrival
+			CPluginMessageBase *pMessage;
+			bool operator>(const _tDelayedMessage &other) const
+			{
+				return (When != other.When) ? (When > other.When) : (Sequence > other.Sequence);
+			}
+		};
+		std::mutex m_QueueMutex; // controls access to the message queues
+		std::condition_variable m_QueueCondition; // signalled when a message is queued
+		std::deque<CPluginMessageBase *> m_MessageQueue; // messages that are ready to be processed
+		std::priority_queue<_tDelayedMessage, std::vector<_tDelayedMessage>, std::greater<_tDelayedMessage>> m_DelayedQueue; // messages sent with a 'Delay', earliest first
+		uint64_t m_DelayedSequence;
 
 		std::shared_ptr<std::thread> m_thread;
 
 		bool m_bIsStarting;
 		bool m_bIsStopped;
+		_tQueueStatistics m_QueueStats;
 
 		void Do_Work();
+		CPluginMessageBase *NextMessage();
+		void WaitForMessage();
+		void FlushMessageQueue();
 
 	public:
 	  CPlugin(int HwdID, const std::string &Name, const std::string &PluginKey);
@@ -110,6 +141,7 @@ namespace Plugins {
 	  void onDeviceModified(const std::string DeviceID, int Unit);
 	  void onDeviceRemoved(const std::string DeviceID, int Unit);
 	  void MessagePlugin(CPluginMessageBase *pMessage);
+	  void GetQueueStatistics(_tQueueStatistics &stats);
 	  void DeviceAdded(const std::string DeviceID, int Unit);
 	  void DeviceModified(const std::string DeviceID, int Unit);
 	  void DeviceRemoved(const std::string DeviceID, int Unit);
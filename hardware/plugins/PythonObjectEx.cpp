@@ -862,7 +862,6 @@ namespace Plugins {
 				pModState->pPlugin->Log(LOG_ERROR, "Update to 'UnitEx' failed to update any DeviceStatus records for key %d/%s/%d", pModState->pPlugin->m_HwdID, sDeviceID.c_str(), self->Unit);
 				Py_RETURN_NONE;
 			}
-
 			// Only trigger notifications if a used value is changed
 			if (self->Used)
 			{
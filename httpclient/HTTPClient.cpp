@@ -1,9 +1,12 @@
 #include "stdafx.h"
 #include "HTTPClient.h"
+#include "HTTPClientEngine.h"
 #include <curl/curl.h>
 #include "../main/Logger.h"
+#include "../main/Helper.h"
 
 #include <algorithm>
+#include <future>
 #include <iostream>
 #include <fstream>
 
@@ -27,22 +30,6 @@ std::string	HTTPClient::m_sUserAgent = "domoticz/1.0";
  *									*
  ************************************************************************/
 
-size_t write_curl_headerdata(void *contents, size_t size, size_t nmemb, void *userp) // called once for each header
-{
-	size_t realsize = size * nmemb;
-	std::vector<std::string>* pvHeaderData = (std::vector<std::string>*)userp;
-	pvHeaderData->push_back(std::string((unsigned char*)contents, (std::find((unsigned char*)contents, (unsigned char*)contents + realsize, '\r'))));
-	return realsize;
-}
-
-size_t write_curl_data(void *contents, size_t size, size_t nmemb, void *userp)
-{
-	size_t realsize = size * nmemb;
-	std::vector<unsigned char>* pvHTTPResponse = (std::vector<unsigned char>*)userp;
-	pvHTTPResponse->insert(pvHTTPResponse->end(), (unsigned char*)contents, (unsigned char*)contents + realsize);
-	return realsize;
-}
-
 size_t write_curl_data_file(void *contents, size_t size, size_t nmemb, void *userp)
 {
 	size_t realsize = size * nmemb;
@@ -68,6 +55,10 @@ size_t write_curl_data_single_line(void *contents, size_t size, size_t nmemb, vo
 }
 
 
+// every request is run by the shared transfer engine
+static CHTTPClientEngine s_HTTPClientEngine;
+
+
 /************************************************************************
  *									*
  * Private functions							*
@@ -88,6 +79,7 @@ bool HTTPClient::CheckIfGlobalInitDone()
 
 void HTTPClient::Cleanup()
 {
+	s_HTTPClientEngine.Stop();
 	if (m_bCurlGlobalInitialized)
 	{
 		curl_global_cleanup();
@@ -108,11 +100,27 @@ void HTTPClient::SetGlobalOptions(void *curlobj)
 	curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, m_bVerifyPeer ? 1L : 0);
 	curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, m_bVerifyHost ? 2L : 0); //allow self signed certificates
 	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
 	std::string domocookie = szUserDataFolder + "domocookie.txt";
 	curl_easy_setopt(curl, CURLOPT_COOKIEFILE, domocookie.c_str());
 	curl_easy_setopt(curl, CURLOPT_COOKIEJAR, domocookie.c_str());
 }
 
+// Run a prepared transfer on the shared engine and wait for it to finish
+int HTTPClient::Perform(void *curlobj)
+{
+	CURL *curl = (CURL *)curlobj;
+	std::shared_ptr<std::promise<CURLcode>> done = std::make_shared<std::promise<CURLcode>>();
+	std::future<CURLcode> result = done->get_future();
+	if (!s_HTTPClientEngine.Submit(curl, [done](CURL *, const CURLcode res) { done->set_value(res); }))
+	{
+		CURLcode res = curl_easy_perform(curl);
+		s_HTTPClientEngine.AddStatistics(curl, res);
+		return res;
+	}
+	return result.get();
+}
+
 struct _tHTTPErrors {
 	const uint16_t http_code;
 	const char* szMeaning;
@@ -258,7 +266,7 @@ bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string
 		curl_easy_setopt(curl, CURLOPT_HEADERDATA, &vHeaderData);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 
 		bool bOK = false;
 		if (res == CURLE_OK)
@@ -334,7 +342,7 @@ bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata,
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postdata.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -403,7 +411,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, putdata.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -472,7 +480,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, putdata.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -541,7 +549,7 @@ bool HTTPClient::PatchBinary(const std::string& url, const std::string& putdata,
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, putdata.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -619,7 +627,7 @@ bool HTTPClient::GETBinarySingleLine(const std::string &url, const std::vector<s
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_curl_data_single_line);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 
 		if (
 			(res == CURLE_WRITE_ERROR) &&
@@ -826,7 +834,7 @@ bool HTTPClient::GETBinaryToFile(const std::string &url, const std::string &outp
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_curl_data_file);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&outfile);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-		res = curl_easy_perform(curl);
+		res = (CURLcode)Perform(curl);
 		curl_easy_cleanup(curl);
 
 		outfile.close();
@@ -838,3 +846,87 @@ bool HTTPClient::GETBinaryToFile(const std::string &url, const std::string &outp
 		return false;
 	}
 }
+
+
+/************************************************************************
+ *									*
+ * asynchronous methods							*
+ *									*
+ ************************************************************************/
+
+std::future<HTTPClient::_tHTTPResult> HTTPClient::Async(const _eHTTPmethod method, const std::string &url, const std::string &data, const std::vector<std::string> &ExtraHeaders,
+							const HTTPCallback &callback, const bool bFollowRedirect, const long TimeOut)
+{
+	HTTPCallback OnResult = [callback](const _tHTTPResult &result) {
+		if ((!result.bOK) && (result.http_code))
+		{
+			LogError(result.http_code);
+		}
+		if (callback)
+			callback(result);
+	};
+
+	CURL *curl = nullptr;
+	if (CheckIfGlobalInitDone())
+		curl = curl_easy_init();
+	if (!curl)
+		return s_HTTPClientEngine.SubmitAsync(nullptr, nullptr, OnResult);
+
+	SetGlobalOptions(curl);
+	if (TimeOut != -1)
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, TimeOut);
+	if (!bFollowRedirect)
+		curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 0L);
+
+	struct curl_slist *headers = nullptr;
+	for (const auto &header : ExtraHeaders)
+	{
+		headers = curl_slist_append(headers, header.c_str());
+	}
+	if (headers != nullptr)
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+
+	// the request outlives the caller's data, curl keeps its own copy
+	switch (method)
+	{
+	case HTTP_METHOD_GET:
+		break;
+	case HTTP_METHOD_POST:
+		curl_easy_setopt(curl, CURLOPT_POST, 1);
+		curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, data.c_str());
+		break;
+	case HTTP_METHOD_PUT:
+		curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+		curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, data.c_str());
+		break;
+	case HTTP_METHOD_DELETE:
+		curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+		curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, data.c_str());
+		break;
+	case HTTP_METHOD_PATCH:
+		curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
+		curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, data.c_str());
+		break;
+	}
+
+	return s_HTTPClientEngine.SubmitAsync(curl, headers, OnResult);
+}
+
+std::future<HTTPClient::_tHTTPResult> HTTPClient::GETAsync(const std::string &url, const std::vector<std::string> &ExtraHeaders, const HTTPCallback &callback, const long TimeOut)
+{
+	return Async(HTTP_METHOD_GET, url, "", ExtraHeaders, callback, true, TimeOut);
+}
+
+std::future<HTTPClient::_tHTTPResult> HTTPClient::POSTAsync(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, const HTTPCallback &callback,
+							    const long TimeOut)
+{
+	return Async(HTTP_METHOD_POST, url, postdata, ExtraHeaders, callback, true, TimeOut);
+}
+
+void HTTPClient::GetHostStatistics(std::vector<_tHostStatistics> &stats)
+{
+	stats.clear();
+	s_HTTPClientEngine.GetHostStatistics(stats);
+}
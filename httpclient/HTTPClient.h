@@ -1,5 +1,8 @@
 #pragma once
 
+#include <functional>
+#include <future>
+
 class HTTPClient
 {
 	// give MainWorker acces to the protected Cleanup() function
@@ -15,6 +18,26 @@ class HTTPClient
 		HTTP_METHOD_PATCH
 	};
 
+	struct _tHTTPResult
+	{
+		bool bOK = false;
+		long http_code = 0;
+		std::vector<unsigned char> response;
+		std::vector<std::string> vHeaderData;
+	};
+	typedef std::function<void(const _tHTTPResult &result)> HTTPCallback;
+
+	struct _tHostStatistics
+	{
+		std::string host;
+		uint64_t requests = 0;
+		uint64_t failed = 0;
+		uint64_t reused = 0; // requests that did not need a new connection
+		double latency_p50 = 0; // milliseconds, over the most recent requests
+		double latency_p90 = 0;
+		double latency_p99 = 0;
+	};
+
       protected:
 	// Cleanup function, should be called before application closed
 	static void Cleanup();
@@ -111,7 +134,33 @@ class HTTPClient
 	static bool PatchBinary(const std::string& url, const std::string& putdata, const std::vector<std::string>& ExtraHeaders, std::vector<unsigned char>& response,
 		std::vector<std::string>& vHeaderData, long TimeOut = -1);
 
+	/************************************************************************
+	 *									*
+	 * asynchronous methods							*
+	 *   - the request is handled by the shared transfer engine, the	*
+	 *     calling thread does not wait for the reply			*
+	 *   - the callback (optional) is called from the engine thread and	*
+	 *     should return quickly						*
+	 *   - bOK is set when the transfer succeeded with a HTTP code < 400	*
+	 *									*
+	 ************************************************************************/
+
+	static std::future<_tHTTPResult> Async(_eHTTPmethod method, const std::string &url, const std::string &data, const std::vector<std::string> &ExtraHeaders,
+					       const HTTPCallback &callback = nullptr, bool bFollowRedirect = true, long TimeOut = -1);
+	static std::future<_tHTTPResult> GETAsync(const std::string &url, const std::vector<std::string> &ExtraHeaders, const HTTPCallback &callback = nullptr, long TimeOut = -1);
+	static std::future<_tHTTPResult> POSTAsync(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, const HTTPCallback &callback = nullptr,
+						   long TimeOut = -1);
+
+	/************************************************************************
+	 *									*
+	 * statistics of the shared transfer engine, per scheme/host/port	*
+	 *									*
+	 ************************************************************************/
+
+	static void GetHostStatistics(std::vector<_tHostStatistics> &stats);
+
       private:
+	static int Perform(void *curlobj); // returns the CURLcode
 	static void SetGlobalOptions(void *curlobj);
 	static bool CheckIfGlobalInitDone();
 	static void LogError(long response_code);
@@ -0,0 +1,305 @@
+#include "stdafx.h"
+#include "HTTPClientEngine.h"
+#include "../main/Helper.h"
+
+#include <algorithm>
+#include <sstream>
+
+// idle connections kept open by the transfer engine (over all hosts)
+#define HTTP_ENGINE_MAX_CONNECTIONS 32
+// number of recent requests per host used for the latency percentiles
+#define HTTP_ENGINE_LATENCY_SAMPLES 128
+
+size_t write_curl_headerdata(void *contents, size_t size, size_t nmemb, void *userp) // called once for each header
+{
+	size_t realsize = size * nmemb;
+	std::vector<std::string>* pvHeaderData = (std::vector<std::string>*)userp;
+	pvHeaderData->push_back(std::string((unsigned char*)contents, (std::find((unsigned char*)contents, (unsigned char*)contents + realsize, '\r'))));
+	return realsize;
+}
+
+size_t write_curl_data(void *contents, size_t size, size_t nmemb, void *userp)
+{
+	size_t realsize = size * nmemb;
+	std::vector<unsigned char>* pvHTTPResponse = (std::vector<unsigned char>*)userp;
+	pvHTTPResponse->insert(pvHTTPResponse->end(), (unsigned char*)contents, (unsigned char*)contents + realsize);
+	return realsize;
+}
+
+CHTTPClientEngine::~CHTTPClientEngine()
+{
+	Stop();
+}
+
+bool CHTTPClientEngine::Submit(CURL *curl, const HTTPTransferDone &OnDone)
+{
+	std::lock_guard<std::mutex> l(m_mutex);
+	if (m_bStopped)
+		return false;
+	if (!m_thread && !Start())
+	{
+		m_bStopped = true;
+		return false;
+	}
+	if (std::this_thread::get_id() == m_thread->get_id())
+		return false;
+	m_pending.emplace_back(curl, OnDone);
+#if LIBCURL_VERSION_NUM >= 0x074400
+	curl_multi_wakeup(m_multi);
+#endif
+	return true;
+}
+
+std::future<HTTPClient::_tHTTPResult> CHTTPClientEngine::SubmitAsync(CURL *curl, struct curl_slist *headers, const HTTPClient::HTTPCallback &callback)
+{
+	struct _tAsyncRequest
+	{
+		struct curl_slist *headers = nullptr;
+		HTTPClient::HTTPCallback callback;
+		HTTPClient::_tHTTPResult result;
+		std::promise<HTTPClient::_tHTTPResult> done;
+	};
+	std::shared_ptr<_tAsyncRequest> request = std::make_shared<_tAsyncRequest>();
+	request->headers = headers;
+	request->callback = callback;
+	std::future<HTTPClient::_tHTTPResult> future = request->done.get_future();
+
+	HTTPTransferDone OnDone = [request](CURL *curl, const CURLcode res) {
+		HTTPClient::_tHTTPResult &result = request->result;
+		if (res == CURLE_OK)
+		{
+			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &result.http_code);
+			result.bOK = ((result.http_code) && (result.http_code < 400));
+		}
+		else if (res != CURLE_HTTP_RETURNED_ERROR)
+		{
+			//Need to generate a header
+			std::stringstream ss;
+			ss << "HTTP/1.1 " << res << " " << curl_easy_strerror(res);
+			result.vHeaderData.push_back(ss.str());
+		}
+		if (curl != nullptr)
+			curl_easy_cleanup(curl);
+		if (request->headers != nullptr)
+		{
+			curl_slist_free_all(request->headers); /* free the header list */
+			request->headers = nullptr;
+		}
+		if (request->callback)
+		{
+			try
+			{
+				request->callback(result);
+			}
+			catch (...)
+			{
+			}
+		}
+		request->done.set_value(std::move(result));
+	};
+
+	if (curl == nullptr)
+	{
+		OnDone(nullptr, CURLE_FAILED_INIT);
+		return future;
+	}
+	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, write_curl_headerdata);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &request->result.vHeaderData);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_curl_data);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&request->result.response);
+
+	if (!Submit(curl, OnDone))
+	{
+		CURLcode res = curl_easy_perform(curl);
+		AddStatistics(curl, res);
+		OnDone(curl, res);
+	}
+	return future;
+}
+
+void CHTTPClientEngine::Stop()
+{
+	std::shared_ptr<std::thread> thread;
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		m_bStopped = true;
+		if (!m_thread)
+			return;
+		m_bStopRequested = true;
+#if LIBCURL_VERSION_NUM >= 0x074400
+		curl_multi_wakeup(m_multi);
+#endif
+		thread = m_thread;
+	}
+	thread->join();
+
+	std::lock_guard<std::mutex> l(m_mutex);
+	m_thread.reset();
+	curl_multi_cleanup(m_multi);
+	m_multi = nullptr;
+}
+
+void CHTTPClientEngine::AddStatistics(CURL *curl, const CURLcode res)
+{
+	char *szURL = nullptr;
+	long num_connects = 0;
+	long http_code = 0;
+	double total_time = 0;
+	curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &szURL);
+	curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &num_connects);
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+	curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total_time);
+
+	std::string szHost = GetHostKey((szURL != nullptr) ? szURL : "");
+
+	std::lock_guard<std::mutex> l(m_statsMutex);
+	_tHostStats &stats = m_stats[szHost];
+	stats.requests++;
+	if ((res != CURLE_OK) || (http_code >= 400))
+		stats.failed++;
+	else if (num_connects == 0)
+		stats.reused++;
+	if (stats.latencies.size() < HTTP_ENGINE_LATENCY_SAMPLES)
+		stats.latencies.push_back(static_cast<float>(total_time * 1000.0));
+	else
+		stats.latencies[stats.next_latency] = static_cast<float>(total_time * 1000.0);
+	stats.next_latency = (stats.next_latency + 1) % HTTP_ENGINE_LATENCY_SAMPLES;
+}
+
+void CHTTPClientEngine::GetHostStatistics(std::vector<HTTPClient::_tHostStatistics> &result)
+{
+	std::lock_guard<std::mutex> l(m_statsMutex);
+	for (const auto &itt : m_stats)
+	{
+		HTTPClient::_tHostStatistics hstats;
+		hstats.host = itt.first;
+		hstats.requests = itt.second.requests;
+		hstats.failed = itt.second.failed;
+		hstats.reused = itt.second.reused;
+
+		std::vector<float> latencies = itt.second.latencies;
+		if (!latencies.empty())
+		{
+			std::sort(latencies.begin(), latencies.end());
+			hstats.latency_p50 = latencies[(latencies.size() - 1) * 50 / 100];
+			hstats.latency_p90 = latencies[(latencies.size() - 1) * 90 / 100];
+			hstats.latency_p99 = latencies[(latencies.size() - 1) * 99 / 100];
+		}
+		result.push_back(hstats);
+	}
+}
+
+// Reduce an url to its lowercase 'scheme://host:port' part
+std::string CHTTPClientEngine::GetHostKey(const std::string &url)
+{
+	std::string szScheme = "http";
+	std::string szHost = url;
+	size_t pos = szHost.find("://");
+	if (pos != std::string::npos)
+	{
+		szScheme = szHost.substr(0, pos);
+		szHost = szHost.substr(pos + 3);
+	}
+	pos = szHost.find_first_of("/?#");
+	if (pos != std::string::npos)
+		szHost = szHost.substr(0, pos);
+	pos = szHost.rfind('@');
+	if (pos != std::string::npos)
+		szHost = szHost.substr(pos + 1);
+	std::string szKey = szScheme + "://" + szHost;
+	std::transform(szKey.begin(), szKey.end(), szKey.begin(), ::tolower);
+	return szKey;
+}
+
+// Called with m_mutex locked
+bool CHTTPClientEngine::Start()
+{
+#if LIBCURL_VERSION_NUM < 0x074400
+	// curl_multi_poll/curl_multi_wakeup are needed, fall back to blocking transfers
+	return false;
+#else
+	m_multi = curl_multi_init();
+	if (m_multi == nullptr)
+		return false;
+	curl_multi_setopt(m_multi, CURLMOPT_MAXCONNECTS, static_cast<long>(HTTP_ENGINE_MAX_CONNECTIONS));
+	m_bStopRequested = false;
+	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
+	SetThreadName(m_thread->native_handle(), "HTTPClient");
+	return true;
+#endif
+}
+
+void CHTTPClientEngine::Do_Work()
+{
+#if LIBCURL_VERSION_NUM >= 0x074400
+	std::deque<std::pair<CURL *, HTTPTransferDone>> rejected;
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> l(m_mutex);
+			if (m_bStopRequested)
+				break;
+			while (!m_pending.empty())
+			{
+				if (curl_multi_add_handle(m_multi, m_pending.front().first) == CURLM_OK)
+					m_active[m_pending.front().first] = std::move(m_pending.front().second);
+				else
+					rejected.push_back(std::move(m_pending.front()));
+				m_pending.pop_front();
+			}
+		}
+		while (!rejected.empty())
+		{
+			rejected.front().second(rejected.front().first, CURLE_FAILED_INIT);
+			rejected.pop_front();
+		}
+
+		int running = 0;
+		curl_multi_perform(m_multi, &running);
+
+		int msgs_left = 0;
+		CURLMsg *msg;
+		while ((msg = curl_multi_info_read(m_multi, &msgs_left)) != nullptr)
+		{
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+			CURL *curl = msg->easy_handle;
+			CURLcode res = msg->data.result;
+			Complete(curl, res);
+		}
+
+		curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr);
+	}
+
+	// Abort everything that is still queued or running, nobody should keep waiting
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		rejected.swap(m_pending);
+	}
+	while (!rejected.empty())
+	{
+		rejected.front().second(rejected.front().first, CURLE_ABORTED_BY_CALLBACK);
+		rejected.pop_front();
+	}
+	while (!m_active.empty())
+	{
+		CURL *curl = m_active.begin()->first;
+		HTTPTransferDone OnDone = std::move(m_active.begin()->second);
+		m_active.erase(m_active.begin());
+		curl_multi_remove_handle(m_multi, curl);
+		OnDone(curl, CURLE_ABORTED_BY_CALLBACK);
+	}
+#endif
+}
+
+void CHTTPClientEngine::Complete(CURL *curl, const CURLcode res)
+{
+	curl_multi_remove_handle(m_multi, curl);
+	auto itt = m_active.find(curl);
+	if (itt == m_active.end())
+		return;
+	HTTPTransferDone OnDone = std::move(itt->second);
+	m_active.erase(itt);
+	AddStatistics(curl, res);
+	OnDone(curl, res);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "HTTPClient.h"
+#include <curl/curl.h>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/************************************************************************
+ *									*
+ * Shared transfer engine						*
+ *									*
+ * All requests are run by one curl multi handle in a worker thread.	*
+ * The multi handle keeps finished connections alive in its per-host	*
+ * connection cache, so consecutive requests to the same server reuse	*
+ * the TCP/TLS connection instead of doing a new handshake.		*
+ *									*
+ ************************************************************************/
+
+typedef std::function<void(CURL *curl, CURLcode res)> HTTPTransferDone;
+
+// Curl writeback functions, the body into a std::vector<unsigned char>, each header line into a std::vector<std::string>
+size_t write_curl_data(void *contents, size_t size, size_t nmemb, void *userp);
+size_t write_curl_headerdata(void *contents, size_t size, size_t nmemb, void *userp);
+
+class CHTTPClientEngine
+{
+      public:
+	CHTTPClientEngine() = default;
+	~CHTTPClientEngine();
+
+	// Returns false if the request can not be handled by the engine (not available,
+	// stopped or called from the engine thread), the caller has to perform it itself.
+	// OnDone is called from the engine thread, with CURLE_ABORTED_BY_CALLBACK when the engine is stopped first
+	bool Submit(CURL *curl, const HTTPTransferDone &OnDone);
+	// Runs a request of HTTPClient::Async, the body and headers are collected in the result and the handle
+	// and header list are cleaned up. The callback is called first (from the engine thread), then the future is set.
+	// When the engine can not take the request it is performed in the calling thread
+	std::future<HTTPClient::_tHTTPResult> SubmitAsync(CURL *curl, struct curl_slist *headers, const HTTPClient::HTTPCallback &callback);
+	void Stop();
+
+	void AddStatistics(CURL *curl, CURLcode res);
+	void GetHostStatistics(std::vector<HTTPClient::_tHostStatistics> &result);
+
+      private:
+	struct _tHostStats
+	{
+		uint64_t requests = 0;
+		uint64_t failed = 0;
+		uint64_t reused = 0;
+		std::vector<float> latencies;
+		size_t next_latency = 0;
+	};
+
+	static std::string GetHostKey(const std::string &url);
+	bool Start();
+	void Do_Work();
+	void Complete(CURL *curl, CURLcode res);
+
+	std::mutex m_mutex;
+	std::shared_ptr<std::thread> m_thread;
+	CURLM *m_multi = nullptr;
+	bool m_bStopRequested = false;
+	bool m_bStopped = false;
+	std::deque<std::pair<CURL *, HTTPTransferDone>> m_pending;
+	// only accessed by the engine thread
+	std::map<CURL *, HTTPTransferDone> m_active;
+
+	std::mutex m_statsMutex;
+	std::map<std::string, _tHostStats> m_stats;
+};
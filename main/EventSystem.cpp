@@ -3,6 +3,7 @@
 #include "RFXNames.h"
 #include "EventSystem.h"
 #include "dzVents.h"
+#include "LuaEnvironment.h"
 #include "Helper.h"
 #include "HTMLSanitizer.h"
 #include "SQLHelper.h"
@@ -24,6 +25,11 @@
 #include "../main/LuaTable.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 extern "C" {
 #include <lua.h>
@@ -31,8 +37,42 @@ extern "C" {
 #include <lauxlib.h>
 }
 
+#define SCRIPT_INDEX_RESCAN_SEC 10 // without inotify the script directories are listed again after this many seconds
+
 bool g_bUseEventTrigger = true;
 
+// Classic Lua tables that are only exported for some events
+static const char *szLuaEventTables[] = {
+	"devicechanged",		   "devicechanged_ext",	     "uservariablechanged",	      "notification",
+	"otherdevices_temperature",	   "otherdevices_dewpoint",  "otherdevices_humidity",	      "otherdevices_barometer",
+	"otherdevices_utility",	   "otherdevices_rain",	     "otherdevices_rain_lasthour",   "otherdevices_uv",
+	"otherdevices_winddir",	   "otherdevices_windspeed", "otherdevices_windgust",	      "otherdevices_weather",
+	"otherdevices_zwavealarms",
+};
+
+// Upper bounds (in microseconds) of the Lua script execution time histogram, the last bucket takes the rest
+static const uint64_t LuaHistogramBounds[] = { 1000, 5000, 10000, 50000, 100000, 500000, 1000000 };
+static const char *szLuaHistogramLabels[] = { "<1ms", "<5ms", "<10ms", "<50ms", "<100ms", "<500ms", "<1s", ">=1s" };
+
+// Leaves the global table Name on top of the stack, creating it when needed
+static void PushLuaGlobalTable(lua_State *lua_state, const char *Name)
+{
+	lua_getglobal(lua_state, Name);
+	if (lua_istable(lua_state, -1))
+		return;
+	lua_pop(lua_state, 1);
+	lua_newtable(lua_state);
+	lua_pushvalue(lua_state, -1);
+	lua_setglobal(lua_state, Name);
+}
+
+// Tables a persistent classic Lua state shares between all scripts, besides the per event ones in szLuaEventTables
+static const char *szLuaSharedTables[] = {
+	"otherdevices",	       "otherdevices_lastupdate",	"otherdevices_svalues", "otherdevices_idx",	   "otherdevices_lastlevel",
+	"otherdevices_scenesgroups", "otherdevices_scenesgroups_idx", "uservariables",	      "uservariables_lastupdate", "globalvariables",
+	"timeofday",
+};
+
 extern time_t m_StartTime;
 extern std::string szUserDataFolder, szStartupFolder;
 extern http::server::CWebServerHelper m_webservers;
@@ -64,64 +104,6 @@ const std::string CEventSystem::m_szSecStatus[] =
 	"Armed Away"	// 2
 };
 
-// This table specifies which JSON fields are passed to the LUA scripts.
-// If new return fields are added in CWebServer::GetJSonDevices, they should
-// be added to this table.
-const CEventSystem::_tJsonMap CEventSystem::JsonMap[] = {
-	{ "Barometer", "barometer", JTYPE_FLOAT },
-	{ "CameraIndx", "cameraIdx", JTYPE_STRING },
-	{ "Chill", "chill", JTYPE_FLOAT },
-	{ "Color", "color", JTYPE_STRING },
-	{ "Counter", "counter", JTYPE_STRING },
-	{ "CounterDeliv", "counterDelivered", JTYPE_FLOAT },
-	{ "CounterDelivToday", "counterDeliveredToday", JTYPE_STRING },
-	{ "CounterToday", "counterToday", JTYPE_STRING },
-	{ "Current", "current", JTYPE_FLOAT },
-	{ "CustomImage", "customImage", JTYPE_INT },
-	{ "DewPoint", "dewPoint", JTYPE_FLOAT },
-	{ "Direction", "direction", JTYPE_FLOAT },
-	{ "DirectionStr", "directionString", JTYPE_STRING },
-	{ "Forecast", "forecast", JTYPE_INT },
-	{ "ForecastStr", "forecastString", JTYPE_STRING },
-	{ "HardwareName", "hardwareName", JTYPE_STRING },
-	{ "HardwareType", "hardwareType", JTYPE_STRING },
-	{ "HardwareTypeVal", "hardwareTypeValue", JTYPE_INT },
-	{ "Humidity", "humidity", JTYPE_INT },
-	{ "HumidityStatus", "humidityStatus", JTYPE_STRING },
-	{ "Image", "Image", JTYPE_STRING },
-	{ "InternalState", "internalState", JTYPE_STRING }, // door contact
-	{ "LevelActions", "levelActions", JTYPE_STRING },
-	{ "LevelInt", "levelVal", JTYPE_INT },
-	{ "LevelNames", "levelNames", JTYPE_STRING },
-	{ "LevelOffHidden", "levelOffHidden", JTYPE_BOOL },
-	{ "MaxDimLevel", "maxDimLevel", JTYPE_INT },
-	{ "Mode", "mode", JTYPE_INT }, // zwave thermostat
-	{ "Modes", "modes", JTYPE_STRING },
-	{ "Moisture", "moisture", JTYPE_STRING },
-	{ "Pressure", "pressure", JTYPE_FLOAT },
-	{ "Protected", "protected", JTYPE_BOOL },
-	{ "Quality", "quality", JTYPE_STRING },
-	{ "Radiation", "radiation", JTYPE_FLOAT },
-	{ "Rain", "rain", JTYPE_FLOAT },
-	{ "RainRate", "rainRate", JTYPE_FLOAT },
-	{ "SensorType", "sensorType", JTYPE_INT },
-	{ "SensorUnit", "sensorUnit", JTYPE_STRING },
-	{ "SetPoint", "setPoint", JTYPE_FLOAT },
-	{ "Speed", "speed", JTYPE_FLOAT },
-	{ "Temp", "temperature", JTYPE_FLOAT },
-	{ "TypeImg", "icon", JTYPE_STRING },
-	{ "Unit", "unit", JTYPE_INT },
-	{ "Until", "until", JTYPE_STRING }, // evohome zone/water
-	{ "Usage", "usage", JTYPE_STRING },
-	{ "UsedByCamera", "usedByCamera", JTYPE_BOOL },
-	{ "UsageDeliv", "usageDelivered", JTYPE_STRING },
-	{ "ValueQuantity", "valueQuantity", JTYPE_STRING },
-	{ "ValueUnits", "valueUnits", JTYPE_STRING },
-	{ "Visibility", "visibility", JTYPE_FLOAT },
-	{ "Voltage", "voltage", JTYPE_FLOAT },
-	{ nullptr, nullptr, JTYPE_STRING },
-};
-
 CEventSystem::CEventSystem()
 {
 	m_bEnabled = false;
@@ -181,6 +163,12 @@ void CEventSystem::StopEventSystem()
 #ifdef ENABLE_PYTHON
 	Plugins::PythonEventsStop();
 #endif
+
+	CloseScriptIndex();
+
+	std::lock_guard<std::mutex> l(luaMutex);
+	ClosePersistentLuaState();
+	CdzVents::GetInstance()->FlushPersistentData();
 }
 
 void CEventSystem::SetEnabled(const bool bEnabled)
@@ -338,6 +326,7 @@ void CEventSystem::Do_Work()
 			{
 				_LastMinute = ltime.tm_min;
 				ProcessMinute();
+				CdzVents::GetInstance()->FlushPersistentData();
 			}
 		}
 	}
@@ -433,6 +422,8 @@ void CEventSystem::GetCurrentStates()
 
 	_log.Log(LOG_STATUS, "EventSystem: reset all device statuses...");
 	m_devicestates.clear();
+	m_bScriptIndexDeviceNamesChanged = true;
+	SetDzVentsListChanged();
 
 	result = m_sql.safe_query(
 		"SELECT A.HardwareID, A.ID, A.Name, A.nValue, A.sValue, A.Type, A.SubType, A.SwitchType, A.LastUpdate, A.LastLevel, A.Options, A.Description, A.BatteryLevel, A.SignalLevel, A.Unit, A.DeviceID, A.Protected, A.AddjValue, A.AddjMulti, A.AddjValue2, A.AddjMulti2 "
@@ -519,6 +510,7 @@ void CEventSystem::GetCurrentUserVariables()
 
 	//_log.Log(LOG_STATUS, "EventSystem: reset all user variables...");
 	m_uservariables.clear();
+	SetDzVentsListChanged();
 
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query("SELECT ID,Name,Value, ValueType, LastUpdate FROM UserVariables");
@@ -542,6 +534,7 @@ void CEventSystem::GetCurrentScenesGroups()
 	boost::unique_lock<boost::shared_mutex> scenesgroupsMutexLock(m_scenesgroupsMutex);
 
 	m_scenesgroups.clear();
+	SetDzVentsListChanged();
 
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query("SELECT ID, Name, nValue, SceneType, LastUpdate, Protected, Description FROM Scenes");
@@ -887,13 +880,13 @@ void CEventSystem::GetCurrentMeasurementStates()
 					uint64_t total_min, total_max, total_real;
 					std::vector<std::vector<std::string> > result2;
 
-					result2 = m_sql.safe_query("SELECT sValue FROM DeviceStatus WHERE (ID=%" PRIu64 ")", sitem.ID);
+					result2 = m_sql.bind_query("SELECT sValue FROM DeviceStatus WHERE (ID=?)", sitem.ID);
 					total_max = std::stoull(result2[0][0]);
 
 					//get value of today
 					std::string szDate = TimeToString(nullptr, TF_Date);
-					result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-						sitem.ID, szDate.c_str());
+					result2 = m_sql.bind_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=? AND Date>=?)",
+						sitem.ID, szDate);
 					if (!result2.empty())
 					{
 						total_min = std::stoull(result2[0][0]);
@@ -938,15 +931,15 @@ void CEventSystem::GetCurrentMeasurementStates()
 
 				if (sitem.subType == sTypeRAINWU || sitem.subType == sTypeRAINByRate)
 				{
-					result2 = m_sql.safe_query(
-						"SELECT Total, Total FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q') ORDER BY ROWID DESC LIMIT 1",
-						sitem.ID, szDate.c_str());
+					result2 = m_sql.bind_query(
+						"SELECT Total, Total FROM Rain WHERE (DeviceRowID=? AND Date>=?) ORDER BY ROWID DESC LIMIT 1",
+						sitem.ID, szDate);
 				}
 				else
 				{
-					result2 = m_sql.safe_query(
-						"SELECT MIN(Total), MAX(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-						sitem.ID, szDate.c_str());
+					result2 = m_sql.bind_query(
+						"SELECT MIN(Total), MAX(Total) FROM Rain WHERE (DeviceRowID=? AND Date>=?)",
+						sitem.ID, szDate);
 				}
 				if (!result2.empty())
 				{
@@ -972,8 +965,8 @@ void CEventSystem::GetCurrentMeasurementStates()
 			//get lowest value of today
 			std::string szDate = TimeToString(nullptr, TF_Date);
 			std::vector<std::vector<std::string> > result2;
-			result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-				sitem.ID, szDate.c_str());
+			result2 = m_sql.bind_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=? AND Date>=?)",
+				sitem.ID, szDate);
 			if (!result2.empty())
 			{
 				std::vector<std::string> sd2 = result2[0];
@@ -998,8 +991,8 @@ void CEventSystem::GetCurrentMeasurementStates()
 				//get value of today
 				std::string szDate = TimeToString(nullptr, TF_Date);
 				std::vector<std::vector<std::string> > result2;
-				result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-					sitem.ID, szDate.c_str());
+				result2 = m_sql.bind_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID=? AND Date>=?)",
+					sitem.ID, szDate);
 				if (!result2.empty())
 				{
 					std::vector<std::string> sd2 = result2[0];
@@ -1085,11 +1078,14 @@ void CEventSystem::RemoveSingleState(const uint64_t ulDevID, const _eReason reas
 	{
 		boost::unique_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
 		m_devicestates.erase(ulDevID);
+		m_bScriptIndexDeviceNamesChanged = true;
+		SetDzVentsListChanged();
 	}
 	else if (reason == REASON_SCENEGROUP)
 	{
 		boost::unique_lock<boost::shared_mutex> scenesgroupsMutexLock(m_scenesgroupsMutex);
 		m_scenesgroups.erase(ulDevID);
+		SetDzVentsListChanged();
 	}
 }
 
@@ -1110,6 +1106,8 @@ void CEventSystem::WWWUpdateSingleState(const uint64_t ulDevID, const std::strin
 			_tDeviceStatus replaceitem = itt->second;
 			replaceitem.deviceName = l_deviceName;
 			itt->second = replaceitem;
+			m_bScriptIndexDeviceNamesChanged = true;
+			SetDzVentsChanged(reason, ulDevID);
 		}
 	}
 	else if (reason == REASON_SCENEGROUP)
@@ -1121,6 +1119,7 @@ void CEventSystem::WWWUpdateSingleState(const uint64_t ulDevID, const std::strin
 			_tScenesGroups replaceitem = itt->second;
 			replaceitem.scenesgroupName = l_deviceName;
 			itt->second = replaceitem;
+			SetDzVentsChanged(reason, ulDevID);
 		}
 	}
 }
@@ -1262,6 +1261,7 @@ bool CEventSystem::UpdateSceneGroup(const uint64_t ulDevID, const int nValue, co
 		}
 		replaceitem.lastUpdate = lastUpdate;
 		itt->second = replaceitem;
+		SetDzVentsChanged(REASON_SCENEGROUP, ulDevID);
 	}
 	return bEventTrigger;
 }
@@ -1292,6 +1292,7 @@ void CEventSystem::UpdateUserVariable(const uint64_t ulDevID, const std::string
 	}
 	replaceitem.lastUpdate = lastUpdate;
 	itt->second = replaceitem;
+	SetDzVentsChanged(REASON_USERVARIABLE, ulDevID);
 }
 
 void CEventSystem::UpdateBatteryLevel(const uint64_t ulDevID, const unsigned char batteryLevel)
@@ -1307,6 +1308,7 @@ void CEventSystem::UpdateBatteryLevel(const uint64_t ulDevID, const unsigned cha
 		_tDeviceStatus replaceitem = itt->second;
 		replaceitem.batteryLevel = batteryLevel;
 		itt->second = replaceitem;
+		SetDzVentsChanged(REASON_DEVICE, ulDevID);
 	}
 }
 
@@ -1338,6 +1340,8 @@ std::string CEventSystem::UpdateSingleState(
 	{
 		//_log.Log(LOG_STATUS,"EventSystem: update device %" PRIu64 "",ulDevID);
 		_tDeviceStatus replaceitem = itt->second;
+		if (replaceitem.deviceName != l_deviceName)
+			m_bScriptIndexDeviceNamesChanged = true;
 		replaceitem.deviceName = l_deviceName;
 		//replaceitem.batteryLevel = batteryLevel;
 		if (nValue != -1)
@@ -1356,6 +1360,7 @@ std::string CEventSystem::UpdateSingleState(
 			UpdateJsonMap(replaceitem, ulDevID);
 		}
 		itt->second = replaceitem;
+		SetDzVentsChanged(REASON_DEVICE, ulDevID);
 	}
 	else
 	{
@@ -1378,6 +1383,8 @@ std::string CEventSystem::UpdateSingleState(
 			UpdateJsonMap(newitem, ulDevID);
 		}
 		m_devicestates[newitem.ID] = newitem;
+		m_bScriptIndexDeviceNamesChanged = true;
+		SetDzVentsListChanged();
 	}
 	return nValueWording;
 }
@@ -1444,7 +1451,7 @@ void CEventSystem::ProcessDevice(
 		return;
 
 	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT SwitchType, LastUpdate, LastLevel, Options, Name FROM DeviceStatus WHERE (ID==%" PRIu64 ")", ulDevID);
+	result = m_sql.bind_query("SELECT SwitchType, LastUpdate, LastLevel, Options, Name FROM DeviceStatus WHERE (ID==?)", ulDevID);
 	if (result.empty())
 	{
 		//impossible as we just updated it
@@ -1473,7 +1480,7 @@ void CEventSystem::ProcessDevice(
 
 		std::string szDate = TimeToString(nullptr, TF_Date);
 		std::vector<std::vector<std::string> > result2;
-		result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')", ulDevID, szDate.c_str());
+		result2 = m_sql.bind_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=? AND Date>=?)", ulDevID, szDate);
 		if (!result2.empty())
 		{
 			uint64_t total_min = std::stoull(result2[0][0]);
@@ -1510,6 +1517,7 @@ void CEventSystem::ProcessDevice(
 			replaceitem.lastUpdate = lastUpdate;
 			replaceitem.lastLevel = lastLevel;
 			itt->second = replaceitem;
+			SetDzVentsChanged(REASON_DEVICE, ulDevID);
 		}
 		m_eventqueue.push(item);
 	}
@@ -1530,99 +1538,57 @@ void CEventSystem::EvaluateEvent(const std::vector<_tEventQueue> &items)
 	if (!m_bEnabled)
 		return;
 
-	std::vector<std::string> FileEntries;
-	std::string filename;
-#ifdef ENABLE_PYTHON
-	std::vector<std::string> FileEntriesPython;
-	DirectoryListing(FileEntriesPython, m_python_Dir, false, true);
-#endif
+	std::unique_lock<std::mutex> scriptIndexLock(m_scriptIndexMutex);
+	UpdateScriptIndex();
+	bool bDzVentsScripts = m_scriptIndex.bDzVentsScripts;
+	scriptIndexLock.unlock();
 
 	if (!m_sql.m_bDisableDzVentsSystem)
 	{
 		CdzVents* dzvents = CdzVents::GetInstance();
-		if (dzvents->m_bdzVentsExist)
+		if (dzvents->m_bdzVentsExist || bDzVentsScripts)
 			EvaluateLua(items, dzvents->m_runtimeDir + "dzVents.lua", "");
-		else
-		{
-			DirectoryListing(FileEntries, dzvents->m_scriptsDir, false, true);
-			for (const auto &filename : FileEntries)
-			{
-				if (filename.length() > 4 &&
-					filename.compare(filename.length() - 4, 4, ".lua") == 0)
-				{
-					EvaluateLua(items, dzvents->m_runtimeDir + "dzVents.lua", "");
-					break;
-				}
-			}
-			FileEntries.clear();
-		}
 	}
 
-	bool bDeviceFileFound = false;
-	DirectoryListing(FileEntries, m_lua_Dir, false, true);
 	for (const auto &item : items)
 	{
-		for (const auto &filename : FileEntries)
+		std::vector<std::string> LuaScripts;
+		std::vector<std::string> PythonScripts;
+
+		scriptIndexLock.lock();
+		if (item.reason == REASON_DEVICE)
 		{
-			if (filename.length() > 4 &&
-				filename.compare(filename.length() - 4, 4, ".lua") == 0 &&
-				filename.find("_demo.lua") == std::string::npos)
+			// Scripts for this device and the ones that are not bound to a device, in directory order
+			std::vector<size_t> indexes = m_scriptIndex.luaDeviceAny;
+			auto itt = m_scriptIndex.luaDeviceByName.find(SpaceToUnderscore(LowerCase(item.devname)));
+			if (itt != m_scriptIndex.luaDeviceByName.end())
 			{
-				if (item.reason == REASON_DEVICE && filename.find("_device_") != std::string::npos)
-				{
-					bDeviceFileFound = false;
-					boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
-					for (const auto &state : m_devicestates)
-					{
-						std::string deviceName = SpaceToUnderscore(LowerCase(state.second.deviceName));
-						if (filename.find("_device_" + deviceName + ".lua") != std::string::npos)
-						{
-							bDeviceFileFound = true;
-							if (deviceName == SpaceToUnderscore(LowerCase(item.devname)))
-							{
-								devicestatesMutexLock.unlock();
-								EvaluateLua(item, m_lua_Dir + filename, "");
-								break;
-							}
-						}
-					}
-					if (!bDeviceFileFound)
-					{
-						devicestatesMutexLock.unlock();
-						EvaluateLua(item, m_lua_Dir + filename, "");
-					}
-				}
-				else if ((item.reason == REASON_TIME && filename.find("_time_") != std::string::npos)
-					 || (item.reason == REASON_SECURITY && filename.find("_security_") != std::string::npos)
-					 || (item.reason == REASON_NOTIFICATION && filename.find("_notification_") != std::string::npos)
-					 || (item.reason == REASON_USERVARIABLE && filename.find("_variable_") != std::string::npos))
-				{
-					EvaluateLua(item, m_lua_Dir + filename, "");
-				}
+				indexes.insert(indexes.end(), itt->second.begin(), itt->second.end());
+				std::sort(indexes.begin(), indexes.end());
 			}
-			// else _log.Log(LOG_STATUS,"EventSystem: ignore file not .lua or is demo file: %s", filename.c_str());
+			for (const auto index : indexes)
+				LuaScripts.push_back(m_scriptIndex.luaDevice[index]);
 		}
+		else
+		{
+			auto itt = m_scriptIndex.lua.find(item.reason);
+			if (itt != m_scriptIndex.lua.end())
+				LuaScripts = itt->second;
+		}
+		auto ittPython = m_scriptIndex.python.find(item.reason);
+		if (ittPython != m_scriptIndex.python.end())
+			PythonScripts = ittPython->second;
+		scriptIndexLock.unlock();
+
+		for (const auto &filename : LuaScripts)
+			EvaluateLua(item, m_lua_Dir + filename, "");
 
 #ifdef ENABLE_PYTHON
 		boost::unique_lock<boost::shared_mutex> uservariablesMutexLock(m_uservariablesMutex);
 		try
 		{
-			for (const auto &filename : FileEntriesPython)
-			{
-				if (filename.length() > 3 &&
-					filename.compare(filename.length() - 3, 3, ".py") == 0 &&
-					filename.find("_demo.py") == std::string::npos)
-				{
-					if ((item.reason == REASON_DEVICE && filename.find("_device_") != std::string::npos)
-					    || (item.reason == REASON_TIME && filename.find("_time_") != std::string::npos)
-					    || (item.reason == REASON_SECURITY && filename.find("_security_") != std::string::npos)
-					    || (item.reason == REASON_USERVARIABLE && filename.find("_variable_") != std::string::npos))
-					{
-						EvaluatePython(item, m_python_Dir + filename, "");
-					}
-				}
-				// else _log.Log(LOG_STATUS,"EventSystem: ignore file not .py or is demo file: %s", filename.c_str());
-			}
+			for (const auto &filename : PythonScripts)
+				EvaluatePython(item, m_python_Dir + filename, "");
 		}
 		catch (...)
 		{
@@ -1876,6 +1842,172 @@ lua_State *CEventSystem::ParseBlocklyLua(lua_State *lua_state, const _tEventItem
 	return lua_state;
 }
 
+void CEventSystem::UpdateScriptIndex()
+{
+	// Caller holds m_scriptIndexMutex
+	if (m_scriptIndex.bValid && !ScriptDirectoriesChanged())
+	{
+		if (m_bScriptIndexDeviceNamesChanged.exchange(false))
+			IndexDeviceScripts();
+		return;
+	}
+	m_bScriptIndexDeviceNamesChanged = false;
+
+	CdzVents* dzvents = CdzVents::GetInstance();
+	std::vector<std::string> dirs = { m_lua_Dir, dzvents->m_scriptsDir };
+#ifdef ENABLE_PYTHON
+	dirs.push_back(m_python_Dir);
+#endif
+	WatchScriptDirectories(dirs);
+
+	_tScriptIndex index;
+	std::vector<std::string> FileEntries;
+
+	DirectoryListing(FileEntries, dzvents->m_scriptsDir, false, true);
+	for (const auto &filename : FileEntries)
+	{
+		if (filename.length() > 4 &&
+			filename.compare(filename.length() - 4, 4, ".lua") == 0)
+		{
+			index.bDzVentsScripts = true;
+			break;
+		}
+	}
+	FileEntries.clear();
+
+	DirectoryListing(FileEntries, m_lua_Dir, false, true);
+	for (const auto &filename : FileEntries)
+	{
+		if (filename.length() > 4 &&
+			filename.compare(filename.length() - 4, 4, ".lua") == 0 &&
+			filename.find("_demo.lua") == std::string::npos)
+		{
+			if (filename.find("_device_") != std::string::npos)
+				index.luaDevice.push_back(filename);
+			if (filename.find("_time_") != std::string::npos)
+				index.lua[REASON_TIME].push_back(filename);
+			if (filename.find("_security_") != std::string::npos)
+				index.lua[REASON_SECURITY].push_back(filename);
+			if (filename.find("_notification_") != std::string::npos)
+				index.lua[REASON_NOTIFICATION].push_back(filename);
+			if (filename.find("_variable_") != std::string::npos)
+				index.lua[REASON_USERVARIABLE].push_back(filename);
+		}
+	}
+
+#ifdef ENABLE_PYTHON
+	FileEntries.clear();
+	DirectoryListing(FileEntries, m_python_Dir, false, true);
+	for (const auto &filename : FileEntries)
+	{
+		if (filename.length() > 3 &&
+			filename.compare(filename.length() - 3, 3, ".py") == 0 &&
+			filename.find("_demo.py") == std::string::npos)
+		{
+			if (filename.find("_device_") != std::string::npos)
+				index.python[REASON_DEVICE].push_back(filename);
+			if (filename.find("_time_") != std::string::npos)
+				index.python[REASON_TIME].push_back(filename);
+			if (filename.find("_security_") != std::string::npos)
+				index.python[REASON_SECURITY].push_back(filename);
+			if (filename.find("_variable_") != std::string::npos)
+				index.python[REASON_USERVARIABLE].push_back(filename);
+		}
+	}
+#endif
+
+	m_scriptIndex = std::move(index);
+	IndexDeviceScripts();
+	m_scriptIndex.bValid = true;
+	m_scriptIndexTime = mytime(nullptr);
+}
+
+void CEventSystem::IndexDeviceScripts()
+{
+	// Caller holds m_scriptIndexMutex
+	std::set<std::string> deviceNames;
+	{
+		boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+		for (const auto &state : m_devicestates)
+			deviceNames.insert(SpaceToUnderscore(LowerCase(state.second.deviceName)));
+	}
+
+	m_scriptIndex.luaDeviceByName.clear();
+	m_scriptIndex.luaDeviceAny.clear();
+	for (size_t ii = 0; ii < m_scriptIndex.luaDevice.size(); ii++)
+	{
+		// script_device_<name>.lua only runs for device <name>, if such a device exists
+		const std::string &filename = m_scriptIndex.luaDevice[ii];
+		bool bBound = false;
+		size_t pos = filename.find("_device_");
+		while (pos != std::string::npos)
+		{
+			size_t nameStart = pos + 8;
+			if (nameStart <= filename.length() - 4)
+			{
+				std::string deviceName = filename.substr(nameStart, filename.length() - 4 - nameStart);
+				if (deviceNames.find(deviceName) != deviceNames.end())
+				{
+					m_scriptIndex.luaDeviceByName[deviceName].push_back(ii);
+					bBound = true;
+				}
+			}
+			pos = filename.find("_device_", pos + 1);
+		}
+		if (!bBound)
+			m_scriptIndex.luaDeviceAny.push_back(ii);
+	}
+}
+
+bool CEventSystem::ScriptDirectoriesChanged()
+{
+	bool bChanged = false;
+#ifdef __linux__
+	if (m_inotifyFd != -1)
+	{
+		char buffer[4096];
+		while (read(m_inotifyFd, buffer, sizeof(buffer)) > 0)
+			bChanged = true;
+	}
+#endif
+	// Without (complete) inotify coverage the directories are listed again now and then
+	if (m_bScriptIndexPoll && (mytime(nullptr) - m_scriptIndexTime >= SCRIPT_INDEX_RESCAN_SEC))
+		bChanged = true;
+	return bChanged;
+}
+
+void CEventSystem::WatchScriptDirectories(const std::vector<std::string> &dirs)
+{
+	m_bScriptIndexPoll = true;
+#ifdef __linux__
+	if (m_inotifyFd == -1)
+		m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotifyFd == -1)
+		return;
+
+	bool bWatched = true;
+	for (const auto &dir : dirs)
+	{
+		if (inotify_add_watch(m_inotifyFd, dir.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF) == -1)
+			bWatched = false;
+	}
+	m_bScriptIndexPoll = !bWatched;
+#endif
+}
+
+void CEventSystem::CloseScriptIndex()
+{
+	std::lock_guard<std::mutex> l(m_scriptIndexMutex);
+#ifdef __linux__
+	if (m_inotifyFd != -1)
+	{
+		close(m_inotifyFd);
+		m_inotifyFd = -1;
+	}
+#endif
+	m_scriptIndex = _tScriptIndex();
+}
+
 void CEventSystem::EvaluateDatabaseEvents(const _tEventQueue &item)
 {
 	lua_State *lua_state = nullptr;
@@ -2664,12 +2796,208 @@ void CEventSystem::ExportDeviceStatesToLua(lua_State *lua_state, const _tEventQu
 	luaTable.Publish();
 }
 
-void CEventSystem::EvaluateLuaClassic(lua_State *lua_state, const _tEventQueue &item, const int secStatus)
+void CEventSystem::SyncDeviceStatesToLua(lua_State *lua_state, const _tEventQueue &item)
 {
-	// reroute print library to Domoticz logger
-	luaL_openlibs(lua_state);
-	lua_pushcfunction(lua_state, l_domoticz_print);
-	lua_setglobal(lua_state, "print");
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+
+	static const char *szTables[] = { "otherdevices", "otherdevices_lastupdate", "otherdevices_svalues", "otherdevices_idx", "otherdevices_lastlevel" };
+
+	// Removed or renamed devices could leave stale (or shared) names behind, start over in that case
+	bool bRebuild = false;
+	for (const auto &exported : m_luaExportedDevices)
+	{
+		auto itt = m_devicestates.find(exported.first);
+		if ((itt == m_devicestates.end()) || (itt->second.deviceName != exported.second.deviceName))
+		{
+			bRebuild = true;
+			break;
+		}
+	}
+	if (bRebuild)
+	{
+		m_luaExportedDevices.clear();
+		for (const char *szTable : szTables)
+		{
+			lua_createtable(lua_state, 0, (int)m_devicestates.size());
+			lua_setglobal(lua_state, szTable);
+		}
+	}
+
+	int iBase = lua_gettop(lua_state);
+	for (const char *szTable : szTables)
+		PushLuaGlobalTable(lua_state, szTable);
+	const int tDevices = iBase + 1;
+	const int tLastUpdate = iBase + 2;
+	const int tSValues = iBase + 3;
+	const int tIdx = iBase + 4;
+	const int tLastLevel = iBase + 5;
+
+	for (const auto &state : m_devicestates)
+	{
+		bool bItem = (state.first == item.id && item.reason == REASON_DEVICE);
+		const std::string &nValueWording = bItem ? item.nValueWording : state.second.nValueWording;
+		const std::string &lastUpdate = bItem ? item.lastUpdate : state.second.lastUpdate;
+		const std::string &sValue = bItem ? item.sValue : state.second.sValue;
+		uint8_t lastLevel = bItem ? item.lastLevel : state.second.lastLevel;
+		const char *szName = state.second.deviceName.c_str();
+
+		auto itt = m_luaExportedDevices.find(state.first);
+		bool bNew = (itt == m_luaExportedDevices.end());
+		if (bNew)
+		{
+			itt = m_luaExportedDevices.insert(std::make_pair(state.first, _tLuaExportedDevice())).first;
+			itt->second.deviceName = state.second.deviceName;
+			lua_pushinteger(lua_state, (lua_Integer)state.second.ID);
+			lua_setfield(lua_state, tIdx, szName);
+		}
+		_tLuaExportedDevice &exported = itt->second;
+		if (bNew || (exported.nValueWording != nValueWording))
+		{
+			exported.nValueWording = nValueWording;
+			lua_pushstring(lua_state, nValueWording.c_str());
+			lua_setfield(lua_state, tDevices, szName);
+		}
+		if (bNew || (exported.lastUpdate != lastUpdate))
+		{
+			exported.lastUpdate = lastUpdate;
+			lua_pushstring(lua_state, lastUpdate.c_str());
+			lua_setfield(lua_state, tLastUpdate, szName);
+		}
+		if (bNew || (exported.sValue != sValue))
+		{
+			exported.sValue = sValue;
+			lua_pushstring(lua_state, sValue.c_str());
+			lua_setfield(lua_state, tSValues, szName);
+		}
+		if (bNew || (exported.lastLevel != lastLevel))
+		{
+			exported.lastLevel = lastLevel;
+			lua_pushnumber(lua_state, (lua_Number)lastLevel);
+			lua_setfield(lua_state, tLastLevel, szName);
+		}
+	}
+	lua_settop(lua_state, iBase);
+}
+
+void CEventSystem::SyncUserVariablesToLua(lua_State *lua_state)
+{
+	// Caller holds m_uservariablesMutex
+	bool bRebuild = false;
+	for (const auto &exported : m_luaExportedUserVariables)
+	{
+		auto itt = m_uservariables.find(exported.first);
+		if ((itt == m_uservariables.end()) || (itt->second.variableName != exported.second.variableName) || (itt->second.variableType != exported.second.variableType))
+		{
+			bRebuild = true;
+			break;
+		}
+	}
+	if (bRebuild)
+	{
+		m_luaExportedUserVariables.clear();
+		lua_createtable(lua_state, 0, (int)m_uservariables.size());
+		lua_setglobal(lua_state, "uservariables");
+		lua_createtable(lua_state, 0, (int)m_uservariables.size());
+		lua_setglobal(lua_state, "uservariables_lastupdate");
+	}
+
+	int iBase = lua_gettop(lua_state);
+	PushLuaGlobalTable(lua_state, "uservariables");
+	PushLuaGlobalTable(lua_state, "uservariables_lastupdate");
+	const int tValues = iBase + 1;
+	const int tLastUpdate = iBase + 2;
+
+	for (const auto &uservar : m_uservariables)
+	{
+		const _tUserVariable &uvitem = uservar.second;
+		auto itt = m_luaExportedUserVariables.find(uservar.first);
+		bool bNew = (itt == m_luaExportedUserVariables.end());
+		if (bNew || (itt->second.variableValue != uvitem.variableValue))
+		{
+			if (uvitem.variableType == 0)
+				lua_pushinteger(lua_state, (lua_Integer)atoi(uvitem.variableValue.c_str()));
+			else if (uvitem.variableType == 1)
+				lua_pushnumber(lua_state, (lua_Number)atof(uvitem.variableValue.c_str()));
+			else
+				lua_pushstring(lua_state, uvitem.variableValue.c_str());
+			lua_setfield(lua_state, tValues, uvitem.variableName.c_str());
+		}
+		if (bNew || (itt->second.lastUpdate != uvitem.lastUpdate))
+		{
+			lua_pushstring(lua_state, uvitem.lastUpdate.c_str());
+			lua_setfield(lua_state, tLastUpdate, uvitem.variableName.c_str());
+		}
+		m_luaExportedUserVariables[uservar.first] = uvitem;
+	}
+	lua_settop(lua_state, iBase);
+}
+
+void CEventSystem::SyncScenesGroupsToLua(lua_State *lua_state)
+{
+	// Caller holds m_scenesgroupsMutex
+	bool bRebuild = false;
+	for (const auto &exported : m_luaExportedScenesGroups)
+	{
+		auto itt = m_scenesgroups.find(exported.first);
+		if ((itt == m_scenesgroups.end()) || (itt->second.scenesgroupName != exported.second.scenesgroupName))
+		{
+			bRebuild = true;
+			break;
+		}
+	}
+	if (bRebuild)
+	{
+		m_luaExportedScenesGroups.clear();
+		lua_createtable(lua_state, 0, (int)m_scenesgroups.size());
+		lua_setglobal(lua_state, "otherdevices_scenesgroups");
+		lua_createtable(lua_state, 0, (int)m_scenesgroups.size());
+		lua_setglobal(lua_state, "otherdevices_scenesgroups_idx");
+	}
+
+	int iBase = lua_gettop(lua_state);
+	PushLuaGlobalTable(lua_state, "otherdevices_scenesgroups");
+	PushLuaGlobalTable(lua_state, "otherdevices_scenesgroups_idx");
+	const int tValues = iBase + 1;
+	const int tIdx = iBase + 2;
+
+	for (const auto &group : m_scenesgroups)
+	{
+		const _tScenesGroups &sgitem = group.second;
+		auto itt = m_luaExportedScenesGroups.find(group.first);
+		bool bNew = (itt == m_luaExportedScenesGroups.end());
+		if (bNew)
+		{
+			lua_pushinteger(lua_state, (lua_Integer)sgitem.ID);
+			lua_setfield(lua_state, tIdx, sgitem.scenesgroupName.c_str());
+		}
+		if (bNew || (itt->second.scenesgroupValue != sgitem.scenesgroupValue))
+		{
+			lua_pushstring(lua_state, sgitem.scenesgroupValue.c_str());
+			lua_setfield(lua_state, tValues, sgitem.scenesgroupName.c_str());
+		}
+		m_luaExportedScenesGroups[group.first] = sgitem;
+	}
+	lua_settop(lua_state, iBase);
+}
+
+void CEventSystem::EvaluateLuaClassic(lua_State *lua_state, const _tEventQueue &item, const int secStatus, const bool bPersistent)
+{
+	if (!bPersistent)
+	{
+		// reroute print library to Domoticz logger
+		luaL_openlibs(lua_state);
+		lua_pushcfunction(lua_state, l_domoticz_print);
+		lua_setglobal(lua_state, "print");
+	}
+	else
+	{
+		// These tables are not exported for every event, so do not let them survive into the next one
+		for (const char *szTable : szLuaEventTables)
+		{
+			lua_pushnil(lua_state);
+			lua_setglobal(lua_state, szTable);
+		}
+	}
 
 	{
 		std::lock_guard<std::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
@@ -2927,38 +3255,46 @@ void CEventSystem::EvaluateLuaClassic(lua_State *lua_state, const _tEventQueue &
 		}
 	}
 
-	ExportDeviceStatesToLua(lua_state, item);
+	if (bPersistent)
+		SyncDeviceStatesToLua(lua_state, item);
+	else
+		ExportDeviceStatesToLua(lua_state, item);
 
 	boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(m_uservariablesMutex);
 
 	CLuaTable luaTable(lua_state, "uservariables", (int)m_uservariables.size(), 0);
 
-	for (const auto &uservar : m_uservariables)
+	if (bPersistent)
+		SyncUserVariablesToLua(lua_state);
+	else
 	{
-		_tUserVariable uvitem = uservar.second;
-		if (uvitem.variableType == 0) {
-			//Integer
-			luaTable.AddInteger(uvitem.variableName, atoi(uvitem.variableValue.c_str()));
-		}
-		else if (uvitem.variableType == 1) {
-			//Float
-			luaTable.AddNumber(uvitem.variableName, atof(uvitem.variableValue.c_str()));
-		}
-		else {
-			//String,Date,Time
-			luaTable.AddString(uvitem.variableName, uvitem.variableValue);
+		for (const auto &uservar : m_uservariables)
+		{
+			_tUserVariable uvitem = uservar.second;
+			if (uvitem.variableType == 0) {
+				//Integer
+				luaTable.AddInteger(uvitem.variableName, atoi(uvitem.variableValue.c_str()));
+			}
+			else if (uvitem.variableType == 1) {
+				//Float
+				luaTable.AddNumber(uvitem.variableName, atof(uvitem.variableValue.c_str()));
+			}
+			else {
+				//String,Date,Time
+				luaTable.AddString(uvitem.variableName, uvitem.variableValue);
+			}
 		}
-	}
-	luaTable.Publish();
+		luaTable.Publish();
 
-	luaTable.InitTable(lua_state, "uservariables_lastupdate", (int)m_uservariables.size(), 0);
+		luaTable.InitTable(lua_state, "uservariables_lastupdate", (int)m_uservariables.size(), 0);
 
-	for (const auto &uservar : m_uservariables)
-	{
-		_tUserVariable uvitem = uservar.second;
-		luaTable.AddString(uvitem.variableName, uvitem.lastUpdate);
+		for (const auto &uservar : m_uservariables)
+		{
+			_tUserVariable uvitem = uservar.second;
+			luaTable.AddString(uvitem.variableName, uvitem.lastUpdate);
+		}
+		luaTable.Publish();
 	}
-	luaTable.Publish();
 
 	if (item.reason == REASON_USERVARIABLE) {
 		if (item.id > 0) {
@@ -2976,21 +3312,26 @@ void CEventSystem::EvaluateLuaClassic(lua_State *lua_state, const _tEventQueue &
 	uservariablesMutexLock.unlock();
 
 	boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(m_scenesgroupsMutex);
-	luaTable.InitTable(lua_state, "otherdevices_scenesgroups", (int)m_scenesgroups.size(), 0);
-	for (const auto &group : m_scenesgroups)
+	if (bPersistent)
+		SyncScenesGroupsToLua(lua_state);
+	else
 	{
-		_tScenesGroups sgitem = group.second;
-		luaTable.AddString(sgitem.scenesgroupName, sgitem.scenesgroupValue);
-	}
-	luaTable.Publish();
+		luaTable.InitTable(lua_state, "otherdevices_scenesgroups", (int)m_scenesgroups.size(), 0);
+		for (const auto &group : m_scenesgroups)
+		{
+			_tScenesGroups sgitem = group.second;
+			luaTable.AddString(sgitem.scenesgroupName, sgitem.scenesgroupValue);
+		}
+		luaTable.Publish();
 
-	luaTable.InitTable(lua_state, "otherdevices_scenesgroups_idx", (int)m_scenesgroups.size(), 0);
-	for (const auto &group : m_scenesgroups)
-	{
-		_tScenesGroups sgitem = group.second;
-		luaTable.AddInteger(sgitem.scenesgroupName, sgitem.ID);
+		luaTable.InitTable(lua_state, "otherdevices_scenesgroups_idx", (int)m_scenesgroups.size(), 0);
+		for (const auto &group : m_scenesgroups)
+		{
+			_tScenesGroups sgitem = group.second;
+			luaTable.AddInteger(sgitem.scenesgroupName, sgitem.ID);
+		}
+		luaTable.Publish();
 	}
-	luaTable.Publish();
 	scenesgroupsMutexLock.unlock();
 
 	luaTable.InitTable(lua_state, "globalvariables", 0, 0);
@@ -3019,28 +3360,21 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 {
 	std::lock_guard<std::mutex> l(luaMutex);
 
-	lua_State *lua_state;
-	lua_state = luaL_newstate();
-
-	// load Lua libraries
-	static const luaL_Reg lualibs[] = {
-		{ "base", luaopen_base },     { "io", luaopen_io },	{ "table", luaopen_table },
-		{ "string", luaopen_string }, { "math", luaopen_math }, { nullptr, nullptr },
-	};
+	CdzVents* dzvents = CdzVents::GetInstance();
+	bool bDzVents = (!m_sql.m_bDisableDzVentsSystem && filename == dzvents->m_runtimeDir + "dzVents.lua");
+	bool bPersistent = m_sql.m_bLuaPersistentStates;
+	if (!bPersistent)
+		ClosePersistentLuaState();
 
-	const luaL_Reg *lib = lualibs;
-	for (; lib->func != nullptr; lib++)
+	lua_State *lua_state;
+	if (bPersistent)
+		lua_state = (bDzVents) ? GetPersistentDzVentsState() : GetPersistentLuaState();
+	else
 	{
-		lib->func(lua_state);
-		lua_settop(lua_state, 0);
+		lua_state = luaL_newstate();
+		OpenLuaLibraries(lua_state);
 	}
 
-	lua_pushcfunction(lua_state, l_domoticz_applyJsonPath);
-	lua_setglobal(lua_state, "domoticz_applyJsonPath");
-
-	lua_pushcfunction(lua_state, l_domoticz_applyXPath);
-	lua_setglobal(lua_state, "domoticz_applyXPath");
-
 #ifdef _DEBUG
 	_log.Log(LOG_STATUS, "EventSystem: script %s trigger (%s)", m_szReason[items[0].reason].c_str(), filename.c_str());
 #endif
@@ -3101,11 +3435,19 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 
 	int secstatus = 0;
 	m_sql.GetPreferencesVar("SecStatus", secstatus);
-	CdzVents* dzvents = CdzVents::GetInstance();
-	if (!m_sql.m_bDisableDzVentsSystem && filename == dzvents->m_runtimeDir + "dzVents.lua")
-		dzvents->EvaluateDzVents(lua_state, items, secstatus);
+	if (bDzVents)
+		dzvents->EvaluateDzVents(lua_state, items, secstatus, bPersistent);
 	else
-		EvaluateLuaClassic(lua_state, items[0], secstatus);
+		EvaluateLuaClassic(lua_state, items[0], secstatus, bPersistent);
+
+	if (bPersistent)
+	{
+		if (bDzVents)
+			RunPersistentDzVents(filename);
+		else
+			RunPersistentLuaScript(filename, LuaString);
+		return;
+	}
 
 	int status = 0;
 	if (LuaString.length() == 0)
@@ -3171,7 +3513,9 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
 {
 	int status;
+	auto tStart = std::chrono::steady_clock::now();
 	status = lua_pcall(lua_state, 0, LUA_MULTRET, 0);
+	AddLuaScriptTiming(filename, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count());
 	report_errors(lua_state, status, filename);
 
 	bool scriptTrue = false;
@@ -3210,6 +3554,414 @@ void CEventSystem::luaStop(lua_State *L, lua_Debug *ar)
 	}
 }
 
+void CEventSystem::OpenLuaLibraries(lua_State *lua_state)
+{
+	// load Lua libraries
+	static const luaL_Reg lualibs[] = {
+		{ "base", luaopen_base },     { "io", luaopen_io },	{ "table", luaopen_table },
+		{ "string", luaopen_string }, { "math", luaopen_math }, { nullptr, nullptr },
+	};
+
+	const luaL_Reg *lib = lualibs;
+	for (; lib->func != nullptr; lib++)
+	{
+		lib->func(lua_state);
+		lua_settop(lua_state, 0);
+	}
+
+	lua_pushcfunction(lua_state, l_domoticz_applyJsonPath);
+	lua_setglobal(lua_state, "domoticz_applyJsonPath");
+
+	lua_pushcfunction(lua_state, l_domoticz_applyXPath);
+	lua_setglobal(lua_state, "domoticz_applyXPath");
+}
+
+lua_State *CEventSystem::GetPersistentLuaState()
+{
+	// Caller holds luaMutex
+	if (m_luaPersistentState != nullptr)
+		return m_luaPersistentState;
+
+	m_luaPersistentState = luaL_newstate();
+	OpenLuaLibraries(m_luaPersistentState);
+
+	// reroute print library to Domoticz logger
+	luaL_openlibs(m_luaPersistentState);
+	lua_pushcfunction(m_luaPersistentState, l_domoticz_print);
+	lua_setglobal(m_luaPersistentState, "print");
+	return m_luaPersistentState;
+}
+
+void CEventSystem::ClosePersistentLuaState()
+{
+	// Caller holds luaMutex
+	if (m_dzVentsPersistentState != nullptr)
+	{
+		lua_close(m_dzVentsPersistentState);
+		ForgetPersistentLuaState(true);
+	}
+	if (m_luaPersistentState != nullptr)
+	{
+		lua_close(m_luaPersistentState);
+		ForgetPersistentLuaState(false);
+	}
+}
+
+void CEventSystem::ForgetPersistentLuaState(const bool bDzVents)
+{
+	// Caller holds luaMutex, the next event creates a new state
+	if (bDzVents)
+	{
+		m_dzVentsPersistentState = nullptr;
+		CdzVents::GetInstance()->ResetExportedData();
+		return;
+	}
+	m_luaPersistentState = nullptr;
+	m_luaChunks.clear();
+	m_luaExportedDevices.clear();
+	m_luaExportedUserVariables.clear();
+	m_luaExportedScenesGroups.clear();
+}
+
+bool CEventSystem::RunPersistentLuaThread(lua_State *lua_state, const std::string &filename, int &status)
+{
+	// Runs the chunk on top of the stack in a luaThread, with the same 10 second limit as a script in its own state.
+	// Returns false when the script is still running, the state then belongs to that thread, which closes it when the script ends
+	struct _tRun
+	{
+		std::mutex mutex;
+		bool bDone = false;
+		bool bAbandoned = false;
+		int status = 0;
+	};
+	std::shared_ptr<_tRun> run = std::make_shared<_tRun>();
+
+	lua_sethook(lua_state, luaStop, LUA_MASKCOUNT, 10000000);
+	boost::thread aluaThread([this, lua_state, filename, run] {
+		auto tStart = std::chrono::steady_clock::now();
+		int result = lua_pcall(lua_state, 0, 0, 0);
+		AddLuaScriptTiming(filename, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count());
+		std::unique_lock<std::mutex> lock(run->mutex);
+		run->bDone = true;
+		run->status = result;
+		if (!run->bAbandoned)
+			return;
+		lock.unlock();
+		report_errors(lua_state, result, filename);
+		lua_close(lua_state);
+	});
+	SetThreadName(aluaThread.native_handle(), "luaThread");
+
+	if (!aluaThread.timed_join(boost::posix_time::seconds(10)))
+	{
+		std::lock_guard<std::mutex> lock(run->mutex);
+		if (!run->bDone)
+		{
+			run->bAbandoned = true;
+			aluaThread.detach();
+			_log.Log(LOG_ERROR, "EventSystem: Warning!, lua script %s has been running for more than 10 seconds", filename.c_str());
+			return false;
+		}
+	}
+	if (aluaThread.joinable())
+		aluaThread.join();
+	lua_sethook(lua_state, nullptr, 0, 0);
+	status = run->status;
+	return true;
+}
+
+bool CEventSystem::LoadPersistentLuaChunk(const std::string &filename, const std::string &LuaString)
+{
+	// Leaves the compiled script on top of the stack, scripts are only compiled again when they changed
+	lua_State *lua_state = m_luaPersistentState;
+
+	_tLuaChunk chunk;
+	chunk.mtime = 0;
+	chunk.size = LuaString.size();
+	chunk.hash = 0;
+	if (LuaString.empty())
+	{
+		struct stat st;
+		if (stat(filename.c_str(), &st) == 0)
+		{
+			chunk.mtime = st.st_mtime;
+			chunk.size = (size_t)st.st_size;
+		}
+	}
+	else
+		chunk.hash = std::hash<std::string>()(LuaString);
+
+	auto itt = m_luaChunks.find(filename);
+	if (itt != m_luaChunks.end())
+	{
+		if ((itt->second.mtime == chunk.mtime) && (itt->second.size == chunk.size) && (itt->second.hash == chunk.hash))
+		{
+			lua_rawgeti(lua_state, LUA_REGISTRYINDEX, itt->second.ref);
+			return true;
+		}
+		luaL_unref(lua_state, LUA_REGISTRYINDEX, itt->second.ref);
+		m_luaChunks.erase(itt);
+	}
+
+	int status = 0;
+	if (LuaString.empty())
+		status = luaL_loadfile(lua_state, filename.c_str());
+	else
+		status = luaL_loadstring(lua_state, LuaString.c_str());
+	if (status != 0)
+	{
+		report_errors(lua_state, status, filename);
+		return false;
+	}
+	lua_pushvalue(lua_state, -1);
+	chunk.ref = luaL_ref(lua_state, LUA_REGISTRYINDEX);
+	m_luaChunks[filename] = chunk;
+	return true;
+}
+
+void CEventSystem::RunPersistentLuaScript(const std::string &filename, const std::string &LuaString)
+{
+	lua_State *lua_state = m_luaPersistentState;
+	lua_settop(lua_state, 0);
+
+	if (!LoadPersistentLuaChunk(filename, LuaString))
+		return;
+
+	// Every run gets its own (empty) globals, reads fall through to the exported tables,
+	// what a script writes into otherdevices, uservariables, ... must not reach the next script
+	int tEnv = PushLuaScriptEnvironment(lua_state);
+	for (const char *szTable : szLuaSharedTables)
+		AddLuaSharedTableProxy(lua_state, tEnv, szTable);
+	for (const char *szTable : szLuaEventTables)
+		AddLuaSharedTableProxy(lua_state, tEnv, szTable);
+	lua_pushvalue(lua_state, tEnv);
+	lua_setupvalue(lua_state, 1, 1); // _ENV
+	lua_insert(lua_state, 1);
+	tEnv = 1;
+
+	int status = 0;
+	if (!RunPersistentLuaThread(lua_state, filename, status))
+	{
+		ForgetPersistentLuaState(false);
+		return;
+	}
+	report_errors(lua_state, status, filename);
+
+	bool scriptTrue = false;
+	lua_pushstring(lua_state, "commandArray");
+	lua_rawget(lua_state, tEnv);
+	if (lua_istable(lua_state, -1))
+	{
+		int tIndex = lua_gettop(lua_state);
+		scriptTrue = iterateLuaTable(lua_state, tIndex, filename);
+	}
+	else
+	{
+		if (status == 0)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Lua script %s did not return a commandArray", filename.c_str());
+		}
+	}
+
+	if (scriptTrue)
+	{
+		if (m_sql.m_bLogEventScriptTrigger)
+			_log.Log(LOG_STATUS, "EventSystem: Script event triggered: %s", filename.c_str());
+	}
+	lua_settop(lua_state, 0);
+
+	if (status == LUA_ERRMEM)
+		ClosePersistentLuaState();
+}
+
+static void CopyLuaTable(lua_State *lua_state, const int tIndex)
+{
+	// Pushes a shallow copy of the table at tIndex
+	lua_newtable(lua_state);
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, tIndex) != 0)
+	{
+		lua_pushvalue(lua_state, -2);
+		lua_insert(lua_state, -2);
+		lua_rawset(lua_state, -4);
+	}
+}
+
+static void RestoreLuaTable(lua_State *lua_state, const int tIndex, const int tCopy)
+{
+	// Gives the table at tIndex the fields of the copy at tCopy again (clearing fields is allowed during a traversal)
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, tIndex) != 0)
+	{
+		lua_pop(lua_state, 1);
+		lua_pushvalue(lua_state, -1);
+		lua_rawget(lua_state, tCopy);
+		bool bKeep = !lua_isnil(lua_state, -1);
+		lua_pop(lua_state, 1);
+		if (!bKeep)
+		{
+			lua_pushvalue(lua_state, -1);
+			lua_pushnil(lua_state);
+			lua_rawset(lua_state, tIndex);
+		}
+	}
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, tCopy) != 0)
+	{
+		lua_pushvalue(lua_state, -2);
+		lua_insert(lua_state, -2);
+		lua_rawset(lua_state, tIndex);
+	}
+}
+
+lua_State *CEventSystem::GetPersistentDzVentsState()
+{
+	// Caller holds luaMutex
+	// Every event starts from the globals and modules the state had when it was created,
+	// only domoticzData (kept in the registry by CdzVents) lives on
+	lua_State *lua_state = m_dzVentsPersistentState;
+	if (lua_state == nullptr)
+	{
+		lua_state = luaL_newstate();
+		OpenLuaLibraries(lua_state);
+		luaL_openlibs(lua_state);
+
+		lua_pushglobaltable(lua_state);
+		CopyLuaTable(lua_state, 1);
+		lua_setfield(lua_state, LUA_REGISTRYINDEX, "dzVents.globals");
+		lua_getfield(lua_state, 1, "package");
+		lua_getfield(lua_state, 2, "loaded");
+		CopyLuaTable(lua_state, 3);
+		lua_setfield(lua_state, LUA_REGISTRYINDEX, "dzVents.loaded");
+		lua_getfield(lua_state, 2, "path");
+		lua_setfield(lua_state, LUA_REGISTRYINDEX, "dzVents.path");
+		lua_getfield(lua_state, 2, "cpath");
+		lua_setfield(lua_state, LUA_REGISTRYINDEX, "dzVents.cpath");
+		lua_settop(lua_state, 0);
+		m_dzVentsPersistentState = lua_state;
+		return lua_state;
+	}
+
+	lua_settop(lua_state, 0);
+	lua_pushglobaltable(lua_state);
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, "dzVents.globals");
+	RestoreLuaTable(lua_state, 1, 2);
+	lua_getfield(lua_state, 1, "package");
+	lua_getfield(lua_state, 3, "loaded");
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, "dzVents.loaded");
+	RestoreLuaTable(lua_state, 4, 5);
+	// dzVents.lua prepends its directories on every run
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, "dzVents.path");
+	lua_setfield(lua_state, 3, "path");
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, "dzVents.cpath");
+	lua_setfield(lua_state, 3, "cpath");
+	lua_settop(lua_state, 0);
+	return lua_state;
+}
+
+void CEventSystem::RunPersistentDzVents(const std::string &filename)
+{
+	lua_State *lua_state = m_dzVentsPersistentState;
+
+	int status = luaL_loadfile(lua_state, filename.c_str());
+	if (status != 0)
+	{
+		report_errors(lua_state, status, filename);
+		lua_settop(lua_state, 0);
+		return;
+	}
+
+	if (!RunPersistentLuaThread(lua_state, filename, status))
+	{
+		ForgetPersistentLuaState(true);
+		return;
+	}
+	report_errors(lua_state, status, filename);
+
+	bool scriptTrue = false;
+	lua_getglobal(lua_state, "commandArray");
+	if (lua_istable(lua_state, -1))
+	{
+		int tIndex = lua_gettop(lua_state);
+		scriptTrue = iterateLuaTable(lua_state, tIndex, filename);
+	}
+	else
+	{
+		if (status == 0)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Lua script %s did not return a commandArray", filename.c_str());
+		}
+	}
+
+	if (scriptTrue)
+	{
+		if (m_sql.m_bLogEventScriptTrigger)
+			_log.Log(LOG_STATUS, "EventSystem: Script event triggered: %s", filename.c_str());
+	}
+	lua_settop(lua_state, 0);
+
+	if (status == LUA_ERRMEM)
+		ClosePersistentLuaState();
+}
+
+void CEventSystem::SetDzVentsChanged(const _eReason reason, const uint64_t ulDevID)
+{
+	std::lock_guard<std::mutex> l(m_dzVentsChangesMutex);
+	if (reason == REASON_DEVICE)
+		m_dzVentsChanges.devices.insert(ulDevID);
+	else if (reason == REASON_SCENEGROUP)
+		m_dzVentsChanges.scenesgroups.insert(ulDevID);
+	else if (reason == REASON_USERVARIABLE)
+		m_dzVentsChanges.uservariables.insert(ulDevID);
+}
+
+void CEventSystem::SetDzVentsListChanged()
+{
+	std::lock_guard<std::mutex> l(m_dzVentsChangesMutex);
+	m_dzVentsChanges.bListChanged = true;
+	m_dzVentsChanges.devices.clear();
+	m_dzVentsChanges.scenesgroups.clear();
+	m_dzVentsChanges.uservariables.clear();
+}
+
+void CEventSystem::GetDzVentsChanges(_tDzVentsChanges &changes)
+{
+	std::lock_guard<std::mutex> l(m_dzVentsChangesMutex);
+	changes = std::move(m_dzVentsChanges);
+	m_dzVentsChanges = _tDzVentsChanges();
+	m_dzVentsChanges.bListChanged = false;
+}
+
+void CEventSystem::AddLuaScriptTiming(const std::string &filename, const uint64_t usec)
+{
+	std::lock_guard<std::mutex> l(m_luaScriptStatsMutex);
+	_tLuaScriptStats &stats = m_luaScriptStats[filename];
+	stats.count++;
+	stats.total_us += usec;
+	stats.max_us = std::max(stats.max_us, usec);
+	size_t iBucket = 0;
+	while ((iBucket < sizeof(LuaHistogramBounds) / sizeof(LuaHistogramBounds[0])) && (usec >= LuaHistogramBounds[iBucket]))
+		iBucket++;
+	stats.buckets[iBucket]++;
+}
+
+void CEventSystem::GetLuaScriptStats(Json::Value &root)
+{
+	std::lock_guard<std::mutex> l(m_luaScriptStatsMutex);
+	int ii = 0;
+	for (const auto &itt : m_luaScriptStats)
+	{
+		const _tLuaScriptStats &stats = itt.second;
+		root[ii]["script"] = itt.first;
+		root[ii]["count"] = (Json::UInt64)stats.count;
+		root[ii]["avg_ms"] = (stats.count > 0) ? ((double)stats.total_us / stats.count / 1000.0) : 0.0;
+		root[ii]["max_ms"] = (double)stats.max_us / 1000.0;
+		for (size_t iBucket = 0; iBucket < sizeof(stats.buckets) / sizeof(stats.buckets[0]); iBucket++)
+			root[ii]["histogram"][szLuaHistogramLabels[iBucket]] = (Json::UInt64)stats.buckets[iBucket];
+		ii++;
+	}
+}
+
 bool CEventSystem::iterateLuaTable(lua_State *lua_state, const int tIndex, const std::string &filename)
 {
 	CdzVents* dzvents = CdzVents::GetInstance();
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <atomic>
+#include <set>
+#include <unordered_map>
 #include <boost/thread/shared_mutex.hpp>
 
 #include "../httpclient/HTTPClient.h"
@@ -10,9 +13,15 @@
 #include "StoppableTask.h"
 #include "NotificationObserver.h"
 
+namespace Json
+{
+	class Value;
+} // namespace Json
+
 class CEventSystem : public CLuaCommon, StoppableTask, CNotificationObserver
 {
 	friend class CdzVents;
+	friend class CdzVentsExport;
 	friend class CLuaHandler;
 	typedef struct lua_State lua_State;
 
@@ -136,11 +145,41 @@ public:
 	bool GetEventTrigger(uint64_t ulDevID, _eReason reason, bool bEventTrigger);
 	void SetEventTrigger(uint64_t ulDevID, _eReason reason, float fDelayTime);
 	bool CustomCommand(uint64_t idx, const std::string &sCommand);
+	void GetLuaScriptStats(Json::Value &root);
 
 	void TriggerURL(const std::string &result, const std::vector<std::string> &headerData, const std::string &callback);
 	void TriggerShellCommand(const std::string &result, const std::string &scriptstderr, const std::string &callback, int exitcode, bool timeoutOccurred);
 
 
+	struct _tEventQueue
+	{
+		_eReason reason;
+		uint64_t id;
+		std::string devname;
+		int nValue;
+		std::string sValue;
+		std::string nValueWording;
+		std::string lastUpdate;
+		std::string errorText;
+		bool timeoutOccurred;
+		uint8_t lastLevel;
+		std::vector<std::string> vData;
+		std::map<uint8_t, int> JsonMapInt;
+		std::map<uint8_t, float> JsonMapFloat;
+		std::map<uint8_t, bool> JsonMapBool;
+		std::map<uint8_t, std::string> JsonMapString;
+		queue_element_trigger* trigger = nullptr;
+	};
+
+	// Items changed since the previous dzVents event
+	struct _tDzVentsChanges
+	{
+		bool bListChanged = true; // items were added or removed, or all states were reloaded
+		std::set<uint64_t> devices;
+		std::set<uint64_t> scenesgroups;
+		std::set<uint64_t> uservariables;
+	};
+
 private:
 	enum _eJsonType
 	{
@@ -164,25 +203,6 @@ private:
 		time_t timestamp;
 	};
 
-	struct _tEventQueue
-	{
-		_eReason reason;
-		uint64_t id;
-		std::string devname;
-		int nValue;
-		std::string sValue;
-		std::string nValueWording;
-		std::string lastUpdate;
-		std::string errorText;
-		bool timeoutOccurred;
-		uint8_t lastLevel;
-		std::vector<std::string> vData;
-		std::map<uint8_t, int> JsonMapInt;
-		std::map<uint8_t, float> JsonMapFloat;
-		std::map<uint8_t, bool> JsonMapBool;
-		std::map<uint8_t, std::string> JsonMapString;
-		queue_element_trigger* trigger = nullptr;
-	};
 	concurrent_queue<_tEventQueue> m_eventqueue;
 
 	std::vector<_tEventTrigger> m_eventtrigger;
@@ -194,6 +214,60 @@ private:
 	boost::shared_mutex m_eventtriggerMutex;
 	std::mutex m_measurementStatesMutex;
 	std::mutex luaMutex;
+
+	// Long lived Lua state for the classic Lua scripts (LuaPersistentStates setting)
+	struct _tLuaChunk
+	{
+		int ref;
+		time_t mtime;
+		size_t size;
+		size_t hash;
+	};
+	struct _tLuaExportedDevice
+	{
+		std::string deviceName;
+		std::string nValueWording;
+		std::string lastUpdate;
+		std::string sValue;
+		uint8_t lastLevel;
+	};
+	struct _tLuaScriptStats
+	{
+		uint64_t count = 0;
+		uint64_t total_us = 0;
+		uint64_t max_us = 0;
+		uint64_t buckets[8] = {};
+	};
+	lua_State *m_luaPersistentState = nullptr;
+	std::map<std::string, _tLuaChunk> m_luaChunks;
+	std::map<uint64_t, _tLuaExportedDevice> m_luaExportedDevices;
+	std::map<uint64_t, _tUserVariable> m_luaExportedUserVariables;
+	std::map<uint64_t, _tScenesGroups> m_luaExportedScenesGroups;
+	std::mutex m_luaScriptStatsMutex;
+	std::map<std::string, _tLuaScriptStats> m_luaScriptStats;
+
+	// Long lived dzVents state, keeps domoticzData between events and only receives the changed items (_tDzVentsChanges)
+	lua_State *m_dzVentsPersistentState = nullptr;
+	std::mutex m_dzVentsChangesMutex;
+	_tDzVentsChanges m_dzVentsChanges;
+
+	// Script files per trigger, so events do not have to list the script directories
+	struct _tScriptIndex
+	{
+		bool bValid = false;
+		bool bDzVentsScripts = false;
+		std::vector<std::string> luaDevice; // _device_ scripts, in directory order
+		std::unordered_map<std::string, std::vector<size_t>> luaDeviceByName; // normalized device name -> luaDevice index
+		std::vector<size_t> luaDeviceAny; // luaDevice scripts not bound to an existing device
+		std::map<_eReason, std::vector<std::string>> lua;
+		std::map<_eReason, std::vector<std::string>> python;
+	};
+	_tScriptIndex m_scriptIndex;
+	std::mutex m_scriptIndexMutex;
+	std::atomic<bool> m_bScriptIndexDeviceNamesChanged{ false };
+	time_t m_scriptIndexTime = 0;
+	bool m_bScriptIndexPoll = true;
+	int m_inotifyFd = -1;
 	std::shared_ptr<std::thread> m_thread;
 	std::shared_ptr<std::thread> m_eventqueuethread;
 	StoppableTask m_TaskQueue;
@@ -211,6 +285,11 @@ private:
 	std::string UpdateSingleState(uint64_t ulDevID, const std::string &devname, int nValue, const std::string &sValue, unsigned char devType, unsigned char subType, _eSwitchType switchType,
 				      const std::string &lastUpdate, unsigned char lastLevel, unsigned char batteryLevel, const std::map<std::string, std::string> &options);
 	void EvaluateEvent(const std::vector<_tEventQueue> &items);
+	void UpdateScriptIndex();
+	void IndexDeviceScripts();
+	bool ScriptDirectoriesChanged();
+	void WatchScriptDirectories(const std::vector<std::string> &dirs);
+	void CloseScriptIndex();
 	void EvaluateDatabaseEvents(const _tEventQueue &item);
 	lua_State *ParseBlocklyLua(lua_State *lua_state, const _tEventItem &item);
 	bool parseBlocklyActions(const _tEventItem &item);
@@ -222,6 +301,19 @@ private:
 	void EvaluateLua(const _tEventQueue &item, const std::string &filename, const std::string &LuaString);
 	void EvaluateLua(const std::vector<_tEventQueue> &items, const std::string &filename, const std::string &LuaString);
 	void luaThread(lua_State *lua_state, const std::string &filename);
+	void OpenLuaLibraries(lua_State *lua_state);
+	lua_State *GetPersistentLuaState();
+	void ClosePersistentLuaState();
+	void ForgetPersistentLuaState(bool bDzVents);
+	bool RunPersistentLuaThread(lua_State *lua_state, const std::string &filename, int &status);
+	bool LoadPersistentLuaChunk(const std::string &filename, const std::string &LuaString);
+	void RunPersistentLuaScript(const std::string &filename, const std::string &LuaString);
+	lua_State *GetPersistentDzVentsState();
+	void RunPersistentDzVents(const std::string &filename);
+	void SetDzVentsChanged(_eReason reason, uint64_t ulDevID);
+	void SetDzVentsListChanged();
+	void GetDzVentsChanges(_tDzVentsChanges &changes);
+	void AddLuaScriptTiming(const std::string &filename, uint64_t usec);
 	static void luaStop(lua_State *L, lua_Debug *ar);
 	std::string nValueToWording(uint8_t dType, uint8_t dSubType, _eSwitchType switchtype, int nValue, const std::string &sValue, const std::map<std::string, std::string> &options);
 	static int l_domoticz_print(lua_State* lua_state);
@@ -237,7 +329,10 @@ private:
 	void EventQueueThread();
 	void UnlockEventQueueThread();
 	void ExportDeviceStatesToLua(lua_State *lua_state, const _tEventQueue &item);
-	void EvaluateLuaClassic(lua_State *lua_state, const _tEventQueue &item, int secStatus);
+	void SyncDeviceStatesToLua(lua_State *lua_state, const _tEventQueue &item);
+	void SyncUserVariablesToLua(lua_State *lua_state);
+	void SyncScenesGroupsToLua(lua_State *lua_state);
+	void EvaluateLuaClassic(lua_State *lua_state, const _tEventQueue &item, int secStatus, bool bPersistent);
 
 	//std::string reciprocalAction (std::string Action);
 	std::vector<_tEventItem> m_events;
@@ -0,0 +1,183 @@
+#include "stdafx.h"
+#include "IoContextPool.h"
+#include <boost/asio/deadline_timer.hpp>
+#include "Helper.h"
+#include "Logger.h"
+
+struct CIoContextPool::_tPeriodicTask
+{
+	explicit _tPeriodicTask(boost::asio::io_service &ios)
+		: ios(ios)
+		, timer(ios)
+	{
+	}
+	boost::asio::io_service &ios;
+	std::mutex mutex; // held while the callback runs, so Remove can wait for it
+	bool bStopped = false;
+	int interval = 0;
+	std::function<void()> callback;
+	std::shared_ptr<_tHandlerStats> stats;
+	boost::asio::deadline_timer timer;
+};
+
+void CIoContextPool::_tHandlerStats::Account(const std::chrono::steady_clock::time_point tStart)
+{
+	uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count();
+	handlers++;
+	total_us += duration;
+	uint64_t prev = max_us.load();
+	while ((duration > prev) && (!max_us.compare_exchange_weak(prev, duration)))
+		;
+}
+
+CIoContextPool::~CIoContextPool()
+{
+	Stop();
+}
+
+bool CIoContextPool::Start(int nThreads)
+{
+	if (m_bEnabled)
+		return true;
+	if (nThreads <= 0)
+		return false;
+	if (nThreads > IOCONTEXTPOOL_MAX_THREADS)
+		nThreads = IOCONTEXTPOOL_MAX_THREADS;
+
+	for (int ii = 0; ii < nThreads; ii++)
+	{
+		auto context = std::make_unique<_tContext>();
+		context->work = std::make_shared<boost::asio::io_service::work>(context->ios);
+		context->thread = std::make_shared<std::thread>([p = &context->ios] { p->run(); });
+		SetThreadName(context->thread->native_handle(), std_format("IoPool%d", ii).c_str());
+		m_contexts.push_back(std::move(context));
+	}
+	m_bEnabled = true;
+	_log.Log(LOG_STATUS, "IoPool: Hardware drivers share %d I/O threads", nThreads);
+	return true;
+}
+
+void CIoContextPool::Stop()
+{
+	if (!m_bEnabled)
+		return;
+	{
+		std::lock_guard<std::mutex> l(m_tasks_mutex);
+		for (auto &itt : m_tasks)
+		{
+			std::lock_guard<std::mutex> t(itt.second->mutex);
+			itt.second->bStopped = true;
+		}
+		m_tasks.clear();
+	}
+	for (auto &context : m_contexts)
+	{
+		context->work.reset();
+		context->ios.stop();
+	}
+	for (auto &context : m_contexts)
+	{
+		if (context->thread)
+		{
+			context->thread->join();
+			context->thread.reset();
+		}
+	}
+	m_contexts.clear();
+	m_bEnabled = false;
+}
+
+int CIoContextPool::GetThreadCount() const
+{
+	return static_cast<int>(m_contexts.size());
+}
+
+boost::asio::io_service &CIoContextPool::GetContext()
+{
+	return m_contexts[m_nextContext++ % m_contexts.size()]->ios;
+}
+
+int CIoContextPool::AddPeriodicTask(const std::string &label, const int intervalSeconds, const std::function<void()> &callback)
+{
+	if (!m_bEnabled)
+		return -1;
+
+	auto task = std::make_shared<_tPeriodicTask>(GetContext());
+	task->interval = (intervalSeconds > 0) ? intervalSeconds : 1;
+	task->callback = callback;
+	task->stats = GetHandlerStats(label);
+
+	int taskID;
+	{
+		std::lock_guard<std::mutex> l(m_tasks_mutex);
+		taskID = ++m_lastTaskID;
+		m_tasks[taskID] = task;
+	}
+	// timers are not thread safe, only touch them from the thread running their io_service
+	task->ios.post([this, task] { ArmPeriodicTask(task); });
+	return taskID;
+}
+
+void CIoContextPool::RemovePeriodicTask(const int taskID)
+{
+	std::shared_ptr<_tPeriodicTask> task;
+	{
+		std::lock_guard<std::mutex> l(m_tasks_mutex);
+		auto itt = m_tasks.find(taskID);
+		if (itt == m_tasks.end())
+			return;
+		task = itt->second;
+		m_tasks.erase(itt);
+	}
+	{
+		// waits for a running callback to finish
+		std::lock_guard<std::mutex> t(task->mutex);
+		task->bStopped = true;
+	}
+	task->ios.post([task] { task->timer.cancel(); });
+}
+
+void CIoContextPool::ArmPeriodicTask(const std::shared_ptr<_tPeriodicTask> &task)
+{
+	task->timer.expires_from_now(boost::posix_time::seconds(task->interval));
+	task->timer.async_wait([this, task](const boost::system::error_code &error) {
+		if (error)
+			return;
+		{
+			std::lock_guard<std::mutex> t(task->mutex);
+			if (task->bStopped)
+				return;
+			auto tStart = std::chrono::steady_clock::now();
+			task->callback();
+			task->stats->Account(tStart);
+		}
+		ArmPeriodicTask(task);
+	});
+}
+
+std::shared_ptr<CIoContextPool::_tHandlerStats> CIoContextPool::GetHandlerStats(const std::string &label)
+{
+	std::lock_guard<std::mutex> l(m_stats_mutex);
+	auto itt = m_stats.find(label);
+	if (itt != m_stats.end())
+		return itt->second;
+	auto stats = std::make_shared<_tHandlerStats>();
+	stats->label = label;
+	m_stats[label] = stats;
+	return stats;
+}
+
+void CIoContextPool::GetStatistics(std::vector<_tHandlerStatsSnapshot> &stats)
+{
+	stats.clear();
+	std::lock_guard<std::mutex> l(m_stats_mutex);
+	for (const auto &itt : m_stats)
+	{
+		_tHandlerStatsSnapshot snapshot;
+		snapshot.label = itt.first;
+		snapshot.handlers = itt.second->handlers;
+		snapshot.total_us = itt.second->total_us;
+		snapshot.max_us = itt.second->max_us;
+		stats.push_back(snapshot);
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ * IoContextPool.h
+ *
+ * Optional shared executor for the asynchronous hardware drivers. Instead of every ASyncTCP
+ * instance and every heartbeat running its own thread, they are multiplexed onto a fixed
+ * number of io_service threads. Each io_service is run by exactly one thread, so all handlers
+ * of a driver execute serialized, just like they did on the driver's own thread.
+ *
+ * The pool also keeps per-driver handler statistics (count, total and longest run time), so a
+ * driver that blocks its thread can be identified.
+ */
+#pragma once
+#ifndef MAIN_IOCONTEXTPOOL_H_
+#define MAIN_IOCONTEXTPOOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_service.hpp>
+
+#define IOCONTEXTPOOL_MAX_THREADS 64
+
+class CIoContextPool
+{
+      public:
+	struct _tHandlerStats
+	{
+		std::string label;
+		std::atomic<uint64_t> handlers{ 0 };
+		std::atomic<uint64_t> total_us{ 0 };
+		std::atomic<uint64_t> max_us{ 0 };
+
+		void Account(std::chrono::steady_clock::time_point tStart);
+	};
+	struct _tHandlerStatsSnapshot
+	{
+		std::string label;
+		uint64_t handlers;
+		uint64_t total_us;
+		uint64_t max_us;
+	};
+
+	CIoContextPool() = default;
+	~CIoContextPool();
+
+	// nThreads <= 0 leaves the pool disabled, drivers then keep their own threads
+	bool Start(int nThreads);
+	void Stop();
+	bool IsEnabled() const
+	{
+		return m_bEnabled;
+	}
+	int GetThreadCount() const;
+
+	// Returns the io_service a new driver should run on (round robin over the pool threads)
+	boost::asio::io_service &GetContext();
+
+	// Runs callback every intervalSeconds on a pool thread. After RemovePeriodicTask returns,
+	// the callback is not running and will not be called anymore.
+	int AddPeriodicTask(const std::string &label, int intervalSeconds, const std::function<void()> &callback);
+	void RemovePeriodicTask(int taskID);
+
+	// Statistics are kept also when the pool is disabled
+	std::shared_ptr<_tHandlerStats> GetHandlerStats(const std::string &label);
+	void GetStatistics(std::vector<_tHandlerStatsSnapshot> &stats);
+
+      private:
+	struct _tContext
+	{
+		boost::asio::io_service ios;
+		std::shared_ptr<boost::asio::io_service::work> work;
+		std::shared_ptr<std::thread> thread;
+	};
+	struct _tPeriodicTask;
+
+	void ArmPeriodicTask(const std::shared_ptr<_tPeriodicTask> &task);
+
+	bool m_bEnabled = false;
+	std::vector<std::unique_ptr<_tContext>> m_contexts;
+	std::atomic<size_t> m_nextContext{ 0 };
+
+	std::mutex m_tasks_mutex;
+	std::map<int, std::shared_ptr<_tPeriodicTask>> m_tasks;
+	int m_lastTaskID = 0;
+
+	std::mutex m_stats_mutex;
+	std::map<std::string, std::shared_ptr<_tHandlerStats>> m_stats;
+};
+
+extern CIoContextPool m_iocontextpool;
+
+#endif /* MAIN_IOCONTEXTPOOL_H_ */
@@ -20,6 +20,8 @@
 
 #define MAX_ACLFLOG_LINES 100000
 
+#define LOG_ASYNC_RING_SIZE 8192 // must be a power of 2
+
 extern bool g_bRunAsDaemon;
 extern bool g_bUseSyslog;
 
@@ -32,7 +34,6 @@ CLogger::_tLogLineStruct::_tLogLineStruct(const _eLogLevel nlevel, const std::st
 
 CLogger::CLogger()
 {
-	m_bInSequenceMode = false;
 	m_bEnableLogThreadIDs = false;
 	m_bEnableLogTimestamps = true;
 	m_bEnableErrorsToNotificationSystem = false;
@@ -43,10 +44,28 @@ CLogger::CLogger()
 
 CLogger::~CLogger()
 {
+	StopAsyncWriter();
 	if (m_outputfile.is_open())
 		m_outputfile.close();
 }
 
+void CLogger::_tLogLineRing::push(_tLogLineStruct &&line)
+{
+	if (lines.size() < MAX_LOG_LINE_BUFFER)
+		lines.push_back(std::move(line));
+	else
+		lines[next] = std::move(line);
+	next = (next + 1) % MAX_LOG_LINE_BUFFER;
+}
+
+// Visits the lines from oldest to newest
+template <typename F> void CLogger::_tLogLineRing::for_each(F f) const
+{
+	size_t start = (lines.size() < MAX_LOG_LINE_BUFFER) ? 0 : next;
+	for (size_t ii = 0; ii < lines.size(); ii++)
+		f(lines[(start + ii) % lines.size()]);
+}
+
 // Supported flags: all,normal,status,error,debug
 bool CLogger::SetLogFlags(const std::string &sFlags)
 {
@@ -262,85 +281,272 @@ void CLogger::Log(const _eLogLevel level, const char *logline, ...)
 	vsnprintf(cbuffer, sizeof(cbuffer), logline, argList);
 	va_end(argList);
 
-#ifndef WIN32
-	if (g_bUseSyslog)
-	{
-		int sLogLevel = LOG_INFO;
-		if (level & LOG_ERROR)
-			sLogLevel = LOG_ERR;
-		else if (level & LOG_STATUS)
-			sLogLevel = LOG_NOTICE;
-		syslog(sLogLevel, "%s", cbuffer);
-	}
-#endif
-
-	std::stringstream sstr;
+	std::string szIntLog;
+	szIntLog.reserve(strlen(cbuffer) + 40);
 
 	if (m_bEnableLogTimestamps)
-		sstr << TimeToString(nullptr, TF_DateTimeMs) << "  ";
+	{
+		szIntLog += TimeToString(nullptr, TF_DateTimeMs);
+		szIntLog += "  ";
+	}
 
 	if ((m_log_flags & LOG_DEBUG_INT) && (m_debug_flags & DEBUG_THREADIDS))
 	{
+		std::stringstream sstr;
 #ifdef WIN32
 		sstr << "[" << std::setfill('0') << std::setw(4) << std::hex << ::GetCurrentThreadId() << "] ";
 #else
 		sstr << "[" << std::setfill('0') << std::setw(4) << std::hex << pthread_self() << "] ";
 #endif
+		szIntLog += sstr.str();
 	}
 
 	if (level & LOG_STATUS)
-		sstr << "Status: " << cbuffer;
+		szIntLog += "Status: ";
 	else if (level & LOG_ERROR)
-		sstr << "Error: " << cbuffer;
+		szIntLog += "Error: ";
 	else if (level & LOG_DEBUG_INT)
-		sstr << "Debug: " << cbuffer;
-	else
-		sstr << cbuffer;
+		szIntLog += "Debug: ";
+	szIntLog += cbuffer;
+
+	if (QueueAsyncLine(level, std::move(szIntLog), cbuffer))
+		return;
 
-	std::string szIntLog = sstr.str();
+	WriteSyslog(level, cbuffer);
 
+	// Locked region to allow multiple threads to print at the same time
+	std::unique_lock<std::mutex> lock(m_mutex);
+	WriteLine(level, mytime(nullptr), szIntLog, true);
+}
+
+void CLogger::WriteSyslog(const _eLogLevel level, const char *szLogline)
+{
+#ifndef WIN32
+	if (g_bUseSyslog)
 	{
-		// Locked region to allow multiple threads to print at the same time
-		std::unique_lock<std::mutex> lock(m_mutex);
+		int sLogLevel = LOG_INFO;
+		if (level & LOG_ERROR)
+			sLogLevel = LOG_ERR;
+		else if (level & LOG_STATUS)
+			sLogLevel = LOG_NOTICE;
+		syslog(sLogLevel, "%s", szLogline);
+	}
+#endif
+}
+
+// Outputs a formatted line to the console, log file and in-memory logs, m_mutex has to be locked
+void CLogger::WriteLine(const _eLogLevel level, const time_t logtime, const std::string &szIntLog, const bool bFlush)
+{
+	_tLogLineStruct logline(level, szIntLog);
+	logline.logtime = logtime;
 
-		if ((level & LOG_ERROR) && (m_bEnableErrorsToNotificationSystem))
+	if ((level & LOG_ERROR) && (m_bEnableErrorsToNotificationSystem))
+	{
+		if (m_notification_log.size() >= MAX_LOG_LINE_BUFFER)
+			m_notification_log.erase(m_notification_log.begin());
+		m_notification_log.push_back(logline);
+		if ((m_notification_log.size() == 1) && (mytime(nullptr) - m_LastLogNotificationsSend >= 5))
 		{
-			if (m_notification_log.size() >= MAX_LOG_LINE_BUFFER)
-				m_notification_log.erase(m_notification_log.begin());
-			m_notification_log.push_back(_tLogLineStruct(level, szIntLog));
-			if ((m_notification_log.size() == 1) && (mytime(nullptr) - m_LastLogNotificationsSend >= 5))
-			{
-				m_mainworker.ForceLogNotificationCheck();
-			}
+			m_mainworker.ForceLogNotificationCheck();
 		}
+	}
 
-		if (!g_bRunAsDaemon)
-		{
-			// output to console
+	if (!g_bRunAsDaemon)
+	{
+		// output to console
 #ifndef WIN32
-			if (level != LOG_ERROR)
+		if (level != LOG_ERROR)
 #endif
-				std::cout << szIntLog << std::endl;
+			std::cout << szIntLog << '\n';
 #ifndef WIN32
-			else // print text in red color
-				std::cout << szIntLog.substr(0, 25) << "\033[1;31m" << szIntLog.substr(25) << "\033[0;0m" << std::endl;
+		else // print text in red color
+			std::cout << szIntLog.substr(0, 25) << "\033[1;31m" << szIntLog.substr(25) << "\033[0;0m" << '\n';
 #endif
-		}
+		if (bFlush)
+			std::cout.flush();
+	}
 
-		if (m_outputfile.is_open())
-		{
-			// output to file
-			m_outputfile << szIntLog << std::endl;
+	if (m_outputfile.is_open())
+	{
+		// output to file
+		m_outputfile << szIntLog << '\n';
+		if (bFlush)
 			m_outputfile.flush();
-		}
+	}
 
-		auto itt = m_lastlog.find(level);
-		if (itt != m_lastlog.end())
+	m_lastlog[level].push(std::move(logline));
+}
+
+void CLogger::StartAsyncWriter(const int iFlushIntervalMs)
+{
+	StopAsyncWriter();
+	if (iFlushIntervalMs <= 0)
+		return;
+
+	if (!m_async_ring)
+	{
+		m_async_ring.reset(new _tAsyncLogSlot[LOG_ASYNC_RING_SIZE]);
+		m_async_mask = LOG_ASYNC_RING_SIZE - 1;
+	}
+	for (size_t ii = 0; ii < LOG_ASYNC_RING_SIZE; ii++)
+		m_async_ring[ii].sequence.store(ii, std::memory_order_relaxed);
+	m_async_enqueue_pos.store(0, std::memory_order_relaxed);
+	m_async_dequeue_pos = 0;
+	m_async_dequeue_hint.store(0, std::memory_order_relaxed);
+	m_async_wakeup.store(false, std::memory_order_relaxed);
+
+	m_async_flush_interval = iFlushIntervalMs;
+	m_async_stop = false;
+	m_async_thread = std::make_shared<std::thread>([this] { Do_AsyncWork(); });
+	SetThreadName(m_async_thread->native_handle(), "Logger");
+	m_async_enabled.store(true, std::memory_order_release);
+}
+
+void CLogger::StopAsyncWriter()
+{
+	if (!m_async_thread)
+		return;
+
+	// New lines go directly to the outputs, wait for producers still busy with the ring
+	m_async_enabled.store(false, std::memory_order_release);
+	while (m_async_producers.load(std::memory_order_acquire) != 0)
+		std::this_thread::yield();
+
+	{
+		std::unique_lock<std::mutex> lock(m_async_mutex);
+		m_async_stop = true;
+	}
+	m_async_condition.notify_all();
+	m_async_thread->join();
+	m_async_thread.reset();
+	WriteAsyncLines();
+}
+
+// Lets following lines bypass the ring without waiting for the writer (used by the fatal signal handler)
+void CLogger::DisableAsyncWriter()
+{
+	m_async_enabled.store(false, std::memory_order_release);
+}
+
+bool CLogger::IsAsyncWriterEnabled()
+{
+	return m_async_enabled.load(std::memory_order_relaxed);
+}
+
+void CLogger::GetAsyncStatistics(uint64_t &written, uint64_t &dropped)
+{
+	written = m_async_written.load(std::memory_order_relaxed);
+	dropped = m_async_dropped.load(std::memory_order_relaxed);
+}
+
+// Stages a line for the writer thread, returns false when the line has to be written directly
+bool CLogger::QueueAsyncLine(const _eLogLevel level, std::string &&sLogline, const char *szSyslogLine)
+{
+	if (!m_async_enabled.load(std::memory_order_acquire))
+		return false;
+	m_async_producers.fetch_add(1, std::memory_order_acq_rel);
+	if (!m_async_enabled.load(std::memory_order_acquire))
+	{
+		m_async_producers.fetch_sub(1, std::memory_order_release);
+		return false;
+	}
+
+	_tAsyncLogSlot *slot = nullptr;
+	size_t pos = m_async_enqueue_pos.load(std::memory_order_relaxed);
+	while (true)
+	{
+		slot = &m_async_ring[pos & m_async_mask];
+		size_t seq = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0)
 		{
-			if (m_lastlog[level].size() >= MAX_LOG_LINE_BUFFER)
-				m_lastlog[level].erase(m_lastlog[level].begin());
+			if (m_async_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
 		}
-		m_lastlog[level].push_back(_tLogLineStruct(level, szIntLog));
+		else if (diff < 0)
+		{
+			// Ring is full, the writer is behind
+			m_async_dropped.fetch_add(1, std::memory_order_relaxed);
+			m_async_producers.fetch_sub(1, std::memory_order_release);
+			return true;
+		}
+		else
+			pos = m_async_enqueue_pos.load(std::memory_order_relaxed);
+	}
+	slot->level = level;
+	slot->logtime = mytime(nullptr);
+	slot->logmessage = std::move(sLogline);
+	if (g_bUseSyslog)
+		slot->syslogmessage = szSyslogLine;
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	m_async_producers.fetch_sub(1, std::memory_order_release);
+
+	// Wake the writer early when half of the ring is in use, instead of waiting for the flush interval
+	if (((pos - m_async_dequeue_hint.load(std::memory_order_relaxed)) == LOG_ASYNC_RING_SIZE / 2))
+	{
+		m_async_wakeup.store(true, std::memory_order_release);
+		m_async_condition.notify_one();
+	}
+	return true;
+}
+
+// Writes out all staged lines in one batch, only called by the writer (or after it stopped)
+size_t CLogger::WriteAsyncLines()
+{
+	if (!m_async_ring)
+		return 0;
+
+	size_t nLines = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		_tAsyncLogSlot &slot = m_async_ring[m_async_dequeue_pos & m_async_mask];
+		if (slot.sequence.load(std::memory_order_acquire) != m_async_dequeue_pos + 1)
+			break;
+		if (g_bUseSyslog)
+			WriteSyslog(slot.level, slot.syslogmessage.c_str());
+		WriteLine(slot.level, slot.logtime, slot.logmessage, false);
+		slot.logmessage.clear();
+		slot.syslogmessage.clear();
+		slot.sequence.store(m_async_dequeue_pos + m_async_mask + 1, std::memory_order_release);
+		m_async_dequeue_pos++;
+		nLines++;
+	}
+	m_async_dequeue_hint.store(m_async_dequeue_pos, std::memory_order_relaxed);
+
+	uint64_t dropped = m_async_dropped.load(std::memory_order_relaxed);
+	if (dropped != m_async_dropped_reported)
+	{
+		std::string szIntLog;
+		if (m_bEnableLogTimestamps)
+			szIntLog = TimeToString(nullptr, TF_DateTimeMs) + "  ";
+		szIntLog += std_format("Error: Logger: %llu log lines dropped, the log buffer was full", (unsigned long long)(dropped - m_async_dropped_reported));
+		m_async_dropped_reported = dropped;
+		WriteLine(LOG_ERROR, mytime(nullptr), szIntLog, false);
+		nLines++;
+	}
+
+	if (nLines != 0)
+	{
+		if (!g_bRunAsDaemon)
+			std::cout.flush();
+		if (m_outputfile.is_open())
+			m_outputfile.flush();
+		m_async_written.fetch_add(nLines, std::memory_order_relaxed);
+	}
+	return nLines;
+}
+
+void CLogger::Do_AsyncWork()
+{
+	std::unique_lock<std::mutex> lock(m_async_mutex);
+	while (!m_async_stop)
+	{
+		m_async_condition.wait_for(lock, std::chrono::milliseconds(m_async_flush_interval), [this] { return m_async_stop || m_async_wakeup.exchange(false); });
+		lock.unlock();
+		WriteAsyncLines();
+		lock.lock();
 	}
 }
 
@@ -409,45 +615,57 @@ bool strhasEnding(std::string const &fullString, std::string const &ending)
 	return fullString.size() >= ending.size() && !fullString.compare(fullString.size() - ending.size(), ending.size(), ending);
 }
 
+// A log sequence is built by a single decoder call chain, keep it per thread
+// so concurrent RX decode workers do not interleave their sequences
+namespace
+{
+	struct _tLogSequence
+	{
+		bool bInSequenceMode = false;
+		std::stringstream sequencestring;
+	};
+	thread_local _tLogSequence tl_LogSequence;
+} // namespace
+
 void CLogger::LogSequenceStart()
 {
-	m_bInSequenceMode = true;
-	m_sequencestring.clear();
-	m_sequencestring.str("");
+	tl_LogSequence.bInSequenceMode = true;
+	tl_LogSequence.sequencestring.clear();
+	tl_LogSequence.sequencestring.str("");
 }
 
 void CLogger::LogSequenceEnd(const _eLogLevel level)
 {
-	if (!m_bInSequenceMode)
+	if (!tl_LogSequence.bInSequenceMode)
 		return;
 
-	std::string message = m_sequencestring.str();
+	std::string message = tl_LogSequence.sequencestring.str();
 	if (strhasEnding(message, "\n"))
 	{
 		message = message.substr(0, message.size() - 1);
 	}
 
 	Log(level, message);
-	m_sequencestring.clear();
-	m_sequencestring.str("");
+	tl_LogSequence.sequencestring.clear();
+	tl_LogSequence.sequencestring.str("");
 
-	m_bInSequenceMode = false;
+	tl_LogSequence.bInSequenceMode = false;
 }
 
 void CLogger::LogSequenceAdd(const char *logline)
 {
-	if (!m_bInSequenceMode)
+	if (!tl_LogSequence.bInSequenceMode)
 		return;
 
-	m_sequencestring << logline << std::endl;
+	tl_LogSequence.sequencestring << logline << std::endl;
 }
 
 void CLogger::LogSequenceAddNoLF(const char *logline)
 {
-	if (!m_bInSequenceMode)
+	if (!tl_LogSequence.bInSequenceMode)
 		return;
 
-	m_sequencestring << logline;
+	tl_LogSequence.sequencestring << logline;
 }
 
 void CLogger::EnableLogTimestamps(const bool bEnableTimestamps)
@@ -472,14 +690,21 @@ std::list<CLogger::_tLogLineStruct> CLogger::GetLog(const _eLogLevel level, cons
 
 	if (level != LOG_ALL)
 	{
-		if (m_lastlog.find(level) == m_lastlog.end())
+		auto itt = m_lastlog.find(level);
+		if (itt == m_lastlog.end())
 			return mlist;
 
-		std::copy_if(std::begin(m_lastlog[level]), std::end(m_lastlog[level]), std::back_inserter(mlist), [lastlogtime](const _tLogLineStruct &l) { return l.logtime > lastlogtime; });
+		itt->second.for_each([&mlist, lastlogtime](const _tLogLineStruct &l) {
+			if (l.logtime > lastlogtime)
+				mlist.push_back(l);
+		});
 	}
 	else
 		for (const auto &l : m_lastlog)
-			std::copy_if(l.second.begin(), l.second.end(), std::back_inserter(mlist), [lastlogtime](const _tLogLineStruct &l2) { return l2.logtime > lastlogtime; });
+			l.second.for_each([&mlist, lastlogtime](const _tLogLineStruct &l2) {
+				if (l2.logtime > lastlogtime)
+					mlist.push_back(l2);
+			});
 
 	// Sort by time
 	mlist.sort(compareLogByTime);
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <list>
+#include <memory>
 #include <string>
 #include <fstream>
 
@@ -64,6 +67,13 @@ class CLogger
 	void SetACLFOutputFile(const char *OutputFile);
 	void OpenACLFOutputFile();
 
+	// Asynchronous mode: lines are staged in a lock-free ring and written by a background thread every iFlushIntervalMs
+	void StartAsyncWriter(int iFlushIntervalMs);
+	void StopAsyncWriter();
+	void DisableAsyncWriter();
+	bool IsAsyncWriterEnabled();
+	void GetAsyncStatistics(uint64_t &written, uint64_t &dropped);
+
 	void Log(_eLogLevel level, const std::string &sLogline);
 	void Log(_eLogLevel level, const char *logline, ...)
 #ifdef __GNUC__
@@ -99,6 +109,30 @@ class CLogger
 	bool NotificationLogsEnabled();
 
       private:
+	// Fixed size ring of the most recent lines of a log level
+	struct _tLogLineRing
+	{
+		std::vector<_tLogLineStruct> lines;
+		size_t next = 0;
+		void push(_tLogLineStruct &&line);
+		template <typename F> void for_each(F f) const;
+	};
+
+	struct _tAsyncLogSlot
+	{
+		std::atomic<size_t> sequence;
+		_eLogLevel level;
+		time_t logtime;
+		std::string logmessage;
+		std::string syslogmessage;
+	};
+
+	bool QueueAsyncLine(_eLogLevel level, std::string &&sLogline, const char *szSyslogLine);
+	void WriteLine(_eLogLevel level, time_t logtime, const std::string &sLogline, bool bFlush);
+	void WriteSyslog(_eLogLevel level, const char *szLogline);
+	size_t WriteAsyncLines();
+	void Do_AsyncWork();
+
 	uint32_t m_log_flags;
 	uint32_t m_debug_flags;
 	uint8_t m_aclf_flags;
@@ -108,13 +142,29 @@ class CLogger
 	std::ofstream m_outputfile;
 	const char *m_aclflogfile;
 	std::ofstream m_aclfoutputfile;
-	std::map<_eLogLevel, std::deque<_tLogLineStruct>> m_lastlog;
+	std::map<_eLogLevel, _tLogLineRing> m_lastlog;
 	std::deque<_tLogLineStruct> m_notification_log;
-	bool m_bInSequenceMode;
 	bool m_bEnableLogTimestamps;
 	bool m_bEnableLogThreadIDs;
 	bool m_bEnableErrorsToNotificationSystem;
 	time_t m_LastLogNotificationsSend;
-	std::stringstream m_sequencestring;
+
+	// Asynchronous writer, producers only touch the ring (bounded MPSC, sequence numbered slots)
+	std::unique_ptr<_tAsyncLogSlot[]> m_async_ring;
+	size_t m_async_mask = 0;
+	std::atomic<size_t> m_async_enqueue_pos{ 0 };
+	size_t m_async_dequeue_pos = 0;
+	std::atomic<size_t> m_async_dequeue_hint{ 0 };
+	std::atomic<bool> m_async_wakeup{ false };
+	std::atomic<bool> m_async_enabled{ false };
+	std::atomic<int> m_async_producers{ 0 };
+	std::atomic<uint64_t> m_async_dropped{ 0 };
+	std::atomic<uint64_t> m_async_written{ 0 };
+	uint64_t m_async_dropped_reported = 0;
+	int m_async_flush_interval = 0;
+	bool m_async_stop = false;
+	std::mutex m_async_mutex;
+	std::condition_variable m_async_condition;
+	std::shared_ptr<std::thread> m_async_thread;
 };
 extern CLogger _log;
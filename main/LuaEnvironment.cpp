@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "LuaEnvironment.h"
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include <string>
+
+static int l_LuaProxyNewIndex(lua_State *lua_state);
+
+// When the value at idx is a proxy that was not written yet, pushes the shared table it reads from
+static bool PushLuaProxyShared(lua_State *lua_state, const int idx)
+{
+	if (!lua_getmetatable(lua_state, idx))
+		return false;
+	lua_getfield(lua_state, -1, "__newindex");
+	bool bProxy = (lua_tocfunction(lua_state, -1) == l_LuaProxyNewIndex);
+	lua_pop(lua_state, 1);
+	if (!bProxy)
+	{
+		lua_pop(lua_state, 1);
+		return false;
+	}
+	lua_getfield(lua_state, -1, "__index");
+	lua_remove(lua_state, -2);
+	return true;
+}
+
+// next(), a proxy is walked in its shared table
+static int l_LuaProxyNext(lua_State *lua_state)
+{
+	if (PushLuaProxyShared(lua_state, 1))
+		lua_replace(lua_state, 1);
+	luaL_checktype(lua_state, 1, LUA_TTABLE);
+	lua_settop(lua_state, 2);
+	if (lua_next(lua_state, 1) != 0)
+		return 2;
+	lua_pushnil(lua_state);
+	return 1;
+}
+
+static int l_LuaProxyPairs(lua_State *lua_state)
+{
+	lua_pushcfunction(lua_state, l_LuaProxyNext);
+	PushLuaProxyShared(lua_state, 1);
+	lua_pushnil(lua_state);
+	return 3;
+}
+
+static int l_LuaProxyLen(lua_State *lua_state)
+{
+	PushLuaProxyShared(lua_state, 1);
+	lua_pushinteger(lua_state, static_cast<lua_Integer>(lua_rawlen(lua_state, -1)));
+	return 1;
+}
+
+// The first write turns the proxy into a private copy of the shared table, like the table the script got in its own state
+static int l_LuaProxyNewIndex(lua_State *lua_state)
+{
+	lua_settop(lua_state, 3);
+	lua_getmetatable(lua_state, 1);
+	lua_getfield(lua_state, -1, "__index");
+	const int tShared = lua_gettop(lua_state);
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, tShared) != 0)
+	{
+		lua_pushvalue(lua_state, -2);
+		lua_insert(lua_state, -2);
+		lua_rawset(lua_state, 1);
+	}
+	lua_pushnil(lua_state);
+	lua_setmetatable(lua_state, 1);
+	lua_settop(lua_state, 3);
+	lua_rawset(lua_state, 1);
+	return 0;
+}
+
+static int l_LuaProxyRawGet(lua_State *lua_state)
+{
+	if (PushLuaProxyShared(lua_state, 1))
+		lua_replace(lua_state, 1);
+	luaL_checktype(lua_state, 1, LUA_TTABLE);
+	luaL_checkany(lua_state, 2);
+	lua_settop(lua_state, 2);
+	lua_rawget(lua_state, 1);
+	return 1;
+}
+
+static int l_LuaProxyRawSet(lua_State *lua_state)
+{
+	luaL_checktype(lua_state, 1, LUA_TTABLE);
+	luaL_checkany(lua_state, 2);
+	luaL_checkany(lua_state, 3);
+	lua_settop(lua_state, 3);
+	if (PushLuaProxyShared(lua_state, 1))
+		l_LuaProxyNewIndex(lua_state);
+	else
+		lua_rawset(lua_state, 1);
+	lua_settop(lua_state, 1);
+	return 1;
+}
+
+static int l_LuaProxyRawLen(lua_State *lua_state)
+{
+	if (PushLuaProxyShared(lua_state, 1))
+		lua_replace(lua_state, 1);
+	int t = lua_type(lua_state, 1);
+	luaL_argcheck(lua_state, (t == LUA_TTABLE) || (t == LUA_TSTRING), 1, "table or string expected");
+	lua_pushinteger(lua_state, static_cast<lua_Integer>(lua_rawlen(lua_state, 1)));
+	return 1;
+}
+
+int PushLuaScriptEnvironment(lua_State *lua_state)
+{
+	static const luaL_Reg rawfuncs[] = {
+		{ "next", l_LuaProxyNext }, { "rawget", l_LuaProxyRawGet }, { "rawset", l_LuaProxyRawSet }, { "rawlen", l_LuaProxyRawLen }, { nullptr, nullptr },
+	};
+
+	lua_newtable(lua_state);
+	const int tEnv = lua_gettop(lua_state);
+	lua_createtable(lua_state, 0, 1);
+	lua_pushglobaltable(lua_state);
+	lua_setfield(lua_state, -2, "__index");
+	lua_setmetatable(lua_state, tEnv);
+	// _G.x = ... must not reach the shared globals either
+	lua_pushvalue(lua_state, tEnv);
+	lua_setfield(lua_state, tEnv, "_G");
+	luaL_setfuncs(lua_state, rawfuncs, 0);
+	return tEnv;
+}
+
+void AddLuaSharedTableProxy(lua_State *lua_state, const int tEnv, const char *szTable)
+{
+	lua_getglobal(lua_state, szTable);
+	if (!lua_istable(lua_state, -1))
+	{
+		lua_pop(lua_state, 1);
+		return;
+	}
+	std::string szKey = std::string("LuaEnvironment.proxy.") + szTable;
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, szKey.c_str());
+	if (!lua_istable(lua_state, -1))
+	{
+		lua_pop(lua_state, 1);
+		lua_createtable(lua_state, 0, 4);
+		lua_pushcfunction(lua_state, l_LuaProxyNewIndex);
+		lua_setfield(lua_state, -2, "__newindex");
+		lua_pushcfunction(lua_state, l_LuaProxyPairs);
+		lua_setfield(lua_state, -2, "__pairs");
+		lua_pushcfunction(lua_state, l_LuaProxyLen);
+		lua_setfield(lua_state, -2, "__len");
+		lua_pushvalue(lua_state, -1);
+		lua_setfield(lua_state, LUA_REGISTRYINDEX, szKey.c_str());
+	}
+	// the shared table itself is replaced when it is rebuilt, and every event for the per event ones
+	lua_insert(lua_state, -2);
+	lua_setfield(lua_state, -2, "__index");
+	lua_createtable(lua_state, 0, 0);
+	lua_insert(lua_state, -2);
+	lua_setmetatable(lua_state, -2);
+	lua_setfield(lua_state, tEnv, szTable);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+struct lua_State;
+
+// Per run globals for classic Lua scripts that share one persistent state
+//
+// PushLuaScriptEnvironment pushes a new environment table and returns its stack index, set it as the _ENV upvalue of the
+// script chunk. Reads fall through to the global table, _G is the environment itself and next/rawget/rawset/rawlen
+// also work on the proxies added with AddLuaSharedTableProxy.
+// A proxy reads (index, #, pairs) from the shared global table, the first write turns it into a private copy,
+// so nothing a script writes reaches the shared globals or the next script.
+int PushLuaScriptEnvironment(lua_State *lua_state);
+void AddLuaSharedTableProxy(lua_State *lua_state, int tEnv, const char *szTable);
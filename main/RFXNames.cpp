@@ -1,7 +1,6 @@
 #include "stdafx.h"
 #include "RFXNames.h"
 #include "RFXtrx.h"
-#include "../hardware/EvohomeBase.h"
 #include "../hardware/hardwaretypes.h"
 #include "Helper.h"
 #include "Logger.h"
@@ -48,13 +47,122 @@ const char* findTableID1ID2(const _STR_TABLE_ID1_ID2* t, const unsigned long id1
 	return "Unknown";
 }
 
+// Lookup indexes for the descriptor tables below, built by the compiler.
+// They return the same result as the linear finders above (first matching entry,
+// stopping at the terminator), but in constant time.
+
+// Single id tables: position (+1, 0 = not present) of the first entry for every id up to MaxID
+template <unsigned long MaxID> struct _tTableIndexSingle
+{
+	uint16_t pos1[MaxID + 1];
+	uint16_t pos2[MaxID + 1];
+};
+
+template <size_t N> constexpr unsigned long TableMaxID(const STR_TABLE_SINGLE (&t)[N])
+{
+	unsigned long maxID = 0;
+	for (size_t ii = 0; ii < N; ii++)
+	{
+		if ((t[ii].str1 || t[ii].str2) && (t[ii].id > maxID))
+			maxID = t[ii].id;
+	}
+	return maxID;
+}
+
+template <unsigned long MaxID, size_t N> constexpr _tTableIndexSingle<MaxID> MakeTableIndex(const STR_TABLE_SINGLE (&t)[N])
+{
+	static_assert(MaxID < 4096, "table id range too large for a direct index");
+	static_assert(N < 65535, "table too large for a 16 bit index");
+	_tTableIndexSingle<MaxID> index{};
+	for (size_t ii = 0; (ii < N) && t[ii].str1; ii++)
+	{
+		if (index.pos1[t[ii].id] == 0)
+			index.pos1[t[ii].id] = static_cast<uint16_t>(ii + 1);
+	}
+	for (size_t ii = 0; (ii < N) && t[ii].str2; ii++)
+	{
+		if (index.pos2[t[ii].id] == 0)
+			index.pos2[t[ii].id] = static_cast<uint16_t>(ii + 1);
+	}
+	return index;
+}
+
+template <unsigned long MaxID> const char* findTableIndexSingle1(const STR_TABLE_SINGLE* t, const _tTableIndexSingle<MaxID>& index, const unsigned long id)
+{
+	if ((id > MaxID) || (index.pos1[id] == 0))
+		return "Unknown";
+	return t[index.pos1[id] - 1].str1;
+}
+
+template <unsigned long MaxID> const char* findTableIndexSingle2(const STR_TABLE_SINGLE* t, const _tTableIndexSingle<MaxID>& index, const unsigned long id)
+{
+	if ((id > MaxID) || (index.pos2[id] == 0))
+		return "Unknown";
+	return t[index.pos2[id] - 1].str2;
+}
+
+// Two id tables: open addressing hash on (id1,id2), at most half filled
+template <size_t Slots> struct _tTableIndexID1ID2
+{
+	uint16_t pos[Slots];
+};
+
+constexpr size_t TableIndexSlots(const size_t entries)
+{
+	size_t slots = 16;
+	while (slots < entries * 2)
+		slots <<= 1;
+	return slots;
+}
+
+constexpr size_t TableIndexHash(const unsigned long id1, const unsigned long id2)
+{
+	uint32_t h = static_cast<uint32_t>((id1 << 16) ^ id2) * 0x9E3779B1U;
+	return static_cast<size_t>(h ^ (h >> 15));
+}
+
+template <size_t Slots, size_t N> constexpr _tTableIndexID1ID2<Slots> MakeTableIndex(const STR_TABLE_ID1_ID2 (&t)[N])
+{
+	static_assert(N < 65535, "table too large for a 16 bit index");
+	_tTableIndexID1ID2<Slots> index{};
+	for (size_t ii = 0; (ii < N) && t[ii].str1; ii++)
+	{
+		size_t slot = TableIndexHash(t[ii].id1, t[ii].id2) & (Slots - 1);
+		while (index.pos[slot] != 0)
+		{
+			const STR_TABLE_ID1_ID2& e = t[index.pos[slot] - 1];
+			if ((e.id1 == t[ii].id1) && (e.id2 == t[ii].id2))
+				break; // keep the first entry, like the linear search does
+			slot = (slot + 1) & (Slots - 1);
+		}
+		if (index.pos[slot] == 0)
+			index.pos[slot] = static_cast<uint16_t>(ii + 1);
+	}
+	return index;
+}
+
+template <size_t Slots> const char* findTableIndexID1ID2(const STR_TABLE_ID1_ID2* t, const _tTableIndexID1ID2<Slots>& index, const unsigned long id1, const unsigned long id2)
+{
+	size_t slot = TableIndexHash(id1, id2) & (Slots - 1);
+	while (index.pos[slot] != 0)
+	{
+		const STR_TABLE_ID1_ID2& e = t[index.pos[slot] - 1];
+		if ((e.id1 == id1) && (e.id2 == id2))
+			return e.str1;
+		slot = (slot + 1) & (Slots - 1);
+	}
+	return "Unknown";
+}
+
+static constexpr STR_TABLE_SINGLE HumidityStatusTable[] = {
+	{ humstat_normal, "Normal" }, { humstat_comfort, "Comfortable" }, { humstat_dry, "Dry" }, { humstat_wet, "Wet" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto HumidityStatusIndex = MakeTableIndex<TableMaxID(HumidityStatusTable)>(HumidityStatusTable);
+
 const char* RFX_Humidity_Status_Desc(const unsigned char status)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ humstat_normal, "Normal" }, { humstat_comfort, "Comfortable" }, { humstat_dry, "Dry" }, { humstat_wet, "Wet" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, status);
+	return findTableIndexSingle1(HumidityStatusTable, HumidityStatusIndex, status);
 }
 
 unsigned char Get_Humidity_Level(const unsigned char hlevel)
@@ -68,89 +176,95 @@ unsigned char Get_Humidity_Level(const unsigned char hlevel)
 	return humstat_normal;
 }
 
+static constexpr STR_TABLE_SINGLE SecurityStatusTable[] = {
+	{ sStatusNormal, "Normal" },
+	{ sStatusNormalDelayed, "Normal Delayed" },
+	{ sStatusAlarm, "Alarm" },
+	{ sStatusAlarmDelayed, "Alarm Delayed" },
+	{ sStatusMotion, "Motion" },
+	{ sStatusNoMotion, "No Motion" },
+	{ sStatusPanic, "Panic" },
+	{ sStatusPanicOff, "Panic End" },
+	{ sStatusArmAway, "Arm Away" },
+	{ sStatusArmAwayDelayed, "Arm Away Delayed" },
+	{ sStatusArmHome, "Arm Home" },
+	{ sStatusArmHomeDelayed, "Arm Home Delayed" },
+	{ sStatusDisarm, "Disarm" },
+	{ sStatusLightOff, "Light Off" },
+	{ sStatusLightOn, "Light On" },
+	{ sStatusLight2Off, "Light 2 Off" },
+	{ sStatusLight2On, "Light 2 On" },
+	{ sStatusDark, "Dark detected" },
+	{ sStatusLight, "Light Detected" },
+	{ sStatusBatLow, "Battery low MS10 or XX18 sensor" },
+	{ sStatusPairKD101, "Pair KD101" },
+	{ sStatusNormalTamper, "Normal + Tamper" },
+	{ sStatusNormalDelayedTamper, "Normal Delayed + Tamper" },
+	{ sStatusAlarmTamper, "Alarm + Tamper" },
+	{ sStatusAlarmDelayedTamper, "Alarm Delayed + Tamper" },
+	{ sStatusMotionTamper, "Motion + Tamper" },
+	{ sStatusNoMotionTamper, "No Motion + Tamper" },
+	{ 0, nullptr },
+};
+static constexpr auto SecurityStatusIndex = MakeTableIndex<TableMaxID(SecurityStatusTable)>(SecurityStatusTable);
+
 const char* Security_Status_Desc(const unsigned char status)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ sStatusNormal, "Normal" },
-		{ sStatusNormalDelayed, "Normal Delayed" },
-		{ sStatusAlarm, "Alarm" },
-		{ sStatusAlarmDelayed, "Alarm Delayed" },
-		{ sStatusMotion, "Motion" },
-		{ sStatusNoMotion, "No Motion" },
-		{ sStatusPanic, "Panic" },
-		{ sStatusPanicOff, "Panic End" },
-		{ sStatusArmAway, "Arm Away" },
-		{ sStatusArmAwayDelayed, "Arm Away Delayed" },
-		{ sStatusArmHome, "Arm Home" },
-		{ sStatusArmHomeDelayed, "Arm Home Delayed" },
-		{ sStatusDisarm, "Disarm" },
-		{ sStatusLightOff, "Light Off" },
-		{ sStatusLightOn, "Light On" },
-		{ sStatusLight2Off, "Light 2 Off" },
-		{ sStatusLight2On, "Light 2 On" },
-		{ sStatusDark, "Dark detected" },
-		{ sStatusLight, "Light Detected" },
-		{ sStatusBatLow, "Battery low MS10 or XX18 sensor" },
-		{ sStatusPairKD101, "Pair KD101" },
-		{ sStatusNormalTamper, "Normal + Tamper" },
-		{ sStatusNormalDelayedTamper, "Normal Delayed + Tamper" },
-		{ sStatusAlarmTamper, "Alarm + Tamper" },
-		{ sStatusAlarmDelayedTamper, "Alarm Delayed + Tamper" },
-		{ sStatusMotionTamper, "Motion + Tamper" },
-		{ sStatusNoMotionTamper, "No Motion + Tamper" },
-		{ 0, nullptr },
-	};
-	return findTableIDSingle1(Table, status);
+	return findTableIndexSingle1(SecurityStatusTable, SecurityStatusIndex, status);
 }
 
+static constexpr STR_TABLE_SINGLE TimerTypeTable[] = {
+	{ TTYPE_BEFORESUNRISE, "Before Sunrise" },
+	{ TTYPE_AFTERSUNRISE, "After Sunrise" },
+	{ TTYPE_ONTIME, "On Time" },
+	{ TTYPE_BEFORESUNSET, "Before Sunset" },
+	{ TTYPE_AFTERSUNSET, "After Sunset" },
+	{ TTYPE_FIXEDDATETIME, "Fixed Date/Time" },
+	{ TTYPE_DAYSODD, "Odd Day Numbers" },
+	{ TTYPE_DAYSEVEN, "Even Day Numbers" },
+	{ TTYPE_WEEKSODD, "Odd Week Numbers" },
+	{ TTYPE_WEEKSEVEN, "Even Week Numbers" },
+	{ TTYPE_MONTHLY, "Monthly" },
+	{ TTYPE_MONTHLY_WD, "Monthly (Weekday)" },
+	{ TTYPE_YEARLY, "Yearly" },
+	{ TTYPE_YEARLY_WD, "Yearly (Weekday)" },
+	{ TTYPE_BEFORESUNATSOUTH, "Before Sun at South" },
+	{ TTYPE_AFTERSUNATSOUTH, "After Sun at South" },
+	{ TTYPE_BEFORECIVTWSTART, "Before Civil Twilight Start" },
+	{ TTYPE_AFTERCIVTWSTART, "After Civil Twilight Start" },
+	{ TTYPE_BEFORECIVTWEND, "Before Civil Twilight End" },
+	{ TTYPE_AFTERCIVTWEND, "After Civil Twilight End" },
+	{ TTYPE_BEFORENAUTTWSTART, "Before Nautical Twilight Start" },
+	{ TTYPE_AFTERNAUTTWSTART, "After Nautical Twilight Start" },
+	{ TTYPE_BEFORENAUTTWEND, "Before Nautical Twilight End" },
+	{ TTYPE_AFTERNAUTTWEND, "After Nautical Twilight End" },
+	{ TTYPE_BEFOREASTTWSTART, "Before Astronomical Twilight Start" },
+	{ TTYPE_AFTERASTTWSTART, "After Astronomical Twilight Start" },
+	{ TTYPE_BEFOREASTTWEND, "Before Astronomical Twilight End" },
+	{ TTYPE_AFTERASTTWEND, "After Astronomical Twilight End" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto TimerTypeIndex = MakeTableIndex<TableMaxID(TimerTypeTable)>(TimerTypeTable);
+
 const char* Timer_Type_Desc(const int tType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ TTYPE_BEFORESUNRISE, "Before Sunrise" },
-		{ TTYPE_AFTERSUNRISE, "After Sunrise" },
-		{ TTYPE_ONTIME, "On Time" },
-		{ TTYPE_BEFORESUNSET, "Before Sunset" },
-		{ TTYPE_AFTERSUNSET, "After Sunset" },
-		{ TTYPE_FIXEDDATETIME, "Fixed Date/Time" },
-		{ TTYPE_DAYSODD, "Odd Day Numbers" },
-		{ TTYPE_DAYSEVEN, "Even Day Numbers" },
-		{ TTYPE_WEEKSODD, "Odd Week Numbers" },
-		{ TTYPE_WEEKSEVEN, "Even Week Numbers" },
-		{ TTYPE_MONTHLY, "Monthly" },
-		{ TTYPE_MONTHLY_WD, "Monthly (Weekday)" },
-		{ TTYPE_YEARLY, "Yearly" },
-		{ TTYPE_YEARLY_WD, "Yearly (Weekday)" },
-		{ TTYPE_BEFORESUNATSOUTH, "Before Sun at South" },
-		{ TTYPE_AFTERSUNATSOUTH, "After Sun at South" },
-		{ TTYPE_BEFORECIVTWSTART, "Before Civil Twilight Start" },
-		{ TTYPE_AFTERCIVTWSTART, "After Civil Twilight Start" },
-		{ TTYPE_BEFORECIVTWEND, "Before Civil Twilight End" },
-		{ TTYPE_AFTERCIVTWEND, "After Civil Twilight End" },
-		{ TTYPE_BEFORENAUTTWSTART, "Before Nautical Twilight Start" },
-		{ TTYPE_AFTERNAUTTWSTART, "After Nautical Twilight Start" },
-		{ TTYPE_BEFORENAUTTWEND, "Before Nautical Twilight End" },
-		{ TTYPE_AFTERNAUTTWEND, "After Nautical Twilight End" },
-		{ TTYPE_BEFOREASTTWSTART, "Before Astronomical Twilight Start" },
-		{ TTYPE_AFTERASTTWSTART, "After Astronomical Twilight Start" },
-		{ TTYPE_BEFOREASTTWEND, "Before Astronomical Twilight End" },
-		{ TTYPE_AFTERASTTWEND, "After Astronomical Twilight End" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, tType);
+	return findTableIndexSingle1(TimerTypeTable, TimerTypeIndex, tType);
 }
 
+static constexpr STR_TABLE_SINGLE TimerCmdTable[] = {
+	{ TCMD_ON, "On" },
+	{ TCMD_OFF, "Off" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto TimerCmdIndex = MakeTableIndex<TableMaxID(TimerCmdTable)>(TimerCmdTable);
+
 const char* Timer_Cmd_Desc(const int tType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ TCMD_ON, "On" },
-		{ TCMD_OFF, "Off" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, tType);
+	return findTableIndexSingle1(TimerCmdTable, TimerCmdIndex, tType);
 }
 
 //ID, Long description, short description
-static const STR_TABLE_SINGLE HardwareTypeTable[] = {
+static constexpr STR_TABLE_SINGLE HardwareTypeTable[] = {
 	{ HTYPE_RFXtrx315, "RFXCOM - RFXtrx315 USB 315MHz Transceiver", "RFXCOM" },
 	{ HTYPE_RFXtrx433, "RFXCOM - RFXtrx433 USB 433.92MHz Transceiver", "RFXCOM" },
 	{ HTYPE_RFXLAN, "RFXCOM - RFXtrx shared over LAN interface", "RFXCOM" },
@@ -281,714 +395,737 @@ static const STR_TABLE_SINGLE HardwareTypeTable[] = {
 	{ HTYPE_RFLINKMQTT, "RFLink Gateway MQTT",	"RFLink" },
 	{ 0, nullptr, nullptr },
 };
+static constexpr auto HardwareTypeIndex = MakeTableIndex<TableMaxID(HardwareTypeTable)>(HardwareTypeTable);
 
 const char* Hardware_Type_Desc(int hType)
 {
-	return findTableIDSingle1(HardwareTypeTable, hType);
+	return findTableIndexSingle1(HardwareTypeTable, HardwareTypeIndex, hType);
 }
 
 const char* Hardware_Short_Desc(int hType)
 {
-	return findTableIDSingle2(HardwareTypeTable, hType);
+	return findTableIndexSingle2(HardwareTypeTable, HardwareTypeIndex, hType);
 }
 
+static constexpr STR_TABLE_SINGLE SwitchTypeTable[] = {
+	{ STYPE_OnOff, "On/Off" },
+	{ STYPE_Doorbell, "Doorbell" },
+	{ STYPE_Contact, "Contact" },
+	{ STYPE_Blinds, "Blinds" },
+	{ STYPE_X10Siren, "X10 Siren" },
+	{ STYPE_SMOKEDETECTOR, "Smoke Detector" },
+	{ STYPE_Dimmer, "Dimmer" },
+	{ STYPE_Motion, "Motion Sensor" },
+	{ STYPE_PushOn, "Push On Button" },
+	{ STYPE_PushOff, "Push Off Button" },
+	{ STYPE_DoorContact, "Door Contact" },
+	{ STYPE_Dusk, "Dusk Sensor" },
+	{ STYPE_BlindsPercentage, "Blinds Percentage" },
+	{ STYPE_VenetianBlindsUS, "Venetian Blinds US" },
+	{ STYPE_VenetianBlindsEU, "Venetian Blinds EU" },
+	{ STYPE_Media, "Media Player" },
+	{ STYPE_Selector, "Selector" },
+	{ STYPE_DoorLock, "Door Lock" },
+	{ STYPE_DoorLockInverted, "Door Lock Inverted" },
+	{ STYPE_BlindsPercentageWithStop, "Blinds + Stop" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto SwitchTypeIndex = MakeTableIndex<TableMaxID(SwitchTypeTable)>(SwitchTypeTable);
+
 const char* Switch_Type_Desc(const _eSwitchType sType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ STYPE_OnOff, "On/Off" },
-		{ STYPE_Doorbell, "Doorbell" },
-		{ STYPE_Contact, "Contact" },
-		{ STYPE_Blinds, "Blinds" },
-		{ STYPE_X10Siren, "X10 Siren" },
-		{ STYPE_SMOKEDETECTOR, "Smoke Detector" },
-		{ STYPE_Dimmer, "Dimmer" },
-		{ STYPE_Motion, "Motion Sensor" },
-		{ STYPE_PushOn, "Push On Button" },
-		{ STYPE_PushOff, "Push Off Button" },
-		{ STYPE_DoorContact, "Door Contact" },
-		{ STYPE_Dusk, "Dusk Sensor" },
-		{ STYPE_BlindsPercentage, "Blinds Percentage" },
-		{ STYPE_VenetianBlindsUS, "Venetian Blinds US" },
-		{ STYPE_VenetianBlindsEU, "Venetian Blinds EU" },
-		{ STYPE_Media, "Media Player" },
-		{ STYPE_Selector, "Selector" },
-		{ STYPE_DoorLock, "Door Lock" },
-		{ STYPE_DoorLockInverted, "Door Lock Inverted" },
-		{ STYPE_BlindsPercentageWithStop, "Blinds + Stop" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, sType);
+	return findTableIndexSingle1(SwitchTypeTable, SwitchTypeIndex, sType);
 }
 
+static constexpr STR_TABLE_SINGLE MeterTypeTable[] = {
+	{ MTYPE_ENERGY, "Energy" },
+	{ MTYPE_GAS, "Gas" },
+	{ MTYPE_WATER, "Water" },
+	{ MTYPE_COUNTER, "Custom" },
+	{ MTYPE_ENERGY_GENERATED, "Energy Generated" },
+	{ MTYPE_TIME, "Time" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto MeterTypeIndex = MakeTableIndex<TableMaxID(MeterTypeTable)>(MeterTypeTable);
+
 const char* Meter_Type_Desc(const _eMeterType sType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ MTYPE_ENERGY, "Energy" },
-		{ MTYPE_GAS, "Gas" },
-		{ MTYPE_WATER, "Water" },
-		{ MTYPE_COUNTER, "Custom" },
-		{ MTYPE_ENERGY_GENERATED, "Energy Generated" },
-		{ MTYPE_TIME, "Time" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, sType);
+	return findTableIndexSingle1(MeterTypeTable, MeterTypeIndex, sType);
 }
 
+static constexpr STR_TABLE_SINGLE NotificationTypeTable[] = {
+	{ NTYPE_TEMPERATURE, "Temperature", "T" },
+	{ NTYPE_HUMIDITY, "Humidity", "H" },
+	{ NTYPE_RAIN, "Rain", "R" },
+	{ NTYPE_UV, "UV", "U" },
+	{ NTYPE_WIND, "Wind", "W" },
+	{ NTYPE_USAGE, "Usage", "M" },
+	{ NTYPE_BARO, "Baro", "B" },
+	{ NTYPE_SWITCH_ON, "Switch On", "S" },
+	{ NTYPE_AMPERE1, "Ampere 1", "1" },
+	{ NTYPE_AMPERE2, "Ampere 2", "2" },
+	{ NTYPE_AMPERE3, "Ampere 3", "3" },
+	{ NTYPE_ENERGYINSTANT, "Instant", "I" },
+	{ NTYPE_TODAYENERGY, "Today", "E" },
+	{ NTYPE_TODAYGAS, "Today", "G" },
+	{ NTYPE_TODAYCOUNTER, "Today", "C" },
+	{ NTYPE_SWITCH_OFF, "Switch Off", "O" },
+	{ NTYPE_PERCENTAGE, "Percentage", "P" },
+	{ NTYPE_RPM, "RPM", "Z" },
+	{ NTYPE_DEWPOINT, "Dew Point", "D" },
+	{ NTYPE_SETPOINT, "Set Point", "N" },
+	{ NTYPE_VIDEO, "Play Video", "V" },
+	{ NTYPE_AUDIO, "Play Audio", "A" },
+	{ NTYPE_PHOTO, "View Photo", "X" },
+	{ NTYPE_PAUSED, "Pause Stream", "Y" },
+	{ NTYPE_STOPPED, "Stop Stream", "Q" },
+	{ NTYPE_PLAYING, "Play Stream", "a" },
+	{ NTYPE_VALUE, "Value", "F" },
+	{ NTYPE_LASTUPDATE, "Last Update", "J" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto NotificationTypeIndex = MakeTableIndex<TableMaxID(NotificationTypeTable)>(NotificationTypeTable);
+
 const char* Notification_Type_Desc(const int nType, const unsigned char snum)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ NTYPE_TEMPERATURE, "Temperature", "T" },
-		{ NTYPE_HUMIDITY, "Humidity", "H" },
-		{ NTYPE_RAIN, "Rain", "R" },
-		{ NTYPE_UV, "UV", "U" },
-		{ NTYPE_WIND, "Wind", "W" },
-		{ NTYPE_USAGE, "Usage", "M" },
-		{ NTYPE_BARO, "Baro", "B" },
-		{ NTYPE_SWITCH_ON, "Switch On", "S" },
-		{ NTYPE_AMPERE1, "Ampere 1", "1" },
-		{ NTYPE_AMPERE2, "Ampere 2", "2" },
-		{ NTYPE_AMPERE3, "Ampere 3", "3" },
-		{ NTYPE_ENERGYINSTANT, "Instant", "I" },
-		{ NTYPE_TODAYENERGY, "Today", "E" },
-		{ NTYPE_TODAYGAS, "Today", "G" },
-		{ NTYPE_TODAYCOUNTER, "Today", "C" },
-		{ NTYPE_SWITCH_OFF, "Switch Off", "O" },
-		{ NTYPE_PERCENTAGE, "Percentage", "P" },
-		{ NTYPE_RPM, "RPM", "Z" },
-		{ NTYPE_DEWPOINT, "Dew Point", "D" },
-		{ NTYPE_SETPOINT, "Set Point", "N" },
-		{ NTYPE_VIDEO, "Play Video", "V" },
-		{ NTYPE_AUDIO, "Play Audio", "A" },
-		{ NTYPE_PHOTO, "View Photo", "X" },
-		{ NTYPE_PAUSED, "Pause Stream", "Y" },
-		{ NTYPE_STOPPED, "Stop Stream", "Q" },
-		{ NTYPE_PLAYING, "Play Stream", "a" },
-		{ NTYPE_VALUE, "Value", "F" },
-		{ NTYPE_LASTUPDATE, "Last Update", "J" },
-		{ 0, nullptr, nullptr },
-	};
 	if (snum == 0)
-		return findTableIDSingle1(Table, nType);
-	return findTableIDSingle2(Table, nType);
+		return findTableIndexSingle1(NotificationTypeTable, NotificationTypeIndex, nType);
+	return findTableIndexSingle2(NotificationTypeTable, NotificationTypeIndex, nType);
 }
 
+static constexpr STR_TABLE_SINGLE NotificationLabelTable[] = {
+	{ NTYPE_TEMPERATURE, "degrees" },
+	{ NTYPE_HUMIDITY, "%" },
+	{ NTYPE_RAIN, "mm" },
+	{ NTYPE_UV, "UVI" },
+	{ NTYPE_WIND, "m/s" },
+	{ NTYPE_USAGE, "" },
+	{ NTYPE_BARO, "hPa" },
+	{ NTYPE_SWITCH_ON, "" },
+	{ NTYPE_AMPERE1, "Ampere" },
+	{ NTYPE_AMPERE2, "Ampere" },
+	{ NTYPE_AMPERE3, "Ampere" },
+	{ NTYPE_ENERGYINSTANT, "Watt" },
+	{ NTYPE_TODAYENERGY, "kWh" },
+	{ NTYPE_TODAYGAS, "m3" },
+	{ NTYPE_TODAYCOUNTER, "cnt" },
+	{ NTYPE_SWITCH_OFF, "On" },
+	{ NTYPE_PERCENTAGE, "%" },
+	{ NTYPE_RPM, "RPM" },
+	{ NTYPE_DEWPOINT, "degrees" },
+	{ NTYPE_SETPOINT, "degrees" },
+	{ NTYPE_VIDEO, "" },
+	{ NTYPE_AUDIO, "" },
+	{ NTYPE_PHOTO, "" },
+	{ NTYPE_PAUSED, "" },
+	{ NTYPE_STOPPED, "" },
+	{ NTYPE_PLAYING, "" },
+	{ NTYPE_VALUE, "" },
+	{ NTYPE_LASTUPDATE, "minutes" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto NotificationLabelIndex = MakeTableIndex<TableMaxID(NotificationLabelTable)>(NotificationLabelTable);
+
 const char* Notification_Type_Label(const int nType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ NTYPE_TEMPERATURE, "degrees" },
-		{ NTYPE_HUMIDITY, "%" },
-		{ NTYPE_RAIN, "mm" },
-		{ NTYPE_UV, "UVI" },
-		{ NTYPE_WIND, "m/s" },
-		{ NTYPE_USAGE, "" },
-		{ NTYPE_BARO, "hPa" },
-		{ NTYPE_SWITCH_ON, "" },
-		{ NTYPE_AMPERE1, "Ampere" },
-		{ NTYPE_AMPERE2, "Ampere" },
-		{ NTYPE_AMPERE3, "Ampere" },
-		{ NTYPE_ENERGYINSTANT, "Watt" },
-		{ NTYPE_TODAYENERGY, "kWh" },
-		{ NTYPE_TODAYGAS, "m3" },
-		{ NTYPE_TODAYCOUNTER, "cnt" },
-		{ NTYPE_SWITCH_OFF, "On" },
-		{ NTYPE_PERCENTAGE, "%" },
-		{ NTYPE_RPM, "RPM" },
-		{ NTYPE_DEWPOINT, "degrees" },
-		{ NTYPE_SETPOINT, "degrees" },
-		{ NTYPE_VIDEO, "" },
-		{ NTYPE_AUDIO, "" },
-		{ NTYPE_PHOTO, "" },
-		{ NTYPE_PAUSED, "" },
-		{ NTYPE_STOPPED, "" },
-		{ NTYPE_PLAYING, "" },
-		{ NTYPE_VALUE, "" },
-		{ NTYPE_LASTUPDATE, "minutes" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, nType);
+	return findTableIndexSingle1(NotificationLabelTable, NotificationLabelIndex, nType);
 }
 
+static constexpr STR_TABLE_SINGLE ForecastTable[] = {
+	{ baroForecastNoInfo, "No Info" }, { baroForecastSunny, "Sunny" }, { baroForecastPartlyCloudy, "Partly Cloudy" },
+	{ baroForecastCloudy, "Cloudy" },  { baroForecastRain, "Rain" },   { 0, nullptr, nullptr },
+};
+static constexpr auto ForecastIndex = MakeTableIndex<TableMaxID(ForecastTable)>(ForecastTable);
+
 const char* RFX_Forecast_Desc(const unsigned char Forecast)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ baroForecastNoInfo, "No Info" }, { baroForecastSunny, "Sunny" }, { baroForecastPartlyCloudy, "Partly Cloudy" },
-		{ baroForecastCloudy, "Cloudy" },  { baroForecastRain, "Rain" },   { 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, Forecast);
+	return findTableIndexSingle1(ForecastTable, ForecastIndex, Forecast);
 }
 
+static constexpr STR_TABLE_SINGLE WSForecastTable[] = {
+	{ wsbaroforecast_heavy_snow, "Heavy Snow" },
+	{ wsbaroforecast_snow, "Snow" },
+	{ wsbaroforecast_heavy_rain, "Heavy Rain" },
+	{ wsbaroforecast_rain, "Rain" },
+	{ wsbaroforecast_cloudy, "Cloudy" },
+	{ wsbaroforecast_some_clouds, "Some Clouds" },
+	{ wsbaroforecast_sunny, "Sunny" },
+	{ wsbaroforecast_unknown, "Unknown" },
+	{ wsbaroforecast_unstable, "Unstable" },
+	{ wsbaroforecast_stable, "Stable" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto WSForecastIndex = MakeTableIndex<TableMaxID(WSForecastTable)>(WSForecastTable);
+
 const char* RFX_WSForecast_Desc(const unsigned char Forecast)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ wsbaroforecast_heavy_snow, "Heavy Snow" },
-		{ wsbaroforecast_snow, "Snow" },
-		{ wsbaroforecast_heavy_rain, "Heavy Rain" },
-		{ wsbaroforecast_rain, "Rain" },
-		{ wsbaroforecast_cloudy, "Cloudy" },
-		{ wsbaroforecast_some_clouds, "Some Clouds" },
-		{ wsbaroforecast_sunny, "Sunny" },
-		{ wsbaroforecast_unknown, "Unknown" },
-		{ wsbaroforecast_unstable, "Unstable" },
-		{ wsbaroforecast_stable, "Stable" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, Forecast);
+	return findTableIndexSingle1(WSForecastTable, WSForecastIndex, Forecast);
 }
 
+static constexpr STR_TABLE_SINGLE BMPForecastTable[] = {
+	{ bmpbaroforecast_stable, "Stable" },
+	{ bmpbaroforecast_sunny, "Sunny" },
+	{ bmpbaroforecast_cloudy, "Cloudy" },
+	{ bmpbaroforecast_unstable, "Unstable" },
+	{ bmpbaroforecast_thunderstorm, "Thunderstorm" },
+	{ bmpbaroforecast_unknown, "Unknown" },
+	{ bmpbaroforecast_rain, "Cloudy/Rain" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto BMPForecastIndex = MakeTableIndex<TableMaxID(BMPForecastTable)>(BMPForecastTable);
+
 const char* BMP_Forecast_Desc(const unsigned char Forecast)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ bmpbaroforecast_stable, "Stable" },
-		{ bmpbaroforecast_sunny, "Sunny" },
-		{ bmpbaroforecast_cloudy, "Cloudy" },
-		{ bmpbaroforecast_unstable, "Unstable" },
-		{ bmpbaroforecast_thunderstorm, "Thunderstorm" },
-		{ bmpbaroforecast_unknown, "Unknown" },
-		{ bmpbaroforecast_rain, "Cloudy/Rain" },
-		{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, Forecast);
+	return findTableIndexSingle1(BMPForecastTable, BMPForecastIndex, Forecast);
 }
 
+static constexpr STR_TABLE_SINGLE RFXTypeTable[] = {
+	{ pTypeInterfaceControl, "Interface Control", "unknown" },
+	{ pTypeInterfaceMessage, "Interface Message", "unknown" },
+	{ pTypeRecXmitMessage, "Receiver/Transmitter Message", "unknown" },
+	{ pTypeUndecoded, "Undecoded RF Message", "unknown" },
+	{
+		pTypeLighting1,
+		"Lighting 1",
+		"lightbulb",
+	},
+	{
+		pTypeLighting2,
+		"Lighting 2",
+		"lightbulb",
+	},
+	{
+		pTypeLighting3,
+		"Lighting 3",
+		"lightbulb",
+	},
+	{
+		pTypeLighting4,
+		"Lighting 4",
+		"lightbulb",
+	},
+	{
+		pTypeLighting5,
+		"Lighting 5",
+		"lightbulb",
+	},
+	{
+		pTypeLighting6,
+		"Lighting 6",
+		"lightbulb",
+	},
+	{ pTypeHomeConfort, "Home Confort", "lightbulb" },
+	{ pTypeColorSwitch, "Color Switch", "lightbulb" },
+	{ pTypeCurtain, "Curtain", "blinds" },
+	{ pTypeBlinds, "Blinds", "blinds" },
+	{ pTypeSecurity1, "Security", "security" },
+	{ pTypeSecurity2, "Security", "security" },
+	{ pTypeCamera, "Camera", "unknown" },
+	{ pTypeRemote, "Remote & IR", "unknown" },
+	{ pTypeThermostat1, "Thermostat 1", "temperature" },
+	{ pTypeThermostat2, "Thermostat 2", "temperature" },
+	{ pTypeThermostat3, "Thermostat 3", "temperature" },
+	{ pTypeThermostat4, "Thermostat 4", "temperature" },
+	{ pTypeRadiator1, "Radiator 1", "temperature" },
+	{ pTypeTEMP, "Temp", "temperature" },
+	{ pTypeHUM, "Humidity", "temperature" },
+	{ pTypeTEMP_HUM, "Temp + Humidity", "temperature" },
+	{ pTypeBARO, "Barometric", "temperature" },
+	{ pTypeTEMP_HUM_BARO, "Temp + Humidity + Baro", "temperature" },
+	{ pTypeRAIN, "Rain", "rain" },
+	{ pTypeWIND, "Wind", "wind" },
+	{ pTypeUV, "UV", "uv" },
+	{ pTypeDT, "Date/Time", "unknown" },
+	{ pTypeCURRENT, "Current", "current" },
+	{ pTypeENERGY, "Energy", "current" },
+	{ pTypeCURRENTENERGY, "Current/Energy", "current" },
+	{ pTypeGAS, "Gas", "counter" },
+	{ pTypeWATER, "Water", "counter" },
+	{ pTypeWEIGHT, "Weight", "scale" },
+	{ pTypeRFXSensor, "RFXSensor", "unknown" },
+	{ pTypeRFXMeter, "RFXMeter", "counter" },
+	{ pTypeP1Power, "P1 Smart Meter", "counter" },
+	{ pTypeP1Gas, "P1 Smart Meter", "counter" },
+	{ pTypeYouLess, "YouLess Meter", "counter" },
+	{ pTypeFS20, "FS20", "lightbulb" },
+	{ pTypeRego6XXTemp, "Temp", "temperature" },
+	{ pTypeRego6XXValue, "Value", "utility" },
+	{ pTypeAirQuality, "Air Quality", "air" },
+	{ pTypeUsage, "Usage", "current" },
+	{ pTypeTEMP_BARO, "Temp + Baro", "temperature" },
+	{ pTypeLux, "Lux", "lux" },
+	{ pTypeGeneral, "General", "General" },
+	{ pTypeThermostat, "Thermostat", "thermostat" },
+	{ pTypeTEMP_RAIN, "Temp + Rain", "Temp + Rain" },
+	{ pTypeChime, "Chime", "doorbell" },
+	{ pTypeFan, "Fan", "fan" },
+	{ pTypeBBQ, "BBQ Meter", "bbq" },
+	{ pTypePOWER, "Power", "current" },
+	{ pTypeRFY, "RFY", "blinds" },
+	{ pTypeEvohome, "Heating", "evohome" },
+	{ pTypeEvohomeZone, "Heating", "evohome" },
+	{ pTypeEvohomeWater, "Heating", "evohome" },
+	{ pTypeEvohomeRelay, "Heating", "evohome" },
+	{ pTypeGeneralSwitch, "Light/Switch", "lightbulb" },
+	{ pTypeWEATHER, "Weather", "weather" },
+	{ pTypeSOLAR, "Solar", "solar" },
+	{ pTypeHunter, "Hunter", "Hunter" },
+	{ 0, nullptr, nullptr },
+};
+static constexpr auto RFXTypeIndex = MakeTableIndex<TableMaxID(RFXTypeTable)>(RFXTypeTable);
+
 const char* RFX_Type_Desc(const unsigned char i, const unsigned char snum)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ pTypeInterfaceControl, "Interface Control", "unknown" },
-		{ pTypeInterfaceMessage, "Interface Message", "unknown" },
-		{ pTypeRecXmitMessage, "Receiver/Transmitter Message", "unknown" },
-		{ pTypeUndecoded, "Undecoded RF Message", "unknown" },
-		{
-			pTypeLighting1,
-			"Lighting 1",
-			"lightbulb",
-		},
-		{
-			pTypeLighting2,
-			"Lighting 2",
-			"lightbulb",
-		},
-		{
-			pTypeLighting3,
-			"Lighting 3",
-			"lightbulb",
-		},
-		{
-			pTypeLighting4,
-			"Lighting 4",
-			"lightbulb",
-		},
-		{
-			pTypeLighting5,
-			"Lighting 5",
-			"lightbulb",
-		},
-		{
-			pTypeLighting6,
-			"Lighting 6",
-			"lightbulb",
-		},
-		{ pTypeHomeConfort, "Home Confort", "lightbulb" },
-		{ pTypeColorSwitch, "Color Switch", "lightbulb" },
-		{ pTypeCurtain, "Curtain", "blinds" },
-		{ pTypeBlinds, "Blinds", "blinds" },
-		{ pTypeSecurity1, "Security", "security" },
-		{ pTypeSecurity2, "Security", "security" },
-		{ pTypeCamera, "Camera", "unknown" },
-		{ pTypeRemote, "Remote & IR", "unknown" },
-		{ pTypeThermostat1, "Thermostat 1", "temperature" },
-		{ pTypeThermostat2, "Thermostat 2", "temperature" },
-		{ pTypeThermostat3, "Thermostat 3", "temperature" },
-		{ pTypeThermostat4, "Thermostat 4", "temperature" },
-		{ pTypeRadiator1, "Radiator 1", "temperature" },
-		{ pTypeTEMP, "Temp", "temperature" },
-		{ pTypeHUM, "Humidity", "temperature" },
-		{ pTypeTEMP_HUM, "Temp + Humidity", "temperature" },
-		{ pTypeBARO, "Barometric", "temperature" },
-		{ pTypeTEMP_HUM_BARO, "Temp + Humidity + Baro", "temperature" },
-		{ pTypeRAIN, "Rain", "rain" },
-		{ pTypeWIND, "Wind", "wind" },
-		{ pTypeUV, "UV", "uv" },
-		{ pTypeDT, "Date/Time", "unknown" },
-		{ pTypeCURRENT, "Current", "current" },
-		{ pTypeENERGY, "Energy", "current" },
-		{ pTypeCURRENTENERGY, "Current/Energy", "current" },
-		{ pTypeGAS, "Gas", "counter" },
-		{ pTypeWATER, "Water", "counter" },
-		{ pTypeWEIGHT, "Weight", "scale" },
-		{ pTypeRFXSensor, "RFXSensor", "unknown" },
-		{ pTypeRFXMeter, "RFXMeter", "counter" },
-		{ pTypeP1Power, "P1 Smart Meter", "counter" },
-		{ pTypeP1Gas, "P1 Smart Meter", "counter" },
-		{ pTypeYouLess, "YouLess Meter", "counter" },
-		{ pTypeFS20, "FS20", "lightbulb" },
-		{ pTypeRego6XXTemp, "Temp", "temperature" },
-		{ pTypeRego6XXValue, "Value", "utility" },
-		{ pTypeAirQuality, "Air Quality", "air" },
-		{ pTypeUsage, "Usage", "current" },
-		{ pTypeTEMP_BARO, "Temp + Baro", "temperature" },
-		{ pTypeLux, "Lux", "lux" },
-		{ pTypeGeneral, "General", "General" },
-		{ pTypeThermostat, "Thermostat", "thermostat" },
-		{ pTypeTEMP_RAIN, "Temp + Rain", "Temp + Rain" },
-		{ pTypeChime, "Chime", "doorbell" },
-		{ pTypeFan, "Fan", "fan" },
-		{ pTypeBBQ, "BBQ Meter", "bbq" },
-		{ pTypePOWER, "Power", "current" },
-		{ pTypeRFY, "RFY", "blinds" },
-		{ pTypeEvohome, "Heating", "evohome" },
-		{ pTypeEvohomeZone, "Heating", "evohome" },
-		{ pTypeEvohomeWater, "Heating", "evohome" },
-		{ pTypeEvohomeRelay, "Heating", "evohome" },
-		{ pTypeGeneralSwitch, "Light/Switch", "lightbulb" },
-		{ pTypeWEATHER, "Weather", "weather" },
-		{ pTypeSOLAR, "Solar", "solar" },
-		{ pTypeHunter, "Hunter", "Hunter" },
-		{ 0, nullptr, nullptr },
-	};
 	if (snum == 1)
-		return findTableIDSingle1(Table, i);
+		return findTableIndexSingle1(RFXTypeTable, RFXTypeIndex, i);
 
-	return findTableIDSingle2(Table, i);
+	return findTableIndexSingle2(RFXTypeTable, RFXTypeIndex, i);
 }
 
+static constexpr STR_TABLE_ID1_ID2 RFXSubTypeTable[] = {
+	{ pTypeTEMP, sTypeTEMP1, "THR128/138, THC138" },
+	{ pTypeTEMP, sTypeTEMP2, "THC238/268, THN132, THWR288, THRN122, THN122, AW129/131" },
+	{ pTypeTEMP, sTypeTEMP3, "THWR800" },
+	{ pTypeTEMP, sTypeTEMP4, "RTHN318" },
+	{ pTypeTEMP, sTypeTEMP5, "LaCrosse TX3" },
+	{ pTypeTEMP, sTypeTEMP6, "TS15C" },
+	{ pTypeTEMP, sTypeTEMP7, "Viking 02811/02813, Proove TSS330" },
+	{ pTypeTEMP, sTypeTEMP8, "LaCrosse WS2300" },
+	{ pTypeTEMP, sTypeTEMP9, "RUBiCSON" },
+	{ pTypeTEMP, sTypeTEMP10, "TFA 30.3133" },
+	{ pTypeTEMP, sTypeTEMP11, "WT0122 Pool sensor" },
+	{ pTypeTEMP, sTypeTEMP_SYSTEM, "System" },
+
+	{ pTypeHUM, sTypeHUM1, "LaCrosse TX3" },
+	{ pTypeHUM, sTypeHUM2, "LaCrosse WS2300" },
+
+	{ pTypeTEMP_HUM, sTypeTH1, "THGN122/123/132, THGR122/228/238/268" },
+	{ pTypeTEMP_HUM, sTypeTH2, "THGR810, THGN800" },
+	{ pTypeTEMP_HUM, sTypeTH3, "RTGR328" },
+	{ pTypeTEMP_HUM, sTypeTH4, "THGR328" },
+	{ pTypeTEMP_HUM, sTypeTH5, "WTGR800" },
+	{ pTypeTEMP_HUM, sTypeTH6, "THGR918, THGRN228, THGN500" },
+	{ pTypeTEMP_HUM, sTypeTH7, "Cresta, TFA TS34C" },
+	{ pTypeTEMP_HUM, sTypeTH8, "WT450H" },
+	{ pTypeTEMP_HUM, sTypeTH9, "Viking 02035, 02038, TSS320" },
+	{ pTypeTEMP_HUM, sTypeTH10, "Rubicson/IW008T/TX95" },
+	{ pTypeTEMP_HUM, sTypeTH11, "Oregon EW109" },
+	{ pTypeTEMP_HUM, sTypeTH12, "Imagintronix" },
+	{ pTypeTEMP_HUM, sTypeTH13, "Alecto WS1700" },
+	{ pTypeTEMP_HUM, sTypeTH14, "Alecto" },
+	{ pTypeTEMP_HUM, sTypeTH_LC_TC, "LaCrosse TX3" },
+
+	{ pTypeTEMP_HUM_BARO, sTypeTHB1, "THB1 - BTHR918, BTHGN129" },
+	{ pTypeTEMP_HUM_BARO, sTypeTHB2, "THB2 - BTHR918N, BTHR968" },
+	{ pTypeTEMP_HUM_BARO, sTypeTHBFloat, "Weather Station" },
+
+	{ pTypeRAIN, sTypeRAIN1, "RGR126/682/918/928" },
+	{ pTypeRAIN, sTypeRAIN2, "PCR800" },
+	{ pTypeRAIN, sTypeRAIN3, "TFA" },
+	{ pTypeRAIN, sTypeRAIN4, "UPM RG700" },
+	{ pTypeRAIN, sTypeRAIN5, "LaCrosse WS2300" },
+	{ pTypeRAIN, sTypeRAIN6, "LaCrosse TX5" },
+	{ pTypeRAIN, sTypeRAIN7, "Alecto" },
+	{ pTypeRAIN, sTypeRAIN8, "Davis" },
+	{ pTypeRAIN, sTypeRAIN9, "TFA 30.3233.01" },
+	{ pTypeRAIN, sTypeRAIN10, "FineOffset WH5360, EcoWitt WH40" },
+	{ pTypeRAIN, sTypeRAINWU, "WWW" },
+	{ pTypeRAIN, sTypeRAINByRate, "RainByRate" },
+
+	{ pTypeWIND, sTypeWIND1, "WTGR800" },
+	{ pTypeWIND, sTypeWIND2, "WGR800" },
+	{ pTypeWIND, sTypeWIND3, "STR918/928, WGR918" },
+	{ pTypeWIND, sTypeWIND4, "TFA" },
+	{ pTypeWIND, sTypeWIND5, "UPM WDS500" },
+	{ pTypeWIND, sTypeWIND6, "LaCrosse WS2300" },
+	{ pTypeWIND, sTypeWIND7, "Alecto WS4500" },
+	{ pTypeWIND, sTypeWINDNoTemp, "Weather Station" },
+	{ pTypeWIND, sTypeWINDNoTempNoChill, "Wind" },
+
+	{ pTypeUV, sTypeUV1, "UVN128,UV138" },
+	{ pTypeUV, sTypeUV2, "UVN800" },
+	{ pTypeUV, sTypeUV3, "TFA" },
+
+	{ pTypeWEATHER, sTypeWEATHER0, "Ecowitt WS90" },
+	{ pTypeWEATHER, sTypeWEATHER1, "Alecto ACH2010" },
+	{ pTypeWEATHER, sTypeWEATHER2, "Alecto WS5500" },
+
+	{ pTypeSOLAR, sTypeSOLAR1, "Davis" },
+
+	{ pTypeHunter, sTypeHunterfan, "Hunter Fan" },
+
+	{ pTypeLighting1, sTypeX10, "X10" },
+	{ pTypeLighting1, sTypeARC, "ARC" },
+	{ pTypeLighting1, sTypeAB400D, "ELRO AB400" },
+	{ pTypeLighting1, sTypeWaveman, "Waveman" },
+	{ pTypeLighting1, sTypeEMW200, "EMW200" },
+	{ pTypeLighting1, sTypeIMPULS, "Impuls" },
+	{ pTypeLighting1, sTypeRisingSun, "RisingSun" },
+	{ pTypeLighting1, sTypePhilips, "Philips" },
+	{ pTypeLighting1, sTypeEnergenie, "Energenie" },
+	{ pTypeLighting1, sTypeEnergenie5, "Energenie 5-gang" },
+	{ pTypeLighting1, sTypeGDR2, "COCO GDR2" },
+	{ pTypeLighting1, sTypeHQ, "HQ COCO-20" },
+	{ pTypeLighting1, sTypeOase, "Oase Inscenio" },
+
+	{ pTypeLighting2, sTypeAC, "AC" },
+	{ pTypeLighting2, sTypeHEU, "HomeEasy EU" },
+	{ pTypeLighting2, sTypeANSLUT, "Anslut" },
+
+	{ pTypeLighting3, sTypeKoppla, "Ikea Koppla" },
+
+	{ pTypeLighting4, sTypePT2262, "PT2262" },
+
+	{ pTypeLighting5, sTypeLightwaveRF, "LightwaveRF" },
+	{ pTypeLighting5, sTypeEMW100, "EMW100" },
+	{ pTypeLighting5, sTypeBBSB, "BBSB new" },
+	{ pTypeLighting5, sTypeMDREMOTE, "MDRemote" },
+	{ pTypeLighting5, sTypeRSL, "Conrad RSL" },
+	{ pTypeLighting5, sTypeLivolo, "Livolo" },
+	{ pTypeLighting5, sTypeTRC02, "TRC02 (RGB)" },
+	{ pTypeLighting5, sTypeTRC02_2, "TRC02_2 (RGB)" },
+	{ pTypeLighting5, sTypeAoke, "Aoke" },
+	{ pTypeLighting5, sTypeEurodomest, "Eurodomest" },
+	{ pTypeLighting5, sTypeLivolo1to10, "Livolo 1 to 10" },
+	{ pTypeLighting5, sTypeRGB432W, "RGB432W" },
+	{ pTypeLighting5, sTypeMDREMOTE107, "MDRemote 107" },
+	{ pTypeLighting5, sTypeLegrandCAD, "Legrand CAD" },
+	{ pTypeLighting5, sTypeAvantek, "Avantek" },
+	{ pTypeLighting5, sTypeIT, "Intertek,FA500,PROmax" },
+	{ pTypeLighting5, sTypeMDREMOTE108, "MDRemote 108" },
+	{ pTypeLighting5, sTypeKangtai, "Kangtai / Cotech" },
+
+	{ pTypeLighting6, sTypeBlyss, "Blyss" },
+
+	{ pTypeHomeConfort, sTypeHomeConfortTEL010, "TEL-010" },
+
+	{ pTypeCurtain, sTypeHarrison, "Harrison" },
+
+	{ pTypeBlinds, sTypeBlindsT0, "RollerTrol/Hasta" },
+	{ pTypeBlinds, sTypeBlindsT1, "Hasta old" },
+	{ pTypeBlinds, sTypeBlindsT2, "A-OK RF01" },
+	{ pTypeBlinds, sTypeBlindsT3, "A-OK AC114" },
+	{ pTypeBlinds, sTypeBlindsT4, "RAEX" },
+	{ pTypeBlinds, sTypeBlindsT5, "Media Mount" },
+	{ pTypeBlinds, sTypeBlindsT6, "DC106" },
+	{ pTypeBlinds, sTypeBlindsT7, "Forest" },
+	{ pTypeBlinds, sTypeBlindsT8, "Chamberlain" },
+	{ pTypeBlinds, sTypeBlindsT9, "Sunpery" },
+	{ pTypeBlinds, sTypeBlindsT10, "Dolat DLM-1" },
+	{ pTypeBlinds, sTypeBlindsT11, "ASP" },
+	{ pTypeBlinds, sTypeBlindsT12, "Confexx" },
+	{ pTypeBlinds, sTypeBlindsT13, "Screenline" },
+	{ pTypeBlinds, sTypeBlindsT14, "Hualite" },
+	{ pTypeBlinds, sTypeBlindsT15, "RFU" },
+	{ pTypeBlinds, sTypeBlindsT16, "Zemismart" },
+	{ pTypeBlinds, sTypeBlindsT17, "Gaposa" },
+	{ pTypeBlinds, sTypeBlindsT18, "Cherubini" },
+
+	{ pTypeSecurity1, sTypeSecX10, "X10 security" },
+	{ pTypeSecurity1, sTypeSecX10M, "X10 security motion" },
+	{ pTypeSecurity1, sTypeSecX10R, "X10 security remote" },
+	{ pTypeSecurity1, sTypeKD101, "KD101 smoke detector" },
+	{ pTypeSecurity1, sTypePowercodeSensor, "Visonic sensor - primary contact" },
+	{ pTypeSecurity1, sTypePowercodeMotion, "Visonic motion" },
+	{ pTypeSecurity1, sTypeCodesecure, "Visonic CodeSecure" },
+	{ pTypeSecurity1, sTypePowercodeAux, "Visonic sensor - auxiliary contact" },
+	{ pTypeSecurity1, sTypeMeiantech, "Meiantech/Atlantic/Aidebao" },
+	{ pTypeSecurity1, sTypeSA30, "Alecto SA30 smoke detector" },
+	{ pTypeSecurity1, sTypeRM174RF, "Smartwares RM174RF smoke detector" },
+	{ pTypeSecurity1, sTypeDomoticzSecurity, "Security Panel" },
+
+	{ pTypeSecurity2, sTypeSec2Classic, "KeeLoq" },
+
+	{ pTypeCamera, sTypeNinja, "Meiantech" },
+
+	{ pTypeRemote, sTypeATI, "ATI Remote Wonder" },
+	{ pTypeRemote, sTypeATIplus, "ATI Remote Wonder Plus" },
+	{ pTypeRemote, sTypeMedion, "Medion Remote" },
+	{ pTypeRemote, sTypePCremote, "PC Remote" },
+	{ pTypeRemote, sTypeATIrw2, "ATI Remote Wonder II" },
+
+	{ pTypeThermostat1, sTypeDigimax, "Digimax" },
+	{ pTypeThermostat1, sTypeDigimaxShort, "Digimax short" },
+
+	{ pTypeThermostat2, sTypeHE105, "HE105" },
+	{ pTypeThermostat2, sTypeRTS10, "RTS10" },
+
+	{ pTypeThermostat3, sTypeMertikG6RH4T1, "Mertik G6R-H4T1" },
+	{ pTypeThermostat3, sTypeMertikG6RH4TB, "Mertik G6R-H4TB" },
+	{ pTypeThermostat3, sTypeMertikG6RH4TD, "Mertik G6R-H4TD" },
+	{ pTypeThermostat3, sTypeMertikG6RH4S, "Mertik G6R-H4S" },
+
+	{ pTypeThermostat4, sTypeMCZ1, "MCZ 1 fan model" },
+	{ pTypeThermostat4, sTypeMCZ2, "MCZ 2 fan model" },
+	{ pTypeThermostat4, sTypeMCZ3, "MCZ 3 fan model" },
+
+	{ pTypeRadiator1, sTypeSmartwares, "Smartwares" },
+	{ pTypeRadiator1, sTypeSmartwaresSwitchRadiator, "Smartwares Mode" },
+
+	{ pTypeDT, sTypeDT1, "RTGR328N" },
+
+	{ pTypeCURRENT, sTypeELEC1, "CM113, Electrisave" },
+
+	{ pTypeENERGY, sTypeELEC2, "CM119 / CM160" },
+	{ pTypeENERGY, sTypeELEC3, "CM180" },
+
+	{ pTypeCURRENTENERGY, sTypeELEC4, "CM180i" },
+
+	{ pTypeWEIGHT, sTypeWEIGHT1, "BWR102" },
+	{ pTypeWEIGHT, sTypeWEIGHT2, "GR101" },
+
+	{ pTypeRFXSensor, sTypeRFXSensorTemp, "Temperature" },
+	{ pTypeRFXSensor, sTypeRFXSensorAD, "A/D" },
+	{ pTypeRFXSensor, sTypeRFXSensorVolt, "Voltage" },
+
+	{ pTypeRFXMeter, sTypeRFXMeterCount, "RFXMeter counter" },
+
+	{ pTypeP1Power, sTypeP1Power, "Energy" },
+	{ pTypeP1Gas, sTypeP1Gas, "Gas" },
+
+	{ pTypeYouLess, sTypeYouLess, "YouLess counter" },
+
+	{ pTypeRego6XXTemp, sTypeRego6XXTemp, "Rego 6XX" },
+	{ pTypeRego6XXValue, sTypeRego6XXStatus, "Rego 6XX" },
+	{ pTypeRego6XXValue, sTypeRego6XXCounter, "Rego 6XX" },
+
+	{ pTypeAirQuality, sTypeVoltcraft, "Voltcraft CO-20" },
+
+	{ pTypeUsage, sTypeElectric, "Electric" },
+
+	{ pTypeTEMP_BARO, sTypeBMP085, "BMP085 I2C" },
+
+	{ pTypeLux, sTypeLux, "Lux" },
+
+	{ pTypeGeneral, sTypeVisibility, "Visibility" },
+	{ pTypeGeneral, sTypeSolarRadiation, "Solar Radiation" },
+	{ pTypeGeneral, sTypeSoilMoisture, "Soil Moisture" },
+	{ pTypeGeneral, sTypeLeafWetness, "Leaf Wetness" },
+	{ pTypeGeneral, sTypeSystemTemp, "System temperature" },
+	{ pTypeGeneral, sTypePercentage, "Percentage" },
+	{ pTypeGeneral, sTypeFan, "Fan" },
+	{ pTypeGeneral, sTypeVoltage, "Voltage" },
+	{ pTypeGeneral, sTypeCurrent, "Current" },
+	{ pTypeGeneral, sTypePressure, "Pressure" },
+	{ pTypeGeneral, sTypeBaro, "Barometer" },
+	{ pTypeGeneral, sTypeSetPoint, "Setpoint" },
+	{ pTypeGeneral, sTypeTemperature, "Temperature" },
+	{ pTypeGeneral, sTypeZWaveClock, "Thermostat Clock" },
+	{ pTypeGeneral, sTypeTextStatus, "Text" },
+	{ pTypeGeneral, sTypeZWaveThermostatMode, "Thermostat Mode" },
+	{ pTypeGeneral, sTypeZWaveThermostatFanMode, "Thermostat Fan Mode" },
+	{ pTypeGeneral, sTypeZWaveThermostatOperatingState, "Thermostat Operating State" },
+	{ pTypeGeneral, sTypeAlert, "Alert" },
+	{ pTypeGeneral, sTypeSoundLevel, "Sound Level" },
+	{ pTypeGeneral, sTypeUV, "UV" },
+	{ pTypeGeneral, sTypeDistance, "Distance" },
+	{ pTypeGeneral, sTypeCounterIncremental, "Counter Incremental" },
+	{ pTypeGeneral, sTypeKwh, "kWh" },
+	{ pTypeGeneral, sTypeWaterflow, "Waterflow" },
+	{ pTypeGeneral, sTypeCustom, "Custom Sensor" },
+	{ pTypeGeneral, sTypeZWaveAlarm, "Alarm" },
+	{ pTypeGeneral, sTypeManagedCounter, "Managed Counter" },
+
+	{ pTypeThermostat, sTypeThermSetpoint, "SetPoint" },
+	{ pTypeThermostat, sTypeThermTemperature, "Temperature" },
+
+	{ pTypeChime, sTypeByronSX, "Byron SX" },
+	{ pTypeChime, sTypeByronMP001, "Byron MP001" },
+	{ pTypeChime, sTypeSelectPlus, "SelectPlus" },
+	{ pTypeChime, sTypeByronBY, "Byron BY" },
+	{ pTypeChime, sTypeEnvivo, "Envivo" },
+	{ pTypeChime, sTypeAlfawise, "Alfawise" },
+
+	{ pTypeFan, sTypeSiemensSF01, "Siemens SF01" },
+	{ pTypeFan, sTypeItho, "Itho CVE RFT" },
+	{ pTypeFan, sTypeLucciAir, "Lucci Air" },
+	{ pTypeFan, sTypeSeavTXS4, "SEAV TXS4" },
+	{ pTypeFan, sTypeWestinghouse, "Westinghouse" },
+	{ pTypeFan, sTypeLucciAirDC, "Lucci Air DC" },
+	{ pTypeFan, sTypeCasafan, "Casafan" },
+	{ pTypeFan, sTypeFT1211R, "FT1211R" },
+	{ pTypeFan, sTypeFalmec, "Falmec" },
+	{ pTypeFan, sTypeLucciAirDCII, "Lucci Air DC II" },
+	{ pTypeFan, sTypeIthoECO, "Itho ECO" },
+	{ pTypeFan, sTypeNovy, "Novy" },
+	{ pTypeFan, sTypeOrcon, "Orcon" },
+	{ pTypeFan, sTypeIthoHRU400, "Itho HRU400" },
+
+	{ pTypeTEMP_RAIN, sTypeTR1, "Alecto WS1200" },
+
+	{ pTypeBBQ, sTypeBBQ1, "Maverick ET-732" },
+
+	{ pTypePOWER, sTypeELEC5, "Revolt" },
+
+	{ pTypeColorSwitch, sTypeColor_RGB_W, "RGBW" },
+	{ pTypeColorSwitch, sTypeColor_RGB, "RGB" },
+	{ pTypeColorSwitch, sTypeColor_White, "White" },
+	{ pTypeColorSwitch, sTypeColor_RGB_CW_WW, "RGBWW" },
+	{ pTypeColorSwitch, sTypeColor_LivCol, "RGB" },
+	{ pTypeColorSwitch, sTypeColor_RGB_W_Z, "RGBWZ" },
+	{ pTypeColorSwitch, sTypeColor_RGB_CW_WW_Z, "RGBWWZ" },
+	{ pTypeColorSwitch, sTypeColor_CW_WW, "WW" },
+
+	{ pTypeRFY, sTypeRFY, "RFY" },
+	{ pTypeRFY, sTypeRFY2, "RFY2" },
+	{ pTypeRFY, sTypeRFYext, "RFY-Ext" },
+	{ pTypeRFY, sTypeASA, "ASA" },
+
+	{ pTypeEvohome, sTypeEvohome, "Evohome" },
+	{ pTypeEvohomeZone, sTypeEvohomeZone, "Zone" },
+	{ pTypeEvohomeWater, sTypeEvohomeWater, "Hot Water" },
+	{ pTypeEvohomeRelay, sTypeEvohomeRelay, "Relay" },
+
+	{ pTypeFS20, sTypeFS20, "FS20" },
+	{ pTypeFS20, sTypeFHT8V, "FHT 8V valve" },
+	{ pTypeFS20, sTypeFHT80, "FHT80 door/window sensor" },
+
+	{ pTypeGeneralSwitch, sSwitchTypeX10, "X10" },
+	{ pTypeGeneralSwitch, sSwitchTypeARC, "ARC" },
+	{ pTypeGeneralSwitch, sSwitchTypeAB400D, "ELRO AB400" },
+	{ pTypeGeneralSwitch, sSwitchTypeWaveman, "Waveman" },
+	{ pTypeGeneralSwitch, sSwitchTypeEMW200, "EMW200" },
+	{ pTypeGeneralSwitch, sSwitchTypeIMPULS, "Impuls" },
+	{ pTypeGeneralSwitch, sSwitchTypeRisingSun, "RisingSun" },
+	{ pTypeGeneralSwitch, sSwitchTypePhilips, "Philips" },
+	{ pTypeGeneralSwitch, sSwitchTypeEnergenie, "Energenie" },
+	{ pTypeGeneralSwitch, sSwitchTypeEnergenie5, "Energenie 5-gang" },
+	{ pTypeGeneralSwitch, sSwitchTypeGDR2, "COCO GDR2" },
+	{ pTypeGeneralSwitch, sSwitchTypeAC, "AC" },
+	{ pTypeGeneralSwitch, sSwitchTypeHEU, "HomeEasy EU" },
+	{ pTypeGeneralSwitch, sSwitchTypeANSLUT, "Anslut" },
+	{ pTypeGeneralSwitch, sSwitchTypeKoppla, "Ikea Koppla" },
+	{ pTypeGeneralSwitch, sSwitchTypePT2262, "PT2262" },
+	{ pTypeGeneralSwitch, sSwitchTypeLightwaveRF, "LightwaveRF" },
+	{ pTypeGeneralSwitch, sSwitchTypeEMW100, "EMW100" },
+	{ pTypeGeneralSwitch, sSwitchTypeBBSB, "BBSB new" },
+	{ pTypeGeneralSwitch, sSwitchTypeMDREMOTE, "MDRemote" },
+	{ pTypeGeneralSwitch, sSwitchTypeRSL, "Conrad RSL" },
+	{ pTypeGeneralSwitch, sSwitchTypeLivolo, "Livolo" },
+	{ pTypeGeneralSwitch, sSwitchTypeTRC02, "TRC02 (RGB)" },
+	{ pTypeGeneralSwitch, sSwitchTypeTRC02_2, "TRC02_2 (RGB)" },
+	{ pTypeGeneralSwitch, sSwitchTypeAoke, "Aoke" },
+	{ pTypeGeneralSwitch, sSwitchTypeEurodomest, "Eurodomest" },
+	{ pTypeGeneralSwitch, sSwitchTypeLivoloAppliance, "Livolo Appliance" },
+	{ pTypeGeneralSwitch, sSwitchTypeBlyss, "Blyss" },
+	{ pTypeGeneralSwitch, sSwitchTypeByronSX, "ByronSX" },
+	{ pTypeGeneralSwitch, sSwitchTypeByronMP001, "Byron MP001" },
+	{ pTypeGeneralSwitch, sSwitchTypeSelectPlus, "SelectPlus" },
+	{ pTypeGeneralSwitch, sSwitchTypeSelectPlus3, "SelectPlus3" },
+	{ pTypeGeneralSwitch, sSwitchTypeFA20, "FA20RF" },
+	{ pTypeGeneralSwitch, sSwitchTypeChuango, "Chuango" },
+	{ pTypeGeneralSwitch, sSwitchTypePlieger, "Plieger" },
+	{ pTypeGeneralSwitch, sSwitchTypeSilvercrest, "SilverCrest" },
+	{ pTypeGeneralSwitch, sSwitchTypeMertik, "Mertik" },
+	{ pTypeGeneralSwitch, sSwitchTypeHomeConfort, "HomeConfort" },
+	{ pTypeGeneralSwitch, sSwitchTypePowerfix, "Powerfix" },
+	{ pTypeGeneralSwitch, sSwitchTypeTriState, "TriState" },
+	{ pTypeGeneralSwitch, sSwitchTypeDeltronic, "Deltronic" },
+	{ pTypeGeneralSwitch, sSwitchTypeFA500, "FA500" },
+	{ pTypeGeneralSwitch, sSwitchTypeHT12E, "HT12E" },
+	{ pTypeGeneralSwitch, sSwitchTypeEV1527, "EV1527" },
+	{ pTypeGeneralSwitch, sSwitchTypeElmes, "Elmes" },
+	{ pTypeGeneralSwitch, sSwitchTypeAster, "Aster" },
+	{ pTypeGeneralSwitch, sSwitchTypeSartano, "Sartano" },
+	{ pTypeGeneralSwitch, sSwitchTypeEurope, "Europe" },
+	{ pTypeGeneralSwitch, sSwitchTypeAvidsen, "Avidsen" },
+	{ pTypeGeneralSwitch, sSwitchTypeBofu, "BofuMotor" },
+	{ pTypeGeneralSwitch, sSwitchTypeBrel, "BrelMotor" },
+	{ pTypeGeneralSwitch, sSwitchTypeRTS, "RTS" },
+	{ pTypeGeneralSwitch, sSwitchTypeElroDB, "ElroDB" },
+	{ pTypeGeneralSwitch, sSwitchTypeDooya, "Dooya" },
+	{ pTypeGeneralSwitch, sSwitchTypeUnitec, "Unitec" },
+	{ pTypeGeneralSwitch, sSwitchTypeSelector, "Selector Switch" },
+	{ pTypeGeneralSwitch, sSwitchTypeMaclean, "Maclean" },
+	{ pTypeGeneralSwitch, sSwitchTypeR546, "R546" },
+	{ pTypeGeneralSwitch, sSwitchTypeDiya, "Diya" },
+	{ pTypeGeneralSwitch, sSwitchTypeX10secu, "X10Secure" },
+	{ pTypeGeneralSwitch, sSwitchTypeAtlantic, "Atlantic" },
+	{ pTypeGeneralSwitch, sSwitchTypeSilvercrestDB, "SilvercrestDB" },
+	{ pTypeGeneralSwitch, sSwitchTypeMedionDB, "MedionDB" },
+	{ pTypeGeneralSwitch, sSwitchTypeVMC, "VMC" },
+	{ pTypeGeneralSwitch, sSwitchTypeKeeloq, "Keeloq" },
+	{ pTypeGeneralSwitch, sSwitchCustomSwitch, "CustomSwitch" },
+	{ pTypeGeneralSwitch, sSwitchGeneralSwitch, "Switch" },
+	{ pTypeGeneralSwitch, sSwitchTypeKoch, "Koch" },
+	{ pTypeGeneralSwitch, sSwitchTypeKingpin, "Kingpin" },
+	{ pTypeGeneralSwitch, sSwitchTypeFunkbus, "Funkbus" },
+	{ pTypeGeneralSwitch, sSwitchTypeNice, "Nice" },
+	{ pTypeGeneralSwitch, sSwitchTypeForest, "Forest" },
+	{ pTypeGeneralSwitch, sSwitchBlindsT1, "Legrand MyHome Blind Bus" },
+	{ pTypeGeneralSwitch, sSwitchLightT1, "Legrand MyHome Light Bus" },
+	{ pTypeGeneralSwitch, sSwitchAuxiliaryT1, "Legrand MyHome Auxiliary Bus" },
+	{ pTypeGeneralSwitch, sSwitchContactT1, "Legrand MyHome Contact" },
+	{ pTypeGeneralSwitch, sSwitchMC145026, "MC145026" },
+	{ pTypeGeneralSwitch, sSwitchLobeco, "Lobeco" },
+	{ pTypeGeneralSwitch, sSwitchFriedland, "Friedland" },
+	{ pTypeGeneralSwitch, sSwitchBFT, "BFT" },
+	{ pTypeGeneralSwitch, sSwitchNovatys, "Novatys" },
+	{ pTypeGeneralSwitch, sSwitchHalemeier, "Halemeier" },
+	{ pTypeGeneralSwitch, sSwitchGaposa, "Gaposa" },
+	{ pTypeGeneralSwitch, sSwitchMiLightv1, "MiLightv1" },
+	{ pTypeGeneralSwitch, sSwitchMiLightv2, "MiLightv2" },
+	{ pTypeGeneralSwitch, sSwitchHT6P20, "HT6P20" },
+	{ pTypeGeneralSwitch, sSwitchTypeDoitrand, "Doitrand" },
+	{ pTypeGeneralSwitch, sSwitchTypeWarema, "Warema" },
+	{ pTypeGeneralSwitch, sSwitchTypeAnsluta, "Ansluta" },
+	{ pTypeGeneralSwitch, sSwitchTypeLivcol, "Livcol" },
+	{ pTypeGeneralSwitch, sSwitchTypeBosch, "Bosch" },
+	{ pTypeGeneralSwitch, sSwitchTypeNingbo, "Ningbo" },
+	{ pTypeGeneralSwitch, sSwitchTypeDitec, "Ditec" },
+	{ pTypeGeneralSwitch, sSwitchTypeSteffen, "Steffen" },
+	{ pTypeGeneralSwitch, sSwitchTypeAlectoSA, "AlectoSA" },
+	{ pTypeGeneralSwitch, sSwitchTypeGPIOset, "GPIOset" },
+	{ pTypeGeneralSwitch, sSwitchTypeKonigSec, "KonigSec" },
+	{ pTypeGeneralSwitch, sSwitchTypeRM174RF, "RM174RF" },
+	{ pTypeGeneralSwitch, sSwitchTypeLiwin, "Liwin" },
+	{ pTypeGeneralSwitch, sSwitchBlindsT2, "Legrand MyHome Blind Zigbee" },
+	{ pTypeGeneralSwitch, sSwitchLightT2, "Legrand MyHome Light Zigbee" },
+	{ pTypeGeneralSwitch, sSwitchTypeYW_Secu, "YW_Secu" },
+	{ pTypeGeneralSwitch, sSwitchTypeMertik_GV60, "Mertik_GV60" },
+	{ pTypeGeneralSwitch, sSwitchTypeNingbo64, "Ningbo64" },
+	{ pTypeGeneralSwitch, sSwitchTypeX2D, "X2D" },
+	{ pTypeGeneralSwitch, sSwitchTypeHRCMotor, "HRCMotor" },
+	{ pTypeGeneralSwitch, sSwitchTypeVelleman, "Velleman" },
+	{ pTypeGeneralSwitch, sSwitchTypeRFCustom, "RFCustom" },
+	{ pTypeGeneralSwitch, sSwitchTypeYW_Sensor, "YW_Sensor" },
+	{ pTypeGeneralSwitch, sSwitchTypeLegrandcad, "LEGRANDCAD" },
+	{ pTypeGeneralSwitch, sSwitchTypeSysfsGpio, "SysfsGpio" },
+	{ pTypeGeneralSwitch, sSwitchTypeHager, "Hager" },
+	{ pTypeGeneralSwitch, sSwitchTypeFaber, "Faber" },
+	{ pTypeGeneralSwitch, sSwitchTypeDrayton, "Drayton" },
+	{ pTypeGeneralSwitch, sSwitchTypeV2Phoenix, "V2Phoenix" },
+	{ 0, 0, nullptr },
+};
+static constexpr auto RFXSubTypeIndex = MakeTableIndex<TableIndexSlots(sizeof(RFXSubTypeTable) / sizeof(RFXSubTypeTable[0]))>(RFXSubTypeTable);
+
 const char* RFX_Type_SubType_Desc(const unsigned char dType, const unsigned char sType)
 {
-	static const STR_TABLE_ID1_ID2 Table[] = {
-		{ pTypeTEMP, sTypeTEMP1, "THR128/138, THC138" },
-		{ pTypeTEMP, sTypeTEMP2, "THC238/268, THN132, THWR288, THRN122, THN122, AW129/131" },
-		{ pTypeTEMP, sTypeTEMP3, "THWR800" },
-		{ pTypeTEMP, sTypeTEMP4, "RTHN318" },
-		{ pTypeTEMP, sTypeTEMP5, "LaCrosse TX3" },
-		{ pTypeTEMP, sTypeTEMP6, "TS15C" },
-		{ pTypeTEMP, sTypeTEMP7, "Viking 02811/02813, Proove TSS330" },
-		{ pTypeTEMP, sTypeTEMP8, "LaCrosse WS2300" },
-		{ pTypeTEMP, sTypeTEMP9, "RUBiCSON" },
-		{ pTypeTEMP, sTypeTEMP10, "TFA 30.3133" },
-		{ pTypeTEMP, sTypeTEMP11, "WT0122 Pool sensor" },
-		{ pTypeTEMP, sTypeTEMP_SYSTEM, "System" },
-
-		{ pTypeHUM, sTypeHUM1, "LaCrosse TX3" },
-		{ pTypeHUM, sTypeHUM2, "LaCrosse WS2300" },
-
-		{ pTypeTEMP_HUM, sTypeTH1, "THGN122/123/132, THGR122/228/238/268" },
-		{ pTypeTEMP_HUM, sTypeTH2, "THGR810, THGN800" },
-		{ pTypeTEMP_HUM, sTypeTH3, "RTGR328" },
-		{ pTypeTEMP_HUM, sTypeTH4, "THGR328" },
-		{ pTypeTEMP_HUM, sTypeTH5, "WTGR800" },
-		{ pTypeTEMP_HUM, sTypeTH6, "THGR918, THGRN228, THGN500" },
-		{ pTypeTEMP_HUM, sTypeTH7, "Cresta, TFA TS34C" },
-		{ pTypeTEMP_HUM, sTypeTH8, "WT450H" },
-		{ pTypeTEMP_HUM, sTypeTH9, "Viking 02035, 02038, TSS320" },
-		{ pTypeTEMP_HUM, sTypeTH10, "Rubicson/IW008T/TX95" },
-		{ pTypeTEMP_HUM, sTypeTH11, "Oregon EW109" },
-		{ pTypeTEMP_HUM, sTypeTH12, "Imagintronix" },
-		{ pTypeTEMP_HUM, sTypeTH13, "Alecto WS1700" },
-		{ pTypeTEMP_HUM, sTypeTH14, "Alecto" },
-		{ pTypeTEMP_HUM, sTypeTH_LC_TC, "LaCrosse TX3" },
-
-		{ pTypeTEMP_HUM_BARO, sTypeTHB1, "THB1 - BTHR918, BTHGN129" },
-		{ pTypeTEMP_HUM_BARO, sTypeTHB2, "THB2 - BTHR918N, BTHR968" },
-		{ pTypeTEMP_HUM_BARO, sTypeTHBFloat, "Weather Station" },
-
-		{ pTypeRAIN, sTypeRAIN1, "RGR126/682/918/928" },
-		{ pTypeRAIN, sTypeRAIN2, "PCR800" },
-		{ pTypeRAIN, sTypeRAIN3, "TFA" },
-		{ pTypeRAIN, sTypeRAIN4, "UPM RG700" },
-		{ pTypeRAIN, sTypeRAIN5, "LaCrosse WS2300" },
-		{ pTypeRAIN, sTypeRAIN6, "LaCrosse TX5" },
-		{ pTypeRAIN, sTypeRAIN7, "Alecto" },
-		{ pTypeRAIN, sTypeRAIN8, "Davis" },
-		{ pTypeRAIN, sTypeRAIN9, "TFA 30.3233.01" },
-		{ pTypeRAIN, sTypeRAIN10, "FineOffset WH5360, EcoWitt WH40" },
-		{ pTypeRAIN, sTypeRAINWU, "WWW" },
-		{ pTypeRAIN, sTypeRAINByRate, "RainByRate" },
-
-		{ pTypeWIND, sTypeWIND1, "WTGR800" },
-		{ pTypeWIND, sTypeWIND2, "WGR800" },
-		{ pTypeWIND, sTypeWIND3, "STR918/928, WGR918" },
-		{ pTypeWIND, sTypeWIND4, "TFA" },
-		{ pTypeWIND, sTypeWIND5, "UPM WDS500" },
-		{ pTypeWIND, sTypeWIND6, "LaCrosse WS2300" },
-		{ pTypeWIND, sTypeWIND7, "Alecto WS4500" },
-		{ pTypeWIND, sTypeWINDNoTemp, "Weather Station" },
-		{ pTypeWIND, sTypeWINDNoTempNoChill, "Wind" },
-
-		{ pTypeUV, sTypeUV1, "UVN128,UV138" },
-		{ pTypeUV, sTypeUV2, "UVN800" },
-		{ pTypeUV, sTypeUV3, "TFA" },
-
-		{ pTypeWEATHER, sTypeWEATHER0, "Ecowitt WS90" },
-		{ pTypeWEATHER, sTypeWEATHER1, "Alecto ACH2010" },
-		{ pTypeWEATHER, sTypeWEATHER2, "Alecto WS5500" },
-
-		{ pTypeSOLAR, sTypeSOLAR1, "Davis" },
-
-		{ pTypeHunter, sTypeHunterfan, "Hunter Fan" },
-
-		{ pTypeLighting1, sTypeX10, "X10" },
-		{ pTypeLighting1, sTypeARC, "ARC" },
-		{ pTypeLighting1, sTypeAB400D, "ELRO AB400" },
-		{ pTypeLighting1, sTypeWaveman, "Waveman" },
-		{ pTypeLighting1, sTypeEMW200, "EMW200" },
-		{ pTypeLighting1, sTypeIMPULS, "Impuls" },
-		{ pTypeLighting1, sTypeRisingSun, "RisingSun" },
-		{ pTypeLighting1, sTypePhilips, "Philips" },
-		{ pTypeLighting1, sTypeEnergenie, "Energenie" },
-		{ pTypeLighting1, sTypeEnergenie5, "Energenie 5-gang" },
-		{ pTypeLighting1, sTypeGDR2, "COCO GDR2" },
-		{ pTypeLighting1, sTypeHQ, "HQ COCO-20" },
-		{ pTypeLighting1, sTypeOase, "Oase Inscenio" },
-
-		{ pTypeLighting2, sTypeAC, "AC" },
-		{ pTypeLighting2, sTypeHEU, "HomeEasy EU" },
-		{ pTypeLighting2, sTypeANSLUT, "Anslut" },
-
-		{ pTypeLighting3, sTypeKoppla, "Ikea Koppla" },
-
-		{ pTypeLighting4, sTypePT2262, "PT2262" },
-
-		{ pTypeLighting5, sTypeLightwaveRF, "LightwaveRF" },
-		{ pTypeLighting5, sTypeEMW100, "EMW100" },
-		{ pTypeLighting5, sTypeBBSB, "BBSB new" },
-		{ pTypeLighting5, sTypeMDREMOTE, "MDRemote" },
-		{ pTypeLighting5, sTypeRSL, "Conrad RSL" },
-		{ pTypeLighting5, sTypeLivolo, "Livolo" },
-		{ pTypeLighting5, sTypeTRC02, "TRC02 (RGB)" },
-		{ pTypeLighting5, sTypeTRC02_2, "TRC02_2 (RGB)" },
-		{ pTypeLighting5, sTypeAoke, "Aoke" },
-		{ pTypeLighting5, sTypeEurodomest, "Eurodomest" },
-		{ pTypeLighting5, sTypeLivolo1to10, "Livolo 1 to 10" },
-		{ pTypeLighting5, sTypeRGB432W, "RGB432W" },
-		{ pTypeLighting5, sTypeMDREMOTE107, "MDRemote 107" },
-		{ pTypeLighting5, sTypeLegrandCAD, "Legrand CAD" },
-		{ pTypeLighting5, sTypeAvantek, "Avantek" },
-		{ pTypeLighting5, sTypeIT, "Intertek,FA500,PROmax" },
-		{ pTypeLighting5, sTypeMDREMOTE108, "MDRemote 108" },
-		{ pTypeLighting5, sTypeKangtai, "Kangtai / Cotech" },
-
-		{ pTypeLighting6, sTypeBlyss, "Blyss" },
-
-		{ pTypeHomeConfort, sTypeHomeConfortTEL010, "TEL-010" },
-
-		{ pTypeCurtain, sTypeHarrison, "Harrison" },
-
-		{ pTypeBlinds, sTypeBlindsT0, "RollerTrol/Hasta" },
-		{ pTypeBlinds, sTypeBlindsT1, "Hasta old" },
-		{ pTypeBlinds, sTypeBlindsT2, "A-OK RF01" },
-		{ pTypeBlinds, sTypeBlindsT3, "A-OK AC114" },
-		{ pTypeBlinds, sTypeBlindsT4, "RAEX" },
-		{ pTypeBlinds, sTypeBlindsT5, "Media Mount" },
-		{ pTypeBlinds, sTypeBlindsT6, "DC106" },
-		{ pTypeBlinds, sTypeBlindsT7, "Forest" },
-		{ pTypeBlinds, sTypeBlindsT8, "Chamberlain" },
-		{ pTypeBlinds, sTypeBlindsT9, "Sunpery" },
-		{ pTypeBlinds, sTypeBlindsT10, "Dolat DLM-1" },
-		{ pTypeBlinds, sTypeBlindsT11, "ASP" },
-		{ pTypeBlinds, sTypeBlindsT12, "Confexx" },
-		{ pTypeBlinds, sTypeBlindsT13, "Screenline" },
-		{ pTypeBlinds, sTypeBlindsT14, "Hualite" },
-		{ pTypeBlinds, sTypeBlindsT15, "RFU" },
-		{ pTypeBlinds, sTypeBlindsT16, "Zemismart" },
-		{ pTypeBlinds, sTypeBlindsT17, "Gaposa" },
-		{ pTypeBlinds, sTypeBlindsT18, "Cherubini" },
-
-		{ pTypeSecurity1, sTypeSecX10, "X10 security" },
-		{ pTypeSecurity1, sTypeSecX10M, "X10 security motion" },
-		{ pTypeSecurity1, sTypeSecX10R, "X10 security remote" },
-		{ pTypeSecurity1, sTypeKD101, "KD101 smoke detector" },
-		{ pTypeSecurity1, sTypePowercodeSensor, "Visonic sensor - primary contact" },
-		{ pTypeSecurity1, sTypePowercodeMotion, "Visonic motion" },
-		{ pTypeSecurity1, sTypeCodesecure, "Visonic CodeSecure" },
-		{ pTypeSecurity1, sTypePowercodeAux, "Visonic sensor - auxiliary contact" },
-		{ pTypeSecurity1, sTypeMeiantech, "Meiantech/Atlantic/Aidebao" },
-		{ pTypeSecurity1, sTypeSA30, "Alecto SA30 smoke detector" },
-		{ pTypeSecurity1, sTypeRM174RF, "Smartwares RM174RF smoke detector" },
-		{ pTypeSecurity1, sTypeDomoticzSecurity, "Security Panel" },
-
-		{ pTypeSecurity2, sTypeSec2Classic, "KeeLoq" },
-
-		{ pTypeCamera, sTypeNinja, "Meiantech" },
-
-		{ pTypeRemote, sTypeATI, "ATI Remote Wonder" },
-		{ pTypeRemote, sTypeATIplus, "ATI Remote Wonder Plus" },
-		{ pTypeRemote, sTypeMedion, "Medion Remote" },
-		{ pTypeRemote, sTypePCremote, "PC Remote" },
-		{ pTypeRemote, sTypeATIrw2, "ATI Remote Wonder II" },
-
-		{ pTypeThermostat1, sTypeDigimax, "Digimax" },
-		{ pTypeThermostat1, sTypeDigimaxShort, "Digimax short" },
-
-		{ pTypeThermostat2, sTypeHE105, "HE105" },
-		{ pTypeThermostat2, sTypeRTS10, "RTS10" },
-
-		{ pTypeThermostat3, sTypeMertikG6RH4T1, "Mertik G6R-H4T1" },
-		{ pTypeThermostat3, sTypeMertikG6RH4TB, "Mertik G6R-H4TB" },
-		{ pTypeThermostat3, sTypeMertikG6RH4TD, "Mertik G6R-H4TD" },
-		{ pTypeThermostat3, sTypeMertikG6RH4S, "Mertik G6R-H4S" },
-
-		{ pTypeThermostat4, sTypeMCZ1, "MCZ 1 fan model" },
-		{ pTypeThermostat4, sTypeMCZ2, "MCZ 2 fan model" },
-		{ pTypeThermostat4, sTypeMCZ3, "MCZ 3 fan model" },
-
-		{ pTypeRadiator1, sTypeSmartwares, "Smartwares" },
-		{ pTypeRadiator1, sTypeSmartwaresSwitchRadiator, "Smartwares Mode" },
-
-		{ pTypeDT, sTypeDT1, "RTGR328N" },
-
-		{ pTypeCURRENT, sTypeELEC1, "CM113, Electrisave" },
-
-		{ pTypeENERGY, sTypeELEC2, "CM119 / CM160" },
-		{ pTypeENERGY, sTypeELEC3, "CM180" },
-
-		{ pTypeCURRENTENERGY, sTypeELEC4, "CM180i" },
-
-		{ pTypeWEIGHT, sTypeWEIGHT1, "BWR102" },
-		{ pTypeWEIGHT, sTypeWEIGHT2, "GR101" },
-
-		{ pTypeRFXSensor, sTypeRFXSensorTemp, "Temperature" },
-		{ pTypeRFXSensor, sTypeRFXSensorAD, "A/D" },
-		{ pTypeRFXSensor, sTypeRFXSensorVolt, "Voltage" },
-
-		{ pTypeRFXMeter, sTypeRFXMeterCount, "RFXMeter counter" },
-
-		{ pTypeP1Power, sTypeP1Power, "Energy" },
-		{ pTypeP1Gas, sTypeP1Gas, "Gas" },
-
-		{ pTypeYouLess, sTypeYouLess, "YouLess counter" },
-
-		{ pTypeRego6XXTemp, sTypeRego6XXTemp, "Rego 6XX" },
-		{ pTypeRego6XXValue, sTypeRego6XXStatus, "Rego 6XX" },
-		{ pTypeRego6XXValue, sTypeRego6XXCounter, "Rego 6XX" },
-
-		{ pTypeAirQuality, sTypeVoltcraft, "Voltcraft CO-20" },
-
-		{ pTypeUsage, sTypeElectric, "Electric" },
-
-		{ pTypeTEMP_BARO, sTypeBMP085, "BMP085 I2C" },
-
-		{ pTypeLux, sTypeLux, "Lux" },
-
-		{ pTypeGeneral, sTypeVisibility, "Visibility" },
-		{ pTypeGeneral, sTypeSolarRadiation, "Solar Radiation" },
-		{ pTypeGeneral, sTypeSoilMoisture, "Soil Moisture" },
-		{ pTypeGeneral, sTypeLeafWetness, "Leaf Wetness" },
-		{ pTypeGeneral, sTypeSystemTemp, "System temperature" },
-		{ pTypeGeneral, sTypePercentage, "Percentage" },
-		{ pTypeGeneral, sTypeFan, "Fan" },
-		{ pTypeGeneral, sTypeVoltage, "Voltage" },
-		{ pTypeGeneral, sTypeCurrent, "Current" },
-		{ pTypeGeneral, sTypePressure, "Pressure" },
-		{ pTypeGeneral, sTypeBaro, "Barometer" },
-		{ pTypeGeneral, sTypeSetPoint, "Setpoint" },
-		{ pTypeGeneral, sTypeTemperature, "Temperature" },
-		{ pTypeGeneral, sTypeZWaveClock, "Thermostat Clock" },
-		{ pTypeGeneral, sTypeTextStatus, "Text" },
-		{ pTypeGeneral, sTypeZWaveThermostatMode, "Thermostat Mode" },
-		{ pTypeGeneral, sTypeZWaveThermostatFanMode, "Thermostat Fan Mode" },
-		{ pTypeGeneral, sTypeZWaveThermostatOperatingState, "Thermostat Operating State" },
-		{ pTypeGeneral, sTypeAlert, "Alert" },
-		{ pTypeGeneral, sTypeSoundLevel, "Sound Level" },
-		{ pTypeGeneral, sTypeUV, "UV" },
-		{ pTypeGeneral, sTypeDistance, "Distance" },
-		{ pTypeGeneral, sTypeCounterIncremental, "Counter Incremental" },
-		{ pTypeGeneral, sTypeKwh, "kWh" },
-		{ pTypeGeneral, sTypeWaterflow, "Waterflow" },
-		{ pTypeGeneral, sTypeCustom, "Custom Sensor" },
-		{ pTypeGeneral, sTypeZWaveAlarm, "Alarm" },
-		{ pTypeGeneral, sTypeManagedCounter, "Managed Counter" },
-
-		{ pTypeThermostat, sTypeThermSetpoint, "SetPoint" },
-		{ pTypeThermostat, sTypeThermTemperature, "Temperature" },
-
-		{ pTypeChime, sTypeByronSX, "Byron SX" },
-		{ pTypeChime, sTypeByronMP001, "Byron MP001" },
-		{ pTypeChime, sTypeSelectPlus, "SelectPlus" },
-		{ pTypeChime, sTypeByronBY, "Byron BY" },
-		{ pTypeChime, sTypeEnvivo, "Envivo" },
-		{ pTypeChime, sTypeAlfawise, "Alfawise" },
-
-		{ pTypeFan, sTypeSiemensSF01, "Siemens SF01" },
-		{ pTypeFan, sTypeItho, "Itho CVE RFT" },
-		{ pTypeFan, sTypeLucciAir, "Lucci Air" },
-		{ pTypeFan, sTypeSeavTXS4, "SEAV TXS4" },
-		{ pTypeFan, sTypeWestinghouse, "Westinghouse" },
-		{ pTypeFan, sTypeLucciAirDC, "Lucci Air DC" },
-		{ pTypeFan, sTypeCasafan, "Casafan" },
-		{ pTypeFan, sTypeFT1211R, "FT1211R" },
-		{ pTypeFan, sTypeFalmec, "Falmec" },
-		{ pTypeFan, sTypeLucciAirDCII, "Lucci Air DC II" },
-		{ pTypeFan, sTypeIthoECO, "Itho ECO" },
-		{ pTypeFan, sTypeNovy, "Novy" },
-		{ pTypeFan, sTypeOrcon, "Orcon" },
-		{ pTypeFan, sTypeIthoHRU400, "Itho HRU400" },
-
-		{ pTypeTEMP_RAIN, sTypeTR1, "Alecto WS1200" },
-
-		{ pTypeBBQ, sTypeBBQ1, "Maverick ET-732" },
-
-		{ pTypePOWER, sTypeELEC5, "Revolt" },
-
-		{ pTypeColorSwitch, sTypeColor_RGB_W, "RGBW" },
-		{ pTypeColorSwitch, sTypeColor_RGB, "RGB" },
-		{ pTypeColorSwitch, sTypeColor_White, "White" },
-		{ pTypeColorSwitch, sTypeColor_RGB_CW_WW, "RGBWW" },
-		{ pTypeColorSwitch, sTypeColor_LivCol, "RGB" },
-		{ pTypeColorSwitch, sTypeColor_RGB_W_Z, "RGBWZ" },
-		{ pTypeColorSwitch, sTypeColor_RGB_CW_WW_Z, "RGBWWZ" },
-		{ pTypeColorSwitch, sTypeColor_CW_WW, "WW" },
-
-		{ pTypeRFY, sTypeRFY, "RFY" },
-		{ pTypeRFY, sTypeRFY2, "RFY2" },
-		{ pTypeRFY, sTypeRFYext, "RFY-Ext" },
-		{ pTypeRFY, sTypeASA, "ASA" },
-
-		{ pTypeEvohome, sTypeEvohome, "Evohome" },
-		{ pTypeEvohomeZone, sTypeEvohomeZone, "Zone" },
-		{ pTypeEvohomeWater, sTypeEvohomeWater, "Hot Water" },
-		{ pTypeEvohomeRelay, sTypeEvohomeRelay, "Relay" },
-
-		{ pTypeFS20, sTypeFS20, "FS20" },
-		{ pTypeFS20, sTypeFHT8V, "FHT 8V valve" },
-		{ pTypeFS20, sTypeFHT80, "FHT80 door/window sensor" },
-
-		{ pTypeGeneralSwitch, sSwitchTypeX10, "X10" },
-		{ pTypeGeneralSwitch, sSwitchTypeARC, "ARC" },
-		{ pTypeGeneralSwitch, sSwitchTypeAB400D, "ELRO AB400" },
-		{ pTypeGeneralSwitch, sSwitchTypeWaveman, "Waveman" },
-		{ pTypeGeneralSwitch, sSwitchTypeEMW200, "EMW200" },
-		{ pTypeGeneralSwitch, sSwitchTypeIMPULS, "Impuls" },
-		{ pTypeGeneralSwitch, sSwitchTypeRisingSun, "RisingSun" },
-		{ pTypeGeneralSwitch, sSwitchTypePhilips, "Philips" },
-		{ pTypeGeneralSwitch, sSwitchTypeEnergenie, "Energenie" },
-		{ pTypeGeneralSwitch, sSwitchTypeEnergenie5, "Energenie 5-gang" },
-		{ pTypeGeneralSwitch, sSwitchTypeGDR2, "COCO GDR2" },
-		{ pTypeGeneralSwitch, sSwitchTypeAC, "AC" },
-		{ pTypeGeneralSwitch, sSwitchTypeHEU, "HomeEasy EU" },
-		{ pTypeGeneralSwitch, sSwitchTypeANSLUT, "Anslut" },
-		{ pTypeGeneralSwitch, sSwitchTypeKoppla, "Ikea Koppla" },
-		{ pTypeGeneralSwitch, sSwitchTypePT2262, "PT2262" },
-		{ pTypeGeneralSwitch, sSwitchTypeLightwaveRF, "LightwaveRF" },
-		{ pTypeGeneralSwitch, sSwitchTypeEMW100, "EMW100" },
-		{ pTypeGeneralSwitch, sSwitchTypeBBSB, "BBSB new" },
-		{ pTypeGeneralSwitch, sSwitchTypeMDREMOTE, "MDRemote" },
-		{ pTypeGeneralSwitch, sSwitchTypeRSL, "Conrad RSL" },
-		{ pTypeGeneralSwitch, sSwitchTypeLivolo, "Livolo" },
-		{ pTypeGeneralSwitch, sSwitchTypeTRC02, "TRC02 (RGB)" },
-		{ pTypeGeneralSwitch, sSwitchTypeTRC02_2, "TRC02_2 (RGB)" },
-		{ pTypeGeneralSwitch, sSwitchTypeAoke, "Aoke" },
-		{ pTypeGeneralSwitch, sSwitchTypeEurodomest, "Eurodomest" },
-		{ pTypeGeneralSwitch, sSwitchTypeLivoloAppliance, "Livolo Appliance" },
-		{ pTypeGeneralSwitch, sSwitchTypeBlyss, "Blyss" },
-		{ pTypeGeneralSwitch, sSwitchTypeByronSX, "ByronSX" },
-		{ pTypeGeneralSwitch, sSwitchTypeByronMP001, "Byron MP001" },
-		{ pTypeGeneralSwitch, sSwitchTypeSelectPlus, "SelectPlus" },
-		{ pTypeGeneralSwitch, sSwitchTypeSelectPlus3, "SelectPlus3" },
-		{ pTypeGeneralSwitch, sSwitchTypeFA20, "FA20RF" },
-		{ pTypeGeneralSwitch, sSwitchTypeChuango, "Chuango" },
-		{ pTypeGeneralSwitch, sSwitchTypePlieger, "Plieger" },
-		{ pTypeGeneralSwitch, sSwitchTypeSilvercrest, "SilverCrest" },
-		{ pTypeGeneralSwitch, sSwitchTypeMertik, "Mertik" },
-		{ pTypeGeneralSwitch, sSwitchTypeHomeConfort, "HomeConfort" },
-		{ pTypeGeneralSwitch, sSwitchTypePowerfix, "Powerfix" },
-		{ pTypeGeneralSwitch, sSwitchTypeTriState, "TriState" },
-		{ pTypeGeneralSwitch, sSwitchTypeDeltronic, "Deltronic" },
-		{ pTypeGeneralSwitch, sSwitchTypeFA500, "FA500" },
-		{ pTypeGeneralSwitch, sSwitchTypeHT12E, "HT12E" },
-		{ pTypeGeneralSwitch, sSwitchTypeEV1527, "EV1527" },
-		{ pTypeGeneralSwitch, sSwitchTypeElmes, "Elmes" },
-		{ pTypeGeneralSwitch, sSwitchTypeAster, "Aster" },
-		{ pTypeGeneralSwitch, sSwitchTypeSartano, "Sartano" },
-		{ pTypeGeneralSwitch, sSwitchTypeEurope, "Europe" },
-		{ pTypeGeneralSwitch, sSwitchTypeAvidsen, "Avidsen" },
-		{ pTypeGeneralSwitch, sSwitchTypeBofu, "BofuMotor" },
-		{ pTypeGeneralSwitch, sSwitchTypeBrel, "BrelMotor" },
-		{ pTypeGeneralSwitch, sSwitchTypeRTS, "RTS" },
-		{ pTypeGeneralSwitch, sSwitchTypeElroDB, "ElroDB" },
-		{ pTypeGeneralSwitch, sSwitchTypeDooya, "Dooya" },
-		{ pTypeGeneralSwitch, sSwitchTypeUnitec, "Unitec" },
-		{ pTypeGeneralSwitch, sSwitchTypeSelector, "Selector Switch" },
-		{ pTypeGeneralSwitch, sSwitchTypeMaclean, "Maclean" },
-		{ pTypeGeneralSwitch, sSwitchTypeR546, "R546" },
-		{ pTypeGeneralSwitch, sSwitchTypeDiya, "Diya" },
-		{ pTypeGeneralSwitch, sSwitchTypeX10secu, "X10Secure" },
-		{ pTypeGeneralSwitch, sSwitchTypeAtlantic, "Atlantic" },
-		{ pTypeGeneralSwitch, sSwitchTypeSilvercrestDB, "SilvercrestDB" },
-		{ pTypeGeneralSwitch, sSwitchTypeMedionDB, "MedionDB" },
-		{ pTypeGeneralSwitch, sSwitchTypeVMC, "VMC" },
-		{ pTypeGeneralSwitch, sSwitchTypeKeeloq, "Keeloq" },
-		{ pTypeGeneralSwitch, sSwitchCustomSwitch, "CustomSwitch" },
-		{ pTypeGeneralSwitch, sSwitchGeneralSwitch, "Switch" },
-		{ pTypeGeneralSwitch, sSwitchTypeKoch, "Koch" },
-		{ pTypeGeneralSwitch, sSwitchTypeKingpin, "Kingpin" },
-		{ pTypeGeneralSwitch, sSwitchTypeFunkbus, "Funkbus" },
-		{ pTypeGeneralSwitch, sSwitchTypeNice, "Nice" },
-		{ pTypeGeneralSwitch, sSwitchTypeForest, "Forest" },
-		{ pTypeGeneralSwitch, sSwitchBlindsT1, "Legrand MyHome Blind Bus" },
-		{ pTypeGeneralSwitch, sSwitchLightT1, "Legrand MyHome Light Bus" },
-		{ pTypeGeneralSwitch, sSwitchAuxiliaryT1, "Legrand MyHome Auxiliary Bus" },
-		{ pTypeGeneralSwitch, sSwitchContactT1, "Legrand MyHome Contact" },
-		{ pTypeGeneralSwitch, sSwitchMC145026, "MC145026" },
-		{ pTypeGeneralSwitch, sSwitchLobeco, "Lobeco" },
-		{ pTypeGeneralSwitch, sSwitchFriedland, "Friedland" },
-		{ pTypeGeneralSwitch, sSwitchBFT, "BFT" },
-		{ pTypeGeneralSwitch, sSwitchNovatys, "Novatys" },
-		{ pTypeGeneralSwitch, sSwitchHalemeier, "Halemeier" },
-		{ pTypeGeneralSwitch, sSwitchGaposa, "Gaposa" },
-		{ pTypeGeneralSwitch, sSwitchMiLightv1, "MiLightv1" },
-		{ pTypeGeneralSwitch, sSwitchMiLightv2, "MiLightv2" },
-		{ pTypeGeneralSwitch, sSwitchHT6P20, "HT6P20" },
-		{ pTypeGeneralSwitch, sSwitchTypeDoitrand, "Doitrand" },
-		{ pTypeGeneralSwitch, sSwitchTypeWarema, "Warema" },
-		{ pTypeGeneralSwitch, sSwitchTypeAnsluta, "Ansluta" },
-		{ pTypeGeneralSwitch, sSwitchTypeLivcol, "Livcol" },
-		{ pTypeGeneralSwitch, sSwitchTypeBosch, "Bosch" },
-		{ pTypeGeneralSwitch, sSwitchTypeNingbo, "Ningbo" },
-		{ pTypeGeneralSwitch, sSwitchTypeDitec, "Ditec" },
-		{ pTypeGeneralSwitch, sSwitchTypeSteffen, "Steffen" },
-		{ pTypeGeneralSwitch, sSwitchTypeAlectoSA, "AlectoSA" },
-		{ pTypeGeneralSwitch, sSwitchTypeGPIOset, "GPIOset" },
-		{ pTypeGeneralSwitch, sSwitchTypeKonigSec, "KonigSec" },
-		{ pTypeGeneralSwitch, sSwitchTypeRM174RF, "RM174RF" },
-		{ pTypeGeneralSwitch, sSwitchTypeLiwin, "Liwin" },
-		{ pTypeGeneralSwitch, sSwitchBlindsT2, "Legrand MyHome Blind Zigbee" },
-		{ pTypeGeneralSwitch, sSwitchLightT2, "Legrand MyHome Light Zigbee" },
-		{ pTypeGeneralSwitch, sSwitchTypeYW_Secu, "YW_Secu" },
-		{ pTypeGeneralSwitch, sSwitchTypeMertik_GV60, "Mertik_GV60" },
-		{ pTypeGeneralSwitch, sSwitchTypeNingbo64, "Ningbo64" },
-		{ pTypeGeneralSwitch, sSwitchTypeX2D, "X2D" },
-		{ pTypeGeneralSwitch, sSwitchTypeHRCMotor, "HRCMotor" },
-		{ pTypeGeneralSwitch, sSwitchTypeVelleman, "Velleman" },
-		{ pTypeGeneralSwitch, sSwitchTypeRFCustom, "RFCustom" },
-		{ pTypeGeneralSwitch, sSwitchTypeYW_Sensor, "YW_Sensor" },
-		{ pTypeGeneralSwitch, sSwitchTypeLegrandcad, "LEGRANDCAD" },
-		{ pTypeGeneralSwitch, sSwitchTypeSysfsGpio, "SysfsGpio" },
-		{ pTypeGeneralSwitch, sSwitchTypeHager, "Hager" },
-		{ pTypeGeneralSwitch, sSwitchTypeFaber, "Faber" },
-		{ pTypeGeneralSwitch, sSwitchTypeDrayton, "Drayton" },
-		{ pTypeGeneralSwitch, sSwitchTypeV2Phoenix, "V2Phoenix" },
-		{ 0, 0, nullptr },
-	};
-	return findTableID1ID2(Table, dType, sType);
+	return findTableIndexID1ID2(RFXSubTypeTable, RFXSubTypeIndex, dType, sType);
 }
 
+static constexpr STR_TABLE_SINGLE MediaPlayerStatesTable[] = {
+	{ MSTAT_OFF, "Off" },		{ MSTAT_ON, "On" },	      { MSTAT_PAUSED, "Paused" },
+	{ MSTAT_STOPPED, "Stopped" },	{ MSTAT_VIDEO, "Video" },     { MSTAT_AUDIO, "Audio" },
+	{ MSTAT_PHOTO, "Photo" },	{ MSTAT_PLAYING, "Playing" }, { MSTAT_DISCONNECTED, "Disconnected" },
+	{ MSTAT_SLEEPING, "Sleeping" }, { MSTAT_UNKNOWN, "Unknown" }, { 0, nullptr, nullptr },
+};
+static constexpr auto MediaPlayerStatesIndex = MakeTableIndex<TableMaxID(MediaPlayerStatesTable)>(MediaPlayerStatesTable);
+
 const char* Media_Player_States(const _eMediaStatus Status)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ MSTAT_OFF, "Off" },		{ MSTAT_ON, "On" },	      { MSTAT_PAUSED, "Paused" },
-		{ MSTAT_STOPPED, "Stopped" },	{ MSTAT_VIDEO, "Video" },     { MSTAT_AUDIO, "Audio" },
-		{ MSTAT_PHOTO, "Photo" },	{ MSTAT_PLAYING, "Playing" }, { MSTAT_DISCONNECTED, "Disconnected" },
-		{ MSTAT_SLEEPING, "Sleeping" }, { MSTAT_UNKNOWN, "Unknown" }, { 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, Status);
+	return findTableIndexSingle1(MediaPlayerStatesTable, MediaPlayerStatesIndex, Status);
 }
 
+static constexpr STR_TABLE_SINGLE ZWaveClockDaysTable[] = {
+	{ 0, "Monday" }, { 1, "Tuesday" },  { 2, "Wednesday" }, { 3, "Thursday" },
+	{ 4, "Friday" }, { 5, "Saturday" }, { 6, "Sunday" },	{ 0, nullptr, nullptr },
+};
+static constexpr auto ZWaveClockDaysIndex = MakeTableIndex<TableMaxID(ZWaveClockDaysTable)>(ZWaveClockDaysTable);
+
 const char* ZWave_Clock_Days(const unsigned char Day)
 {
-	static const STR_TABLE_SINGLE Table[] = {
-		{ 0, "Monday" }, { 1, "Tuesday" },  { 2, "Wednesday" }, { 3, "Thursday" },
-		{ 4, "Friday" }, { 5, "Saturday" }, { 6, "Sunday" },	{ 0, nullptr, nullptr },
-	};
-	return findTableIDSingle1(Table, Day);
+	return findTableIndexSingle1(ZWaveClockDaysTable, ZWaveClockDaysIndex, Day);
 }
 /*
 const char *ZWave_Thermostat_Modes[] =
@@ -1014,6 +1151,15 @@ NULL
 const char *ZWave_Thermostat_Fan_Modes[]
 = { "Auto Low", "On Low", "Auto High", "On High", "Unknown 4", "Unknown 5", "Circulate", "Unknown", nullptr };
 
+// Evohome controller modes, as named by the Evohome Web API (and used by the web front end for images etc.)
+const char *Evohome_WebAPI_Modes[]
+= { "Auto", "AutoWithEco", "Away", "DayOff", "Custom", "HeatingOff", "Unknown", nullptr };
+
+const char* Evohome_WebAPI_Mode_Desc(const unsigned char nControllerMode)
+{
+	return Evohome_WebAPI_Modes[(nControllerMode < 6) ? nControllerMode : 6];
+}
+
 int Lookup_ZWave_Thermostat_Modes(const std::vector<std::string>& Modes, const std::string& sMode)
 {
 	int ii = 0;
@@ -1980,7 +2126,7 @@ void GetLightStatus(
 		break;
 	case pTypeEvohome:
 		llevel = 0;
-		lstatus = CEvohomeBase::GetWebAPIModeName(nValue);
+		lstatus = Evohome_WebAPI_Mode_Desc(nValue);
 		break;
 	case pTypeEvohomeRelay:
 		bHaveDimmer = true;
@@ -4065,3 +4211,75 @@ void ConvertToGeneralSwitchType(std::string& devid, int& dtype, int& subtype)
 		subtype = sSwitchTypeRTS;
 	}
 }
+
+// Checks every descriptor index against the plain table scan it replaces
+template <unsigned long MaxID> static bool VerifyTableIndex(const char* szName, const STR_TABLE_SINGLE* t, const _tTableIndexSingle<MaxID>& index, std::string& szError)
+{
+	for (unsigned long id = 0; id <= MaxID + 1; id++)
+	{
+		if ((strcmp(findTableIndexSingle1(t, index, id), findTableIDSingle1(t, id)) != 0) || (strcmp(findTableIndexSingle2(t, index, id), findTableIDSingle2(t, id)) != 0))
+		{
+			szError = std_format("%s: mismatch for id %lu", szName, id);
+			return false;
+		}
+	}
+	return true;
+}
+
+template <size_t Slots> static bool VerifyTableIndex(const char* szName, const STR_TABLE_ID1_ID2* t, const _tTableIndexID1ID2<Slots>& index, std::string& szError)
+{
+	for (unsigned long id1 = 0; id1 < 0x100; id1++)
+	{
+		for (unsigned long id2 = 0; id2 < 0x100; id2++)
+		{
+			if (strcmp(findTableIndexID1ID2(t, index, id1, id2), findTableID1ID2(t, id1, id2)) != 0)
+			{
+				szError = std_format("%s: mismatch for id 0x%02lX/0x%02lX", szName, id1, id2);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool RFXNames_VerifyLookupTables(std::string& szError)
+{
+	return VerifyTableIndex("HumidityStatus", HumidityStatusTable, HumidityStatusIndex, szError)
+		&& VerifyTableIndex("SecurityStatus", SecurityStatusTable, SecurityStatusIndex, szError)
+		&& VerifyTableIndex("TimerType", TimerTypeTable, TimerTypeIndex, szError)
+		&& VerifyTableIndex("TimerCmd", TimerCmdTable, TimerCmdIndex, szError)
+		&& VerifyTableIndex("HardwareType", HardwareTypeTable, HardwareTypeIndex, szError)
+		&& VerifyTableIndex("SwitchType", SwitchTypeTable, SwitchTypeIndex, szError)
+		&& VerifyTableIndex("MeterType", MeterTypeTable, MeterTypeIndex, szError)
+		&& VerifyTableIndex("NotificationType", NotificationTypeTable, NotificationTypeIndex, szError)
+		&& VerifyTableIndex("NotificationLabel", NotificationLabelTable, NotificationLabelIndex, szError)
+		&& VerifyTableIndex("Forecast", ForecastTable, ForecastIndex, szError)
+		&& VerifyTableIndex("WSForecast", WSForecastTable, WSForecastIndex, szError)
+		&& VerifyTableIndex("BMPForecast", BMPForecastTable, BMPForecastIndex, szError)
+		&& VerifyTableIndex("RFXType", RFXTypeTable, RFXTypeIndex, szError)
+		&& VerifyTableIndex("RFXSubType", RFXSubTypeTable, RFXSubTypeIndex, szError)
+		&& VerifyTableIndex("MediaPlayerStates", MediaPlayerStatesTable, MediaPlayerStatesIndex, szError)
+		&& VerifyTableIndex("ZWaveClockDays", ZWaveClockDaysTable, ZWaveClockDaysIndex, szError);
+}
+
+// Times RFX_Type_SubType_Desc style lookups over all type/subtype combinations, indexed versus linear (in nanoseconds per lookup)
+bool RFXNames_BenchmarkLookup(const int iterations, double& dIndexedNs, double& dLinearNs)
+{
+	size_t nIndexed = 0, nLinear = 0;
+	auto tStart = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < iterations; ii++)
+		for (unsigned long id1 = 0; id1 < 0x100; id1++)
+			for (unsigned long id2 = 0; id2 < 0x100; id2++)
+				nIndexed += (size_t)findTableIndexID1ID2(RFXSubTypeTable, RFXSubTypeIndex, id1, id2)[0];
+	auto tIndexed = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < iterations; ii++)
+		for (unsigned long id1 = 0; id1 < 0x100; id1++)
+			for (unsigned long id2 = 0; id2 < 0x100; id2++)
+				nLinear += (size_t)findTableID1ID2(RFXSubTypeTable, id1, id2)[0];
+	auto tLinear = std::chrono::steady_clock::now();
+
+	const double dLookups = (double)iterations * 0x10000;
+	dIndexedNs = std::chrono::duration<double, std::nano>(tIndexed - tStart).count() / dLookups;
+	dLinearNs = std::chrono::duration<double, std::nano>(tLinear - tIndexed).count() / dLookups;
+	return (nIndexed == nLinear);
+}
@@ -279,6 +279,8 @@ const char* Get_Moisture_Desc(int moisture);
 const char* Get_Alert_Desc(int level);
 const char* Media_Player_States(_eMediaStatus Status);
 const char* ZWave_Clock_Days(unsigned char Day);
+const char* Evohome_WebAPI_Mode_Desc(unsigned char nControllerMode);
+extern const char* Evohome_WebAPI_Modes[];
 extern const char* ZWave_Thermostat_Fan_Modes[];
 int Lookup_ZWave_Thermostat_Modes(const std::vector<std::string>& Modes, const std::string& sMode);
 int Lookup_ZWave_Thermostat_Fan_Modes(const std::string& sMode);
@@ -297,3 +299,7 @@ bool IsLightSwitchOn(const std::string& lstatus);
 bool IsSerialDevice(_eHardwareTypes htype);
 bool IsNetworkDevice(_eHardwareTypes htype);
 void ConvertToGeneralSwitchType(std::string& devid, int& dtype, int& subtype);
+
+bool RFXNames_VerifyLookupTables(std::string& szError);
+// returns false when the indexed and the linear lookup did not find the same entries
+bool RFXNames_BenchmarkLookup(int iterations, double& dIndexedNs, double& dLinearNs);
@@ -0,0 +1,41 @@
+/*
+ * RxMessageBuffer.h
+ *
+ * Fixed size, inline copy of a received hardware message. Used as a member of queue
+ * items so queueing a message does not need a heap allocation for the packet.
+ */
+#pragma once
+#ifndef MAIN_RXMESSAGEBUFFER_H_
+#define MAIN_RXMESSAGEBUFFER_H_
+
+#include <cstdint>
+#include <cstring>
+
+// The first byte of a message holds its length, so a message never exceeds 256 bytes (sizeof(tRBUF))
+#define RX_MESSAGE_MAX_SIZE 256
+
+struct _tRxMessageBuffer {
+	uint8_t data[RX_MESSAGE_MAX_SIZE];
+
+	_tRxMessageBuffer() {
+		data[0] = 0;
+	}
+	// Copies only the used part of the buffer
+	_tRxMessageBuffer(const _tRxMessageBuffer &other) {
+		memcpy(data, other.data, other.size());
+	}
+	_tRxMessageBuffer &operator=(const _tRxMessageBuffer &other) {
+		if (this != &other)
+			memcpy(data, other.data, other.size());
+		return *this;
+	}
+
+	size_t size() const {
+		return static_cast<size_t>(data[0]) + 1;
+	}
+	void assign(const uint8_t *pRXCommand) {
+		memcpy(data, pRXCommand, static_cast<size_t>(pRXCommand[0]) + 1);
+	}
+};
+
+#endif /* MAIN_RXMESSAGEBUFFER_H_ */
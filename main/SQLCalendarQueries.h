@@ -0,0 +1,81 @@
+#pragma once
+
+// Daily calendar rollups (CSQLHelper::ScheduleDay), also run by the tester
+// ?1 = first day (YYYY-MM-DD), ?2 = end of the period (YYYY-MM-DD 00:00:00)
+// Every device is looked up through its (DeviceRowID, Date) index. The samples of the period are LEFT JOINed,
+// a device without samples gets a zero row, like the per-device rollups did
+
+constexpr auto sqlCalendarTemperature =
+"INSERT INTO Temperature_Calendar (DeviceRowID, Temp_Min, Temp_Max, Temp_Avg, Chill_Min, Chill_Max, Humidity, Barometer, DewPoint, SetPoint_Min, SetPoint_Max, SetPoint_Avg, Date) "
+"SELECT d.DeviceRowID, ROUND(IFNULL(MIN(t.Temperature),0),2), ROUND(IFNULL(MAX(t.Temperature),0),2), ROUND(IFNULL(AVG(t.Temperature),0),2), "
+"ROUND(IFNULL(MIN(t.Chill),0),2), ROUND(IFNULL(MAX(t.Chill),0),2), CAST(IFNULL(AVG(t.Humidity),0) AS INTEGER), CAST(IFNULL(AVG(t.Barometer),0) AS INTEGER), "
+"ROUND(IFNULL(MIN(t.DewPoint),0),2), ROUND(IFNULL(MIN(t.SetPoint),0),2), ROUND(IFNULL(MAX(t.SetPoint),0),2), ROUND(IFNULL(AVG(t.SetPoint),0),2), ?1 "
+"FROM (SELECT DISTINCT DeviceRowID FROM Temperature) d "
+"LEFT JOIN Temperature t ON (t.DeviceRowID=d.DeviceRowID AND t.Date>=?1 AND t.Date<=?2) "
+"GROUP BY d.DeviceRowID";
+
+// Counter based rain meters, the day total is the difference of the counter (?3/?4 are the subtypes reporting a day total)
+constexpr auto sqlCalendarRainCounter =
+"INSERT INTO Rain_Calendar (DeviceRowID, Total, Rate, Date) "
+"SELECT d.DeviceRowID, ROUND(IFNULL(MAX(r.Total),0) - IFNULL(MIN(r.Total),0),2), CAST(IFNULL(MAX(r.Rate),0) AS INTEGER), ?1 "
+"FROM (SELECT DISTINCT DeviceRowID FROM Rain) d "
+"INNER JOIN DeviceStatus ds ON (ds.ID=d.DeviceRowID AND ds.SubType<>?3 AND ds.SubType<>?4) "
+"LEFT JOIN Rain r ON (r.DeviceRowID=d.DeviceRowID AND r.Date>=?1 AND r.Date<=?2) "
+"GROUP BY d.DeviceRowID "
+"HAVING (IFNULL(MAX(r.Total),0) - IFNULL(MIN(r.Total),0)) < 1000";
+
+// Rain meters reporting a day total, use the last value of the day
+constexpr auto sqlCalendarRainTotal =
+"INSERT INTO Rain_Calendar (DeviceRowID, Total, Rate, Date) "
+"SELECT r.DeviceRowID, ROUND(r.Total,2), CAST(r.Rate AS INTEGER), ?1 FROM Rain r "
+"INNER JOIN DeviceStatus ds ON (ds.ID=r.DeviceRowID AND (ds.SubType=?3 OR ds.SubType=?4)) "
+"WHERE r.ROWID IN (SELECT MAX(ROWID) FROM Rain WHERE (Date>=?1 AND Date<=?2) GROUP BY DeviceRowID) AND (r.Total < 1000)";
+
+// Meters need per-device handling, first/last values of the day and the last counter are index lookups
+constexpr auto sqlCalendarMeter =
+"SELECT ds.ID, ds.Name, ds.Type, ds.SubType, ds.SwitchType, ds.Options, MIN(m.Value), MAX(m.Value), AVG(m.Value), "
+"(SELECT Value FROM Meter WHERE (DeviceRowID=d.DeviceRowID AND Date>=?1 AND Date<=?2) ORDER BY Date ASC LIMIT 1), "
+"(SELECT Value FROM Meter WHERE (DeviceRowID=d.DeviceRowID AND Date>=?1 AND Date<=?2) ORDER BY Date DESC LIMIT 1), "
+"(SELECT Value FROM Meter WHERE (DeviceRowID=d.DeviceRowID) ORDER BY ROWID DESC LIMIT 1), "
+"(SELECT [Usage] FROM Meter WHERE (DeviceRowID=d.DeviceRowID) ORDER BY ROWID DESC LIMIT 1) "
+"FROM (SELECT DISTINCT DeviceRowID FROM Meter) d "
+"INNER JOIN DeviceStatus ds ON (ds.ID=d.DeviceRowID) "
+"LEFT JOIN Meter m ON (m.DeviceRowID=d.DeviceRowID AND m.Date>=?1 AND m.Date<=?2) "
+"GROUP BY d.DeviceRowID";
+
+constexpr auto sqlCalendarMultiMeter =
+"SELECT ds.ID, ds.Name, ds.Type, ds.SubType, ds.Options, "
+"MIN(m.Value1), MAX(m.Value1), MIN(m.Value2), MAX(m.Value2), MIN(m.Value3), MAX(m.Value3), MIN(m.Value4), MAX(m.Value4), MIN(m.Value5), MAX(m.Value5), MIN(m.Value6), MAX(m.Value6) "
+"FROM (SELECT DISTINCT DeviceRowID FROM MultiMeter) d "
+"INNER JOIN DeviceStatus ds ON (ds.ID=d.DeviceRowID) "
+"LEFT JOIN MultiMeter m ON (m.DeviceRowID=d.DeviceRowID AND m.Date>=?1 AND m.Date<=?2) "
+"GROUP BY d.DeviceRowID";
+
+constexpr auto sqlCalendarWind =
+"INSERT INTO Wind_Calendar (DeviceRowID, Direction, Speed_Min, Speed_Max, Gust_Min, Gust_Max, Date) "
+"SELECT d.DeviceRowID, ROUND(IFNULL(AVG(w.Direction),0),2), CAST(IFNULL(MIN(w.Speed),0) AS INTEGER), CAST(IFNULL(MAX(w.Speed),0) AS INTEGER), "
+"CAST(IFNULL(MIN(w.Gust),0) AS INTEGER), CAST(IFNULL(MAX(w.Gust),0) AS INTEGER), ?1 "
+"FROM (SELECT DISTINCT DeviceRowID FROM Wind) d "
+"LEFT JOIN Wind w ON (w.DeviceRowID=d.DeviceRowID AND w.Date>=?1 AND w.Date<=?2) "
+"GROUP BY d.DeviceRowID";
+
+constexpr auto sqlCalendarUV =
+"INSERT INTO UV_Calendar (DeviceRowID, Level, Date) "
+"SELECT d.DeviceRowID, IFNULL(MAX(u.Level),0), ?1 "
+"FROM (SELECT DISTINCT DeviceRowID FROM UV) d "
+"LEFT JOIN UV u ON (u.DeviceRowID=d.DeviceRowID AND u.Date>=?1 AND u.Date<=?2) "
+"GROUP BY d.DeviceRowID";
+
+constexpr auto sqlCalendarPercentage =
+"INSERT INTO Percentage_Calendar (DeviceRowID, Percentage_Min, Percentage_Max, Percentage_Avg, Date) "
+"SELECT d.DeviceRowID, IFNULL(MIN(p.Percentage),0), IFNULL(MAX(p.Percentage),0), IFNULL(AVG(p.Percentage),0), ?1 "
+"FROM (SELECT DISTINCT DeviceRowID FROM Percentage) d "
+"LEFT JOIN Percentage p ON (p.DeviceRowID=d.DeviceRowID AND p.Date>=?1 AND p.Date<=?2) "
+"GROUP BY d.DeviceRowID";
+
+constexpr auto sqlCalendarFan =
+"INSERT INTO Fan_Calendar (DeviceRowID, Speed_Min, Speed_Max, Speed_Avg, Date) "
+"SELECT d.DeviceRowID, CAST(IFNULL(MIN(f.Speed),0) AS INTEGER), CAST(IFNULL(MAX(f.Speed),0) AS INTEGER), CAST(IFNULL(AVG(f.Speed),0) AS INTEGER), ?1 "
+"FROM (SELECT DISTINCT DeviceRowID FROM Fan) d "
+"LEFT JOIN Fan f ON (f.DeviceRowID=d.DeviceRowID AND f.Date>=?1 AND f.Date<=?2) "
+"GROUP BY d.DeviceRowID";
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "SQLHelper.h"
+#include "SQLCalendarQueries.h"
 #include <iostream>	 /* standard I/O functions						 */
 #include <string>
 #ifdef WIN32
@@ -42,6 +43,9 @@
 
 #define DB_VERSION 161
 
+#define SQL_STATEMENT_CACHE_SIZE 64
+#define SQL_SHORTLOG_INSERT_ROWS 100
+
 #define DEFAULT_ADMINUSER "admin"
 #define DEFAULT_ADMINPWD "domoticz"
 
@@ -693,6 +697,7 @@ CSQLHelper::CSQLHelper()
 	m_bShortLogAddOnlyNewValues = false;
 	m_bPreviousAcceptNewHardware = false;
 	m_bLogEventScriptTrigger = false;
+	m_bLuaPersistentStates = false;
 
 	SetDatabaseName("domoticz.db");
 }
@@ -719,6 +724,12 @@ bool CSQLHelper::OpenDatabase()
 	sqlite3_exec(m_dbase, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
 	sqlite3_exec(m_dbase, "PRAGMA busy_timeout = 1000", nullptr, nullptr, nullptr);
 
+	//Keep our DeviceStatus and Preferences caches coherent with every update/delete done on this connection
+	ClearDeviceStatusCache();
+	ClearPreferencesCache();
+	ResetDeviceJournal();
+	sqlite3_update_hook(m_dbase, DatabaseUpdateHook, this);
+
 	std::vector<std::vector<std::string> > result = query("SELECT name FROM sqlite_master WHERE type='table' AND name='DeviceStatus'");
 	bool bNewInstall = (result.empty());
 	int dbversion = 0;
@@ -3489,6 +3500,14 @@ bool CSQLHelper::OpenDatabase()
 	}
 	m_bLogEventScriptTrigger = (nValue != 0);
 
+	nValue = 0;
+	if (!GetPreferencesVar("LuaPersistentStates", nValue))
+	{
+		UpdatePreferencesVar("LuaPersistentStates", 0);
+		nValue = 0;
+	}
+	m_bLuaPersistentStates = (nValue != 0);
+
 	if ((!GetPreferencesVar("WebTheme", sValue)) || (sValue.empty()))
 	{
 		UpdatePreferencesVar("WebTheme", "default");
@@ -3604,6 +3623,8 @@ bool CSQLHelper::OpenDatabase()
 	//Update version in database
 	UpdatePreferencesVar("Domoticz_Version", szAppVersion);
 
+	CreateLogDataTriggers();
+
 	//Start background thread
 	if (!StartThread())
 		return false;
@@ -3615,14 +3636,29 @@ void CSQLHelper::CloseDatabase()
 	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
 	if (m_dbase != nullptr)
 	{
+		FlushDeviceWritesInt();
+		ClearStatementCache();
 		OptimizeDatabase(m_dbase);
 		sqlite3_close(m_dbase);
 		m_dbase = nullptr;
 	}
+	ClearDeviceStatusCache();
+	ClearPreferencesCache();
+	ResetDeviceJournal();
 }
 
 void CSQLHelper::StopThread()
 {
+	if (m_device_write_thread)
+	{
+		{
+			std::lock_guard<std::mutex> l(m_device_write_mutex);
+			m_device_write_stop = true;
+		}
+		m_device_write_cond.notify_one();
+		m_device_write_thread->join();
+		m_device_write_thread.reset();
+	}
 	if (m_thread)
 	{
 		RequestStop();
@@ -3636,6 +3672,13 @@ bool CSQLHelper::StartThread()
 	RequestStart();
 	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
 	SetThreadName(m_thread->native_handle(), "SQLHelper");
+	if (m_device_write_interval > 0)
+	{
+		m_device_write_stop = false;
+		m_device_write_thread = std::make_shared<std::thread>([this] { Do_Work_DeviceWriter(); });
+		SetThreadName(m_device_write_thread->native_handle(), "SQLWriter");
+		_log.Log(LOG_STATUS, "SQLHelper: Batching device writes (every %d ms or %d rows)", m_device_write_interval, m_device_write_max_rows);
+	}
 	return (m_thread != nullptr);
 }
 
@@ -4281,6 +4324,12 @@ void CSQLHelper::SetJournalMode(const std::string& mode)
 	m_journal_mode = mode;
 }
 
+void CSQLHelper::SetDeviceWriteBatching(const int IntervalMs, const int MaxRows)
+{
+	m_device_write_interval = (IntervalMs > 0) ? IntervalMs : 0;
+	m_device_write_max_rows = (MaxRows > 0) ? MaxRows : 1;
+}
+
 bool CSQLHelper::DoesColumnExistsInTable(const std::string& columnname, const std::string& tablename)
 {
 	if (!m_dbase)
@@ -4349,6 +4398,9 @@ bool CSQLHelper::safe_UpdateBlobInTableWithID(const std::string& Table, const st
 
 int CSQLHelper::execute_sql(const std::string &sSQL, std::vector<std::string> *pValues, bool bLogError)
 {
+	if (m_device_write_pending != 0)
+		FlushDeviceWrites();
+
 	CSQLStatement sqlStatement(m_dbase, sSQL);
 	std::vector<std::vector<std::string>> result;
 	for (unsigned int i = 0; (i < pValues->size()) && (!sqlStatement.Error()); i++)
@@ -4419,6 +4471,10 @@ std::vector<std::vector<std::string> > CSQLHelper::query(const std::string& szQu
 	}
 	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
 
+	//Pending device writes have to be in the database before anyone reads or changes it
+	if (m_device_write_pending != 0)
+		FlushDeviceWritesInt();
+
 	sqlite3_stmt* statement;
 	std::vector<std::vector<std::string> > results;
     _log.Debug(DEBUG_SQL, "Query:%s", szQuery.c_str());
@@ -4486,6 +4542,9 @@ std::vector<std::vector<std::string> > CSQLHelper::queryBlob(const std::string&
 	}
 	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
 
+	if (m_device_write_pending != 0)
+		FlushDeviceWritesInt();
+
 	sqlite3_stmt* statement;
 	std::vector<std::vector<std::string> > results;
 
@@ -4526,6 +4585,148 @@ std::vector<std::vector<std::string> > CSQLHelper::queryBlob(const std::string&
 	return results;
 }
 
+static void BindSQLParams(sqlite3_stmt* statement, const _tSQLParam* params, const size_t nparams)
+{
+	for (size_t ii = 0; ii < nparams; ii++)
+	{
+		int iParam = (int)ii + 1;
+		switch (params[ii].type)
+		{
+		case _tSQLParam::SP_INT:
+			sqlite3_bind_int64(statement, iParam, (sqlite3_int64)params[ii].iValue);
+			break;
+		case _tSQLParam::SP_REAL:
+			sqlite3_bind_double(statement, iParam, params[ii].dValue);
+			break;
+		case _tSQLParam::SP_TEXT:
+			sqlite3_bind_text(statement, iParam, params[ii].szValue, (int)params[ii].length, SQLITE_STATIC);
+			break;
+		default:
+			sqlite3_bind_null(statement, iParam);
+			break;
+		}
+	}
+}
+
+//m_sqlQueryMutex has to be locked by the caller
+sqlite3_stmt* CSQLHelper::GetCachedStatement(const std::string& szSQL)
+{
+	auto itt = m_statement_cache_index.find(szSQL);
+	if (itt != m_statement_cache_index.end())
+	{
+		//move to front (most recently used)
+		m_statement_cache.splice(m_statement_cache.begin(), m_statement_cache, itt->second);
+		return itt->second->second;
+	}
+
+	sqlite3_stmt* statement = nullptr;
+	if (sqlite3_prepare_v3(m_dbase, szSQL.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &statement, nullptr) != SQLITE_OK)
+	{
+		_log.Log(LOG_ERROR, "SQL Prepare(\"%s\") : %s", szSQL.c_str(), sqlite3_errmsg(m_dbase));
+		return nullptr;
+	}
+	m_statement_cache.emplace_front(szSQL, statement);
+	m_statement_cache_index[szSQL] = m_statement_cache.begin();
+	if (m_statement_cache.size() > SQL_STATEMENT_CACHE_SIZE)
+	{
+		//evict least recently used
+		sqlite3_finalize(m_statement_cache.back().second);
+		m_statement_cache_index.erase(m_statement_cache.back().first);
+		m_statement_cache.pop_back();
+	}
+	std::lock_guard<std::mutex> l(m_statement_stats_mutex);
+	m_statement_stats[szSQL].prepares++;
+	return statement;
+}
+
+//m_sqlQueryMutex has to be locked by the caller (or the database is already closed for others)
+void CSQLHelper::ClearStatementCache()
+{
+	for (const auto& itt : m_statement_cache)
+		sqlite3_finalize(itt.second);
+	m_statement_cache.clear();
+	m_statement_cache_index.clear();
+}
+
+std::vector<std::vector<std::string>> CSQLHelper::bind_query_int(const char* szSQL, const _tSQLParam* params, const size_t nparams)
+{
+	std::vector<std::vector<std::string> > results;
+	if (!m_dbase)
+	{
+		_log.Log(LOG_ERROR, "Database not open!!...Check your user rights!..");
+		return results;
+	}
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+
+	if (m_device_write_pending != 0)
+		FlushDeviceWritesInt();
+
+	return bind_query_nolock_int(szSQL, params, nparams);
+}
+
+//m_sqlQueryMutex has to be locked by the caller
+std::vector<std::vector<std::string>> CSQLHelper::bind_query_nolock_int(const char* szSQL, const _tSQLParam* params, const size_t nparams)
+{
+	std::vector<std::vector<std::string> > results;
+	if (!m_dbase)
+		return results;
+
+	std::string szQuery(szSQL);
+	_log.Debug(DEBUG_SQL, "Query:%s", szSQL);
+	auto tStart = std::chrono::steady_clock::now();
+
+	sqlite3_stmt* statement = GetCachedStatement(szQuery);
+	if (statement == nullptr)
+		return results;
+
+	BindSQLParams(statement, params, nparams);
+
+	int cols = sqlite3_column_count(statement);
+	int rc;
+	while ((rc = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		std::vector<std::string> values;
+		for (int col = 0; col < cols; col++)
+		{
+			char* value = (char*)sqlite3_column_text(statement, col);
+			if ((value == nullptr) && (col == 0))
+				break;
+			if (value == nullptr)
+				values.push_back(std::string("")); //insert empty string
+			else
+				values.push_back(value);
+		}
+		if (!values.empty())
+			results.push_back(values);
+	}
+	if (rc != SQLITE_DONE)
+		_log.Log(LOG_ERROR, "SQL Query(\"%s\") : %s", szSQL, sqlite3_errmsg(m_dbase));
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+
+	uint64_t tElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count();
+	std::lock_guard<std::mutex> l2(m_statement_stats_mutex);
+	_tStatementStats& sStats = m_statement_stats[szQuery];
+	sStats.calls++;
+	sStats.total_us += tElapsed;
+	return results;
+}
+
+void CSQLHelper::GetStatementStats(Json::Value& root)
+{
+	std::lock_guard<std::mutex> l(m_statement_stats_mutex);
+	int ii = 0;
+	for (const auto& itt : m_statement_stats)
+	{
+		root[ii]["sql"] = itt.first;
+		root[ii]["calls"] = (Json::UInt64)itt.second.calls;
+		root[ii]["prepares"] = (Json::UInt64)itt.second.prepares;
+		root[ii]["total_ms"] = (double)itt.second.total_us / 1000.0;
+		root[ii]["avg_us"] = (itt.second.calls != 0) ? (double)itt.second.total_us / (double)itt.second.calls : 0.0;
+		ii++;
+	}
+}
+
 uint64_t CSQLHelper::CreateDevice(const int HardwareID, const int SensorType, const int SensorSubType, std::string &devname, const unsigned long nid, const std::string &soptions,
 				  const std::string &userName)
 {
@@ -4823,7 +5024,7 @@ uint64_t CSQLHelper::UpdateValue(const int HardwareID, const char* ID, const uns
 	//Get the ID of this device
 	std::vector<std::vector<std::string> > result, result2;
 
-	result = safe_query("SELECT ID FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)", HardwareID, ID, unit, devType, subType);
+	result = bind_query("SELECT ID FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)", HardwareID, ID, unit, devType, subType);
 	if (result.empty())
 		return devRowID; //should never happen, because it was previously inserted if non-existent
 
@@ -5064,8 +5265,8 @@ uint64_t CSQLHelper::InsertDevice(const int HardwareID, const char* ID, const un
 		nValue, sValue, name.c_str());
 
 	//Get new ID
-	result = safe_query(
-		"SELECT ID FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)",
+	result = bind_query(
+		"SELECT ID FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)",
 		HardwareID, ID, unit, devType, subType);
 	if (result.empty())
 	{
@@ -5086,168 +5287,677 @@ uint64_t CSQLHelper::GetDeviceIndex(const int HardwareID, const std::string& ID,
 	return std::stoull(result[0].at(0));
 }
 
-uint64_t CSQLHelper::UpdateValueInt(
-        const int HardwareID, const char *ID, const unsigned char unit, const unsigned char devType, const unsigned char subType,
-        const unsigned char signallevel, const unsigned char batterylevel, const int nValue, const char *sValue, std::string &devname,
-        const bool bUseOnOffAction,
-		const char* User
-)
+//Row ID that the current thread is writing through the DeviceStatus cache itself (0 = none)
+static thread_local uint64_t tl_DeviceCacheOwnWriteID = 0;
+
+struct _tDeviceCacheOwnWrite
 {
-	if (!m_dbase)
-		return -1;
+	explicit _tDeviceCacheOwnWrite(const uint64_t idx)
+	{
+		tl_DeviceCacheOwnWriteID = idx;
+	}
+	~_tDeviceCacheOwnWrite()
+	{
+		tl_DeviceCacheOwnWriteID = 0;
+	}
+};
 
-	uint64_t ulID = 0;
-	bool bDeviceUsed = false;
-	bool bSameDeviceStatusValue = false;
-	int nValueBeforeUpdate = -1;
-	std::string sValueBeforeUpdate;
-	_eSwitchType stype = STYPE_OnOff;
+//Set while the current thread writes a preference through UpdatePreferencesVar/DeletePreferencesVar
+static thread_local bool tl_PreferencesOwnWrite = false;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID, Name, Used, SwitchType, nValue, sValue, LastUpdate, Options FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)", HardwareID, ID, unit, devType, subType);
-	if (result.empty())
+struct _tPreferencesOwnWrite
+{
+	_tPreferencesOwnWrite()
 	{
-		//Insert
-		ulID = InsertDevice(HardwareID, ID, unit, devType, subType, 0, nValue, sValue, devname, signallevel, batterylevel);
+		tl_PreferencesOwnWrite = true;
+	}
+	~_tPreferencesOwnWrite()
+	{
+		tl_PreferencesOwnWrite = false;
+	}
+};
 
-		if (ulID == (uint64_t)-1)
-		{
-			return -1;
-		}
+//Log tables (and their _Calendar tables) graphs are made of
+static const char* szGraphLogTables[] = { "Temperature", "Rain", "Wind", "UV", "Meter", "MultiMeter", "Percentage", "Fan" };
 
-#ifdef ENABLE_PYTHON
-		//TODO: Plugins should perhaps be blocked from implicitly adding a device by update? It's most likely a bug due to updating a removed device..
-		CDomoticzHardwareBase* pHardware = m_mainworker.GetHardware(HardwareID);
-		if (pHardware != nullptr && pHardware->HwdType == HTYPE_PythonPlugin)
+void CSQLHelper::LogDataChangedFunction(sqlite3_context* context, const int /*argc*/, sqlite3_value** argv)
+{
+	CSQLHelper* pHelper = static_cast<CSQLHelper*>(sqlite3_user_data(context));
+	pHelper->SetLogDataChanged((uint64_t)sqlite3_value_int64(argv[0]));
+}
+
+void CSQLHelper::CreateLogDataTriggers()
+{
+	//TEMP triggers only live on this connection, they tell which device a log row belongs to (the update hook only knows the rowid)
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	m_bLogDataTriggers = false;
+	if (sqlite3_create_function(m_dbase, "dz_log_data_changed", 1, SQLITE_UTF8, this, LogDataChangedFunction, nullptr, nullptr) != SQLITE_OK)
+	{
+		_log.Log(LOG_ERROR, "SQL: Could not register dz_log_data_changed: %s", sqlite3_errmsg(m_dbase));
+		return;
+	}
+	std::string szSQL = "BEGIN TRANSACTION;\n";
+	for (const char* szLogTable : szGraphLogTables)
+	{
+		for (const auto& szTable : { std::string(szLogTable), std::string(szLogTable) + "_Calendar" })
 		{
-			_log.Debug(DEBUG_NORM, "CSQLHelper::UpdateValueInt: Notifying plugin %u about creation of device %u", HardwareID, unit);
-			Plugins::CPlugin* pPlugin = (Plugins::CPlugin*)pHardware;
-			pPlugin->DeviceAdded(ID, unit);
+			szSQL += std_format("CREATE TEMP TRIGGER IF NOT EXISTS dz_%s_insert AFTER INSERT ON main.%s BEGIN SELECT dz_log_data_changed(NEW.DeviceRowID); END;\n", szTable.c_str(), szTable.c_str());
+			szSQL += std_format("CREATE TEMP TRIGGER IF NOT EXISTS dz_%s_update AFTER UPDATE ON main.%s BEGIN SELECT dz_log_data_changed(NEW.DeviceRowID); END;\n", szTable.c_str(), szTable.c_str());
+			szSQL += std_format("CREATE TEMP TRIGGER IF NOT EXISTS dz_%s_delete AFTER DELETE ON main.%s BEGIN SELECT dz_log_data_changed(OLD.DeviceRowID); END;\n", szTable.c_str(), szTable.c_str());
 		}
-#endif
 	}
-	else
+	szSQL += "COMMIT;";
+	char* errorMessage = nullptr;
+	if (sqlite3_exec(m_dbase, szSQL.c_str(), nullptr, nullptr, &errorMessage) != SQLITE_OK)
 	{
-		//Update
-		ulID = std::stoull(result[0][0]);
-		std::string sOption = result[0][7];
-		auto options = BuildDeviceOptions(sOption);
-		devname = result[0][1];
-		bDeviceUsed = atoi(result[0][2].c_str()) != 0;
-		stype = (_eSwitchType)atoi(result[0][3].c_str());
-		nValueBeforeUpdate = atoi(result[0][4].c_str());
-		sValueBeforeUpdate = result[0][5];
-
-		std::string sLastUpdate = TimeToString(nullptr, TF_DateTime);
+		_log.Log(LOG_ERROR, "SQL: Could not create the log data triggers: %s", (errorMessage != nullptr) ? errorMessage : "unknown error");
+		sqlite3_free(errorMessage);
+		if (sqlite3_get_autocommit(m_dbase) == 0)
+			sqlite3_exec(m_dbase, "ROLLBACK", nullptr, nullptr, nullptr);
+		return;
+	}
+	m_bLogDataTriggers = true;
+}
 
-		//Commit: If Option 1: energy is computed as usage*time
-		//Default is option 0, read from device
-		if (options["EnergyMeterMode"] == "1" && devType == pTypeGeneral && subType == sTypeKwh)
-		{
-            double intervalSeconds;
-            struct tm ntime;
-			std::string sLastUpdate = result[0][6];
+void CSQLHelper::SetLogDataChanged(const uint64_t DeviceRowIdx)
+{
+	std::lock_guard<std::mutex> l(m_log_data_mutex);
+	m_log_data_generation++;
+	if (DeviceRowIdx == 0)
+		m_log_data_global_generation = m_log_data_generation;
+	else
+		m_device_log_data_generation[DeviceRowIdx] = m_log_data_generation;
+}
 
-			time_t now = time(nullptr);
-			struct tm ltime;
-			localtime_r(&now, &ltime);
+uint64_t CSQLHelper::GetLogDataGeneration(const uint64_t DeviceRowIdx)
+{
+	std::lock_guard<std::mutex> l(m_log_data_mutex);
+	auto itt = m_device_log_data_generation.find(DeviceRowIdx);
+	if ((itt != m_device_log_data_generation.end()) && (itt->second > m_log_data_global_generation))
+		return itt->second;
+	return m_log_data_global_generation;
+}
 
-			time_t lutime;
-			ParseSQLdatetime(lutime, ntime, sLastUpdate, ltime.tm_isdst);
-			intervalSeconds = difftime(now, lutime);
+void CSQLHelper::DatabaseUpdateHook(void* pUserData, const int op, const char* /*zDb*/, const char* zTable, const long long rowid)
+{
+	CSQLHelper* pHelper = static_cast<CSQLHelper*>(pUserData);
+	pHelper->AddDeviceJournalChange(op, zTable, (uint64_t)rowid);
+	if (strcmp(zTable, "DeviceStatus") != 0)
+	{
+		//Preferences written with plain SQL, reload the cache on next use
+		if ((strcmp(zTable, "Preferences") == 0) && (!tl_PreferencesOwnWrite))
+			pHelper->ClearPreferencesCache();
+		else if ((strcmp(zTable, "Hardware") == 0) || (strcmp(zTable, "Cameras") == 0))
+			pHelper->m_hardware_data_generation++;
 
-            std::vector<std::string> powerAndEnergyBeforeUpdate;
-			StringSplit(sValueBeforeUpdate, ";", powerAndEnergyBeforeUpdate);
-			if (powerAndEnergyBeforeUpdate.size() == 2)
+		//Any change to the preferences makes cached graph data outdated, (calendar) log changes are reported per device by the triggers
+		if (strcmp(zTable, "Preferences") == 0)
+			pHelper->SetLogDataChanged(0);
+		else if (!pHelper->m_bLogDataTriggers)
+		{
+			for (const char* szLogTable : szGraphLogTables)
 			{
-				//we need to use atof here because some users seem to have a illegal sValue in the database that causes std::stof to crash
-				double powerDuringInterval = atof(powerAndEnergyBeforeUpdate[0].c_str());
-				double energyUpToInterval = atof(powerAndEnergyBeforeUpdate[1].c_str());
-				double energyDuringInterval = powerDuringInterval * intervalSeconds / 3600;
-				double energyAfterInterval = energyUpToInterval + energyDuringInterval;
-				std::vector<std::string> powerAndEnergyUpdate;
-				StringSplit(sValue, ";", powerAndEnergyUpdate);
-				if (!powerAndEnergyUpdate.empty())
-				{
-					const char* powerUpdate = powerAndEnergyUpdate[0].c_str();
-                    char sValueUpdate[100];
-                    sprintf(sValueUpdate, "%s;%.4f", powerUpdate, energyAfterInterval);
-					sValue = sValueUpdate;
-				}
-				else
+				size_t len = strlen(szLogTable);
+				if ((strncmp(zTable, szLogTable, len) == 0) && ((zTable[len] == 0) || (strcmp(zTable + len, "_Calendar") == 0)))
 				{
-                    sValue = sValueBeforeUpdate.c_str();
+					pHelper->SetLogDataChanged(0);
+					break;
 				}
 			}
-			else
-            {
-                sValue = sValueBeforeUpdate.c_str();
-            }
-		}
-		//~ use different update queries based on the device type
-		if (devType == pTypeGeneral && subType == sTypeCounterIncremental)
-		{
-			result = safe_query(
-				"UPDATE DeviceStatus SET SignalLevel=%d, BatteryLevel=%d, nValue= nValue + %d, sValue= sValue + '%q', LastUpdate='%q' "
-				"WHERE (ID = %" PRIu64 ")",
-				signallevel, batterylevel,
-				nValue, sValue,
-				sLastUpdate.c_str(),
-				ulID);
 		}
-		else
+		return;
+	}
+	//New rows are loaded on first use, we only have to drop rows that are changed or deleted
+	if (op == SQLITE_INSERT)
+		return;
+	if ((op == SQLITE_UPDATE) && ((uint64_t)rowid == tl_DeviceCacheOwnWriteID))
+		return;
+	pHelper->InvalidateDeviceStatusCache((uint64_t)rowid);
+	//Own writes only change values, anything else can change the columns notifications keep (SwitchType, Options, ...)
+	m_notifications.InvalidateDeviceInfo((uint64_t)rowid);
+}
+
+void CSQLHelper::AddDeviceJournalChange(const int op, const char* zTable, const uint64_t rowid)
+{
+	//Tables that change what the device list looks like, or which rows it contains
+	static const char* szStructureTables[] = { "Hardware", "Plans", "DeviceToPlansMap", "Floorplans", "SharedDevices", "Users", "LightSubDevices",
+		"SceneDevices", "Timers", "SceneTimers", "Cameras", "CamerasActiveDevices" };
+
+	bool bIsDevice = (strcmp(zTable, "DeviceStatus") == 0);
+	bool bIsScene = (!bIsDevice) && (strcmp(zTable, "Scenes") == 0);
+	bool bIsStructure = false;
+	if ((bIsDevice) || (bIsScene))
+		bIsStructure = (op == SQLITE_DELETE); //a removed row can not be reported as a changed row
+	else
+	{
+		for (const char* szTable : szStructureTables)
 		{
-			if (
-				(stype == STYPE_DoorContact) ||
-				(stype == STYPE_DoorLock) ||
-				(stype == STYPE_DoorLockInverted) ||
-				(stype == STYPE_Contact)
-				)
+			if (strcmp(zTable, szTable) == 0)
 			{
-				//Check if we received the same state as before, if yes, don't do anything (only update)
-				//This is specially handy for devices that send a keep-alive status every xx minutes
-				//like professional alarm system equipment
-				//.. we should make this an option of course
-				bSameDeviceStatusValue = (
-					(nValue == nValueBeforeUpdate) &&
-					(sValue == sValueBeforeUpdate)
-					);
+				bIsStructure = true;
+				break;
 			}
+		}
+		if (!bIsStructure)
+			return;
+	}
 
-			if ((devType == pTypeGeneral && subType == sTypeManagedCounter) || (options["AddDBLogEntry"] == "true"))
-			{
-				std::vector<std::string> parts, parts2;
-				StringSplit(sValue, ";", parts);
-				if (parts.size() == 11)
-				{
-					// is last part date only, or date with hour with space?
-					StringSplit(parts[10], " ", parts2);
-					bool shortLog = false;
-					if (parts2.size() > 1) {
-						shortLog = true;
-					}
-					// second part is date only, or date with hour with space
-					// In DeviceStatus table, index 0 = Usage 1,  1 = Usage 2, 2 = Delivery 1,  3 = Delivery 2, 4 = Usage current, 5 = Delivery current
-					// In MultiMeter table, index 0 = Usage 1, 1 = Delivery 1, 2 = Usage current, 3 = Delivery current, 4 = Usage 2, 5 = Delivery 2
-					// In MultiMeter_Calendar table, same as Multimeter table + counter1, counter2, counter3 and counter4 when shortlog is False
-					UpdateCalendarMeter(HardwareID, ID, unit, devType, subType,
-						shortLog,
-						true,
-						parts[10].c_str(),
-						std::stoll(parts[0]),
-						std::stoll(parts[2]),
-						std::stoll(parts[4]),
-						std::stoll(parts[5]),
-						std::stoll(parts[1]),
-						std::stoll(parts[3]),
-						std::stoll(parts[6]),
-						std::stoll(parts[7]),
-						std::stoll(parts[8]),
-						std::stoll(parts[9])
-					);
-					result = safe_query("UPDATE DeviceStatus SET LastUpdate='%q' WHERE (ID = %" PRIu64 ")", sLastUpdate.c_str(), ulID);
-					return ulID;
-				}
+	std::lock_guard<std::mutex> l(m_device_journal_mutex);
+	uint64_t sequence = ++m_device_journal_sequence;
+
+	//Remember where every second starts, so a lastupdate time can be turned into a sequence (kept for an hour)
+	time_t now = mytime(nullptr);
+	if (m_device_journal_times.empty() || (m_device_journal_times.back().first != now))
+		m_device_journal_times.emplace_back(now, sequence - 1);
+	while (m_device_journal_times.front().first < now - 3600)
+	{
+		m_device_journal_times_start = m_device_journal_times.front().first + 1;
+		m_device_journal_times.pop_front();
+	}
+
+	if (bIsStructure)
+	{
+		//Per row information before this point is no longer needed
+		m_device_journal_floor = sequence;
+		m_device_journal_devices.clear();
+		m_device_journal_scenes.clear();
+		return;
+	}
+	if (bIsDevice)
+		m_device_journal_devices[rowid] = sequence;
+	else
+		m_device_journal_scenes[rowid] = sequence;
+}
+
+void CSQLHelper::ResetDeviceJournal()
+{
+	std::lock_guard<std::mutex> l(m_device_journal_mutex);
+	//Start above anything a client could have from a previous run or database
+	m_device_journal_sequence = std::max(m_device_journal_sequence + 1, static_cast<uint64_t>(mytime(nullptr)) << 20);
+	m_device_journal_floor = m_device_journal_sequence;
+	m_device_journal_devices.clear();
+	m_device_journal_scenes.clear();
+	m_device_journal_times.clear();
+	m_device_journal_times_start = mytime(nullptr);
+}
+
+uint64_t CSQLHelper::GetDeviceChangeSequence()
+{
+	std::lock_guard<std::mutex> l(m_device_journal_mutex);
+	return m_device_journal_sequence;
+}
+
+uint64_t CSQLHelper::GetDeviceChangeSequenceAt(const time_t tTime)
+{
+	std::lock_guard<std::mutex> l(m_device_journal_mutex);
+	if (tTime < m_device_journal_times_start)
+		return 0;
+	auto itt = std::lower_bound(m_device_journal_times.begin(), m_device_journal_times.end(), tTime,
+				    [](const std::pair<time_t, uint64_t> &a, const time_t b) { return a.first < b; });
+	if (itt == m_device_journal_times.end())
+		return m_device_journal_sequence; //nothing changed since
+	return itt->second;
+}
+
+bool CSQLHelper::GetDeviceChangesSince(const uint64_t Sequence, std::set<uint64_t>& Devices, std::set<uint64_t>& Scenes)
+{
+	Devices.clear();
+	Scenes.clear();
+	std::lock_guard<std::mutex> l(m_device_journal_mutex);
+	if ((Sequence < m_device_journal_floor) || (Sequence > m_device_journal_sequence))
+		return false;
+	for (const auto& itt : m_device_journal_devices)
+	{
+		if (itt.second > Sequence)
+			Devices.insert(itt.first);
+	}
+	for (const auto& itt : m_device_journal_scenes)
+	{
+		if (itt.second > Sequence)
+			Scenes.insert(itt.first);
+	}
+	return true;
+}
+
+void CSQLHelper::InvalidateDeviceStatusCache(const uint64_t idx)
+{
+	std::lock_guard<std::mutex> l(m_device_cache_mutex);
+	m_device_cache_generation++;
+	auto itt = m_device_cache_idx.find(idx);
+	if (itt == m_device_cache_idx.end())
+		return;
+	m_device_cache.erase(itt->second);
+	m_device_cache_idx.erase(itt);
+}
+
+void CSQLHelper::ClearDeviceStatusCache()
+{
+	std::lock_guard<std::mutex> l(m_device_cache_mutex);
+	m_device_cache_generation++;
+	m_device_cache.clear();
+	m_device_cache_idx.clear();
+}
+
+void CSQLHelper::GetDeviceStatusCacheStats(uint64_t& hits, uint64_t& misses, size_t& entries)
+{
+	std::lock_guard<std::mutex> l(m_device_cache_mutex);
+	hits = m_device_cache_hits;
+	misses = m_device_cache_misses;
+	entries = m_device_cache.size();
+}
+
+bool CSQLHelper::GetDeviceStatusCacheItem(const int HardwareID, const char* ID, const unsigned char unit, const unsigned char devType, const unsigned char subType, _tDeviceStatusCacheItem& dItem)
+{
+	std::string szKey = std_format("%d|%s|%d|%d|%d", HardwareID, ID, unit, devType, subType);
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> l(m_device_cache_mutex);
+		auto itt = m_device_cache.find(szKey);
+		if (itt != m_device_cache.end())
+		{
+			m_device_cache_hits++;
+			dItem = itt->second;
+			return true;
+		}
+		m_device_cache_misses++;
+		generation = m_device_cache_generation;
+	}
+
+	//Not cached (yet), the database lookup is done without holding the cache lock
+	auto result = bind_query("SELECT ID, Name, Used, SwitchType, nValue, sValue, LastUpdate, Options FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)", HardwareID, ID, unit, devType, subType);
+	if (result.empty())
+		return false;
+
+	dItem.ID = std::stoull(result[0][0]);
+	dItem.devType = devType;
+	dItem.subType = subType;
+	dItem.Name = result[0][1];
+	dItem.bUsed = atoi(result[0][2].c_str()) != 0;
+	dItem.SwitchType = (_eSwitchType)atoi(result[0][3].c_str());
+	dItem.nValue = atoi(result[0][4].c_str());
+	dItem.sValue = result[0][5];
+	dItem.LastUpdate = result[0][6];
+	dItem.Options = BuildDeviceOptions(result[0][7]);
+
+	std::lock_guard<std::mutex> l(m_device_cache_mutex);
+	if (generation == m_device_cache_generation)
+	{
+		//Nothing changed in DeviceStatus since our query, safe to store
+		m_device_cache[szKey] = dItem;
+		m_device_cache_idx[dItem.ID] = szKey;
+	}
+	return true;
+}
+
+bool CSQLHelper::GetCachedDeviceState(const uint64_t idx, unsigned char& devType, unsigned char& subType, int& nValue, std::string& sValue, std::string& sLastUpdate)
+{
+	std::lock_guard<std::mutex> l(m_device_cache_mutex);
+	auto itt = m_device_cache_idx.find(idx);
+	if (itt == m_device_cache_idx.end())
+		return false;
+	const _tDeviceStatusCacheItem& dItem = m_device_cache[itt->second];
+	devType = dItem.devType;
+	subType = dItem.subType;
+	nValue = dItem.nValue;
+	sValue = dItem.sValue;
+	sLastUpdate = dItem.LastUpdate;
+	return true;
+}
+
+void CSQLHelper::SetDeviceStatusCacheValue(const uint64_t idx, const int nValue, const std::string& sValue, const std::string& sLastUpdate)
+{
+	std::lock_guard<std::mutex> l(m_device_cache_mutex);
+	auto itt = m_device_cache_idx.find(idx);
+	if (itt == m_device_cache_idx.end())
+		return;
+	_tDeviceStatusCacheItem& dItem = m_device_cache[itt->second];
+	dItem.nValue = nValue;
+	dItem.sValue = sValue;
+	dItem.LastUpdate = sLastUpdate;
+}
+
+bool CSQLHelper::QueueDeviceUpdate(const uint64_t idx, const unsigned char signallevel, const unsigned char batterylevel, const int nValue, const std::string& sValue, const std::string& sLastUpdate)
+{
+	if (m_device_write_interval == 0)
+		return false;
+	std::unique_lock<std::mutex> lock(m_device_write_mutex);
+	if (m_device_write_stop)
+		return false;
+	//Only the last value of a device has to be written
+	_tPendingDeviceUpdate& pItem = m_device_write_updates[idx];
+	pItem.signallevel = signallevel;
+	pItem.batterylevel = batterylevel;
+	pItem.nValue = nValue;
+	pItem.sValue = sValue;
+	pItem.LastUpdate = sLastUpdate;
+	m_device_write_pending = m_device_write_updates.size() + m_device_write_lightinglog.size();
+	bool bFull = (m_device_write_pending >= (size_t)m_device_write_max_rows);
+	lock.unlock();
+	if (bFull)
+		m_device_write_cond.notify_one();
+	return true;
+}
+
+bool CSQLHelper::QueueLightingLog(const uint64_t idx, const int nValue, const std::string& sValue, const std::string& User)
+{
+	if (m_device_write_interval == 0)
+		return false;
+	std::unique_lock<std::mutex> lock(m_device_write_mutex);
+	if (m_device_write_stop)
+		return false;
+	_tPendingLightingLog lItem;
+	lItem.DeviceRowID = idx;
+	lItem.nValue = nValue;
+	lItem.sValue = sValue;
+	lItem.User = User;
+	lItem.Date = TimeToString(nullptr, TF_DateTime);
+	m_device_write_lightinglog.push_back(lItem);
+	m_device_write_pending = m_device_write_updates.size() + m_device_write_lightinglog.size();
+	bool bFull = (m_device_write_pending >= (size_t)m_device_write_max_rows);
+	lock.unlock();
+	if (bFull)
+		m_device_write_cond.notify_one();
+	return true;
+}
+
+void CSQLHelper::ClearDeviceWrites()
+{
+	std::lock_guard<std::mutex> l(m_device_write_mutex);
+	m_device_write_updates.clear();
+	m_device_write_lightinglog.clear();
+	m_device_write_pending = 0;
+}
+
+void CSQLHelper::FlushDeviceWrites()
+{
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	FlushDeviceWritesInt();
+}
+
+//Writes the queued device writes in one transaction, this is done by the writer thread at its interval
+//and before any other statement on the connection, so everyone reads the pending rows from the database.
+//The transaction is begun and committed here, it is never left open for other statements to join
+//m_sqlQueryMutex has to be locked by the caller
+void CSQLHelper::FlushDeviceWritesInt()
+{
+	if (m_dbase == nullptr)
+		return;
+	//Inside a transaction of the caller (that could be rolled back) the writes stay queued,
+	//callers flush before they begin one
+	if (sqlite3_get_autocommit(m_dbase) == 0)
+		return;
+
+	std::map<uint64_t, _tPendingDeviceUpdate> updates;
+	std::vector<_tPendingLightingLog> lightinglog;
+	{
+		std::lock_guard<std::mutex> l(m_device_write_mutex);
+		updates.swap(m_device_write_updates);
+		lightinglog.swap(m_device_write_lightinglog);
+		m_device_write_pending = 0;
+	}
+	if (updates.empty() && lightinglog.empty())
+		return;
+
+	if (sqlite3_exec(m_dbase, "BEGIN IMMEDIATE TRANSACTION", nullptr, nullptr, nullptr) != SQLITE_OK)
+	{
+		//Written one by one in autocommit mode
+		_log.Log(LOG_ERROR, "SQLHelper: Error starting device write batch (%s)", sqlite3_errmsg(m_dbase));
+	}
+
+	sqlite3_stmt* stmt = nullptr;
+	if (!updates.empty())
+	{
+		if ((stmt = GetCachedStatement("UPDATE DeviceStatus SET SignalLevel=?, BatteryLevel=?, nValue=?, sValue=?, LastUpdate=? WHERE (ID = ?)")) != nullptr)
+		{
+			for (const auto& itt : updates)
+			{
+				sqlite3_bind_int(stmt, 1, itt.second.signallevel);
+				sqlite3_bind_int(stmt, 2, itt.second.batterylevel);
+				sqlite3_bind_int(stmt, 3, itt.second.nValue);
+				sqlite3_bind_text(stmt, 4, itt.second.sValue.c_str(), -1, SQLITE_STATIC);
+				sqlite3_bind_text(stmt, 5, itt.second.LastUpdate.c_str(), -1, SQLITE_STATIC);
+				sqlite3_bind_int64(stmt, 6, (sqlite3_int64)itt.first);
+				_tDeviceCacheOwnWrite ownWrite(itt.first);
+				if (sqlite3_step(stmt) != SQLITE_DONE)
+					_log.Log(LOG_ERROR, "SQLHelper: Error writing device %" PRIu64 " (%s)", itt.first, sqlite3_errmsg(m_dbase));
+				sqlite3_reset(stmt);
+			}
+			sqlite3_clear_bindings(stmt);
+		}
+	}
+	if (!lightinglog.empty())
+	{
+		if ((stmt = GetCachedStatement("INSERT INTO LightingLog (DeviceRowID, nValue, sValue, User, Date) VALUES (?, ?, ?, ?, ?)")) != nullptr)
+		{
+			for (const auto& itt : lightinglog)
+			{
+				sqlite3_bind_int64(stmt, 1, (sqlite3_int64)itt.DeviceRowID);
+				sqlite3_bind_int(stmt, 2, itt.nValue);
+				sqlite3_bind_text(stmt, 3, itt.sValue.c_str(), -1, SQLITE_STATIC);
+				sqlite3_bind_text(stmt, 4, itt.User.c_str(), -1, SQLITE_STATIC);
+				sqlite3_bind_text(stmt, 5, itt.Date.c_str(), -1, SQLITE_STATIC);
+				if (sqlite3_step(stmt) != SQLITE_DONE)
+					_log.Log(LOG_ERROR, "SQLHelper: Error adding lighting log for device %" PRIu64 " (%s)", itt.DeviceRowID, sqlite3_errmsg(m_dbase));
+				sqlite3_reset(stmt);
+			}
+			sqlite3_clear_bindings(stmt);
+		}
+	}
+
+	//A failing statement (disk full, I/O error) can make SQLite roll the transaction back by itself
+	bool bCommitted = false;
+	if (sqlite3_get_autocommit(m_dbase) != 0)
+	{
+		_log.Log(LOG_ERROR, "SQLHelper: Device write batch was rolled back, %d device update(s) and %d lighting log entries lost", (int)updates.size(), (int)lightinglog.size());
+	}
+	else if (sqlite3_exec(m_dbase, "COMMIT TRANSACTION", nullptr, nullptr, nullptr) != SQLITE_OK)
+	{
+		_log.Log(LOG_ERROR, "SQLHelper: Error committing device write batch, %d device update(s) and %d lighting log entries lost (%s)", (int)updates.size(), (int)lightinglog.size(),
+			 sqlite3_errmsg(m_dbase));
+		if (sqlite3_get_autocommit(m_dbase) == 0)
+			sqlite3_exec(m_dbase, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
+	}
+	else
+		bCommitted = true;
+
+	std::lock_guard<std::mutex> l(m_device_write_mutex);
+	if (!bCommitted)
+		return;
+	m_device_write_commits++;
+	m_device_write_rows += updates.size() + lightinglog.size();
+	_log.Debug(DEBUG_SQL, "SQLHelper: Committed %d device update(s) and %d lighting log entries", (int)updates.size(), (int)lightinglog.size());
+}
+
+void CSQLHelper::Do_Work_DeviceWriter()
+{
+	_log.Log(LOG_STATUS, "SQLHelper: Device writer thread started...");
+	std::unique_lock<std::mutex> lock(m_device_write_mutex);
+	while (!m_device_write_stop)
+	{
+		m_device_write_cond.wait_for(lock, std::chrono::milliseconds(m_device_write_interval), [this] { return m_device_write_stop || (m_device_write_pending >= (size_t)m_device_write_max_rows); });
+		if (m_device_write_pending == 0)
+			continue;
+		lock.unlock();
+		FlushDeviceWrites();
+		lock.lock();
+	}
+	lock.unlock();
+	//Make sure nothing is left behind
+	FlushDeviceWrites();
+	_log.Log(LOG_STATUS, "SQLHelper: Device writer thread stopped...");
+}
+
+void CSQLHelper::GetDeviceWriteStats(int& IntervalMs, int& MaxRows, uint64_t& commits, uint64_t& rows, size_t& pending)
+{
+	std::lock_guard<std::mutex> l(m_device_write_mutex);
+	IntervalMs = m_device_write_interval;
+	MaxRows = m_device_write_max_rows;
+	commits = m_device_write_commits;
+	rows = m_device_write_rows;
+	pending = m_device_write_pending;
+}
+
+uint64_t CSQLHelper::UpdateValueInt(
+        const int HardwareID, const char *ID, const unsigned char unit, const unsigned char devType, const unsigned char subType,
+        const unsigned char signallevel, const unsigned char batterylevel, const int nValue, const char *sValue, std::string &devname,
+        const bool bUseOnOffAction,
+		const char* User
+)
+{
+	if (!m_dbase)
+		return -1;
+
+	uint64_t ulID = 0;
+	bool bDeviceUsed = false;
+	bool bSameDeviceStatusValue = false;
+	int nValueBeforeUpdate = -1;
+	std::string sValueBeforeUpdate;
+	_eSwitchType stype = STYPE_OnOff;
+
+	std::vector<std::vector<std::string> > result;
+	_tDeviceStatusCacheItem dItem;
+	if (!GetDeviceStatusCacheItem(HardwareID, ID, unit, devType, subType, dItem))
+	{
+		//Insert
+		ulID = InsertDevice(HardwareID, ID, unit, devType, subType, 0, nValue, sValue, devname, signallevel, batterylevel);
+
+		if (ulID == (uint64_t)-1)
+		{
+			return -1;
+		}
+
+#ifdef ENABLE_PYTHON
+		//TODO: Plugins should perhaps be blocked from implicitly adding a device by update? It's most likely a bug due to updating a removed device..
+		CDomoticzHardwareBase* pHardware = m_mainworker.GetHardware(HardwareID);
+		if (pHardware != nullptr && pHardware->HwdType == HTYPE_PythonPlugin)
+		{
+			_log.Debug(DEBUG_NORM, "CSQLHelper::UpdateValueInt: Notifying plugin %u about creation of device %u", HardwareID, unit);
+			Plugins::CPlugin* pPlugin = (Plugins::CPlugin*)pHardware;
+			pPlugin->DeviceAdded(ID, unit);
+		}
+#endif
+	}
+	else
+	{
+		//Update
+		ulID = dItem.ID;
+		auto &options = dItem.Options;
+		devname = dItem.Name;
+		bDeviceUsed = dItem.bUsed;
+		stype = dItem.SwitchType;
+		nValueBeforeUpdate = dItem.nValue;
+		sValueBeforeUpdate = dItem.sValue;
+
+		std::string sLastUpdate = TimeToString(nullptr, TF_DateTime);
+
+		//Commit: If Option 1: energy is computed as usage*time
+		//Default is option 0, read from device
+		if (options["EnergyMeterMode"] == "1" && devType == pTypeGeneral && subType == sTypeKwh)
+		{
+            double intervalSeconds;
+            struct tm ntime;
+			std::string sLastUpdate = dItem.LastUpdate;
+
+			time_t now = time(nullptr);
+			struct tm ltime;
+			localtime_r(&now, &ltime);
+
+			time_t lutime;
+			ParseSQLdatetime(lutime, ntime, sLastUpdate, ltime.tm_isdst);
+			intervalSeconds = difftime(now, lutime);
+
+            std::vector<std::string> powerAndEnergyBeforeUpdate;
+			StringSplit(sValueBeforeUpdate, ";", powerAndEnergyBeforeUpdate);
+			if (powerAndEnergyBeforeUpdate.size() == 2)
+			{
+				//we need to use atof here because some users seem to have a illegal sValue in the database that causes std::stof to crash
+				double powerDuringInterval = atof(powerAndEnergyBeforeUpdate[0].c_str());
+				double energyUpToInterval = atof(powerAndEnergyBeforeUpdate[1].c_str());
+				double energyDuringInterval = powerDuringInterval * intervalSeconds / 3600;
+				double energyAfterInterval = energyUpToInterval + energyDuringInterval;
+				std::vector<std::string> powerAndEnergyUpdate;
+				StringSplit(sValue, ";", powerAndEnergyUpdate);
+				if (!powerAndEnergyUpdate.empty())
+				{
+					const char* powerUpdate = powerAndEnergyUpdate[0].c_str();
+                    char sValueUpdate[100];
+                    sprintf(sValueUpdate, "%s;%.4f", powerUpdate, energyAfterInterval);
+					sValue = sValueUpdate;
+				}
+				else
+				{
+                    sValue = sValueBeforeUpdate.c_str();
+				}
+			}
+			else
+            {
+                sValue = sValueBeforeUpdate.c_str();
+            }
+		}
+		//~ use different update queries based on the device type
+		if (devType == pTypeGeneral && subType == sTypeCounterIncremental)
+		{
+			result = safe_query(
+				"UPDATE DeviceStatus SET SignalLevel=%d, BatteryLevel=%d, nValue= nValue + %d, sValue= sValue + '%q', LastUpdate='%q' "
+				"WHERE (ID = %" PRIu64 ")",
+				signallevel, batterylevel,
+				nValue, sValue,
+				sLastUpdate.c_str(),
+				ulID);
+		}
+		else
+		{
+			if (
+				(stype == STYPE_DoorContact) ||
+				(stype == STYPE_DoorLock) ||
+				(stype == STYPE_DoorLockInverted) ||
+				(stype == STYPE_Contact)
+				)
+			{
+				//Check if we received the same state as before, if yes, don't do anything (only update)
+				//This is specially handy for devices that send a keep-alive status every xx minutes
+				//like professional alarm system equipment
+				//.. we should make this an option of course
+				bSameDeviceStatusValue = (
+					(nValue == nValueBeforeUpdate) &&
+					(sValue == sValueBeforeUpdate)
+					);
+			}
+
+			if ((devType == pTypeGeneral && subType == sTypeManagedCounter) || (options["AddDBLogEntry"] == "true"))
+			{
+				std::vector<std::string> parts, parts2;
+				StringSplit(sValue, ";", parts);
+				if (parts.size() == 11)
+				{
+					// is last part date only, or date with hour with space?
+					StringSplit(parts[10], " ", parts2);
+					bool shortLog = false;
+					if (parts2.size() > 1) {
+						shortLog = true;
+					}
+					// second part is date only, or date with hour with space
+					// In DeviceStatus table, index 0 = Usage 1,  1 = Usage 2, 2 = Delivery 1,  3 = Delivery 2, 4 = Usage current, 5 = Delivery current
+					// In MultiMeter table, index 0 = Usage 1, 1 = Delivery 1, 2 = Usage current, 3 = Delivery current, 4 = Usage 2, 5 = Delivery 2
+					// In MultiMeter_Calendar table, same as Multimeter table + counter1, counter2, counter3 and counter4 when shortlog is False
+					UpdateCalendarMeter(HardwareID, ID, unit, devType, subType,
+						shortLog,
+						true,
+						parts[10].c_str(),
+						std::stoll(parts[0]),
+						std::stoll(parts[2]),
+						std::stoll(parts[4]),
+						std::stoll(parts[5]),
+						std::stoll(parts[1]),
+						std::stoll(parts[3]),
+						std::stoll(parts[6]),
+						std::stoll(parts[7]),
+						std::stoll(parts[8]),
+						std::stoll(parts[9])
+					);
+					result = safe_query("UPDATE DeviceStatus SET LastUpdate='%q' WHERE (ID = %" PRIu64 ")", sLastUpdate.c_str(), ulID);
+					return ulID;
+				}
 				if (parts.size() == 7)
 				{
 					// is last part date only, or date with hour with space?
@@ -5293,13 +6003,19 @@ uint64_t CSQLHelper::UpdateValueInt(
 				}
 			}
 
-			result = safe_query(
-				"UPDATE DeviceStatus SET SignalLevel=%d, BatteryLevel=%d, nValue=%d, sValue='%q', LastUpdate='%q' "
-				"WHERE (ID = %" PRIu64 ")",
-				signallevel, batterylevel,
-				nValue, sValue,
-				sLastUpdate.c_str(),
-				ulID);
+			//Write-through, the cache is updated first so a concurrent update by someone else always invalidates it
+			SetDeviceStatusCacheValue(ulID, nValue, sValue, sLastUpdate);
+			if (!QueueDeviceUpdate(ulID, signallevel, batterylevel, nValue, sValue, sLastUpdate))
+			{
+				_tDeviceCacheOwnWrite ownWrite(ulID);
+				result = bind_query(
+					"UPDATE DeviceStatus SET SignalLevel=?, BatteryLevel=?, nValue=?, sValue=?, LastUpdate=? "
+					"WHERE (ID = ?)",
+					signallevel, batterylevel,
+					nValue, sValue,
+					sLastUpdate,
+					ulID);
+			}
 		}
 	}
 
@@ -5358,20 +6074,23 @@ uint64_t CSQLHelper::UpdateValueInt(
 			|| (devType == pTypeSecurity1)
 			)
 		{
-			result = safe_query(
-				"INSERT INTO LightingLog (DeviceRowID, nValue, sValue, User) "
-				"VALUES ('%" PRIu64 "', '%d', '%q', '%q')",
-				ulID,
-				nValue, sValue,
-				(User != nullptr) ? User : ""
-			);
+			if (!QueueLightingLog(ulID, nValue, sValue, (User != nullptr) ? User : ""))
+			{
+				result = bind_query(
+					"INSERT INTO LightingLog (DeviceRowID, nValue, sValue, User) "
+					"VALUES (?, ?, ?, ?)",
+					ulID,
+					nValue, sValue,
+					(User != nullptr) ? User : ""
+				);
+			}
 		}
 		if (!bDeviceUsed)
 			return ulID;	//don't process further as the device is not used
 		std::string lstatus;
 
-		result = safe_query(
-			"SELECT Name,SwitchType,AddjValue,StrParam1,StrParam2,Options,LastLevel FROM DeviceStatus WHERE (ID = %" PRIu64 ")",
+		result = bind_query(
+			"SELECT Name,SwitchType,AddjValue,StrParam1,StrParam2,Options,LastLevel FROM DeviceStatus WHERE (ID = ?)",
 			ulID);
 		if (!result.empty())
 		{
@@ -5403,9 +6122,10 @@ uint64_t CSQLHelper::UpdateValueInt(
 				|| (bIsBlindsPercentage)
 				)
 			{
-				//update level for device
-				safe_query(
-					"UPDATE DeviceStatus SET LastLevel='%d' WHERE (ID = %" PRIu64 ")",
+				//update level for device (LastLevel is not cached)
+				_tDeviceCacheOwnWrite ownWrite(ulID);
+				bind_query(
+					"UPDATE DeviceStatus SET LastLevel=? WHERE (ID = ?)",
 					llevel,
 					ulID);
 
@@ -5652,8 +6372,8 @@ void CSQLHelper::GetAddjustment(const int HardwareID, const char* ID, const unsi
 	AddjValue = 0.0F;
 	AddjMulti = 1.0F;
 	std::vector<std::vector<std::string> > result;
-	result = safe_query(
-		"SELECT AddjValue,AddjMulti FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)",
+	result = bind_query(
+		"SELECT AddjValue,AddjMulti FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)",
 		HardwareID, ID, unit, devType, subType);
 	if (!result.empty())
 	{
@@ -5666,8 +6386,8 @@ void CSQLHelper::GetMeterType(const int HardwareID, const char* ID, const unsign
 {
 	meterType = 0;
 	std::vector<std::vector<std::string> > result;
-	result = safe_query(
-		"SELECT SwitchType FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)",
+	result = bind_query(
+		"SELECT SwitchType FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)",
 		HardwareID, ID, unit, devType, subType);
 	if (!result.empty())
 	{
@@ -5680,8 +6400,8 @@ void CSQLHelper::GetAddjustment2(const int HardwareID, const char* ID, const uns
 	AddjValue = 0.0F;
 	AddjMulti = 1.0F;
 	std::vector<std::vector<std::string> > result;
-	result = safe_query(
-		"SELECT AddjValue2,AddjMulti2 FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)",
+	result = bind_query(
+		"SELECT AddjValue2,AddjMulti2 FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)",
 		HardwareID, ID, unit, devType, subType);
 	if (!result.empty())
 	{
@@ -5710,35 +6430,130 @@ void CSQLHelper::UpdatePreferencesVar(const std::string& Key, const int nValue,
 	if (!m_dbase)
 		return;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ROWID FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
+	_tPreferencesCacheItem pItem;
+	if (GetPreferencesCacheItem(Key, pItem) && (pItem.nValue == nValue) && (pItem.sValue == sValue))
+		return; //nothing changed
+
 	{
-		//Insert
-		result = safe_query("INSERT INTO Preferences (Key, nValue, sValue) VALUES ('%q', %d,'%q')",
-			Key.c_str(), nValue, sValue.c_str());
+		_tPreferencesOwnWrite ownWrite;
+		std::vector<std::vector<std::string> > result;
+		result = bind_query("SELECT ROWID FROM Preferences WHERE (Key=?)", Key);
+		if (result.empty())
+		{
+			//Insert
+			result = bind_query("INSERT INTO Preferences (Key, nValue, sValue) VALUES (?, ?, ?)", Key, nValue, sValue);
+		}
+		else
+		{
+			//Update
+			result = bind_query("UPDATE Preferences SET Key=?, nValue=?, sValue=? WHERE (ROWID = ?)", Key, nValue, sValue, std::stoll(result[0][0]));
+		}
 	}
-	else
 	{
-		//Update
-		result = safe_query("UPDATE Preferences SET Key='%q', nValue=%d, sValue='%q' WHERE (ROWID = '%q')",
-			Key.c_str(), nValue, sValue.c_str(), result[0][0].c_str());
+		std::lock_guard<std::mutex> l(m_preferences_mutex);
+		m_preferences_generation++;
+		if (m_preferences_loaded)
+		{
+			_tPreferencesCacheItem& cItem = m_preferences[Key];
+			cItem.nValue = nValue;
+			cItem.sValue = sValue;
+		}
 	}
+	NotifyPreferencesChanged(Key);
 }
 
-bool CSQLHelper::GetPreferencesVar(const std::string& Key, std::string& sValue)
+//Preferences are read from the cache, the complete table is (re)loaded when needed
+bool CSQLHelper::GetPreferencesCacheItem(const std::string& Key, _tPreferencesCacheItem& pItem)
 {
 	if (!m_dbase)
 		return false;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT sValue FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> l(m_preferences_mutex);
+		if (m_preferences_loaded)
+		{
+			auto itt = m_preferences.find(Key);
+			if (itt == m_preferences.end())
+				return false;
+			pItem = itt->second;
+			return true;
+		}
+		generation = m_preferences_generation;
+	}
+
+	//The database lookup is done without holding the cache lock
+	std::map<std::string, _tPreferencesCacheItem> preferences;
+	auto result = safe_query("SELECT Key, nValue, sValue FROM Preferences");
+	for (const auto& sd : result)
+	{
+		_tPreferencesCacheItem& cItem = preferences[sd[0]];
+		cItem.nValue = atoi(sd[1].c_str());
+		cItem.sValue = sd[2];
+	}
+
+	bool bFound = false;
+	auto itt = preferences.find(Key);
+	if (itt != preferences.end())
+	{
+		pItem = itt->second;
+		bFound = true;
+	}
+
+	std::lock_guard<std::mutex> l(m_preferences_mutex);
+	if (generation == m_preferences_generation)
+	{
+		//Nothing changed in Preferences since our query, safe to store (an empty table is cached as well)
+		m_preferences = std::move(preferences);
+		m_preferences_loaded = true;
+	}
+	return bFound;
+}
+
+void CSQLHelper::ClearPreferencesCache()
+{
+	std::lock_guard<std::mutex> l(m_preferences_mutex);
+	m_preferences_generation++;
+	m_preferences_loaded = false;
+	m_preferences.clear();
+}
+
+int CSQLHelper::RegisterPreferencesCallback(const std::string& KeyPrefix, const PreferencesCallback& callback)
+{
+	std::lock_guard<std::mutex> l(m_preferences_callback_mutex);
+	int id = ++m_preferences_callback_id;
+	m_preferences_callbacks[id] = std::make_pair(KeyPrefix, callback);
+	return id;
+}
+
+void CSQLHelper::UnregisterPreferencesCallback(const int id)
+{
+	std::lock_guard<std::mutex> l(m_preferences_callback_mutex);
+	m_preferences_callbacks.erase(id);
+}
+
+void CSQLHelper::NotifyPreferencesChanged(const std::string& Key)
+{
+	std::vector<PreferencesCallback> callbacks;
+	{
+		std::lock_guard<std::mutex> l(m_preferences_callback_mutex);
+		for (const auto& itt : m_preferences_callbacks)
+		{
+			if (Key.compare(0, itt.second.first.size(), itt.second.first) == 0)
+				callbacks.push_back(itt.second.second);
+		}
+	}
+	//Called without holding any lock, callbacks are free to read preferences
+	for (const auto& callback : callbacks)
+		callback(Key);
+}
+
+bool CSQLHelper::GetPreferencesVar(const std::string& Key, std::string& sValue)
+{
+	_tPreferencesCacheItem pItem;
+	if (!GetPreferencesCacheItem(Key, pItem))
 		return false;
-	std::vector<std::string> sd = result[0];
-	sValue = sd[0];
+	sValue = pItem.sValue;
 	return true;
 }
 
@@ -5755,24 +6570,21 @@ bool CSQLHelper::GetPreferencesVar(const std::string& Key, double& Value)
 }
 bool CSQLHelper::GetPreferencesVar(const std::string& Key, int& nValue, std::string& sValue)
 {
-	if (!m_dbase)
+	_tPreferencesCacheItem pItem;
+	if (!GetPreferencesCacheItem(Key, pItem))
 		return false;
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT nValue, sValue FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
-		return false;
-	std::vector<std::string> sd = result[0];
-	nValue = atoi(sd[0].c_str());
-	sValue = sd[1];
+	nValue = pItem.nValue;
+	sValue = pItem.sValue;
 	return true;
 }
 
 bool CSQLHelper::GetPreferencesVar(const std::string& Key, int& nValue)
 {
-	std::string sValue;
-	return GetPreferencesVar(Key, nValue, sValue);
+	_tPreferencesCacheItem pItem;
+	if (!GetPreferencesCacheItem(Key, pItem))
+		return false;
+	nValue = pItem.nValue;
+	return true;
 }
 
 void CSQLHelper::DeletePreferencesVar(const std::string& Key)
@@ -5784,7 +6596,16 @@ void CSQLHelper::DeletePreferencesVar(const std::string& Key)
 	//if found, delete
 	if (GetPreferencesVar(Key, sValue) == true)
 	{
-		safe_query("DELETE FROM Preferences WHERE (Key='%q')", Key.c_str());
+		{
+			_tPreferencesOwnWrite ownWrite;
+			safe_query("DELETE FROM Preferences WHERE (Key='%q')", Key.c_str());
+		}
+		{
+			std::lock_guard<std::mutex> l(m_preferences_mutex);
+			m_preferences_generation++;
+			m_preferences.erase(Key);
+		}
+		NotifyPreferencesChanged(Key);
 	}
 }
 
@@ -5903,14 +6724,7 @@ void CSQLHelper::ScheduleShortlog()
 		//Force WAL flush
 		sqlite3_wal_checkpoint(m_dbase, nullptr);
 
-		UpdateTemperatureLog();
-		UpdateRainLog();
-		UpdateWindLog();
-		UpdateUVLog();
-		UpdateMeter();
-		UpdateMultiMeter();
-		UpdatePercentageLog();
-		UpdateFanLog();
+		UpdateShortLog();
 		//Removing the line below could cause a very large database,
 		//and slow(large) data transfer (specially when working remote!!)
 		CleanupShortLog();
@@ -5937,14 +6751,65 @@ void CSQLHelper::ScheduleDay()
 		//Force WAL flush
 		sqlite3_wal_checkpoint(m_dbase, nullptr);
 
-		AddCalendarTemperature();
-		AddCalendarUpdateRain();
-		AddCalendarUpdateUV();
-		AddCalendarUpdateWind();
-		AddCalendarUpdateMeter();
-		AddCalendarUpdateMultiMeter();
-		AddCalendarUpdatePercentage();
-		AddCalendarUpdateFan();
+		char szDateStart[40];
+		char szDateEnd[40];
+
+		time_t now = mytime(nullptr);
+		struct tm ltime;
+		localtime_r(&now, &ltime);
+		sprintf(szDateEnd, "%04d-%02d-%02d 00:00:00", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+
+		time_t yesterday;
+		struct tm tm2;
+		getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
+		sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
+
+		std::vector<_tCalendarNotification> notifications;
+		std::vector<uint64_t> influxdevices;
+		std::string szTimings;
+
+		auto tStart = std::chrono::steady_clock::now();
+		//Every table is rolled up in its own transaction, other database users only wait for one pass
+		auto RunRollup = [&](const char* szTable, const std::function<int()>& rollup) {
+			auto tTableStart = std::chrono::steady_clock::now();
+			int nRows = 0;
+			{
+				std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+				FlushDeviceWritesInt();
+				sqlite3_exec(m_dbase, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+				try
+				{
+					nRows = rollup();
+				}
+				catch (...)
+				{
+					if (sqlite3_get_autocommit(m_dbase) == 0)
+						sqlite3_exec(m_dbase, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
+					throw;
+				}
+				if (sqlite3_get_autocommit(m_dbase) == 0)
+					sqlite3_exec(m_dbase, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+			}
+			int64_t tElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tTableStart).count();
+			if (!szTimings.empty())
+				szTimings += ", ";
+			szTimings += std_format("%s: %d rows/%d ms", szTable, nRows, (int)tElapsed);
+		};
+		RunRollup("Temperature", [&]() { return AddCalendarTemperature(szDateStart, szDateEnd); });
+		RunRollup("Rain", [&]() { return AddCalendarUpdateRain(szDateStart, szDateEnd); });
+		RunRollup("UV", [&]() { return AddCalendarUpdateUV(szDateStart, szDateEnd); });
+		RunRollup("Wind", [&]() { return AddCalendarUpdateWind(szDateStart, szDateEnd); });
+		RunRollup("Meter", [&]() { return AddCalendarUpdateMeter(szDateStart, szDateEnd, notifications, influxdevices); });
+		RunRollup("MultiMeter", [&]() { return AddCalendarUpdateMultiMeter(szDateStart, szDateEnd, notifications); });
+		RunRollup("Percentage", [&]() { return AddCalendarUpdatePercentage(szDateStart, szDateEnd); });
+		RunRollup("Fan", [&]() { return AddCalendarUpdateFan(szDateStart, szDateEnd); });
+		int64_t tElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tStart).count();
+		_log.Log(LOG_STATUS, "SQLHelper: Daily calendar rollup done in %d ms (%s)", (int)tElapsed, szTimings.c_str());
+
+		HandleCalendarNotifications(notifications);
+		for (const auto& itt : influxdevices)
+			m_influxpush.DoInfluxPush(itt, true);
+
 		CleanupLightSceneLog();
 	}
 	catch (boost::exception& e)
@@ -5959,7 +6824,8 @@ void CSQLHelper::ScheduleDay()
 	}
 }
 
-void CSQLHelper::UpdateTemperatureLog()
+//Scan the device states once and hand every device to the samplers of the log tables it belongs to
+void CSQLHelper::UpdateShortLog()
 {
 	time_t now = mytime(nullptr);
 	if (now == 0)
@@ -5970,369 +6836,350 @@ void CSQLHelper::UpdateTemperatureLog()
 	int SensorTimeOut = 60;
 	GetPreferencesVar("SensorTimeout", SensorTimeOut);
 
+	static const std::string szTypes = std_format("%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+		pTypeTEMP, pTypeHUM, pTypeTEMP_HUM, pTypeTEMP_HUM_BARO, pTypeTEMP_BARO, pTypeUV, pTypeWIND, pTypeThermostat1, pTypeRFXSensor,
+		pTypeRego6XXTemp, pTypeEvohomeZone, pTypeEvohomeWater, pTypeRadiator1, pTypeGeneral, pTypeThermostat, pTypeRAIN,
+		pTypeRFXMeter, pTypeP1Gas, pTypeYouLess, pTypeENERGY, pTypePOWER, pTypeAirQuality, pTypeUsage, pTypeLux, pTypeWEIGHT,
+		pTypeRego6XXValue, pTypeP1Power);
+	static const std::string szQuery = "SELECT ID,Name,HardwareID,DeviceID,Unit,Type,SubType,nValue,sValue,LastUpdate,Options FROM DeviceStatus WHERE (Type IN (" + szTypes + std_format(",%d,%d))", pTypeCURRENT, pTypeCURRENTENERGY);
+
 	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d))",
-		pTypeTEMP,
-		pTypeHUM,
-		pTypeTEMP_HUM,
-		pTypeTEMP_HUM_BARO,
-		pTypeTEMP_BARO,
-		pTypeUV,
-		pTypeWIND,
-		pTypeThermostat1,
-		pTypeRFXSensor,
-		pTypeRego6XXTemp,
-		pTypeEvohomeZone,
-		pTypeEvohomeWater,
-		pTypeRadiator1,
-		pTypeGeneral, sTypeSystemTemp,
-		pTypeThermostat, sTypeThermSetpoint,
-		pTypeGeneral, sTypeBaro
-	);
-	if (!result.empty())
+	result = bind_query(szQuery.c_str());
+
+	_tShortLogSamples samples;
+	for (const auto &sd : result)
 	{
-		for (const auto &sd : result)
+		_tShortLogDevice dev;
+		dev.ID = std::stoull(sd[0]);
+		dev.Name = sd[1];
+		dev.HardwareID = atoi(sd[2].c_str());
+		dev.DeviceID = sd[3];
+		dev.Unit = atoi(sd[4].c_str());
+		dev.devType = atoi(sd[5].c_str());
+		dev.subType = atoi(sd[6].c_str());
+		dev.nValue = atoi(sd[7].c_str());
+		dev.sValue = sd[8];
+		dev.Options = sd[10];
+
+		struct tm ntime;
+		time_t checktime;
+		ParseSQLdatetime(checktime, ntime, sd[9], tm1.tm_isdst);
+		dev.age = difftime(now, checktime);
+
+		UpdateTemperatureLog(dev, SensorTimeOut, samples.Temperature);
+		UpdateRainLog(dev, SensorTimeOut, samples.Rain);
+		UpdateWindLog(dev, SensorTimeOut, samples.Wind);
+		UpdateUVLog(dev, SensorTimeOut, samples.UV);
+		UpdateMeter(dev, SensorTimeOut, samples.Meter);
+		UpdateMultiMeter(dev, SensorTimeOut, samples.MultiMeter);
+		UpdatePercentageLog(dev, SensorTimeOut, samples.Percentage);
+		UpdateFanLog(dev, SensorTimeOut, samples.Fan);
+	}
+
+	//write all samples of this interval in one transaction
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	FlushDeviceWritesInt();
+	sqlite3_exec(m_dbase, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+	InsertShortLogSamples("Temperature", "DeviceRowID, Temperature, Chill, Humidity, Barometer, DewPoint, SetPoint", 7, samples.Temperature);
+	InsertShortLogSamples("Rain", "DeviceRowID, Total, Rate", 3, samples.Rain);
+	InsertShortLogSamples("Wind", "DeviceRowID, Direction, Speed, Gust", 4, samples.Wind);
+	InsertShortLogSamples("UV", "DeviceRowID, Level", 2, samples.UV);
+	InsertShortLogSamples("Meter", "DeviceRowID, Value, [Usage]", 3, samples.Meter);
+	InsertShortLogSamples("MultiMeter", "DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6", 7, samples.MultiMeter);
+	InsertShortLogSamples("Percentage", "DeviceRowID, Percentage", 2, samples.Percentage);
+	InsertShortLogSamples("Fan", "DeviceRowID, Speed", 2, samples.Fan);
+	sqlite3_exec(m_dbase, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+}
+
+//m_sqlQueryMutex has to be locked by the caller
+void CSQLHelper::InsertShortLogSamples(const char *szTable, const char *szColumns, const size_t nColumns, const std::vector<_tSQLParam> &samples)
+{
+	size_t nRows = samples.size() / nColumns;
+	if (nRows == 0)
+		return;
+
+	std::string szRow = "(?";
+	for (size_t ii = 1; ii < nColumns; ii++)
+		szRow += ",?";
+	szRow += ")";
+
+	size_t iRow = 0;
+	while (iRow < nRows)
+	{
+		size_t nChunk = std::min<size_t>(nRows - iRow, SQL_SHORTLOG_INSERT_ROWS);
+		std::string szQuery = std_format("INSERT INTO %s (%s) VALUES ", szTable, szColumns);
+		for (size_t ii = 0; ii < nChunk; ii++)
+		{
+			if (ii != 0)
+				szQuery += ",";
+			szQuery += szRow;
+		}
+		//the remainder chunk differs every run, so these are not kept in the statement cache
+		sqlite3_stmt *statement = nullptr;
+		if (sqlite3_prepare_v2(m_dbase, szQuery.c_str(), -1, &statement, nullptr) != SQLITE_OK)
 		{
-			uint64_t ID = std::stoull(sd[0]);
-			unsigned char dType = atoi(sd[1].c_str());
-			unsigned char dSubType = atoi(sd[2].c_str());
-			int nValue = atoi(sd[3].c_str());
-			std::string sValue = sd[4];
+			_log.Log(LOG_ERROR, "SQL Prepare(\"%s\") : %s", szTable, sqlite3_errmsg(m_dbase));
+			return;
+		}
+		BindSQLParams(statement, &samples[iRow * nColumns], nChunk * nColumns);
+		if (sqlite3_step(statement) != SQLITE_DONE)
+			_log.Log(LOG_ERROR, "SQLHelper: Error adding %s samples (%s)", szTable, sqlite3_errmsg(m_dbase));
+		sqlite3_finalize(statement);
+		iRow += nChunk;
+	}
+	_log.Debug(DEBUG_SQL, "SQLHelper: Added %d %s samples", (int)nRows, szTable);
+}
 
-			if (dType != pTypeRadiator1)
-			{
-				//do not include sensors that have no reading within an hour (except for devices that do not provide feedback, like the smartware radiator)
-				std::string sLastUpdate = sd[5];
-				struct tm ntime;
-				time_t checktime;
-				ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
+//do not include sensors that have no reading within the sensor timeout
+bool CSQLHelper::IsShortLogSensorActive(const _tShortLogDevice &dev, const int SensorTimeOut)
+{
+	if (dev.age >= SensorTimeOut * 60)
+		return false;
+	if (m_bShortLogAddOnlyNewValues)
+	{
+		if (dev.age > m_ShortLogInterval * 60)
+			return false;
+	}
+	return true;
+}
 
-				if (difftime(now, checktime) >= SensorTimeOut * 60)
-					continue;
-				if (m_bShortLogAddOnlyNewValues)
-				{
-					if (difftime(now, checktime) > m_ShortLogInterval * 60)
-						continue;
-				}
-			}
+void CSQLHelper::UpdateTemperatureLog(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
+{
+	unsigned char dType = dev.devType;
+	unsigned char dSubType = dev.subType;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
+	switch (dType)
+	{
+	case pTypeTEMP:
+	case pTypeHUM:
+	case pTypeTEMP_HUM:
+	case pTypeTEMP_HUM_BARO:
+	case pTypeTEMP_BARO:
+	case pTypeUV:
+	case pTypeWIND:
+	case pTypeThermostat1:
+	case pTypeRFXSensor:
+	case pTypeRego6XXTemp:
+	case pTypeEvohomeZone:
+	case pTypeEvohomeWater:
+	case pTypeRadiator1:
+		break;
+	case pTypeGeneral:
+		if ((dSubType != sTypeSystemTemp) && (dSubType != sTypeBaro))
+			return;
+		break;
+	case pTypeThermostat:
+		if (dSubType != sTypeThermSetpoint)
+			return;
+		break;
+	default:
+		return;
+	}
+
+	//do not include sensors that have no reading within an hour (except for devices that do not provide feedback, like the smartware radiator)
+	if ((dType != pTypeRadiator1) && (!IsShortLogSensorActive(dev, SensorTimeOut)))
+		return;
+
+	int nValue = dev.nValue;
+	std::vector<std::string> splitresults;
+	StringSplit(dev.sValue, ";", splitresults);
+	if (splitresults.empty())
+		return; //impossible
 
-			float temp = 0;
-			float chill = 0;
-			unsigned char humidity = 0;
-			int barometer = 0;
-			float dewpoint = 0;
-			float setpoint = 0;
+	float temp = 0;
+	float chill = 0;
+	unsigned char humidity = 0;
+	int barometer = 0;
+	float dewpoint = 0;
+	float setpoint = 0;
 
-			switch (dType)
+	switch (dType)
+	{
+	case pTypeRego6XXTemp:
+	case pTypeTEMP:
+	case pTypeThermostat:
+		temp = static_cast<float>(atof(splitresults[0].c_str()));
+		break;
+	case pTypeThermostat1:
+		temp = static_cast<float>(atof(splitresults[0].c_str()));
+		break;
+	case pTypeRadiator1:
+		temp = static_cast<float>(atof(splitresults[0].c_str()));
+		break;
+	case pTypeEvohomeWater:
+		if (splitresults.size() >= 2)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			if (splitresults[1] == "On")
+				setpoint = 60;
+			else if (splitresults[1] == "Off")
+				setpoint = 0;
+			else
+				setpoint = static_cast<float>(atof(splitresults[1].c_str()));
+		}
+		break;
+	case pTypeEvohomeZone:
+		if (splitresults.size() >= 2)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			setpoint = static_cast<float>(atof(splitresults[1].c_str()));
+		}
+		break;
+	case pTypeHUM:
+		humidity = nValue;
+		break;
+	case pTypeTEMP_HUM:
+		if (splitresults.size() >= 2)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			humidity = atoi(splitresults[1].c_str());
+			dewpoint = (float)CalculateDewPoint(temp, humidity);
+		}
+		break;
+	case pTypeTEMP_HUM_BARO:
+		if (splitresults.size() == 5)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			humidity = atoi(splitresults[1].c_str());
+			if (dSubType == sTypeTHBFloat)
+				barometer = int(atof(splitresults[3].c_str()) * 10.0F);
+			else
+				barometer = atoi(splitresults[3].c_str());
+			dewpoint = (float)CalculateDewPoint(temp, humidity);
+		}
+		break;
+	case pTypeTEMP_BARO:
+		if (splitresults.size() >= 2)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			barometer = int(atof(splitresults[1].c_str()) * 10.0F);
+		}
+		break;
+	case pTypeUV:
+		if (dSubType != sTypeUV3)
+			return;
+		if (splitresults.size() >= 2)
+		{
+			temp = static_cast<float>(atof(splitresults[1].c_str()));
+		}
+		break;
+	case pTypeWIND:
+		if (dSubType == sTypeWINDNoTempNoChill)
+			return;
+		if (splitresults.size() >= 6)
+		{
+			if (dSubType != sTypeWINDNoTemp)
 			{
-			case pTypeRego6XXTemp:
-			case pTypeTEMP:
-			case pTypeThermostat:
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeThermostat1:
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeRadiator1:
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeEvohomeWater:
-				if (splitresults.size() >= 2)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					if (splitresults[1] == "On")
-						setpoint = 60;
-					else if (splitresults[1] == "Off")
-						setpoint = 0;
-					else
-						setpoint = static_cast<float>(atof(splitresults[1].c_str()));
-				}
-				break;
-			case pTypeEvohomeZone:
-				if (splitresults.size() >= 2)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					setpoint = static_cast<float>(atof(splitresults[1].c_str()));
-				}
-				break;
-			case pTypeHUM:
-				humidity = nValue;
-				break;
-			case pTypeTEMP_HUM:
-				if (splitresults.size() >= 2)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					humidity = atoi(splitresults[1].c_str());
-					dewpoint = (float)CalculateDewPoint(temp, humidity);
-				}
-				break;
-			case pTypeTEMP_HUM_BARO:
-				if (splitresults.size() == 5)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					humidity = atoi(splitresults[1].c_str());
-					if (dSubType == sTypeTHBFloat)
-						barometer = int(atof(splitresults[3].c_str()) * 10.0F);
-					else
-						barometer = atoi(splitresults[3].c_str());
-					dewpoint = (float)CalculateDewPoint(temp, humidity);
-				}
-				break;
-			case pTypeTEMP_BARO:
-				if (splitresults.size() >= 2)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					barometer = int(atof(splitresults[1].c_str()) * 10.0F);
-				}
-				break;
-			case pTypeUV:
-				if (dSubType != sTypeUV3)
-					continue;
-				if (splitresults.size() >= 2)
-				{
-					temp = static_cast<float>(atof(splitresults[1].c_str()));
-				}
-				break;
-			case pTypeWIND:
-				if (dSubType == sTypeWINDNoTempNoChill)
-					continue;
-				if (splitresults.size() >= 6)
-				{
-					if (dSubType != sTypeWINDNoTemp)
-					{
-						temp = static_cast<float>(atof(splitresults[4].c_str()));
-					}
-					chill = static_cast<float>(atof(splitresults[5].c_str()));
-				}
-				break;
-			case pTypeRFXSensor:
-				if (dSubType != sTypeRFXSensorTemp)
-					continue;
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeGeneral:
-				if (dSubType == sTypeSystemTemp)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-				}
-				else if (dSubType == sTypeBaro)
-				{
-					if (splitresults.size() != 2)
-						continue;
-					barometer = int(atof(splitresults[0].c_str()) * 10.0F);
-				}
-				break;
+				temp = static_cast<float>(atof(splitresults[4].c_str()));
 			}
-			//insert record
-			safe_query(
-				"INSERT INTO Temperature (DeviceRowID, Temperature, Chill, Humidity, Barometer, DewPoint, SetPoint) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%.2f', '%d', '%d', '%.2f', '%.2f')",
-				ID,
-				temp,
-				chill,
-				humidity,
-				barometer,
-				dewpoint,
-				setpoint
-			);
+			chill = static_cast<float>(atof(splitresults[5].c_str()));
+		}
+		break;
+	case pTypeRFXSensor:
+		if (dSubType != sTypeRFXSensorTemp)
+			return;
+		temp = static_cast<float>(atof(splitresults[0].c_str()));
+		break;
+	case pTypeGeneral:
+		if (dSubType == sTypeSystemTemp)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
 		}
+		else if (dSubType == sTypeBaro)
+		{
+			if (splitresults.size() != 2)
+				return;
+			barometer = int(atof(splitresults[0].c_str()) * 10.0F);
+		}
+		break;
 	}
+	samples.insert(samples.end(), {
+		dev.ID,
+		round_digits(temp, 2),
+		round_digits(chill, 2),
+		humidity,
+		barometer,
+		round_digits(dewpoint, 2),
+		round_digits(setpoint, 2)
+		});
 }
 
-void CSQLHelper::UpdateRainLog()
+void CSQLHelper::UpdateRainLog(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
 {
-	time_t now = mytime(nullptr);
-	if (now == 0)
+	if (dev.devType != pTypeRAIN)
 		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d)", pTypeRAIN);
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			uint64_t ID = std::stoull(sd[0]);
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue = sd[4];
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate = sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now, checktime) >= SensorTimeOut * 60)
-				continue;
-			if (m_bShortLogAddOnlyNewValues)
-			{
-				if (difftime(now, checktime) > m_ShortLogInterval * 60)
-					continue;
-			}
+	//do not include sensors that have no reading within an hour
+	if (!IsShortLogSensorActive(dev, SensorTimeOut))
+		return;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size() < 2)
-				continue; //impossible
+	std::vector<std::string> splitresults;
+	StringSplit(dev.sValue, ";", splitresults);
+	if (splitresults.size() < 2)
+		return; //impossible
 
-			int rate = atoi(splitresults[0].c_str());
-			float total = static_cast<float>(atof(splitresults[1].c_str()));
+	int rate = atoi(splitresults[0].c_str());
+	float total = static_cast<float>(atof(splitresults[1].c_str()));
 
-			//insert record
-			safe_query(
-				"INSERT INTO Rain (DeviceRowID, Total, Rate) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%d')",
-				ID,
-				total,
-				rate
-			);
-		}
-	}
+	samples.insert(samples.end(), { dev.ID, round_digits(total, 2), rate });
 }
 
-void CSQLHelper::UpdateWindLog()
+void CSQLHelper::UpdateWindLog(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
 {
-	time_t now = mytime(nullptr);
-	if (now == 0)
+	if (dev.devType != pTypeWIND)
 		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,DeviceID, Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d)", pTypeWIND);
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			uint64_t ID = std::stoull(sd[0]);
-
-			unsigned short DeviceID;
-			std::stringstream s_str2(sd[1]);
-			s_str2 >> DeviceID;
 
-			//unsigned char dType=atoi(sd[2].c_str());
-			//unsigned char dSubType=atoi(sd[3].c_str());
-			//int nValue=atoi(sd[4].c_str());
-			std::string sValue = sd[5];
+	unsigned short DeviceID;
+	std::stringstream s_str2(dev.DeviceID);
+	s_str2 >> DeviceID;
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate = sd[6];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now, checktime) >= SensorTimeOut * 60)
-				continue;
-			if (m_bShortLogAddOnlyNewValues)
-			{
-				if (difftime(now, checktime) > m_ShortLogInterval * 60)
-					continue;
-			}
-
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size() < 4)
-				continue; //impossible
+	//do not include sensors that have no reading within an hour
+	if (!IsShortLogSensorActive(dev, SensorTimeOut))
+		return;
 
-			float direction = static_cast<float>(atof(splitresults[0].c_str()));
+	std::vector<std::string> splitresults;
+	StringSplit(dev.sValue, ";", splitresults);
+	if (splitresults.size() < 4)
+		return; //impossible
 
-			int speed = atoi(splitresults[2].c_str());
-			int gust = atoi(splitresults[3].c_str());
+	float direction = static_cast<float>(atof(splitresults[0].c_str()));
 
-			auto ittWC = m_mainworker.m_wind_calculator.find(DeviceID);
-			if (ittWC != m_mainworker.m_wind_calculator.end())
-			{
-				int speed_max, gust_max, speed_min, gust_min;
-				ittWC->second.GetMMSpeedGust(speed_min, speed_max, gust_min, gust_max);
-				if (speed_max != -1)
-					speed = speed_max;
-				if (gust_max != -1)
-					gust = gust_max;
-			}
+	int speed = atoi(splitresults[2].c_str());
+	int gust = atoi(splitresults[3].c_str());
 
-			//insert record
-			safe_query(
-				"INSERT INTO Wind (DeviceRowID, Direction, Speed, Gust) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%d', '%d')",
-				ID,
-				direction,
-				speed,
-				gust
-			);
-		}
+	std::unique_lock<std::mutex> calculatorLock(m_mainworker.m_calculatorMutex);
+	auto ittWC = m_mainworker.m_wind_calculator.find(DeviceID);
+	if (ittWC != m_mainworker.m_wind_calculator.end())
+	{
+		int speed_max, gust_max, speed_min, gust_min;
+		ittWC->second.GetMMSpeedGust(speed_min, speed_max, gust_min, gust_max);
+		if (speed_max != -1)
+			speed = speed_max;
+		if (gust_max != -1)
+			gust = gust_max;
 	}
+	calculatorLock.unlock();
+
+	samples.insert(samples.end(), { dev.ID, round_digits(direction, 2), speed, gust });
 }
 
-void CSQLHelper::UpdateUVLog()
+void CSQLHelper::UpdateUVLog(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
 {
-	time_t now = mytime(nullptr);
-	if (now == 0)
+	if ((dev.devType != pTypeUV) && (!((dev.devType == pTypeGeneral) && (dev.subType == sTypeUV))))
 		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d) OR (Type=%d AND SubType=%d)",
-		pTypeUV,
-		pTypeGeneral, sTypeUV
-	);
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			uint64_t ID = std::stoull(sd[0]);
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue = sd[4];
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate = sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now, checktime) >= SensorTimeOut * 60)
-				continue;
-			if (m_bShortLogAddOnlyNewValues)
-			{
-				if (difftime(now, checktime) > m_ShortLogInterval * 60)
-					continue;
-			}
+	//do not include sensors that have no reading within an hour
+	if (!IsShortLogSensorActive(dev, SensorTimeOut))
+		return;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
+	std::vector<std::string> splitresults;
+	StringSplit(dev.sValue, ";", splitresults);
+	if (splitresults.empty())
+		return; //impossible
 
-			float level = static_cast<float>(atof(splitresults[0].c_str()));
+	double level = atof(splitresults[0].c_str());
 
-			//insert record
-			safe_query(
-				"INSERT INTO UV (DeviceRowID, Level) "
-				"VALUES ('%" PRIu64 "', '%g')",
-				ID,
-				level
-			);
-		}
-	}
+	samples.insert(samples.end(), { dev.ID, level });
 }
 
 bool CSQLHelper::UpdateCalendarMeter(
@@ -6462,802 +7309,447 @@ bool CSQLHelper::UpdateCalendarMeter(
 					(value5 < 0) ? 0 : value5,
 					(value6 < 0) ? 0 : value6,
 					(counter1 < 0) ? 0 : counter1,
-					(counter2 < 0) ? 0 : counter2,
-					(counter3 < 0) ? 0 : counter3,
-					(counter4 < 0) ? 0 : counter4,
-					date
-				);
-			}
-			else
-			{
-				safe_query(
-					"UPDATE MultiMeter_Calendar SET Value1='%" PRId64 "', Value2='%" PRId64 "', Value3='%" PRId64 "', Value4='%" PRId64 "', Value5='%" PRId64 "', Value6='%" PRId64 "' , Counter1='%" PRId64 "' , Counter2='%" PRId64 "' , Counter3='%" PRId64 "' , Counter4='%" PRId64 "' "
-					"WHERE ((DeviceRowID=='%" PRIu64 "') AND (Date=='%q'))",
-					(value1 < 0) ? 0 : value1,
-					(value2 < 0) ? 0 : value2,
-					(value3 < 0) ? 0 : value3,
-					(value4 < 0) ? 0 : value4,
-					(value5 < 0) ? 0 : value5,
-					(value6 < 0) ? 0 : value6,
-					(counter1 < 0) ? 0 : counter1,
-					(counter2 < 0) ? 0 : counter2,
-					(counter3 < 0) ? 0 : counter3,
-					(counter4 < 0) ? 0 : counter4,
-					DeviceRowID,
-					date
-				);
-			}
-		}
-		else {
-			result = safe_query(
-				"SELECT DeviceRowID FROM Meter_Calendar "
-				"WHERE (DeviceRowID=='%" PRIu64 "') AND (Date=='%q')",
-				DeviceRowID, date
-			);
-			if (result.empty())
-			{
-				safe_query(
-					"INSERT INTO Meter_Calendar (DeviceRowID, Counter, Value, Date) "
-					"VALUES ('%" PRIu64 "', '%" PRId64 "', '%" PRId64 "', '%q')",
-					DeviceRowID, (value1 < 0) ? 0 : value1, (value2 < 0) ? 0 : value2, date
-				);
-			}
-			else
-			{
-				safe_query(
-					"UPDATE Meter_Calendar SET DeviceRowID='%" PRIu64 "', Counter='%" PRId64 "', Value='%" PRId64 "', Date='%q' "
-					"WHERE (DeviceRowID=='%" PRIu64 "') AND (Date=='%q')",
-					DeviceRowID, (value1 < 0) ? 0 : value1, (value2 < 0) ? 0 : value2, date,
-					DeviceRowID, date
-				);
-			}
-		}
-	}
-	return true;
-}
-
-void CSQLHelper::UpdateMeter()
-{
-	time_t now = mytime(nullptr);
-	if (now == 0)
-		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	std::vector<std::vector<std::string> > result2;
-
-	result = safe_query(
-		"SELECT ID,Name,HardwareID,DeviceID,Unit,Type,SubType,nValue,sValue,LastUpdate,Options FROM DeviceStatus WHERE ("
-		"Type=%d OR " //pTypeRFXMeter
-		"Type=%d OR " //pTypeP1Gas
-		"Type=%d OR " //pTypeYouLess
-		"Type=%d OR " //pTypeENERGY
-		"Type=%d OR " //pTypePOWER
-		"Type=%d OR " //pTypeAirQuality
-		"Type=%d OR " //pTypeUsage
-		"Type=%d OR " //pTypeLux
-		"Type=%d OR " //pTypeWEIGHT
-		"(Type=%d AND SubType=%d) OR " //pTypeRego6XXValue,sTypeRego6XXCounter
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeVisibility
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeSolarRadiation
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeSoilMoisture
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeLeafWetness
-		"(Type=%d AND SubType=%d) OR " //pTypeRFXSensor,sTypeRFXSensorAD
-		"(Type=%d AND SubType=%d) OR" //pTypeRFXSensor,sTypeRFXSensorVolt
-		"(Type=%d AND SubType=%d) OR"  //pTypeGeneral,sTypeVoltage
-		"(Type=%d AND SubType=%d) OR"  //pTypeGeneral,sTypeCurrent
-		"(Type=%d AND SubType=%d) OR"  //pTypeGeneral,sTypeSoundLevel
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeDistance
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypePressure
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeCounterIncremental
-		"(Type=%d AND SubType=%d)"	 //pTypeGeneral,sTypeKwh
-		")",
-		pTypeRFXMeter,
-		pTypeP1Gas,
-		pTypeYouLess,
-		pTypeENERGY,
-		pTypePOWER,
-		pTypeAirQuality,
-		pTypeUsage,
-		pTypeLux,
-		pTypeWEIGHT,
-		pTypeRego6XXValue, sTypeRego6XXCounter,
-		pTypeGeneral, sTypeVisibility,
-		pTypeGeneral, sTypeSolarRadiation,
-		pTypeGeneral, sTypeSoilMoisture,
-		pTypeGeneral, sTypeLeafWetness,
-		pTypeRFXSensor, sTypeRFXSensorAD,
-		pTypeRFXSensor, sTypeRFXSensorVolt,
-		pTypeGeneral, sTypeVoltage,
-		pTypeGeneral, sTypeCurrent,
-		pTypeGeneral, sTypeSoundLevel,
-		pTypeGeneral, sTypeDistance,
-		pTypeGeneral, sTypePressure,
-		pTypeGeneral, sTypeCounterIncremental,
-		pTypeGeneral, sTypeKwh
-	);
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			char szTmp[200];
-
-			std::string sOptions = sd[10];
-			std::map<std::string, std::string> options = BuildDeviceOptions(sOptions);
-			// We don't want to update meter if externally managed
-			if (options["DisableLogAutoUpdate"] == "true")
-			{
-				continue;
-			}
-
-			uint64_t ID = std::stoull(sd[0]);
-			std::string devname = sd[1];
-			int hardwareID = atoi(sd[2].c_str());
-			std::string DeviceID = sd[3];
-			unsigned char Unit = atoi(sd[4].c_str());
-
-			unsigned char dType = atoi(sd[5].c_str());
-			unsigned char dSubType = atoi(sd[6].c_str());
-			int nValue = atoi(sd[7].c_str());
-			std::string sValue = sd[8];
-			std::string sLastUpdate = sd[9];
-
-			std::string sUsage = "0";
-
-			//do not include sensors that have no reading within an hour
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			//Check for timeout, if timeout then dont add value
-			if (dType != pTypeP1Gas)
-			{
-				if (difftime(now, checktime) >= SensorTimeOut * 60)
-					continue;
-				if (m_bShortLogAddOnlyNewValues)
-				{
-					if (difftime(now, checktime) > m_ShortLogInterval * 60)
-						continue;
-				}
-			}
-			else
-			{
-				//P1 Gas meter transmits results every 1 a 2 hours
-				if (difftime(now, checktime) >= 3 * 3600)
-					continue;
-			}
-
-			if (dType == pTypeYouLess)
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size() < 2)
-					continue;
-				sValue = splitresults[0];
-				sUsage = splitresults[1];
-			}
-			else if (dType == pTypeENERGY)
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size() < 2)
-					continue;
-				sUsage = splitresults[0];
-				double fValue = atof(splitresults[1].c_str()) * 100;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypePOWER)
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size() < 2)
-					continue;
-				sUsage = splitresults[0];
-				double fValue = atof(splitresults[1].c_str()) * 100;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypeAirQuality)
-			{
-				sprintf(szTmp, "%d", nValue);
-				sValue = szTmp;
-				m_notifications.CheckAndHandleNotification(ID, hardwareID, DeviceID, devname, Unit, dType, dSubType, (int)nValue);
-			}
-			else if ((dType == pTypeGeneral) && ((dSubType == sTypeSoilMoisture) || (dSubType == sTypeLeafWetness)))
-			{
-				sprintf(szTmp, "%d", nValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeVisibility))
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeDistance))
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeKwh))
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size() < 2)
-					continue;
-
-				double fValue = atof(splitresults[0].c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sUsage = szTmp;
-
-				fValue = atof(splitresults[1].c_str());
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypeLux)
-			{
-				double fValue = atof(sValue.c_str());
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypeWEIGHT)
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypeRFXSensor)
-			{
-				double fValue = atof(sValue.c_str());
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeCounterIncremental))
-			{
-				double fValue = atof(sValue.c_str());
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeVoltage))
-			{
-				double fValue = atof(sValue.c_str()) * 1000.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeCurrent))
-			{
-				double fValue = atof(sValue.c_str()) * 1000.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypePressure))
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypeUsage)
-			{
-				double fValue = atof(sValue.c_str()) * 10.0F;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-
-			int64_t MeterValue = 0;
-			int64_t MeterUsage = 0;
-
-			try
-			{
-				MeterUsage = std::stoll(sUsage);
-				MeterValue = std::stoll(sValue);
-			}
-			catch (const std::exception&)
-			{
-				_log.Log(LOG_ERROR, "UpdateMeter: Error converting sValue/sUsage! (IDX: %s, sValue: '%s', sUsage: '%s', dType: %d, sType: %d)", sd[0].c_str(), sValue.c_str(), sUsage.c_str(), dType, dSubType);
-				continue;
-			}
-
-			//insert record
-			safe_query(
-				"INSERT INTO Meter (DeviceRowID, Value, [Usage]) "
-				"VALUES ('%" PRIu64 "', '%" PRId64 "', '%" PRId64 "')",
-				ID,
-				MeterValue,
-				MeterUsage
-			);
-		}
-	}
-}
-
-void CSQLHelper::UpdateMultiMeter()
-{
-	time_t now = mytime(nullptr);
-	if (now == 0)
-		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate,Options FROM DeviceStatus WHERE (Type=%d OR Type=%d OR Type=%d)",
-		pTypeP1Power,
-		pTypeCURRENT,
-		pTypeCURRENTENERGY
-	);
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			std::string sOptions = sd[6];
-			std::map<std::string, std::string> options = BuildDeviceOptions(sOptions);
-			// We don't want to update meter if externally managed
-			if (options["DisableLogAutoUpdate"] == "true")
-			{
-				continue;
-			}
-
-			uint64_t ID = std::stoull(sd[0]);
-			unsigned char dType = atoi(sd[1].c_str());
-			unsigned char dSubType = atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue = sd[4];
-
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate = sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now, checktime) >= SensorTimeOut * 60)
-				continue;
-			if (m_bShortLogAddOnlyNewValues)
-			{
-				if (difftime(now, checktime) > m_ShortLogInterval * 60)
-					continue;
+					(counter2 < 0) ? 0 : counter2,
+					(counter3 < 0) ? 0 : counter3,
+					(counter4 < 0) ? 0 : counter4,
+					date
+				);
 			}
-
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-
-			uint64_t value1 = 0;
-			uint64_t value2 = 0;
-			uint64_t value3 = 0;
-			uint64_t value4 = 0;
-			uint64_t value5 = 0;
-			uint64_t value6 = 0;
-
-			if (dType == pTypeP1Power)
+			else
 			{
-				if (splitresults.size() != 6)
-					continue; //impossible
-
-				uint64_t powerusage1 = 0;
-				uint64_t powerusage2 = 0;
-				uint64_t powerdeliv1 = 0;
-				uint64_t powerdeliv2 = 0;
-				uint64_t usagecurrent = 0;
-				uint64_t delivcurrent = 0;
-
-				try
-				{
-					powerusage1 = std::stoull(splitresults[0]);
-					powerusage2 = std::stoull(splitresults[1]);
-					powerdeliv1 = std::stoull(splitresults[2]);
-					powerdeliv2 = std::stoull(splitresults[3]);
-					usagecurrent = std::stoull(splitresults[4]);
-					delivcurrent = std::stoull(splitresults[5]);
-				}
-				catch (const std::exception &)
-				{
-					_log.Log(LOG_ERROR, "UpdateMultiMeter: Error converting sValue values! (IDX: %s, sValue: '%s', dType: %d, sType: %d)", sd[0].c_str(), sValue.c_str(), dType, dSubType);
-					continue;
-				}
-
-				value1 = powerusage1;
-				value2 = powerdeliv1;
-				value5 = powerusage2;
-				value6 = powerdeliv2;
-				value3 = usagecurrent;
-				value4 = delivcurrent;
+				safe_query(
+					"UPDATE MultiMeter_Calendar SET Value1='%" PRId64 "', Value2='%" PRId64 "', Value3='%" PRId64 "', Value4='%" PRId64 "', Value5='%" PRId64 "', Value6='%" PRId64 "' , Counter1='%" PRId64 "' , Counter2='%" PRId64 "' , Counter3='%" PRId64 "' , Counter4='%" PRId64 "' "
+					"WHERE ((DeviceRowID=='%" PRIu64 "') AND (Date=='%q'))",
+					(value1 < 0) ? 0 : value1,
+					(value2 < 0) ? 0 : value2,
+					(value3 < 0) ? 0 : value3,
+					(value4 < 0) ? 0 : value4,
+					(value5 < 0) ? 0 : value5,
+					(value6 < 0) ? 0 : value6,
+					(counter1 < 0) ? 0 : counter1,
+					(counter2 < 0) ? 0 : counter2,
+					(counter3 < 0) ? 0 : counter3,
+					(counter4 < 0) ? 0 : counter4,
+					DeviceRowID,
+					date
+				);
 			}
-			else if ((dType == pTypeCURRENT) && (dSubType == sTypeELEC1))
+		}
+		else {
+			result = safe_query(
+				"SELECT DeviceRowID FROM Meter_Calendar "
+				"WHERE (DeviceRowID=='%" PRIu64 "') AND (Date=='%q')",
+				DeviceRowID, date
+			);
+			if (result.empty())
 			{
-				if (splitresults.size() != 3)
-					continue; //impossible
-
-				value1 = (unsigned long)(atof(splitresults[0].c_str()) * 10.0F);
-				value2 = (unsigned long)(atof(splitresults[1].c_str()) * 10.0F);
-				value3 = (unsigned long)(atof(splitresults[2].c_str()) * 10.0F);
+				safe_query(
+					"INSERT INTO Meter_Calendar (DeviceRowID, Counter, Value, Date) "
+					"VALUES ('%" PRIu64 "', '%" PRId64 "', '%" PRId64 "', '%q')",
+					DeviceRowID, (value1 < 0) ? 0 : value1, (value2 < 0) ? 0 : value2, date
+				);
 			}
-			else if ((dType == pTypeCURRENTENERGY) && (dSubType == sTypeELEC4))
+			else
 			{
-				if (splitresults.size() != 4)
-					continue; //impossible
-
-				value1 = (unsigned long)(atof(splitresults[0].c_str()) * 10.0F);
-				value2 = (unsigned long)(atof(splitresults[1].c_str()) * 10.0F);
-				value3 = (unsigned long)(atof(splitresults[2].c_str()) * 10.0F);
-				value4 = (uint64_t)(atof(splitresults[3].c_str()) * 1000.0F);
+				safe_query(
+					"UPDATE Meter_Calendar SET DeviceRowID='%" PRIu64 "', Counter='%" PRId64 "', Value='%" PRId64 "', Date='%q' "
+					"WHERE (DeviceRowID=='%" PRIu64 "') AND (Date=='%q')",
+					DeviceRowID, (value1 < 0) ? 0 : value1, (value2 < 0) ? 0 : value2, date,
+					DeviceRowID, date
+				);
 			}
-			else
-				continue;//don't know you (yet)
-
-			//insert record
-			safe_query(
-				"INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6) "
-				"VALUES ('%" PRIu64 "', '%" PRIu64 "', '%" PRIu64 "', '%" PRIu64 "', '%" PRIu64 "', '%" PRIu64 "', '%" PRIu64 "')",
-				ID,
-				value1,
-				value2,
-				value3,
-				value4,
-				value5,
-				value6
-			);
 		}
 	}
+	return true;
 }
 
-void CSQLHelper::UpdatePercentageLog()
+void CSQLHelper::UpdateMeter(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
 {
-	time_t now = mytime(nullptr);
-	if (now == 0)
-		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
+	unsigned char dType = dev.devType;
+	unsigned char dSubType = dev.subType;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d)",
-		pTypeGeneral, sTypePercentage,
-		pTypeGeneral, sTypeWaterflow,
-		pTypeGeneral, sTypeCustom
-	);
-	if (!result.empty())
+	switch (dType)
 	{
-		for (const auto &sd : result)
-		{
-			uint64_t ID = std::stoull(sd[0]);
-
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue = sd[4];
-
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate = sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now, checktime) >= SensorTimeOut * 60)
-				continue;
-			if (m_bShortLogAddOnlyNewValues)
-			{
-				if (difftime(now, checktime) > m_ShortLogInterval * 60)
-					continue;
-			}
-
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
-
-			float percentage = static_cast<float>(atof(sValue.c_str()));
-
-			//insert record
-			safe_query(
-				"INSERT INTO Percentage (DeviceRowID, Percentage) "
-				"VALUES ('%" PRIu64 "', '%g')",
-				ID,
-				percentage
-			);
+	case pTypeRFXMeter:
+	case pTypeP1Gas:
+	case pTypeYouLess:
+	case pTypeENERGY:
+	case pTypePOWER:
+	case pTypeAirQuality:
+	case pTypeUsage:
+	case pTypeLux:
+	case pTypeWEIGHT:
+		break;
+	case pTypeRego6XXValue:
+		if (dSubType != sTypeRego6XXCounter)
+			return;
+		break;
+	case pTypeRFXSensor:
+		if ((dSubType != sTypeRFXSensorAD) && (dSubType != sTypeRFXSensorVolt))
+			return;
+		break;
+	case pTypeGeneral:
+		switch (dSubType)
+		{
+		case sTypeVisibility:
+		case sTypeSolarRadiation:
+		case sTypeSoilMoisture:
+		case sTypeLeafWetness:
+		case sTypeVoltage:
+		case sTypeCurrent:
+		case sTypeSoundLevel:
+		case sTypeDistance:
+		case sTypePressure:
+		case sTypeCounterIncremental:
+		case sTypeKwh:
+			break;
+		default:
+			return;
 		}
+		break;
+	default:
+		return;
 	}
-}
 
-void CSQLHelper::UpdateFanLog()
-{
-	time_t now = mytime(nullptr);
-	if (now == 0)
+	std::map<std::string, std::string> options = BuildDeviceOptions(dev.Options);
+	// We don't want to update meter if externally managed
+	if (options["DisableLogAutoUpdate"] == "true")
+	{
 		return;
-	struct tm tm1;
-	localtime_r(&now, &tm1);
+	}
 
-	int SensorTimeOut = 60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
+	char szTmp[200];
+	uint64_t ID = dev.ID;
+	int nValue = dev.nValue;
+	std::string sValue = dev.sValue;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d AND SubType=%d)",
-		pTypeGeneral, sTypeFan
-	);
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			uint64_t ID = std::stoull(sd[0]);
+	std::string sUsage = "0";
 
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue = sd[4];
+	//Check for timeout, if timeout then dont add value
+	if (dType != pTypeP1Gas)
+	{
+		if (!IsShortLogSensorActive(dev, SensorTimeOut))
+			return;
+	}
+	else
+	{
+		//P1 Gas meter transmits results every 1 a 2 hours
+		if (dev.age >= 3 * 3600)
+			return;
+	}
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate = sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
+	if (dType == pTypeYouLess)
+	{
+		std::vector<std::string> splitresults;
+		StringSplit(sValue, ";", splitresults);
+		if (splitresults.size() < 2)
+			return;
+		sValue = splitresults[0];
+		sUsage = splitresults[1];
+	}
+	else if (dType == pTypeENERGY)
+	{
+		std::vector<std::string> splitresults;
+		StringSplit(sValue, ";", splitresults);
+		if (splitresults.size() < 2)
+			return;
+		sUsage = splitresults[0];
+		double fValue = atof(splitresults[1].c_str()) * 100;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if (dType == pTypePOWER)
+	{
+		std::vector<std::string> splitresults;
+		StringSplit(sValue, ";", splitresults);
+		if (splitresults.size() < 2)
+			return;
+		sUsage = splitresults[0];
+		double fValue = atof(splitresults[1].c_str()) * 100;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if (dType == pTypeAirQuality)
+	{
+		sprintf(szTmp, "%d", nValue);
+		sValue = szTmp;
+		m_notifications.CheckAndHandleNotification(ID, dev.HardwareID, dev.DeviceID, dev.Name, dev.Unit, dType, dSubType, (int)nValue);
+	}
+	else if ((dType == pTypeGeneral) && ((dSubType == sTypeSoilMoisture) || (dSubType == sTypeLeafWetness)))
+	{
+		sprintf(szTmp, "%d", nValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeVisibility))
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeDistance))
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeKwh))
+	{
+		std::vector<std::string> splitresults;
+		StringSplit(sValue, ";", splitresults);
+		if (splitresults.size() < 2)
+			return;
 
-			if (difftime(now, checktime) >= SensorTimeOut * 60)
-				continue;
-			if (m_bShortLogAddOnlyNewValues)
-			{
-				if (difftime(now, checktime) > m_ShortLogInterval * 60)
-					continue;
-			}
+		double fValue = atof(splitresults[0].c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sUsage = szTmp;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
+		fValue = atof(splitresults[1].c_str());
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if (dType == pTypeLux)
+	{
+		double fValue = atof(sValue.c_str());
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if (dType == pTypeWEIGHT)
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if (dType == pTypeRFXSensor)
+	{
+		double fValue = atof(sValue.c_str());
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeCounterIncremental))
+	{
+		double fValue = atof(sValue.c_str());
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeVoltage))
+	{
+		double fValue = atof(sValue.c_str()) * 1000.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypeCurrent))
+	{
+		double fValue = atof(sValue.c_str()) * 1000.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if ((dType == pTypeGeneral) && (dSubType == sTypePressure))
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
+	else if (dType == pTypeUsage)
+	{
+		double fValue = atof(sValue.c_str()) * 10.0F;
+		sprintf(szTmp, "%.0f", fValue);
+		sValue = szTmp;
+	}
 
-			int speed = (int)atoi(sValue.c_str());
+	int64_t MeterValue = 0;
+	int64_t MeterUsage = 0;
 
-			//insert record
-			safe_query(
-				"INSERT INTO Fan (DeviceRowID, Speed) "
-				"VALUES ('%" PRIu64 "', '%d')",
-				ID,
-				speed
-			);
-		}
+	try
+	{
+		MeterUsage = std::stoll(sUsage);
+		MeterValue = std::stoll(sValue);
+	}
+	catch (const std::exception&)
+	{
+		_log.Log(LOG_ERROR, "UpdateMeter: Error converting sValue/sUsage! (IDX: %" PRIu64 ", sValue: '%s', sUsage: '%s', dType: %d, sType: %d)", ID, sValue.c_str(), sUsage.c_str(), dType, dSubType);
+		return;
 	}
+
+	samples.insert(samples.end(), { ID, MeterValue, MeterUsage });
 }
 
-void CSQLHelper::AddCalendarTemperature()
+void CSQLHelper::UpdateMultiMeter(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
 {
-	//Get All temperature devices in the Temperature Table
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM Temperature ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+	unsigned char dType = dev.devType;
+	unsigned char dSubType = dev.subType;
 
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
-
-	std::vector<std::vector<std::string> > result;
+	if ((dType != pTypeP1Power) && (dType != pTypeCURRENT) && (dType != pTypeCURRENTENERGY))
+		return;
 
-	for (const auto &sddev : resultdevices)
+	std::map<std::string, std::string> options = BuildDeviceOptions(dev.Options);
+	// We don't want to update meter if externally managed
+	if (options["DisableLogAutoUpdate"] == "true")
 	{
-		uint64_t ID = std::stoull(sddev[0]);
-
-		result = safe_query("SELECT MIN(Temperature), MAX(Temperature), AVG(Temperature), MIN(Chill), MAX(Chill), AVG(Humidity), AVG(Barometer), MIN(DewPoint), MIN(SetPoint), MAX(SetPoint), AVG(SetPoint) FROM Temperature WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-			ID,
-			szDateStart,
-			szDateEnd
-		);
-		if (!result.empty())
-		{
-			std::vector<std::string> sd = result[0];
-
-			float temp_min = static_cast<float>(atof(sd[0].c_str()));
-			float temp_max = static_cast<float>(atof(sd[1].c_str()));
-			float temp_avg = static_cast<float>(atof(sd[2].c_str()));
-			float chill_min = static_cast<float>(atof(sd[3].c_str()));
-			float chill_max = static_cast<float>(atof(sd[4].c_str()));
-			int humidity = atoi(sd[5].c_str());
-			int barometer = atoi(sd[6].c_str());
-			float dewpoint = static_cast<float>(atof(sd[7].c_str()));
-			float setpoint_min = static_cast<float>(atof(sd[8].c_str()));
-			float setpoint_max = static_cast<float>(atof(sd[9].c_str()));
-			float setpoint_avg = static_cast<float>(atof(sd[10].c_str()));
-			result = safe_query(
-				"INSERT INTO Temperature_Calendar (DeviceRowID, Temp_Min, Temp_Max, Temp_Avg, Chill_Min, Chill_Max, Humidity, Barometer, DewPoint, SetPoint_Min, SetPoint_Max, SetPoint_Avg, Date) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%d', '%d', '%.2f', '%.2f', '%.2f', '%.2f', '%q')",
-				ID,
-				temp_min,
-				temp_max,
-				temp_avg,
-				chill_min,
-				chill_max,
-				humidity,
-				barometer,
-				dewpoint,
-				setpoint_min,
-				setpoint_max,
-				setpoint_avg,
-				szDateStart
-			);
-		}
+		return;
 	}
-}
 
-void CSQLHelper::AddCalendarUpdateRain()
-{
-	//Get All UV devices
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM Rain ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+	//do not include sensors that have no reading within an hour
+	if (!IsShortLogSensorActive(dev, SensorTimeOut))
+		return;
 
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
+	std::vector<std::string> splitresults;
+	StringSplit(dev.sValue, ";", splitresults);
 
-	std::vector<std::vector<std::string> > result;
+	uint64_t value1 = 0;
+	uint64_t value2 = 0;
+	uint64_t value3 = 0;
+	uint64_t value4 = 0;
+	uint64_t value5 = 0;
+	uint64_t value6 = 0;
 
-	for (const auto &sddev : resultdevices)
+	if (dType == pTypeP1Power)
 	{
-		uint64_t ID = std::stoull(sddev[0]);
-
-		//Get Device Information
-		result = safe_query("SELECT SubType FROM DeviceStatus WHERE (ID='%" PRIu64 "')", ID);
-		if (result.empty())
-			continue;
-		std::vector<std::string> sd = result[0];
+		if (splitresults.size() != 6)
+			return; //impossible
 
-		unsigned char subType = atoi(sd[0].c_str());
+		uint64_t powerusage1 = 0;
+		uint64_t powerusage2 = 0;
+		uint64_t powerdeliv1 = 0;
+		uint64_t powerdeliv2 = 0;
+		uint64_t usagecurrent = 0;
+		uint64_t delivcurrent = 0;
 
-		if (subType == sTypeRAINWU || subType == sTypeRAINByRate)
+		try
 		{
-			result = safe_query("SELECT Total, Total, Rate FROM Rain WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00') ORDER BY ROWID DESC LIMIT 1",
-				ID,
-				szDateStart,
-				szDateEnd
-			);
-		}
-		else
-		{
-			result = safe_query("SELECT MIN(Total), MAX(Total), MAX(Rate) FROM Rain WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-				ID,
-				szDateStart,
-				szDateEnd
-			);
+			powerusage1 = std::stoull(splitresults[0]);
+			powerusage2 = std::stoull(splitresults[1]);
+			powerdeliv1 = std::stoull(splitresults[2]);
+			powerdeliv2 = std::stoull(splitresults[3]);
+			usagecurrent = std::stoull(splitresults[4]);
+			delivcurrent = std::stoull(splitresults[5]);
 		}
-
-		if (!result.empty())
+		catch (const std::exception &)
 		{
-			std::vector<std::string> sd = result[0];
-
-			float total_min = static_cast<float>(atof(sd[0].c_str()));
-			float total_max = static_cast<float>(atof(sd[1].c_str()));
-			int rate = atoi(sd[2].c_str());
-
-			float total_real = 0;
-			if (subType == sTypeRAINWU || subType == sTypeRAINByRate)
-			{
-				total_real = total_max;
-			}
-			else
-			{
-				total_real = total_max - total_min;
-			}
-
-			if (total_real < 1000)
-			{
-				result = safe_query(
-					"INSERT INTO Rain_Calendar (DeviceRowID, Total, Rate, Date) "
-					"VALUES ('%" PRIu64 "', '%.2f', '%d', '%q')",
-					ID,
-					total_real,
-					rate,
-					szDateStart
-				);
-			}
+			_log.Log(LOG_ERROR, "UpdateMultiMeter: Error converting sValue values! (IDX: %" PRIu64 ", sValue: '%s', dType: %d, sType: %d)", dev.ID, dev.sValue.c_str(), dType, dSubType);
+			return;
 		}
-	}
-}
 
-void CSQLHelper::AddCalendarUpdateMeter()
-{
-	float EnergyDivider = 1000.0F;
-	float GasDivider = 100.0F;
-	float WaterDivider = 100.0F;
-	float musage = 0;
-	int tValue;
-	if (GetPreferencesVar("MeterDividerEnergy", tValue))
-	{
-		EnergyDivider = float(tValue);
+		value1 = powerusage1;
+		value2 = powerdeliv1;
+		value5 = powerusage2;
+		value6 = powerdeliv2;
+		value3 = usagecurrent;
+		value4 = delivcurrent;
 	}
-	if (GetPreferencesVar("MeterDividerGas", tValue))
+	else if ((dType == pTypeCURRENT) && (dSubType == sTypeELEC1))
 	{
-		GasDivider = float(tValue);
+		if (splitresults.size() != 3)
+			return; //impossible
+
+		value1 = (unsigned long)(atof(splitresults[0].c_str()) * 10.0F);
+		value2 = (unsigned long)(atof(splitresults[1].c_str()) * 10.0F);
+		value3 = (unsigned long)(atof(splitresults[2].c_str()) * 10.0F);
 	}
-	if (GetPreferencesVar("MeterDividerWater", tValue))
+	else if ((dType == pTypeCURRENTENERGY) && (dSubType == sTypeELEC4))
 	{
-		WaterDivider = float(tValue);
+		if (splitresults.size() != 4)
+			return; //impossible
+
+		value1 = (unsigned long)(atof(splitresults[0].c_str()) * 10.0F);
+		value2 = (unsigned long)(atof(splitresults[1].c_str()) * 10.0F);
+		value3 = (unsigned long)(atof(splitresults[2].c_str()) * 10.0F);
+		value4 = (uint64_t)(atof(splitresults[3].c_str()) * 1000.0F);
 	}
+	else
+		return;//don't know you (yet)
+
+	samples.insert(samples.end(), { dev.ID, value1, value2, value3, value4, value5, value6 });
+}
+
+void CSQLHelper::UpdatePercentageLog(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
+{
+	if ((dev.devType != pTypeGeneral) || ((dev.subType != sTypePercentage) && (dev.subType != sTypeWaterflow) && (dev.subType != sTypeCustom)))
+		return;
 
-	//Get All Meter devices
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM Meter ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
+	//do not include sensors that have no reading within an hour
+	if (!IsShortLogSensorActive(dev, SensorTimeOut))
+		return;
 
-	char szDateStart[40];
-	char szDateEnd[40];
+	if (dev.sValue.empty())
+		return; //impossible
 
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+	double percentage = atof(dev.sValue.c_str());
 
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
+	samples.insert(samples.end(), { dev.ID, percentage });
+}
 
-	std::vector<std::vector<std::string> > result;
+void CSQLHelper::UpdateFanLog(const _tShortLogDevice &dev, const int SensorTimeOut, std::vector<_tSQLParam> &samples)
+{
+	if ((dev.devType != pTypeGeneral) || (dev.subType != sTypeFan))
+		return;
 
-	for (const auto &sddev : resultdevices)
-	{
-		uint64_t ID = std::stoull(sddev[0]);
+	//do not include sensors that have no reading within an hour
+	if (!IsShortLogSensorActive(dev, SensorTimeOut))
+		return;
 
-		//Get Device Information
-		result = safe_query("SELECT Name, HardwareID, DeviceID, Unit, Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID='%" PRIu64 "')", ID);
-		if (result.empty())
-			continue;
-		std::vector<std::string> sd = result[0];
+	if (dev.sValue.empty())
+		return; //impossible
+
+	int speed = (int)atoi(dev.sValue.c_str());
+
+	samples.insert(samples.end(), { dev.ID, speed });
+}
+
+//Simple rollups are done in one grouped INSERT ... SELECT pass (SQLCalendarQueries.h)
+//Devices without samples in the period get a zero calendar row
+int CSQLHelper::AddCalendarTemperature(const std::string &szDateStart, const std::string &szDateEnd)
+{
+	bind_query_nolock(sqlCalendarTemperature, szDateStart, szDateEnd);
+	return sqlite3_changes(m_dbase);
+}
+
+int CSQLHelper::AddCalendarUpdateRain(const std::string &szDateStart, const std::string &szDateEnd)
+{
+	//Counter based rain meters, the day total is the difference of the counter
+	bind_query_nolock(sqlCalendarRainCounter, szDateStart, szDateEnd, sTypeRAINWU, sTypeRAINByRate);
+	int nRows = sqlite3_changes(m_dbase);
+
+	//Rain meters reporting a day total, use the last value of the day
+	bind_query_nolock(sqlCalendarRainTotal, szDateStart, szDateEnd, sTypeRAINWU, sTypeRAINByRate);
+	return nRows + sqlite3_changes(m_dbase);
+}
+
+int CSQLHelper::AddCalendarUpdateMeter(const std::string &szDateStart, const std::string &szDateEnd, std::vector<_tCalendarNotification> &notifications, std::vector<uint64_t> &influxdevices)
+{
+	//All meters in one grouped pass, first/last values of the day and the last counter are index lookups
+	std::vector<std::vector<std::string> > resultdevices;
+	resultdevices = bind_query_nolock(sqlCalendarMeter, szDateStart, szDateEnd);
+
+	int nRows = 0;
+	for (const auto &sd : resultdevices)
+	{
+		//A meter without samples in the period gets a zero row, its last counter is still carried over
+		uint64_t ID = std::stoull(sd[0]);
 
-		std::string sOptions = sd[7];
-		std::map<std::string, std::string> options = BuildDeviceOptions(sOptions);
+		std::map<std::string, std::string> options = BuildDeviceOptions(sd[5]);
 		// We don't want to update meter if externally managed
 		if (options["DisableLogAutoUpdate"] == "true")
 		{
 			continue;
 		}
-		std::string devname = sd[0];
-		//int hardwareID= atoi(sd[1].c_str());
-		//std::string DeviceID=sd[2];
-		//unsigned char Unit = atoi(sd[3].c_str());
-		unsigned char devType = atoi(sd[4].c_str());
-		unsigned char subType = atoi(sd[5].c_str());
-		_eSwitchType switchtype = (_eSwitchType)atoi(sd[6].c_str());
+		std::string devname = sd[1];
+		unsigned char devType = atoi(sd[2].c_str());
+		unsigned char subType = atoi(sd[3].c_str());
+		_eSwitchType switchtype = (_eSwitchType)atoi(sd[4].c_str());
 		_eMeterType metertype = (_eMeterType)switchtype;
 
-		float tGasDivider = GasDivider;
-
 		if (devType == pTypeP1Power)
 		{
 			metertype = MTYPE_ENERGY;
@@ -7265,497 +7757,245 @@ void CSQLHelper::AddCalendarUpdateMeter()
 		else if (devType == pTypeP1Gas)
 		{
 			metertype = MTYPE_GAS;
-			tGasDivider = 1000.0F;
 		}
 		else if ((devType == pTypeRego6XXValue) && (subType == sTypeRego6XXCounter))
 		{
 			metertype = MTYPE_COUNTER;
 		}
 
-		result = safe_query("SELECT MIN(Value), MAX(Value), AVG(Value) FROM Meter WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-			ID,
-			szDateStart,
-			szDateEnd
-		);
+		double total_min = (double)atof(sd[6].c_str());
+		double total_max = (double)atof(sd[7].c_str());
+		double avg_value = (double)atof(sd[8].c_str());
 
-		if (!result.empty())
+		// if kwh counter => total_min = first value of the day, and total_max = last value of the day
+		// because last value can be lower than first value when consumed energy is negative (e.g. photovoltaic produces more than building usage)
+		if (((devType == pTypeGeneral) && ((subType == sTypeKwh) || (subType == sTypeCounterIncremental))) || ((devType == pTypeRFXMeter) && (subType == sTypeRFXMeterCount)))
 		{
-			std::vector<std::string> sd = result[0];
-
-			double total_min = (double)atof(sd[0].c_str());
-			double total_max = (double)atof(sd[1].c_str());
-			double avg_value = (double)atof(sd[2].c_str());
-
-			// if kwh counter => total_min = first value of the day, and total_max = last value of the day
-			// because last value can be lower than first value when consumed energy is negative (e.g. photovoltaic produces more than building usage)
-			if (((devType == pTypeGeneral) && ((subType == sTypeKwh) || (subType == sTypeCounterIncremental))) || ((devType == pTypeRFXMeter) && (subType == sTypeRFXMeterCount)))
+			if (!sd[9].empty())
 			{
-				result = safe_query("SELECT Value FROM Meter WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00') ORDER BY Date ASC LIMIT 1",
-						ID, szDateStart, szDateEnd );
-				if (!result.empty())
-				{
-					std::vector<std::string> sd = result[0];
-					total_min = (double)atof(sd[0].c_str());
-					total_max = total_min;
-				}
-				result = safe_query("SELECT Value FROM Meter WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00') ORDER BY Date DESC LIMIT 1",
-						ID, szDateStart, szDateEnd );
-				if (!result.empty())
-				{
-					std::vector<std::string> sd = result[0];
-					total_max = (double)atof(sd[0].c_str());
-				}
+				total_min = (double)atof(sd[9].c_str());
+				total_max = total_min;
 			}
+			if (!sd[10].empty())
+				total_max = (double)atof(sd[10].c_str());
+		}
 
-			if (
-				(devType != pTypeAirQuality) &&
-				(devType != pTypeRFXSensor) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeVisibility))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeDistance))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeSolarRadiation))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeSoilMoisture))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeLeafWetness))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeVoltage))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeCurrent))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypePressure))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeSoundLevel))) &&
-				(devType != pTypeLux) &&
-				(devType != pTypeWEIGHT) &&
-				(devType != pTypeUsage)
-				)
-			{
-				double total_real = total_max - total_min;
-				double counter = total_max;
+		if (
+			(devType != pTypeAirQuality) &&
+			(devType != pTypeRFXSensor) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeVisibility))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeDistance))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeSolarRadiation))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeSoilMoisture))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeLeafWetness))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeVoltage))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeCurrent))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypePressure))) &&
+			(!((devType == pTypeGeneral) && (subType == sTypeSoundLevel))) &&
+			(devType != pTypeLux) &&
+			(devType != pTypeWEIGHT) &&
+			(devType != pTypeUsage)
+			)
+		{
+			double total_real = total_max - total_min;
+			double counter = total_max;
 
-				result = safe_query(
-					"INSERT INTO Meter_Calendar (DeviceRowID, Value, Counter, Date) "
-					"VALUES ('%" PRIu64 "', '%.2f', '%.2f', '%q')",
-					ID,
-					total_real,
-					counter,
-					szDateStart
-				);
+			bind_query_nolock("INSERT INTO Meter_Calendar (DeviceRowID, Value, Counter, Date) VALUES (?, ?, ?, ?)",
+				ID, round_digits(total_real, 2), round_digits(counter, 2), szDateStart);
+			nRows++;
 
-				//Check for Notification
-				musage = 0;
-				switch (metertype)
-				{
-				case MTYPE_ENERGY:
-				case MTYPE_ENERGY_GENERATED:
-					musage = float(total_real) / EnergyDivider;
-					if (musage != 0)
-						m_notifications.CheckAndHandleNotification(ID, devname, devType, subType, NTYPE_TODAYENERGY, musage);
-					break;
-				case MTYPE_GAS:
-					musage = float(total_real) / tGasDivider;
-					if (musage != 0)
-						m_notifications.CheckAndHandleNotification(ID, devname, devType, subType, NTYPE_TODAYGAS, musage);
-					break;
-				case MTYPE_WATER:
-					musage = float(total_real) / WaterDivider;
-					if (musage != 0)
-						m_notifications.CheckAndHandleNotification(ID, devname, devType, subType, NTYPE_TODAYGAS, musage);
-					break;
-				case MTYPE_COUNTER:
-					musage = float(total_real);
-					if (musage != 0)
-						m_notifications.CheckAndHandleNotification(ID, devname, devType, subType, NTYPE_TODAYCOUNTER, musage);
-					break;
-				default:
-					//Unhandled
-					musage = 0;
-					break;
-				}
-			}
-			else
-			{
-				//AirQuality/Usage Meter/Moisture/RFXSensor/Voltage/Lux/SoundLevel insert into MultiMeter_Calendar table
-				result = safe_query("INSERT INTO MultiMeter_Calendar (DeviceRowID, Value1,Value2,Value3,Value4,Value5,Value6, Date) "
-						    "VALUES ('%" PRIu64 "', '%.2f','%.2f','%.2f','%.2f','%.2f','%.2f', '%q')",
-						    ID, total_min, total_max, avg_value, 0.0F, 0.0F, 0.0F, szDateStart);
-			}
-			//Insert the last (max) counter value into the meter table to get the "today" value correct.
-			if (
-				(devType == pTypeRFXMeter)
-				|| (devType == pTypeP1Gas)
-				|| (devType == pTypeYouLess)
-				|| (devType == pTypeENERGY)
-				|| (devType == pTypePOWER)
-				|| ((devType == pTypeRego6XXValue) && (subType == sTypeRego6XXCounter))
-				|| ((devType == pTypeGeneral) && (subType == sTypeCounterIncremental))
-				|| ((devType == pTypeGeneral) && (subType == sTypeKwh))
-				)
-			{
-				result = safe_query("SELECT Value, Usage FROM Meter WHERE (DeviceRowID='%" PRIu64 "') ORDER BY ROWID DESC LIMIT 1", ID);
-				if (!result.empty())
-				{
-					std::vector<std::string> sd = result[0];
-					result = safe_query(
-						"INSERT INTO Meter (DeviceRowID, Value, Usage) "
-						"VALUES ('%" PRIu64 "', '%q', '%q')",
-						ID,
-						sd[0].c_str(),
-						sd[1].c_str()
-						);
-					//also send this to Influx as this can be used as start counter of today()
-					m_influxpush.DoInfluxPush(ID, true);
-				}
-			}
+			//Notifications are handled after the transaction
+			notifications.push_back({ ID, devname, devType, subType, metertype, total_real, false });
 		}
 		else
 		{
-			//no new meter result received in last day
-			result = safe_query("INSERT INTO Meter_Calendar (DeviceRowID, Value, Date) "
-					    "VALUES ('%" PRIu64 "', '%.2f', '%q')",
-					    ID, 0.0F, szDateStart);
+			//AirQuality/Usage Meter/Moisture/RFXSensor/Voltage/Lux/SoundLevel insert into MultiMeter_Calendar table
+			bind_query_nolock("INSERT INTO MultiMeter_Calendar (DeviceRowID, Value1,Value2,Value3,Value4,Value5,Value6, Date) VALUES (?, ?, ?, ?, 0, 0, 0, ?)",
+				ID, round_digits(total_min, 2), round_digits(total_max, 2), round_digits(avg_value, 2), szDateStart);
+			nRows++;
+		}
+		//Insert the last (max) counter value into the meter table to get the "today" value correct.
+		if (
+			(devType == pTypeRFXMeter)
+			|| (devType == pTypeP1Gas)
+			|| (devType == pTypeYouLess)
+			|| (devType == pTypeENERGY)
+			|| (devType == pTypePOWER)
+			|| ((devType == pTypeRego6XXValue) && (subType == sTypeRego6XXCounter))
+			|| ((devType == pTypeGeneral) && (subType == sTypeCounterIncremental))
+			|| ((devType == pTypeGeneral) && (subType == sTypeKwh))
+			)
+		{
+			if (!sd[11].empty())
+			{
+				bind_query_nolock("INSERT INTO Meter (DeviceRowID, Value, [Usage]) VALUES (?, ?, ?)", ID, sd[11], sd[12]);
+				//also send this to Influx as this can be used as start counter of today()
+				influxdevices.push_back(ID);
+			}
 		}
 	}
+	return nRows;
 }
 
-void CSQLHelper::AddCalendarUpdateMultiMeter()
+int CSQLHelper::AddCalendarUpdateMultiMeter(const std::string &szDateStart, const std::string &szDateEnd, std::vector<_tCalendarNotification> &notifications)
 {
-	float EnergyDivider = 1000.0F;
-	int tValue;
-	if (GetPreferencesVar("MeterDividerEnergy", tValue))
-	{
-		EnergyDivider = float(tValue);
-	}
-
-	//Get All meter devices
 	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM MultiMeter ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
-
-	std::vector<std::vector<std::string> > result;
+	resultdevices = bind_query_nolock(sqlCalendarMultiMeter, szDateStart, szDateEnd);
 
-	for (const auto &sddev : resultdevices)
+	int nRows = 0;
+	for (const auto &sd : resultdevices)
 	{
-		uint64_t ID = std::stoull(sddev[0]);
-
-		//Get Device Information
-		result = safe_query("SELECT Name, HardwareID, DeviceID, Unit, Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID='%" PRIu64 "')", ID);
-		if (result.empty())
-			continue;
-		std::vector<std::string> sd = result[0];
+		uint64_t ID = std::stoull(sd[0]);
 
-		std::string sOptions = sd[7];
-		std::map<std::string, std::string> options = BuildDeviceOptions(sOptions);
+		std::map<std::string, std::string> options = BuildDeviceOptions(sd[4]);
 		// We don't want to update meter if externally managed
 		if (options["DisableLogAutoUpdate"] == "true")
 		{
 			continue;
 		}
 
-		std::string devname = sd[0];
-		//int hardwareID= atoi(sd[1].c_str());
-		//std::string DeviceID=sd[2];
-		//unsigned char Unit = atoi(sd[3].c_str());
-		unsigned char devType = atoi(sd[4].c_str());
-		unsigned char subType = atoi(sd[5].c_str());
-		//_eSwitchType switchtype=(_eSwitchType) atoi(sd[6].c_str());
-		//_eMeterType metertype=(_eMeterType)switchtype;
-
-		result = safe_query(
-			"SELECT MIN(Value1), MAX(Value1), MIN(Value2), MAX(Value2), MIN(Value3), MAX(Value3), MIN(Value4), MAX(Value4), MIN(Value5), MAX(Value5), MIN(Value6), MAX(Value6) FROM MultiMeter WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-			ID,
-			szDateStart,
-			szDateEnd
-		);
-		if (!result.empty())
-		{
-			std::vector<std::string> sd = result[0];
+		std::string devname = sd[1];
+		unsigned char devType = atoi(sd[2].c_str());
+		unsigned char subType = atoi(sd[3].c_str());
 
-			float total_real[6];
-			float counter1 = 0;
-			float counter2 = 0;
-			float counter3 = 0;
-			float counter4 = 0;
+		//the aggregated values start at column 5
+		const int iAgg = 5;
+		float total_real[6];
+		float counter1 = 0;
+		float counter2 = 0;
+		float counter3 = 0;
+		float counter4 = 0;
 
-			if (devType == pTypeP1Power)
-			{
-				for (int ii = 0; ii < 6; ii++)
-				{
-					float total_min = static_cast<float>(atof(sd[(ii * 2) + 0].c_str()));
-					float total_max = static_cast<float>(atof(sd[(ii * 2) + 1].c_str()));
-					total_real[ii] = total_max - total_min;
-				}
-				counter1 = static_cast<float>(atof(sd[1].c_str()));
-				counter2 = static_cast<float>(atof(sd[3].c_str()));
-				counter3 = static_cast<float>(atof(sd[9].c_str()));
-				counter4 = static_cast<float>(atof(sd[11].c_str()));
-			}
-			else
+		if (devType == pTypeP1Power)
+		{
+			for (int ii = 0; ii < 6; ii++)
 			{
-				for (int ii = 0; ii < 6; ii++)
-				{
-					float fvalue = static_cast<float>(atof(sd[ii].c_str()));
-					total_real[ii] = fvalue;
-				}
+				float total_min = static_cast<float>(atof(sd[iAgg + (ii * 2) + 0].c_str()));
+				float total_max = static_cast<float>(atof(sd[iAgg + (ii * 2) + 1].c_str()));
+				total_real[ii] = total_max - total_min;
 			}
-
-			result = safe_query(
-				"INSERT INTO MultiMeter_Calendar (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6, Counter1, Counter2, Counter3, Counter4, Date) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%.2f', '%q')",
-				ID,
-				total_real[0],
-				total_real[1],
-				total_real[2],
-				total_real[3],
-				total_real[4],
-				total_real[5],
-				counter1,
-				counter2,
-				counter3,
-				counter4,
-				szDateStart
-			);
-
-			//Check for Notification
-			if (devType == pTypeP1Power)
+			counter1 = static_cast<float>(atof(sd[iAgg + 1].c_str()));
+			counter2 = static_cast<float>(atof(sd[iAgg + 3].c_str()));
+			counter3 = static_cast<float>(atof(sd[iAgg + 9].c_str()));
+			counter4 = static_cast<float>(atof(sd[iAgg + 11].c_str()));
+		}
+		else
+		{
+			for (int ii = 0; ii < 6; ii++)
 			{
-				float musage = (total_real[0] + total_real[4]) / EnergyDivider;
-				m_notifications.CheckAndHandleNotification(ID, devname, devType, subType, NTYPE_TODAYENERGY, musage);
+				float fvalue = static_cast<float>(atof(sd[iAgg + ii].c_str()));
+				total_real[ii] = fvalue;
 			}
-			/*
-			//Insert the last (max) counter values into the table to get the "today" value correct.
-			sprintf(szTmp,
-			"INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6, Date) "
-			"VALUES (%" PRIu64 ", %s, %s, %s, %s, %s, %s, '%s')",
-			ID,
-			sd[0].c_str(),
-			sd[1].c_str(),
-			sd[2].c_str(),
-			sd[3].c_str(),
-			sd[4].c_str(),
-			sd[5].c_str(),
-			szDateEnd
-			);
-			result=query(szTmp);
-			*/
 		}
-	}
-}
-
-void CSQLHelper::AddCalendarUpdateWind()
-{
-	//Get All Wind devices
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM Wind ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
-
-	std::vector<std::vector<std::string> > result;
-
-	for (const auto &sddev : resultdevices)
-	{
-		uint64_t ID = std::stoull(sddev[0]);
 
-		result = safe_query("SELECT AVG(Direction), MIN(Speed), MAX(Speed), MIN(Gust), MAX(Gust) FROM Wind WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
+		bind_query_nolock(
+			"INSERT INTO MultiMeter_Calendar (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6, Counter1, Counter2, Counter3, Counter4, Date) "
+			"VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
 			ID,
-			szDateStart,
-			szDateEnd
+			round_digits(total_real[0], 2),
+			round_digits(total_real[1], 2),
+			round_digits(total_real[2], 2),
+			round_digits(total_real[3], 2),
+			round_digits(total_real[4], 2),
+			round_digits(total_real[5], 2),
+			round_digits(counter1, 2),
+			round_digits(counter2, 2),
+			round_digits(counter3, 2),
+			round_digits(counter4, 2),
+			szDateStart
 		);
-		if (!result.empty())
-		{
-			std::vector<std::string> sd = result[0];
-
-			float Direction = static_cast<float>(atof(sd[0].c_str()));
-			int speed_min = atoi(sd[1].c_str());
-			int speed_max = atoi(sd[2].c_str());
-			int gust_min = atoi(sd[3].c_str());
-			int gust_max = atoi(sd[4].c_str());
+		nRows++;
 
-			result = safe_query(
-				"INSERT INTO Wind_Calendar (DeviceRowID, Direction, Speed_Min, Speed_Max, Gust_Min, Gust_Max, Date) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%d', '%d', '%d', '%d', '%q')",
-				ID,
-				Direction,
-				speed_min,
-				speed_max,
-				gust_min,
-				gust_max,
-				szDateStart
-			);
+		//Check for Notification (after the transaction)
+		if (devType == pTypeP1Power)
+		{
+			notifications.push_back({ ID, devname, devType, subType, MTYPE_ENERGY, (double)(total_real[0] + total_real[4]), true });
 		}
 	}
+	return nRows;
 }
 
-void CSQLHelper::AddCalendarUpdateUV()
+int CSQLHelper::AddCalendarUpdateWind(const std::string &szDateStart, const std::string &szDateEnd)
 {
-	//Get All UV devices
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM UV ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
-
-	std::vector<std::vector<std::string> > result;
-
-	for (const auto &sddev : resultdevices)
-	{
-		uint64_t ID = std::stoull(sddev[0]);
-
-		result = safe_query("SELECT MAX(Level) FROM UV WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-			ID,
-			szDateStart,
-			szDateEnd
-		);
-		if (!result.empty())
-		{
-			std::vector<std::string> sd = result[0];
-
-			float level = static_cast<float>(atof(sd[0].c_str()));
-
-			result = safe_query(
-				"INSERT INTO UV_Calendar (DeviceRowID, Level, Date) "
-				"VALUES ('%" PRIu64 "', '%g', '%q')",
-				ID,
-				level,
-				szDateStart
-			);
-		}
-	}
+	bind_query_nolock(sqlCalendarWind, szDateStart, szDateEnd);
+	return sqlite3_changes(m_dbase);
 }
 
-void CSQLHelper::AddCalendarUpdatePercentage()
+int CSQLHelper::AddCalendarUpdateUV(const std::string &szDateStart, const std::string &szDateEnd)
 {
-	//Get All Percentage devices in the Percentage Table
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM Percentage ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
-
-	std::vector<std::vector<std::string> > result;
-
-	for (const auto &sddev : resultdevices)
-	{
-		uint64_t ID = std::stoull(sddev[0]);
-
-		result = safe_query("SELECT MIN(Percentage), MAX(Percentage), AVG(Percentage) FROM Percentage WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-			ID,
-			szDateStart,
-			szDateEnd
-		);
-		if (!result.empty())
-		{
-			std::vector<std::string> sd = result[0];
-
-			float percentage_min = static_cast<float>(atof(sd[0].c_str()));
-			float percentage_max = static_cast<float>(atof(sd[1].c_str()));
-			float percentage_avg = static_cast<float>(atof(sd[2].c_str()));
-			result = safe_query(
-				"INSERT INTO Percentage_Calendar (DeviceRowID, Percentage_Min, Percentage_Max, Percentage_Avg, Date) "
-				"VALUES ('%" PRIu64 "', '%g', '%g', '%g','%q')",
-				ID,
-				percentage_min,
-				percentage_max,
-				percentage_avg,
-				szDateStart
-			);
-		}
-	}
+	bind_query_nolock(sqlCalendarUV, szDateStart, szDateEnd);
+	return sqlite3_changes(m_dbase);
 }
 
-void CSQLHelper::AddCalendarUpdateFan()
+int CSQLHelper::AddCalendarUpdatePercentage(const std::string &szDateStart, const std::string &szDateEnd)
 {
-	//Get All FAN devices in the Fan Table
-	std::vector<std::vector<std::string> > resultdevices;
-	resultdevices = safe_query("SELECT DISTINCT(DeviceRowID) FROM Fan ORDER BY DeviceRowID");
-	if (resultdevices.empty())
-		return; //nothing to do
-
-	char szDateStart[40];
-	char szDateEnd[40];
-
-	time_t now = mytime(nullptr);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
-	sprintf(szDateEnd, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+	bind_query_nolock(sqlCalendarPercentage, szDateStart, szDateEnd);
+	return sqlite3_changes(m_dbase);
+}
 
-	time_t yesterday;
-	struct tm tm2;
-	getNoon(yesterday, tm2, ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday - 1); // we only want the date
-	sprintf(szDateStart, "%04d-%02d-%02d", tm2.tm_year + 1900, tm2.tm_mon + 1, tm2.tm_mday);
+int CSQLHelper::AddCalendarUpdateFan(const std::string &szDateStart, const std::string &szDateEnd)
+{
+	bind_query_nolock(sqlCalendarFan, szDateStart, szDateEnd);
+	return sqlite3_changes(m_dbase);
+}
 
-	std::vector<std::vector<std::string> > result;
+void CSQLHelper::HandleCalendarNotifications(const std::vector<_tCalendarNotification> &notifications)
+{
+	if (notifications.empty())
+		return;
 
-	for (const auto &sddev : resultdevices)
+	float EnergyDivider = 1000.0F;
+	float GasDivider = 100.0F;
+	float WaterDivider = 100.0F;
+	int tValue;
+	if (GetPreferencesVar("MeterDividerEnergy", tValue))
+	{
+		EnergyDivider = float(tValue);
+	}
+	if (GetPreferencesVar("MeterDividerGas", tValue))
 	{
-		uint64_t ID = std::stoull(sddev[0]);
+		GasDivider = float(tValue);
+	}
+	if (GetPreferencesVar("MeterDividerWater", tValue))
+	{
+		WaterDivider = float(tValue);
+	}
 
-		result = safe_query("SELECT MIN(Speed), MAX(Speed), AVG(Speed) FROM Fan WHERE (DeviceRowID='%" PRIu64 "' AND Date>='%q' AND Date<='%q 00:00:00')",
-			ID,
-			szDateStart,
-			szDateEnd
-		);
-		if (!result.empty())
+	for (const auto &itt : notifications)
+	{
+		if (itt.bMultiMeter)
 		{
-			std::vector<std::string> sd = result[0];
-
-			int speed_min = (int)atoi(sd[0].c_str());
-			int speed_max = (int)atoi(sd[1].c_str());
-			int speed_avg = (int)atoi(sd[2].c_str());
-			result = safe_query(
-				"INSERT INTO Fan_Calendar (DeviceRowID, Speed_Min, Speed_Max, Speed_Avg, Date) "
-				"VALUES ('%" PRIu64 "', '%d', '%d', '%d','%q')",
-				ID,
-				speed_min,
-				speed_max,
-				speed_avg,
-				szDateStart
-			);
+			float musage = float(itt.usage) / EnergyDivider;
+			m_notifications.CheckAndHandleNotification(itt.ID, itt.Name, itt.devType, itt.subType, NTYPE_TODAYENERGY, musage);
+			continue;
+		}
+		float musage = 0;
+		switch (itt.metertype)
+		{
+		case MTYPE_ENERGY:
+		case MTYPE_ENERGY_GENERATED:
+			musage = float(itt.usage) / EnergyDivider;
+			if (musage != 0)
+				m_notifications.CheckAndHandleNotification(itt.ID, itt.Name, itt.devType, itt.subType, NTYPE_TODAYENERGY, musage);
+			break;
+		case MTYPE_GAS:
+			musage = float(itt.usage) / ((itt.devType == pTypeP1Gas) ? 1000.0F : GasDivider);
+			if (musage != 0)
+				m_notifications.CheckAndHandleNotification(itt.ID, itt.Name, itt.devType, itt.subType, NTYPE_TODAYGAS, musage);
+			break;
+		case MTYPE_WATER:
+			musage = float(itt.usage) / WaterDivider;
+			if (musage != 0)
+				m_notifications.CheckAndHandleNotification(itt.ID, itt.Name, itt.devType, itt.subType, NTYPE_TODAYGAS, musage);
+			break;
+		case MTYPE_COUNTER:
+			musage = float(itt.usage);
+			if (musage != 0)
+				m_notifications.CheckAndHandleNotification(itt.ID, itt.Name, itt.devType, itt.subType, NTYPE_TODAYCOUNTER, musage);
+			break;
+		default:
+			//Unhandled
+			break;
 		}
 	}
 }
@@ -7824,7 +8064,12 @@ void CSQLHelper::ClearShortLog()
 
 void CSQLHelper::VacuumDatabase()
 {
-	query("VACUUM");
+	if (!m_dbase)
+		return;
+	//VACUUM can not run inside the open device write batch
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	FlushDeviceWritesInt();
+	sqlite3_exec(m_dbase, "VACUUM", nullptr, nullptr, nullptr);
 }
 
 void CSQLHelper::OptimizeDatabase(sqlite3* dbase)
@@ -7907,6 +8152,7 @@ void CSQLHelper::DeleteDevices(const std::string& idx)
 	{
 		//Avoid mutex deadlock here
 		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		FlushDeviceWritesInt();
 
 		char* errorMessage;
 		sqlite3_exec(m_dbase, "BEGIN TRANSACTION", nullptr, nullptr, &errorMessage);
@@ -7979,6 +8225,7 @@ void CSQLHelper::DeleteScenes(const std::string& idx)
 	{
 		//Avoid mutex deadlock here
 		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		FlushDeviceWritesInt();
 
 		char* errorMessage;
 		sqlite3_exec(m_dbase, "BEGIN TRANSACTION", nullptr, nullptr, &errorMessage);
@@ -8300,8 +8547,18 @@ bool CSQLHelper::RestoreDatabase(const std::string& dbase)
 	StopThread();
 
 	//stop database
+	{
+		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		ClearStatementCache();
+	}
 	sqlite3_close(m_dbase);
 	m_dbase = nullptr;
+	ClearDeviceStatusCache();
+	ClearPreferencesCache();
+	ResetDeviceJournal();
+	ClearDeviceWrites();
+	SetLogDataChanged(0);
+	m_hardware_data_generation++;
 	std::ofstream outfile2;
 	outfile2.open(m_dbase_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
 	if (!outfile2.is_open())
@@ -8346,6 +8603,7 @@ bool CSQLHelper::BackupDatabase(const std::string& OutputFile)
 	VacuumDatabase();
 
 	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	FlushDeviceWritesInt();
 
 	int rc;					 // Function return code
 	sqlite3* pFile;			 // Database connection opened on zFilename
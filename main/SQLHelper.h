@@ -1,6 +1,13 @@
 #pragma once
 
 #include <string>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <set>
+#include <unordered_map>
 #include "RFXNames.h"
 #include "../hardware/hardwaretypes.h"
 #include "Helper.h"
@@ -12,6 +19,8 @@
 
 struct sqlite3;
 struct sqlite3_stmt;
+struct sqlite3_context;
+struct sqlite3_value;
 
 enum _eWindUnit
 {
@@ -342,6 +351,62 @@ class CSQLStatement
 	~CSQLStatement();
 };
 
+// typed parameter for bind_query, the referenced text has to stay valid during the call
+struct _tSQLParam
+{
+	enum _eType
+	{
+		SP_NULL = 0,
+		SP_INT,
+		SP_REAL,
+		SP_TEXT,
+	};
+	_eType type = SP_NULL;
+	int64_t iValue = 0;
+	double dValue = 0;
+	const char *szValue = nullptr;
+	size_t length = 0;
+
+	_tSQLParam() = default;
+	_tSQLParam(const bool value) : type(SP_INT), iValue(value ? 1 : 0) {}
+	_tSQLParam(const unsigned char value) : type(SP_INT), iValue(value) {}
+	_tSQLParam(const int value) : type(SP_INT), iValue(value) {}
+	_tSQLParam(const unsigned int value) : type(SP_INT), iValue(value) {}
+	_tSQLParam(const long value) : type(SP_INT), iValue(value) {}
+	_tSQLParam(const unsigned long value) : type(SP_INT), iValue((int64_t)value) {}
+	_tSQLParam(const long long value) : type(SP_INT), iValue(value) {}
+	_tSQLParam(const unsigned long long value) : type(SP_INT), iValue((int64_t)value) {}
+	_tSQLParam(const float value) : type(SP_REAL), dValue(value) {}
+	_tSQLParam(const double value) : type(SP_REAL), dValue(value) {}
+	_tSQLParam(const char *value) : type((value != nullptr) ? SP_TEXT : SP_NULL), szValue(value), length((value != nullptr) ? strlen(value) : 0) {}
+	_tSQLParam(const std::string &value) : type(SP_TEXT), szValue(value.c_str()), length(value.size()) {}
+};
+
+// cached DeviceStatus row, used by the UpdateValueInt hot path
+struct _tDeviceStatusCacheItem
+{
+	uint64_t ID = 0;
+	unsigned char devType = 0;
+	unsigned char subType = 0;
+	std::string Name;
+	bool bUsed = false;
+	_eSwitchType SwitchType = STYPE_OnOff;
+	int nValue = 0;
+	std::string sValue;
+	std::string LastUpdate;
+	std::map<std::string, std::string> Options;
+};
+
+// cached Preferences row
+struct _tPreferencesCacheItem
+{
+	int nValue = 0;
+	std::string sValue;
+};
+
+// called after a preference has been changed or deleted through UpdatePreferencesVar/DeletePreferencesVar
+typedef std::function<void(const std::string &Key)> PreferencesCallback;
+
 class CSQLHelper : public StoppableTask
 {
       public:
@@ -350,6 +415,7 @@ class CSQLHelper : public StoppableTask
 
 	void SetDatabaseName(const std::string &DBName);
 	void SetJournalMode(const std::string &mode);
+	void SetDeviceWriteBatching(int IntervalMs, int MaxRows);
 
 	bool OpenDatabase();
 	void CloseDatabase();
@@ -442,6 +508,12 @@ class CSQLHelper : public StoppableTask
 
 	int execute_sql(const std::string &sSQL, std::vector<std::string> *pValues, bool bLogError);
 	std::vector<std::vector<std::string>> safe_query(const char *fmt, ...);
+	// Query with '?' placeholders, the prepared statement is kept in a LRU cache keyed by the SQL text
+	template <typename... Args> std::vector<std::vector<std::string>> bind_query(const char *szSQL, const Args &...args)
+	{
+		const _tSQLParam params[] = { _tSQLParam(args)..., _tSQLParam() };
+		return bind_query_int(szSQL, params, sizeof...(Args));
+	}
 	std::vector<std::vector<std::string>> safe_queryBlob(const char *fmt, ...);
 	void safe_exec_no_return(const char *fmt, ...);
 	bool safe_UpdateBlobInTableWithID(const std::string &Table, const std::string &Column, const std::string &sID, const std::string &BlobData);
@@ -475,6 +547,35 @@ class CSQLHelper : public StoppableTask
 
 	float GetCounterDivider(int metertype, int dType, float DefaultValue);
 
+	void InvalidateDeviceStatusCache(uint64_t idx);
+	void ClearDeviceStatusCache();
+	void GetDeviceStatusCacheStats(uint64_t &hits, uint64_t &misses, size_t &entries);
+	// State of a device from the DeviceStatus cache only (no database access), false when it is not cached
+	bool GetCachedDeviceState(uint64_t idx, unsigned char &devType, unsigned char &subType, int &nValue, std::string &sValue, std::string &sLastUpdate);
+
+	void ClearPreferencesCache();
+	// callback is invoked for every changed Key starting with KeyPrefix, returns an id for UnregisterPreferencesCallback
+	int RegisterPreferencesCallback(const std::string &KeyPrefix, const PreferencesCallback &callback);
+	void UnregisterPreferencesCallback(int id);
+	// changes every time a log or calendar row of the device, or a preferences row is written
+	uint64_t GetLogDataGeneration(uint64_t DeviceRowIdx);
+	// changes every time a Hardware or Cameras row is written
+	uint64_t GetHardwareDataGeneration()
+	{
+		return m_hardware_data_generation;
+	}
+
+	// Device change journal, every DeviceStatus/Scenes row change gets a new (monotonic) sequence number
+	uint64_t GetDeviceChangeSequence();
+	// returns false when the changes since Sequence can not be given per row (structure changed, journal restarted)
+	bool GetDeviceChangesSince(uint64_t Sequence, std::set<uint64_t> &Devices, std::set<uint64_t> &Scenes);
+	// sequence as it was at the start of the given second (for lastupdate polling), 0 when the journal does not go back that far
+	uint64_t GetDeviceChangeSequenceAt(time_t tTime);
+
+	void FlushDeviceWrites();
+	void GetStatementStats(Json::Value &root);
+	void GetDeviceWriteStats(int &IntervalMs, int &MaxRows, uint64_t &commits, uint64_t &rows, size_t &pending);
+
       public:
 	std::string m_LastSwitchID; // for learning command
 	std::string m_UniqueID;
@@ -496,6 +597,7 @@ class CSQLHelper : public StoppableTask
 	int m_ShortLogInterval;
 	bool m_bShortLogAddOnlyNewValues;
 	bool m_bLogEventScriptTrigger;
+	bool m_bLuaPersistentStates;
 	bool m_bDisableDzVentsSystem;
 	double m_max_kwh_usage;
 
@@ -512,6 +614,107 @@ class CSQLHelper : public StoppableTask
 	float m_iAcceptHardwareTimerCounter;
 	bool m_bPreviousAcceptNewHardware;
 
+	// DeviceStatus cache, key: HardwareID|DeviceID|Unit|Type|SubType
+	std::mutex m_device_cache_mutex;
+	std::map<std::string, _tDeviceStatusCacheItem> m_device_cache;
+	std::map<uint64_t, std::string> m_device_cache_idx;
+	uint64_t m_device_cache_generation = 0;
+	uint64_t m_device_cache_hits = 0;
+	uint64_t m_device_cache_misses = 0;
+	bool GetDeviceStatusCacheItem(int HardwareID, const char *ID, unsigned char unit, unsigned char devType, unsigned char subType, _tDeviceStatusCacheItem &dItem);
+	void SetDeviceStatusCacheValue(uint64_t idx, int nValue, const std::string &sValue, const std::string &sLastUpdate);
+	// Log data generations, all taken from one counter so the highest of the global and the device one is the current one
+	std::mutex m_log_data_mutex;
+	uint64_t m_log_data_generation = 0;
+	uint64_t m_log_data_global_generation = 0; // preferences, database restore
+	std::unordered_map<uint64_t, uint64_t> m_device_log_data_generation;
+	bool m_bLogDataTriggers = false; // log tables report their DeviceRowID through dz_log_data_changed()
+	void SetLogDataChanged(uint64_t DeviceRowIdx); // 0: all devices
+	void CreateLogDataTriggers();
+	static void LogDataChangedFunction(sqlite3_context *context, int argc, sqlite3_value **argv);
+	std::atomic<uint64_t> m_hardware_data_generation{ 0 };
+
+	// Preferences cache, holds the complete table once loaded
+	std::mutex m_preferences_mutex;
+	std::map<std::string, _tPreferencesCacheItem> m_preferences;
+	bool m_preferences_loaded = false;
+	uint64_t m_preferences_generation = 0;
+	std::mutex m_preferences_callback_mutex;
+	std::map<int, std::pair<std::string, PreferencesCallback>> m_preferences_callbacks;
+	int m_preferences_callback_id = 0;
+	bool GetPreferencesCacheItem(const std::string &Key, _tPreferencesCacheItem &pItem);
+	void NotifyPreferencesChanged(const std::string &Key);
+
+	static void DatabaseUpdateHook(void *pUserData, int op, const char *zDb, const char *zTable, long long rowid);
+
+	// Device change journal, rows map to the sequence of their last change
+	std::mutex m_device_journal_mutex;
+	uint64_t m_device_journal_sequence = 0;
+	uint64_t m_device_journal_floor = 0; // last change that can not be tracked per row
+	std::map<uint64_t, uint64_t> m_device_journal_devices;
+	std::map<uint64_t, uint64_t> m_device_journal_scenes;
+	std::deque<std::pair<time_t, uint64_t>> m_device_journal_times; // second of a change -> sequence before the first change in that second
+	time_t m_device_journal_times_start = 0;						 // m_device_journal_times is complete from this time on
+	void AddDeviceJournalChange(int op, const char *zTable, uint64_t rowid);
+	void ResetDeviceJournal();
+
+	// Group committed DeviceStatus/LightingLog writes (writer thread mode, disabled when interval is 0)
+	struct _tPendingDeviceUpdate
+	{
+		unsigned char signallevel;
+		unsigned char batterylevel;
+		int nValue;
+		std::string sValue;
+		std::string LastUpdate;
+	};
+	struct _tPendingLightingLog
+	{
+		uint64_t DeviceRowID;
+		int nValue;
+		std::string sValue;
+		std::string User;
+		std::string Date;
+	};
+	int m_device_write_interval = 0;
+	int m_device_write_max_rows = 100;
+	std::mutex m_device_write_mutex;
+	std::condition_variable m_device_write_cond;
+	std::map<uint64_t, _tPendingDeviceUpdate> m_device_write_updates;
+	std::vector<_tPendingLightingLog> m_device_write_lightinglog;
+	std::atomic<size_t> m_device_write_pending{ 0 };
+	uint64_t m_device_write_commits = 0;
+	uint64_t m_device_write_rows = 0;
+	bool m_device_write_stop = false;
+	std::shared_ptr<std::thread> m_device_write_thread;
+	void Do_Work_DeviceWriter();
+	bool QueueDeviceUpdate(uint64_t idx, unsigned char signallevel, unsigned char batterylevel, int nValue, const std::string &sValue, const std::string &sLastUpdate);
+	bool QueueLightingLog(uint64_t idx, int nValue, const std::string &sValue, const std::string &User);
+	void FlushDeviceWritesInt();
+	void ClearDeviceWrites();
+
+	// Prepared statement cache (LRU), protected by m_sqlQueryMutex
+	struct _tStatementStats
+	{
+		uint64_t calls = 0;
+		uint64_t prepares = 0;
+		uint64_t total_us = 0;
+	};
+	typedef std::list<std::pair<std::string, sqlite3_stmt *>> TStatementList;
+	TStatementList m_statement_cache;
+	std::unordered_map<std::string, TStatementList::iterator> m_statement_cache_index;
+	std::map<std::string, _tStatementStats> m_statement_stats;
+	std::mutex m_statement_stats_mutex;
+	sqlite3_stmt *GetCachedStatement(const std::string &szSQL);
+	void ClearStatementCache();
+	std::vector<std::vector<std::string>> bind_query_int(const char *szSQL, const _tSQLParam *params, size_t nparams);
+	std::vector<std::vector<std::string>> bind_query_nolock_int(const char *szSQL, const _tSQLParam *params, size_t nparams);
+	// Same as bind_query, m_sqlQueryMutex has to be locked by the caller
+	template <typename... Args> std::vector<std::vector<std::string>> bind_query_nolock(const char *szSQL, const Args &...args)
+	{
+		const _tSQLParam params[] = { _tSQLParam(args)..., _tSQLParam() };
+		return bind_query_nolock_int(szSQL, params, sizeof...(Args));
+	}
+
 	std::vector<_tTaskItem> m_background_task_queue;
 	std::shared_ptr<std::thread> m_thread;
 	std::mutex m_background_task_mutex;
@@ -541,22 +744,64 @@ class CSQLHelper : public StoppableTask
 
 	void CleanupLightSceneLog();
 
-	void UpdateTemperatureLog();
-	void UpdateRainLog();
-	void UpdateWindLog();
-	void UpdateUVLog();
-	void UpdateMeter();
-	void UpdateMultiMeter();
-	void UpdatePercentageLog();
-	void UpdateFanLog();
-	void AddCalendarTemperature();
-	void AddCalendarUpdateRain();
-	void AddCalendarUpdateWind();
-	void AddCalendarUpdateUV();
-	void AddCalendarUpdateMeter();
-	void AddCalendarUpdateMultiMeter();
-	void AddCalendarUpdatePercentage();
-	void AddCalendarUpdateFan();
+	// Short log sampling, one DeviceStatus scan dispatched to the samplers below, written in one transaction
+	struct _tShortLogDevice
+	{
+		uint64_t ID;
+		std::string Name;
+		int HardwareID;
+		std::string DeviceID;
+		unsigned char Unit;
+		unsigned char devType;
+		unsigned char subType;
+		int nValue;
+		std::string sValue;
+		std::string Options;
+		double age; // seconds since LastUpdate
+	};
+	// flat rows of typed values, one vector per log table
+	struct _tShortLogSamples
+	{
+		std::vector<_tSQLParam> Temperature;
+		std::vector<_tSQLParam> Rain;
+		std::vector<_tSQLParam> Wind;
+		std::vector<_tSQLParam> UV;
+		std::vector<_tSQLParam> Meter;
+		std::vector<_tSQLParam> MultiMeter;
+		std::vector<_tSQLParam> Percentage;
+		std::vector<_tSQLParam> Fan;
+	};
+	void UpdateShortLog();
+	void InsertShortLogSamples(const char *szTable, const char *szColumns, size_t nColumns, const std::vector<_tSQLParam> &samples);
+	bool IsShortLogSensorActive(const _tShortLogDevice &dev, int SensorTimeOut);
+	void UpdateTemperatureLog(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdateRainLog(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdateWindLog(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdateUVLog(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdateMeter(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdateMultiMeter(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdatePercentageLog(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	void UpdateFanLog(const _tShortLogDevice &dev, int SensorTimeOut, std::vector<_tSQLParam> &samples);
+	// Daily calendar rollups, run inside one transaction with m_sqlQueryMutex locked, they return the number of inserted rows
+	struct _tCalendarNotification
+	{
+		uint64_t ID;
+		std::string Name;
+		unsigned char devType;
+		unsigned char subType;
+		_eMeterType metertype;
+		double usage;
+		bool bMultiMeter;
+	};
+	int AddCalendarTemperature(const std::string &szDateStart, const std::string &szDateEnd);
+	int AddCalendarUpdateRain(const std::string &szDateStart, const std::string &szDateEnd);
+	int AddCalendarUpdateWind(const std::string &szDateStart, const std::string &szDateEnd);
+	int AddCalendarUpdateUV(const std::string &szDateStart, const std::string &szDateEnd);
+	int AddCalendarUpdateMeter(const std::string &szDateStart, const std::string &szDateEnd, std::vector<_tCalendarNotification> &notifications, std::vector<uint64_t> &influxdevices);
+	int AddCalendarUpdateMultiMeter(const std::string &szDateStart, const std::string &szDateEnd, std::vector<_tCalendarNotification> &notifications);
+	int AddCalendarUpdatePercentage(const std::string &szDateStart, const std::string &szDateEnd);
+	int AddCalendarUpdateFan(const std::string &szDateStart, const std::string &szDateEnd);
+	void HandleCalendarNotifications(const std::vector<_tCalendarNotification> &notifications);
 	void CleanupShortLog();
 	bool CheckDate(const std::string &sDate, int &d, int &m, int &y);
 	bool CheckDateSQL(const std::string &sDate);
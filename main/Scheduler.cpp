@@ -39,6 +39,11 @@ void CScheduler::StopScheduler()
 	if (m_thread)
 	{
 		RequestStop();
+		{
+			std::lock_guard<std::mutex> l(m_mutex);
+			m_bScheduleChanged = true;
+		}
+		m_cond.notify_all();
 		m_thread->join();
 		m_thread.reset();
 	}
@@ -50,6 +55,45 @@ std::vector<tScheduleItem> CScheduler::GetScheduleItems()
 	return std::vector<tScheduleItem>{ m_scheduleitems };
 }
 
+std::vector<tScheduleItem> CScheduler::GetUpcomingScheduleItems(const size_t count)
+{
+	std::vector<tScheduleItem> items;
+	std::lock_guard<std::mutex> l(m_mutex);
+	auto queue = m_schedulequeue;
+	while ((!queue.empty()) && (items.size() < count))
+	{
+		const tScheduleItem &item = m_scheduleitems[queue.top().second];
+		if ((item.bEnabled) && (item.startTime == queue.top().first))
+			items.push_back(item);
+		queue.pop();
+	}
+	return items;
+}
+
+void CScheduler::RebuildScheduleQueue()
+{
+	//Caller holds m_mutex
+	m_schedulequeue = decltype(m_schedulequeue)();
+	for (size_t ii = 0; ii < m_scheduleitems.size(); ii++)
+	{
+		if (m_scheduleitems[ii].bEnabled)
+			m_schedulequeue.push(std::make_pair(m_scheduleitems[ii].startTime, ii));
+	}
+}
+
+time_t CScheduler::GetNextScheduleTime()
+{
+	//Caller holds m_mutex, skips entries of items that have been rescheduled or disabled
+	while (!m_schedulequeue.empty())
+	{
+		const tScheduleItem &item = m_scheduleitems[m_schedulequeue.top().second];
+		if ((item.bEnabled) && (item.startTime == m_schedulequeue.top().first))
+			return m_schedulequeue.top().first;
+		m_schedulequeue.pop();
+	}
+	return 0;
+}
+
 void CScheduler::ReloadSchedules()
 {
 	std::lock_guard<std::mutex> l(m_mutex);
@@ -334,6 +378,10 @@ void CScheduler::ReloadSchedules()
 				m_scheduleitems.push_back(titem);
 		}
 	}
+
+	RebuildScheduleQueue();
+	m_bScheduleChanged = true;
+	m_cond.notify_all();
 }
 
 void CScheduler::SetSunRiseSetTimers(const std::string &sSunRise, const std::string &sSunSet, const std::string &sSunAtSouth, const std::string &sCivTwStart, const std::string &sCivTwEnd, const std::string &sNautTwStart, const std::string &sNautTwEnd, const std::string &sAstTwStart, const std::string &sAstTwEnd)
@@ -686,22 +734,34 @@ bool CScheduler::AdjustScheduleItem(tScheduleItem *pItem, bool bForceAddDay)
 
 void CScheduler::Do_Work()
 {
-	while (!IsStopRequested(1000))
+	time_t lastHeartbeat = 0;
+	time_t lastMinute = mytime(nullptr) / 60;
+	while (!IsStopRequested(0))
 	{
 		time_t atime = mytime(nullptr);
-		struct tm ltime;
-		localtime_r(&atime, &ltime);
-
 
-		if (ltime.tm_sec % 12 == 0) {
+		if (atime - lastHeartbeat >= 12) {
 			m_mainworker.HeartbeatUpdate("Scheduler");
+			lastHeartbeat = atime;
 		}
 
 		CheckSchedules();
 
-		if (ltime.tm_sec == 0) {
+		if (atime / 60 != lastMinute) {
+			lastMinute = atime / 60;
 			DeleteExpiredTimers();
 		}
+
+		//Sleep until the next item is due (items fire the second after their startTime), the next heartbeat or the next minute
+		std::unique_lock<std::mutex> l(m_mutex);
+		atime = mytime(nullptr);
+		time_t wakeTime = std::min(lastHeartbeat + 12, (atime / 60 + 1) * 60);
+		time_t nextTime = GetNextScheduleTime();
+		if ((nextTime != 0) && (nextTime + 1 < wakeTime))
+			wakeTime = nextTime + 1;
+		if (wakeTime > atime)
+			m_cond.wait_for(l, std::chrono::seconds(wakeTime - atime), [this] { return m_bScheduleChanged; });
+		m_bScheduleChanged = false;
 	}
 	_log.Log(LOG_STATUS, "Scheduler stopped...");
 }
@@ -714,231 +774,243 @@ void CScheduler::CheckSchedules()
 	struct tm ltime;
 	localtime_r(&atime, &ltime);
 
-	for (auto &item : m_scheduleitems)
+	//Only the items that are due are taken from the queue, and put back with their new startTime
+	std::vector<size_t> rescheduled;
+	while (true)
 	{
-		if ((item.bEnabled) && (atime > item.startTime))
+		time_t nextTime = GetNextScheduleTime();
+		if ((nextTime == 0) || (atime <= nextTime))
+			break;
+		size_t itemIdx = m_schedulequeue.top().second;
+		m_schedulequeue.pop();
+		rescheduled.push_back(itemIdx);
+
+		tScheduleItem &item = m_scheduleitems[itemIdx];
+		//check if we are on a valid day
+		bool bOkToFire = false;
+		if (item.timerType == TTYPE_FIXEDDATETIME)
+		{
+			bOkToFire = true;
+		}
+		else if (item.timerType == TTYPE_DAYSODD)
+		{
+			bOkToFire = (ltime.tm_mday % 2 != 0);
+		}
+		else if (item.timerType == TTYPE_DAYSEVEN)
+		{
+			bOkToFire = (ltime.tm_mday % 2 == 0);
+		}
+		else
 		{
-			//check if we are on a valid day
-			bool bOkToFire = false;
-			if (item.timerType == TTYPE_FIXEDDATETIME)
+			if (item.Days & 0x80)
 			{
+				//everyday
 				bOkToFire = true;
 			}
-			else if (item.timerType == TTYPE_DAYSODD)
+			else if (item.Days & 0x100)
 			{
-				bOkToFire = (ltime.tm_mday % 2 != 0);
+				//weekdays
+				if ((ltime.tm_wday > 0) && (ltime.tm_wday < 6))
+					bOkToFire = true;
 			}
-			else if (item.timerType == TTYPE_DAYSEVEN)
+			else if (item.Days & 0x200)
 			{
-				bOkToFire = (ltime.tm_mday % 2 == 0);
+				//weekends
+				if ((ltime.tm_wday == 0) || (ltime.tm_wday == 6))
+					bOkToFire = true;
 			}
 			else
 			{
-				if (item.Days & 0x80)
-				{
-					//everyday
-					bOkToFire = true;
-				}
-				else if (item.Days & 0x100)
-				{
-					//weekdays
-					if ((ltime.tm_wday > 0) && (ltime.tm_wday < 6))
-						bOkToFire = true;
-				}
-				else if (item.Days & 0x200)
-				{
-					//weekends
-					if ((ltime.tm_wday == 0) || (ltime.tm_wday == 6))
-						bOkToFire = true;
-				}
-				else
+				//custom days
+				if ((item.Days & 0x01) && (ltime.tm_wday == 1))
+					bOkToFire = true;//Monday
+				if ((item.Days & 0x02) && (ltime.tm_wday == 2))
+					bOkToFire = true;//Tuesday
+				if ((item.Days & 0x04) && (ltime.tm_wday == 3))
+					bOkToFire = true;//Wednesday
+				if ((item.Days & 0x08) && (ltime.tm_wday == 4))
+					bOkToFire = true;//Thursday
+				if ((item.Days & 0x10) && (ltime.tm_wday == 5))
+					bOkToFire = true;//Friday
+				if ((item.Days & 0x20) && (ltime.tm_wday == 6))
+					bOkToFire = true;//Saturday
+				if ((item.Days & 0x40) && (ltime.tm_wday == 0))
+					bOkToFire = true;//Sunday
+			}
+			if (bOkToFire)
+			{
+				if ((item.timerType == TTYPE_WEEKSODD) || (item.timerType == TTYPE_WEEKSEVEN))
 				{
-					//custom days
-					if ((item.Days & 0x01) && (ltime.tm_wday == 1))
-						bOkToFire = true;//Monday
-					if ((item.Days & 0x02) && (ltime.tm_wday == 2))
-						bOkToFire = true;//Tuesday
-					if ((item.Days & 0x04) && (ltime.tm_wday == 3))
-						bOkToFire = true;//Wednesday
-					if ((item.Days & 0x08) && (ltime.tm_wday == 4))
-						bOkToFire = true;//Thursday
-					if ((item.Days & 0x10) && (ltime.tm_wday == 5))
-						bOkToFire = true;//Friday
-					if ((item.Days & 0x20) && (ltime.tm_wday == 6))
-						bOkToFire = true;//Saturday
-					if ((item.Days & 0x40) && (ltime.tm_wday == 0))
-						bOkToFire = true;//Sunday
+					struct tm timeinfo;
+					localtime_r(&item.startTime, &timeinfo);
+
+					boost::gregorian::date d = boost::gregorian::date(
+						timeinfo.tm_year + 1900,
+						timeinfo.tm_mon + 1,
+						timeinfo.tm_mday);
+					int w = d.week_number();
+
+					if (item.timerType == TTYPE_WEEKSODD)
+						bOkToFire = (w % 2 != 0);
+					else
+						bOkToFire = (w % 2 == 0);
 				}
-				if (bOkToFire)
+			}
+		}
+		if (bOkToFire)
+		{
+			char ltimeBuf[30];
+			strftime(ltimeBuf, sizeof(ltimeBuf), "%Y-%m-%d %H:%M:%S", &ltime);
+
+			if (item.bIsScene == true)
+				_log.Log(LOG_STATUS, "Schedule item started! Name: %s, Type: %s, SceneID: %" PRIu64 ", Time: %s",
+					 item.DeviceName.c_str(), Timer_Type_Desc(item.timerType), item.RowID, ltimeBuf);
+			else if (item.bIsThermostat == true)
+				_log.Log(LOG_STATUS,
+					 "Schedule item started! Name: %s, Type: %s, ThermostatID: %" PRIu64 ", Time: %s",
+					 item.DeviceName.c_str(), Timer_Type_Desc(item.timerType), item.RowID, ltimeBuf);
+			else
+				_log.Log(LOG_STATUS, "Schedule item started! Name: %s, Type: %s, DevID: %" PRIu64 ", Time: %s",
+					 item.DeviceName.c_str(), Timer_Type_Desc(item.timerType), item.RowID, ltimeBuf);
+			std::string switchcmd;
+			if (item.timerCmd == TCMD_ON)
+				switchcmd = "On";
+			else if (item.timerCmd == TCMD_OFF)
+				switchcmd = "Off";
+			if (switchcmd.empty())
+			{
+				_log.Log(LOG_ERROR, "Unknown switch command in timer!!....");
+			}
+			else
+			{
+				if (item.bIsScene == true)
 				{
-					if ((item.timerType == TTYPE_WEEKSODD) || (item.timerType == TTYPE_WEEKSEVEN))
+					/*
+											if (
+												(item.timerType ==
+					   TTYPE_BEFORESUNRISE) || (item.timerType == TTYPE_AFTERSUNRISE) || (item.timerType ==
+					   TTYPE_BEFORESUNSET) || (item.timerType == TTYPE_AFTERSUNSET)
+												)
+											{
+
+											}
+					*/
+					if (!m_mainworker.SwitchScene(item.RowID, switchcmd, "timer"))
 					{
-						struct tm timeinfo;
-						localtime_r(&item.startTime, &timeinfo);
-
-						boost::gregorian::date d = boost::gregorian::date(
-							timeinfo.tm_year + 1900,
-							timeinfo.tm_mon + 1,
-							timeinfo.tm_mday);
-						int w = d.week_number();
-
-						if (item.timerType == TTYPE_WEEKSODD)
-							bOkToFire = (w % 2 != 0);
-						else
-							bOkToFire = (w % 2 == 0);
+						_log.Log(LOG_ERROR, "Error switching Scene command, SceneID: %" PRIu64 ", Time: %s",
+							 item.RowID, ltimeBuf);
 					}
 				}
-			}
-			if (bOkToFire)
-			{
-				char ltimeBuf[30];
-				strftime(ltimeBuf, sizeof(ltimeBuf), "%Y-%m-%d %H:%M:%S", &ltime);
-
-				if (item.bIsScene == true)
-					_log.Log(LOG_STATUS, "Schedule item started! Name: %s, Type: %s, SceneID: %" PRIu64 ", Time: %s",
-						 item.DeviceName.c_str(), Timer_Type_Desc(item.timerType), item.RowID, ltimeBuf);
 				else if (item.bIsThermostat == true)
-					_log.Log(LOG_STATUS,
-						 "Schedule item started! Name: %s, Type: %s, ThermostatID: %" PRIu64 ", Time: %s",
-						 item.DeviceName.c_str(), Timer_Type_Desc(item.timerType), item.RowID, ltimeBuf);
-				else
-					_log.Log(LOG_STATUS, "Schedule item started! Name: %s, Type: %s, DevID: %" PRIu64 ", Time: %s",
-						 item.DeviceName.c_str(), Timer_Type_Desc(item.timerType), item.RowID, ltimeBuf);
-				std::string switchcmd;
-				if (item.timerCmd == TCMD_ON)
-					switchcmd = "On";
-				else if (item.timerCmd == TCMD_OFF)
-					switchcmd = "Off";
-				if (switchcmd.empty())
 				{
-					_log.Log(LOG_ERROR, "Unknown switch command in timer!!....");
+					std::stringstream sstr;
+					sstr << item.RowID;
+					if (!m_mainworker.SetSetPoint(sstr.str(), item.Temperature))
+					{
+						_log.Log(LOG_ERROR,
+							 "Error setting thermostat setpoint, ThermostatID: %" PRIu64 ", Time: %s",
+							 item.RowID, ltimeBuf);
+					}
 				}
 				else
 				{
-					if (item.bIsScene == true)
-					{
-						/*
-												if (
-													(item.timerType ==
-						   TTYPE_BEFORESUNRISE) || (item.timerType == TTYPE_AFTERSUNRISE) || (item.timerType ==
-						   TTYPE_BEFORESUNSET) || (item.timerType == TTYPE_AFTERSUNSET)
-													)
-												{
-
-												}
-						*/
-						if (!m_mainworker.SwitchScene(item.RowID, switchcmd, "timer"))
-						{
-							_log.Log(LOG_ERROR, "Error switching Scene command, SceneID: %" PRIu64 ", Time: %s",
-								 item.RowID, ltimeBuf);
-						}
-					}
-					else if (item.bIsThermostat == true)
+					//Get SwitchType
+					std::vector<std::vector<std::string> > result;
+					result = m_sql.safe_query(
+						"SELECT Type,SubType,SwitchType FROM DeviceStatus WHERE (ID == %" PRIu64 ")",
+						item.RowID);
+					if (!result.empty())
 					{
-						std::stringstream sstr;
-						sstr << item.RowID;
-						if (!m_mainworker.SetSetPoint(sstr.str(), item.Temperature))
+						std::vector<std::string> sd = result[0];
+
+						unsigned char dType = atoi(sd[0].c_str());
+						unsigned char dSubType = atoi(sd[1].c_str());
+						_eSwitchType switchtype = (_eSwitchType)atoi(sd[2].c_str());
+						std::string lstatus;
+						int llevel = 0;
+						bool bHaveDimmer = false;
+						bool bHaveGroupCmd = false;
+						int maxDimLevel = 0;
+
+						GetLightStatus(dType, dSubType, switchtype, 0, "", lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+						int ilevel = maxDimLevel;
+						if (switchtype == STYPE_Blinds)
 						{
-							_log.Log(LOG_ERROR,
-								 "Error setting thermostat setpoint, ThermostatID: %" PRIu64 ", Time: %s",
-								 item.RowID, ltimeBuf);
+							if (item.timerCmd == TCMD_ON)
+								switchcmd = "Open";
+							else if (item.timerCmd == TCMD_OFF)
+								switchcmd = "Close";
 						}
-					}
-					else
-					{
-						//Get SwitchType
-						std::vector<std::vector<std::string> > result;
-						result = m_sql.safe_query(
-							"SELECT Type,SubType,SwitchType FROM DeviceStatus WHERE (ID == %" PRIu64 ")",
-							item.RowID);
-						if (!result.empty())
+						else if (
+							(switchtype == STYPE_BlindsPercentage)
+							|| (switchtype == STYPE_BlindsPercentageWithStop)
+							)
 						{
-							std::vector<std::string> sd = result[0];
-
-							unsigned char dType = atoi(sd[0].c_str());
-							unsigned char dSubType = atoi(sd[1].c_str());
-							_eSwitchType switchtype = (_eSwitchType)atoi(sd[2].c_str());
-							std::string lstatus;
-							int llevel = 0;
-							bool bHaveDimmer = false;
-							bool bHaveGroupCmd = false;
-							int maxDimLevel = 0;
-
-							GetLightStatus(dType, dSubType, switchtype, 0, "", lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-							int ilevel = maxDimLevel;
-							if (switchtype == STYPE_Blinds)
+							if (item.timerCmd == TCMD_ON)
+							{
+								switchcmd = "Set Level";
+								float fLevel = (maxDimLevel / 100.0F) * item.Level;
+								if (fLevel > 100)
+									fLevel = 100;
+								ilevel = int(fLevel);
+							}
+							else if (item.timerCmd == TCMD_OFF)
 							{
-								if (item.timerCmd == TCMD_ON)
-									switchcmd = "Open";
-								else if (item.timerCmd == TCMD_OFF)
-									switchcmd = "Close";
+								switchcmd = "Close";
+								ilevel = 0;
 							}
-							else if (
-								(switchtype == STYPE_BlindsPercentage)
-								|| (switchtype == STYPE_BlindsPercentageWithStop)
-								)
+						}
+						else if ((switchtype == STYPE_Dimmer) && (maxDimLevel != 0))
+						{
+							if (item.timerCmd == TCMD_ON)
 							{
-								if (item.timerCmd == TCMD_ON)
-								{
-									switchcmd = "Set Level";
-									float fLevel = (maxDimLevel / 100.0F) * item.Level;
-									if (fLevel > 100)
-										fLevel = 100;
-									ilevel = int(fLevel);
-								}
-								else if (item.timerCmd == TCMD_OFF)
-								{
-									switchcmd = "Close";
-									ilevel = 0;
-								}
+								switchcmd = "Set Level";
+								float fLevel = (maxDimLevel / 100.0F) * item.Level;
+								if (fLevel > 100)
+									fLevel = 100;
+								ilevel = int(fLevel);
 							}
-							else if ((switchtype == STYPE_Dimmer) && (maxDimLevel != 0))
+						} else if (switchtype == STYPE_Selector) {
+							if (item.timerCmd == TCMD_ON)
 							{
-								if (item.timerCmd == TCMD_ON)
-								{
-									switchcmd = "Set Level";
-									float fLevel = (maxDimLevel / 100.0F) * item.Level;
-									if (fLevel > 100)
-										fLevel = 100;
-									ilevel = int(fLevel);
-								}
-							} else if (switchtype == STYPE_Selector) {
-								if (item.timerCmd == TCMD_ON)
-								{
-									switchcmd = "Set Level";
-									ilevel = item.Level;
-								}
-								else if (item.timerCmd == TCMD_OFF)
-								{
-									ilevel = 0; // force level to a valid value for Selector
-								}
+								switchcmd = "Set Level";
+								ilevel = item.Level;
 							}
-							if (!m_mainworker.SwitchLight(item.RowID, switchcmd, ilevel, item.Color, false, 0,
-										      "timer"))
+							else if (item.timerCmd == TCMD_OFF)
 							{
-								_log.Log(LOG_ERROR,
-									 "Error sending switch command, DevID: %" PRIu64 ", Time: %s",
-									 item.RowID, ltimeBuf);
+								ilevel = 0; // force level to a valid value for Selector
 							}
 						}
+						if (!m_mainworker.SwitchLight(item.RowID, switchcmd, ilevel, item.Color, false, 0,
+									      "timer"))
+						{
+							_log.Log(LOG_ERROR,
+								 "Error sending switch command, DevID: %" PRIu64 ", Time: %s",
+								 item.RowID, ltimeBuf);
+						}
 					}
 				}
 			}
-			if (!AdjustScheduleItem(&item, true))
+		}
+		if (!AdjustScheduleItem(&item, true))
+		{
+			//something is wrong, probably no sunset/rise
+			if (item.timerType != TTYPE_FIXEDDATETIME)
 			{
-				//something is wrong, probably no sunset/rise
-				if (item.timerType != TTYPE_FIXEDDATETIME)
-				{
-					item.startTime += atime + (24 * 3600);
-				}
-				else
-				{
-					//Disable timer
-					item.bEnabled = false;
-				}
+				item.startTime += atime + (24 * 3600);
+			}
+			else
+			{
+				//Disable timer
+				item.bEnabled = false;
 			}
 		}
 	}
+	for (const auto itemIdx : rescheduled)
+	{
+		if (m_scheduleitems[itemIdx].bEnabled)
+			m_schedulequeue.push(std::make_pair(m_scheduleitems[itemIdx].startTime, itemIdx));
+	}
 }
 
 void CScheduler::DeleteExpiredTimers()
@@ -1130,6 +1202,36 @@ namespace http {
 				}
 			}
 		}
+		void CWebServer::Cmd_GetUpcomingSchedules(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			int iCount = atoi(request::findValue(&req, "count").c_str());
+			if (iCount < 1)
+				iCount = 10;
+
+			root["status"] = "OK";
+			root["title"] = "GetUpcomingSchedules";
+
+			std::vector<tScheduleItem> schedules = m_mainworker.m_scheduler.GetUpcomingScheduleItems(iCount);
+			int ii = 0;
+			for (const auto &item : schedules)
+			{
+				char ltimeBuf[30];
+				struct tm timeinfo;
+				localtime_r(&item.startTime, &timeinfo);
+				strftime(ltimeBuf, sizeof(ltimeBuf), "%Y-%m-%d %H:%M:%S", &timeinfo);
+
+				root["result"][ii]["TimerID"] = (Json::UInt64)item.TimerID;
+				root["result"][ii]["Type"] = item.bIsScene ? "Scene" : "Device";
+				root["result"][ii]["IsThermostat"] = item.bIsThermostat ? "true" : "false";
+				root["result"][ii]["DevName"] = item.DeviceName;
+				root["result"][ii]["DeviceRowID"] = (Json::UInt64)item.RowID;
+				root["result"][ii]["TimerType"] = item.timerType;
+				root["result"][ii]["TimerTypeStr"] = Timer_Type_Desc(item.timerType);
+				root["result"][ii]["ScheduleDate"] = ltimeBuf;
+				ii++;
+			}
+		}
+
 		void CWebServer::RType_Timers(WebEmSession & session, const request& req, Json::Value &root)
 		{
 			uint64_t idx = 0;
@@ -3,6 +3,8 @@
 #include "RFXNames.h"
 #include "../hardware/hardwaretypes.h"
 #include <string>
+#include <queue>
+#include <condition_variable>
 #include "StoppableTask.h"
 
 struct tScheduleItem
@@ -77,6 +79,7 @@ public:
 			   const std::string &sNautTwStart, const std::string &sNauTtwEnd, const std::string &sAstTwStart, const std::string &sAstTwEnd);
 
   std::vector<tScheduleItem> GetScheduleItems();
+  std::vector<tScheduleItem> GetUpcomingScheduleItems(size_t count);
 
 private:
 	time_t m_tSunRise;
@@ -89,8 +92,13 @@ private:
 	time_t m_tAstTwStart;
 	time_t m_tAstTwEnd;
 	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	bool m_bScheduleChanged = false;
 	std::shared_ptr<std::thread> m_thread;
 	std::vector<tScheduleItem> m_scheduleitems;
+	//startTime and index in m_scheduleitems, earliest first
+	typedef std::pair<time_t, size_t> tScheduleQueueItem;
+	std::priority_queue<tScheduleQueueItem, std::vector<tScheduleQueueItem>, std::greater<tScheduleQueueItem>> m_schedulequeue;
 
 	//our thread
 	void Do_Work();
@@ -100,6 +108,8 @@ private:
 	bool AdjustScheduleItem(tScheduleItem *pItem, bool bForceAddDay);
 	//will check if anything needs to be scheduled
 	void CheckSchedules();
+	void RebuildScheduleQueue();
+	time_t GetNextScheduleTime();
 	void DeleteExpiredTimers();
 };
 
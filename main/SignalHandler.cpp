@@ -427,6 +427,7 @@ void signal_handler(int sig_num
 #endif
 		tid = syscall(__NR_gettid);
 #endif
+		_log.DisableAsyncWriter();
 		if (fatal_handling) {
 #if defined(__GLIBC__)
 			_log.Log(LOG_ERROR, "Domoticz(pid:%d, tid:%ld('%s')) received fatal signal %d (%s) while backtracing", getpid(), tid, thread_name, sig_num
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <stdarg.h>
 #include "mainworker.h"
+#include "IoContextPool.h"
 #include "Helper.h"
 #include "localtime_r.h"
 #include "EventSystem.h"
@@ -74,6 +75,8 @@
 
 #define round(a) (int)(a + .5)
 
+#define GRAPH_CACHE_MAX_ITEMS 200
+
 extern std::string szStartupFolder;
 extern std::string szUserDataFolder;
 extern std::string szWWWFolder;
@@ -412,6 +415,15 @@ namespace http
 			RegisterCommandCode(
 				"getuptime", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetUptime(session, req, root); }, true);
 
+			RegisterCommandCode("getsqlstats", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetSQLStats(session, req, root); });
+			RegisterCommandCode("getluastats", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetLuaStats(session, req, root); });
+			RegisterCommandCode("gethttpclientstats", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetHTTPClientStats(session, req, root); });
+			RegisterCommandCode("getrxqueuestats", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetRxQueueStats(session, req, root); });
+			RegisterCommandCode("getiopoolstats", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetIoPoolStats(session, req, root); });
+#ifdef ENABLE_PYTHON
+			RegisterCommandCode("getpluginstats", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetPluginStats(session, req, root); });
+#endif
+
 			RegisterCommandCode("storesettings", [this](auto&& session, auto&& req, auto&& root) { Cmd_PostSettings(session, req, root); });
 			RegisterCommandCode("getlog", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetLog(session, req, root); });
 			RegisterCommandCode("clearlog", [this](auto&& session, auto&& req, auto&& root) { Cmd_ClearLog(session, req, root); });
@@ -527,6 +539,7 @@ namespace http
 			RegisterCommandCode("changeplandeviceorder", [this](auto&& session, auto&& req, auto&& root) { Cmd_ChangePlanDeviceOrder(session, req, root); });
 
 			RegisterCommandCode("gettimerplans", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetTimerPlans(session, req, root); });
+			RegisterCommandCode("getupcomingschedules", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetUpcomingSchedules(session, req, root); });
 			RegisterCommandCode("addtimerplan", [this](auto&& session, auto&& req, auto&& root) { Cmd_AddTimerPlan(session, req, root); });
 			RegisterCommandCode("updatetimerplan", [this](auto&& session, auto&& req, auto&& root) { Cmd_UpdateTimerPlan(session, req, root); });
 			RegisterCommandCode("deletetimerplan", [this](auto&& session, auto&& req, auto&& root) { Cmd_DeleteTimerPlan(session, req, root); });
@@ -837,6 +850,16 @@ namespace http
 				HandleRType(rtype, session, req, root);
 			}
 
+			if (!session.reply_etag.empty())
+				reply::add_header(&rep, "ETag", session.reply_etag);
+			if (session.reply_status == reply::not_modified)
+			{
+				// The client already has this answer, a 304 has no body
+				rep.status = reply::not_modified;
+				rep.content.clear();
+				return;
+			}
+
 			std::string jcallback = request::findValue(&req, "jsoncallback");
 			if (!jcallback.empty())
 			{
@@ -2531,6 +2554,139 @@ namespace http
 			root["seconds"] = seconds;
 		}
 
+		void CWebServer::Cmd_GetSQLStats(WebEmSession& session, const request& req, Json::Value& root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; // Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetSQLStats";
+
+			uint64_t hits, misses;
+			size_t entries;
+			m_sql.GetDeviceStatusCacheStats(hits, misses, entries);
+			root["DeviceCache"]["hits"] = (Json::UInt64)hits;
+			root["DeviceCache"]["misses"] = (Json::UInt64)misses;
+			root["DeviceCache"]["entries"] = (Json::UInt64)entries;
+
+			int interval, maxrows;
+			uint64_t commits, rows;
+			size_t pending;
+			m_sql.GetDeviceWriteStats(interval, maxrows, commits, rows, pending);
+			root["DeviceWriter"]["enabled"] = (interval > 0);
+			root["DeviceWriter"]["interval"] = interval;
+			root["DeviceWriter"]["maxrows"] = maxrows;
+			root["DeviceWriter"]["commits"] = (Json::UInt64)commits;
+			root["DeviceWriter"]["rows"] = (Json::UInt64)rows;
+			root["DeviceWriter"]["pending"] = (Json::UInt64)pending;
+
+			m_sql.GetStatementStats(root["Statements"]);
+
+			std::lock_guard<std::mutex> l(m_graph_cache_mutex);
+			root["GraphCache"]["hits"] = (Json::UInt64)m_graph_cache_hits;
+			root["GraphCache"]["misses"] = (Json::UInt64)m_graph_cache_misses;
+			root["GraphCache"]["entries"] = (Json::UInt64)m_graph_cache.size();
+		}
+
+		void CWebServer::Cmd_GetLuaStats(WebEmSession& session, const request& req, Json::Value& root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; // Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetLuaStats";
+			root["persistent"] = m_sql.m_bLuaPersistentStates;
+			m_mainworker.m_eventsystem.GetLuaScriptStats(root["result"]);
+		}
+
+		void CWebServer::Cmd_GetHTTPClientStats(WebEmSession& session, const request& req, Json::Value& root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; // Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetHTTPClientStats";
+
+			std::vector<HTTPClient::_tHostStatistics> stats;
+			HTTPClient::GetHostStatistics(stats);
+			int ii = 0;
+			for (const auto& itt : stats)
+			{
+				root["result"][ii]["host"] = itt.host;
+				root["result"][ii]["requests"] = (Json::UInt64)itt.requests;
+				root["result"][ii]["failed"] = (Json::UInt64)itt.failed;
+				root["result"][ii]["reused"] = (Json::UInt64)itt.reused;
+				root["result"][ii]["reuse_ratio"] = (itt.requests > 0) ? round_digits(double(itt.reused) * 100.0 / double(itt.requests), 1) : 0.0;
+				root["result"][ii]["latency_p50"] = round_digits(itt.latency_p50, 1);
+				root["result"][ii]["latency_p90"] = round_digits(itt.latency_p90, 1);
+				root["result"][ii]["latency_p99"] = round_digits(itt.latency_p99, 1);
+				ii++;
+			}
+		}
+
+		void CWebServer::Cmd_GetRxQueueStats(WebEmSession& session, const request& req, Json::Value& root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; // Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetRxQueueStats";
+
+			std::vector<MainWorker::_tRxQueueStatistics> stats;
+			m_mainworker.GetRxQueueStatistics(stats);
+			root["threads"] = static_cast<int>(stats.size());
+			int ii = 0;
+			for (const auto& itt : stats)
+			{
+				root["result"][ii]["shard"] = ii;
+				root["result"][ii]["depth"] = (Json::UInt64)itt.depth;
+				root["result"][ii]["maxdepth"] = (Json::UInt64)itt.maxdepth;
+				root["result"][ii]["processed"] = (Json::UInt64)itt.processed;
+				for (size_t jj = 0; jj < itt.latency.size(); jj++)
+				{
+					root["result"][ii]["latency"][(int)jj]["max_ms"] = MainWorker::GetRxLatencyBucketLimit(jj);
+					root["result"][ii]["latency"][(int)jj]["count"] = (Json::UInt64)itt.latency[jj];
+				}
+				ii++;
+			}
+		}
+
+		void CWebServer::Cmd_GetIoPoolStats(WebEmSession& session, const request& req, Json::Value& root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; // Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetIoPoolStats";
+			root["enabled"] = m_iocontextpool.IsEnabled();
+			root["threads"] = m_iocontextpool.GetThreadCount();
+
+			std::vector<CIoContextPool::_tHandlerStatsSnapshot> stats;
+			m_iocontextpool.GetStatistics(stats);
+			// busiest drivers first
+			std::sort(stats.begin(), stats.end(), [](const CIoContextPool::_tHandlerStatsSnapshot& a, const CIoContextPool::_tHandlerStatsSnapshot& b) { return a.total_us > b.total_us; });
+			int ii = 0;
+			for (const auto& itt : stats)
+			{
+				root["result"][ii]["name"] = itt.label;
+				root["result"][ii]["handlers"] = (Json::UInt64)itt.handlers;
+				root["result"][ii]["total_ms"] = (Json::UInt64)(itt.total_us / 1000);
+				root["result"][ii]["max_ms"] = (Json::UInt64)(itt.max_us / 1000);
+				root["result"][ii]["avg_us"] = (Json::UInt64)((itt.handlers != 0) ? itt.total_us / itt.handlers : 0);
+				ii++;
+			}
+		}
+
 		void CWebServer::Cmd_GetActualHistory(WebEmSession& session, const request& req, Json::Value& root)
 		{
 			root["status"] = "OK";
@@ -8168,6 +8324,9 @@ namespace http
 				m_sql.m_bLogEventScriptTrigger = (request::findValue(&req, "LogEventScriptTrigger") == "on" ? 1 : 0);
 				m_sql.UpdatePreferencesVar("LogEventScriptTrigger", m_sql.m_bLogEventScriptTrigger); cntSettings++;
 
+				m_sql.m_bLuaPersistentStates = (request::findValue(&req, "LuaPersistentStates") == "on" ? 1 : 0);
+				m_sql.UpdatePreferencesVar("LuaPersistentStates", m_sql.m_bLuaPersistentStates); cntSettings++;
+
 				m_sql.m_bAllowWidgetOrdering = (request::findValue(&req, "AllowWidgetOrdering") == "on" ? 1 : 0);
 				m_sql.UpdatePreferencesVar("AllowWidgetOrdering", m_sql.m_bAllowWidgetOrdering); cntSettings++;
 
@@ -8415,7 +8574,7 @@ namespace http
 
 		void CWebServer::GetJSonDevices(Json::Value& root, const std::string& rused, const std::string& rfilter, const std::string& order, const std::string& rowid, const std::string& planID,
 			const std::string& floorID, const bool bDisplayHidden, const bool bDisplayDisabled, const bool bFetchFavorites, const time_t LastUpdate,
-			const std::string& username, const std::string& hardwareid)
+			const std::string& username, const std::string& hardwareid, const uint64_t LastChangeSeq)
 		{
 			std::vector<std::vector<std::string>> result;
 
@@ -8425,10 +8584,35 @@ namespace http
 			struct tm tLastUpdate;
 			localtime_r(&now, &tLastUpdate);
 
-			const time_t iLastUpdate = LastUpdate - 1;
+			time_t iLastUpdate = LastUpdate - 1;
+
+			// Incremental request, only rows the device journal has seen changing since the client's sequence
+			std::set<uint64_t> _ChangedDevices, _ChangedScenes;
+			bool bOnlyChanged = false;
+			if (LastChangeSeq != 0)
+			{
+				bOnlyChanged = m_sql.GetDeviceChangesSince(LastChangeSeq, _ChangedDevices, _ChangedScenes);
+				if (!bOnlyChanged)
+					root["FullRefresh"] = true;
+				iLastUpdate = 0; // the sequence replaces the timestamp filter
+			}
+			else if (LastUpdate != 0)
+			{
+				// Plain lastupdate polling is answered from the journal too while it goes back that far,
+				// this also reports rows that changed without a new LastUpdate (renamed, protected, ...)
+				uint64_t Sequence = m_sql.GetDeviceChangeSequenceAt(LastUpdate);
+				if ((Sequence != 0) && (m_sql.GetDeviceChangesSince(Sequence, _ChangedDevices, _ChangedScenes)))
+				{
+					bOnlyChanged = true;
+					iLastUpdate = 0;
+				}
+			}
 
 			int SensorTimeOut = 60;
 			m_sql.GetPreferencesVar("SensorTimeout", SensorTimeOut);
+			// Devices that timed out since the last request did not change, but their HaveTimeout did
+			const time_t iTimeoutSince = (LastUpdate != 0) ? LastUpdate - (SensorTimeOut * 60) : 0;
+			const time_t iTimeoutBefore = now - (SensorTimeOut * 60);
 
 			// Get All Hardware ID's/Names, need them later
 			std::map<int, _tHardwareListInt> _hardwareNames;
@@ -8582,6 +8766,9 @@ namespace http
 
 							std::string sLastUpdate = sd[3];
 
+							if ((bOnlyChanged) && (_ChangedScenes.find(std::stoull(sd[0])) == _ChangedScenes.end()))
+								continue;
+
 							if (iLastUpdate != 0)
 							{
 								time_t cLastUpdate;
@@ -8927,11 +9114,17 @@ namespace http
 					if (sLastUpdate.size() > 19)
 						sLastUpdate = sLastUpdate.substr(0, 19);
 
-					if (iLastUpdate != 0)
+					if ((bOnlyChanged) || (iLastUpdate != 0))
 					{
 						time_t cLastUpdate;
 						ParseSQLdatetime(cLastUpdate, tLastUpdate, sLastUpdate, tm1.tm_isdst);
-						if (cLastUpdate <= iLastUpdate)
+						bool bTimedOutSince = (iTimeoutSince != 0) && (cLastUpdate >= iTimeoutSince) && (cLastUpdate <= iTimeoutBefore);
+						if (bOnlyChanged)
+						{
+							if ((_ChangedDevices.find(std::stoull(sd[0])) == _ChangedDevices.end()) && (!bTimedOutSince))
+								continue;
+						}
+						else if ((cLastUpdate <= iLastUpdate) && (!bTimedOutSince))
 							continue;
 					}
 
@@ -11669,6 +11862,16 @@ namespace http
 
 			root["ActTime"] = static_cast<int>(now);
 
+			// lastupdate polling is answered from the device journal while it goes back that far,
+			// like the device list the LastUpdate second itself is included (a change in that second may have missed the last reply)
+			std::set<uint64_t> _ChangedDevices, _ChangedScenes;
+			bool bOnlyChanged = false;
+			if (LastUpdate != 0)
+			{
+				uint64_t Sequence = m_sql.GetDeviceChangeSequenceAt(LastUpdate);
+				bOnlyChanged = (Sequence != 0) && (m_sql.GetDeviceChangesSince(Sequence, _ChangedDevices, _ChangedScenes));
+			}
+
 			std::vector<std::vector<std::string>> result, result2;
 			std::string szQuery = "SELECT ID, Name, Activators, Favorite, nValue, SceneType, LastUpdate, Protected, OnAction, OffAction, Description FROM Scenes";
 			if (!rid.empty())
@@ -11685,11 +11888,16 @@ namespace http
 						continue;
 
 					std::string sLastUpdate = sd[6];
-					if (LastUpdate != 0)
+					if (bOnlyChanged)
+					{
+						if (_ChangedScenes.find(std::stoull(sd[0])) == _ChangedScenes.end())
+							continue;
+					}
+					else if (LastUpdate != 0)
 					{
 						time_t cLastUpdate;
 						ParseSQLdatetime(cLastUpdate, tLastUpdate, sLastUpdate, tm1.tm_isdst);
-						if (cLastUpdate <= LastUpdate)
+						if (cLastUpdate < LastUpdate)
 							continue;
 					}
 
@@ -11892,10 +12100,30 @@ namespace http
 				sstr >> LastUpdate;
 			}
 
+			// Incremental polling on the device journal sequence, answered with 304 while nothing changed
+			std::string sLastSeq = request::findValue(&req, "lastseq");
+			uint64_t LastChangeSeq = 0;
+			uint64_t ChangeSeq = m_sql.GetDeviceChangeSequence();
+			if (!sLastSeq.empty())
+			{
+				LastChangeSeq = std::strtoull(sLastSeq.c_str(), nullptr, 10);
+				// Sensor timeouts change HaveTimeout without a journal change, the minute (the unit of SensorTimeout) is part of the tag
+				const time_t TimeoutBucket = mytime(nullptr) / 60;
+				session.reply_etag = std_format("\"%" PRIu64 "-%" PRIu64 "-%08x\"", ChangeSeq, static_cast<uint64_t>(TimeoutBucket),
+								static_cast<unsigned int>(std::hash<std::string>()(session.username)));
+				const char* pIfNoneMatch = request::get_req_header(&req, "If-None-Match");
+				if ((pIfNoneMatch != nullptr) && (session.reply_etag == pIfNoneMatch))
+				{
+					session.reply_status = reply::not_modified;
+					return;
+				}
+			}
+
 			root["status"] = "OK";
 			root["title"] = "Devices";
 			root["app_version"] = szAppVersion;
-			GetJSonDevices(root, rused, rfilter, order, rid, planid, floorid, bDisplayHidden, bDisabledDisabled, bFetchFavorites, LastUpdate, session.username, hwidx);
+			root["ChangeSeq"] = (Json::UInt64)ChangeSeq;
+			GetJSonDevices(root, rused, rfilter, order, rid, planid, floorid, bDisplayHidden, bDisabledDisabled, bFetchFavorites, LastUpdate, session.username, hwidx, LastChangeSeq);
 		}
 
 		void CWebServer::RType_Users(WebEmSession& session, const request& req, Json::Value& root)
@@ -13378,6 +13606,10 @@ namespace http
 				{
 					root["LogEventScriptTrigger"] = nValue;
 				}
+				else if (Key == "LuaPersistentStates")
+				{
+					root["LuaPersistentStates"] = nValue;
+				}
 				else if (Key == "(1WireSensorPollPeriod")
 				{
 					root["1WireSensorPollPeriod"] = nValue;
@@ -13673,6 +13905,95 @@ namespace http
 		}
 
 		void CWebServer::RType_HandleGraph(WebEmSession& session, const request& req, Json::Value& root)
+		{
+			std::string sidx = request::findValue(&req, "idx");
+			std::string sensor = request::findValue(&req, "sensor");
+			if (sidx.empty() || sensor.empty())
+			{
+				GetGraphData(session, req, root);
+				return;
+			}
+
+			std::string szKey;
+			for (const char* szParam : { "idx", "sensor", "sensorarea", "range", "groupby", "actmonth", "actyear", "graphtype", "method", "graphTemp", "graphChill",
+				"graphHum", "graphBaro", "graphDew", "graphSet" })
+			{
+				szKey += request::findValue(&req, szParam);
+				szKey += "|";
+			}
+
+			//Graphs are rebuilt when the logs of the device or the preferences changed (generation), on a new day, or when the device was changed
+			//counter and rain graphs also include the actual device value
+			uint64_t generation = m_sql.GetLogDataGeneration(std::strtoull(sidx.c_str(), nullptr, 10));
+			std::string szVersion = TimeToString(nullptr, TF_Date);
+			std::vector<std::vector<std::string>> result;
+			result = m_sql.bind_query("SELECT sValue, SwitchType, AddjValue, AddjMulti, AddjValue2, Options FROM DeviceStatus WHERE (ID == ?)", sidx);
+			if (!result.empty())
+			{
+				for (size_t ii = ((sensor == "counter") || (sensor == "rain")) ? 0 : 1; ii < result[0].size(); ii++)
+					szVersion += "|" + result[0][ii];
+			}
+
+			std::shared_ptr<Json::Value> pGraph;
+			{
+				std::lock_guard<std::mutex> l(m_graph_cache_mutex);
+				auto itt = m_graph_cache_index.find(szKey);
+				if ((itt != m_graph_cache_index.end()) && (itt->second->second.generation == generation) && (itt->second->second.version == szVersion))
+				{
+					//move to front (most recently used)
+					m_graph_cache.splice(m_graph_cache.begin(), m_graph_cache, itt->second);
+					pGraph = itt->second->second.root;
+					m_graph_cache_hits++;
+				}
+			}
+			if (!pGraph)
+			{
+				pGraph = std::make_shared<Json::Value>();
+				GetGraphData(session, req, *pGraph);
+
+				std::lock_guard<std::mutex> l(m_graph_cache_mutex);
+				m_graph_cache_misses++;
+				auto itt = m_graph_cache_index.find(szKey);
+				if (itt != m_graph_cache_index.end())
+				{
+					itt->second->second = { generation, szVersion, pGraph };
+					m_graph_cache.splice(m_graph_cache.begin(), m_graph_cache, itt->second);
+				}
+				else
+				{
+					m_graph_cache.emplace_front(szKey, _tGraphCacheItem{ generation, szVersion, pGraph });
+					m_graph_cache_index[szKey] = m_graph_cache.begin();
+					if (m_graph_cache.size() > GRAPH_CACHE_MAX_ITEMS)
+					{
+						//evict least recently used
+						m_graph_cache_index.erase(m_graph_cache.back().first);
+						m_graph_cache.pop_back();
+					}
+				}
+			}
+
+			//Incremental request, only return the points after the given date/time
+			std::string since = request::findValue(&req, "since");
+			if (since.empty() || !pGraph->isMember("result"))
+			{
+				root = *pGraph;
+				return;
+			}
+			for (const auto& itt : pGraph->getMemberNames())
+			{
+				if (itt != "result")
+					root[itt] = (*pGraph)[itt];
+			}
+			root["since"] = since;
+			root["result"] = Json::Value(Json::arrayValue);
+			for (const auto& itt : (*pGraph)["result"])
+			{
+				if (itt["d"].asString() > since)
+					root["result"].append(itt);
+			}
+		}
+
+		void CWebServer::GetGraphData(WebEmSession& session, const request& req, Json::Value& root)
 		{
 			uint64_t idx = 0;
 			if (!request::findValue(&req, "idx").empty())
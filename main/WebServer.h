@@ -1,6 +1,8 @@
 #pragma once
 
+#include <list>
 #include <string>
+#include <unordered_map>
 #include "../webserver/cWebem.h"
 #include "../webserver/request.hpp"
 #include "../webserver/session_store.hpp"
@@ -93,7 +95,8 @@ class CWebServer : public session_store, public std::enable_shared_from_this<CWe
 	//JSon
 	void GetJSonDevices(Json::Value &root, const std::string &rused, const std::string &rfilter, const std::string &order, const std::string &rowid, const std::string &planID,
 			    const std::string &floorID, bool bDisplayHidden, bool bDisplayDisabled, bool bFetchFavorites, time_t LastUpdate, const std::string &username,
-			    const std::string &hardwareid = ""); // OTO
+			    const std::string &hardwareid = "", // OTO
+			    uint64_t LastChangeSeq = 0); // only rows changed after this device journal sequence
 
 	// SessionStore interface
 	WebEmStoredSession GetSession(const std::string &sessionId) override;
@@ -194,6 +197,11 @@ private:
 	void Cmd_GetVersion(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetAuth(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetUptime(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetSQLStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetLuaStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetHTTPClientStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetRxQueueStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetIoPoolStats(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetActualHistory(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetNewHistory(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetConfig(WebEmSession& session, const request& req, Json::Value& root);
@@ -292,6 +300,7 @@ private:
 	void Cmd_BleBoxUpdateFirmware(WebEmSession & session, const request& req, Json::Value &root);
 
 	void Cmd_GetTimerPlans(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetUpcomingSchedules(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_AddTimerPlan(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_UpdateTimerPlan(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_DeleteTimerPlan(WebEmSession & session, const request& req, Json::Value &root);
@@ -306,10 +315,12 @@ private:
 	void PluginList(Json::Value &root);
 #ifdef ENABLE_PYTHON
 	void PluginLoadConfig();
+	void Cmd_GetPluginStats(WebEmSession & session, const request& req, Json::Value &root);
 #endif
 
 	//RTypes
 	void RType_HandleGraph(WebEmSession & session, const request& req, Json::Value &root);
+	void GetGraphData(WebEmSession & session, const request& req, Json::Value &root);
 	void RType_LightLog(WebEmSession & session, const request& req, Json::Value &root);
 	void RType_TextLog(WebEmSession & session, const request& req, Json::Value &root);
 	void RType_SceneLog(WebEmSession & session, const request& req, Json::Value &root);
@@ -445,6 +456,21 @@ private:
 
 	std::vector<_tUserAccessCode> m_accesscodes;
 
+	// Graph results, valid as long as the logs of the device, the preferences, the device and the day did not change
+	struct _tGraphCacheItem
+	{
+		uint64_t generation;
+		std::string version;
+		std::shared_ptr<Json::Value> root;
+	};
+	// LRU, most recently used first
+	typedef std::list<std::pair<std::string, _tGraphCacheItem>> TGraphCacheList;
+	TGraphCacheList m_graph_cache;
+	std::unordered_map<std::string, TGraphCacheList::iterator> m_graph_cache_index;
+	std::mutex m_graph_cache_mutex;
+	uint64_t m_graph_cache_hits = 0;
+	uint64_t m_graph_cache_misses = 0;
+
 };
 
 	} // namespace server
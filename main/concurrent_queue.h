@@ -14,21 +14,77 @@
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <deque>
+#include <vector>
+#include <utility>
 
+// Growable ring buffer usable as std::queue container. Slots are reused once the ring
+// covers the peak depth, so a steady push/pop flow no longer allocates per element
 template<typename Data>
+class ring_deque {
+private:
+	std::vector<Data> slots;
+	size_t head = 0;
+	size_t count = 0;
+
+	void grow() {
+		std::vector<Data> new_slots(slots.empty() ? 16 : slots.size() * 2);
+		for (size_t i = 0; i < count; i++)
+			new_slots[i] = std::move(slots[(head + i) % slots.size()]);
+		slots.swap(new_slots);
+		head = 0;
+	}
+
+public:
+	typedef Data value_type;
+	typedef Data& reference;
+	typedef const Data& const_reference;
+	typedef size_t size_type;
+
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+	Data& front() { return slots[head]; }
+	const Data& front() const { return slots[head]; }
+	Data& back() { return slots[(head + count - 1) % slots.size()]; }
+	const Data& back() const { return slots[(head + count - 1) % slots.size()]; }
+
+	void push_back(Data const& data) {
+		if (count == slots.size())
+			grow();
+		slots[(head + count) % slots.size()] = data;
+		count++;
+	}
+	void push_back(Data&& data) {
+		if (count == slots.size())
+			grow();
+		slots[(head + count) % slots.size()] = std::move(data);
+		count++;
+	}
+	template<typename... Args>
+	void emplace_back(Args&&... args) {
+		push_back(Data(std::forward<Args>(args)...));
+	}
+	void pop_front() {
+		slots[head] = Data(); // release what the element still owns
+		head = (head + 1) % slots.size();
+		count--;
+	}
+};
+
+template<typename Data, typename Container = std::deque<Data> >
 class concurrent_queue {
 private:
 	struct queue_not_empty {
-		std::queue<Data>& queue;
+		std::queue<Data, Container>& queue;
 
-		explicit queue_not_empty(std::queue<Data>& queue_): queue(queue_) {}
+		explicit queue_not_empty(std::queue<Data, Container>& queue_): queue(queue_) {}
 
 		bool operator()() const {
 			return !queue.empty();
 		}
 	};
 
-	std::queue<Data> the_queue;
+	std::queue<Data, Container> the_queue;
 	mutable std::mutex the_mutex;
 	std::condition_variable the_condition_variable;
 
@@ -51,6 +107,21 @@ public:
 		the_condition_variable.notify_one();
 	}
 
+	void push(Data&& data) {
+		std::unique_lock<std::mutex> lock(the_mutex);
+		the_queue.push(std::move(data));
+		lock.unlock();
+		the_condition_variable.notify_one();
+	}
+
+	template<typename... Args>
+	void emplace(Args&&... args) {
+		std::unique_lock<std::mutex> lock(the_mutex);
+		the_queue.emplace(std::forward<Args>(args)...);
+		lock.unlock();
+		the_condition_variable.notify_one();
+	}
+
 	bool empty() const {
 		std::unique_lock<std::mutex> lock(the_mutex);
 		return the_queue.empty();
@@ -62,7 +133,7 @@ public:
 			return false;
 		}
 
-		popped_value=the_queue.front();
+		popped_value=std::move(the_queue.front());
 		the_queue.pop();
 		return true;
 	}
@@ -76,7 +147,7 @@ public:
 		*/
 		the_condition_variable.wait(lock, queue_not_empty(the_queue));
 
-		popped_value=the_queue.front();
+		popped_value=std::move(the_queue.front());
 		the_queue.pop();
 	}
 
@@ -86,11 +157,27 @@ public:
 		if(!the_condition_variable.wait_for(lock, wait_duration, queue_not_empty(the_queue))) {
 			return false;
 		}
-		popped_value=the_queue.front();
+		popped_value=std::move(the_queue.front());
 		the_queue.pop();
 		return true;
 	}
 
+	// Wait for at least one element, then move up to max_count elements out under a single lock
+	template<typename Duration>
+	size_t timed_wait_and_pop_batch(std::vector<Data>& popped_values, size_t max_count, Duration const& wait_duration) {
+		std::unique_lock<std::mutex> lock(the_mutex);
+		if(!the_condition_variable.wait_for(lock, wait_duration, queue_not_empty(the_queue))) {
+			return 0;
+		}
+		size_t count = 0;
+		while(!the_queue.empty() && (count < max_count)) {
+			popped_values.push_back(std::move(the_queue.front()));
+			the_queue.pop();
+			count++;
+		}
+		return count;
+	}
+
 };
 
 class queue_element_trigger {
@@ -28,6 +28,7 @@
 #include "Helper.h"
 #include "WebServerHelper.h"
 #include "SQLHelper.h"
+#include "IoContextPool.h"
 #include "../notifications/NotificationHelper.h"
 #include "appversion.h"
 #include "localtime_r.h"
@@ -84,6 +85,8 @@ namespace
 #endif
 		"\t-noupdates do not use the internal update functionality\n"
 		"\t-dbase_disable_wal_mode\n"
+		"\t-dbase_write_interval ms (group commit device updates every x milliseconds, default=0 (disabled))\n"
+		"\t-dbase_write_batch rows (commit earlier when this many device updates are pending, default=100)\n"
 #if defined WIN32
 		"\t-log file_path (for example D:\\domoticz.log)\n"
 		"\t-weblog file_path (for example D:\\domoticz_access.log)\n"
@@ -91,6 +94,9 @@ namespace
 		"\t-log file_path (for example /var/log/domoticz.log)\n"
 		"\t-weblog file_path (for example /var/log/domoticz_access.log)\n"
 #endif
+		"\t-logasync ms (write log output from a background thread, flushing every x milliseconds, default=0 (disabled))\n"
+		"\t-rxthreads count (queue received hardware messages on this many threads, sharded by hardware, default=1; decoding is not thread safe and stays serialized)\n"
+		"\t-iothreads count|auto (run TCP hardware drivers and heartbeats on a shared pool of I/O threads, auto=number of cores, default=0 (disabled))\n"
 		"\t-loglevel (combination of: all,normal,status,error,debug)\n"
 		"\t-debuglevel (combination of: all,normal,hardware,received,webserver,eventsystem,python,thread_id,sql,auth)\n"
 		"\t-notimestamps (do not prepend timestamps to logs; useful with syslog, etc.)\n"
@@ -158,11 +164,17 @@ std::string szPyVersion="None";
 int ActYear;
 time_t m_StartTime = time(nullptr);
 std::string journalMode="WAL";
+int dbaseWriteInterval = 0;
+int dbaseWriteBatch = 100;
+int logAsyncInterval = 0;
+int rxDecodeThreads = 1;
+int ioPoolThreads = 0;
 
 MainWorker m_mainworker;
 CLogger _log;
 http::server::CWebServerHelper m_webservers;
 CSQLHelper m_sql;
+CIoContextPool m_iocontextpool;
 CNotificationHelper m_notifications;
 
 std::string logfile;
@@ -482,6 +494,14 @@ bool GetConfigBool(std::string szValue)
 	return (szValue == "yes");
 }
 
+int GetIoPoolThreads(std::string szValue)
+{
+	stdlower(szValue);
+	if (szValue == "auto")
+		return std::max<int>(std::thread::hardware_concurrency(), 1);
+	return atoi(szValue.c_str());
+}
+
 bool ParseConfigFile(const std::string &szConfigFile)
 {
 	std::ifstream infile;
@@ -570,6 +590,15 @@ bool ParseConfigFile(const std::string &szConfigFile)
 		else if (szFlag == "weblog_file") {
 			weblogfile = sLine;
 		}
+		else if (szFlag == "log_async_interval") {
+			logAsyncInterval = atoi(sLine.c_str());
+		}
+		else if (szFlag == "rx_decode_threads") {
+			rxDecodeThreads = atoi(sLine.c_str());
+		}
+		else if (szFlag == "io_threads") {
+			ioPoolThreads = GetIoPoolThreads(sLine);
+		}
 		else if (szFlag == "loglevel") {
 			_log.SetLogFlags(sLine);
 		}
@@ -591,6 +620,12 @@ bool ParseConfigFile(const std::string &szConfigFile)
 		else if ( (szFlag == "dbase_disable_wal_mode") && (GetConfigBool(sLine) ) )  {
 			journalMode = "DELETE";
 		}
+		else if (szFlag == "dbase_write_interval") {
+			dbaseWriteInterval = atoi(sLine.c_str());
+		}
+		else if (szFlag == "dbase_write_batch") {
+			dbaseWriteBatch = atoi(sLine.c_str());
+		}
 
 		else if (szFlag == "startup_delay") {
 			int DelaySeconds = atoi(sLine.c_str());
@@ -712,6 +747,33 @@ int main(int argc, char**argv)
 			}
 			logfile = cmdLine.GetSafeArgument("-log", 0, "domoticz.log");
 		}
+		if (cmdLine.HasSwitch("-logasync"))
+		{
+			if (cmdLine.GetArgumentCount("-logasync") != 1)
+			{
+				_log.Log(LOG_ERROR, "Please specify the log flush interval (in milliseconds)");
+				return 1;
+			}
+			logAsyncInterval = atoi(cmdLine.GetSafeArgument("-logasync", 0, "0").c_str());
+		}
+		if (cmdLine.HasSwitch("-rxthreads"))
+		{
+			if (cmdLine.GetArgumentCount("-rxthreads") != 1)
+			{
+				_log.Log(LOG_ERROR, "Please specify the number of RX decode threads");
+				return 1;
+			}
+			rxDecodeThreads = atoi(cmdLine.GetSafeArgument("-rxthreads", 0, "1").c_str());
+		}
+		if (cmdLine.HasSwitch("-iothreads"))
+		{
+			if (cmdLine.GetArgumentCount("-iothreads") != 1)
+			{
+				_log.Log(LOG_ERROR, "Please specify the number of shared I/O threads (or auto)");
+				return 1;
+			}
+			ioPoolThreads = GetIoPoolThreads(cmdLine.GetSafeArgument("-iothreads", 0, "0"));
+		}
 		if (cmdLine.HasSwitch("-weblog"))
 		{
 			if (cmdLine.GetArgumentCount("-weblog") != 1)
@@ -1039,6 +1101,28 @@ int main(int argc, char**argv)
 	}
 	m_sql.SetJournalMode(journalMode);
 
+	if (!bUseConfigFile) {
+		if (cmdLine.HasSwitch("-dbase_write_interval"))
+		{
+			if (cmdLine.GetArgumentCount("-dbase_write_interval") != 1)
+			{
+				_log.Log(LOG_ERROR, "Please specify the database write interval (in milliseconds)");
+				return 1;
+			}
+			dbaseWriteInterval = atoi(cmdLine.GetSafeArgument("-dbase_write_interval", 0, "0").c_str());
+		}
+		if (cmdLine.HasSwitch("-dbase_write_batch"))
+		{
+			if (cmdLine.GetArgumentCount("-dbase_write_batch") != 1)
+			{
+				_log.Log(LOG_ERROR, "Please specify the maximum number of pending database writes");
+				return 1;
+			}
+			dbaseWriteBatch = atoi(cmdLine.GetSafeArgument("-dbase_write_batch", 0, "100").c_str());
+		}
+	}
+	m_sql.SetDeviceWriteBatching(dbaseWriteInterval, dbaseWriteBatch);
+
 	if (!bUseConfigFile) {
 		if (cmdLine.HasSwitch("-webroot"))
 		{
@@ -1177,6 +1261,14 @@ int main(int argc, char**argv)
 #endif
 	}
 
+	// Only now, the writer thread would not survive daemonize()
+	if (logAsyncInterval > 0)
+		_log.StartAsyncWriter(logAsyncInterval);
+
+	// The pool has to run before the hardware is created, drivers pick their io_service when constructed
+	m_iocontextpool.Start(ioPoolThreads);
+
+	m_mainworker.SetRxDecodeThreads(rxDecodeThreads);
 	if (!m_mainworker.Start())
 	{
 		return 1;
@@ -1229,6 +1321,7 @@ int main(int argc, char**argv)
 	{
 
 	}
+	m_iocontextpool.Stop();
 #ifndef WIN32
 	if (g_bRunAsDaemon)
 	{
@@ -1246,6 +1339,7 @@ int main(int argc, char**argv)
 #endif
 	g_stop_watchdog = true;
 	thread_watchdog.join();
+	_log.StopAsyncWriter();
 	return 0;
 }
 
@@ -7,6 +7,23 @@
 #include "Helper.h"
 #include "appversion.h"
 #include "localtime_r.h"
+#include "RFXNames.h"
+#include "concurrent_queue.h"
+#include "RxMessageBuffer.h"
+#include "../hardware/P1MeterOBIS.h"
+#include "../hardware/hardwaretypes.h"
+#include "SQLCalendarQueries.h"
+#include "dzVentsExport.h"
+#include "dzVentsStore.h"
+#include "LuaEnvironment.h"
+#include "../httpclient/HTTPClientEngine.h"
+#include <sqlite3.h>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
 
 #ifndef WIN32
 	#include <sys/stat.h>
@@ -16,6 +33,9 @@
 	#include <fcntl.h>
 	#include <string.h>
 	#include <stdarg.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <arpa/inet.h>
 #endif
 
 constexpr const char *szHelp
@@ -33,6 +53,13 @@ constexpr const char *szHelp
 	"Available modules:\n"
 	"\thelper\n"
 	"\tbaroforecastcalculator\n"
+	"\trfxnames\n"
+	"\trxqueue\n"
+	"\tp1meter\n"
+	"\tcalendar\n"
+	"\tdzvents\n"
+	"\tdzventsstore\n"
+	"\thttpclient\n"
 	""
 };
 
@@ -197,6 +224,1353 @@ bool helper_tester(const std::string szFunction, std::string &szInput, std::stri
 	return bSuccess;
 }
 
+/* **********
+RFXNames.cpp
+********** */
+bool rfxnames_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	std::vector<std::string> svInputs;
+	StringSplit(szInput, INPUTSEPERATOR, svInputs);
+
+	// VerifyLookupTables (compares the compile-time indexes with a plain table scan, input is ignored)
+	if (szFunction == "VerifyLookupTables")
+	{
+		std::string szError;
+		bSuccess = RFXNames_VerifyLookupTables(szError);
+		szOutput = (bSuccess) ? "OK" : szError;
+	}
+	// RFX_Type_Desc
+	else if (szFunction == "RFX_Type_Desc")
+	{
+		if (svInputs.size() == 2)
+		{
+			szOutput = RFX_Type_Desc((unsigned char)std::stoi(svInputs[0]), (unsigned char)std::stoi(svInputs[1]));
+			bSuccess = true;
+		}
+	}
+	// RFX_Type_SubType_Desc
+	else if (szFunction == "RFX_Type_SubType_Desc")
+	{
+		if (svInputs.size() == 2)
+		{
+			szOutput = RFX_Type_SubType_Desc((unsigned char)std::stoi(svInputs[0]), (unsigned char)std::stoi(svInputs[1]));
+			bSuccess = true;
+		}
+	}
+	// Hardware_Type_Desc
+	else if (szFunction == "Hardware_Type_Desc")
+	{
+		szOutput = Hardware_Type_Desc(std::stoi(szInput));
+		bSuccess = true;
+	}
+	// Switch_Type_Desc
+	else if (szFunction == "Switch_Type_Desc")
+	{
+		szOutput = Switch_Type_Desc((_eSwitchType)std::stoi(szInput));
+		bSuccess = true;
+	}
+	// BenchmarkLookup (input is the number of passes over all type/subtype combinations)
+	else if (szFunction == "BenchmarkLookup")
+	{
+		int iterations = std::stoi(szInput);
+		if (iterations > 0)
+		{
+			double dIndexedNs = 0, dLinearNs = 0;
+			bool bSame = RFXNames_BenchmarkLookup(iterations, dIndexedNs, dLinearNs);
+			if (bMeasure)
+				Log("RFX_Type_SubType lookup: indexed %.2f ns, linear %.2f ns", dIndexedNs, dLinearNs);
+			// timings are only reported (-measure), the result is the equivalence of both lookups
+			szOutput = bSame ? "OK" : "lookup mismatch";
+			bSuccess = bSame;
+		}
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
+/* **********
+RxMessageBuffer.h / concurrent_queue.h
+********** */
+
+// RX queue item as it was before, the packet lives in a vector and the item is copied on push and on pop
+struct _tLegacyRxQueueItem {
+	std::string Name;
+	int BatteryLevel;
+	unsigned long rxMessageIdx;
+	int hardwareId;
+	std::vector<uint8_t> vrxCommand;
+	std::string UserName;
+};
+
+struct _tInlineRxQueueItem {
+	std::string Name;
+	int BatteryLevel;
+	unsigned long rxMessageIdx;
+	int hardwareId;
+	_tRxMessageBuffer rxCommand;
+	std::string UserName;
+};
+
+// Sample packet, a temperature/humidity sensor message (length byte + 10 bytes)
+static const uint8_t RxQueueSamplePacket[] = { 0x0A, 0x52, 0x01, 0x00, 0x12, 0x34, 0x00, 0xD2, 0x3C, 0x02, 0x89 };
+
+#define RXQUEUE_BENCHMARK_BURST 32
+
+// Pushes iMessages in bursts and pops them again on the same thread (no scheduling noise), returns messages per second
+double rxqueue_benchmark_legacy(const int iMessages, unsigned long &checksum)
+{
+	concurrent_queue<_tLegacyRxQueueItem> queue;
+	auto tStart = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < iMessages; ii += RXQUEUE_BENCHMARK_BURST)
+	{
+		for (int jj = 0; jj < RXQUEUE_BENCHMARK_BURST; jj++)
+		{
+			_tLegacyRxQueueItem rxMessage;
+			rxMessage.Name = "Temp+Hum";
+			rxMessage.BatteryLevel = 255;
+			rxMessage.rxMessageIdx = ii + jj;
+			rxMessage.hardwareId = 1;
+			rxMessage.vrxCommand.resize(RxQueueSamplePacket[0] + 1);
+			rxMessage.vrxCommand.insert(rxMessage.vrxCommand.begin(), RxQueueSamplePacket, RxQueueSamplePacket + RxQueueSamplePacket[0] + 1);
+			queue.push(rxMessage);
+		}
+		for (int jj = 0; jj < RXQUEUE_BENCHMARK_BURST; jj++)
+		{
+			_tLegacyRxQueueItem popped;
+			queue.try_pop(popped);
+			_tLegacyRxQueueItem rxQItem = popped; // the old pop copied the front element
+			checksum += rxQItem.vrxCommand[1];
+		}
+	}
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+	return (dSeconds > 0) ? (iMessages / dSeconds) : 0;
+}
+
+double rxqueue_benchmark_inline(const int iMessages, unsigned long &checksum)
+{
+	concurrent_queue<_tInlineRxQueueItem, ring_deque<_tInlineRxQueueItem> > queue;
+	std::vector<_tInlineRxQueueItem> rxQItems;
+	rxQItems.reserve(RXQUEUE_BENCHMARK_BURST);
+	auto tStart = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < iMessages; ii += RXQUEUE_BENCHMARK_BURST)
+	{
+		for (int jj = 0; jj < RXQUEUE_BENCHMARK_BURST; jj++)
+		{
+			_tInlineRxQueueItem rxMessage;
+			rxMessage.Name = "Temp+Hum";
+			rxMessage.BatteryLevel = 255;
+			rxMessage.rxMessageIdx = ii + jj;
+			rxMessage.hardwareId = 1;
+			rxMessage.rxCommand.assign(RxQueueSamplePacket);
+			queue.push(std::move(rxMessage));
+		}
+		rxQItems.clear();
+		queue.timed_wait_and_pop_batch(rxQItems, RXQUEUE_BENCHMARK_BURST, std::chrono::duration<int>(1));
+		for (const auto &rxQItem : rxQItems)
+			checksum += rxQItem.rxCommand.data[1];
+	}
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+	return (dSeconds > 0) ? (iMessages / dSeconds) : 0;
+}
+
+bool rxqueue_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	// Roundtrip (input is the number of messages, all queued before being popped, the second pass reuses the ring slots)
+	if (szFunction == "Roundtrip")
+	{
+		int iMessages = std::stoi(szInput);
+		if (iMessages > 0)
+		{
+			concurrent_queue<_tInlineRxQueueItem, ring_deque<_tInlineRxQueueItem> > queue;
+			szOutput = "OK";
+			for (int pass = 0; pass < 2; pass++)
+			{
+				for (int ii = 0; ii < iMessages; ii++)
+				{
+					uint8_t packet[RX_MESSAGE_MAX_SIZE];
+					packet[0] = static_cast<uint8_t>(ii % RX_MESSAGE_MAX_SIZE);
+					for (int jj = 1; jj <= packet[0]; jj++)
+						packet[jj] = static_cast<uint8_t>(ii + jj);
+					_tInlineRxQueueItem rxMessage;
+					rxMessage.rxMessageIdx = ii;
+					rxMessage.rxCommand.assign(packet);
+					queue.emplace(std::move(rxMessage));
+				}
+				unsigned long expected = 0;
+				_tInlineRxQueueItem rxQItem;
+				while (queue.try_pop(rxQItem))
+				{
+					const uint8_t *pData = rxQItem.rxCommand.data;
+					bool bMatch = (rxQItem.rxMessageIdx == expected++);
+					bMatch = bMatch && (rxQItem.rxCommand.size() == static_cast<size_t>(rxQItem.rxMessageIdx % RX_MESSAGE_MAX_SIZE) + 1);
+					for (size_t jj = 1; bMatch && (jj < rxQItem.rxCommand.size()); jj++)
+						bMatch = (pData[jj] == static_cast<uint8_t>(rxQItem.rxMessageIdx + jj));
+					if (!bMatch)
+						szOutput = std_format("Message %lu corrupted or out of order", rxQItem.rxMessageIdx);
+				}
+				if (expected != static_cast<unsigned long>(iMessages))
+					szOutput = std_format("%lu of %d messages popped", expected, iMessages);
+			}
+			bSuccess = (szOutput == "OK");
+		}
+	}
+	// BenchmarkQueue (input is the number of messages pushed and popped)
+	else if (szFunction == "BenchmarkQueue")
+	{
+		int iMessages = std::stoi(szInput);
+		if (iMessages > 0)
+		{
+			unsigned long checksumLegacy = 0, checksumInline = 0;
+			double dLegacy = rxqueue_benchmark_legacy(iMessages, checksumLegacy);
+			double dInline = rxqueue_benchmark_inline(iMessages, checksumInline);
+			if (bMeasure)
+				Log("RX queue: vector/copy %.0f msg/s, inline/move %.0f msg/s", dLegacy, dInline);
+			// timings are only reported (-measure), the result is the equivalence of both queues
+			szOutput = (checksumLegacy == checksumInline) ? "OK" : "checksum mismatch";
+			bSuccess = (szOutput == "OK");
+		}
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
+// Recorded P1 telegrams (DSMR 5.0 NL with CRLF line ends, e-MUCS BE with a water meter and LF line ends)
+static const char *P1SampleTelegrams[] = {
+	"/ISk5\\2MT382-1000\r\n\r\n1-3:0.2.8(50)\r\n0-0:1.0.0(101209113020W)\r\n0-0:96.1.1(4B384547303034303436333935353037)\r\n"
+	"1-0:1.8.1(123456.789*kWh)\r\n1-0:1.8.2(123456.789*kWh)\r\n1-0:2.8.1(123456.789*kWh)\r\n1-0:2.8.2(123456.789*kWh)\r\n"
+	"0-0:96.14.0(0002)\r\n1-0:1.7.0(01.193*kW)\r\n1-0:2.7.0(00.000*kW)\r\n0-0:96.7.21(00004)\r\n0-0:96.7.9(00002)\r\n"
+	"1-0:99.97.0(2)(0-0:96.7.19)(101208152415W)(0000000240*s)(101208151004W)(0000000301*s)\r\n"
+	"1-0:32.32.0(00002)\r\n1-0:52.32.0(00001)\r\n1-0:72.32.0(00000)\r\n1-0:32.36.0(00000)\r\n1-0:52.36.0(00003)\r\n1-0:72.36.0(00000)\r\n"
+	"0-0:96.13.0(303132333435363738393A3B3C3D3E3F303132333435363738393A3B3C3D3E3F)\r\n"
+	"1-0:32.7.0(220.1*V)\r\n1-0:52.7.0(220.2*V)\r\n1-0:72.7.0(220.3*V)\r\n1-0:31.7.0(001*A)\r\n1-0:51.7.0(002*A)\r\n1-0:71.7.0(003*A)\r\n"
+	"1-0:21.7.0(01.111*kW)\r\n1-0:41.7.0(02.222*kW)\r\n1-0:61.7.0(03.333*kW)\r\n1-0:22.7.0(04.444*kW)\r\n1-0:42.7.0(05.555*kW)\r\n1-0:62.7.0(06.666*kW)\r\n"
+	"0-1:24.1.0(003)\r\n0-1:96.1.0(3232323241424344313233343536373839)\r\n0-1:24.2.1(101209112500W)(12785.123*m3)\r\n!6D54\r\n",
+	"/FLU5\\253769484_A\n\n0-0:96.1.4(50216)\n0-0:96.1.1(3153414733313030353733313933)\n0-0:1.0.0(220812104627S)\n"
+	"1-0:1.8.1(000012.755*kWh)\n1-0:1.8.2(000005.763*kWh)\n1-0:2.8.1(000000.159*kWh)\n1-0:2.8.2(000000.000*kWh)\n"
+	"0-0:96.14.0(0001)\n1-0:1.7.0(00.123*kW)\n1-0:2.7.0(00.000*kW)\n1-0:21.7.0(00.009*kW)\n1-0:41.7.0(00.006*kW)\n1-0:61.7.0(00.107*kW)\n"
+	"1-0:22.7.0(00.000*kW)\n1-0:42.7.0(00.000*kW)\n1-0:62.7.0(00.000*kW)\n1-0:32.7.0(229.1*V)\n1-0:52.7.0(231.5*V)\n1-0:72.7.0(233.1*V)\n"
+	"1-0:31.7.0(000.09*A)\n1-0:51.7.0(000.03*A)\n1-0:71.7.0(000.82*A)\n0-0:96.3.10(1)\n0-0:17.0.0(999.9*kW)\n1-0:31.4.0(999*A)\n0-0:96.13.0()\n"
+	"0-1:24.1.0(003)\n0-1:96.1.1(37464C4F32313232303935333931)\n0-1:24.4.0(1)\n0-1:24.2.3(220812104535S)(00001.326*m3)\n"
+	"0-2:24.1.0(007)\n0-2:96.1.1(3853455430303030323731323938)\n0-2:24.2.1(220812104503S)(00000.302*m3)\n!25FD\n",
+};
+
+// The line dispatch P1MeterBase used before the OBIS index: every line copied into a null terminated
+// buffer, strncmp against each entry of p1_matchlist and the value extracted through a std::string
+size_t p1meter_replay_legacy(const char *pTelegram, std::string &result)
+{
+	char l_buffer[128];
+	size_t l_bufferpos = 0;
+	size_t matches = 0;
+	for (const char *p = pTelegram; *p != 0; p++)
+	{
+		if ((*p != '\n') && (*p != '\r'))
+		{
+			if (l_bufferpos < sizeof(l_buffer) - 1)
+				l_buffer[l_bufferpos++] = *p;
+			continue;
+		}
+		if (*p == '\r')
+			continue;
+		l_buffer[l_bufferpos] = 0;
+		l_bufferpos = 0;
+		for (const auto &match : p1_matchlist)
+		{
+			if ((match.matchtype != _eP1MatchType::STD) || (strncmp(match.key, l_buffer, strlen(match.key)) != 0))
+				continue;
+			std::string vString = l_buffer + match.start;
+			size_t ePos = vString.find_first_of("*)");
+			if (ePos != std::string::npos)
+			{
+				result += std::string(match.topic) + "=" + vString.substr(0, ePos) + "\n";
+				matches++;
+			}
+			break;
+		}
+	}
+	return matches;
+}
+
+// The same dispatch on the lines in place, through the sorted OBIS key index
+size_t p1meter_replay_index(const char *pTelegram, const size_t len, std::string &result)
+{
+	size_t matches = 0;
+	const char *pEnd = pTelegram + len;
+	const char *pLine = pTelegram;
+	while (pLine < pEnd)
+	{
+		const char *pLF = static_cast<const char *>(memchr(pLine, '\n', pEnd - pLine));
+		if (pLF == nullptr)
+			break;
+		size_t lineLen = pLF - pLine;
+		while ((lineLen > 0) && (pLine[lineLen - 1] == '\r'))
+			lineLen--;
+		const P1Match *match = P1FindStdMatch(pLine, lineLen);
+		const char *pValue = nullptr;
+		size_t valuelen = 0;
+		if ((match != nullptr) && (P1GetLineValue(pLine, lineLen, match->start, pValue, valuelen)))
+		{
+			result.append(match->topic).append("=").append(pValue, valuelen).append("\n");
+			matches++;
+		}
+		pLine = pLF + 1;
+	}
+	return matches;
+}
+
+bool p1meter_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	// Lookup (input is a telegram line, output is the topic and value it is dispatched to)
+	if (szFunction == "Lookup")
+	{
+		const P1Match *match = P1FindStdMatch(szInput.c_str(), szInput.size());
+		const char *pValue = nullptr;
+		size_t valuelen = 0;
+		if ((match != nullptr) && (P1GetLineValue(szInput.c_str(), szInput.size(), match->start, pValue, valuelen)))
+		{
+			szOutput = std::string(match->topic) + "=" + std::string(pValue, valuelen);
+			bSuccess = true;
+		}
+		else
+			szOutput = "NOT FOUND!";
+	}
+	// Replay (input is the number of times the recorded telegrams are replayed, both dispatchers have to report the same values)
+	else if (szFunction == "Replay")
+	{
+		int iRepeat = std::stoi(szInput);
+		if (iRepeat > 0)
+		{
+			szOutput = "OK";
+			for (int ii = 0; ii < iRepeat; ii++)
+			{
+				for (const char *pTelegram : P1SampleTelegrams)
+				{
+					std::string sLegacy, sIndex;
+					size_t nLegacy = p1meter_replay_legacy(pTelegram, sLegacy);
+					size_t nIndex = p1meter_replay_index(pTelegram, strlen(pTelegram), sIndex);
+					if ((nLegacy == 0) || (nLegacy != nIndex) || (sLegacy != sIndex))
+						szOutput = std_format("Mismatch (%d/%d values)", static_cast<int>(nLegacy), static_cast<int>(nIndex));
+				}
+			}
+			bSuccess = (szOutput == "OK");
+		}
+	}
+	// Benchmark (input is the number of telegrams parsed by each dispatcher)
+	else if (szFunction == "Benchmark")
+	{
+		int iTelegrams = std::stoi(szInput);
+		if (iTelegrams > 0)
+		{
+			const size_t nSamples = sizeof(P1SampleTelegrams) / sizeof(P1SampleTelegrams[0]);
+			size_t sampleLen[nSamples];
+			for (size_t jj = 0; jj < nSamples; jj++)
+				sampleLen[jj] = strlen(P1SampleTelegrams[jj]);
+			size_t checksumLegacy = 0, checksumIndex = 0;
+			std::string result;
+
+			auto tStart = std::chrono::steady_clock::now();
+			for (int ii = 0; ii < iTelegrams; ii++)
+			{
+				result.clear();
+				checksumLegacy += p1meter_replay_legacy(P1SampleTelegrams[ii % nSamples], result);
+			}
+			double dLegacy = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+			tStart = std::chrono::steady_clock::now();
+			for (int ii = 0; ii < iTelegrams; ii++)
+			{
+				result.clear();
+				checksumIndex += p1meter_replay_index(P1SampleTelegrams[ii % nSamples], sampleLen[ii % nSamples], result);
+			}
+			double dIndex = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+			if (bMeasure)
+				Log("P1 telegrams: linear/copy %.0f telegrams/s, index/in place %.0f telegrams/s", (dLegacy > 0) ? iTelegrams / dLegacy : 0, (dIndex > 0) ? iTelegrams / dIndex : 0);
+			// timings are only reported (-measure), the result is the equivalence of both dispatchers
+			szOutput = (checksumLegacy == checksumIndex) ? "OK" : "checksum mismatch";
+			bSuccess = (szOutput == "OK");
+		}
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
+/* **********
+SQLCalendarQueries.h
+********** */
+
+// Device 1 logged during the rolled up day, device 2 only the day before (idle)
+constexpr auto sqlCalendarFixture =
+"CREATE TABLE DeviceStatus (ID INTEGER PRIMARY KEY, Name VARCHAR(100), Type INTEGER, SubType INTEGER, SwitchType INTEGER DEFAULT 0, Options TEXT DEFAULT '');"
+"CREATE TABLE Temperature (DeviceRowID BIGINT, Temperature FLOAT, Chill FLOAT DEFAULT 0, Humidity INTEGER DEFAULT 0, Barometer INTEGER DEFAULT 0, DewPoint FLOAT DEFAULT 0, SetPoint FLOAT DEFAULT 0, Date DATETIME);"
+"CREATE TABLE Temperature_Calendar (DeviceRowID BIGINT, Temp_Min FLOAT, Temp_Max FLOAT, Temp_Avg FLOAT, Chill_Min FLOAT, Chill_Max FLOAT, Humidity INTEGER, Barometer INTEGER, DewPoint FLOAT, SetPoint_Min FLOAT, SetPoint_Max FLOAT, SetPoint_Avg FLOAT, Date DATE);"
+"CREATE TABLE Rain (DeviceRowID BIGINT, Total FLOAT, Rate INTEGER DEFAULT 0, Date DATETIME);"
+"CREATE TABLE Rain_Calendar (DeviceRowID BIGINT, Total FLOAT, Rate INTEGER, Date DATE);"
+"CREATE TABLE Meter (DeviceRowID BIGINT, Value BIGINT, [Usage] INTEGER DEFAULT 0, Date DATETIME);"
+"CREATE TABLE MultiMeter (DeviceRowID BIGINT, Value1 BIGINT, Value2 BIGINT, Value3 BIGINT, Value4 BIGINT, Value5 BIGINT, Value6 BIGINT, Date DATETIME);"
+"CREATE TABLE Wind (DeviceRowID BIGINT, Direction FLOAT, Speed INTEGER, Gust INTEGER, Date DATETIME);"
+"CREATE TABLE Wind_Calendar (DeviceRowID BIGINT, Direction FLOAT, Speed_Min INTEGER, Speed_Max INTEGER, Gust_Min INTEGER, Gust_Max INTEGER, Date DATE);"
+"CREATE TABLE UV (DeviceRowID BIGINT, Level FLOAT, Date DATETIME);"
+"CREATE TABLE UV_Calendar (DeviceRowID BIGINT, Level FLOAT, Date DATE);"
+"CREATE TABLE Percentage (DeviceRowID BIGINT, Percentage FLOAT, Date DATETIME);"
+"CREATE TABLE Percentage_Calendar (DeviceRowID BIGINT, Percentage_Min FLOAT, Percentage_Max FLOAT, Percentage_Avg FLOAT, Date DATE);"
+"CREATE TABLE Fan (DeviceRowID BIGINT, Speed INTEGER, Date DATETIME);"
+"CREATE TABLE Fan_Calendar (DeviceRowID BIGINT, Speed_Min INTEGER, Speed_Max INTEGER, Speed_Avg INTEGER, Date DATE);"
+"INSERT INTO DeviceStatus (ID, Name, Type, SubType) VALUES (1, 'Active', 243, 29), (2, 'Idle', 243, 29);"
+"INSERT INTO Temperature (DeviceRowID, Temperature, Date) VALUES (1, 20.5, '2024-03-10 08:00:00'), (1, 22.5, '2024-03-10 16:00:00'), (2, 18.0, '2024-03-09 12:00:00');"
+"INSERT INTO Rain (DeviceRowID, Total, Date) VALUES (1, 10.0, '2024-03-10 08:00:00'), (1, 12.5, '2024-03-10 16:00:00'), (2, 30.0, '2024-03-09 12:00:00');"
+"INSERT INTO Meter (DeviceRowID, Value, [Usage], Date) VALUES (1, 1000, 50, '2024-03-10 08:00:00'), (1, 1500, 60, '2024-03-10 16:00:00'), (2, 7000, 0, '2024-03-09 12:00:00');"
+"INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6, Date) VALUES (1, 1, 2, 3, 4, 5, 6, '2024-03-10 08:00:00'), (2, 1, 2, 3, 4, 5, 6, '2024-03-09 12:00:00');"
+"INSERT INTO Wind (DeviceRowID, Direction, Speed, Gust, Date) VALUES (1, 90, 10, 20, '2024-03-10 08:00:00'), (2, 180, 5, 8, '2024-03-09 12:00:00');"
+"INSERT INTO UV (DeviceRowID, Level, Date) VALUES (1, 3.5, '2024-03-10 12:00:00'), (2, 1.0, '2024-03-09 12:00:00');"
+"INSERT INTO Percentage (DeviceRowID, Percentage, Date) VALUES (1, 40, '2024-03-10 08:00:00'), (1, 60, '2024-03-10 16:00:00'), (2, 10, '2024-03-09 12:00:00');"
+"INSERT INTO Fan (DeviceRowID, Speed, Date) VALUES (1, 1200, '2024-03-10 08:00:00'), (2, 900, '2024-03-09 12:00:00');";
+
+// Runs szSQL with the period as ?1/?2 (and the rain subtypes as ?3/?4), returns the rows as "col,col;col,col"
+bool calendar_run(sqlite3 *dbase, const char *szSQL, std::string &szResult)
+{
+	sqlite3_stmt *stmt = nullptr;
+	if (sqlite3_prepare_v2(dbase, szSQL, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		szResult = sqlite3_errmsg(dbase);
+		return false;
+	}
+	sqlite3_bind_text(stmt, 1, "2024-03-10", -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 2, "2024-03-11 00:00:00", -1, SQLITE_STATIC);
+	if (sqlite3_bind_parameter_count(stmt) >= 4)
+	{
+		sqlite3_bind_int(stmt, 3, sTypeRAINWU);
+		sqlite3_bind_int(stmt, 4, sTypeRAINByRate);
+	}
+	int rc;
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+	{
+		if (!szResult.empty())
+			szResult += ";";
+		for (int ii = 0; ii < sqlite3_column_count(stmt); ii++)
+		{
+			const unsigned char *pValue = sqlite3_column_text(stmt, ii);
+			if (ii > 0)
+				szResult += ",";
+			szResult += (pValue != nullptr) ? reinterpret_cast<const char *>(pValue) : "NULL";
+		}
+	}
+	sqlite3_finalize(stmt);
+	if (rc != SQLITE_DONE)
+	{
+		szResult = sqlite3_errmsg(dbase);
+		return false;
+	}
+	return true;
+}
+
+bool calendar_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	// Rollup (input is the log table, output is the rolled up rows: the calendar rows, or the rows meters are handled from)
+	static const std::map<std::string, std::pair<std::vector<const char *>, const char *>> rollups = {
+		{ "Temperature", { { sqlCalendarTemperature }, "SELECT DeviceRowID, Temp_Min, Temp_Max, Temp_Avg, Date FROM Temperature_Calendar" } },
+		{ "Rain", { { sqlCalendarRainCounter, sqlCalendarRainTotal }, "SELECT DeviceRowID, Total, Date FROM Rain_Calendar" } },
+		{ "Meter", { { sqlCalendarMeter }, nullptr } },
+		{ "MultiMeter", { { sqlCalendarMultiMeter }, nullptr } },
+		{ "Wind", { { sqlCalendarWind }, "SELECT DeviceRowID, Speed_Min, Gust_Max, Date FROM Wind_Calendar" } },
+		{ "UV", { { sqlCalendarUV }, "SELECT DeviceRowID, Level, Date FROM UV_Calendar" } },
+		{ "Percentage", { { sqlCalendarPercentage }, "SELECT DeviceRowID, Percentage_Min, Percentage_Max, Percentage_Avg, Date FROM Percentage_Calendar" } },
+		{ "Fan", { { sqlCalendarFan }, "SELECT DeviceRowID, Speed_Min, Speed_Max, Date FROM Fan_Calendar" } },
+	};
+
+	if (szFunction != "Rollup")
+	{
+		szOutput = "NOT FOUND!";
+		return false;
+	}
+	auto itt = rollups.find(szInput);
+	if (itt == rollups.end())
+	{
+		szOutput = "NOT FOUND!";
+		return false;
+	}
+
+	sqlite3 *dbase = nullptr;
+	if (sqlite3_open(":memory:", &dbase) != SQLITE_OK)
+	{
+		szOutput = "no database";
+		return false;
+	}
+	bool bSuccess = (sqlite3_exec(dbase, sqlCalendarFixture, nullptr, nullptr, nullptr) == SQLITE_OK);
+	std::string szResult;
+	for (const char *szSQL : itt->second.first)
+	{
+		if (bSuccess)
+			bSuccess = calendar_run(dbase, szSQL, szResult);
+	}
+	if (bSuccess && (itt->second.second != nullptr))
+	{
+		szResult.clear();
+		bSuccess = calendar_run(dbase, itt->second.second, szResult);
+	}
+	szOutput = bSuccess ? szResult : std::string(sqlite3_errmsg(dbase));
+	sqlite3_close(dbase);
+	return bSuccess;
+}
+
+/* **********
+dzVentsExport.cpp
+********** */
+
+// The items the event system would hold: devices (every third one a switch, every fiftieth never updated),
+// a scene or group per 20 devices and a user variable of each type per 20 devices
+struct _tDzVentsFixture
+{
+	std::map<uint64_t, CEventSystem::_tDeviceStatus> devices;
+	boost::shared_mutex devicesMutex;
+	std::map<uint64_t, CEventSystem::_tScenesGroups> scenesgroups;
+	boost::shared_mutex scenesgroupsMutex;
+	std::map<uint64_t, CEventSystem::_tUserVariable> uservariables;
+	boost::shared_mutex uservariablesMutex;
+	time_t now = 1700000000;
+	int sensorTimeOut = 60;
+	uint64_t hardwareGeneration = 1;
+
+	CdzVentsExport::_tSource Source()
+	{
+		return CdzVentsExport::_tSource{ devices, devicesMutex, scenesgroups, scenesgroupsMutex, uservariables, uservariablesMutex, now, sensorTimeOut, hardwareGeneration,
+						 [](CdzVentsExport::_tRows &cameras, CdzVentsExport::_tRows &hardware) {
+							 cameras = { { "1", "Front door" } };
+							 hardware = { { "1", "Virtual", "15" }, { "2", "Plugin", std::to_string(HTYPE_PythonPlugin) } };
+						 } };
+	}
+};
+
+static std::string dzvents_datetime(const time_t when)
+{
+	struct tm ltime;
+	localtime_r(&when, &ltime);
+	char szDate[40];
+	strftime(szDate, sizeof(szDate), "%Y-%m-%d %H:%M:%S", &ltime);
+	return szDate;
+}
+
+static void dzvents_add_device(_tDzVentsFixture &fixture, const uint64_t ID)
+{
+	CEventSystem::_tDeviceStatus item;
+	item.ID = ID;
+	item.deviceName = std_format("Device %d", static_cast<int>(ID));
+	item.devType = (ID % 3 == 0) ? pTypeLighting2 : pTypeTEMP;
+	item.subType = (ID % 3 == 0) ? sTypeAC : sTypeTEMP1;
+	item.switchtype = 0;
+	item.nValue = (ID % 2 == 0) ? 1 : 0;
+	item.nValueWording = (ID % 3 != 0) ? "" : ((item.nValue == 1) ? "On" : "Off");
+	item.sValue = (ID % 3 == 0) ? "" : std_format("%d.5;%d", static_cast<int>(ID % 30), static_cast<int>(ID % 100));
+	// spread over the last two hours, so half of them timed out and the others will during the test
+	item.lastUpdate = (ID % 50 == 0) ? "" : dzvents_datetime(fixture.now - static_cast<time_t>(ID % 120) * 60 - 7);
+	item.lastLevel = 0;
+	item.description = "";
+	item.deviceID = std_format("%08X", static_cast<int>(ID));
+	item.batteryLevel = 255;
+	item.protection = 0;
+	item.signalLevel = 12;
+	item.unit = 1;
+	item.hardwareID = 1;
+	item.AddjValue = item.AddjMulti = item.AddjValue2 = item.AddjMulti2 = 0;
+	item.customImage = 0;
+	item.image = "";
+	if (item.devType == pTypeTEMP)
+		item.JsonMapFloat[0] = 1013.5f; // barometer
+	fixture.devices[ID] = item;
+}
+
+static void dzvents_setup(_tDzVentsFixture &fixture, const int iDevices)
+{
+	for (int ii = 1; ii <= iDevices; ii++)
+		dzvents_add_device(fixture, ii);
+	for (int ii = 1; ii <= (iDevices + 19) / 20; ii++)
+	{
+		CEventSystem::_tScenesGroups &sgitem = fixture.scenesgroups[ii];
+		sgitem.ID = ii;
+		sgitem.scenesgroupName = std_format("Scene %d", ii);
+		sgitem.scenesgroupValue = "Off";
+		sgitem.scenesgroupType = ii % 2;
+		sgitem.protection = 0;
+		sgitem.lastUpdate = dzvents_datetime(fixture.now - 3600);
+		sgitem.memberID = { static_cast<uint64_t>(ii), static_cast<uint64_t>(ii + 1) };
+
+		CEventSystem::_tUserVariable &uvitem = fixture.uservariables[ii];
+		uvitem.ID = ii;
+		uvitem.variableName = std_format("Variable %d", ii);
+		uvitem.variableType = ii % 5;
+		uvitem.variableValue = (uvitem.variableType == 1) ? "2.5" : std::to_string(ii);
+		uvitem.lastUpdate = dzvents_datetime(fixture.now - 3600);
+	}
+}
+
+// Serializes the value on top of the stack, table keys sorted
+static std::string dzvents_serialize(lua_State *lua_state)
+{
+	const int idx = lua_gettop(lua_state);
+	switch (lua_type(lua_state, idx))
+	{
+	case LUA_TTABLE:
+	{
+		std::map<std::string, std::string> fields;
+		lua_pushnil(lua_state);
+		while (lua_next(lua_state, idx) != 0)
+		{
+			lua_pushvalue(lua_state, -2);
+			std::string szKey = lua_tostring(lua_state, -1);
+			lua_pop(lua_state, 1);
+			fields[szKey] = dzvents_serialize(lua_state);
+			lua_pop(lua_state, 1);
+		}
+		std::string szResult = "{";
+		for (const auto &field : fields)
+			szResult += field.first + "=" + field.second + ",";
+		return szResult + "}";
+	}
+	case LUA_TSTRING:
+		return std::string("\"") + lua_tostring(lua_state, idx) + "\"";
+	case LUA_TBOOLEAN:
+		return lua_toboolean(lua_state, idx) ? "true" : "false";
+	case LUA_TNUMBER:
+	{
+		lua_pushvalue(lua_state, idx);
+		std::string szResult = lua_tostring(lua_state, -1); // keeps 1 and 1.0 apart
+		lua_pop(lua_state, 1);
+		return szResult;
+	}
+	default:
+		return lua_typename(lua_state, lua_type(lua_state, idx));
+	}
+}
+
+// domoticzData as the scripts see it, rawData and data of lazily exported devices included
+static std::vector<std::string> dzvents_read(lua_State *lua_state)
+{
+	std::vector<std::string> entries;
+	lua_getglobal(lua_state, "domoticzData");
+	const int tData = lua_gettop(lua_state);
+	const int iEntries = static_cast<int>(lua_rawlen(lua_state, tData));
+	for (int ii = 1; ii <= iEntries; ii++)
+	{
+		lua_rawgeti(lua_state, tData, ii);
+		lua_getfield(lua_state, -1, "rawData");
+		lua_getfield(lua_state, -2, "data");
+		lua_pop(lua_state, 2);
+		entries.push_back(dzvents_serialize(lua_state));
+		lua_pop(lua_state, 1);
+	}
+	lua_pop(lua_state, 1);
+	return entries;
+}
+
+// Exports into the long lived state, then compares domoticzData with a full export into a new state
+static bool dzvents_check(_tDzVentsFixture &fixture, CdzVentsExport &dzexport, lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items,
+			  const CEventSystem::_tDzVentsChanges &changes, const bool bExpectFull, const std::string &szStep, std::string &szOutput)
+{
+	CdzVentsExport::_tSource source = fixture.Source();
+	dzexport.Export(lua_state, source, items, changes, true, true);
+	if (dzexport.IsLastExportFull() != bExpectFull)
+	{
+		szOutput = szStep + (bExpectFull ? ": delta export instead of a full one" : ": full export instead of a delta");
+		return false;
+	}
+	std::vector<std::string> delta = dzvents_read(lua_state);
+
+	lua_State *lua_full = luaL_newstate();
+	CdzVentsExport fullexport;
+	fullexport.Export(lua_full, source, items, changes, false, false);
+	std::vector<std::string> full = dzvents_read(lua_full);
+	lua_close(lua_full);
+
+	if (delta.size() != full.size())
+	{
+		szOutput = std_format("%s: %d entries, expected %d", szStep.c_str(), static_cast<int>(delta.size()), static_cast<int>(full.size()));
+		return false;
+	}
+	for (size_t ii = 0; ii < full.size(); ii++)
+	{
+		if (delta[ii] != full[ii])
+		{
+			szOutput = szStep + ": " + delta[ii] + " instead of " + full[ii];
+			return false;
+		}
+	}
+	return true;
+}
+
+static CEventSystem::_tEventQueue dzvents_trigger(const CEventSystem::_eReason reason, const uint64_t ID, const std::string &sValue, const std::string &lastUpdate)
+{
+	CEventSystem::_tEventQueue item;
+	item.reason = reason;
+	item.id = ID;
+	item.nValue = 0;
+	item.sValue = sValue;
+	item.lastUpdate = lastUpdate;
+	item.timeoutOccurred = false;
+	item.lastLevel = 0;
+	return item;
+}
+
+bool dzvents_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	// Export (input is the number of devices, every event exported into the long lived state has to match a full export)
+	if (szFunction == "Export")
+	{
+		int iDevices = std::stoi(szInput);
+		if (iDevices >= 20)
+		{
+			_tDzVentsFixture fixture;
+			dzvents_setup(fixture, iDevices);
+			CdzVentsExport dzexport;
+			lua_State *lua_state = luaL_newstate();
+			std::vector<CEventSystem::_tEventQueue> items;
+			CEventSystem::_tDzVentsChanges changes;
+
+			bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, true, "First event", szOutput);
+
+			// a device update triggers the event, exported with the values of the trigger
+			changes.bListChanged = false;
+			if (bSuccess)
+			{
+				fixture.now += 10;
+				fixture.devices[5].sValue = "21.5;40";
+				fixture.devices[5].lastUpdate = dzvents_datetime(fixture.now);
+				changes.devices = { 5 };
+				items = { dzvents_trigger(CEventSystem::REASON_DEVICE, 5, "21.5;40", fixture.devices[5].lastUpdate) };
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Device trigger", szOutput);
+			}
+			// the next (time) event has to export the triggering device again, it is no longer changed
+			if (bSuccess)
+			{
+				fixture.now += 30;
+				changes.devices.clear();
+				items = { dzvents_trigger(CEventSystem::REASON_TIME, 0, "", "") };
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Trigger re-export", szOutput);
+			}
+			// devices time out between events
+			if (bSuccess)
+			{
+				fixture.now += 45 * 60;
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Timed out devices", szOutput);
+			}
+			// a scene and a variable trigger, with updates of items that do not trigger
+			if (bSuccess)
+			{
+				fixture.now += 60;
+				std::string lastUpdate = dzvents_datetime(fixture.now);
+				fixture.scenesgroups[2].scenesgroupValue = "On";
+				fixture.scenesgroups[2].lastUpdate = lastUpdate;
+				fixture.uservariables[3].variableValue = "42";
+				fixture.uservariables[3].lastUpdate = lastUpdate;
+				fixture.devices[7].sValue = "19.5;55";
+				fixture.devices[7].lastUpdate = lastUpdate;
+				changes.devices = { 7 };
+				changes.scenesgroups = { 2 };
+				changes.uservariables = { 3 };
+				items = { dzvents_trigger(CEventSystem::REASON_SCENEGROUP, 2, "On", lastUpdate), dzvents_trigger(CEventSystem::REASON_USERVARIABLE, 3, "42", lastUpdate) };
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Scene and variable trigger", szOutput);
+			}
+			// a shorter sensor timeout rechecks every device
+			if (bSuccess)
+			{
+				fixture.now += 60;
+				fixture.sensorTimeOut = 30;
+				changes = CEventSystem::_tDzVentsChanges();
+				changes.bListChanged = false;
+				items = { dzvents_trigger(CEventSystem::REASON_TIME, 0, "", "") };
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Sensor timeout change", szOutput);
+			}
+			// the clock going back rechecks every device
+			if (bSuccess)
+			{
+				fixture.now -= 20 * 60;
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Clock change", szOutput);
+			}
+			// a device that was not exported yet, without the list change, falls back to a full export
+			if (bSuccess)
+			{
+				fixture.now += 60;
+				dzvents_add_device(fixture, iDevices + 1);
+				changes.devices = { static_cast<uint64_t>(iDevices + 1) };
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, true, "Unknown device", szOutput);
+			}
+			// removed items change the list
+			if (bSuccess)
+			{
+				fixture.now += 60;
+				fixture.devices.erase(9);
+				fixture.uservariables.erase(1);
+				changes = CEventSystem::_tDzVentsChanges();
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, true, "List change", szOutput);
+			}
+			// cameras and hardware are only exported with everything else
+			if (bSuccess)
+			{
+				fixture.now += 60;
+				fixture.hardwareGeneration++;
+				changes.bListChanged = false;
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, true, "Hardware change", szOutput);
+			}
+			if (bSuccess)
+			{
+				fixture.now += 60;
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "After full export", szOutput);
+			}
+			lua_close(lua_state);
+			if (bSuccess)
+				szOutput = "OK";
+		}
+	}
+	// Benchmark (input is the number of devices, one device update per event)
+	else if (szFunction == "Benchmark")
+	{
+		int iDevices = std::stoi(szInput);
+		if (iDevices > 0)
+		{
+			const int iEvents = 100;
+			_tDzVentsFixture fixture;
+			dzvents_setup(fixture, iDevices);
+			CEventSystem::_tDzVentsChanges changes;
+			changes.bListChanged = false;
+			std::vector<CEventSystem::_tEventQueue> items;
+			double dFull = 0, dDelta = 0;
+
+			// full export of every event (short lived state) against delta export into the long lived state
+			for (int pass = 0; pass < 2; pass++)
+			{
+				lua_State *lua_state = luaL_newstate();
+				CdzVentsExport dzexport;
+				CdzVentsExport::_tSource source = fixture.Source();
+				dzexport.Export(lua_state, source, std::vector<CEventSystem::_tEventQueue>(), CEventSystem::_tDzVentsChanges(), (pass == 1), true);
+				auto tStart = std::chrono::steady_clock::now();
+				for (int ii = 0; ii < iEvents; ii++)
+				{
+					uint64_t ID = 1 + (ii * 7) % iDevices;
+					changes.devices = { ID };
+					items = { dzvents_trigger(CEventSystem::REASON_DEVICE, ID, fixture.devices[ID].sValue, fixture.devices[ID].lastUpdate) };
+					dzexport.Export(lua_state, source, items, changes, (pass == 1), true);
+				}
+				double dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+				if (pass == 0)
+					dFull = dElapsed;
+				else
+					dDelta = dElapsed;
+				lua_close(lua_state);
+			}
+			if (bMeasure)
+				Log("dzVents export of %d devices: full %.3f ms/event, delta %.3f ms/event", iDevices, dFull * 1000 / iEvents, dDelta * 1000 / iEvents);
+
+			// timings are only reported (-measure), the result is the equivalence of both exports
+			lua_State *lua_state = luaL_newstate();
+			CdzVentsExport dzexport;
+			changes = CEventSystem::_tDzVentsChanges();
+			items.clear();
+			bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, true, "First event", szOutput);
+			changes.bListChanged = false;
+			for (int ii = 0; bSuccess && (ii < 10); ii++)
+			{
+				uint64_t ID = 1 + (ii * 7) % iDevices;
+				changes.devices = { ID };
+				items = { dzvents_trigger(CEventSystem::REASON_DEVICE, ID, fixture.devices[ID].sValue, fixture.devices[ID].lastUpdate) };
+				bSuccess = dzvents_check(fixture, dzexport, lua_state, items, changes, false, "Device trigger", szOutput);
+			}
+			lua_close(lua_state);
+			if (bSuccess)
+				szOutput = "OK";
+		}
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
+/* **********
+dzVentsStore.cpp
+********** */
+
+// Stores data with domoticz_setPersistentData, writes it with flush() and compares the data file with what was stored,
+// with the resident copy and with what persistence.store writes (dataFile, persistenceFile and persistence are set by the caller)
+constexpr auto dzVentsStoreTest = R"lua(
+local function same(a, b)
+	if (type(a) ~= type(b)) then return false end
+	if (type(a) == 'number') then
+		if (a ~= a) then return (b ~= b) end
+		return (a == b) and (math.type(a) == math.type(b))
+	end
+	if (type(a) ~= 'table') then return (a == b) end
+	for k, v in pairs(a) do
+		if (not same(v, b[k])) then return false end
+	end
+	for k in pairs(b) do
+		if (a[k] == nil) then return false end
+	end
+	return true
+end
+
+local function check(step, values, histories, expected, bPersistence)
+	assert(domoticz_setPersistentData(dataFile, values, histories), step .. ': not stored')
+	assert(flush(), step .. ': data file not written')
+	local written = assert(loadfile(dataFile))()
+	assert(same(expected, written), step .. ': data file differs')
+	assert(same(expected, domoticz_getPersistentData(dataFile)), step .. ': resident data differs')
+	if (bPersistence) then
+		persistence.store(persistenceFile, expected)
+		assert(same(assert(loadfile(persistenceFile))(), written), step .. ': differs from persistence.store')
+	end
+end
+
+local bytes = {}
+for i = 0, 255 do bytes[#bytes + 1] = string.char(i) end
+local values = {
+	counter = 42, negative = -7, maxint = math.maxinteger, ratio = 2.5, small = -0.125, whole = 3.0, exp = 1e100,
+	on = true, off = false,
+	text = 'line 1\nline 2 "quoted" \\ \r\t',
+	binary = table.concat(bytes),
+	nested = { a = { b = { c = { 1, 2, { deep = 'yes' } } } }, [10] = 'ten', ['10'] = 'string ten', [1.5] = 'float key', [true] = 'boolean key' },
+	list = { 'x', 'y', 'z' },
+	empty = {}
+}
+check('Tables and strings', values, {}, values, true)
+
+-- persistence.store writes nan and inf as names that load as nil, and floats with 14 digits
+local numbers = { third = 1 / 3, tiny = 5e-324, max = 1.7976931348623157e308, nan = 0 / 0, inf = math.huge, ninf = -math.huge, negzero = -0.0, one = 1, onef = 1.0 }
+check('Numbers', numbers, {}, numbers, false)
+
+local s1 = { time = '2026-01-01 00:00:01' }
+local s2 = { time = '2026-01-01 00:00:02', data = { value = 2, unit = 'two' } }
+local s3 = { time = '2026-01-01 00:00:03', data = 3 }
+local s4 = { time = '2026-01-01 00:00:04', data = 4.5 }
+local s5 = { time = '2026-01-01 00:00:05', data = 'five' }
+check('History', { x = 1 }, { temps = { full = { s3, s2, s1 } } }, { x = 1, temps = { s3, s2, s1 } }, true)
+check('History add', { x = 1 }, { temps = { reset = false, added = { s4 }, size = 3 } }, { x = 1, temps = { s4, s3, s2 } }, true)
+check('History reset', { x = 1 }, { temps = { reset = true, added = { s5 }, size = 1 } }, { x = 1, temps = { s5 } }, true)
+check('History trim', { x = 1 }, { temps = { reset = false, added = {}, size = 0 } }, { x = 1, temps = {} }, true)
+check('History removed', { x = 2 }, {}, { x = 2 }, true)
+
+-- changes need the resident history
+assert(not domoticz_setPersistentData(dataFile .. '.other', {}, { temps = { reset = false, added = { s1 }, size = 1 } }), 'Changes to data that is not resident')
+return 'OK'
+)lua";
+
+static int dzventsstore_flush(lua_State *lua_state)
+{
+	CdzVentsStore *pStore = static_cast<CdzVentsStore *>(lua_touserdata(lua_state, lua_upvalueindex(1)));
+	std::vector<std::string> failed;
+	pStore->Flush(failed);
+	lua_pushboolean(lua_state, failed.empty());
+	return 1;
+}
+
+bool dzventsstore_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	// Roundtrip (input is the path of dzVents/runtime/persistence.lua)
+	if (szFunction != "Roundtrip")
+	{
+		szOutput = "NOT FOUND!";
+		return false;
+	}
+
+	const char *szTmpDir = getenv("TMPDIR");
+	std::string szBase = std::string((szTmpDir != nullptr) ? szTmpDir : "/tmp") + "/domoticztester_" + std::to_string(static_cast<int>(getpid()));
+	std::string szDataFile = szBase + "_data.lua";
+	std::string szPersistenceFile = szBase + "_persistence.lua";
+
+	CdzVentsStore store;
+	lua_State *lua_state = luaL_newstate();
+	luaL_openlibs(lua_state);
+	store.Register(lua_state);
+	lua_pushlightuserdata(lua_state, &store);
+	lua_pushcclosure(lua_state, dzventsstore_flush, 1);
+	lua_setglobal(lua_state, "flush");
+	lua_pushstring(lua_state, szDataFile.c_str());
+	lua_setglobal(lua_state, "dataFile");
+	lua_pushstring(lua_state, szPersistenceFile.c_str());
+	lua_setglobal(lua_state, "persistenceFile");
+
+	bool bSuccess = (luaL_dofile(lua_state, szInput.c_str()) == 0) && (luaL_dostring(lua_state, dzVentsStoreTest) == 0);
+	const char *szResult = lua_tostring(lua_state, -1);
+	szOutput = (szResult != nullptr) ? szResult : "no result";
+	bSuccess = bSuccess && (szOutput == "OK");
+	lua_close(lua_state);
+
+	remove(szDataFile.c_str());
+	remove(szPersistenceFile.c_str());
+	return bSuccess;
+}
+
+/* **********
+LuaEnvironment.cpp
+********** */
+
+// Two runs of classic scripts on one (persistent) state, the shared tables are the globals otherdevices and uservariables
+static const char *luaEnvironmentScripts[] = {
+	R"lua(
+local n = 0
+for k, v in pairs(otherdevices) do n = n + 1 end
+assert(n == 2, 'pairs does not walk the shared table')
+local k, v = next(otherdevices)
+assert((k ~= nil) and (otherdevices[k] == v), 'next does not walk the shared table')
+assert(rawget(otherdevices, 'a') == 'On', 'rawget does not read the shared table')
+assert((#uservariables == 3) and (rawlen(uservariables) == 3), '# does not count the shared table')
+local sum = 0
+for i, v in ipairs(uservariables) do sum = sum + v end
+assert(sum == 60, 'ipairs does not walk the shared table')
+otherdevices['a'] = 'Off'
+rawset(otherdevices, 'c', 'On')
+uservariables[#uservariables + 1] = 40
+assert((otherdevices['a'] == 'Off') and (#uservariables == 4), 'the script does not see its own writes')
+n = 0
+for k, v in pairs(otherdevices) do n = n + 1 end
+assert(n == 3, 'pairs does not walk the written table')
+leak = true
+_G.leak_G = true
+assert(_G.otherdevices == otherdevices, '_G is not the script environment')
+commandArray = {}
+return 'OK'
+)lua",
+	R"lua(
+assert((otherdevices['a'] == 'On') and (otherdevices['c'] == nil), 'a write reached the shared otherdevices')
+assert(#uservariables == 3, 'a write reached the shared uservariables')
+assert((leak == nil) and (leak_G == nil) and (_G.leak_G == nil), 'a global of the previous script is still set')
+assert(commandArray == nil, 'the commandArray of the previous script is still set')
+return 'OK'
+)lua",
+};
+
+bool luaenvironment_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	// Isolation (input is the comma separated list of shared tables that get a proxy: otherdevices,uservariables)
+	if (szFunction != "Isolation")
+	{
+		szOutput = "NOT FOUND!";
+		return false;
+	}
+
+	std::vector<std::string> tables;
+	StringSplit(szInput, ",", tables);
+
+	lua_State *lua_state = luaL_newstate();
+	luaL_openlibs(lua_state);
+	bool bSuccess = (luaL_dostring(lua_state, "otherdevices = { a = 'On', b = 'Off' } uservariables = { 10, 20, 30 }") == 0);
+	for (const char *szScript : luaEnvironmentScripts)
+	{
+		if (!bSuccess)
+			break;
+		lua_settop(lua_state, 0);
+		bSuccess = (luaL_loadstring(lua_state, szScript) == 0);
+		if (!bSuccess)
+			break;
+		int tEnv = PushLuaScriptEnvironment(lua_state);
+		for (const auto &szTable : tables)
+			AddLuaSharedTableProxy(lua_state, tEnv, szTable.c_str());
+		lua_setupvalue(lua_state, 1, 1); // _ENV
+		bSuccess = (lua_pcall(lua_state, 0, 1, 0) == 0);
+		const char *szResult = lua_tostring(lua_state, -1);
+		szOutput = (szResult != nullptr) ? szResult : "no result";
+		bSuccess = bSuccess && (szOutput == "OK");
+	}
+	if (bSuccess)
+	{
+		lua_settop(lua_state, 0);
+		bSuccess = (luaL_dostring(lua_state, "return ((otherdevices.a == 'On') and (otherdevices.c == nil) and (#uservariables == 3) and (leak == nil) and (leak_G == nil) "
+							"and (commandArray == nil)) and 'OK' or 'the shared globals changed'")
+			    == 0);
+		const char *szResult = lua_tostring(lua_state, -1);
+		szOutput = (szResult != nullptr) ? szResult : "no result";
+		bSuccess = bSuccess && (szOutput == "OK");
+	}
+	lua_close(lua_state);
+	return bSuccess;
+}
+
+/* **********
+HTTPClientEngine.cpp
+********** */
+
+// Listens on a free local port, returns the socket (or -1)
+static int httpclient_listen(int &port, const int backlog)
+{
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addrlen = sizeof(addr);
+	if ((bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) || (listen(fd, backlog) != 0)
+	    || (getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &addrlen) != 0))
+	{
+		close(fd);
+		return -1;
+	}
+	port = ntohs(addr.sin_port);
+	return fd;
+}
+
+// Answers every request of one (keep-alive) connection with szResponse
+static void httpclient_serve(const int listenfd, const std::string szResponse)
+{
+	int fd = accept(listenfd, nullptr, nullptr);
+	if (fd < 0)
+		return;
+	std::string szRequest;
+	char buffer[1024];
+	ssize_t len;
+	while ((len = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+	{
+		szRequest.append(buffer, static_cast<size_t>(len));
+		size_t pos;
+		while ((pos = szRequest.find("\r\n\r\n")) != std::string::npos)
+		{
+			szRequest.erase(0, pos + 4);
+			send(fd, szResponse.c_str(), szResponse.size(), 0);
+		}
+	}
+	close(fd);
+}
+
+static size_t httpclient_discard(void *contents, size_t size, size_t nmemb, void *userp)
+{
+	return size * nmemb;
+}
+
+static CURL *httpclient_request(const int port, const long TimeOutMs)
+{
+	CURL *curl = curl_easy_init();
+	curl_easy_setopt(curl, CURLOPT_URL, std_format("http://127.0.0.1:%d/test", port).c_str());
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, httpclient_discard);
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, TimeOutMs);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	return curl;
+}
+
+// Runs one request on the engine, szResult is the CURLcode and HTTP code as "code/http_code"
+static void httpclient_run(CHTTPClientEngine &engine, const int port, const long TimeOutMs, std::string &szResult)
+{
+	CURL *curl = httpclient_request(port, TimeOutMs);
+	std::shared_ptr<std::promise<CURLcode>> done = std::make_shared<std::promise<CURLcode>>();
+	std::future<CURLcode> result = done->get_future();
+	if (!engine.Submit(curl, [done](CURL *, const CURLcode res) { done->set_value(res); }))
+		szResult = "not submitted";
+	else if (result.wait_for(std::chrono::seconds(10)) != std::future_status::ready)
+		szResult = "no result"; // the handle is leaked, the engine still owns it
+	else
+	{
+		long http_code = 0;
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+		szResult = std_format("%d/%ld", static_cast<int>(result.get()), http_code);
+		curl_easy_cleanup(curl);
+		return;
+	}
+	if (szResult != "no result")
+		curl_easy_cleanup(curl);
+}
+
+bool httpclient_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+	curl_global_init(CURL_GLOBAL_ALL);
+
+	// Errors (input is the request timeout in ms, every failing transfer has to complete with its error and be counted as failed)
+	if (szFunction == "Errors")
+	{
+		long TimeOutMs = std::stol(szInput);
+		CHTTPClientEngine engine;
+		std::string szResult;
+		std::vector<std::string> vResults;
+		int port = 0;
+
+		// nothing listening
+		int fd = httpclient_listen(port, 1);
+		close(fd);
+		httpclient_run(engine, port, TimeOutMs, szResult);
+		vResults.push_back(std_format("refused=%s", (szResult == std_format("%d/0", CURLE_COULDNT_CONNECT)) ? "OK" : szResult.c_str()));
+
+		// HTTP error, the connection is kept
+		int errorport = 0;
+		fd = httpclient_listen(errorport, 1);
+		std::thread server(httpclient_serve, fd, std::string("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n"));
+		httpclient_run(engine, errorport, TimeOutMs, szResult);
+		std::string szSecond;
+		httpclient_run(engine, errorport, TimeOutMs, szSecond);
+		vResults.push_back(std_format("http=%s", ((szResult == std_format("%d/404", CURLE_OK)) && (szResult == szSecond)) ? "OK" : szResult.c_str()));
+
+		// no reply within the timeout
+		int silentport = 0;
+		int silentfd = httpclient_listen(silentport, 1);
+		httpclient_run(engine, silentport, TimeOutMs, szResult);
+		vResults.push_back(std_format("timeout=%s", (szResult == std_format("%d/0", CURLE_OPERATION_TIMEDOUT)) ? "OK" : szResult.c_str()));
+
+		// a transfer submitted from the engine thread (a completion callback) has to be refused, the caller performs it
+		CURL *curl = httpclient_request(port, TimeOutMs);
+		std::shared_ptr<std::promise<bool>> nested = std::make_shared<std::promise<bool>>();
+		std::future<bool> nestedresult = nested->get_future();
+		CHTTPClientEngine *pEngine = &engine;
+		bool bSubmitted = engine.Submit(curl, [pEngine, nested](CURL *curl, const CURLcode) { nested->set_value(pEngine->Submit(curl, [](CURL *, const CURLcode) {})); });
+		bool bNested = bSubmitted && (nestedresult.wait_for(std::chrono::seconds(10)) == std::future_status::ready) && !nestedresult.get();
+		vResults.push_back(std_format("nested=%s", bNested ? "OK" : "submitted"));
+		if (bNested)
+			curl_easy_cleanup(curl);
+
+		std::vector<HTTPClient::_tHostStatistics> stats;
+		engine.GetHostStatistics(stats);
+		std::string szStats = "stats=missing";
+		for (const auto &hstats : stats)
+		{
+			if (hstats.host == std_format("http://127.0.0.1:%d", errorport))
+				szStats = std_format("stats=%s", ((hstats.requests == 2) && (hstats.failed == 2) && (hstats.reused == 0)) ? "OK" : "wrong");
+		}
+		vResults.push_back(szStats);
+
+		engine.Stop();
+		shutdown(fd, SHUT_RDWR);
+		close(fd);
+		server.join();
+		close(silentfd);
+
+		szOutput.clear();
+		for (const auto &result : vResults)
+			szOutput += (szOutput.empty() ? "" : ",") + result;
+		bSuccess = true;
+	}
+	// Async (input is the body the server replies, the callback has to be called from the engine thread before the future is set)
+	else if (szFunction == "Async")
+	{
+		const long TimeOutMs = 5000;
+		CHTTPClientEngine engine;
+		std::vector<std::string> vResults;
+		int port = 0;
+		int fd = httpclient_listen(port, 1);
+		std::thread server(httpclient_serve, fd, std_format("HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n%s", static_cast<int>(szInput.size()), szInput.c_str()));
+
+		std::mutex callbackMutex;
+		std::vector<std::pair<std::thread::id, std::string>> callbacks;
+		HTTPClient::HTTPCallback callback = [&callbackMutex, &callbacks](const HTTPClient::_tHTTPResult &result) {
+			std::lock_guard<std::mutex> l(callbackMutex);
+			callbacks.emplace_back(std::this_thread::get_id(), std::string(result.response.begin(), result.response.end()));
+		};
+
+		std::future<HTTPClient::_tHTTPResult> future = engine.SubmitAsync(httpclient_request(port, TimeOutMs), nullptr, callback);
+		if (future.wait_for(std::chrono::seconds(10)) != std::future_status::ready)
+			vResults.push_back("future=no result");
+		else
+		{
+			HTTPClient::_tHTTPResult result = future.get();
+			std::string szBody(result.response.begin(), result.response.end());
+			std::lock_guard<std::mutex> l(callbackMutex);
+			vResults.push_back(std_format("callback=%s", ((callbacks.size() == 1) && (callbacks[0].first != std::this_thread::get_id()) && (callbacks[0].second == szInput)) ? "OK" : "wrong"));
+			vResults.push_back(std_format("future=%s", ((result.bOK) && (result.http_code == 200) && (szBody == szInput) && (!result.vHeaderData.empty()) && (result.vHeaderData[0] == "HTTP/1.1 200 OK")) ? "OK" : "wrong"));
+		}
+
+		// a failed transfer resolves the future as well, with a generated status line
+		int refusedport = 0;
+		int refusedfd = httpclient_listen(refusedport, 1);
+		close(refusedfd);
+		future = engine.SubmitAsync(httpclient_request(refusedport, TimeOutMs), nullptr, nullptr);
+		if (future.wait_for(std::chrono::seconds(10)) != std::future_status::ready)
+			vResults.push_back("refused=no result");
+		else
+		{
+			HTTPClient::_tHTTPResult result = future.get();
+			vResults.push_back(std_format("refused=%s", ((!result.bOK) && (result.http_code == 0) && (result.vHeaderData.size() == 1) && (result.vHeaderData[0].find(std_format("HTTP/1.1 %d ", CURLE_COULDNT_CONNECT)) == 0)) ? "OK" : "wrong"));
+		}
+
+		// a stopped engine performs the request in the calling thread, the future is ready on return
+		engine.Stop();
+		server.join(); // the kept connection is closed by the stop, serve the new one
+		server = std::thread(httpclient_serve, fd, std_format("HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n%s", static_cast<int>(szInput.size()), szInput.c_str()));
+		future = engine.SubmitAsync(httpclient_request(port, TimeOutMs), nullptr, callback);
+		bool bStopped = (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) && (future.get().bOK);
+		{
+			std::lock_guard<std::mutex> l(callbackMutex);
+			bStopped = bStopped && (callbacks.size() == 2) && (callbacks[1].first == std::this_thread::get_id()) && (callbacks[1].second == szInput);
+		}
+		vResults.push_back(std_format("stopped=%s", bStopped ? "OK" : "wrong"));
+
+		shutdown(fd, SHUT_RDWR);
+		close(fd);
+		server.join();
+
+		szOutput.clear();
+		for (const auto &result : vResults)
+			szOutput += (szOutput.empty() ? "" : ",") + result;
+		bSuccess = true;
+	}
+	// Stop (input is the number of transfers waiting for a reply when the engine is stopped, all have to complete as aborted)
+	else if (szFunction == "Stop")
+	{
+		int iTransfers = std::stoi(szInput);
+		if (iTransfers > 0)
+		{
+			int port = 0;
+			int fd = httpclient_listen(port, iTransfers);
+			CHTTPClientEngine engine;
+			std::vector<CURL *> handles;
+			std::mutex resultsMutex;
+			std::map<CURLcode, int> results;
+			for (int ii = 0; ii < iTransfers; ii++)
+			{
+				handles.push_back(httpclient_request(port, 60000));
+				if (!engine.Submit(handles.back(), [&resultsMutex, &results](CURL *, const CURLcode res) {
+					    std::lock_guard<std::mutex> l(resultsMutex);
+					    results[res]++;
+				    }))
+				{
+					std::lock_guard<std::mutex> l(resultsMutex);
+					results[CURLE_FAILED_INIT]++;
+				}
+			}
+			// let the engine connect them
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+			auto tStart = std::chrono::steady_clock::now();
+			engine.Stop();
+			double dStop = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+			if (bMeasure)
+				Log("Stopping with %d transfers in flight took %.3f s", iTransfers, dStop);
+
+			bool bRefused = !engine.Submit(handles.front(), [](CURL *, const CURLcode) {});
+			for (auto curl : handles)
+				curl_easy_cleanup(curl);
+			close(fd);
+
+			if ((results.size() != 1) || (results.begin()->first != CURLE_ABORTED_BY_CALLBACK) || (results.begin()->second != iTransfers))
+				szOutput = std_format("%d of %d transfers aborted", (results.find(CURLE_ABORTED_BY_CALLBACK) != results.end()) ? results[CURLE_ABORTED_BY_CALLBACK] : 0, iTransfers);
+			else if (dStop > 5)
+				szOutput = "Stop waited for the transfers";
+			else if (!bRefused)
+				szOutput = "Submitted after Stop";
+			else
+				szOutput = "OK";
+			bSuccess = (szOutput == "OK");
+		}
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	curl_global_cleanup();
+	return bSuccess;
+}
+
 /* **********
 Main function
 ********** */
@@ -307,9 +1681,101 @@ int main(int argc, char**argv)
 			return 1;
 		}
 	}
-	else if (false)
+	else if (szTestModule == "rfxnames")
+	{
+		try
+		{
+			bSuccess = rfxnames_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "rxqueue")
+	{
+		try
+		{
+			bSuccess = rxqueue_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "p1meter")
 	{
-		/* code */
+		try
+		{
+			bSuccess = p1meter_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "calendar")
+	{
+		try
+		{
+			bSuccess = calendar_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "dzvents")
+	{
+		try
+		{
+			bSuccess = dzvents_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "dzventsstore")
+	{
+		try
+		{
+			bSuccess = dzventsstore_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "luaenvironment")
+	{
+		try
+		{
+			bSuccess = luaenvironment_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
+	}
+	else if (szTestModule == "httpclient")
+	{
+		try
+		{
+			bSuccess = httpclient_tester(szTestFunction, szTestInput, szTestOutput);
+		}
+		catch(const std::exception& e)
+		{
+			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+			return 1;
+		}
 	}
 	else
 	{
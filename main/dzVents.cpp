@@ -40,12 +40,13 @@ std::string CdzVents::GetVersion()
 	return m_version;
 }
 
-void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus)
+void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus, const bool bPersistent)
 {
 	// reroute print library to Domoticz logger
 	luaL_openlibs(lua_state);
 	lua_pushcfunction(lua_state, l_domoticz_print);
 	lua_setglobal(lua_state, "print");
+	m_persistentData.Register(lua_state);
 
 	bool reasonTime = false;
 	bool reasonURL = false;
@@ -66,7 +67,7 @@ void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSys
 			reasonNotification = true;
 	}
 
-	ExportDomoticzDataToLua(lua_state, items);
+	ExportDomoticzDataToLua(lua_state, items, bPersistent);
 	SetGlobalVariables(lua_state, reasonTime, secStatus);
 
 	if (reasonURL)
@@ -79,6 +80,14 @@ void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSys
 		ProcessNotification(lua_state, items);
 }
 
+void CdzVents::FlushPersistentData()
+{
+	std::vector<std::string> failed;
+	m_persistentData.Flush(failed);
+	for (const auto &path : failed)
+		_log.Log(LOG_ERROR, "dzVents: Error writing persistent data to %s", path.c_str());
+}
+
 void CdzVents::ProcessNotificationItem(CLuaTable &luaTable, int &index, const CEventSystem::_tEventQueue& item)
 {
 	std::string type, status;
@@ -849,311 +858,34 @@ void CdzVents::SetGlobalVariables(lua_State *lua_state, const bool reasonTime, c
 	luaTable.Publish();
 }
 
-void CdzVents::ExportHardwareData(CLuaTable &luaTable, int& index, const std::vector<CEventSystem::_tEventQueue>& items)
+void CdzVents::ResetExportedData()
 {
-	;// to be implemented when hardware notification support is added
+	m_export.Reset();
 }
 
-void CdzVents::ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items)
+void CdzVents::ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const bool bPersistent)
 {
-	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_mainworker.m_eventsystem.m_devicestatesMutex);
-	int index = 1;
-	time_t now = mytime(nullptr);
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-	struct tm tLastUpdate;
-	localtime_r(&now, &tLastUpdate);
-	int SensorTimeOut = 60;
-	m_sql.GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	struct tm ntime;
-	time_t checktime;
-
-	CLuaTable luaTable(lua_state, "domoticzData");
-
-	// First export all the devices.
-	for (const auto &state : m_mainworker.m_eventsystem.m_devicestates)
-	{
-		CEventSystem::_tDeviceStatus sitem = state.second;
-		const char *dev_type = RFX_Type_Desc(sitem.devType, 1);
-		const char *sub_type = RFX_Type_SubType_Desc(sitem.devType, sitem.subType);
-
-		bool triggerDevice = false;
-		for (const auto &item : items)
-		{
-			if (sitem.ID > 0 && sitem.ID == item.id && item.reason == m_mainworker.m_eventsystem.REASON_DEVICE)
-			{
-				triggerDevice = true;
-				sitem.lastUpdate = item.lastUpdate;
-				sitem.lastLevel = item.lastLevel;
-				sitem.sValue = item.sValue;
-				sitem.nValueWording = item.nValueWording;
-				sitem.nValue = item.nValue;
-				if (!item.JsonMapString.empty())
-					sitem.JsonMapString = item.JsonMapString;
-				if (!item.JsonMapFloat.empty())
-					sitem.JsonMapFloat = item.JsonMapFloat;
-				if (!item.JsonMapInt.empty())
-					sitem.JsonMapInt = item.JsonMapInt;
-				if (!item.JsonMapBool.empty())
-					sitem.JsonMapBool = item.JsonMapBool;
-			}
-		}
-
-		ParseSQLdatetime(checktime, ntime, sitem.lastUpdate, tm1.tm_isdst);
-		bool timed_out = (now - checktime >= SensorTimeOut * 60);
-		if (sitem.ID > 0)
-		{
-			luaTable.OpenSubTableEntry(index, 1, 14);
-
-			luaTable.AddString("name", sitem.deviceName);
-			luaTable.AddBool("protected", (sitem.protection == 1) );
-			luaTable.AddInteger("id", sitem.ID);
-			luaTable.AddInteger("iconNumber", sitem.customImage);
-			luaTable.AddString("image", sitem.image);
-			luaTable.AddString("baseType","device");
-			luaTable.AddString("deviceType", dev_type);
-			luaTable.AddString("subType", sub_type);
-			luaTable.AddString("switchType", Switch_Type_Desc((_eSwitchType)sitem.switchtype));
-			luaTable.AddInteger("switchTypeValue", sitem.switchtype);
-			luaTable.AddString("lastUpdate", sitem.lastUpdate);
-			luaTable.AddInteger("lastLevel", sitem.lastLevel);
-			luaTable.AddBool("changed", triggerDevice);
-			luaTable.AddBool("timedOut", timed_out);
-
-			//get all svalues separate
-			std::vector<std::string> strarray;
-			StringSplit(sitem.sValue, ";", strarray);
-
-			luaTable.OpenSubTableEntry("rawData", 0, 0);
-			for (size_t i = 0; i < strarray.size(); i++)
-				luaTable.AddString(i + 1, strarray[i]);
-
-			luaTable.CloseSubTableEntry();
-
-			luaTable.AddString("deviceID", sitem.deviceID);
-			luaTable.AddString("description", sitem.description);
-			luaTable.AddInteger("batteryLevel", sitem.batteryLevel);
-			luaTable.AddInteger("signalLevel", sitem.signalLevel);
-
-			luaTable.OpenSubTableEntry("data", 0, 0);
-			luaTable.AddString("_state", sitem.nValueWording);
-			luaTable.AddInteger("_nValue", sitem.nValue);
-			luaTable.AddInteger("hardwareID", sitem.hardwareID);
-			if (sitem.devType == pTypeGeneral && sitem.subType == sTypeKwh)
-			{
-				long double value = 0.0F;
-				if (strarray.size() > 1)
-					value = atof(strarray[1].c_str());
-				luaTable.AddNumber("whTotal", value);
-				value = 0.0F;
-				if (!strarray.empty())
-					value = atof(strarray[0].c_str());
-				luaTable.AddNumber("whActual", value);
-			}
-
-			// Now see if we have additional fields from the JSON data
-			if (!sitem.JsonMapString.empty())
-			{
-				for (const auto &item : sitem.JsonMapString)
-				{
-					if (strcmp(m_mainworker.m_eventsystem.JsonMap[item.first].szOriginal, "LevelNames") == 0
-					    || strcmp(m_mainworker.m_eventsystem.JsonMap[item.first].szOriginal, "LevelActions") == 0)
-						luaTable.AddString(m_mainworker.m_eventsystem.JsonMap[item.first].szNew,
-								   base64_decode(item.second));
-					else
-						luaTable.AddString(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-				}
-			}
-
-			if (!sitem.JsonMapFloat.empty())
-			{
-				for (const auto &item : sitem.JsonMapFloat)
-					luaTable.AddNumber(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-			}
-
-			if (!sitem.JsonMapInt.empty())
-			{
-				for (const auto &item : sitem.JsonMapInt)
-					luaTable.AddInteger(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-			}
-
-			if (!sitem.JsonMapBool.empty())
-			{
-				for (const auto &item : sitem.JsonMapBool)
-					luaTable.AddBool(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-			}
-
-			luaTable.CloseSubTableEntry();
-			luaTable.CloseSubTableEntry();
-			index++;
-		}
-	}
-
-	devicestatesMutexLock.unlock();
-
-	// Now do the scenes and groups.
-	boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(m_mainworker.m_eventsystem.m_scenesgroupsMutex);
-
-	std::vector<std::vector<std::string> > result;
-
-	for (const auto &scene : m_mainworker.m_eventsystem.m_scenesgroups)
-	{
-		CEventSystem::_tScenesGroups sgitem = scene.second;
-		bool triggerScene = false;
-		for (const auto &item : items)
-		{
-			if (sgitem.ID == item.id && item.reason == m_mainworker.m_eventsystem.REASON_SCENEGROUP)
-			{
-				triggerScene = true;
-				sgitem.lastUpdate = item.lastUpdate;
-				sgitem.scenesgroupValue = item.sValue;
-			}
-		}
-
-		luaTable.OpenSubTableEntry(index, 1, 7);
-
-		luaTable.AddString("name", sgitem.scenesgroupName);
-		luaTable.AddInteger("id", sgitem.ID);
-		luaTable.AddString("description", sgitem.description);
-		luaTable.AddString("baseType", (sgitem.scenesgroupType == 0) ? "scene" : "group");
-		luaTable.AddBool("protected", (lua_Number)sgitem.protection == 1);
-		luaTable.AddString("lastUpdate", sgitem.lastUpdate);
-		luaTable.AddBool("changed", triggerScene);
-
-		luaTable.OpenSubTableEntry("data", 0, 0);
+	CEventSystem &eventsystem = m_mainworker.m_eventsystem;
 
-		luaTable.AddString("_state", sgitem.scenesgroupValue);
+	CEventSystem::_tDzVentsChanges changes;
+	eventsystem.GetDzVentsChanges(changes);
 
-		luaTable.CloseSubTableEntry();
-
-		luaTable.OpenSubTableEntry("deviceIDs", 0, 0);
-		if (!sgitem.memberID.empty())
-		{
-			int index = 1;
-			for (const auto &id : sgitem.memberID)
-			{
-				luaTable.AddInteger(index, id);
-				index++;
-			}
-		}
-
-		luaTable.CloseSubTableEntry(); // device table
-		luaTable.CloseSubTableEntry(); // end entry
-		index++;
-	}
-	scenesgroupsMutexLock.unlock();
-
-	std::string vtype;
-
-	// Now do the user variables.
-	boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(m_mainworker.m_eventsystem.m_uservariablesMutex);
-	for (const auto &var : m_mainworker.m_eventsystem.m_uservariables)
-	{
-		CEventSystem::_tUserVariable uvitem = var.second;
-		bool triggerVar = false;
-		for (const auto &item : items)
-		{
-			if (uvitem.ID == item.id && item.reason == m_mainworker.m_eventsystem.REASON_USERVARIABLE)
-			{
-				triggerVar = true;
-				uvitem.lastUpdate = item.lastUpdate;
-				uvitem.variableValue = item.sValue;
-			}
-		}
-
-		luaTable.OpenSubTableEntry(index, 1, 5);
-
-		luaTable.AddString("name", uvitem.variableName);
-		luaTable.AddInteger("id", uvitem.ID);
-		luaTable.AddString("baseType", "uservariable");
-		luaTable.AddString("lastUpdate", uvitem.lastUpdate);
-		luaTable.AddBool("changed", triggerVar);
-
-		luaTable.OpenSubTableEntry("data", 0, 0);
-
-		if (uvitem.variableType == 0)
-		{
-			luaTable.AddInteger("value", atoi(uvitem.variableValue.c_str()));
-			vtype = "integer";
-		}
-		else if (uvitem.variableType == 1)
-		{
-			//Float
-			luaTable.AddNumber("value", atof(uvitem.variableValue.c_str()));
-			vtype = "float";
-		}
-		else
-		{
-			//String,Date,Time
-			luaTable.AddString("value", uvitem.variableValue);
-			if (uvitem.variableType == 2)
-				vtype = "string";
-			else if (uvitem.variableType == 3)
-				vtype = "date";
-			else if (uvitem.variableType == 4)
-				vtype = "time";
-			else
-				vtype = "unknown";
-		}
-
-		luaTable.CloseSubTableEntry(); // data table
-
-		luaTable.AddString("variableType", vtype);
-
-		luaTable.CloseSubTableEntry(); // end entry
-
-		index++;
-	}
-
-	// Now do the cameras.
-	result = m_sql.safe_query("SELECT ID, Name FROM Cameras where enabled = '1' ORDER BY ID ASC");
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			luaTable.OpenSubTableEntry(index, 1, 3);
-			luaTable.AddString("name", sd[1]);
-			luaTable.AddInteger("id", atoi(sd[0].c_str()));
-			luaTable.AddString("baseType", "camera");
-			luaTable.CloseSubTableEntry(); // end entry
-
-			index++;
-		}
-	}
-
-	// Now do the Hardware.
-	result = m_sql.safe_query("SELECT ID, Name, type FROM Hardware where enabled = '1' ORDER BY ID ASC");
-	int HardwareTypeVal;
-
-	if (!result.empty())
-	{
-		for (const auto &sd : result)
-		{
-			HardwareTypeVal = atoi(sd[2].c_str());
-
-			luaTable.OpenSubTableEntry(index, 1, 6);
-			luaTable.AddString("name", sd[1]);
-			luaTable.AddInteger("id", atoi(sd[0].c_str()));
-			luaTable.AddInteger("typeValue", HardwareTypeVal);
-			luaTable.AddString("baseType", "hardware");
-			if (HardwareTypeVal != HTYPE_PythonPlugin)
-			{
-				luaTable.AddString("typeName",Hardware_Type_Desc(HardwareTypeVal));
-				luaTable.AddBool("isPythonPlugin", false);
-			}
-			else
-			{
-				luaTable.AddString("typeName", "Python plugin");
-				luaTable.AddBool("isPythonPlugin", true);
-			}
-			luaTable.CloseSubTableEntry(); // end entry
-
-			index++;
-		}
-	}
-
-	ExportHardwareData(luaTable, index, items);
+	int SensorTimeOut = 60;
+	m_sql.GetPreferencesVar("SensorTimeout", SensorTimeOut);
 
-	luaTable.Publish();
+	CdzVentsExport::_tSource source{ eventsystem.m_devicestates,  eventsystem.m_devicestatesMutex,	eventsystem.m_scenesgroups,
+					 eventsystem.m_scenesgroupsMutex, eventsystem.m_uservariables, eventsystem.m_uservariablesMutex,
+					 mytime(nullptr), SensorTimeOut,
+					 // read before the queries, a change while exporting makes the next event export everything again
+					 m_sql.GetHardwareDataGeneration(),
+					 [](CdzVentsExport::_tRows &cameras, CdzVentsExport::_tRows &hardware) {
+						 cameras = m_sql.safe_query("SELECT ID, Name FROM Cameras where enabled = '1' ORDER BY ID ASC");
+						 hardware = m_sql.safe_query("SELECT ID, Name, type FROM Hardware where enabled = '1' ORDER BY ID ASC");
+					 } };
+
+	// dzVents.lua dumps domoticzData at debug level, the dump has to show every field
+	int logLevel = 0;
+	m_sql.GetPreferencesVar("DzVentsLogLevel", logLevel);
+
+	m_export.Export(lua_state, source, items, changes, bPersistent, (logLevel != 4));
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "EventSystem.h"
 #include "LuaTable.h"
+#include "dzVentsStore.h"
+#include "dzVentsExport.h"
 
 class CdzVents
 {
@@ -14,7 +16,9 @@ public:
   std::string GetVersion();
   void LoadEvents();
   bool processLuaCommand(lua_State *lua_state, const std::string &filename, const int tIndex);
-  void EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus);
+  void EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus, const bool bPersistent);
+  void ResetExportedData();
+  void FlushPersistentData();
 
   std::string m_scriptsDir, m_runtimeDir;
   bool m_bdzVentsExist;
@@ -48,8 +52,7 @@ private:
 	bool CancelItem(lua_State *lua_state, const std::vector<_tLuaTableValues> &vLuaTable, const std::string &eventName);
 	bool TriggerIFTTT(lua_State *lua_state, const std::vector<_tLuaTableValues> &vLuaTable);
 	bool TriggerCustomEvent(lua_State *lua_state, const std::vector<_tLuaTableValues>& vLuaTable);
-	void ExportHardwareData(CLuaTable &luaTable, int& index, const std::vector<CEventSystem::_tEventQueue>& items);
-	void ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items);
+	void ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, bool bPersistent);
 	void IterateTable(lua_State *lua_state, const int tIndex, std::vector<_tLuaTableValues> &vLuaTable);
 	void SetGlobalVariables(lua_State *lua_state, const bool reasonTime, const int secStatus);
 	void ProcessHttpResponse(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items);
@@ -60,4 +63,6 @@ private:
 	static int l_domoticz_print(lua_State* lua_state);
 	static CdzVents m_dzvents;
 	std::string m_version;
+	CdzVentsExport m_export;
+	CdzVentsStore m_persistentData;
 };
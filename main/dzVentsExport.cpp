@@ -0,0 +1,650 @@
+#include "stdafx.h"
+#include "dzVentsExport.h"
+#include "Helper.h"
+#include "localtime_r.h"
+#include "../hardware/hardwaretypes.h"
+#include "../webserver/Base64.h"
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+// This table specifies which JSON fields are passed to the LUA scripts.
+// If new return fields are added in CWebServer::GetJSonDevices, they should
+// be added to this table.
+const CEventSystem::_tJsonMap CEventSystem::JsonMap[] = {
+	{ "Barometer", "barometer", JTYPE_FLOAT },
+	{ "CameraIndx", "cameraIdx", JTYPE_STRING },
+	{ "Chill", "chill", JTYPE_FLOAT },
+	{ "Color", "color", JTYPE_STRING },
+	{ "Counter", "counter", JTYPE_STRING },
+	{ "CounterDeliv", "counterDelivered", JTYPE_FLOAT },
+	{ "CounterDelivToday", "counterDeliveredToday", JTYPE_STRING },
+	{ "CounterToday", "counterToday", JTYPE_STRING },
+	{ "Current", "current", JTYPE_FLOAT },
+	{ "CustomImage", "customImage", JTYPE_INT },
+	{ "DewPoint", "dewPoint", JTYPE_FLOAT },
+	{ "Direction", "direction", JTYPE_FLOAT },
+	{ "DirectionStr", "directionString", JTYPE_STRING },
+	{ "Forecast", "forecast", JTYPE_INT },
+	{ "ForecastStr", "forecastString", JTYPE_STRING },
+	{ "HardwareName", "hardwareName", JTYPE_STRING },
+	{ "HardwareType", "hardwareType", JTYPE_STRING },
+	{ "HardwareTypeVal", "hardwareTypeValue", JTYPE_INT },
+	{ "Humidity", "humidity", JTYPE_INT },
+	{ "HumidityStatus", "humidityStatus", JTYPE_STRING },
+	{ "Image", "Image", JTYPE_STRING },
+	{ "InternalState", "internalState", JTYPE_STRING }, // door contact
+	{ "LevelActions", "levelActions", JTYPE_STRING },
+	{ "LevelInt", "levelVal", JTYPE_INT },
+	{ "LevelNames", "levelNames", JTYPE_STRING },
+	{ "LevelOffHidden", "levelOffHidden", JTYPE_BOOL },
+	{ "MaxDimLevel", "maxDimLevel", JTYPE_INT },
+	{ "Mode", "mode", JTYPE_INT }, // zwave thermostat
+	{ "Modes", "modes", JTYPE_STRING },
+	{ "Moisture", "moisture", JTYPE_STRING },
+	{ "Pressure", "pressure", JTYPE_FLOAT },
+	{ "Protected", "protected", JTYPE_BOOL },
+	{ "Quality", "quality", JTYPE_STRING },
+	{ "Radiation", "radiation", JTYPE_FLOAT },
+	{ "Rain", "rain", JTYPE_FLOAT },
+	{ "RainRate", "rainRate", JTYPE_FLOAT },
+	{ "SensorType", "sensorType", JTYPE_INT },
+	{ "SensorUnit", "sensorUnit", JTYPE_STRING },
+	{ "SetPoint", "setPoint", JTYPE_FLOAT },
+	{ "Speed", "speed", JTYPE_FLOAT },
+	{ "Temp", "temperature", JTYPE_FLOAT },
+	{ "TypeImg", "icon", JTYPE_STRING },
+	{ "Unit", "unit", JTYPE_INT },
+	{ "Until", "until", JTYPE_STRING }, // evohome zone/water
+	{ "Usage", "usage", JTYPE_STRING },
+	{ "UsedByCamera", "usedByCamera", JTYPE_BOOL },
+	{ "UsageDeliv", "usageDelivered", JTYPE_STRING },
+	{ "ValueQuantity", "valueQuantity", JTYPE_STRING },
+	{ "ValueUnits", "valueUnits", JTYPE_STRING },
+	{ "Visibility", "visibility", JTYPE_FLOAT },
+	{ "Voltage", "voltage", JTYPE_FLOAT },
+	{ nullptr, nullptr, JTYPE_STRING },
+};
+
+static void SetLuaString(lua_State *lua_state, const char *szName, const std::string &Value)
+{
+	lua_pushstring(lua_state, Value.c_str());
+	lua_setfield(lua_state, -2, szName);
+}
+
+static void SetLuaInteger(lua_State *lua_state, const char *szName, const int64_t Value)
+{
+	lua_pushinteger(lua_state, (lua_Integer)Value);
+	lua_setfield(lua_state, -2, szName);
+}
+
+static void SetLuaNumber(lua_State *lua_state, const char *szName, const long double Value)
+{
+	lua_pushnumber(lua_state, (lua_Number)Value);
+	lua_setfield(lua_state, -2, szName);
+}
+
+static void SetLuaBool(lua_State *lua_state, const char *szName, const bool Value)
+{
+	lua_pushboolean(lua_state, Value);
+	lua_setfield(lua_state, -2, szName);
+}
+
+static time_t GetLastUpdateTime(const std::string &lastUpdate, const int isdst)
+{
+	struct tm ntime;
+	time_t checktime = 0;
+	if (!ParseSQLdatetime(checktime, ntime, lastUpdate, isdst))
+		return 0; // unknown, never times out
+	return checktime;
+}
+
+void CdzVentsExport::Export(lua_State *lua_state, const _tSource &source, const std::vector<CEventSystem::_tEventQueue> &items, const CEventSystem::_tDzVentsChanges &changes,
+			    const bool bPersistent, const bool bLazy)
+{
+	if (!bPersistent)
+	{
+		Reset();
+		ExportAllData(lua_state, source, items, false, false);
+		return;
+	}
+
+	if ((!bLazy) || (!m_exported.bValid) || (changes.bListChanged) || (!ExportChangedData(lua_state, source, items, changes)))
+		ExportAllData(lua_state, source, items, true, bLazy);
+}
+
+void CdzVentsExport::Reset()
+{
+	// The Lua state holding domoticzData was closed
+	m_exported = _tExportedData();
+}
+
+void CdzVentsExport::ExportHardwareData(lua_State *lua_state, const int tData, int &index, const std::vector<CEventSystem::_tEventQueue> &items)
+{
+	;// to be implemented when hardware notification support is added
+}
+
+void CdzVentsExport::GetTriggerItems(const std::vector<CEventSystem::_tEventQueue> &items, _tTriggerItems &triggers)
+{
+	for (const auto &item : items)
+	{
+		if (item.reason == CEventSystem::REASON_DEVICE)
+		{
+			if (item.id > 0)
+				triggers.devices[item.id].push_back(&item);
+		}
+		else if (item.reason == CEventSystem::REASON_SCENEGROUP)
+			triggers.scenesgroups[item.id] = &item;
+		else if (item.reason == CEventSystem::REASON_USERVARIABLE)
+			triggers.uservariables[item.id] = &item;
+	}
+}
+
+void CdzVentsExport::ExportDevice(lua_State *lua_state, const CEventSystem::_tDeviceStatus &state, const _tTriggerItems &triggers, const time_t now, const bool bKeep, const bool bLazy,
+			    const int slot)
+{
+	// Pushes the domoticzData entry of a device
+	const CEventSystem::_tDeviceStatus *pState = &state;
+	CEventSystem::_tDeviceStatus triggerState;
+	auto ittTrigger = triggers.devices.find(state.ID);
+	bool bTrigger = (ittTrigger != triggers.devices.end());
+	if (bTrigger)
+	{
+		triggerState = state;
+		for (const auto *pItem : ittTrigger->second)
+		{
+			triggerState.lastUpdate = pItem->lastUpdate;
+			triggerState.lastLevel = pItem->lastLevel;
+			triggerState.sValue = pItem->sValue;
+			triggerState.nValueWording = pItem->nValueWording;
+			triggerState.nValue = pItem->nValue;
+			if (!pItem->JsonMapString.empty())
+				triggerState.JsonMapString = pItem->JsonMapString;
+			if (!pItem->JsonMapFloat.empty())
+				triggerState.JsonMapFloat = pItem->JsonMapFloat;
+			if (!pItem->JsonMapInt.empty())
+				triggerState.JsonMapInt = pItem->JsonMapInt;
+			if (!pItem->JsonMapBool.empty())
+				triggerState.JsonMapBool = pItem->JsonMapBool;
+		}
+		pState = &triggerState;
+	}
+	const CEventSystem::_tDeviceStatus &sitem = *pState;
+
+	time_t lastUpdate = GetLastUpdateTime(sitem.lastUpdate, m_exported.isdst);
+	time_t timeOut = lastUpdate + (time_t)m_exported.sensorTimeOut * 60;
+	bool bTimedOut = ((lastUpdate != 0) && (now >= timeOut));
+
+	lua_createtable(lua_state, 0, 20);
+	SetLuaString(lua_state, "name", sitem.deviceName);
+	SetLuaBool(lua_state, "protected", (sitem.protection == 1));
+	SetLuaInteger(lua_state, "id", sitem.ID);
+	SetLuaInteger(lua_state, "iconNumber", sitem.customImage);
+	SetLuaString(lua_state, "image", sitem.image);
+	SetLuaString(lua_state, "baseType", "device");
+	SetLuaString(lua_state, "deviceType", RFX_Type_Desc(sitem.devType, 1));
+	SetLuaString(lua_state, "subType", RFX_Type_SubType_Desc(sitem.devType, sitem.subType));
+	SetLuaString(lua_state, "switchType", Switch_Type_Desc((_eSwitchType)sitem.switchtype));
+	SetLuaInteger(lua_state, "switchTypeValue", sitem.switchtype);
+	SetLuaString(lua_state, "lastUpdate", sitem.lastUpdate);
+	SetLuaInteger(lua_state, "lastLevel", sitem.lastLevel);
+	SetLuaBool(lua_state, "changed", bTrigger);
+	SetLuaBool(lua_state, "timedOut", bTimedOut);
+	SetLuaString(lua_state, "deviceID", sitem.deviceID);
+	SetLuaString(lua_state, "description", sitem.description);
+	SetLuaInteger(lua_state, "batteryLevel", sitem.batteryLevel);
+	SetLuaInteger(lua_state, "signalLevel", sitem.signalLevel);
+
+	if (bLazy)
+	{
+		// rawData and data are only built when a script uses the device
+		if (luaL_newmetatable(lua_state, "dzVents.device"))
+		{
+			lua_pushlightuserdata(lua_state, this);
+			lua_pushcclosure(lua_state, l_domoticz_device_index, 1);
+			lua_setfield(lua_state, -2, "__index");
+		}
+		lua_setmetatable(lua_state, -2);
+	}
+	else
+	{
+		PushDeviceRawData(lua_state, sitem);
+		lua_setfield(lua_state, -2, "rawData");
+		PushDeviceData(lua_state, sitem);
+		lua_setfield(lua_state, -2, "data");
+	}
+
+	if (!bKeep)
+		return;
+
+	_tExportedDevice &exported = m_exported.devices[sitem.ID];
+	exported.slot = slot;
+	exported.lastUpdate = lastUpdate;
+	exported.state = sitem;
+	if ((lastUpdate != 0) && (!bTimedOut))
+		m_exported.timeouts.insert(std::make_pair(timeOut, sitem.ID));
+	if (bTrigger)
+		m_exported.triggered.push_back(std::make_pair(CEventSystem::REASON_DEVICE, sitem.ID));
+}
+
+void CdzVentsExport::PushDeviceRawData(lua_State *lua_state, const CEventSystem::_tDeviceStatus &sitem)
+{
+	// get all svalues separate
+	std::vector<std::string> strarray;
+	StringSplit(sitem.sValue, ";", strarray);
+
+	lua_createtable(lua_state, (int)strarray.size(), 0);
+	for (size_t i = 0; i < strarray.size(); i++)
+	{
+		lua_pushstring(lua_state, strarray[i].c_str());
+		lua_rawseti(lua_state, -2, (lua_Integer)(i + 1));
+	}
+}
+
+void CdzVentsExport::PushDeviceData(lua_State *lua_state, const CEventSystem::_tDeviceStatus &sitem)
+{
+	lua_createtable(lua_state, 0, 3);
+	SetLuaString(lua_state, "_state", sitem.nValueWording);
+	SetLuaInteger(lua_state, "_nValue", sitem.nValue);
+	SetLuaInteger(lua_state, "hardwareID", sitem.hardwareID);
+	if (sitem.devType == pTypeGeneral && sitem.subType == sTypeKwh)
+	{
+		std::vector<std::string> strarray;
+		StringSplit(sitem.sValue, ";", strarray);
+
+		long double value = 0.0F;
+		if (strarray.size() > 1)
+			value = atof(strarray[1].c_str());
+		SetLuaNumber(lua_state, "whTotal", value);
+		value = 0.0F;
+		if (!strarray.empty())
+			value = atof(strarray[0].c_str());
+		SetLuaNumber(lua_state, "whActual", value);
+	}
+
+	// Now see if we have additional fields from the JSON data
+	for (const auto &item : sitem.JsonMapString)
+	{
+		const CEventSystem::_tJsonMap &jsonMap = CEventSystem::JsonMap[item.first];
+		if (strcmp(jsonMap.szOriginal, "LevelNames") == 0 || strcmp(jsonMap.szOriginal, "LevelActions") == 0)
+			SetLuaString(lua_state, jsonMap.szNew, base64_decode(item.second));
+		else
+			SetLuaString(lua_state, jsonMap.szNew, item.second);
+	}
+	for (const auto &item : sitem.JsonMapFloat)
+		SetLuaNumber(lua_state, CEventSystem::JsonMap[item.first].szNew, item.second);
+	for (const auto &item : sitem.JsonMapInt)
+		SetLuaInteger(lua_state, CEventSystem::JsonMap[item.first].szNew, item.second);
+	for (const auto &item : sitem.JsonMapBool)
+		SetLuaBool(lua_state, CEventSystem::JsonMap[item.first].szNew, item.second);
+}
+
+int CdzVentsExport::l_domoticz_device_index(lua_State *lua_state)
+{
+	// __index of the device entries, builds rawData and data from the exported state on first access
+	if (lua_type(lua_state, 2) != LUA_TSTRING)
+		return 0;
+	const char *szKey = lua_tostring(lua_state, 2);
+	bool bRawData = (strcmp(szKey, "rawData") == 0);
+	if ((!bRawData) && (strcmp(szKey, "data") != 0))
+		return 0;
+
+	lua_pushstring(lua_state, "id");
+	lua_rawget(lua_state, 1);
+	uint64_t ID = (uint64_t)lua_tointeger(lua_state, -1);
+	lua_pop(lua_state, 1);
+
+	const CdzVentsExport *pExport = static_cast<const CdzVentsExport *>(lua_touserdata(lua_state, lua_upvalueindex(1)));
+	auto itt = pExport->m_exported.devices.find(ID);
+	if (itt == pExport->m_exported.devices.end())
+		return 0;
+	if (bRawData)
+		PushDeviceRawData(lua_state, itt->second.state);
+	else
+		PushDeviceData(lua_state, itt->second.state);
+	lua_pushvalue(lua_state, 2);
+	lua_pushvalue(lua_state, -2);
+	lua_rawset(lua_state, 1);
+	return 1;
+}
+
+void CdzVentsExport::PushSceneGroup(lua_State *lua_state, const CEventSystem::_tScenesGroups &sgitem, const CEventSystem::_tEventQueue *pItem)
+{
+	lua_createtable(lua_state, 0, 9);
+	SetLuaString(lua_state, "name", sgitem.scenesgroupName);
+	SetLuaInteger(lua_state, "id", sgitem.ID);
+	SetLuaString(lua_state, "description", sgitem.description);
+	SetLuaString(lua_state, "baseType", (sgitem.scenesgroupType == 0) ? "scene" : "group");
+	SetLuaBool(lua_state, "protected", sgitem.protection == 1);
+	SetLuaString(lua_state, "lastUpdate", (pItem != nullptr) ? pItem->lastUpdate : sgitem.lastUpdate);
+	SetLuaBool(lua_state, "changed", (pItem != nullptr));
+
+	lua_createtable(lua_state, 0, 1);
+	SetLuaString(lua_state, "_state", (pItem != nullptr) ? pItem->sValue : sgitem.scenesgroupValue);
+	lua_setfield(lua_state, -2, "data");
+
+	lua_createtable(lua_state, (int)sgitem.memberID.size(), 0);
+	int index = 1;
+	for (const auto &id : sgitem.memberID)
+	{
+		lua_pushinteger(lua_state, (lua_Integer)id);
+		lua_rawseti(lua_state, -2, index);
+		index++;
+	}
+	lua_setfield(lua_state, -2, "deviceIDs");
+}
+
+void CdzVentsExport::PushUserVariable(lua_State *lua_state, const CEventSystem::_tUserVariable &uvitem, const CEventSystem::_tEventQueue *pItem)
+{
+	const std::string &variableValue = (pItem != nullptr) ? pItem->sValue : uvitem.variableValue;
+	std::string vtype;
+
+	lua_createtable(lua_state, 0, 7);
+	SetLuaString(lua_state, "name", uvitem.variableName);
+	SetLuaInteger(lua_state, "id", uvitem.ID);
+	SetLuaString(lua_state, "baseType", "uservariable");
+	SetLuaString(lua_state, "lastUpdate", (pItem != nullptr) ? pItem->lastUpdate : uvitem.lastUpdate);
+	SetLuaBool(lua_state, "changed", (pItem != nullptr));
+
+	lua_createtable(lua_state, 0, 1);
+	if (uvitem.variableType == 0)
+	{
+		SetLuaInteger(lua_state, "value", atoi(variableValue.c_str()));
+		vtype = "integer";
+	}
+	else if (uvitem.variableType == 1)
+	{
+		//Float
+		SetLuaNumber(lua_state, "value", atof(variableValue.c_str()));
+		vtype = "float";
+	}
+	else
+	{
+		//String,Date,Time
+		SetLuaString(lua_state, "value", variableValue);
+		if (uvitem.variableType == 2)
+			vtype = "string";
+		else if (uvitem.variableType == 3)
+			vtype = "date";
+		else if (uvitem.variableType == 4)
+			vtype = "time";
+		else
+			vtype = "unknown";
+	}
+	lua_setfield(lua_state, -2, "data");
+
+	SetLuaString(lua_state, "variableType", vtype);
+}
+
+void CdzVentsExport::ExportAllData(lua_State *lua_state, const _tSource &source, const std::vector<CEventSystem::_tEventQueue> &items, const bool bKeep, const bool bLazy)
+{
+	if (m_exported.bValid)
+		luaL_unref(lua_state, LUA_REGISTRYINDEX, m_exported.ref);
+	Reset();
+	m_bLastExportFull = true;
+
+	_tTriggerItems triggers;
+	GetTriggerItems(items, triggers);
+
+	const time_t now = source.now;
+	struct tm tm1;
+	localtime_r(&now, &tm1);
+	m_exported.isdst = tm1.tm_isdst;
+	m_exported.sensorTimeOut = source.sensorTimeOut;
+	m_exported.lastExport = now;
+	m_exported.hardwareGeneration = source.hardwareGeneration;
+
+	lua_newtable(lua_state);
+	const int tData = lua_gettop(lua_state);
+	int index = 1;
+
+	// First export all the devices.
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(source.devicesMutex);
+	for (const auto &state : source.devices)
+	{
+		if (state.second.ID == 0)
+			continue;
+		ExportDevice(lua_state, state.second, triggers, now, bKeep, bLazy, index);
+		lua_rawseti(lua_state, tData, index);
+		index++;
+	}
+	devicestatesMutexLock.unlock();
+
+	// Now do the scenes and groups.
+	boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(source.scenesgroupsMutex);
+	for (const auto &scene : source.scenesgroups)
+	{
+		auto itt = triggers.scenesgroups.find(scene.first);
+		const CEventSystem::_tEventQueue *pItem = (itt != triggers.scenesgroups.end()) ? itt->second : nullptr;
+		PushSceneGroup(lua_state, scene.second, pItem);
+		lua_rawseti(lua_state, tData, index);
+		if (bKeep)
+		{
+			m_exported.scenesgroups[scene.first] = index;
+			if (pItem != nullptr)
+				m_exported.triggered.push_back(std::make_pair(CEventSystem::REASON_SCENEGROUP, scene.first));
+		}
+		index++;
+	}
+	scenesgroupsMutexLock.unlock();
+
+	// Now do the user variables.
+	boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(source.uservariablesMutex);
+	for (const auto &var : source.uservariables)
+	{
+		auto itt = triggers.uservariables.find(var.first);
+		const CEventSystem::_tEventQueue *pItem = (itt != triggers.uservariables.end()) ? itt->second : nullptr;
+		PushUserVariable(lua_state, var.second, pItem);
+		lua_rawseti(lua_state, tData, index);
+		if (bKeep)
+		{
+			m_exported.uservariables[var.first] = index;
+			if (pItem != nullptr)
+				m_exported.triggered.push_back(std::make_pair(CEventSystem::REASON_USERVARIABLE, var.first));
+		}
+		index++;
+	}
+	uservariablesMutexLock.unlock();
+
+	// Now do the cameras.
+	_tRows cameras, hardware;
+	source.getCamerasAndHardware(cameras, hardware);
+	for (const auto &sd : cameras)
+	{
+		lua_createtable(lua_state, 0, 3);
+		SetLuaString(lua_state, "name", sd[1]);
+		SetLuaInteger(lua_state, "id", atoi(sd[0].c_str()));
+		SetLuaString(lua_state, "baseType", "camera");
+		lua_rawseti(lua_state, tData, index);
+		index++;
+	}
+
+	// Now do the Hardware.
+	for (const auto &sd : hardware)
+	{
+		int HardwareTypeVal = atoi(sd[2].c_str());
+
+		lua_createtable(lua_state, 0, 6);
+		SetLuaString(lua_state, "name", sd[1]);
+		SetLuaInteger(lua_state, "id", atoi(sd[0].c_str()));
+		SetLuaInteger(lua_state, "typeValue", HardwareTypeVal);
+		SetLuaString(lua_state, "baseType", "hardware");
+		if (HardwareTypeVal != HTYPE_PythonPlugin)
+		{
+			SetLuaString(lua_state, "typeName", Hardware_Type_Desc(HardwareTypeVal));
+			SetLuaBool(lua_state, "isPythonPlugin", false);
+		}
+		else
+		{
+			SetLuaString(lua_state, "typeName", "Python plugin");
+			SetLuaBool(lua_state, "isPythonPlugin", true);
+		}
+		lua_rawseti(lua_state, tData, index);
+		index++;
+	}
+
+	ExportHardwareData(lua_state, tData, index, items);
+
+	if (bKeep)
+	{
+		lua_pushvalue(lua_state, tData);
+		m_exported.ref = luaL_ref(lua_state, LUA_REGISTRYINDEX);
+		m_exported.bValid = true;
+	}
+	lua_setglobal(lua_state, "domoticzData");
+}
+
+bool CdzVentsExport::ExportChangedData(lua_State *lua_state, const _tSource &source, const std::vector<CEventSystem::_tEventQueue> &items, const CEventSystem::_tDzVentsChanges &changes)
+{
+	// Replaces the entries of the changed items in the kept domoticzData, false when the list itself has to change
+	if (source.hardwareGeneration != m_exported.hardwareGeneration)
+		return false;
+
+	int iBase = lua_gettop(lua_state);
+	lua_rawgeti(lua_state, LUA_REGISTRYINDEX, m_exported.ref);
+	if (!lua_istable(lua_state, -1))
+	{
+		lua_settop(lua_state, iBase);
+		return false;
+	}
+	const int tData = lua_gettop(lua_state);
+
+	_tTriggerItems triggers;
+	GetTriggerItems(items, triggers);
+
+	// Changed items, items triggering now, and items that were exported with the values of the previous trigger
+	std::set<uint64_t> devices = changes.devices;
+	std::set<uint64_t> scenesgroups = changes.scenesgroups;
+	std::set<uint64_t> uservariables = changes.uservariables;
+	for (const auto &trigger : m_exported.triggered)
+	{
+		if (trigger.first == CEventSystem::REASON_DEVICE)
+			devices.insert(trigger.second);
+		else if (trigger.first == CEventSystem::REASON_SCENEGROUP)
+			scenesgroups.insert(trigger.second);
+		else
+			uservariables.insert(trigger.second);
+	}
+	m_exported.triggered.clear();
+	for (const auto &trigger : triggers.devices)
+		devices.insert(trigger.first);
+	for (const auto &trigger : triggers.scenesgroups)
+		scenesgroups.insert(trigger.first);
+	for (const auto &trigger : triggers.uservariables)
+		uservariables.insert(trigger.first);
+
+	const time_t now = source.now;
+	struct tm tm1;
+	localtime_r(&now, &tm1);
+	const int SensorTimeOut = source.sensorTimeOut;
+	bool bRecheckAll = ((SensorTimeOut != m_exported.sensorTimeOut) || (tm1.tm_isdst != m_exported.isdst) || (now < m_exported.lastExport));
+
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(source.devicesMutex);
+	for (const auto &ID : devices)
+	{
+		auto itt = source.devices.find(ID);
+		auto ittExported = m_exported.devices.find(ID);
+		if ((itt == source.devices.end()) || (ittExported == m_exported.devices.end()))
+		{
+			if ((itt == source.devices.end()) && (ittExported == m_exported.devices.end()))
+				continue;
+			lua_settop(lua_state, iBase);
+			return false;
+		}
+		if (ittExported->second.lastUpdate != 0)
+			m_exported.timeouts.erase(std::make_pair(ittExported->second.lastUpdate + (time_t)m_exported.sensorTimeOut * 60, ID));
+		int slot = ittExported->second.slot;
+		ExportDevice(lua_state, itt->second, triggers, now, true, true, slot);
+		lua_rawseti(lua_state, tData, slot);
+	}
+	devicestatesMutexLock.unlock();
+
+	boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(source.scenesgroupsMutex);
+	for (const auto &ID : scenesgroups)
+	{
+		auto itt = source.scenesgroups.find(ID);
+		auto ittExported = m_exported.scenesgroups.find(ID);
+		if ((itt == source.scenesgroups.end()) || (ittExported == m_exported.scenesgroups.end()))
+		{
+			if ((itt == source.scenesgroups.end()) && (ittExported == m_exported.scenesgroups.end()))
+				continue;
+			lua_settop(lua_state, iBase);
+			return false;
+		}
+		auto ittTrigger = triggers.scenesgroups.find(ID);
+		const CEventSystem::_tEventQueue *pItem = (ittTrigger != triggers.scenesgroups.end()) ? ittTrigger->second : nullptr;
+		PushSceneGroup(lua_state, itt->second, pItem);
+		lua_rawseti(lua_state, tData, ittExported->second);
+		if (pItem != nullptr)
+			m_exported.triggered.push_back(std::make_pair(CEventSystem::REASON_SCENEGROUP, ID));
+	}
+	scenesgroupsMutexLock.unlock();
+
+	boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(source.uservariablesMutex);
+	for (const auto &ID : uservariables)
+	{
+		auto itt = source.uservariables.find(ID);
+		auto ittExported = m_exported.uservariables.find(ID);
+		if ((itt == source.uservariables.end()) || (ittExported == m_exported.uservariables.end()))
+		{
+			if ((itt == source.uservariables.end()) && (ittExported == m_exported.uservariables.end()))
+				continue;
+			lua_settop(lua_state, iBase);
+			return false;
+		}
+		auto ittTrigger = triggers.uservariables.find(ID);
+		const CEventSystem::_tEventQueue *pItem = (ittTrigger != triggers.uservariables.end()) ? ittTrigger->second : nullptr;
+		PushUserVariable(lua_state, itt->second, pItem);
+		lua_rawseti(lua_state, tData, ittExported->second);
+		if (pItem != nullptr)
+			m_exported.triggered.push_back(std::make_pair(CEventSystem::REASON_USERVARIABLE, ID));
+	}
+	uservariablesMutexLock.unlock();
+
+	m_exported.sensorTimeOut = SensorTimeOut;
+	m_exported.isdst = tm1.tm_isdst;
+	m_exported.lastExport = now;
+	UpdateTimeOuts(lua_state, tData, now, bRecheckAll);
+
+	lua_pushvalue(lua_state, tData);
+	lua_setglobal(lua_state, "domoticzData");
+	lua_settop(lua_state, iBase);
+	m_bLastExportFull = false;
+	return true;
+}
+
+void CdzVentsExport::UpdateTimeOuts(lua_State *lua_state, const int tData, const time_t now, const bool bRecheckAll)
+{
+	// Sets timedOut on the devices whose time has passed since the last event, or on all of them when the rules changed
+	if (bRecheckAll)
+	{
+		m_exported.timeouts.clear();
+		for (auto &itt : m_exported.devices)
+		{
+			_tExportedDevice &exported = itt.second;
+			exported.lastUpdate = GetLastUpdateTime(exported.state.lastUpdate, m_exported.isdst);
+			time_t timeOut = exported.lastUpdate + (time_t)m_exported.sensorTimeOut * 60;
+			bool bTimedOut = ((exported.lastUpdate != 0) && (now >= timeOut));
+			if ((exported.lastUpdate != 0) && (!bTimedOut))
+				m_exported.timeouts.insert(std::make_pair(timeOut, itt.first));
+			lua_rawgeti(lua_state, tData, exported.slot);
+			SetLuaBool(lua_state, "timedOut", bTimedOut);
+			lua_pop(lua_state, 1);
+		}
+		return;
+	}
+
+	while ((!m_exported.timeouts.empty()) && (m_exported.timeouts.begin()->first <= now))
+	{
+		auto itt = m_exported.devices.find(m_exported.timeouts.begin()->second);
+		m_exported.timeouts.erase(m_exported.timeouts.begin());
+		if (itt == m_exported.devices.end())
+			continue;
+		lua_rawgeti(lua_state, tData, itt->second.slot);
+		SetLuaBool(lua_state, "timedOut", true);
+		lua_pop(lua_state, 1);
+	}
+}
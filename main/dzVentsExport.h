@@ -0,0 +1,86 @@
+#pragma once
+#include "RFXNames.h"
+#include "EventSystem.h"
+#include <functional>
+
+struct lua_State;
+
+// domoticzData, the table dzVents builds its devices, scenes/groups, variables, cameras and hardware from.
+// In a long lived dzVents state the table is kept in the registry and an event only rebuilds the entries
+// of the items that changed since the previous one
+class CdzVentsExport
+{
+public:
+	typedef std::vector<std::vector<std::string>> _tRows;
+
+	// What gets exported. A map is only read while its mutex is (shared) locked
+	struct _tSource
+	{
+		const std::map<uint64_t, CEventSystem::_tDeviceStatus> &devices;
+		boost::shared_mutex &devicesMutex;
+		const std::map<uint64_t, CEventSystem::_tScenesGroups> &scenesgroups;
+		boost::shared_mutex &scenesgroupsMutex;
+		const std::map<uint64_t, CEventSystem::_tUserVariable> &uservariables;
+		boost::shared_mutex &uservariablesMutex;
+		time_t now;
+		int sensorTimeOut;			 // minutes
+		uint64_t hardwareGeneration; // the camera and hardware entries are only exported again when this changed
+		std::function<void(_tRows &cameras, _tRows &hardware)> getCamerasAndHardware; // ID, Name (, Type)
+	};
+
+	CdzVentsExport() = default;
+	~CdzVentsExport() = default;
+
+	// bPersistent: the Lua state is kept after the event, bLazy: rawData and data are built on first access
+	void Export(lua_State *lua_state, const _tSource &source, const std::vector<CEventSystem::_tEventQueue> &items, const CEventSystem::_tDzVentsChanges &changes,
+		    bool bPersistent, bool bLazy);
+	void Reset();
+	bool IsLastExportFull() const
+	{
+		return m_bLastExportFull;
+	}
+
+private:
+	struct _tExportedDevice
+	{
+		int slot; // index in domoticzData
+		time_t lastUpdate;
+		CEventSystem::_tDeviceStatus state; // rawData and data are built from this on first access
+	};
+	struct _tExportedData
+	{
+		bool bValid = false;
+		int ref = 0; // domoticzData in the registry
+		std::map<uint64_t, _tExportedDevice> devices;
+		std::map<uint64_t, int> scenesgroups; // id -> slot
+		std::map<uint64_t, int> uservariables;
+		std::set<std::pair<time_t, uint64_t>> timeouts; // devices that did not time out yet, by the time they will
+		std::vector<std::pair<CEventSystem::_eReason, uint64_t>> triggered; // exported with the trigger values, export again next time
+		uint64_t hardwareGeneration = 0;
+		int sensorTimeOut = 0;
+		int isdst = -1;
+		time_t lastExport = 0;
+	};
+	// items of the current event, per exported item
+	struct _tTriggerItems
+	{
+		std::map<uint64_t, std::vector<const CEventSystem::_tEventQueue *>> devices;
+		std::map<uint64_t, const CEventSystem::_tEventQueue *> scenesgroups;
+		std::map<uint64_t, const CEventSystem::_tEventQueue *> uservariables;
+	};
+
+	void ExportAllData(lua_State *lua_state, const _tSource &source, const std::vector<CEventSystem::_tEventQueue> &items, bool bKeep, bool bLazy);
+	bool ExportChangedData(lua_State *lua_state, const _tSource &source, const std::vector<CEventSystem::_tEventQueue> &items, const CEventSystem::_tDzVentsChanges &changes);
+	void ExportHardwareData(lua_State *lua_state, int tData, int &index, const std::vector<CEventSystem::_tEventQueue> &items);
+	static void GetTriggerItems(const std::vector<CEventSystem::_tEventQueue> &items, _tTriggerItems &triggers);
+	void ExportDevice(lua_State *lua_state, const CEventSystem::_tDeviceStatus &state, const _tTriggerItems &triggers, time_t now, bool bKeep, bool bLazy, int slot);
+	static void PushSceneGroup(lua_State *lua_state, const CEventSystem::_tScenesGroups &sgitem, const CEventSystem::_tEventQueue *pItem);
+	static void PushUserVariable(lua_State *lua_state, const CEventSystem::_tUserVariable &uvitem, const CEventSystem::_tEventQueue *pItem);
+	void UpdateTimeOuts(lua_State *lua_state, int tData, time_t now, bool bRecheckAll);
+	static void PushDeviceRawData(lua_State *lua_state, const CEventSystem::_tDeviceStatus &sitem);
+	static void PushDeviceData(lua_State *lua_state, const CEventSystem::_tDeviceStatus &sitem);
+	static int l_domoticz_device_index(lua_State *lua_state);
+
+	_tExportedData m_exported;
+	bool m_bLastExportFull = true;
+};
@@ -0,0 +1,568 @@
+#include "stdafx.h"
+#include "dzVentsStore.h"
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+// Values are kept encoded so they do not live in (and can not be changed through) a Lua state:
+//   'T' / 'F'                 boolean
+//   'i' int64 / 'd' double    number
+//   's' uint32 length, bytes  string
+//   '{' key value ... '}'     table
+// Functions, userdata and threads are dropped, just like persistence.lua writes them as nil
+
+namespace
+{
+	// deeper tables (and cyclic ones) are left to persistence.lua
+	constexpr int MAX_TABLE_DEPTH = 64;
+
+	bool IsStorable(const int type)
+	{
+		return (type == LUA_TBOOLEAN) || (type == LUA_TNUMBER) || (type == LUA_TSTRING) || (type == LUA_TTABLE);
+	}
+
+	template <typename T> void AppendRaw(std::string &out, const T value)
+	{
+		out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	template <typename T> T ReadRaw(const char *&pos)
+	{
+		T value;
+		memcpy(&value, pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+
+	void WriteNumber(std::string &out, const double value)
+	{
+		if (std::isnan(value))
+		{
+			out += "(0/0)";
+			return;
+		}
+		if (std::isinf(value))
+		{
+			out += (value > 0) ? "math.huge" : "-math.huge";
+			return;
+		}
+		char szTmp[32];
+		snprintf(szTmp, sizeof(szTmp), "%.15g", value);
+		if (strtod(szTmp, nullptr) != value)
+			snprintf(szTmp, sizeof(szTmp), "%.17g", value);
+		out += szTmp;
+		if (strspn(szTmp, "-0123456789") == strlen(szTmp))
+			out += ".0"; // keep it a float, like tostring does
+	}
+
+	// same result as string.format('%q'), but with all control characters as decimal escapes
+	void WriteString(std::string &out, const char *str, const size_t len)
+	{
+		out += '"';
+		for (size_t i = 0; i < len; i++)
+		{
+			unsigned char c = static_cast<unsigned char>(str[i]);
+			if ((c == '"') || (c == '\\'))
+			{
+				out += '\\';
+				out += static_cast<char>(c);
+			}
+			else if (c == '\n')
+				out += "\\n";
+			else if ((c < 32) || (c == 127))
+			{
+				char szTmp[8];
+				snprintf(szTmp, sizeof(szTmp), "\\%03d", c);
+				out += szTmp;
+			}
+			else
+				out += static_cast<char>(c);
+		}
+		out += '"';
+	}
+} // namespace
+
+void CdzVentsStore::Register(lua_State *lua_state)
+{
+	lua_pushlightuserdata(lua_state, this);
+	lua_pushcclosure(lua_state, l_domoticz_getPersistentData, 1);
+	lua_setglobal(lua_state, "domoticz_getPersistentData");
+	lua_pushlightuserdata(lua_state, this);
+	lua_pushcclosure(lua_state, l_domoticz_setPersistentData, 1);
+	lua_setglobal(lua_state, "domoticz_setPersistentData");
+}
+
+// domoticz_getPersistentData(dataFilePath)
+// returns the data as persistence.load would, or nil when it is not resident (anymore)
+int CdzVentsStore::l_domoticz_getPersistentData(lua_State *lua_state)
+{
+	CdzVentsStore *pStore = static_cast<CdzVentsStore *>(lua_touserdata(lua_state, lua_upvalueindex(1)));
+	if ((lua_gettop(lua_state) < 1) || (lua_type(lua_state, 1) != LUA_TSTRING) || !pStore->GetModule(lua_state, lua_tostring(lua_state, 1)))
+		lua_pushnil(lua_state);
+	return 1;
+}
+
+// domoticz_setPersistentData(dataFilePath, values, histories)
+// histories: name -> { full = samples } or { reset = bool, added = samples, size = n }, samples youngest first
+// returns false when the data can not be kept, the caller has to write the file itself
+int CdzVentsStore::l_domoticz_setPersistentData(lua_State *lua_state)
+{
+	CdzVentsStore *pStore = static_cast<CdzVentsStore *>(lua_touserdata(lua_state, lua_upvalueindex(1)));
+	bool bResult = (lua_gettop(lua_state) >= 3) && (lua_type(lua_state, 1) == LUA_TSTRING) && lua_istable(lua_state, 2) && lua_istable(lua_state, 3);
+	if (bResult)
+	{
+		std::string path = lua_tostring(lua_state, 1);
+		bResult = pStore->SetModule(lua_state, path, 2, 3);
+		if (!bResult)
+		{
+			std::lock_guard<std::mutex> l(pStore->m_mutex);
+			pStore->m_modules.erase(path);
+		}
+	}
+	lua_pushboolean(lua_state, bResult);
+	return 1;
+}
+
+bool CdzVentsStore::GetModule(lua_State *lua_state, const std::string &path)
+{
+	std::lock_guard<std::mutex> l(m_mutex);
+	auto itt = m_modules.find(path);
+	if (itt == m_modules.end())
+		return false;
+
+	_tFileStat file;
+	GetFileStat(path, file);
+	if (file != itt->second.file)
+	{
+		// edited or removed outside of dzVents, the file wins
+		m_modules.erase(itt);
+		return false;
+	}
+
+	const _tModule &module = itt->second;
+	int top = lua_gettop(lua_state);
+	if (!lua_checkstack(lua_state, 6))
+		return false;
+	lua_createtable(lua_state, 0, static_cast<int>(module.variables.size() + module.histories.size()));
+	for (const auto &var : module.variables)
+	{
+		const char *pos = var.second.c_str();
+		if (!PushValue(lua_state, pos))
+		{
+			lua_settop(lua_state, top);
+			return false;
+		}
+		lua_setfield(lua_state, -2, var.first.c_str());
+	}
+	for (const auto &history : module.histories)
+	{
+		lua_createtable(lua_state, static_cast<int>(history.second.size()), 0);
+		int index = 1;
+		for (const auto &sample : history.second)
+		{
+			lua_createtable(lua_state, 0, 2);
+			lua_pushlstring(lua_state, sample.time.c_str(), sample.time.size());
+			lua_setfield(lua_state, -2, "time");
+			if (!sample.data.empty())
+			{
+				const char *pos = sample.data.c_str();
+				if (!PushValue(lua_state, pos))
+				{
+					lua_settop(lua_state, top);
+					return false;
+				}
+				lua_setfield(lua_state, -2, "data");
+			}
+			lua_rawseti(lua_state, -2, index++);
+		}
+		lua_setfield(lua_state, -2, history.first.c_str());
+	}
+	return true;
+}
+
+bool CdzVentsStore::SetModule(lua_State *lua_state, const std::string &path, const int tValues, const int tHistories)
+{
+	struct _tHistoryChange
+	{
+		bool bFull = false;
+		bool bReset = false;
+		std::deque<_tSample> samples;
+		size_t size = 0;
+	};
+
+	std::map<std::string, std::string> variables;
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, tValues) != 0)
+	{
+		if ((lua_type(lua_state, -2) == LUA_TSTRING) && IsStorable(lua_type(lua_state, -1)))
+		{
+			std::string value;
+			if (!EncodeValue(lua_state, lua_gettop(lua_state), value, 0))
+			{
+				lua_pop(lua_state, 2);
+				return false;
+			}
+			variables[lua_tostring(lua_state, -2)] = value;
+		}
+		lua_pop(lua_state, 1);
+	}
+
+	std::map<std::string, _tHistoryChange> changes;
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, tHistories) != 0)
+	{
+		if ((lua_type(lua_state, -2) != LUA_TSTRING) || !lua_istable(lua_state, -1))
+		{
+			lua_pop(lua_state, 2);
+			return false;
+		}
+		_tHistoryChange &change = changes[lua_tostring(lua_state, -2)];
+		int tChange = lua_gettop(lua_state);
+		bool bOk = true;
+		lua_getfield(lua_state, tChange, "full");
+		if (lua_istable(lua_state, -1))
+		{
+			change.bFull = true;
+			bOk = ReadSamples(lua_state, lua_gettop(lua_state), change.samples);
+		}
+		else
+		{
+			lua_getfield(lua_state, tChange, "reset");
+			change.bReset = (lua_toboolean(lua_state, -1) != 0);
+			lua_getfield(lua_state, tChange, "size");
+			change.size = static_cast<size_t>(std::max<lua_Integer>(lua_tointeger(lua_state, -1), 0));
+			lua_getfield(lua_state, tChange, "added");
+			if (lua_istable(lua_state, -1))
+				bOk = ReadSamples(lua_state, lua_gettop(lua_state), change.samples);
+		}
+		lua_settop(lua_state, tChange - 1); // keep the key for lua_next
+		if (!bOk)
+			return false;
+	}
+
+	std::lock_guard<std::mutex> l(m_mutex);
+	auto itt = m_modules.find(path);
+	if (itt == m_modules.end())
+	{
+		// only complete data can be taken over, changes need the resident history
+		for (const auto &change : changes)
+		{
+			if (!change.second.bFull)
+				return false;
+		}
+		itt = m_modules.emplace(path, _tModule()).first;
+		GetFileStat(path, itt->second.file);
+		itt->second.bDirty = true;
+	}
+	_tModule &module = itt->second;
+
+	if (module.variables != variables)
+	{
+		module.variables.swap(variables);
+		module.bDirty = true;
+	}
+	for (auto ith = module.histories.begin(); ith != module.histories.end();)
+	{
+		if (changes.find(ith->first) == changes.end())
+		{
+			ith = module.histories.erase(ith);
+			module.bDirty = true;
+		}
+		else
+			++ith;
+	}
+	for (auto &change : changes)
+	{
+		std::deque<_tSample> &samples = module.histories[change.first];
+		if (change.second.bFull)
+		{
+			samples.swap(change.second.samples);
+			module.bDirty = true;
+			continue;
+		}
+		if (change.second.bReset)
+		{
+			samples.clear();
+			module.bDirty = true;
+		}
+		// the samples added by the script go in front, whatever the script pruned falls off the end
+		for (auto its = change.second.samples.rbegin(); its != change.second.samples.rend(); ++its)
+		{
+			samples.push_front(std::move(*its));
+			module.bDirty = true;
+		}
+		if (samples.size() > change.second.size)
+		{
+			samples.resize(change.second.size);
+			module.bDirty = true;
+		}
+	}
+	return true;
+}
+
+bool CdzVentsStore::ReadSamples(lua_State *lua_state, const int tSamples, std::deque<_tSample> &samples)
+{
+	size_t count = lua_rawlen(lua_state, tSamples);
+	for (size_t i = 1; i <= count; i++)
+	{
+		lua_rawgeti(lua_state, tSamples, static_cast<lua_Integer>(i));
+		int tSample = lua_gettop(lua_state);
+		if (!lua_istable(lua_state, tSample))
+		{
+			lua_pop(lua_state, 1);
+			return false;
+		}
+		_tSample sample;
+		lua_getfield(lua_state, tSample, "time");
+		bool bOk = (lua_type(lua_state, -1) == LUA_TSTRING);
+		if (bOk)
+			sample.time = lua_tostring(lua_state, -1);
+		lua_getfield(lua_state, tSample, "data");
+		if (bOk && IsStorable(lua_type(lua_state, -1)))
+			bOk = EncodeValue(lua_state, lua_gettop(lua_state), sample.data, 0);
+		lua_settop(lua_state, tSample - 1);
+		if (!bOk)
+			return false;
+		samples.push_back(std::move(sample));
+	}
+	return true;
+}
+
+bool CdzVentsStore::EncodeValue(lua_State *lua_state, const int index, std::string &out, const int level)
+{
+	switch (lua_type(lua_state, index))
+	{
+	case LUA_TBOOLEAN:
+		out += lua_toboolean(lua_state, index) ? 'T' : 'F';
+		return true;
+	case LUA_TNUMBER:
+		if (lua_isinteger(lua_state, index))
+		{
+			out += 'i';
+			AppendRaw<int64_t>(out, static_cast<int64_t>(lua_tointeger(lua_state, index)));
+		}
+		else
+		{
+			out += 'd';
+			AppendRaw<double>(out, static_cast<double>(lua_tonumber(lua_state, index)));
+		}
+		return true;
+	case LUA_TSTRING:
+	{
+		size_t len = 0;
+		const char *str = lua_tolstring(lua_state, index, &len);
+		out += 's';
+		AppendRaw<uint32_t>(out, static_cast<uint32_t>(len));
+		out.append(str, len);
+		return true;
+	}
+	case LUA_TTABLE:
+		if ((level >= MAX_TABLE_DEPTH) || !lua_checkstack(lua_state, 3))
+			return false;
+		out += '{';
+		lua_pushnil(lua_state);
+		while (lua_next(lua_state, index) != 0)
+		{
+			int top = lua_gettop(lua_state);
+			if (IsStorable(lua_type(lua_state, top - 1)) && IsStorable(lua_type(lua_state, top)))
+			{
+				if (!EncodeValue(lua_state, top - 1, out, level + 1) || !EncodeValue(lua_state, top, out, level + 1))
+				{
+					lua_pop(lua_state, 2);
+					return false;
+				}
+			}
+			lua_pop(lua_state, 1);
+		}
+		out += '}';
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool CdzVentsStore::PushValue(lua_State *lua_state, const char *&pos)
+{
+	if (!lua_checkstack(lua_state, 3))
+		return false;
+	switch (*pos++)
+	{
+	case 'T':
+		lua_pushboolean(lua_state, 1);
+		return true;
+	case 'F':
+		lua_pushboolean(lua_state, 0);
+		return true;
+	case 'i':
+		lua_pushinteger(lua_state, static_cast<lua_Integer>(ReadRaw<int64_t>(pos)));
+		return true;
+	case 'd':
+		lua_pushnumber(lua_state, static_cast<lua_Number>(ReadRaw<double>(pos)));
+		return true;
+	case 's':
+	{
+		uint32_t len = ReadRaw<uint32_t>(pos);
+		lua_pushlstring(lua_state, pos, len);
+		pos += len;
+		return true;
+	}
+	case '{':
+		lua_newtable(lua_state);
+		while (*pos != '}')
+		{
+			if (!PushValue(lua_state, pos) || !PushValue(lua_state, pos))
+				return false;
+			lua_rawset(lua_state, -3);
+		}
+		pos++;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void CdzVentsStore::WriteValue(std::string &out, const char *&pos, const int level)
+{
+	switch (*pos++)
+	{
+	case 'T':
+		out += "true";
+		break;
+	case 'F':
+		out += "false";
+		break;
+	case 'i':
+		out += std::to_string(ReadRaw<int64_t>(pos));
+		break;
+	case 'd':
+		WriteNumber(out, ReadRaw<double>(pos));
+		break;
+	case 's':
+	{
+		uint32_t len = ReadRaw<uint32_t>(pos);
+		WriteString(out, pos, len);
+		pos += len;
+		break;
+	}
+	case '{':
+		out += "{\n";
+		while (*pos != '}')
+		{
+			out.append(level + 1, '\t');
+			out += '[';
+			WriteValue(out, pos, level + 1);
+			out += "] = ";
+			WriteValue(out, pos, level + 1);
+			out += ";\n";
+		}
+		pos++;
+		out.append(level, '\t');
+		out += '}';
+		break;
+	}
+}
+
+// Same layout as persistence.store, so the files can still be read by older versions and edited by hand
+void CdzVentsStore::WriteModule(const _tModule &module, std::string &out)
+{
+	out = "-- Persistent Data\nlocal multiRefObjects = {\n\n} -- multiRefObjects\nlocal obj1 = {\n";
+	for (const auto &var : module.variables)
+	{
+		out += "\t[";
+		WriteString(out, var.first.c_str(), var.first.size());
+		out += "] = ";
+		const char *pos = var.second.c_str();
+		WriteValue(out, pos, 1);
+		out += ";\n";
+	}
+	for (const auto &history : module.histories)
+	{
+		out += "\t[";
+		WriteString(out, history.first.c_str(), history.first.size());
+		out += "] = {\n";
+		int index = 1;
+		for (const auto &sample : history.second)
+		{
+			out += "\t\t[" + std::to_string(index++) + "] = {\n\t\t\t[\"time\"] = ";
+			WriteString(out, sample.time.c_str(), sample.time.size());
+			out += ";\n";
+			if (!sample.data.empty())
+			{
+				out += "\t\t\t[\"data\"] = ";
+				const char *pos = sample.data.c_str();
+				WriteValue(out, pos, 3);
+				out += ";\n";
+			}
+			out += "\t\t};\n";
+		}
+		out += "\t};\n";
+	}
+	out += "}\nreturn obj1\n";
+}
+
+bool CdzVentsStore::WriteFileAtomic(const std::string &path, const std::string &content)
+{
+	std::string tmpPath = path + ".tmp";
+	FILE *fOut = fopen(tmpPath.c_str(), "wb");
+	if (fOut == nullptr)
+		return false;
+	bool bOk = (fwrite(content.data(), 1, content.size(), fOut) == content.size());
+	bOk = (fflush(fOut) == 0) && bOk;
+#ifndef WIN32
+	bOk = (fsync(fileno(fOut)) == 0) && bOk;
+#endif
+	bOk = (fclose(fOut) == 0) && bOk;
+	if (bOk)
+	{
+#ifdef WIN32
+		bOk = (MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+		bOk = (rename(tmpPath.c_str(), path.c_str()) == 0);
+#endif
+	}
+	if (!bOk)
+		remove(tmpPath.c_str());
+	return bOk;
+}
+
+void CdzVentsStore::GetFileStat(const std::string &path, _tFileStat &file)
+{
+	struct stat st;
+	file = _tFileStat();
+	if (stat(path.c_str(), &st) == 0)
+	{
+		file.bExists = true;
+		file.mtime = st.st_mtime;
+		file.size = static_cast<int64_t>(st.st_size);
+	}
+}
+
+void CdzVentsStore::Flush(std::vector<std::string> &failed)
+{
+	std::lock_guard<std::mutex> l(m_mutex);
+	for (auto &module : m_modules)
+	{
+		if (!module.second.bDirty)
+			continue;
+		std::string content;
+		WriteModule(module.second, content);
+		if (!WriteFileAtomic(module.first, content))
+		{
+			failed.push_back(module.first);
+			continue;
+		}
+		module.second.bDirty = false;
+		GetFileStat(module.first, module.second.file);
+	}
+}
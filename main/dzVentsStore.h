@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct lua_State;
+
+// Resident copy of the dzVents persistent data (domoticz.data / domoticz.globalData)
+// Scripts read and write it through domoticz_getPersistentData / domoticz_setPersistentData,
+// the data files are only rewritten (in the persistence.lua format) when Flush is called
+class CdzVentsStore
+{
+public:
+	CdzVentsStore() = default;
+	~CdzVentsStore() = default;
+
+	void Register(lua_State *lua_state);
+	void Flush(std::vector<std::string> &failed); // failed: the data files that could not be written
+
+private:
+	struct _tSample
+	{
+		std::string time; // UTC, as in the data files
+		std::string data; // encoded value
+	};
+	struct _tFileStat
+	{
+		bool bExists = false;
+		time_t mtime = 0;
+		int64_t size = 0;
+		bool operator!=(const _tFileStat &other) const
+		{
+			return (bExists != other.bExists) || (mtime != other.mtime) || (size != other.size);
+		}
+	};
+	struct _tModule
+	{
+		std::map<std::string, std::string> variables;		   // name -> encoded value
+		std::map<std::string, std::deque<_tSample>> histories; // name -> samples, youngest first
+		bool bDirty = false;
+		_tFileStat file; // data file as it was last read or written, an external change drops the module
+	};
+
+	static int l_domoticz_getPersistentData(lua_State *lua_state);
+	static int l_domoticz_setPersistentData(lua_State *lua_state);
+	bool GetModule(lua_State *lua_state, const std::string &path);
+	bool SetModule(lua_State *lua_state, const std::string &path, int tValues, int tHistories);
+	static bool ReadSamples(lua_State *lua_state, int tSamples, std::deque<_tSample> &samples);
+	static bool EncodeValue(lua_State *lua_state, int index, std::string &out, int level);
+	static bool PushValue(lua_State *lua_state, const char *&pos);
+	static void WriteValue(std::string &out, const char *&pos, int level);
+	static void WriteModule(const _tModule &module, std::string &out);
+	static bool WriteFileAtomic(const std::string &path, const std::string &content);
+	static void GetFileStat(const std::string &path, _tFileStat &file);
+
+	std::mutex m_mutex;
+	std::map<std::string, _tModule> m_modules; // data file path -> data
+};
@@ -256,6 +256,7 @@ MainWorker::MainWorker()
 	m_SecStatus = SECSTATUS_DISARMED;
 
 	m_rxMessageIdx = 1;
+	SetRxDecodeThreads(1);
 	m_bForceLogNotificationCheck = false;
 }
 
@@ -1189,9 +1190,20 @@ bool MainWorker::Start()
 
 	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
 	SetThreadName(m_thread->native_handle(), "MainWorker");
-	m_rxMessageThread = std::make_shared<std::thread>([this] { Do_Work_On_Rx_Messages(); });
-	SetThreadName(m_rxMessageThread->native_handle(), "MainWorkerRxMsg");
-	return (m_thread != nullptr) && (m_rxMessageThread != nullptr);
+	bool bRxStarted = true;
+	if (m_rxShards.size() > 1)
+		_log.Log(LOG_STATUS, "RxQueue: queueing with %d worker threads (decoding stays serialized)", static_cast<int>(m_rxShards.size()));
+	for (auto &shard : m_rxShards)
+	{
+		_tRxShard *pShard = shard.get();
+		pShard->thread = std::make_shared<std::thread>([this, pShard] { Do_Work_On_Rx_Messages(pShard); });
+		if (m_rxShards.size() == 1)
+			SetThreadName(pShard->thread->native_handle(), "MainWorkerRxMsg");
+		else
+			SetThreadName(pShard->thread->native_handle(), std_format("MainWorkerRx%d", pShard->index).c_str());
+		bRxStarted = bRxStarted && (pShard->thread != nullptr);
+	}
+	return (m_thread != nullptr) && bRxStarted;
 }
 
 
@@ -1202,12 +1214,18 @@ bool MainWorker::Stop()
 		m_notificationsystem.NotifyWait(Notification::DZ_STOP, Notification::STATUS_INFO); // blocking call
 	}
 
-	if (m_rxMessageThread) {
-		// Stop RxMessage thread before hardware to avoid NULL pointer exception
+	if (!m_rxShards.empty() && m_rxShards[0]->thread) {
+		// Stop RxMessage threads before hardware to avoid NULL pointer exception
 		m_TaskRXMessage.RequestStop();
 		UnlockRxMessageQueue();
-		m_rxMessageThread->join();
-		m_rxMessageThread.reset();
+		for (auto &shard : m_rxShards)
+		{
+			if (shard->thread)
+			{
+				shard->thread->join();
+				shard->thread.reset();
+			}
+		}
 	}
 	if (m_thread)
 	{
@@ -1937,9 +1955,9 @@ uint64_t MainWorker::PerformRealActionFromDomoticzClient(const uint8_t* pRXComma
 		// find our original hardware
 		// if it is not a domoticz type, perform the actual command
 
-		result = m_sql.safe_query(
-			"SELECT HardwareID,ID,Name,StrParam1,StrParam2,nValue,sValue FROM DeviceStatus WHERE (DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)",
-			ID.c_str(), Unit, devType, subType);
+		result = m_sql.bind_query(
+			"SELECT HardwareID,ID,Name,StrParam1,StrParam2,nValue,sValue FROM DeviceStatus WHERE (DeviceID=? AND Unit=? AND Type=? AND SubType=?)",
+			ID, Unit, devType, subType);
 		if (result.size() == 1)
 		{
 			std::vector<std::string> sd = result[0];
@@ -2020,8 +2038,7 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 	rxMessage.rxMessageIdx = m_rxMessageIdx++;
 	rxMessage.hardwareId = pHardware->m_HwdID;
 	// defensive copy of the command
-	rxMessage.vrxCommand.resize(pRXCommand[0] + 1);
-	rxMessage.vrxCommand.insert(rxMessage.vrxCommand.begin(), pRXCommand, pRXCommand + pRXCommand[0] + 1);
+	rxMessage.rxCommand.assign(pRXCommand);
 	rxMessage.crc = 0x0;
 #ifdef DEBUG_RXQUEUE
 	// CRC
@@ -2036,32 +2053,37 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 	}
 
 	// Trigger
+	queue_element_trigger trigger;
 	rxMessage.trigger = nullptr; // Should be initialized to NULL if trigger is no used
 	if (wait) { // add trigger to wait for the message to be processed
-		rxMessage.trigger = new queue_element_trigger();
+		rxMessage.trigger = &trigger;
 	}
 
 #ifdef DEBUG_RXQUEUE
+	const unsigned long rxMessageIdx = rxMessage.rxMessageIdx; // rxMessage is moved into the queue
+	bool moreThanTimeout = false;
 	_log.Log(LOG_STATUS, "RxQueue: push a rxMessage(%lu) (hrdwId=%d, hrdwType=%d, hrdwName=%s, type=%02X, subtype=%02X)",
 		rxMessage.rxMessageIdx,
 		pHardware->m_HwdID,
 		pHardware->HwdType,
-		pHardware->Name.c_str(),
+		pHardware->m_Name.c_str(),
 		pRXCommand[1],
 		pRXCommand[2]);
 #endif
 
-	// Push item to queue
-	m_rxMessageQueue.push(rxMessage);
+	// Push item to the queue of its hardware shard
+	rxMessage.enqueued = std::chrono::steady_clock::now();
+	PushRxShard(m_rxShards[rxMessage.hardwareId % m_rxShards.size()].get(), std::move(rxMessage));
 
-	if (rxMessage.trigger != nullptr)
+	if (wait)
 	{
 #ifdef DEBUG_RXQUEUE
-		_log.Log(LOG_STATUS, "RxQueue: wait for rxMessage(%lu) to be processed...", rxMessage.rxMessageIdx);
+		_log.Log(LOG_STATUS, "RxQueue: wait for rxMessage(%lu) to be processed...", rxMessageIdx);
 #endif
-		while (!rxMessage.trigger->timed_wait(std::chrono::duration<int>(1))) {
+		while (!trigger.timed_wait(std::chrono::duration<int>(1))) {
 #ifdef DEBUG_RXQUEUE
-			_log.Log(LOG_STATUS, "RxQueue: wait 1s for rxMessage(%lu) to be processed...", rxMessage.rxMessageIdx);
+			_log.Log(LOG_STATUS, "RxQueue: wait 1s for rxMessage(%lu) to be processed...", rxMessageIdx);
+			moreThanTimeout = true;
 #endif
 			if (m_TaskRXMessage.IsStopRequested(0)) {
 				// Server is stopping
@@ -2070,10 +2092,9 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 		}
 #ifdef DEBUG_RXQUEUE
 		if (moreThanTimeout) {
-			_log.Log(LOG_STATUS, "RxQueue: rxMessage(%lu) processed", rxMessage.rxMessageIdx);
+			_log.Log(LOG_STATUS, "RxQueue: rxMessage(%lu) processed", rxMessageIdx);
 		}
 #endif
-		delete rxMessage.trigger;
 	}
 }
 
@@ -2082,97 +2103,187 @@ void MainWorker::UnlockRxMessageQueue()
 #ifdef DEBUG_RXQUEUE
 	_log.Log(LOG_STATUS, "RxQueue: unlock queue using dummy message");
 #endif
-	// Push dummy message to unlock queue
-	_tRxQueueItem rxMessage;
-	rxMessage.rxMessageIdx = m_rxMessageIdx++;
-	rxMessage.hardwareId = -1;
-	rxMessage.trigger = nullptr;
-	rxMessage.BatteryLevel = 0;
-	m_rxMessageQueue.push(rxMessage);
+	// Push dummy message to unlock every queue
+	for (auto &shard : m_rxShards)
+	{
+		_tRxQueueItem rxMessage;
+		rxMessage.rxMessageIdx = m_rxMessageIdx++;
+		rxMessage.hardwareId = -1;
+		rxMessage.trigger = nullptr;
+		rxMessage.BatteryLevel = 0;
+		PushRxShard(shard.get(), std::move(rxMessage));
+	}
+}
+
+void MainWorker::PushRxShard(_tRxShard *pShard, _tRxQueueItem &&rxMessage)
+{
+	size_t depth = ++pShard->depth;
+	size_t maxdepth = pShard->maxdepth.load(std::memory_order_relaxed);
+	while ((depth > maxdepth) && !pShard->maxdepth.compare_exchange_weak(maxdepth, depth, std::memory_order_relaxed))
+		;
+	pShard->queue.push(std::move(rxMessage));
+}
+
+void MainWorker::SetRxDecodeThreads(int nThreads)
+{
+	if ((!m_rxShards.empty()) && (m_rxShards[0]->thread))
+	{
+		_log.Log(LOG_ERROR, "RxQueue: cannot change the number of decode threads while running");
+		return;
+	}
+	if (nThreads < 1)
+		nThreads = 1;
+	else if (nThreads > 32)
+		nThreads = 32;
+	m_rxShards.clear();
+	for (int ii = 0; ii < nThreads; ii++)
+	{
+		m_rxShards.push_back(std::unique_ptr<_tRxShard>(new _tRxShard));
+		m_rxShards.back()->index = ii;
+	}
+}
+
+int MainWorker::GetRxDecodeThreads() const
+{
+	return static_cast<int>(m_rxShards.size());
+}
+
+static_assert(sizeof(tRBUF) <= RX_MESSAGE_MAX_SIZE, "RX message buffer too small");
+
+// Maximum number of messages a worker moves out of its queue per wakeup
+#define RX_QUEUE_BATCH_SIZE 32
+
+// Latency bucket upper bounds (ms), the last bucket collects everything above
+static const int RxLatencyBucketLimits[] = { 1, 5, 10, 50, 100, 500, 1000, -1 };
+
+int MainWorker::GetRxLatencyBucketLimit(const size_t bucket)
+{
+	if (bucket >= sizeof(RxLatencyBucketLimits) / sizeof(RxLatencyBucketLimits[0]))
+		return -1;
+	return RxLatencyBucketLimits[bucket];
 }
 
-void MainWorker::Do_Work_On_Rx_Messages()
+void MainWorker::GetRxQueueStatistics(std::vector<_tRxQueueStatistics> &stats)
 {
-	_log.Log(LOG_STATUS, "RxQueue: queue worker started...");
+	stats.clear();
+	for (const auto &shard : m_rxShards)
+	{
+		_tRxQueueStatistics sstat;
+		sstat.depth = shard->depth.load(std::memory_order_relaxed);
+		sstat.maxdepth = shard->maxdepth.load(std::memory_order_relaxed);
+		sstat.processed = shard->processed.load(std::memory_order_relaxed);
+		for (const auto &bucket : shard->latency)
+			sstat.latency.push_back(bucket.load(std::memory_order_relaxed));
+		stats.push_back(sstat);
+	}
+}
+
+void MainWorker::Do_Work_On_Rx_Messages(_tRxShard *pShard)
+{
+	if (m_rxShards.size() > 1)
+		_log.Log(LOG_STATUS, "RxQueue: queue worker %d started...", pShard->index);
+	else
+		_log.Log(LOG_STATUS, "RxQueue: queue worker started...");
+
+	static_assert(sizeof(RxLatencyBucketLimits) / sizeof(RxLatencyBucketLimits[0]) == RX_LATENCY_BUCKETS, "latency bucket limits out of sync");
+
+	std::vector<_tRxQueueItem> rxQItems;
+	rxQItems.reserve(RX_QUEUE_BATCH_SIZE);
 
 	while (!m_TaskRXMessage.IsStopRequested(0))
 	{
-		// Wait and pop next message or timeout
-		_tRxQueueItem rxQItem;
-		bool hasPopped = m_rxMessageQueue.timed_wait_and_pop<std::chrono::duration<int> >(rxQItem, std::chrono::duration<int>(5));
+		// Wait and pop the next messages (moved out in one go) or timeout
+		rxQItems.clear();
+		size_t popped = pShard->queue.timed_wait_and_pop_batch<std::chrono::duration<int> >(rxQItems, RX_QUEUE_BATCH_SIZE, std::chrono::duration<int>(5));
 		// (if no message for 5 seconds, returns anyway to check m_TaskRXMessage.IsStopRequested)
 
-		if (!hasPopped) {
+		if (popped == 0) {
 			// Timeout occurred : queue is empty
 #ifdef DEBUG_RXQUEUE
 			//_log.Log(LOG_STATUS, "RxQueue: the queue has been empty for five seconds");
 #endif
 			continue;
 		}
-		if (rxQItem.hardwareId == -1) {
-			// dummy message
+		pShard->depth -= popped;
+
+		for (auto &rxQItem : rxQItems)
+		{
+			if (m_TaskRXMessage.IsStopRequested(0))
+				break;
+			if (rxQItem.hardwareId == -1) {
+				// dummy message
 #ifdef DEBUG_RXQUEUE
-			_log.Log(LOG_STATUS, "RxQueue: dummy message popped");
+				_log.Log(LOG_STATUS, "RxQueue: dummy message popped");
 #endif
-			continue;
-		}
-		if (rxQItem.hardwareId < 1) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot process invalid hardware id: (%d)", rxQItem.hardwareId);
-			// cannot process message with invalid id or null message
-			if (rxQItem.trigger != nullptr)
-				rxQItem.trigger->popped();
-			continue;
-		}
-
-		const CDomoticzHardwareBase* pHardware = GetHardware(rxQItem.hardwareId);
+				continue;
+			}
+			if (rxQItem.hardwareId < 1) {
+				_log.Log(LOG_ERROR, "RxQueue: cannot process invalid hardware id: (%d)", rxQItem.hardwareId);
+				// cannot process message with invalid id or null message
+				if (rxQItem.trigger != nullptr)
+					rxQItem.trigger->popped();
+				continue;
+			}
 
-		// Check pointers
-		if (pHardware == nullptr)
-		{
-			_log.Log(LOG_ERROR, "RxQueue: cannot retrieve hardware with id: %d", rxQItem.hardwareId);
-			if (rxQItem.trigger != nullptr)
-				rxQItem.trigger->popped();
-			continue;
-		}
-		if (rxQItem.vrxCommand.empty()) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot retrieve command with id: %d", rxQItem.hardwareId);
-			if (rxQItem.trigger != nullptr)
-				rxQItem.trigger->popped();
-			continue;
-		}
+			const CDomoticzHardwareBase* pHardware = GetHardware(rxQItem.hardwareId);
 
-		const uint8_t* pRXCommand = &rxQItem.vrxCommand[0];
+			// Check pointers
+			if (pHardware == nullptr)
+			{
+				_log.Log(LOG_ERROR, "RxQueue: cannot retrieve hardware with id: %d", rxQItem.hardwareId);
+				if (rxQItem.trigger != nullptr)
+					rxQItem.trigger->popped();
+				continue;
+			}
+			const uint8_t* pRXCommand = rxQItem.rxCommand.data;
 
 #ifdef DEBUG_RXQUEUE
-		// CRC
-		boost::uint16_t crc = rxQItem.crc;
-		boost::crc_optimal<16, 0x1021, 0xFFFF, 0, false, false> crc_ccitt2;
-		crc_ccitt2 = std::for_each(pRXCommand, pRXCommand + rxQItem.vrxCommand.size(), crc_ccitt2);
-		if (crc != crc_ccitt2()) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot process invalid rxMessage(%lu) from hardware with id=%d (type %d)",
-				rxQItem.rxMessageIdx,
-				rxQItem.hardwareId,
-				pHardware->HwdType);
-			if (rxQItem.trigger != NULL) rxQItem.trigger->popped();
-			continue;
-		}
+			// CRC
+			boost::uint16_t crc = rxQItem.crc;
+			boost::crc_optimal<16, 0x1021, 0xFFFF, 0, false, false> crc_ccitt2;
+			crc_ccitt2 = std::for_each(pRXCommand, pRXCommand + rxQItem.rxCommand.size(), crc_ccitt2);
+			if (crc != crc_ccitt2()) {
+				_log.Log(LOG_ERROR, "RxQueue: cannot process invalid rxMessage(%lu) from hardware with id=%d (type %d)",
+					rxQItem.rxMessageIdx,
+					rxQItem.hardwareId,
+					pHardware->HwdType);
+				if (rxQItem.trigger != nullptr) rxQItem.trigger->popped();
+				continue;
+			}
 
-		_log.Log(LOG_STATUS, "RxQueue: process a rxMessage(%lu) (hrdwId=%d, hrdwType=%d, hrdwName=%s, type=%02X, subtype=%02X)",
-			rxQItem.rxMessageIdx,
-			pHardware->m_HwdID,
-			pHardware->HwdType,
-			pHardware->Name.c_str(),
-			pRXCommand[1],
-			pRXCommand[2]);
+			_log.Log(LOG_STATUS, "RxQueue: process a rxMessage(%lu) (hrdwId=%d, hrdwType=%d, hrdwName=%s, type=%02X, subtype=%02X)",
+				rxQItem.rxMessageIdx,
+				pHardware->m_HwdID,
+				pHardware->HwdType,
+				pHardware->m_Name.c_str(),
+				pRXCommand[1],
+				pRXCommand[2]);
 #endif
-		ProcessRXMessage(pHardware, pRXCommand, rxQItem.Name.c_str(), rxQItem.BatteryLevel, rxQItem.UserName.c_str());
-		if (rxQItem.trigger != nullptr)
-		{
-			rxQItem.trigger->popped();
+			{
+				// Decoding updates shared state (m_sql.m_LastSwitchID, hardware, events, notifications), so it stays serialized,
+				// the shards only take the queue handling off each other
+				std::lock_guard<std::mutex> l(m_decodeRXMessageMutex);
+				ProcessRXMessage(pHardware, pRXCommand, rxQItem.Name.c_str(), rxQItem.BatteryLevel, rxQItem.UserName.c_str());
+			}
+			if (rxQItem.trigger != nullptr)
+			{
+				rxQItem.trigger->popped();
+			}
+
+			// End-to-end latency (push to decoded)
+			int64_t latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - rxQItem.enqueued).count();
+			size_t bucket = 0;
+			while ((bucket < RX_LATENCY_BUCKETS - 1) && (latency >= RxLatencyBucketLimits[bucket]))
+				bucket++;
+			pShard->latency[bucket].fetch_add(1, std::memory_order_relaxed);
+			pShard->processed.fetch_add(1, std::memory_order_relaxed);
 		}
 	}
 
-	_log.Log(LOG_STATUS, "RxQueue: queue worker stopped...");
+	if (m_rxShards.size() > 1)
+		_log.Log(LOG_STATUS, "RxQueue: queue worker %d stopped...", pShard->index);
+	else
+		_log.Log(LOG_STATUS, "RxQueue: queue worker stopped...");
 }
 
 void MainWorker::ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const char *userName)
@@ -2468,7 +2579,7 @@ void MainWorker::ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const
 
 	if ((BatteryLevel != -1) && (procResult.bProcessBatteryValue))
 	{
-		m_sql.safe_query("UPDATE DeviceStatus SET BatteryLevel=%d WHERE (ID==%" PRIu64 ")", BatteryLevel, DeviceRowIdx);
+		m_sql.bind_query("UPDATE DeviceStatus SET BatteryLevel=? WHERE (ID==?)", BatteryLevel, DeviceRowIdx);
 		m_eventsystem.UpdateBatteryLevel(DeviceRowIdx, BatteryLevel); //GizMoCuz, temporarily... 
 	}
 
@@ -3098,8 +3209,8 @@ void MainWorker::decode_Rain(const CDomoticzHardwareBase* pHardware, const tRBUF
 		std::vector<std::vector<std::string>> result;
 
 		//Get our index
-		result = m_sql.safe_query(
-			"SELECT ID FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)", pHardware->m_HwdID, ID.c_str(), Unit, devType, subType);
+		result = m_sql.bind_query(
+			"SELECT ID FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)", pHardware->m_HwdID, ID, Unit, devType, subType);
 		if (!result.empty())
 		{
 			uint64_t ulID = std::stoull(result[0][0]);
@@ -3144,8 +3255,8 @@ void MainWorker::decode_Rain(const CDomoticzHardwareBase* pHardware, const tRBUF
 		std::vector<std::vector<std::string>> result;
 
 		//Get our index
-		result = m_sql.safe_query(
-			"SELECT ID FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)", pHardware->m_HwdID, ID.c_str(), Unit, devType, subType);
+		result = m_sql.bind_query(
+			"SELECT ID FROM DeviceStatus WHERE (HardwareID=? AND DeviceID=? AND Unit=? AND Type=? AND SubType=?)", pHardware->m_HwdID, ID, Unit, devType, subType);
 		if (!result.empty())
 		{
 			uint64_t ulID = std::stoull(result[0][0]);
@@ -3278,7 +3389,10 @@ void MainWorker::decode_Wind(const CDomoticzHardwareBase* pHardware, const tRBUF
 	//Apply user defined offset
 	dDirection = std::fmod(dDirection + AddjValue2, 360.0);
 
-	dDirection = m_wind_calculator[windID].AddValueAndReturnAvarage(dDirection);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		dDirection = m_wind_calculator[windID].AddValueAndReturnAvarage(dDirection);
+	}
 
 	std::string strDirection;
 	if (dDirection > 348.75 || dDirection < 11.26)
@@ -3332,7 +3446,10 @@ void MainWorker::decode_Wind(const CDomoticzHardwareBase* pHardware, const tRBUF
 		intSpeed = intGust;
 	}
 
-	m_wind_calculator[windID].SetSpeedGust(intSpeed, intGust);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_wind_calculator[windID].SetSpeedGust(intSpeed, intGust);
+	}
 
 	float temp = 0, chill = 0;
 	if (subType != sTypeWINDNoTempNoChill)
@@ -3402,7 +3519,10 @@ void MainWorker::decode_Wind(const CDomoticzHardwareBase* pHardware, const tRBUF
 	m_notifications.CheckAndHandleNotification(DevRowIdx, pHardware->m_HwdID, ID, procResult.DeviceName, Unit, devType, subType, cmnd, szTmp);
 
 	uint64_t tID = ((uint64_t)(pHardware->m_HwdID & 0x7FFFFFFF) << 32) | (DevRowIdx & 0x7FFFFFFF);
-	m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(chill), _tTrendCalculator::TAVERAGE_TEMP);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(chill), _tTrendCalculator::TAVERAGE_TEMP);
+	}
 
 	if (_log.IsDebugLevelEnabled(DEBUG_RECEIVED))
 	{
@@ -3541,7 +3661,10 @@ void MainWorker::decode_Temp(const CDomoticzHardwareBase* pHardware, const tRBUF
 		return;
 
 	uint64_t tID = ((uint64_t)(pHardware->m_HwdID & 0x7FFFFFFF) << 32) | (DevRowIdx & 0x7FFFFFFF);
-	m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	}
 
 	bool bHandledNotification = false;
 	uint8_t humidity = 0;
@@ -3855,7 +3978,10 @@ void MainWorker::decode_TempHum(const CDomoticzHardwareBase* pHardware, const tR
 		return;
 
 	uint64_t tID = ((uint64_t)(pHardware->m_HwdID & 0x7FFFFFFF) << 32) | (DevRowIdx & 0x7FFFFFFF);
-	m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	}
 
 	m_notifications.CheckAndHandleNotification(DevRowIdx, pHardware->m_HwdID, ID, procResult.DeviceName, Unit, devType, subType, cmnd, szTmp);
 
@@ -4065,7 +4191,10 @@ void MainWorker::decode_TempHumBaro(const CDomoticzHardwareBase* pHardware, cons
 		return;
 
 	uint64_t tID = ((uint64_t)(pHardware->m_HwdID & 0x7FFFFFFF) << 32) | (DevRowIdx & 0x7FFFFFFF);
-	m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	}
 
 	//calculate Altitude
 	//float seaLevelPressure=101325.0f;
@@ -4201,7 +4330,10 @@ void MainWorker::decode_TempBaro(const CDomoticzHardwareBase* pHardware, const t
 		return;
 
 	uint64_t tID = ((uint64_t)(pHardware->m_HwdID & 0x7FFFFFFF) << 32) | (DevRowIdx & 0x7FFFFFFF);
-	m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	}
 
 	m_notifications.CheckAndHandleNotification(DevRowIdx, pHardware->m_HwdID, ID, procResult.DeviceName, Unit, devType, subType, cmnd, szTmp);
 
@@ -4305,7 +4437,10 @@ void MainWorker::decode_TempRain(const CDomoticzHardwareBase* pHardware, const t
 		return;
 
 	uint64_t tID = ((uint64_t)(pHardware->m_HwdID & 0x7FFFFFFF) << 32) | (DevRowIdx & 0x7FFFFFFF);
-	m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	{
+		std::lock_guard<std::mutex> l(m_calculatorMutex);
+		m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+	}
 
 	sprintf(szTmp, "%.1f", temp);
 	uint64_t DevRowIdxTemp = m_sql.UpdateValue(pHardware->m_HwdID, ID.c_str(), Unit, pTypeTEMP, sTypeTEMP3, SignalLevel, BatteryLevel, cmnd, szTmp, procResult.DeviceName, true, procResult.Username.c_str());
@@ -13997,7 +14132,10 @@ bool MainWorker::UpdateDevice(const int HardwareID, const std::string &DeviceID,
 		if (temp != 12345.0F)
 		{
 			uint64_t tID = ((uint64_t)(HardwareID & 0x7FFFFFFF) << 32) | (devidx & 0x7FFFFFFF);
-			m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+			{
+				std::lock_guard<std::mutex> l(m_calculatorMutex);
+				m_trend_calculator[tID].AddValueAndReturnTendency(static_cast<double>(temp), _tTrendCalculator::TAVERAGE_TEMP);
+			}
 		}
 
 #ifdef ENABLE_PYTHON
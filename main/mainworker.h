@@ -7,11 +7,14 @@
 #include "NotificationSystem.h"
 #include "Camera.h"
 #include <deque>
+#include <atomic>
+#include <array>
 #include "WindCalculation.h"
 #include "TrendCalculator.h"
 #include "StoppableTask.h"
 #include "../tcpserver/TCPServer.h"
 #include "concurrent_queue.h"
+#include "RxMessageBuffer.h"
 #include "../webserver/server_settings.hpp"
 #include "../iamserver/iam_settings.hpp"
 #ifdef ENABLE_PYTHON
@@ -54,6 +57,18 @@ public:
 	void DecodeRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
 	void PushAndWaitRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
 
+	// RX queue workers, messages are sharded by hardware id (only effective before Start), decoding stays serialized
+	void SetRxDecodeThreads(int nThreads);
+	int GetRxDecodeThreads() const;
+	struct _tRxQueueStatistics {
+		size_t depth;
+		size_t maxdepth;
+		uint64_t processed;
+		std::vector<uint64_t> latency; // end-to-end count per latency bucket
+	};
+	void GetRxQueueStatistics(std::vector<_tRxQueueStatistics> &stats);
+	static int GetRxLatencyBucketLimit(size_t bucket); // upper bound in ms, -1 for the overflow bucket
+
 	bool SwitchLight(const std::string &idx, const std::string &switchcmd, const std::string &level, const std::string &color, const std::string &ooc, int ExtraDelay, const std::string &User);
 	bool SwitchLight(uint64_t idx, const std::string &switchcmd, int level, _tColor color, bool ooc, int ExtraDelay, const std::string &User);
 	bool SwitchLightInt(const std::vector<std::string> &sd, std::string switchcmd, int level, _tColor color, bool IsTesting, const std::string &User);
@@ -129,6 +144,7 @@ public:
 	std::vector<std::string> m_webthemes;
 	std::map<uint16_t, _tWindCalculator> m_wind_calculator;
 	std::map<uint64_t, _tTrendCalculator> m_trend_calculator;
+	std::mutex m_calculatorMutex; // RX decode workers update the calculators concurrently
 
 	time_t m_LastHeartbeat = 0;
 private:
@@ -191,20 +207,32 @@ private:
 
 	// RxMessage queue resources
 	volatile unsigned long m_rxMessageIdx;
-	std::shared_ptr<std::thread> m_rxMessageThread;
 	StoppableTask m_TaskRXMessage;
-	void Do_Work_On_Rx_Messages();
 	struct _tRxQueueItem {
 		std::string Name;
 		int BatteryLevel;
 		unsigned long rxMessageIdx;
 		int hardwareId;
-		std::vector<uint8_t> vrxCommand;
+		_tRxMessageBuffer rxCommand; // inline, no allocation per message
 		boost::uint16_t crc;
 		queue_element_trigger* trigger;
 		std::string UserName;
+		std::chrono::steady_clock::time_point enqueued;
+	};
+	// One queue and worker per shard, a hardware always maps to the same shard so its messages stay ordered
+	static constexpr size_t RX_LATENCY_BUCKETS = 8;
+	struct _tRxShard {
+		int index = 0;
+		concurrent_queue<_tRxQueueItem, ring_deque<_tRxQueueItem> > queue; // slots are reused
+		std::shared_ptr<std::thread> thread;
+		std::atomic<size_t> depth{ 0 };
+		std::atomic<size_t> maxdepth{ 0 };
+		std::atomic<uint64_t> processed{ 0 };
+		std::array<std::atomic<uint64_t>, RX_LATENCY_BUCKETS> latency{};
 	};
-	concurrent_queue<_tRxQueueItem> m_rxMessageQueue;
+	std::vector<std::unique_ptr<_tRxShard>> m_rxShards;
+	void Do_Work_On_Rx_Messages(_tRxShard *pShard);
+	void PushRxShard(_tRxShard *pShard, _tRxQueueItem &&rxMessage);
 	void UnlockRxMessageQueue();
 	void PushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
 	void CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName, bool wait);
@@ -240,17 +240,179 @@ std::string CNotificationHelper::ParseCustomMessage(const std::string &cMessage,
 	return ret;
 }
 
-bool CNotificationHelper::ApplyRule(const std::string &rule, const bool equal, const bool less)
+void _tNotificationRule::Compile(const std::string &Params)
 {
-	if (((rule == ">") || (rule == ">=")) && (!less) && (!equal))
-		return true;
-	if (((rule == "<") || (rule == "<=")) && (less))
-		return true;
-	if (((rule == "=") || (rule == ">=") || (rule == "<=")) && (equal))
-		return true;
-	if ((rule == "!=") && (!equal))
+	std::vector<std::string> splitresults;
+	StringSplit(Params, ";", splitresults);
+	Fields = splitresults.size();
+
+	Type = -1;
+	if (Fields > 0)
+	{
+		for (int ii = NTYPE_TEMPERATURE; ii <= NTYPE_SLEEPING; ii++)
+		{
+			if (splitresults[0] == Notification_Type_Desc(ii, 1))
+			{
+				Type = ii;
+				break;
+			}
+		}
+	}
+	Condition = (Fields > 1) ? splitresults[1] : "";
+	if (Condition == ">")
+		Compare = _eNotificationCondition::Greater;
+	else if (Condition == ">=")
+		Compare = _eNotificationCondition::GreaterEqual;
+	else if (Condition == "=")
+		Compare = _eNotificationCondition::Equal;
+	else if (Condition == "!=")
+		Compare = _eNotificationCondition::NotEqual;
+	else if (Condition == "<=")
+		Compare = _eNotificationCondition::LessEqual;
+	else if (Condition == "<")
+		Compare = _eNotificationCondition::Less;
+	else
+		Compare = _eNotificationCondition::None;
+	Value = (Fields > 2) ? static_cast<float>(atof(splitresults[2].c_str())) : 0.0F;
+	Recovery = (Fields > 3) && (splitresults[3] == "1");
+}
+
+bool _tNotificationRule::Apply(const bool equal, const bool less) const
+{
+	switch (Compare)
+	{
+	case _eNotificationCondition::Greater:
+		return (!less) && (!equal);
+	case _eNotificationCondition::GreaterEqual:
+		return !less;
+	case _eNotificationCondition::Equal:
+		return equal;
+	case _eNotificationCondition::NotEqual:
+		return !equal;
+	case _eNotificationCondition::LessEqual:
+		return less || equal;
+	case _eNotificationCondition::Less:
+		return less;
+	default:
+		return false;
+	}
+}
+
+// Copies the notifications of a device that have one of the given types. Returns false when the device has no notifications
+// (or, when pInfo is given, is not in the database anymore).
+bool CNotificationHelper::GetDeviceNotifications(const uint64_t DevIdx, const std::initializer_list<_eNotificationTypes> ntypes, const bool bTouchLastUpdate, std::vector<_tNotification> &notifications,
+						 _tNotificationDeviceInfo *pInfo)
+{
+	notifications.clear();
+	if (pInfo != nullptr)
+		ReloadStaleDeviceInfo(DevIdx);
+	std::lock_guard<std::mutex> l(m_mutex);
+	auto itt = m_notifications.find(DevIdx);
+	if (itt == m_notifications.end())
+		return false;
+	time_t atime = mytime(nullptr);
+	for (auto &n : itt->second.Notifications)
+	{
+		if (bTouchLastUpdate && n.LastUpdate)
+			n.LastUpdate = atime;
+		if (std::find(ntypes.begin(), ntypes.end(), n.Rule.Type) != ntypes.end())
+			notifications.push_back(n);
+	}
+	if (pInfo == nullptr)
 		return true;
-	return false;
+	if (!itt->second.Info.bExists)
+		return false;
+	if (!notifications.empty())
+		*pInfo = itt->second.Info;
+	return true;
+}
+
+bool CNotificationHelper::GetDeviceInfo(const uint64_t DevIdx, _tNotificationDeviceInfo &info)
+{
+	ReloadStaleDeviceInfo(DevIdx);
+	std::lock_guard<std::mutex> l(m_mutex);
+	auto itt = m_notifications.find(DevIdx);
+	if ((itt == m_notifications.end()) || (!itt->second.Info.bExists))
+		return false;
+	info = itt->second.Info;
+	return true;
+}
+
+// The rain of today is the counter minus the lowest counter stored today, that minimum is only queried once a day
+bool CNotificationHelper::GetRainDayMinimum(const uint64_t DevIdx, const std::string &szDate, const float mvalue, float &total_min)
+{
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		auto itt = m_notifications.find(DevIdx);
+		if (itt == m_notifications.end())
+			return false;
+		if (itt->second.RainDate == szDate)
+		{
+			// a counter reset lowers the minimum before it is stored in the Rain table
+			itt->second.RainDayMinimum = std::min(itt->second.RainDayMinimum, mvalue);
+			total_min = itt->second.RainDayMinimum;
+			return true;
+		}
+	}
+
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT MIN(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
+		DevIdx, szDate.c_str());
+	if (result.empty())
+		return false;
+	total_min = static_cast<float>(atof(result[0][0].c_str()));
+	if (!result[0][0].empty()) // NULL until the first rain sample of the day is stored
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		auto itt = m_notifications.find(DevIdx);
+		if (itt != m_notifications.end())
+		{
+			itt->second.RainDate = szDate;
+			itt->second.RainDayMinimum = total_min;
+		}
+	}
+	return true;
+}
+
+void CNotificationHelper::LoadDeviceInfo(const std::vector<std::string> &sd, _tNotificationDeviceInfo &info)
+{
+	info.bExists = true;
+	info.SwitchType = sd[1];
+	info.CustomImage = sd[2];
+	info.Options = sd[3];
+	info.AddjMulti = atof(sd[4].c_str());
+}
+
+void CNotificationHelper::InvalidateDeviceInfo(const uint64_t DevIdx)
+{
+	std::lock_guard<std::mutex> l(m_stale_mutex);
+	m_stale_devices.insert(DevIdx);
+}
+
+void CNotificationHelper::ReloadStaleDeviceInfo(const uint64_t DevIdx)
+{
+	{
+		std::lock_guard<std::mutex> l(m_stale_mutex);
+		if (m_stale_devices.erase(DevIdx) == 0)
+			return;
+	}
+	ReloadDeviceInfo(DevIdx);
+}
+
+void CNotificationHelper::ReloadDeviceInfo(const uint64_t DevIdx)
+{
+	if (!HasNotifications(DevIdx))
+		return;
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT ID, SwitchType, CustomImage, Options, AddjMulti FROM DeviceStatus WHERE (ID=%" PRIu64 ")", DevIdx);
+
+	std::lock_guard<std::mutex> l(m_mutex);
+	auto itt = m_notifications.find(DevIdx);
+	if (itt == m_notifications.end())
+		return;
+	itt->second.Info = _tNotificationDeviceInfo();
+	if (!result.empty())
+		LoadDeviceInfo(result[0], itt->second.Info);
 }
 
 bool CNotificationHelper::CheckAndHandleNotification(const uint64_t DevRowIdx, const int HardwareID, const std::string &ID, const std::string &sName, const unsigned char unit, const unsigned char cType, const unsigned char cSubType, const int nValue) {
@@ -280,6 +442,9 @@ bool CNotificationHelper::CheckAndHandleNotification(const uint64_t DevRowIdx, c
 	if ((DevRowIdx == -1) || IsLightOrSwitch(cType, cSubType)) {
 		return false;
 	}
+	// Nothing to check (or to split and convert) for devices without notifications
+	if (!HasNotifications(DevRowIdx))
+		return false;
 
 	int meterType = 0;
 	std::vector<std::string> strarray;
@@ -521,8 +686,8 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 	const bool bHaveTemp,
 	const bool bHaveHumidity)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	if (!GetDeviceNotifications(Idx, { NTYPE_TEMPERATURE, NTYPE_HUMIDITY }, true, notifications, nullptr))
 		return false;
 
 	char szTmp[600];
@@ -539,14 +704,9 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 	std::string msg;
 
 	std::string label = Notification_Type_Label(NTYPE_TEMPERATURE);
-	std::string signtemp = Notification_Type_Desc(NTYPE_TEMPERATURE, 1);
-	std::string signhum = Notification_Type_Desc(NTYPE_HUMIDITY, 1);
 
 	for (const auto &n : notifications)
 	{
-		if (n.LastUpdate)
-			TouchLastUpdate(n.ID);
-
 		if ((atime >= n.LastSend) || (n.SendAlways) || (!n.CustomMessage.empty())) // emergency always goes true
 		{
 			std::string recoverymsg;
@@ -554,18 +714,15 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 			bRecoveryMessage = CustomRecoveryMessage(n.ID, recoverymsg, true);
 			if ((atime < n.LastSend) && (!n.SendAlways) && (!bRecoveryMessage))
 				continue;
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 3)
+			if (n.Rule.Fields < 3)
 				continue; //impossible
-			std::string ntype = splitresults[0];
 			std::string custommsg;
-			float svalue = static_cast<float>(atof(splitresults[2].c_str()));
+			float svalue = n.Rule.Value;
 			bool bSendNotification = false;
 			bool bCustomMessage = false;
 			bCustomMessage = CustomRecoveryMessage(n.ID, custommsg, false);
 
-			if ((ntype == signtemp) && (bHaveTemp))
+			if ((n.Rule.Type == NTYPE_TEMPERATURE) && (bHaveTemp))
 			{
 				//temperature
 				if (m_sql.m_tempunit == TEMPUNIT_F)
@@ -581,10 +738,10 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 				else if (temp > 10.0) szExtraData += "Image=temp-10-15|";
 				else if (temp > 5.0) szExtraData += "Image=temp-5-10|";
 				else szExtraData += "Image=temp48|";
-				bSendNotification = ApplyRule(splitresults[1], (temp == svalue), (temp < svalue));
+				bSendNotification = n.Rule.Apply((temp == svalue), (temp < svalue));
 				if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 				{
-					sprintf(szTmp, "%s Temperature is %.1f %s [%s %.1f %s]", devicename.c_str(), temp, label.c_str(), splitresults[1].c_str(), svalue, label.c_str());
+					sprintf(szTmp, "%s Temperature is %.1f %s [%s %.1f %s]", devicename.c_str(), temp, label.c_str(), n.Rule.Condition.c_str(), svalue, label.c_str());
 					msg = szTmp;
 					sprintf(szTmp, "%.1f", temp);
 					notValue = szTmp;
@@ -601,14 +758,14 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 					bSendNotification = false;
 				}
 			}
-			else if ((ntype == signhum) && (bHaveHumidity))
+			else if ((n.Rule.Type == NTYPE_HUMIDITY) && (bHaveHumidity))
 			{
 				//humidity
 				szExtraData += "Image=moisture48|";
-				bSendNotification = ApplyRule(splitresults[1], (humidity == svalue), (humidity < svalue));
+				bSendNotification = n.Rule.Apply((humidity == svalue), (humidity < svalue));
 				if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 				{
-					sprintf(szTmp, "%s Humidity is %d %% [%s %.0f %%]", devicename.c_str(), humidity, splitresults[1].c_str(), svalue);
+					sprintf(szTmp, "%s Humidity is %d %% [%s %.0f %%]", devicename.c_str(), humidity, n.Rule.Condition.c_str(), svalue);
 					msg = szTmp;
 					sprintf(szTmp, "%d", humidity);
 					notValue = szTmp;
@@ -647,8 +804,8 @@ bool CNotificationHelper::CheckAndHandleDewPointNotification(
 	const float temp,
 	const float dewpoint)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	if (!GetDeviceNotifications(Idx, { NTYPE_DEWPOINT }, true, notifications, nullptr))
 		return false;
 
 	char szTmp[600];
@@ -663,35 +820,22 @@ bool CNotificationHelper::CheckAndHandleDewPointNotification(
 
 	std::string msg;
 
-	std::string signdewpoint = Notification_Type_Desc(NTYPE_DEWPOINT, 1);
-
 	for (const auto &n : notifications)
 	{
-		if (n.LastUpdate)
-			TouchLastUpdate(n.ID);
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
-			std::string ntype = splitresults[0];
-
-			if (ntype == signdewpoint)
+			//dewpoint
+			if (temp <= dewpoint)
 			{
-				//dewpoint
-				if (temp <= dewpoint)
-				{
-					sprintf(szTmp, "%s Dew Point reached (%.1f degrees)", devicename.c_str(), temp);
-					msg = szTmp;
-					sprintf(szTmp, "%.1f", temp);
-					notValue = szTmp;
-					if (!n.CustomMessage.empty())
-						msg = ParseCustomMessage(n.CustomMessage, devicename, notValue);
-					SendMessageEx(Idx, devicename, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""),
-						      true);
-					TouchNotification(n.ID);
-				}
+				sprintf(szTmp, "%s Dew Point reached (%.1f degrees)", devicename.c_str(), temp);
+				msg = szTmp;
+				sprintf(szTmp, "%.1f", temp);
+				notValue = szTmp;
+				if (!n.CustomMessage.empty())
+					msg = ParseCustomMessage(n.CustomMessage, devicename, notValue);
+				SendMessageEx(Idx, devicename, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""),
+					      true);
+				TouchNotification(n.ID);
 			}
 		}
 	}
@@ -703,8 +847,8 @@ bool CNotificationHelper::CheckAndHandleValueNotification(
 	const std::string &DeviceName,
 	const int value)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	if (!GetDeviceNotifications(Idx, { NTYPE_VALUE }, true, notifications, nullptr))
 		return false;
 
 	char szTmp[600];
@@ -718,35 +862,26 @@ bool CNotificationHelper::CheckAndHandleValueNotification(
 	std::string msg;
 	std::string notValue;
 
-	std::string signvalue = Notification_Type_Desc(NTYPE_VALUE, 1);
-
 	for (const auto &n : notifications)
 	{
-		if (n.LastUpdate)
-			TouchLastUpdate(n.ID);
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 2)
+			if (n.Rule.Fields < 2)
 				continue; //impossible
-			std::string ntype = splitresults[0];
-			int svalue = static_cast<int>(atoi(splitresults[1].c_str()));
+			// value notifications have their limit in the second field
+			int svalue = static_cast<int>(atoi(n.Rule.Condition.c_str()));
 
-			if (ntype == signvalue)
+			if (value > svalue)
 			{
-				if (value > svalue)
-				{
-					sprintf(szTmp, "%s is %d", DeviceName.c_str(), value);
-					msg = szTmp;
-					sprintf(szTmp, "%d", value);
-					notValue = szTmp;
-					if (!n.CustomMessage.empty())
-						msg = ParseCustomMessage(n.CustomMessage, DeviceName, notValue);
-					SendMessageEx(Idx, DeviceName, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""),
-						      true);
-					TouchNotification(n.ID);
-				}
+				sprintf(szTmp, "%s is %d", DeviceName.c_str(), value);
+				msg = szTmp;
+				sprintf(szTmp, "%d", value);
+				notValue = szTmp;
+				if (!n.CustomMessage.empty())
+					msg = ParseCustomMessage(n.CustomMessage, DeviceName, notValue);
+				SendMessageEx(Idx, DeviceName, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""),
+					      true);
+				TouchNotification(n.ID);
 			}
 		}
 	}
@@ -760,8 +895,8 @@ bool CNotificationHelper::CheckAndHandleAmpere123Notification(
 	const float Ampere2,
 	const float Ampere3)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	if (!GetDeviceNotifications(Idx, { NTYPE_AMPERE1, NTYPE_AMPERE2, NTYPE_AMPERE3 }, true, notifications, nullptr))
 		return false;
 
 	char szTmp[600];
@@ -777,15 +912,8 @@ bool CNotificationHelper::CheckAndHandleAmpere123Notification(
 
 	std::string notValue;
 
-	std::string signamp1 = Notification_Type_Desc(NTYPE_AMPERE1, 1);
-	std::string signamp2 = Notification_Type_Desc(NTYPE_AMPERE2, 1);
-	std::string signamp3 = Notification_Type_Desc(NTYPE_AMPERE3, 1);
-
 	for (const auto &n : notifications)
 	{
-		if (n.LastUpdate)
-			TouchLastUpdate(n.ID);
-
 		if ((atime >= n.LastSend) || (n.SendAlways) || (!n.CustomMessage.empty())) // emergency always goes true
 		{
 			std::string recoverymsg;
@@ -793,38 +921,26 @@ bool CNotificationHelper::CheckAndHandleAmpere123Notification(
 			bRecoveryMessage = CustomRecoveryMessage(n.ID, recoverymsg, true);
 			if ((atime < n.LastSend) && (!n.SendAlways) && (!bRecoveryMessage))
 				continue;
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 3)
+			if (n.Rule.Fields < 3)
 				continue; //impossible
-			std::string ntype = splitresults[0];
 			std::string custommsg;
-			std::string ltype;
-			float svalue = static_cast<float>(atof(splitresults[2].c_str()));
+			std::string ltype = Notification_Type_Desc(n.Rule.Type, 0);
+			float svalue = n.Rule.Value;
 			float ampere = 0.0F;
 			bool bSendNotification = false;
 			bool bCustomMessage = false;
 			bCustomMessage = CustomRecoveryMessage(n.ID, custommsg, false);
 
-			if (ntype == signamp1)
-			{
+			if (n.Rule.Type == NTYPE_AMPERE1)
 				ampere = Ampere1;
-				ltype = Notification_Type_Desc(NTYPE_AMPERE1, 0);
-			}
-			else if (ntype == signamp2)
-			{
+			else if (n.Rule.Type == NTYPE_AMPERE2)
 				ampere = Ampere2;
-				ltype = Notification_Type_Desc(NTYPE_AMPERE2, 0);
-			}
-			else if (ntype == signamp3)
-			{
+			else
 				ampere = Ampere3;
-				ltype = Notification_Type_Desc(NTYPE_AMPERE3, 0);
-			}
-			bSendNotification = ApplyRule(splitresults[1], (ampere == svalue), (ampere < svalue));
+			bSendNotification = n.Rule.Apply((ampere == svalue), (ampere < svalue));
 			if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 			{
-				sprintf(szTmp, "%s %s is %.1f Ampere [%s %.1f Ampere]", devicename.c_str(), ltype.c_str(), ampere, splitresults[1].c_str(), svalue);
+				sprintf(szTmp, "%s %s is %.1f Ampere [%s %.1f Ampere]", devicename.c_str(), ltype.c_str(), ampere, n.Rule.Condition.c_str(), svalue);
 				msg = szTmp;
 				sprintf(szTmp, "%.1f", ampere);
 				notValue = szTmp;
@@ -862,16 +978,14 @@ bool CNotificationHelper::CheckAndHandleNotification(
 	const _eNotificationTypes ntype,
 	const std::string &message)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
-		return false;
-
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT SwitchType, CustomImage FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-	if (result.empty())
+	std::vector<_tNotification> notifications;
+	_tNotificationDeviceInfo info;
+	if (!GetDeviceNotifications(Idx, { ntype }, true, notifications, &info))
 		return false;
+	if (notifications.empty())
+		return true;
 
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|CustomImage=" + result[0][1] + "|";
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + info.SwitchType + "|CustomImage=" + info.CustomImage + "|";
 	std::string notValue;
 
 	time_t atime = mytime(nullptr);
@@ -879,26 +993,15 @@ bool CNotificationHelper::CheckAndHandleNotification(
 	//check if not sent 12 hours ago, and if applicable
 	atime -= m_NotificationSensorInterval;
 
-	std::string ltype = Notification_Type_Desc(ntype, 1);
 	for (const auto &n : notifications)
 	{
-		if (n.LastUpdate)
-			TouchLastUpdate(n.ID);
-		std::vector<std::string> splitresults;
-		StringSplit(n.Params, ";", splitresults);
-		if (splitresults.empty())
-			continue; //impossible
-		std::string atype = splitresults[0];
-		if (atype == ltype)
+		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
-			{
-				std::string msg = message;
-				if (!n.CustomMessage.empty())
-					msg = ParseCustomMessage(n.CustomMessage, devicename, notValue);
-				SendMessageEx(Idx, devicename, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""), true);
-				TouchNotification(n.ID);
-			}
+			std::string msg = message;
+			if (!n.CustomMessage.empty())
+				msg = ParseCustomMessage(n.CustomMessage, devicename, notValue);
+			SendMessageEx(Idx, devicename, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""), true);
+			TouchNotification(n.ID);
 		}
 	}
 	return true;
@@ -912,9 +1015,12 @@ bool CNotificationHelper::CheckAndHandleNotification(
 	const _eNotificationTypes ntype,
 	const float mvalue)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	_tNotificationDeviceInfo info;
+	if (!GetDeviceNotifications(Idx, { ntype }, true, notifications, &info))
 		return false;
+	if (notifications.empty())
+		return true;
 
 	char szTmp[600];
 
@@ -926,11 +1032,7 @@ bool CNotificationHelper::CheckAndHandleNotification(
 		sprintf(szTmp, "%.1f", mvalue);
 	pvalue = szTmp;
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT SwitchType FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-	if (result.empty())
-		return false;
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|";
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + info.SwitchType + "|";
 
 	time_t atime = mytime(nullptr);
 
@@ -940,14 +1042,10 @@ bool CNotificationHelper::CheckAndHandleNotification(
 	std::string msg;
 
 	std::string ltype = Notification_Type_Desc(ntype, 0);
-	std::string nsign = Notification_Type_Desc(ntype, 1);
 	std::string label = Notification_Type_Label(ntype);
 
 	for (const auto &n : notifications)
 	{
-		if (n.LastUpdate)
-			TouchLastUpdate(n.ID);
-
 		if ((atime >= n.LastSend) || (n.SendAlways) || (!n.CustomMessage.empty())) // emergency always goes true
 		{
 			std::string recoverymsg;
@@ -955,36 +1053,30 @@ bool CNotificationHelper::CheckAndHandleNotification(
 			bRecoveryMessage = CustomRecoveryMessage(n.ID, recoverymsg, true);
 			if ((atime < n.LastSend) && (!n.SendAlways) && (!bRecoveryMessage))
 				continue;
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 3)
+			if (n.Rule.Fields < 3)
 				continue; //impossible
-			std::string ntype = splitresults[0];
 			std::string custommsg;
-			float svalue = static_cast<float>(atof(splitresults[2].c_str()));
+			float svalue = n.Rule.Value;
 			bool bSendNotification = false;
 			bool bCustomMessage = false;
 			bCustomMessage = CustomRecoveryMessage(n.ID, custommsg, false);
 
-			if (ntype == nsign)
+			bSendNotification = n.Rule.Apply((mvalue == svalue), (mvalue < svalue));
+			if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 			{
-				bSendNotification = ApplyRule(splitresults[1], (mvalue == svalue), (mvalue < svalue));
-				if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
-				{
-					sprintf(szTmp, "%s %s is %s %s [%s %.1f %s]", devicename.c_str(), ltype.c_str(), pvalue.c_str(), label.c_str(), splitresults[1].c_str(), svalue, label.c_str());
-					msg = szTmp;
-				}
-				else if (!bSendNotification && bRecoveryMessage)
-				{
-					bSendNotification = true;
-					msg = recoverymsg;
-					std::string clearstr = "!";
-					CustomRecoveryMessage(n.ID, clearstr, true);
-				}
-				else
-				{
-					bSendNotification = false;
-				}
+				sprintf(szTmp, "%s %s is %s %s [%s %.1f %s]", devicename.c_str(), ltype.c_str(), pvalue.c_str(), label.c_str(), n.Rule.Condition.c_str(), svalue, label.c_str());
+				msg = szTmp;
+			}
+			else if (!bSendNotification && bRecoveryMessage)
+			{
+				bSendNotification = true;
+				msg = recoverymsg;
+				std::string clearstr = "!";
+				CustomRecoveryMessage(n.ID, clearstr, true);
+			}
+			else
+			{
+				bSendNotification = false;
 			}
 			if (bSendNotification)
 			{
@@ -1007,23 +1099,18 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	const std::string &devicename,
 	const _eNotificationTypes ntype)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	_tNotificationDeviceInfo info;
+	if (!GetDeviceNotifications(Idx, { ntype }, false, notifications, &info))
 		return false;
+	if (notifications.empty())
+		return true;
 
-	std::vector<std::vector<std::string> > result;
-
-	result = m_sql.safe_query("SELECT SwitchType, CustomImage FROM DeviceStatus WHERE (ID=%" PRIu64 ")",
-		Idx);
-	if (result.empty())
-		return false;
-	_eSwitchType switchtype = (_eSwitchType)atoi(result[0][0].c_str());
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|CustomImage=" + result[0][1] + "|";
+	_eSwitchType switchtype = (_eSwitchType)atoi(info.SwitchType.c_str());
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + info.SwitchType + "|CustomImage=" + info.CustomImage + "|";
 
 	std::string msg;
 
-	std::string ltype = Notification_Type_Desc(ntype, 1);
-
 	time_t atime = mytime(nullptr);
 	atime -= m_NotificationSwitchInterval;
 
@@ -1031,84 +1118,70 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	{
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
-			std::string atype = splitresults[0];
-
-			bool bSendNotification = false;
 			std::string notValue;
 
-			if (atype == ltype)
+			msg = devicename;
+			if (ntype == NTYPE_SWITCH_ON)
 			{
-				bSendNotification = true;
-				msg = devicename;
-				if (ntype == NTYPE_SWITCH_ON)
+				szExtraData += "Status=On|";
+				switch (switchtype)
 				{
-					szExtraData += "Status=On|";
-					switch (switchtype)
-					{
-					case STYPE_Doorbell:
-						notValue = "pressed";
-						break;
-					case STYPE_Contact:
-						notValue = "Open";
-						szExtraData += "Image=Contact48_On|";
-						break;
-					case STYPE_DoorContact:
-						notValue = "Open";
-						szExtraData += "Image=Door48_On|";
-						break;
-					case STYPE_DoorLock:
-						notValue = "Locked";
-						szExtraData += "Image=Door48_Off|";
-						break;
-					case STYPE_DoorLockInverted:
-						notValue = "Unlocked";
-						szExtraData += "Image=Door48_On|";
-						break;
-					case STYPE_Motion:
-						notValue = "movement detected";
-						break;
-					case STYPE_SMOKEDETECTOR:
-						notValue = "ALARM/FIRE !";
-						break;
-					default:
-						notValue = ">> ON";
-						break;
-					}
-				}
-				else {
-					szExtraData += "Status=Off|";
-					switch (switchtype)
-					{
-					case STYPE_DoorContact:
-					case STYPE_Contact:
-						notValue = "Closed";
-						break;
-					case STYPE_DoorLock:
-						notValue = "Unlocked";
-						szExtraData += "Image=Door48_On|";
-						break;
-					case STYPE_DoorLockInverted:
-						notValue = "Locked";
-						szExtraData += "Image=Door48_Off|";
-						break;
-					default:
-						notValue = ">> OFF";
-						break;
-					}
+				case STYPE_Doorbell:
+					notValue = "pressed";
+					break;
+				case STYPE_Contact:
+					notValue = "Open";
+					szExtraData += "Image=Contact48_On|";
+					break;
+				case STYPE_DoorContact:
+					notValue = "Open";
+					szExtraData += "Image=Door48_On|";
+					break;
+				case STYPE_DoorLock:
+					notValue = "Locked";
+					szExtraData += "Image=Door48_Off|";
+					break;
+				case STYPE_DoorLockInverted:
+					notValue = "Unlocked";
+					szExtraData += "Image=Door48_On|";
+					break;
+				case STYPE_Motion:
+					notValue = "movement detected";
+					break;
+				case STYPE_SMOKEDETECTOR:
+					notValue = "ALARM/FIRE !";
+					break;
+				default:
+					notValue = ">> ON";
+					break;
 				}
-				msg += " " + notValue;
 			}
-			if (bSendNotification)
-			{
-				if (!n.CustomMessage.empty())
-					msg = ParseCustomMessage(n.CustomMessage, devicename, notValue);
-				SendMessageEx(Idx, devicename, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""), true);
-				TouchNotification(n.ID);
+			else {
+				szExtraData += "Status=Off|";
+				switch (switchtype)
+				{
+				case STYPE_DoorContact:
+				case STYPE_Contact:
+					notValue = "Closed";
+					break;
+				case STYPE_DoorLock:
+					notValue = "Unlocked";
+					szExtraData += "Image=Door48_On|";
+					break;
+				case STYPE_DoorLockInverted:
+					notValue = "Locked";
+					szExtraData += "Image=Door48_Off|";
+					break;
+				default:
+					notValue = ">> OFF";
+					break;
+				}
 			}
+			msg += " " + notValue;
+			if (!n.CustomMessage.empty())
+				msg = ParseCustomMessage(n.CustomMessage, devicename, notValue);
+			SendMessageEx(Idx, devicename, n.ActiveSystems, n.CustomAction, msg, msg, szExtraData, n.Priority, std::string(""), true);
+			TouchNotification(n.ID);
 		}
 	}
 	return true;
@@ -1120,23 +1193,19 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	const _eNotificationTypes ntype,
 	const int llevel)
 {
-	std::vector<_tNotification> notifications = GetNotifications(Idx);
-	if (notifications.empty())
+	std::vector<_tNotification> notifications;
+	_tNotificationDeviceInfo info;
+	if (!GetDeviceNotifications(Idx, { ntype }, false, notifications, &info))
 		return false;
-	std::vector<std::vector<std::string> > result;
+	if (notifications.empty())
+		return true;
 
-	result = m_sql.safe_query("SELECT SwitchType, CustomImage, Options FROM DeviceStatus WHERE (ID=%" PRIu64 ")",
-		Idx);
-	if (result.empty())
-		return false;
-	_eSwitchType switchtype = (_eSwitchType)atoi(result[0][0].c_str());
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|CustomImage=" + result[0][1] + "|";
-	std::string sOptions = result[0][2];
+	_eSwitchType switchtype = (_eSwitchType)atoi(info.SwitchType.c_str());
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + info.SwitchType + "|CustomImage=" + info.CustomImage + "|";
+	const std::string &sOptions = info.Options;
 
 	std::string msg;
 
-	std::string ltype = Notification_Type_Desc(ntype, 1);
-
 	time_t atime = mytime(nullptr);
 	atime -= m_NotificationSwitchInterval;
 
@@ -1144,57 +1213,48 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	{
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.empty())
-				continue; //impossible
-			std::string atype = splitresults[0];
-
 			bool bSendNotification = false;
 			std::string notValue;
 
-			if (atype == ltype)
+			msg = devicename;
+			if (ntype == NTYPE_SWITCH_ON)
 			{
-				msg = devicename;
-				if (ntype == NTYPE_SWITCH_ON)
+				if (n.Rule.Fields < 3)
+					continue; //impossible
+				bool bWhenEqual = (n.Rule.Compare == _eNotificationCondition::Equal);
+				int iLevel = static_cast<int>(n.Rule.Value);
+				if (!bWhenEqual || iLevel < 10 || iLevel > 100)
+					continue; //invalid
+
+				if (llevel == iLevel)
 				{
-					if (splitresults.size() < 3)
-						continue; //impossible
-					bool bWhenEqual = (splitresults[1] == "=");
-					int iLevel = atoi(splitresults[2].c_str());
-					if (!bWhenEqual || iLevel < 10 || iLevel > 100)
-						continue; //invalid
-
-					if (llevel == iLevel)
+					bSendNotification = true;
+					std::string sLevel = std::to_string(llevel);
+					szExtraData += "Status=Level " + sLevel + "|";
+
+					if (switchtype == STYPE_Selector)
 					{
-						bSendNotification = true;
-						std::string sLevel = std::to_string(llevel);
-						szExtraData += "Status=Level " + sLevel + "|";
-
-						if (switchtype == STYPE_Selector)
-						{
-							std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sOptions);
-							std::string levelNames = options["LevelNames"];
-							std::vector<std::string> splitresults;
-							StringSplit(levelNames, "|", splitresults);
-							msg += " >> " + splitresults[(llevel / 10)];
-							notValue = ">> " + splitresults[(llevel / 10)];
-						}
-						else
-						{
-							msg += " >> LEVEL " + sLevel;
-							notValue = ">> LEVEL " + sLevel;
-						}
+						std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sOptions);
+						std::string levelNames = options["LevelNames"];
+						std::vector<std::string> splitresults;
+						StringSplit(levelNames, "|", splitresults);
+						msg += " >> " + splitresults[(llevel / 10)];
+						notValue = ">> " + splitresults[(llevel / 10)];
+					}
+					else
+					{
+						msg += " >> LEVEL " + sLevel;
+						notValue = ">> LEVEL " + sLevel;
 					}
-				}
-				else
-				{
-					bSendNotification = true;
-					szExtraData += "Status=Off|";
-					msg += " >> OFF";
-					notValue = ">> OFF";
 				}
 			}
+			else
+			{
+				bSendNotification = true;
+				szExtraData += "Status=Off|";
+				msg += " >> OFF";
+				notValue = ">> OFF";
+			}
 			if (bSendNotification)
 			{
 				if (!n.CustomMessage.empty())
@@ -1215,14 +1275,10 @@ bool CNotificationHelper::CheckAndHandleRainNotification(
 	const _eNotificationTypes ntype,
 	const float mvalue)
 {
-	std::vector<std::vector<std::string> > result;
-
-	result = m_sql.safe_query("SELECT AddjValue,AddjMulti FROM DeviceStatus WHERE (ID=%" PRIu64 ")",
-		Idx);
-	if (result.empty())
+	_tNotificationDeviceInfo info;
+	if (!GetDeviceInfo(Idx, info))
 		return false;
-	//double AddjValue = atof(result[0][0].c_str());
-	double AddjMulti = atof(result[0][1].c_str());
+	double AddjMulti = info.AddjMulti;
 
 	char szDateEnd[40];
 
@@ -1249,13 +1305,9 @@ bool CNotificationHelper::CheckAndHandleRainNotification(
 	}
 	else
 	{
-		result = m_sql.safe_query("SELECT MIN(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-			Idx, szDateEnd);
-		if (!result.empty())
+		float total_min;
+		if (GetRainDayMinimum(Idx, szDateEnd, mvalue, total_min))
 		{
-			std::vector<std::string> sd = result[0];
-
-			float total_min = static_cast<float>(atof(sd[0].c_str()));
 			float total_max = mvalue;
 			double total_real = total_max - total_min;
 			total_real *= AddjMulti;
@@ -1268,84 +1320,83 @@ bool CNotificationHelper::CheckAndHandleRainNotification(
 
 void CNotificationHelper::CheckAndHandleLastUpdateNotification()
 {
-	if (m_notifications.empty())
-		return;
-
 	time_t atime = mytime(nullptr);
 	atime -= m_NotificationSensorInterval;
 
-	for (const auto &n : m_notifications)
+	// Collect the 'last update' notifications first, sending them updates the notifications
+	std::vector<std::pair<uint64_t, _tNotification>> lastupdates;
 	{
-		for (const auto &n2 : n.second)
+		std::lock_guard<std::mutex> l(m_mutex);
+		for (const auto &n : m_notifications)
 		{
-			if (((atime >= n2.LastSend) || (n2.SendAlways) || (!n2.CustomMessage.empty()))
-			    && (n2.LastUpdate)) // emergency always goes true
+			for (const auto &n2 : n.second.Notifications)
 			{
-				std::vector<std::string> splitresults;
-				StringSplit(n2.Params, ";", splitresults);
-				if (splitresults.size() < 3)
+				if ((n2.Rule.Type == NTYPE_LASTUPDATE) && (n2.Rule.Fields >= 3) && (n2.LastUpdate))
+					lastupdates.emplace_back(n.first, n2);
+			}
+		}
+	}
+
+	for (const auto &itt : lastupdates)
+	{
+		const _tNotification &n2 = itt.second;
+		if ((atime >= n2.LastSend) || (n2.SendAlways) || (!n2.CustomMessage.empty())) // emergency always goes true
+		{
+			std::string recoverymsg;
+			bool bRecoveryMessage = false;
+			bRecoveryMessage = CustomRecoveryMessage(n2.ID, recoverymsg, true);
+			if ((atime < n2.LastSend) && (!n2.SendAlways) && (!bRecoveryMessage))
+				continue;
+			extern time_t m_StartTime;
+			time_t btime = mytime(nullptr);
+			std::string msg;
+			std::string szExtraData;
+			std::string custommsg;
+			uint64_t Idx = itt.first;
+			uint32_t SensorTimeOut = static_cast<uint32_t>(static_cast<int>(n2.Rule.Value)); // minutes
+			uint32_t diff = static_cast<uint32_t>(round(difftime(btime, n2.LastUpdate)));
+			bool bStartTime = (difftime(btime, m_StartTime) < SensorTimeOut * 60);
+			bool bSendNotification = n2.Rule.Apply((diff == SensorTimeOut * 60), (diff < SensorTimeOut * 60));
+			bool bCustomMessage = false;
+			bCustomMessage = CustomRecoveryMessage(n2.ID, custommsg, false);
+
+			if (bSendNotification && !bStartTime && (!bRecoveryMessage || n2.SendAlways))
+			{
+				if (SystemUptime() < SensorTimeOut * 60 && (!bRecoveryMessage || n2.SendAlways))
 					continue;
-				std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
-				if (splitresults[0] == ttype)
-				{
-					std::string recoverymsg;
-					bool bRecoveryMessage = false;
-					bRecoveryMessage = CustomRecoveryMessage(n2.ID, recoverymsg, true);
-					if ((atime < n2.LastSend) && (!n2.SendAlways) && (!bRecoveryMessage))
-						continue;
-					extern time_t m_StartTime;
-					time_t btime = mytime(nullptr);
-					std::string msg;
-					std::string szExtraData;
-					std::string custommsg;
-					uint64_t Idx = n.first;
-					uint32_t SensorTimeOut = static_cast<uint32_t>(atoi(splitresults[2].c_str()));  // minutes
-					uint32_t diff = static_cast<uint32_t>(round(difftime(btime, n2.LastUpdate)));
-					bool bStartTime = (difftime(btime, m_StartTime) < SensorTimeOut * 60);
-					bool bSendNotification = ApplyRule(splitresults[1], (diff == SensorTimeOut * 60), (diff < SensorTimeOut * 60));
-					bool bCustomMessage = false;
-					bCustomMessage = CustomRecoveryMessage(n2.ID, custommsg, false);
-
-					if (bSendNotification && !bStartTime && (!bRecoveryMessage || n2.SendAlways))
-					{
-						if (SystemUptime() < SensorTimeOut * 60 && (!bRecoveryMessage || n2.SendAlways))
-							continue;
-						std::vector<std::vector<std::string> > result;
-						result = m_sql.safe_query("SELECT SwitchType FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-						if (result.empty())
-							continue;
-						szExtraData = "|Name=" + n2.DeviceName + "|SwitchType=" + result[0][0] + "|";
-						std::string ltype = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
-						std::string label = Notification_Type_Label(NTYPE_LASTUPDATE);
-						char szDate[50];
-						char szTmp[300];
-						struct tm ltime;
-						localtime_r(&n2.LastUpdate, &ltime);
-						sprintf(szDate, "%04d-%02d-%02d %02d:%02d:%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday,
-							ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
-						sprintf(szTmp, "Sensor %s %s: %s [%s %d %s]", n2.DeviceName.c_str(), ltype.c_str(), szDate,
-							splitresults[1].c_str(), SensorTimeOut, label.c_str());
-						msg = szTmp;
-					}
-					else if (!bSendNotification && bRecoveryMessage)
-					{
-						msg = recoverymsg;
-						std::string clearstr = "!";
-						CustomRecoveryMessage(n2.ID, clearstr, true);
-					}
-					else
-						continue;
+				_tNotificationDeviceInfo info;
+				if (!GetDeviceInfo(Idx, info))
+					continue;
+				szExtraData = "|Name=" + n2.DeviceName + "|SwitchType=" + info.SwitchType + "|";
+				std::string ltype = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
+				std::string label = Notification_Type_Label(NTYPE_LASTUPDATE);
+				char szDate[50];
+				char szTmp[300];
+				struct tm ltime;
+				localtime_r(&n2.LastUpdate, &ltime);
+				sprintf(szDate, "%04d-%02d-%02d %02d:%02d:%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday,
+					ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
+				sprintf(szTmp, "Sensor %s %s: %s [%s %d %s]", n2.DeviceName.c_str(), ltype.c_str(), szDate,
+					n2.Rule.Condition.c_str(), SensorTimeOut, label.c_str());
+				msg = szTmp;
+			}
+			else if (!bSendNotification && bRecoveryMessage)
+			{
+				msg = recoverymsg;
+				std::string clearstr = "!";
+				CustomRecoveryMessage(n2.ID, clearstr, true);
+			}
+			else
+				continue;
 
-					if (bCustomMessage && !bRecoveryMessage)
-						msg = ParseCustomMessage(custommsg, n2.DeviceName, "");
-					SendMessageEx(Idx, n2.DeviceName, n2.ActiveSystems, n2.CustomAction, msg, msg, szExtraData, n2.Priority,
-						      std::string(""), true);
-					if (!bRecoveryMessage)
-					{
-						TouchNotification(n2.ID);
-						CustomRecoveryMessage(n2.ID, msg, true);
-					}
-				}
+			if (bCustomMessage && !bRecoveryMessage)
+				msg = ParseCustomMessage(custommsg, n2.DeviceName, "");
+			SendMessageEx(Idx, n2.DeviceName, n2.ActiveSystems, n2.CustomAction, msg, msg, szExtraData, n2.Priority,
+				      std::string(""), true);
+			if (!bRecoveryMessage)
+			{
+				TouchNotification(n2.ID);
+				CustomRecoveryMessage(n2.ID, msg, true);
 			}
 		}
 	}
@@ -1365,109 +1416,96 @@ void CNotificationHelper::TouchNotification(const uint64_t ID)
 
 	//Also touch it internally
 	std::lock_guard<std::mutex> l(m_mutex);
-
-	for (auto &m : m_notifications)
-	{
-		for (auto &n : m.second)
-		{
-			if (n.ID == ID)
-			{
-				n.LastSend = atime;
-				return;
-			}
-		}
-	}
+	_tNotification *pNotification = FindNotification(ID);
+	if (pNotification != nullptr)
+		pNotification->LastSend = atime;
 }
 
 void CNotificationHelper::TouchLastUpdate(const uint64_t ID)
 {
 	time_t atime = mytime(nullptr);
 	std::lock_guard<std::mutex> l(m_mutex);
+	_tNotification *pNotification = FindNotification(ID);
+	if (pNotification != nullptr)
+		pNotification->LastUpdate = atime;
+}
 
-	for (auto &m : m_notifications)
+// Looks up a notification by its ID, m_mutex has to be locked
+_tNotification *CNotificationHelper::FindNotification(const uint64_t ID)
+{
+	auto itt = m_notification_devices.find(ID);
+	if (itt == m_notification_devices.end())
+		return nullptr;
+	auto ittDevice = m_notifications.find(itt->second);
+	if (ittDevice == m_notifications.end())
+		return nullptr;
+	for (auto &n : ittDevice->second.Notifications)
 	{
-		for (auto &n : m.second)
-		{
-			if (n.ID == ID)
-			{
-				n.LastUpdate = atime;
-				return;
-			}
-		}
+		if (n.ID == ID)
+			return &n;
 	}
+	return nullptr;
 }
 
 bool CNotificationHelper::CustomRecoveryMessage(const uint64_t ID, std::string &msg, const bool isRecovery)
 {
 	std::lock_guard<std::mutex> l(m_mutex);
+	_tNotification *pNotification = FindNotification(ID);
+	if (pNotification == nullptr)
+		return false;
+	_tNotification &n = *pNotification;
 
-	for (auto &m : m_notifications)
+	if (isRecovery && !n.Rule.Recovery)
+		return false;
+
+	std::vector<std::string> splitresults;
+	std::string szTmp;
+	StringSplit(n.CustomMessage, ";;", splitresults);
+	if (msg.empty())
 	{
-		for (auto &n : m.second)
+		if (!splitresults.empty())
 		{
-			if (n.ID == ID)
+			if (!splitresults[0].empty() && !isRecovery)
 			{
-				std::vector<std::string> splitresults;
-				if (isRecovery)
-				{
-					StringSplit(n.Params, ";", splitresults);
-					if (splitresults.size() < 4)
-						return false;
-					if (splitresults[3] != "1")
-						return false;
-				}
-
-				std::string szTmp;
-				StringSplit(n.CustomMessage, ";;", splitresults);
-				if (msg.empty())
-				{
-					if (!splitresults.empty())
-					{
-						if (!splitresults[0].empty() && !isRecovery)
-						{
-							szTmp = splitresults[0];
-							msg = szTmp;
-							return true;
-						}
-						if (splitresults.size() > 1)
-						{
-							if (!splitresults[1].empty() && isRecovery)
-							{
-								szTmp = splitresults[1];
-								msg = szTmp;
-								return true;
-							}
-						}
-					}
-					return false;
-				}
-				if (!isRecovery)
-					return false;
-
-				if (!splitresults.empty())
-				{
-					if (!splitresults[0].empty())
-						szTmp = splitresults[0];
-				}
-				if ((msg.find('!') != 0) && (msg.size() > 1))
+				szTmp = splitresults[0];
+				msg = szTmp;
+				return true;
+			}
+			if (splitresults.size() > 1)
+			{
+				if (!splitresults[1].empty() && isRecovery)
 				{
-					szTmp.append(";;[Recovered] ");
-					szTmp.append(msg);
+					szTmp = splitresults[1];
+					msg = szTmp;
+					return true;
 				}
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT ID FROM Notifications WHERE (ID=='%" PRIu64 "') AND (Params=='%q')", n.ID,
-							  n.Params.c_str());
-				if (result.empty())
-					return false;
-
-				m_sql.safe_query("UPDATE Notifications SET CustomMessage='%q' WHERE ID=='%" PRIu64 "'", szTmp.c_str(),
-						 n.ID);
-				n.CustomMessage = szTmp;
-				return true;
 			}
 		}
+		return false;
 	}
-	return false;
+	if (!isRecovery)
+		return false;
+
+	if (!splitresults.empty())
+	{
+		if (!splitresults[0].empty())
+			szTmp = splitresults[0];
+	}
+	if ((msg.find('!') != 0) && (msg.size() > 1))
+	{
+		szTmp.append(";;[Recovered] ");
+		szTmp.append(msg);
+	}
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT ID FROM Notifications WHERE (ID=='%" PRIu64 "') AND (Params=='%q')", n.ID,
+				  n.Params.c_str());
+	if (result.empty())
+		return false;
+
+	m_sql.safe_query("UPDATE Notifications SET CustomMessage='%q' WHERE ID=='%" PRIu64 "'", szTmp.c_str(),
+			 n.ID);
+	n.CustomMessage = szTmp;
+	return true;
 }
 
 bool CNotificationHelper::AddNotification(
@@ -1526,7 +1564,7 @@ std::vector<_tNotification> CNotificationHelper::GetNotifications(const uint64_t
 	auto itt = m_notifications.find(DevIdx);
 	if (itt != m_notifications.end())
 	{
-		ret = itt->second;
+		ret = itt->second.Notifications;
 	}
 	return ret;
 }
@@ -1550,6 +1588,12 @@ void CNotificationHelper::ReloadNotifications()
 {
 	std::lock_guard<std::mutex> l(m_mutex);
 	m_notifications.clear();
+	m_notification_devices.clear();
+	{
+		// everything is read again below
+		std::lock_guard<std::mutex> l2(m_stale_mutex);
+		m_stale_devices.clear();
+	}
 	std::vector<std::vector<std::string> > result;
 
 	m_sql.GetPreferencesVar("NotificationSensorInterval", m_NotificationSensorInterval);
@@ -1562,7 +1606,6 @@ void CNotificationHelper::ReloadNotifications()
 	time_t mtime = mytime(nullptr);
 	struct tm atime;
 	localtime_r(&mtime, &atime);
-	std::vector<std::string> splitresults;
 
 	std::stringstream sstr;
 
@@ -1600,9 +1643,9 @@ void CNotificationHelper::ReloadNotifications()
 			struct tm ntime;
 			ParseSQLdatetime(notification.LastSend, ntime, stime, atime.tm_isdst);
 		}
-		std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
-		StringSplit(notification.Params, ";", splitresults);
-		if (splitresults[0] == ttype) {
+		notification.Rule.Compile(notification.Params);
+		if (notification.Rule.Type == NTYPE_LASTUPDATE) {
+			std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
 			std::vector<std::vector<std::string> > result2;
 			result2 = m_sql.safe_query(
 				"SELECT B.Name, B.LastUpdate "
@@ -1621,6 +1664,16 @@ void CNotificationHelper::ReloadNotifications()
 				ParseSQLdatetime(notification.LastUpdate, ntime, stime, atime.tm_isdst);
 			}
 		}
-		m_notifications[Idx].push_back(notification);
+		m_notification_devices[notification.ID] = Idx;
+		m_notifications[Idx].Notifications.push_back(notification);
+	}
+
+	// The device columns the messages need, so checking a notification does not have to query them
+	result = m_sql.safe_query("SELECT ID, SwitchType, CustomImage, Options, AddjMulti FROM DeviceStatus WHERE ID IN (SELECT DeviceRowID FROM Notifications)");
+	for (const auto &sd : result)
+	{
+		auto itt = m_notifications.find(std::stoull(sd[0]));
+		if (itt != m_notifications.end())
+			LoadDeviceInfo(sd, itt->second.Info);
 	}
 }
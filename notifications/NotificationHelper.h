@@ -3,21 +3,59 @@
 #include "../webserver/cWebem.h"
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #define NOTIFYALL std::string("")
 
+enum class _eNotificationCondition : uint8_t
+{
+	None = 0,
+	Greater,
+	GreaterEqual,
+	Equal,
+	NotEqual,
+	LessEqual,
+	Less
+};
+
+// Notification Params ("T;>;25;1") compiled once when the notifications are (re)loaded
+struct _tNotificationRule
+{
+	int Type = -1;	       // _eNotificationTypes of the type sign in the first field, -1 when unknown
+	std::string Condition; // second field as configured (">", ">=", "=", "!=", "<=", "<"), the limit for value notifications
+	_eNotificationCondition Compare = _eNotificationCondition::None;
+	float Value = 0.0F;    // third field, the threshold
+	bool Recovery = false; // fourth field, also send a message when the condition is no longer met
+	size_t Fields = 0;
+
+	void Compile(const std::string &Params);
+	bool Apply(bool equal, bool less) const;
+};
+
 struct _tNotification
 {
 	uint64_t ID;
 	std::string Params;
 	int Priority;
 	time_t LastSend;
-	time_t LastUpdate;
+	time_t LastUpdate = 0;
 	std::string DeviceName;
 	std::string CustomMessage;
 	std::string CustomAction;
 	std::string ActiveSystems;
 	bool SendAlways;
+	_tNotificationRule Rule;
+};
+
+// DeviceStatus columns used in the notification messages, cached for the devices that have notifications
+struct _tNotificationDeviceInfo
+{
+	bool bExists = false;
+	std::string SwitchType;
+	std::string CustomImage;
+	std::string Options;
+	double AddjMulti = 1.0;
 };
 
 class CNotificationHelper
@@ -47,6 +85,9 @@ class CNotificationHelper
 	bool CustomRecoveryMessage(uint64_t ID, std::string &msg, bool isRecovery);
 	bool HasNotifications(uint64_t DevIdx);
 	bool HasNotifications(const std::string &DevIdx);
+	// Called from the database update hook for DeviceStatus rows changed outside the value updates,
+	// the cached device columns are reloaded on next use (does not query, safe to call while the database is locked)
+	void InvalidateDeviceInfo(uint64_t DevIdx);
 
 	bool CheckAndHandleNotification(uint64_t DevRowIdx, int HardwareID, const std::string &ID, const std::string &sName, unsigned char unit, unsigned char cType, unsigned char cSubType,
 					int nValue);
@@ -81,9 +122,26 @@ class CNotificationHelper
 	bool CheckAndHandleAmpere123Notification(uint64_t Idx, const std::string &DeviceName, float Ampere1, float Ampere2, float Ampere3);
 
 	std::string ParseCustomMessage(const std::string &cMessage, const std::string &sName, const std::string &sValue);
-	bool ApplyRule(const std::string &rule, bool equal, bool less);
+	bool GetDeviceNotifications(uint64_t DevIdx, std::initializer_list<_eNotificationTypes> ntypes, bool bTouchLastUpdate, std::vector<_tNotification> &notifications, _tNotificationDeviceInfo *pInfo);
+	bool GetDeviceInfo(uint64_t DevIdx, _tNotificationDeviceInfo &info);
+	void ReloadDeviceInfo(uint64_t DevIdx);
+	void ReloadStaleDeviceInfo(uint64_t DevIdx);
+	bool GetRainDayMinimum(uint64_t DevIdx, const std::string &szDate, float mvalue, float &total_min);
+	void LoadDeviceInfo(const std::vector<std::string> &sd, _tNotificationDeviceInfo &info);
+	_tNotification *FindNotification(uint64_t ID);
+
+	struct _tDeviceNotifications
+	{
+		std::vector<_tNotification> Notifications;
+		_tNotificationDeviceInfo Info;
+		std::string RainDate; // day of RainDayMinimum
+		float RainDayMinimum = 0.0F;
+	};
 	std::mutex m_mutex;
-	std::map<uint64_t, std::vector<_tNotification>> m_notifications;
+	std::unordered_map<uint64_t, _tDeviceNotifications> m_notifications;
+	std::unordered_map<uint64_t, uint64_t> m_notification_devices; // notification ID -> device row ID
+	std::mutex m_stale_mutex; // never held while querying, the database update hook takes it
+	std::unordered_set<uint64_t> m_stale_devices; // devices whose cached columns have to be reloaded
 	int m_NotificationSensorInterval;
 	int m_NotificationSwitchInterval;
 };
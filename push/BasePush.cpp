@@ -3,6 +3,7 @@
 #include "../hardware/hardwaretypes.h"
 #include <json/json.h>
 #include "../main/Helper.h"
+#include "../main/localtime_r.h"
 #include "../main/Logger.h"
 #include "../main/RFXtrx.h"
 #include "../main/SQLHelper.h"
@@ -12,6 +13,9 @@
 #include <inttypes.h>
 #include <boost/date_time/c_local_time_adjustor.hpp>
 
+// maximum number of devices waiting to be pushed, further updates are dropped
+#define PUSH_QUEUE_MAX_ITEMS 1000
+
 typedef struct _STR_TABLE_ID1_ID2 {
 	unsigned long    id1;
 	unsigned long    id2;
@@ -901,7 +905,8 @@ void CBasePush::ReloadPushLinks(const PushType PType)
 	std::lock_guard<std::mutex> l(m_link_mutex);
 	m_pushlinks.clear();
 	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Name, B.Type, B.SubType, B.SwitchType "
+	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Name, B.Type, B.SubType, B.SwitchType, "
+		"A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, A.IncludeUnit "
 		"FROM PushLink as A, DeviceStatus as B "
 		"WHERE (A.PushType==%d AND A.Enabled==1 AND A.DeviceRowID == B.ID)",
 		PType);
@@ -914,6 +919,12 @@ void CBasePush::ReloadPushLinks(const PushType PType)
 		tlink.devType = std::stoi(sd[4]);
 		tlink.devSubType = std::stoi(sd[5]);
 		tlink.metertype = std::stoi(sd[6]);
+		tlink.pushType = PType;
+		tlink.TargetType = atoi(sd[7].c_str());
+		tlink.TargetVariable = sd[8];
+		tlink.TargetDeviceID = atoi(sd[9].c_str());
+		tlink.TargetProperty = sd[10];
+		tlink.IncludeUnit = atoi(sd[11].c_str());
 		m_pushlinks.push_back(tlink);
 	}
 }
@@ -924,6 +935,20 @@ bool CBasePush::IsLinkInDatabase(const uint64_t DeviceRowIdx)
 	return std::any_of(m_pushlinks.begin(), m_pushlinks.end(), [&](const _tPushLinks& val) { return DeviceRowIdx == val.DeviceRowIdx; });
 }
 
+void CBasePush::RegisterPreferencesCallback(const std::string& KeyPrefix, const std::function<void()>& reload)
+{
+	UnregisterPreferencesCallback();
+	m_PreferencesCallbackID = m_sql.RegisterPreferencesCallback(KeyPrefix, [reload](const std::string& /*Key*/) { reload(); });
+}
+
+void CBasePush::UnregisterPreferencesCallback()
+{
+	if (m_PreferencesCallbackID == 0)
+		return;
+	m_sql.UnregisterPreferencesCallback(m_PreferencesCallbackID);
+	m_PreferencesCallbackID = 0;
+}
+
 bool CBasePush::GetPushLink(const uint64_t DeviceRowIdx, _tPushLinks& plink)
 {
 	std::lock_guard<std::mutex> l(m_link_mutex);
@@ -938,6 +963,64 @@ bool CBasePush::GetPushLink(const uint64_t DeviceRowIdx, _tPushLinks& plink)
 	return false;
 }
 
+bool CBasePush::GetPushLinks(const uint64_t DeviceRowIdx, std::vector<_tPushLinks>& plinks)
+{
+	plinks.clear();
+	std::lock_guard<std::mutex> l(m_link_mutex);
+	std::copy_if(m_pushlinks.begin(), m_pushlinks.end(), std::back_inserter(plinks), [&](const _tPushLinks& val) { return DeviceRowIdx == val.DeviceRowIdx; });
+	return !plinks.empty();
+}
+
+bool CBasePush::QueueDeviceUpdate(const uint64_t DeviceRowIdx)
+{
+	_tQueuedDeviceUpdate update;
+	update.DeviceRowIdx = DeviceRowIdx;
+	update.bHaveState = false;
+	update.nValue = 0;
+	update.lastUpdate = 0;
+
+	// The worker reads the device when it pushes it, a switch could have been toggled back by then.
+	// This runs on the RX signal path, so the state comes from the device cache and the push links are left to the worker
+	unsigned char devType = 0;
+	unsigned char subType = 0;
+	int nValue = 0;
+	std::string sValue, sLastUpdate;
+	if ((m_sql.GetCachedDeviceState(DeviceRowIdx, devType, subType, nValue, sValue, sLastUpdate)) && (IsLightOrSwitch(devType, subType)))
+	{
+		time_t tLastUpdate;
+		struct tm ntime;
+		if (ParseSQLdatetime(tLastUpdate, ntime, sLastUpdate))
+		{
+			update.bHaveState = true;
+			update.nValue = nValue;
+			update.sValue = sValue;
+			update.lastUpdate = tLastUpdate + get_tzoffset();
+		}
+	}
+
+	std::lock_guard<std::mutex> l(m_queue_mutex);
+	if ((!update.bHaveState) && (m_queued.find(DeviceRowIdx) != m_queued.end()))
+		return true; // already waiting, it will be pushed with its latest state
+	if (m_queue.size() >= PUSH_QUEUE_MAX_ITEMS)
+	{
+		m_queue_dropped++;
+		return false;
+	}
+	m_queue.push_back(update);
+	if (!update.bHaveState)
+		m_queued.insert(DeviceRowIdx);
+	return true;
+}
+
+void CBasePush::GetQueuedDeviceUpdates(std::vector<_tQueuedDeviceUpdate>& devices, uint64_t& dropped)
+{
+	devices.clear();
+	std::lock_guard<std::mutex> l(m_queue_mutex);
+	devices.swap(m_queue);
+	m_queued.clear();
+	dropped = m_queue_dropped;
+	m_queue_dropped = 0;
+}
 
 
 //Webserver helpers
@@ -4,6 +4,7 @@
 #include <boost/signals2.hpp>
 #include "../main/StoppableTask.h"
 #include <mutex>
+#include <set>
 
 class CBasePush : public StoppableTask
 {
@@ -26,6 +27,11 @@ public:
 		int devSubType;
 		int metertype;
 		PushType pushType;
+		int TargetType;
+		std::string TargetVariable;
+		int TargetDeviceID;
+		std::string TargetProperty;
+		int IncludeUnit;
 	};
 
 	CBasePush();
@@ -36,6 +42,7 @@ public:
 
 	void ReloadPushLinks(const PushType PType);
 	bool GetPushLink(const uint64_t DeviceRowIdx, _tPushLinks& plink);
+	bool GetPushLinks(const uint64_t DeviceRowIdx, std::vector<_tPushLinks>& plinks);
 
 protected:
 	PushType m_PushType;
@@ -44,6 +51,7 @@ protected:
 	boost::signals2::connection m_sDeviceUpdate;
 	boost::signals2::connection m_sNotification;
 	boost::signals2::connection m_sSceneChanged;
+	int m_PreferencesCallbackID = 0;
 
 	static std::string getUnit(const int devType, const int devSubType, const int delpos, const int metertypein);
 
@@ -54,9 +62,32 @@ protected:
 
 	bool IsLinkInDatabase(const uint64_t DeviceRowIdx);
 
+	// Reload the settings of this link when one of its preferences (Key starts with KeyPrefix) changes
+	void RegisterPreferencesCallback(const std::string& KeyPrefix, const std::function<void()>& reload);
+	void UnregisterPreferencesCallback();
+
+	struct _tQueuedDeviceUpdate
+	{
+		uint64_t DeviceRowIdx;
+		bool bHaveState; // switches: the state at the time of the update, otherwise the current state is pushed
+		int nValue;
+		std::string sValue;
+		time_t lastUpdate; // local time as seconds since the epoch, like strftime('%s', LastUpdate)
+	};
+
+	// Queue of devices with a pending push. Repeated updates of a device are coalesced into one entry,
+	// except for switches where every state change (on/off/on) is queued with its own state
+	bool QueueDeviceUpdate(const uint64_t DeviceRowIdx);
+	void GetQueuedDeviceUpdates(std::vector<_tQueuedDeviceUpdate>& devices, uint64_t& dropped);
+
 	std::mutex m_link_mutex;
 
 private:
 	std::vector<_tPushLinks> m_pushlinks;
+
+	std::mutex m_queue_mutex;
+	std::vector<_tQueuedDeviceUpdate> m_queue;
+	std::set<uint64_t> m_queued;
+	uint64_t m_queue_dropped = 0;
 };
 
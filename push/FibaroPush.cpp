@@ -24,19 +24,51 @@ CFibaroPush::CFibaroPush()
 
 void CFibaroPush::Start()
 {
+	Stop();
+
+	RequestStart();
+
 	UpdateActive();
 	ReloadPushLinks(m_PushType);
+	RegisterPreferencesCallback("Fibaro", [this] { UpdateActive(); });
+
+	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
+	SetThreadName(m_thread->native_handle(), "FibaroPush");
+
 	m_sConnection = m_mainworker.sOnDeviceReceived.connect([this](auto id, auto idx, const auto &name, auto rx) { OnDeviceReceived(id, idx, name, rx); });
 }
 
 void CFibaroPush::Stop()
 {
+	UnregisterPreferencesCallback();
 	if (m_sConnection.connected())
 		m_sConnection.disconnect();
+
+	if (m_thread)
+	{
+		RequestStop();
+		m_thread->join();
+		m_thread.reset();
+	}
 }
 
 void CFibaroPush::UpdateActive()
 {
+	_tFibaroSettings settings;
+	int iValue = 0;
+	m_sql.GetPreferencesVar("FibaroIP", settings.szIP);
+	m_sql.GetPreferencesVar("FibaroUsername", settings.szUsername);
+	m_sql.GetPreferencesVar("FibaroPassword", settings.szPassword);
+	if (m_sql.GetPreferencesVar("FibaroVersion4", iValue))
+		settings.bIsV4 = (iValue != 0);
+	iValue = 0;
+	if (m_sql.GetPreferencesVar("FibaroDebug", iValue))
+		settings.bDebug = (iValue == 1);
+	{
+		std::lock_guard<std::mutex> l(m_settings_mutex);
+		m_settings = settings;
+	}
+
 	int fActive = 0;
 	m_sql.GetPreferencesVar("FibaroActive", fActive);
 	m_bLinkActive = (fActive == 1);
@@ -44,56 +76,78 @@ void CFibaroPush::UpdateActive()
 
 void CFibaroPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
 {
-	if (m_bLinkActive)
+	if (!m_bLinkActive)
+		return;
+	if (!IsLinkInDatabase(DeviceRowIdx))
+		return;
+	QueueDeviceUpdate(DeviceRowIdx);
+}
+
+void CFibaroPush::Do_Work()
+{
+	std::vector<_tQueuedDeviceUpdate> devices;
+	uint64_t dropped = 0;
+
+	while (!IsStopRequested(100))
 	{
-		DoFibaroPush(DeviceRowIdx);
+		GetQueuedDeviceUpdates(devices, dropped);
+		if (dropped != 0)
+		{
+			_log.Log(LOG_ERROR, "FibaroLink: Push queue full, %" PRIu64 " device update(s) dropped!", dropped);
+		}
+		if (devices.empty())
+			continue;
+
+		_tFibaroSettings settings;
+		{
+			std::lock_guard<std::mutex> l(m_settings_mutex);
+			settings = m_settings;
+		}
+		if ((settings.szIP.empty()) || (settings.szUsername.empty()) || (settings.szPassword.empty()))
+			continue;
+
+		for (const auto &update : devices)
+		{
+			if (IsStopRequested(0))
+				break;
+			DoFibaroPush(update, settings);
+		}
 	}
 }
 
-void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
+void CFibaroPush::DoFibaroPush(const _tQueuedDeviceUpdate &update, const _tFibaroSettings &settings)
 {
+	const uint64_t DeviceRowIdx = update.DeviceRowIdx;
+	std::vector<_tPushLinks> links;
+	if (!GetPushLinks(DeviceRowIdx, links))
+		return;
+
 	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, "
-				  "A.IncludeUnit, B.SwitchType FROM PushLink as A, DeviceStatus as B "
-				  "WHERE (A.PushType==%d AND A.DeviceRowID == '%" PRIu64 "' AND A.Enabled = '1' AND A.DeviceRowID==B.ID)",
-				  PushType::PUSHTYPE_FIBARO, DeviceRowIdx);
+	result = m_sql.safe_query("SELECT Type, SubType, nValue, sValue, SwitchType FROM DeviceStatus WHERE (ID == %" PRIu64 ")", DeviceRowIdx);
 	if (result.empty())
 		return;
+	const auto &sd = result[0];
 
-	std::string fibaroIP;
-	std::string fibaroUsername;
-	std::string fibaroPassword;
-	int iIsVersion4 = 0;
-	m_sql.GetPreferencesVar("FibaroIP", fibaroIP);
-	m_sql.GetPreferencesVar("FibaroUsername", fibaroUsername);
-	m_sql.GetPreferencesVar("FibaroPassword", fibaroPassword);
-	m_sql.GetPreferencesVar("FibaroVersion4", iIsVersion4);
-
-
-	int fibaroDebugActiveInt = 0;
-	bool fibaroDebugActive = false;
-	m_sql.GetPreferencesVar("FibaroDebug", fibaroDebugActiveInt);
-	if (fibaroDebugActiveInt == 1) {
-		fibaroDebugActive = true;
+	int dType = atoi(sd[0].c_str());
+	int dSubType = atoi(sd[1].c_str());
+	int nValue = atoi(sd[2].c_str());
+	std::string sValue = sd[3];
+	int metertype = atoi(sd[4].c_str());
+	if (update.bHaveState)
+	{
+		nValue = update.nValue;
+		sValue = update.sValue;
 	}
-	bool bIsV4 = (iIsVersion4 != 0);
 
-	if ((fibaroIP.empty()) || (fibaroUsername.empty()) || (fibaroPassword.empty()))
-		return;
-	for (const auto &sd : result)
+	for (const auto &link : links)
 	{
 		std::string sendValue;
-		int delpos = atoi(sd[1].c_str());
-		int dType = atoi(sd[3].c_str());
-		int dSubType = atoi(sd[4].c_str());
-		int nValue = atoi(sd[5].c_str());
-		std::string sValue = sd[6];
-		int targetType = atoi(sd[7].c_str());
-		std::string targetVariable = sd[8];
-		int targetDeviceID = atoi(sd[9].c_str());
-		std::string targetProperty = sd[10];
-		int includeUnit = atoi(sd[11].c_str());
-		int metertype = atoi(sd[12].c_str());
+		int delpos = link.DelimiterPos;
+		int targetType = link.TargetType;
+		std::string targetVariable = link.TargetVariable;
+		int targetDeviceID = link.TargetDeviceID;
+		std::string targetProperty = link.TargetProperty;
+		int includeUnit = link.IncludeUnit;
 		std::string lstatus;
 
 		if ((targetType == 0) || (targetType == 1)) {
@@ -138,35 +192,35 @@ void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
 
 		Url << "http://";
 
-		if (bIsV4) {
+		if (settings.bIsV4) {
 			// Create basic authentication header
 			std::stringstream sstr;
-			sstr << fibaroUsername << ":" << fibaroPassword;
+			sstr << settings.szUsername << ":" << settings.szPassword;
 			std::string m_AccessToken = base64_encode(sstr.str());
 			ExtraHeaders.push_back("Authorization:Basic " + m_AccessToken);
 		}
 		else {
-			Url << fibaroUsername << ":" << fibaroPassword << "@"; // Add user name in url for earlier than V4
+			Url << settings.szUsername << ":" << settings.szPassword << "@"; // Add user name in url for earlier than V4
 		}
 
-		Url << fibaroIP << "/";
+		Url << settings.szIP << "/";
 
 		sendValue = CURLEncode::URLEncode(sendValue);
 
 		if (targetType == 0) {
 			Url << "api/globalVariables";
 
-			if (bIsV4)
+			if (settings.bIsV4)
 				Url << "/" << targetVariable;
 
 			sPostData << R"({"name": ")" << targetVariable << R"(", "value": ")" << sendValue << "\"";
 
-			if (bIsV4)
+			if (settings.bIsV4)
 				sPostData << ", \"invokeScenes\": true";
 
 			sPostData << " }";
 
-			if (fibaroDebugActive) {
+			if (settings.bDebug) {
 				_log.Log(LOG_NORM, "FibaroLink: sending global variable %s with value: %s", targetVariable.c_str(), sendValue.c_str());
 			}
 			if (!HTTPClient::PUT(Url.str(), sPostData.str(), ExtraHeaders, sResult))
@@ -177,7 +231,7 @@ void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
 		}
 		else if (targetType == 1) {
 			Url << "api/callAction?deviceid=" << targetDeviceID << "&name=setProperty&arg1=" << targetProperty << "&arg2=" << sendValue;
-			if (fibaroDebugActive) {
+			if (settings.bDebug) {
 				_log.Log(LOG_NORM, "FibaroLink: sending value %s to property %s of virtual device id %d", sendValue.c_str(), targetProperty.c_str(), targetDeviceID);
 			}
 			if (!HTTPClient::GET(Url.str(), ExtraHeaders, sResult))
@@ -188,7 +242,7 @@ void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
 		else if (targetType == 2) {
 			if (((delpos == 0) && (lstatus == "Off")) || ((delpos == 1) && (lstatus == "On"))) {
 				Url << "api/sceneControl?id=" << targetDeviceID << "&action=start";
-				if (fibaroDebugActive) {
+				if (settings.bDebug) {
 					_log.Log(LOG_NORM, "FibaroLink: activating scene %d", targetDeviceID);
 				}
 				if (!HTTPClient::GET(Url.str(), ExtraHeaders, sResult))
@@ -200,7 +254,7 @@ void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
 		else if (targetType == 3) {
 			if (((delpos == 0) && (lstatus == "Off")) || ((delpos == 1) && (lstatus == "On"))) {
 				Url << "api/settings/reboot";
-				if (fibaroDebugActive) {
+				if (settings.bDebug) {
 					_log.Log(LOG_NORM, "FibaroLink: reboot");
 				}
 				if (!HTTPClient::POST(Url.str(), sPostData.str(), ExtraHeaders, sResult))
@@ -240,7 +294,6 @@ namespace http {
 			m_sql.UpdatePreferencesVar("FibaroActive", ilinkactive);
 			m_sql.UpdatePreferencesVar("FibaroVersion4", iisversion4);
 			m_sql.UpdatePreferencesVar("FibaroDebug", idebugenabled);
-			m_fibaropush.UpdateActive();
 			root["status"] = "OK";
 			root["title"] = "SaveFibaroLinkConfig";
 		}
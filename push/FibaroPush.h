@@ -11,7 +11,20 @@ public:
 	void UpdateActive();
 
 private:
+  struct _tFibaroSettings
+  {
+	  std::string szIP;
+	  std::string szUsername;
+	  std::string szPassword;
+	  bool bIsV4 = false;
+	  bool bDebug = false;
+  };
   void OnDeviceReceived(int m_HwdID, uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
-  void DoFibaroPush(const uint64_t DeviceRowIdx);
+  void Do_Work();
+  void DoFibaroPush(const _tQueuedDeviceUpdate &update, const _tFibaroSettings &settings);
+
+  std::shared_ptr<std::thread> m_thread;
+  std::mutex m_settings_mutex;
+  _tFibaroSettings m_settings;
 };
 extern CFibaroPush m_fibaropush;
@@ -41,11 +41,13 @@ void CGooglePubSubPush::Start()
 {
 	UpdateActive();
 	ReloadPushLinks(m_PushType);
+	RegisterPreferencesCallback("GooglePubSub", [this] { UpdateActive(); });
 	m_sConnection = m_mainworker.sOnDeviceReceived.connect([this](auto id, auto idx, const auto &name, auto rx) { OnDeviceReceived(id, idx, name, rx); });
 }
 
 void CGooglePubSubPush::Stop()
 {
+	UnregisterPreferencesCallback();
 	if (m_sConnection.connected())
 		m_sConnection.disconnect();
 }
@@ -314,7 +316,6 @@ namespace http {
 			m_sql.UpdatePreferencesVar("GooglePubSubActive", ilinkactive);
 			m_sql.UpdatePreferencesVar("GooglePubSubDebug", idebugenabled);
 
-			m_googlepubsubpush.UpdateActive();
 			root["status"] = "OK";
 			root["title"] = "SaveGooglePubSubLinkConfig";
 		}
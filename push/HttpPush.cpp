@@ -25,20 +25,56 @@ CHttpPush::CHttpPush()
 
 void CHttpPush::Start()
 {
+	Stop();
+
+	RequestStart();
+
 	UpdateActive();
 	ReloadPushLinks(m_PushType);
+	RegisterPreferencesCallback("Http", [this] { UpdateActive(); });
+
+	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
+	SetThreadName(m_thread->native_handle(), "HttpPush");
+
 	m_sConnection = m_mainworker.sOnDeviceReceived.connect([this](auto id, auto idx, const auto &name, auto rx) { OnDeviceReceived(id, idx, name, rx); });
 }
 
 void CHttpPush::Stop()
 {
+	UnregisterPreferencesCallback();
 	if (m_sConnection.connected())
 		m_sConnection.disconnect();
+
+	if (m_thread)
+	{
+		RequestStop();
+		m_thread->join();
+		m_thread.reset();
+	}
 }
 
 
 void CHttpPush::UpdateActive()
 {
+	_tHttpSettings settings;
+	int iValue = 0;
+	m_sql.GetPreferencesVar("HttpUrl", settings.szUrl);
+	m_sql.GetPreferencesVar("HttpData", settings.szData);
+	m_sql.GetPreferencesVar("HttpHeaders", settings.szHeaders);
+	m_sql.GetPreferencesVar("HttpMethod", settings.iMethod);
+	m_sql.GetPreferencesVar("HttpAuth", settings.iAuth);
+	m_sql.GetPreferencesVar("HttpAuthBasicLogin", settings.szAuthBasicLogin);
+	m_sql.GetPreferencesVar("HttpAuthBasicPassword", settings.szAuthBasicPassword);
+	if (m_sql.GetPreferencesVar("HttpDebug", iValue))
+		settings.bDebug = (iValue == 1);
+	iValue = 0;
+	if (m_sql.GetPreferencesVar("HttpBatch", iValue))
+		settings.bBatch = (iValue == 1);
+	{
+		std::lock_guard<std::mutex> l(m_settings_mutex);
+		m_settings = settings;
+	}
+
 	int fActive = 0;
 	m_sql.GetPreferencesVar("HttpActive", fActive);
 	m_bLinkActive = (fActive == 1);
@@ -46,85 +82,113 @@ void CHttpPush::UpdateActive()
 
 void CHttpPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
 {
-	if (m_bLinkActive)
+	if (!m_bLinkActive)
+		return;
+	if (!IsLinkInDatabase(DeviceRowIdx))
+		return;
+	QueueDeviceUpdate(DeviceRowIdx);
+}
+
+void CHttpPush::Do_Work()
+{
+	std::vector<_tQueuedDeviceUpdate> devices;
+	uint64_t dropped = 0;
+
+	while (!IsStopRequested(100))
 	{
-		DoHttpPush(DeviceRowIdx);
+		GetQueuedDeviceUpdates(devices, dropped);
+		if (dropped != 0)
+		{
+			_log.Log(LOG_ERROR, "HttpLink: Push queue full, %" PRIu64 " device update(s) dropped!", dropped);
+		}
+		if (devices.empty())
+			continue;
+
+		_tHttpSettings settings;
+		{
+			std::lock_guard<std::mutex> l(m_settings_mutex);
+			settings = m_settings;
+		}
+		if (settings.szUrl.empty())
+			continue;
+
+		// POST/PUT data for the same url is collected and send in one request when batching is enabled
+		std::map<std::string, std::string> batches;
+		for (const auto &update : devices)
+		{
+			if (IsStopRequested(0))
+				break;
+			DoHttpPush(update, settings, batches);
+		}
+		for (const auto &itt : batches)
+		{
+			SendHttpPush(settings, itt.first, itt.second);
+		}
 	}
 }
 
-void CHttpPush::DoHttpPush(const uint64_t DeviceRowIdx)
+void CHttpPush::DoHttpPush(const _tQueuedDeviceUpdate &update, const _tHttpSettings &settings, std::map<std::string, std::string> &batches)
 {
+	const uint64_t DeviceRowIdx = update.DeviceRowIdx;
+	std::vector<_tPushLinks> links;
+	if (!GetPushLinks(DeviceRowIdx, links))
+		return;
+
 	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, "
-				  "A.IncludeUnit, B.SwitchType, strftime('%%s', B.LastUpdate), B.Name FROM PushLink as A, DeviceStatus as B "
-				  "WHERE (A.PushType==%d AND A.DeviceRowID == '%" PRIu64 "' AND A.Enabled = '1' AND A.DeviceRowID==B.ID)",
-				  PushType::PUSHTYPE_HTTP, DeviceRowIdx);
+	result = m_sql.safe_query("SELECT Type, SubType, nValue, sValue, SwitchType, strftime('%%s', LastUpdate), Name FROM DeviceStatus WHERE (ID == %" PRIu64 ")", DeviceRowIdx);
 	if (result.empty())
 		return;
-
-	std::string httpUrl;
-	std::string httpData;
-	std::string httpHeaders;
-	int httpMethodInt = 0;
-	int httpAuthInt = 0;
-	std::string httpAuthBasicLogin;
-	std::string httpAuthBasicPassword;
-	m_sql.GetPreferencesVar("HttpMethod", httpMethodInt);
-	m_sql.GetPreferencesVar("HttpAuth", httpAuthInt);
-	m_sql.GetPreferencesVar("HttpAuthBasicLogin", httpAuthBasicLogin);
-	m_sql.GetPreferencesVar("HttpAuthBasicPassword", httpAuthBasicPassword);
-
-	int httpDebugActiveInt = 0;
-	bool httpDebugActive = false;
-	m_sql.GetPreferencesVar("HttpDebug", httpDebugActiveInt);
-	if (httpDebugActiveInt == 1) {
-		httpDebugActive = true;
+	const auto &sd = result[0];
+
+	std::string sdeviceId = std::to_string(DeviceRowIdx);
+	int dType = atoi(sd[0].c_str());
+	int dSubType = atoi(sd[1].c_str());
+	int nValue = atoi(sd[2].c_str());
+	std::string sValue = sd[3];
+	int metertype = atoi(sd[4].c_str());
+	int lastUpdate = atoi(sd[5].c_str());
+	std::string lname = sd[6];
+	if (update.bHaveState)
+	{
+		nValue = update.nValue;
+		sValue = update.sValue;
+		lastUpdate = (int)update.lastUpdate;
 	}
 
-	for (const auto &sd : result)
+	unsigned long tzoffset = get_tzoffset();
+
+	uint64_t localTime = lastUpdate;
+	uint64_t localTimeUtc = lastUpdate - tzoffset;
+
+	char szLocalTime[21];
+	sprintf(szLocalTime, "%" PRIu64, localTime);
+	char szLocalTimeUtc[21];
+	sprintf(szLocalTimeUtc, "%" PRIu64, localTimeUtc);
+	char szLocalTimeMs[21];
+	sprintf(szLocalTimeMs, "%" PRIu64, localTime * 1000);
+	char szLocalTimeUtcMs[21];
+	sprintf(szLocalTimeUtcMs, "%" PRIu64, localTimeUtc * 1000);
+
+	std::string llastUpdate = get_lastUpdate(localTimeUtc);
+
+	std::string lType = RFX_Type_Desc(dType, 1);
+	std::string lSubType = RFX_Type_SubType_Desc(dType, dSubType);
+
+	char hostname[256];
+	gethostname(hostname, sizeof(hostname));
+
+	for (const auto &link : links)
 	{
-		std::string sendValue;
-		m_sql.GetPreferencesVar("HttpUrl", httpUrl);
-		m_sql.GetPreferencesVar("HttpData", httpData);
-		m_sql.GetPreferencesVar("HttpHeaders", httpHeaders);
-		if (httpUrl.empty())
-			return;
-
-		//unsigned int deviceId = atoi(sd[0].c_str());
-		std::string sdeviceId = sd[0];
-		std::string ldelpos = sd[1];
-		int delpos = atoi(sd[1].c_str());
-		int dType = atoi(sd[3].c_str());
-		int dSubType = atoi(sd[4].c_str());
-		int nValue = atoi(sd[5].c_str());
-		std::string sValue = sd[6];
-		//int targetType = atoi(sd[7].c_str());
-		std::string targetVariable = sd[8];
-		//int targetDeviceID = atoi(sd[9].c_str());
-		//std::string targetProperty = sd[10].c_str();
-		int includeUnit = atoi(sd[11].c_str());
-		int metertype = atoi(sd[12].c_str());
-		int lastUpdate = atoi(sd[13].c_str());
-		std::string ltargetVariable = sd[8];
-		std::string ltargetDeviceId = sd[9];
-		std::string lname = sd[14];
-		sendValue = sValue;
-
-		unsigned long tzoffset = get_tzoffset();
-
-		uint64_t localTime = lastUpdate;
-		uint64_t localTimeUtc = lastUpdate - tzoffset;
-
-		char szLocalTime[21];
-		sprintf(szLocalTime, "%" PRIu64, localTime);
-		char szLocalTimeUtc[21];
-		sprintf(szLocalTimeUtc, "%" PRIu64, localTimeUtc);
-		char szLocalTimeMs[21];
-		sprintf(szLocalTimeMs, "%" PRIu64, localTime * 1000);
-		char szLocalTimeUtcMs[21];
-		sprintf(szLocalTimeUtcMs, "%" PRIu64, localTimeUtc * 1000);
-
-		std::string llastUpdate = get_lastUpdate(localTimeUtc);
+		std::string httpUrl = settings.szUrl;
+		std::string httpData = settings.szData;
+		std::string sendValue = sValue;
+
+		int delpos = link.DelimiterPos;
+		std::string ldelpos = std::to_string(delpos);
+		std::string targetVariable = link.TargetVariable;
+		int includeUnit = link.IncludeUnit;
+		std::string ltargetVariable = link.TargetVariable;
+		std::string ltargetDeviceId = std::to_string(link.TargetDeviceID);
 
 		// Replace keywords
 		/*
@@ -145,11 +209,6 @@ void CHttpPush::DoHttpPush(const uint64_t DeviceRowIdx)
 		*/
 
 		std::string lunit = getUnit(dType, dSubType, delpos, metertype);
-		std::string lType = RFX_Type_Desc(dType, 1);
-		std::string lSubType = RFX_Type_SubType_Desc(dType, dSubType);
-
-		char hostname[256];
-		gethostname(hostname, sizeof(hostname));
 
 		std::vector<std::string> strarray;
 		if (sendValue.find(';') != std::string::npos)
@@ -201,52 +260,66 @@ void CHttpPush::DoHttpPush(const uint64_t DeviceRowIdx)
 		replaceAll(httpData, "%h", std::string(hostname));
 		replaceAll(httpData, "%idx", sdeviceId);
 
-		std::string sResult;
-		std::vector<std::string> ExtraHeaders;
-		if (httpAuthInt == 1) {			// BASIC authentication
-			std::stringstream sstr;
-			sstr << httpAuthBasicLogin << ":" << httpAuthBasicPassword;
-			std::string m_AccessToken = base64_encode(sstr.str());
-			ExtraHeaders.push_back("Authorization:Basic " + m_AccessToken);
-		}
 		sendValue = CURLEncode::URLEncode(sendValue);
 
 		// data
-		if (httpDebugActive) {
+		if (settings.bDebug) {
 			_log.Log(LOG_NORM, "HttpLink: sending global variable %s with value: %s", targetVariable.c_str(), sendValue.c_str());
 		}
 
-		if (httpMethodInt == 0) {			// GET
-			if (!HTTPClient::GET(httpUrl, ExtraHeaders, sResult, true))
-			{
-				_log.Log(LOG_ERROR, "HttpLink: Error sending data to http with GET!");
-			}
+		if ((settings.bBatch) && ((settings.iMethod == 1) || (settings.iMethod == 2)))
+		{
+			std::string &batch = batches[httpUrl];
+			if (!batch.empty())
+				batch += '\n';
+			batch += httpData;
+			continue;
 		}
-		else if (httpMethodInt == 1) {		// POST
-			if (!httpHeaders.empty())
-			{
-				// Add additional headers
-				std::vector<std::string> ExtraHeaders2;
-				StringSplit(httpHeaders, "\r\n", ExtraHeaders2);
-				std::copy(ExtraHeaders2.begin(), ExtraHeaders2.end(), std::back_inserter(ExtraHeaders));
-			}
-			if (!HTTPClient::POST(httpUrl, httpData, ExtraHeaders, sResult, true, true))
-			{
-				_log.Log(LOG_ERROR, "HttpLink: Error sending data to http with POST!");
-			}
+		SendHttpPush(settings, httpUrl, httpData);
+	}
+}
+
+void CHttpPush::SendHttpPush(const _tHttpSettings &settings, const std::string &httpUrl, const std::string &httpData)
+{
+	std::string sResult;
+	std::vector<std::string> ExtraHeaders;
+	if (settings.iAuth == 1) {			// BASIC authentication
+		std::stringstream sstr;
+		sstr << settings.szAuthBasicLogin << ":" << settings.szAuthBasicPassword;
+		std::string m_AccessToken = base64_encode(sstr.str());
+		ExtraHeaders.push_back("Authorization:Basic " + m_AccessToken);
+	}
+
+	if (settings.iMethod == 0) {			// GET
+		if (!HTTPClient::GET(httpUrl, ExtraHeaders, sResult, true))
+		{
+			_log.Log(LOG_ERROR, "HttpLink: Error sending data to http with GET!");
 		}
-		else if (httpMethodInt == 2) {		// PUT
-			if (!HTTPClient::PUT(httpUrl, httpData, ExtraHeaders, sResult, true))
-			{
-				_log.Log(LOG_ERROR, "HttpLink: Error sending data to http with PUT!");
-			}
+	}
+	else if (settings.iMethod == 1) {		// POST
+		if (!settings.szHeaders.empty())
+		{
+			// Add additional headers
+			std::vector<std::string> ExtraHeaders2;
+			StringSplit(settings.szHeaders, "\r\n", ExtraHeaders2);
+			std::copy(ExtraHeaders2.begin(), ExtraHeaders2.end(), std::back_inserter(ExtraHeaders));
 		}
-
-		// debug
-		if (httpDebugActive) {
-			_log.Log(LOG_NORM, "HttpLink: response %s", sResult.c_str());
+		if (!HTTPClient::POST(httpUrl, httpData, ExtraHeaders, sResult, true, true))
+		{
+			_log.Log(LOG_ERROR, "HttpLink: Error sending data to http with POST!");
 		}
 	}
+	else if (settings.iMethod == 2) {		// PUT
+		if (!HTTPClient::PUT(httpUrl, httpData, ExtraHeaders, sResult, true))
+		{
+			_log.Log(LOG_ERROR, "HttpLink: Error sending data to http with PUT!");
+		}
+	}
+
+	// debug
+	if (settings.bDebug) {
+		_log.Log(LOG_NORM, "HttpLink: response %s", sResult.c_str());
+	}
 }
 
 //Webserver helpers
@@ -269,6 +342,7 @@ namespace http {
 			std::string auth = request::findValue(&req, "auth");
 			std::string authbasiclogin = request::findValue(&req, "authbasiclogin");
 			std::string authbasicpassword = request::findValue(&req, "authbasicpassword");
+			std::string batchenabled = request::findValue(&req, "batchenabled");
 			if ((url.empty()) || (method.empty()) || (linkactive.empty()) || (debugenabled.empty()))
 				return;
 			if ((method != "0") && (data.empty())) //PUT/POST should have data
@@ -284,8 +358,8 @@ namespace http {
 			m_sql.UpdatePreferencesVar("HttpAuth", atoi(auth.c_str()));
 			m_sql.UpdatePreferencesVar("HttpAuthBasicLogin", authbasiclogin);
 			m_sql.UpdatePreferencesVar("HttpAuthBasicPassword", authbasicpassword);
+			m_sql.UpdatePreferencesVar("HttpBatch", atoi(batchenabled.c_str()));
 
-			m_httppush.UpdateActive();
 			root["status"] = "OK";
 			root["title"] = "SaveHttpLinkConfig";
 		}
@@ -311,6 +385,12 @@ namespace http {
 			else {
 				root["HttpDebug"] = 0;
 			}
+			if (m_sql.GetPreferencesVar("HttpBatch", nValue)) {
+				root["HttpBatch"] = nValue;
+			}
+			else {
+				root["HttpBatch"] = 0;
+			}
 			if (m_sql.GetPreferencesVar("HttpUrl", sValue))
 			{
 				root["HttpUrl"] = sValue;
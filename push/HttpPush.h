@@ -11,7 +11,25 @@ public:
 	void UpdateActive();
 
 private:
+  struct _tHttpSettings
+  {
+	  std::string szUrl;
+	  std::string szData;
+	  std::string szHeaders;
+	  int iMethod = 0;
+	  int iAuth = 0;
+	  std::string szAuthBasicLogin;
+	  std::string szAuthBasicPassword;
+	  bool bDebug = false;
+	  bool bBatch = false;
+  };
   void OnDeviceReceived(int m_HwdID, uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
-  void DoHttpPush(const uint64_t DeviceRowIdx);
+  void Do_Work();
+  void DoHttpPush(const _tQueuedDeviceUpdate &update, const _tHttpSettings &settings, std::map<std::string, std::string> &batches);
+  void SendHttpPush(const _tHttpSettings &settings, const std::string &httpUrl, const std::string &httpData);
+
+  std::shared_ptr<std::thread> m_thread;
+  std::mutex m_settings_mutex;
+  _tHttpSettings m_settings;
 };
 extern CHttpPush m_httppush;
@@ -32,6 +32,7 @@ bool CInfluxPush::Start()
 
 	UpdateSettings();
 	ReloadPushLinks(m_PushType);
+	RegisterPreferencesCallback("Influx", [this] { UpdateSettings(); });
 
 	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
 	SetThreadName(m_thread->native_handle(), "InfluxPush");
@@ -43,6 +44,7 @@ bool CInfluxPush::Start()
 
 void CInfluxPush::Stop()
 {
+	UnregisterPreferencesCallback();
 	if (m_sConnection.connected())
 		m_sConnection.disconnect();
 
@@ -297,7 +299,6 @@ namespace http
 			m_sql.UpdatePreferencesVar("InfluxUsername", username);
 			m_sql.UpdatePreferencesVar("InfluxPassword", base64_encode(password));
 			m_sql.UpdatePreferencesVar("InfluxDebug", idebugenabled);
-			m_influxpush.UpdateSettings();
 			root["status"] = "OK";
 			root["title"] = "SaveInfluxLinkConfig";
 		}
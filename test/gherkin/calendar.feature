@@ -0,0 +1,64 @@
+Feature: Daily calendar rollups
+    The rollup queries of SQLCalendarQueries.h run against an in-memory database with an active device (1)
+    that has samples on the rolled up day and an idle device (2) that only has samples on the day before.
+    The idle device gets a zero calendar row, like the per-device rollups wrote
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test the temperature rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "Temperature"
+        Then I expect the function to succeed
+        And have the following result "1,20.5,22.5,21.5,2024-03-10;2,0.0,0.0,0.0,2024-03-10"
+
+    Scenario: Test the rain rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "Rain"
+        Then I expect the function to succeed
+        And have the following result "1,2.5,2024-03-10;2,0.0,2024-03-10"
+
+    Scenario: Test an idle meter is rolled up without day values
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "Meter"
+        Then I expect the function to succeed
+        And have the following result "1,Active,243,29,0,,1000,1500,1250.0,1000,1500,1500,60;2,Idle,243,29,0,,NULL,NULL,NULL,NULL,NULL,7000,0"
+
+    Scenario: Test the multi meter rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "MultiMeter"
+        Then I expect the function to succeed
+        And have the following result "1,Active,243,29,,1,1,2,2,3,3,4,4,5,5,6,6;2,Idle,243,29,,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL"
+
+    Scenario: Test the wind rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "Wind"
+        Then I expect the function to succeed
+        And have the following result "1,10,20,2024-03-10;2,0,0,2024-03-10"
+
+    Scenario: Test the UV rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "UV"
+        Then I expect the function to succeed
+        And have the following result "1,3.5,2024-03-10;2,0.0,2024-03-10"
+
+    Scenario: Test the percentage rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "Percentage"
+        Then I expect the function to succeed
+        And have the following result "1,40.0,60.0,50.0,2024-03-10;2,0.0,0.0,0.0,2024-03-10"
+
+    Scenario: Test the fan rollup writes zero rows for devices without samples
+        Given I am testing the "calendar" module
+        When I test the function "Rollup"
+        And I provide the following input "Fan"
+        Then I expect the function to succeed
+        And have the following result "1,1200,1200,2024-03-10;2,0,0,2024-03-10"
@@ -0,0 +1,22 @@
+Feature: dzVents domoticzData export
+    main/dzVentsExport.cpp exports the devices, scenes/groups, variables, cameras and hardware to dzVents.
+    In a long lived dzVents state an event only exports the items that changed since the previous event,
+    the scripts have to see the same domoticzData as with a full export
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test the delta export matches a full export
+        Given I am testing the "dzvents" module
+        When I test the function "Export"
+        And I provide the following input "200"
+        Then I expect the function to succeed
+        And have the following result "OK"
+
+    Scenario: Test the export benchmark of 2000 devices exports the same data
+        Given I am testing the "dzvents" module
+        When I test the function "Benchmark"
+        And I provide the following input "2000"
+        Then I expect the function to succeed
+        And have the following result "OK"
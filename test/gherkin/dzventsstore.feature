@@ -0,0 +1,14 @@
+Feature: dzVents persistent data store
+    main/dzVentsStore.cpp keeps the dzVents persistent data resident and writes the data files itself.
+    A data file has to load back to the stored data, like one written by persistence.store
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test stored data and histories load back from the data file
+        Given I am testing the "dzventsstore" module
+        When I test the function "Roundtrip"
+        And I provide the following input "dzVents/runtime/persistence.lua"
+        Then I expect the function to succeed
+        And have the following result "OK"
@@ -0,0 +1,28 @@
+Feature: HTTP client transfer engine
+    httpclient/HTTPClientEngine.cpp runs all HTTPClient transfers on one curl multi handle in a worker thread.
+    A failing transfer has to complete with its error, and stopping the engine has to release every waiting caller
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test failing transfers complete with their error
+        Given I am testing the "httpclient" module
+        When I test the function "Errors"
+        And I provide the following input "500"
+        Then I expect the function to succeed
+        And have the following result "refused=OK,http=OK,timeout=OK,nested=OK,stats=OK"
+
+    Scenario: Test stopping the engine aborts the transfers in flight
+        Given I am testing the "httpclient" module
+        When I test the function "Stop"
+        And I provide the following input "20"
+        Then I expect the function to succeed
+        And have the following result "OK"
+
+    Scenario: Test an asynchronous request calls its callback and resolves its future
+        Given I am testing the "httpclient" module
+        When I test the function "Async"
+        And I provide the following input "hello"
+        Then I expect the function to succeed
+        And have the following result "callback=OK,future=OK,refused=OK,stopped=OK"
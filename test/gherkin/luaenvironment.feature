@@ -0,0 +1,15 @@
+Feature: Classic Lua script environment
+    main/LuaEnvironment.cpp gives every classic Lua script run on the persistent state its own globals.
+    The shared tables read like plain tables (index, #, pairs, next, rawget), but nothing a script writes,
+    also not through _G, may reach the shared globals or the next script
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test script writes and globals stay with the script run
+        Given I am testing the "luaenvironment" module
+        When I test the function "Isolation"
+        And I provide the following input "otherdevices,uservariables"
+        Then I expect the function to succeed
+        And have the following result "OK"
@@ -0,0 +1,35 @@
+Feature: P1 smart meter telegram dispatch
+    Lines of a P1 telegram are dispatched in place through a sorted index of the OBIS references
+    in hardware/P1MeterOBIS.h instead of comparing every line with every entry of the match list
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test an OBIS line is dispatched to its topic
+        Given I am testing the "p1meter" module
+        When I test the function "Lookup"
+        And I provide the following input "1-0:1.7.0(01.193*kW)"
+        Then I expect the function to succeed
+        And have the following result "powerusagec=01.193"
+
+    Scenario: Test an unknown OBIS line is not dispatched
+        Given I am testing the "p1meter" module
+        When I test the function "Lookup"
+        And I provide the following input "1-0:99.97.0(2)"
+        Then I expect the function to fail
+        And have the following result "NOT FOUND!"
+
+    Scenario: Test replayed telegrams give the same values as the linear match list
+        Given I am testing the "p1meter" module
+        When I test the function "Replay"
+        And I provide the following input "10"
+        Then I expect the function to succeed
+        And have the following result "OK"
+
+    Scenario: Test telegram dispatch benchmark gives the same values
+        Given I am testing the "p1meter" module
+        When I test the function "Benchmark"
+        And I provide the following input "20000"
+        Then I expect the function to succeed
+        And have the following result "OK"
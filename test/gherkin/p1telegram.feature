@@ -0,0 +1,57 @@
+Feature: P1 smart meter telegram parsing
+    Telegrams received from a P1 smart meter on the LAN are assembled, CRC checked and decoded by
+    P1MeterBase::ParseP1Data, whether a telegram arrives in one piece or split at any byte boundary
+
+    Background:
+        Given Domoticz is running
+        And accessible on port 8080
+
+    Scenario: Test a complete DSMR 5 telegram is accepted
+        Given a P1 smart meter is connected through the LAN
+        When the meter sends the telegram "dsmr5"
+        Then the device "Power" should show "1234567;987654;111222;45678;1193;0"
+        And the device "Gas" should show "12785.123"
+
+    Scenario: Test a DSMR 5 telegram split in single bytes is accepted
+        Given a P1 smart meter is connected through the LAN
+        When the meter sends the telegram "dsmr5" in chunks of 1 bytes
+        Then the device "Power" should show "1234567;987654;111222;45678;1193;0"
+        And the device "Gas" should show "12785.123"
+
+    Scenario: Test a DSMR 5 telegram split at arbitrary byte boundaries is accepted
+        Given a P1 smart meter is connected through the LAN
+        When the meter sends the telegram "dsmr5" in chunks of 7 bytes
+        And the meter sends the telegram "dsmr5_next" in chunks of 61 bytes
+        Then the device "Power" should show "1234571;987654;111222;45678;1204;0"
+        And the device "Gas" should show "12785.127"
+
+    Scenario: Test a telegram with a CRC mismatch is rejected
+        Given a P1 smart meter is connected through the LAN
+        When the meter sends the telegram "dsmr5"
+        And the device "Power" shows "1234567;987654;111222;45678;1193;0"
+        And the meter sends the telegram "dsmr5_next" with a corrupted CRC
+        Then the device "Power" should still show "1234567;987654;111222;45678;1193;0"
+        And the device "Gas" should still show "12785.123"
+        When the meter sends the telegram "dsmr5_next"
+        Then the device "Power" should show "1234571;987654;111222;45678;1204;0"
+
+    Scenario: Test a telegram with M-Bus gas and water meters is accepted
+        Given a P1 smart meter is connected through the LAN
+        When the meter sends the telegram "fluvius" in chunks of 13 bytes
+        Then the device "Power" should show "12755;5763;159;0;123;0"
+        And the device "Gas" should show "1.326"
+        And the device "Water" should show "0.302"
+
+    Scenario: Test a DSMR 2.2 telegram without CRC is accepted
+        Given a P1 smart meter is connected through the LAN
+        When the meter sends the telegram "dsmr22" in chunks of 5 bytes
+        Then the device "Power" should show "512000;510000;0;0;530;0"
+        And the device "Gas" should show "4.123"
+
+    Scenario: Test consecutive encrypted telegrams are decrypted
+        Given an encrypted P1 smart meter with key "000102030405060708090A0B0C0D0E0F" is connected through the LAN
+        When the meter sends the encrypted telegram "dsmr5"
+        And the device "Power" shows "1234567;987654;111222;45678;1193;0"
+        And the meter sends the encrypted telegram "dsmr5_next"
+        Then the device "Power" should show "1234571;987654;111222;45678;1204;0"
+        And the device "Gas" should show "12785.127"
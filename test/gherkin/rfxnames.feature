@@ -0,0 +1,43 @@
+Feature: RFXNames descriptors
+    Domoticz translates hardware, device type and subtype numbers into readable names in main/RFXNames.cpp
+    these lookups are done through indexes that are generated at compile time
+    and have to return exactly the same names as the plain descriptor tables
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test compile-time lookup indexes
+        Given I am testing the "rfxnames" module
+        When I test the function "VerifyLookupTables"
+        And I provide the following input "all"
+        Then I expect the function to succeed
+        And have the following result "OK"
+
+    Scenario: Test type and subtype description
+        Given I am testing the "rfxnames" module
+        When I test the function "RFX_Type_SubType_Desc"
+        And I provide the following input "16|#|1"
+        Then I expect the function to succeed
+        And have the following result "ARC"
+
+    Scenario: Test unknown type and subtype description
+        Given I am testing the "rfxnames" module
+        When I test the function "RFX_Type_SubType_Desc"
+        And I provide the following input "255|#|255"
+        Then I expect the function to succeed
+        And have the following result "Unknown"
+
+    Scenario: Test hardware type description
+        Given I am testing the "rfxnames" module
+        When I test the function "Hardware_Type_Desc"
+        And I provide the following input "1"
+        Then I expect the function to succeed
+        And have the following result "RFXCOM - RFXtrx433 USB 433.92MHz Transceiver"
+
+    Scenario: Test indexed lookup benchmark finds the same entries
+        Given I am testing the "rfxnames" module
+        When I test the function "BenchmarkLookup"
+        And I provide the following input "10"
+        Then I expect the function to succeed
+        And have the following result "OK"
@@ -0,0 +1,22 @@
+Feature: RX message queue
+    Received hardware messages are queued for the decoder in main/mainworker.cpp
+    the packet is stored inline in the queue item and the queue reuses its ring slots
+    so a steady flow of messages does not allocate per message
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test queued messages keep their content and order
+        Given I am testing the "rxqueue" module
+        When I test the function "Roundtrip"
+        And I provide the following input "1000"
+        Then I expect the function to succeed
+        And have the following result "OK"
+
+    Scenario: Test inline queue benchmark pops the same messages
+        Given I am testing the "rxqueue" module
+        When I test the function "BenchmarkQueue"
+        And I provide the following input "100000"
+        Then I expect the function to succeed
+        And have the following result "OK"
@@ -0,0 +1,172 @@
+from pytest_bdd import scenario, given, when, then, parsers
+import pytest, requests, socket, threading, time, os
+
+P1TelegramDir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "resources", "p1telegrams")
+HTYPE_P1SmartMeterLAN = 5
+
+@scenario('p1telegram.feature', 'Test a complete DSMR 5 telegram is accepted')
+def test_complete():
+    pass
+
+@scenario('p1telegram.feature', 'Test a DSMR 5 telegram split in single bytes is accepted')
+def test_split_bytes():
+    pass
+
+@scenario('p1telegram.feature', 'Test a DSMR 5 telegram split at arbitrary byte boundaries is accepted')
+def test_split_chunks():
+    pass
+
+@scenario('p1telegram.feature', 'Test a telegram with a CRC mismatch is rejected')
+def test_crc_mismatch():
+    pass
+
+@scenario('p1telegram.feature', 'Test a telegram with M-Bus gas and water meters is accepted')
+def test_mbus():
+    pass
+
+@scenario('p1telegram.feature', 'Test a DSMR 2.2 telegram without CRC is accepted')
+def test_dsmr22():
+    pass
+
+@scenario('p1telegram.feature', 'Test consecutive encrypted telegrams are decrypted')
+def test_encrypted():
+    pass
+
+# CRC16 of a DSMR 4+ telegram, from the '/' up to and including the '!' (x^16 + x^15 + x^2 + 1, reflected)
+def p1_crc16(data):
+    crc = 0
+    for c in data:
+        crc ^= c
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if (crc & 1) else (crc >> 1)
+    return crc
+
+# The recorded telegrams are stored without the CRC, a meter sends them with CRLF line ends
+# and (DSMR 4 and up) the CRC behind the '!'
+def load_telegram(name):
+    with open(os.path.join(P1TelegramDir, name + ".txt"), "rb") as f:
+        lines = f.read().decode("ascii").splitlines()
+    telegram = "\r\n".join(lines).encode("ascii")
+    if name.startswith("dsmr22"):
+        return telegram + b"\r\n"
+    return telegram + b"%04X\r\n" % p1_crc16(telegram)
+
+def load_encrypted_telegram(name):
+    with open(os.path.join(P1TelegramDir, name + "_encrypted.hex"), "r") as f:
+        return bytes.fromhex("".join(f.read().split()))
+
+class P1Meter:
+    # Plays the P1 port of a smart meter: the P1 LAN hardware connects to it and reads the telegrams
+    def __init__(self):
+        self.oListen = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.oListen.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.oListen.bind(("127.0.0.1", 0))
+        self.oListen.listen(1)
+        self.iPort = self.oListen.getsockname()[1]
+        self.oConnection = None
+        self.sBaseURI = ""
+        self.sHardwareIdx = ""
+        self.oAccepted = threading.Event()
+        threading.Thread(target=self.accept, daemon=True).start()
+
+    def accept(self):
+        try:
+            self.oConnection, _ = self.oListen.accept()
+            self.oConnection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            self.oAccepted.set()
+        except OSError:
+            pass
+
+    def send(self, data, chunksize=0):
+        assert self.oAccepted.wait(15)
+        if chunksize == 0:
+            self.oConnection.sendall(data)
+            return
+        for ii in range(0, len(data), chunksize):
+            self.oConnection.sendall(data[ii:ii + chunksize])
+            time.sleep(0.002)
+
+    def get_device_data(self, name):
+        oResult = requests.get(self.sBaseURI + "/json.htm?type=devices&filter=all&used=all&hwidx=" + self.sHardwareIdx)
+        assert oResult.status_code == 200
+        for device in oResult.json().get("result", []):
+            if device["Name"] == name:
+                return str(device["Data"]).split(" ")[0]
+        return None
+
+    def wait_for_device_data(self, name, data, timeout=15):
+        sData = None
+        tEnd = time.time() + timeout
+        while time.time() < tEnd:
+            sData = self.get_device_data(name)
+            if sData == data:
+                break
+            time.sleep(0.25)
+        return sData
+
+    def close(self):
+        if self.sHardwareIdx != "":
+            requests.get(self.sBaseURI + "/json.htm?type=command&param=deletehardware&idx=" + self.sHardwareIdx)
+        if self.oConnection is not None:
+            self.oConnection.close()
+        self.oListen.close()
+
+@pytest.fixture
+def p1meter():
+    oMeter = P1Meter()
+    yield oMeter
+    oMeter.close()
+
+def add_p1_hardware(test_domoticz, p1meter, key):
+    p1meter.sBaseURI = test_domoticz.sBaseURI
+    oResult = requests.get(test_domoticz.sBaseURI + "/json.htm", params={
+        "type": "command", "param": "addhardware", "name": "P1 telegram test", "enabled": "true",
+        "htype": HTYPE_P1SmartMeterLAN, "address": "127.0.0.1", "port": p1meter.iPort, "password": key,
+        "Mode1": 0, "Mode2": 0, "Mode3": 0, "datatimeout": 0 })
+    assert oResult.status_code == 200
+    oJSON = oResult.json()
+    assert oJSON["status"] == "OK"
+    p1meter.sHardwareIdx = str(oJSON["idx"])
+    assert p1meter.oAccepted.wait(15)
+
+@given('a P1 smart meter is connected through the LAN')
+def setup_p1meter(test_domoticz, p1meter):
+    add_p1_hardware(test_domoticz, p1meter, "")
+
+@given(parsers.parse('an encrypted P1 smart meter with key "{key}" is connected through the LAN'))
+def setup_encrypted_p1meter(test_domoticz, p1meter, key):
+    add_p1_hardware(test_domoticz, p1meter, key)
+
+@when(parsers.parse('the meter sends the telegram "{name}"'))
+def send_telegram(p1meter, name):
+    p1meter.send(load_telegram(name))
+
+@when(parsers.parse('the meter sends the telegram "{name}" in chunks of {size:d} bytes'))
+def send_telegram_chunked(p1meter, name, size):
+    p1meter.send(load_telegram(name), size)
+
+@when(parsers.parse('the meter sends the telegram "{name}" with a corrupted CRC'))
+def send_telegram_corrupted(p1meter, name):
+    telegram = load_telegram(name)
+    # flip a bit of the CRC, the content itself is intact
+    crcpos = telegram.rfind(b"!") + 1
+    crc = int(telegram[crcpos:crcpos + 4], 16) ^ 0x0001
+    p1meter.send(telegram[:crcpos] + b"%04X\r\n" % crc)
+
+@when(parsers.parse('the meter sends the encrypted telegram "{name}"'))
+def send_encrypted_telegram(p1meter, name):
+    p1meter.send(load_encrypted_telegram(name))
+
+@when(parsers.parse('the device "{name}" shows "{data}"'))
+def wait_device_data(p1meter, name, data):
+    assert p1meter.wait_for_device_data(name, data) == data
+
+@then(parsers.parse('the device "{name}" should show "{data}"'))
+def check_device_data(p1meter, name, data):
+    assert p1meter.wait_for_device_data(name, data) == data
+
+@then(parsers.parse('the device "{name}" should still show "{data}"'))
+def check_device_data_unchanged(p1meter, name, data):
+    # give the rejected telegram the time to (wrongly) get through
+    time.sleep(3)
+    assert p1meter.get_device_data(name) == data
@@ -10,14 +10,51 @@
 #include "../main/Logger.h"
 
 #define WEBSOCKET_SESSION_TIMEOUT 86400 // 1 day
+#define WEBSOCKET_COALESCE_MS 100 // changes of the same device within this window are sent once
+#define WEBSOCKET_RENDER_CACHE_MS 2000 // rendered device updates are shared between connections for at most this long
+#define WEBSOCKET_RENDER_CACHE_ITEMS 256
 
 namespace http {
 	namespace server {
 
+		void CWebsocketRenderCache::DeviceChanged(const uint64_t DeviceRowIdx, const std::chrono::steady_clock::time_point tChanged)
+		{
+			std::lock_guard<std::mutex> l(m_mutex);
+			m_device_changed[DeviceRowIdx] = tChanged;
+		}
+
+		std::shared_ptr<const std::string> CWebsocketRenderCache::Find(const uint64_t DeviceRowIdx, const std::string &szKey, const std::chrono::steady_clock::time_point tNow)
+		{
+			std::lock_guard<std::mutex> l(m_mutex);
+			auto itt = m_renders.find(szKey);
+			if (itt == m_renders.end())
+				return nullptr;
+			if ((itt->second.rendered < m_device_changed[DeviceRowIdx]) || (tNow - itt->second.rendered >= std::chrono::milliseconds(WEBSOCKET_RENDER_CACHE_MS)))
+				return nullptr;
+			return itt->second.response;
+		}
+
+		void CWebsocketRenderCache::Add(const std::string &szKey, const std::chrono::steady_clock::time_point tRendered, const std::shared_ptr<const std::string> &response)
+		{
+			std::lock_guard<std::mutex> l(m_mutex);
+			if (m_renders.size() >= WEBSOCKET_RENDER_CACHE_ITEMS)
+			{
+				for (auto itt = m_renders.begin(); itt != m_renders.end();)
+				{
+					if (tRendered - itt->second.rendered >= std::chrono::milliseconds(WEBSOCKET_RENDER_CACHE_MS))
+						itt = m_renders.erase(itt);
+					else
+						++itt;
+				}
+			}
+			m_renders[szKey] = { tRendered, response };
+		}
+
 		CWebsocketHandler::CWebsocketHandler(cWebem *pWebem, std::function<void(const std::string &packet_data)> _MyWrite)
 			: MyWrite(std::move(_MyWrite))
 			, myWebem(pWebem)
 			, m_Push(this)
+			, m_RenderCache(pWebem->GetWebsocketRenderCache())
 		{
 		}
 
@@ -31,26 +68,8 @@ namespace http {
 			Json::Value jsonValue;
 			try
 			{
-				// WebSockets only do security during set up so keep pushing the expiry out to stop it being cleaned up
 				WebEmSession session;
-				auto itt = myWebem->m_sessions.find(sessionid);
-				if (itt != myWebem->m_sessions.end())
-				{
-					session = itt->second;
-				}
-				else
-					// for outbound messages create a temporary session if required
-					// todo: Add the username and rights from the original connection
-					if (outbound)
-					{
-						time_t nowAnd1Day = ((time_t)mytime(nullptr)) + WEBSOCKET_SESSION_TIMEOUT;
-						session.timeout = nowAnd1Day;
-						session.expires = nowAnd1Day;
-						session.isnew = false;
-						session.rememberme = false;
-						session.reply_status = 200;
-					}
-
+				GetSession(session, outbound);
 
 				Json::Value value;
 				if (!ParseJSon(packet_data, value)) {
@@ -60,26 +79,11 @@ namespace http {
 				if (szEvent.find("request") == std::string::npos)
 					return true;
 
-				request req;
-				req.method = "GET";
-				std::string querystring = value["query"].asString();
-				req.uri = myWebem->GetWebRoot() + "/json.htm?" + querystring;
-				req.http_version_major = 1;
-				req.http_version_minor = 1;
-				req.headers.resize(0); // todo: do we need any headers?
-				req.content.clear();
-				reply rep;
-				if (myWebem->CheckForPageOverride(session, req, rep)) {
-					if (rep.status == reply::ok) {
-						jsonValue["request"] = szEvent;
-						jsonValue["event"] = "response";
-						Json::Value::Int64 reqID = value["requestid"].asInt64();
-						jsonValue["requestid"] = reqID;
-						jsonValue["data"] = rep.content;
-						std::string response = JSonToFormatString(jsonValue);
-						MyWrite(response);
-						return true;
-					}
+				std::string response;
+				if (RenderRequest(session, value["query"].asString(), szEvent, value["requestid"].asInt64(), response))
+				{
+					MyWrite(response);
+					return true;
 				}
 			}
 			catch (std::exception& e)
@@ -93,6 +97,52 @@ namespace http {
 			return true;
 		}
 
+		void CWebsocketHandler::GetSession(WebEmSession &session, const bool outbound)
+		{
+			// WebSockets only do security during set up so keep pushing the expiry out to stop it being cleaned up
+			auto itt = myWebem->m_sessions.find(sessionid);
+			if (itt != myWebem->m_sessions.end())
+			{
+				session = itt->second;
+			}
+			else
+				// for outbound messages create a temporary session if required
+				// todo: Add the username and rights from the original connection
+				if (outbound)
+				{
+					time_t nowAnd1Day = ((time_t)mytime(nullptr)) + WEBSOCKET_SESSION_TIMEOUT;
+					session.timeout = nowAnd1Day;
+					session.expires = nowAnd1Day;
+					session.isnew = false;
+					session.rememberme = false;
+					session.reply_status = 200;
+				}
+		}
+
+		bool CWebsocketHandler::RenderRequest(WebEmSession &session, const std::string &querystring, const std::string &szEvent, const int64_t requestid, std::string &response)
+		{
+			request req;
+			req.method = "GET";
+			req.uri = myWebem->GetWebRoot() + "/json.htm?" + querystring;
+			req.http_version_major = 1;
+			req.http_version_minor = 1;
+			req.headers.resize(0); // todo: do we need any headers?
+			req.content.clear();
+			reply rep;
+			if (!myWebem->CheckForPageOverride(session, req, rep))
+				return false;
+			if (rep.status != reply::ok)
+				return false;
+
+			Json::Value jsonValue;
+			jsonValue["request"] = szEvent;
+			jsonValue["event"] = "response";
+			jsonValue["requestid"] = (Json::Value::Int64)requestid;
+			jsonValue["data"] = rep.content;
+			response = JSonToFormatString(jsonValue);
+			return true;
+		}
+
 		void CWebsocketHandler::Start()
 		{
 			RequestStart();
@@ -116,12 +166,16 @@ namespace http {
 
 		void CWebsocketHandler::Do_Work()
 		{
-			while (!IsStopRequested(1000))
+			time_t lastDateTime = 0;
+			while (!IsStopRequested(WEBSOCKET_COALESCE_MS))
 			{
+				SendPendingDeviceChanges();
+
 				time_t atime = mytime(nullptr);
-				if (atime % 10 == 0)
+				if ((atime % 10 == 0) && (atime != lastDateTime))
 				{
 					//Send Date/Time every 10 seconds
+					lastDateTime = atime;
 					SendDateTime();
 				}
 			}
@@ -174,15 +228,55 @@ namespace http {
 
 		void CWebsocketHandler::OnDeviceChanged(const uint64_t DeviceRowIdx)
 		{
+			//Only remember the change, the worker thread sends it when the coalescing window has passed
+			auto tNow = std::chrono::steady_clock::now();
+			m_RenderCache->DeviceChanged(DeviceRowIdx, tNow);
+			std::lock_guard<std::mutex> l(m_pending_mutex);
+			m_pending_devices.emplace(DeviceRowIdx, tNow);
+		}
+
+		void CWebsocketHandler::SendPendingDeviceChanges()
+		{
+			std::vector<uint64_t> devices;
+			auto tNow = std::chrono::steady_clock::now();
+			{
+				std::lock_guard<std::mutex> l(m_pending_mutex);
+				for (auto itt = m_pending_devices.begin(); itt != m_pending_devices.end();)
+				{
+					if (tNow - itt->second >= std::chrono::milliseconds(WEBSOCKET_COALESCE_MS))
+					{
+						devices.push_back(itt->first);
+						itt = m_pending_devices.erase(itt);
+					}
+					else
+						++itt;
+				}
+			}
+			if (devices.empty())
+				return;
+
 			try
 			{
-				std::string query = "type=devices&rid=" + std::to_string(DeviceRowIdx);
-				Json::Value request;
-				request["event"] = "device_request";
-				request["requestid"] = -1;
-				request["query"] = query;
-				std::string packet = JSonToFormatString(request);
-				Handle(packet, true);
+				WebEmSession session;
+				GetSession(session, true);
+				std::string szRightsKey = "|" + session.username + "|" + std::to_string(session.rights);
+
+				for (const auto idx : devices)
+				{
+					//Connections with the same user get the same buffer, rendered at most once per change
+					std::string szKey = std::to_string(idx) + szRightsKey;
+					std::shared_ptr<const std::string> response = m_RenderCache->Find(idx, szKey, tNow);
+					if (!response)
+					{
+						auto tRender = std::chrono::steady_clock::now();
+						std::string szResponse;
+						if (!RenderRequest(session, "type=devices&rid=" + std::to_string(idx), "device_request", -1, szResponse))
+							continue;
+						response = std::make_shared<const std::string>(std::move(szResponse));
+						m_RenderCache->Add(szKey, tRender, response);
+					}
+					MyWrite(*response);
+				}
 			}
 			catch (std::exception& e)
 			{
@@ -8,6 +8,8 @@
 #include <thread>
 #include <mutex>
 #include <memory>
+#include <map>
+#include <chrono>
 
 namespace http
 {
@@ -15,6 +17,27 @@ namespace http
 	{
 
 		class cWebem;
+		struct _tWebEmSession;
+
+		// Device updates rendered for websocket connections, shared by all connections of one webserver (cWebem)
+		class CWebsocketRenderCache
+		{
+		      public:
+			void DeviceChanged(uint64_t DeviceRowIdx, std::chrono::steady_clock::time_point tChanged);
+			// The response rendered for the key after the last change of the device, nullptr when it has to be rendered
+			std::shared_ptr<const std::string> Find(uint64_t DeviceRowIdx, const std::string &szKey, std::chrono::steady_clock::time_point tNow);
+			void Add(const std::string &szKey, std::chrono::steady_clock::time_point tRendered, const std::shared_ptr<const std::string> &response);
+
+		      private:
+			struct _tRender
+			{
+				std::chrono::steady_clock::time_point rendered;
+				std::shared_ptr<const std::string> response;
+			};
+			std::mutex m_mutex;
+			std::map<uint64_t, std::chrono::steady_clock::time_point> m_device_changed;
+			std::map<std::string, _tRender> m_renders;
+		};
 
 		class CWebsocketHandler : public StoppableTask
 		{
@@ -35,11 +58,17 @@ namespace http
 			std::string sessionid;
 			cWebem *myWebem;
 			CWebSocketPush m_Push;
+			std::shared_ptr<CWebsocketRenderCache> m_RenderCache;
 
 		      private:
 			void SendDateTime();
+			void SendPendingDeviceChanges();
+			void GetSession(_tWebEmSession &session, bool outbound);
+			bool RenderRequest(_tWebEmSession &session, const std::string &querystring, const std::string &szEvent, int64_t requestid, std::string &response);
 			std::shared_ptr<std::thread> m_thread;
 			std::mutex m_mutex;
+			std::map<uint64_t, std::chrono::steady_clock::time_point> m_pending_devices; // first change within the coalescing window
+			std::mutex m_pending_mutex;
 			void Do_Work();
 		};
 
@@ -12,6 +12,7 @@
 #include "Base64.h"
 #include "sha1.hpp"
 #include "GZipHelper.h"
+#include "WebsocketHandler.h"
 #include <stdarg.h>
 #include <fstream>
 #include <sstream>
@@ -50,6 +51,7 @@ namespace http {
 			, myServer(server_factory::create(settings, myRequestHandler))
 			, m_io_service()
 			, m_session_clean_timer(m_io_service, boost::posix_time::minutes(1))
+			, m_websocketRenderCache(std::make_shared<CWebsocketRenderCache>())
 		{
 			// associate handler to timer and schedule the first iteration
 			m_session_clean_timer.async_wait([this](auto &&) { CleanSessions(); });
@@ -1080,6 +1082,11 @@ namespace http {
 			return mySessionStore;
 		}
 
+		std::shared_ptr<CWebsocketRenderCache> cWebem::GetWebsocketRenderCache()
+		{
+			return m_websocketRenderCache;
+		}
+
 		std::string cWebem::GetPort()
 		{
 			return m_settings.listening_port;
@@ -2464,6 +2471,7 @@ namespace http {
 			itt_rc->second.host_last_request_uri_ = req.uri;
 
 			session.reply_status = reply::ok;
+			session.reply_etag.clear();
 			session.isnew = false;
 			session.rememberme = false;
 
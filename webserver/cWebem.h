@@ -49,6 +49,7 @@ namespace http
 			std::string auth_token;
 			std::string username;
 			int reply_status = 0;
+			std::string reply_etag; // set by a handler that supports conditional (If-None-Match) requests
 			time_t timeout = 0;
 			time_t expires = 0;
 			int rights = 0;
@@ -104,6 +105,7 @@ namespace http
 
 		*/
 		class cWebem;
+		class CWebsocketRenderCache;
 		typedef std::function<void(std::string &content_part)> webem_include_function;
 		typedef std::function<void(std::wstring &content_part_w)> webem_include_function_w;
 		typedef std::function<void(WebEmSession &session, const request &req, std::string &redirecturi)> webem_action_function;
@@ -215,6 +217,8 @@ namespace http
 			void SetSessionStore(session_store_impl_ptr sessionStore);
 			session_store_impl_ptr GetSessionStore();
 
+			std::shared_ptr<CWebsocketRenderCache> GetWebsocketRenderCache();
+
 			std::string m_zippassword;
 			std::string GetPort();
 			std::string GetWebRoot();
@@ -267,6 +271,8 @@ namespace http
 			boost::asio::io_service m_io_service;
 			boost::asio::deadline_timer m_session_clean_timer;
 			std::shared_ptr<std::thread> m_io_service_thread;
+			/// device updates rendered for the websocket connections
+			std::shared_ptr<CWebsocketRenderCache> m_websocketRenderCache;
 		};
 
 	} // namespace server
@@ -112,13 +112,17 @@ define(['app'], function (app) {
 			if ($('#httpremote #debugenabled').is(":checked")) {
 				debugenabled = 1;
 			}
+			var batchenabled = 0;
+			if ($('#httpremote #batchenabled').is(":checked")) {
+				batchenabled = 1;
+			}
 
 			var auth = $('#httpremote #comboauth').val();
 			var authbasiclogin = $('#httpremote #authBasicUser').val();
 			var authbasicpassword = $('#httpremote #authBasicPassword').val();
 			$.ajax({
 				url: "json.htm?type=command&param=savehttplinkconfig" +
-				"&url=" + encodeURIComponent(cleanurl) + "&method=" + method + "&headers=" + encodeURIComponent(httpheaders) + "&data=" + encodeURIComponent(httpdata) + "&linkactive=" + linkactive + "&debugenabled=" + debugenabled + "&auth=" + auth + "&authbasiclogin=" + authbasiclogin + "&authbasicpassword=" + authbasicpassword,
+				"&url=" + encodeURIComponent(cleanurl) + "&method=" + method + "&headers=" + encodeURIComponent(httpheaders) + "&data=" + encodeURIComponent(httpdata) + "&linkactive=" + linkactive + "&debugenabled=" + debugenabled + "&batchenabled=" + batchenabled + "&auth=" + auth + "&authbasiclogin=" + authbasiclogin + "&authbasicpassword=" + authbasicpassword,
 				async: false,
 				dataType: 'json',
 				success: function (data) {
@@ -216,6 +220,10 @@ define(['app'], function (app) {
 							if (data.HttpDebug) {
 								$('#httpremote #debugenabled').prop('checked', true);
 							}
+							$('#httpremote #batchenabled').prop('checked', false);
+							if (data.HttpBatch) {
+								$('#httpremote #batchenabled').prop('checked', true);
+							}
 							$('#httpremote #comboauth').val(data.HttpAuth);
 							$('#httpremote #authBasicUser').val(data.HttpAuthBasicLogin);
 							$('#httpremote #authBasicPassword').val(data.HttpAuthBasicPassword);
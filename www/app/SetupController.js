@@ -579,6 +579,9 @@ define(['app'], function (app) {
 					if (typeof data.EventSystemLogFullURL != 'undefined') {
 						$("#eventsystemtable #EventSystemLogFullURL").prop('checked', data.EventSystemLogFullURL == 1);
 					}
+					if (typeof data.LuaPersistentStates != 'undefined') {
+						$("#eventsystemtable #LuaPersistentStates").prop('checked', data.LuaPersistentStates == 1);
+					}
 
 					if (typeof data.FloorplanPopupDelay != 'undefined') {
 						$("#floorplanoptionstable #FloorplanPopupDelay").val(data.FloorplanPopupDelay);